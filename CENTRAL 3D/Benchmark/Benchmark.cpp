@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+#include "JSONLoader.h"
+#include "SampleStats.h"
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "mmgr/mmgr.h"
+
+Benchmark::Benchmark(uint min_iterations, uint max_iterations, double time_budget) : min_iterations(min_iterations), max_iterations(max_iterations), time_budget(time_budget)
+{
+	if (this->min_iterations == 0)
+		this->min_iterations = 1;
+
+	if (this->max_iterations < this->min_iterations)
+		this->max_iterations = this->min_iterations;
+}
+
+void Benchmark::SetFilter(const char* filter)
+{
+	this->filter = filter ? filter : "";
+}
+
+bool Benchmark::IsEnabled(const char* name) const
+{
+	return filter.empty() || std::string(name).find(filter) != std::string::npos;
+}
+
+void Benchmark::Run(const char* name, uint size, const char* unit, const std::function<void()>& body, const std::function<void()>& setup)
+{
+	if (!IsEnabled(name))
+		return;
+
+	// --- Warm up, first touch of caches and frame arenas is not what we want to track ---
+	if (setup)
+		setup();
+
+	body();
+
+	std::vector<double> samples;
+	samples.reserve(max_iterations);
+	double total = 0.0;
+
+	while (samples.size() < max_iterations && (samples.size() < min_iterations || total < time_budget))
+	{
+		if (setup)
+			setup();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		body();
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		samples.push_back(ms);
+		total += ms;
+	}
+
+	BenchmarkResult result;
+	result.name = name;
+	result.size = size;
+	result.unit = unit;
+
+	SampleStats stats = ComputeSampleStats(samples);
+	result.iterations = stats.count;
+	result.median = stats.median;
+	result.p95 = stats.p95;
+	result.mean = stats.mean;
+	result.variance = stats.variance;
+	result.min = stats.min;
+	result.max = stats.max;
+
+	results.push_back(result);
+
+	CONSOLE_LOG("Benchmark: %-24s %7u %-9s median %10.4f ms  p95 %10.4f ms  (%u iterations)", name, size, unit, result.median, result.p95, result.iterations);
+}
+
+const std::vector<BenchmarkResult>& Benchmark::GetResults() const
+{
+	return results;
+}
+
+void Benchmark::Fail(const char* format, ...)
+{
+	char message[512];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+
+	CONSOLE_LOG("|[error]: Benchmark: %s", message);
+	failures++;
+}
+
+uint Benchmark::GetFailures() const
+{
+	return failures;
+}
+
+bool Benchmark::Save(const char* path, uint seed) const
+{
+	json file;
+	file["engine"] = TITLE;
+	file["version"] = VERSION;
+	file["seed"] = seed;
+	file["time_unit"] = "ms";
+	file["results"] = json::array();
+
+	for (uint i = 0; i < results.size(); ++i)
+	{
+		json node;
+		node["name"] = results[i].name;
+		node["size"] = results[i].size;
+		node["unit"] = results[i].unit;
+		node["iterations"] = results[i].iterations;
+		node["median"] = results[i].median;
+		node["p95"] = results[i].p95;
+		node["mean"] = results[i].mean;
+		node["variance"] = results[i].variance;
+		node["min"] = results[i].min;
+		node["max"] = results[i].max;
+
+		file["results"].push_back(node);
+	}
+
+	JSONLoader loader;
+	return loader.Save(path, file);
+}
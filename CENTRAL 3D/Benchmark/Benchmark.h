@@ -0,0 +1,61 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "Globals.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+#define BENCHMARK_MIN_ITERATIONS 5
+#define BENCHMARK_MAX_ITERATIONS 200
+#define BENCHMARK_TIME_BUDGET 2000.0 // ms of measured time per case, after the minimum iterations
+
+struct BenchmarkResult
+{
+	std::string name;
+	uint size = 0;
+	std::string unit; // What size counts: objects, vertices, lookups...
+	uint iterations = 0;
+
+	// --- Milliseconds per iteration ---
+	double median = 0.0;
+	double p95 = 0.0;
+	double mean = 0.0;
+	double variance = 0.0; // ms squared
+	double min = 0.0;
+	double max = 0.0;
+};
+
+class Benchmark
+{
+public:
+
+	Benchmark(uint min_iterations = BENCHMARK_MIN_ITERATIONS, uint max_iterations = BENCHMARK_MAX_ITERATIONS, double time_budget = BENCHMARK_TIME_BUDGET);
+
+	// --- Only cases whose name contains the filter run, empty runs everything ---
+	void SetFilter(const char* filter);
+	bool IsEnabled(const char* name) const;
+
+	// --- One warm up, then iterations until both the minimum count and the time budget are met ---
+	// --- setup runs before every iteration and is not measured ---
+	void Run(const char* name, uint size, const char* unit, const std::function<void()>& body, const std::function<void()>& setup = nullptr);
+
+	const std::vector<BenchmarkResult>& GetResults() const;
+	bool Save(const char* path, uint seed) const;
+
+	// --- Checks cases make on their output, any failure fails the run ---
+	void Fail(const char* format, ...);
+	uint GetFailures() const;
+
+private:
+
+	uint min_iterations = 0;
+	uint max_iterations = 0;
+	double time_budget = 0.0;
+	std::string filter;
+	uint failures = 0;
+
+	std::vector<BenchmarkResult> results;
+};
+
+#endif
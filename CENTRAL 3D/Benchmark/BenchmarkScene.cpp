@@ -0,0 +1,240 @@
+#include "BenchmarkScene.h"
+#include "Application.h"
+#include "ModuleJobs.h"
+#include "ModuleFileSystem.h"
+#include "ModuleEventManager.h"
+#include "ModuleHardware.h"
+#include "ModuleGui.h"
+#include "ModuleResourceManager.h"
+#include "ModuleSceneManager.h"
+
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentCamera.h"
+#include "ResourceMesh.h"
+#include "ResourceScene.h"
+#include "ImporterMesh.h"
+
+#include "FrameAllocator.h"
+#include "Profiler.h"
+
+#include "mmgr/mmgr.h"
+
+BenchmarkScene::BenchmarkScene()
+{
+}
+
+BenchmarkScene::~BenchmarkScene()
+{
+}
+
+bool BenchmarkScene::Init(uint seed)
+{
+	// --- Same seed, same UIDs and same scene ---
+	App->GetRandom().Seed(seed);
+	random.Seed(seed);
+
+	json config = App->GetDefaultConfig();
+
+	// --- Application::Init order, minus input, window, renderer and everything that draws ---
+	Module* modules[] = { (Module*)App->jobs, (Module*)App->fs, (Module*)App->event_manager, (Module*)App->hardware, (Module*)App->gui, (Module*)App->resources, (Module*)App->scene_manager };
+
+	for (uint i = 0; i < sizeof(modules) / sizeof(Module*); ++i)
+	{
+		if (!modules[i]->Init(config))
+		{
+			CONSOLE_LOG("|[error]: Benchmark: could not init module %s", modules[i]->GetName());
+			return false;
+		}
+	}
+
+	App->scene_manager->currentScene = (ResourceScene*)App->resources->CreateResource(Resource::ResourceType::SCENE, SCENES_FOLDER "Benchmark.scene");
+
+	// --- Same primitive the editor creates on start, filled in place so it has no library file ---
+	cube = (ResourceMesh*)App->resources->CreateResourceGivenUID(Resource::ResourceType::MESH, "DefaultCube", 2);
+	App->scene_manager->cube = cube;
+	App->scene_manager->CreateCube(1, 1, 1, cube);
+	cube->LoadToMemory();
+
+	// --- Looking at the whole world from outside, so culling has work on both sides ---
+	camera = new ComponentCamera(nullptr);
+	camera->frustum.SetPos(float3(0.0f, 0.0f, -BENCHMARK_WORLD_EXTENT * 1.5f));
+	camera->Look(float3::zero);
+
+	for (uint i = 0; i < BENCHMARK_RAYS; ++i)
+	{
+		float3 a(RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), -BENCHMARK_WORLD_EXTENT);
+		float3 b(RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), BENCHMARK_WORLD_EXTENT);
+		rays.push_back(LineSegment(a, b));
+	}
+
+	return true;
+}
+
+void BenchmarkScene::CleanUp()
+{
+	Clear();
+
+	delete camera;
+	camera = nullptr;
+
+	// --- Reverse init order, same as Application::CleanUp ---
+	App->scene_manager->CleanUp();
+	App->resources->CleanUp();
+	App->gui->CleanUp();
+	App->event_manager->CleanUp();
+	App->fs->CleanUp();
+	App->jobs->CleanUp();
+}
+
+void BenchmarkScene::Build(uint count)
+{
+	PROFILE_FUNCTION();
+
+	Clear();
+	objects.reserve(count);
+
+	GameObject* root = App->scene_manager->GetRootGO();
+	uint group_count = 0;
+
+	while (objects.size() < count)
+	{
+		float3 position(RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT), RandomFloat(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT));
+		GameObject* group = CreateObject(root, position);
+		group_count++;
+
+		for (uint i = 1; i < BENCHMARK_GROUP_SIZE && objects.size() < count; ++i)
+			CreateObject(group, float3(RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f)));
+	}
+
+	// --- Global transforms and AABBs, static objects never update them again ---
+	root->Update(0.0f);
+
+	// --- Every other group is static, the rest is tested object by object ---
+	for (uint i = 0; i < root->childs.size(); i += 2)
+	{
+		std::vector<GameObject*> group;
+		App->scene_manager->GatherGameObjects(root->childs[i], group);
+
+		for (uint j = 0; j < group.size(); ++j)
+		{
+			group[j]->Static = true;
+			App->scene_manager->SetStatic(group[j]);
+		}
+	}
+
+	CONSOLE_LOG("Benchmark: built %u objects in %u groups", (uint)objects.size(), group_count);
+}
+
+void BenchmarkScene::Clear()
+{
+	GameObject* root = App->scene_manager->GetRootGO();
+
+	if (!root)
+		return;
+
+	// --- Deleting takes them out of the scene maps and the octree ---
+	for (uint i = 0; i < root->childs.size(); ++i)
+	{
+		if (root->childs[i])
+		{
+			root->childs[i]->RecursiveDelete();
+			delete root->childs[i];
+		}
+	}
+
+	root->childs.clear();
+	objects.clear();
+
+	// --- Loaded scenes keep static objects on the non static map until SetStatic, which deleting does not expect ---
+	App->scene_manager->currentScene->NoStaticGameObjects.clear();
+	App->scene_manager->currentScene->StaticGameObjects.clear();
+
+	App->scene_manager->SetSelectedGameObject(nullptr);
+	App->scene_manager->tree.SetBoundaries(AABB(float3(-100, -100, -100), float3(100, 100, 100)));
+}
+
+ResourceMesh* BenchmarkScene::CreateGridMesh(uint vertices)
+{
+	uint side = 2;
+
+	while (side * side < vertices)
+		side++;
+
+	ResourceMesh* mesh = (ResourceMesh*)App->resources->CreateResource(Resource::ResourceType::MESH, "BenchmarkGrid");
+	mesh->VerticesSize = side * side;
+	mesh->IndicesSize = (side - 1) * (side - 1) * 6;
+	mesh->vertices = new Vertex[mesh->VerticesSize];
+	mesh->Indices = new uint[mesh->IndicesSize];
+
+	for (uint i = 0; i < mesh->VerticesSize; ++i)
+	{
+		Vertex& vertex = mesh->vertices[i];
+		vertex.position[0] = float(i % side);
+		vertex.position[1] = RandomFloat(-0.5f, 0.5f);
+		vertex.position[2] = float(i / side);
+		vertex.normal[0] = 0.0f;
+		vertex.normal[1] = 1.0f;
+		vertex.normal[2] = 0.0f;
+		vertex.color[0] = vertex.color[1] = vertex.color[2] = vertex.color[3] = 255;
+		vertex.texCoord[0] = float(i % side) / (side - 1);
+		vertex.texCoord[1] = float(i / side) / (side - 1);
+	}
+
+	uint index = 0;
+
+	for (uint z = 0; z < side - 1; ++z)
+	{
+		for (uint x = 0; x < side - 1; ++x)
+		{
+			uint corner = z * side + x;
+			mesh->Indices[index++] = corner;
+			mesh->Indices[index++] = corner + side;
+			mesh->Indices[index++] = corner + 1;
+			mesh->Indices[index++] = corner + 1;
+			mesh->Indices[index++] = corner + side;
+			mesh->Indices[index++] = corner + side + 1;
+		}
+	}
+
+	mesh->CreateAABB();
+	App->resources->GetImporter<ImporterMesh>()->Save(mesh);
+
+	return mesh;
+}
+
+void BenchmarkScene::EndFrame()
+{
+	// --- What Application::FinishUpdate does between frames, minus drawing ---
+	App->event_manager->PreUpdate(0.0f);
+	FrameMemory::EndFrame();
+	Profiler::Get().EndFrame();
+}
+
+float BenchmarkScene::RandomFloat(float min, float max)
+{
+	return random.Float(min, max);
+}
+
+GameObject* BenchmarkScene::CreateObject(GameObject* parent, const float3& position)
+{
+	// --- Not through CreateEmptyGameObject, it parents to the root and reparenting is linear on the root's childs ---
+	GameObject* go = new GameObject("Benchmark Object");
+	App->scene_manager->currentScene->NoStaticGameObjects[go->GetUID()] = go;
+	parent->AddChildGO(go);
+
+	ComponentTransform* transform = go->GetComponent<ComponentTransform>();
+	transform->SetPosition(position.x, position.y, position.z);
+	transform->SetRotation(float3(RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f)));
+
+	float scale = RandomFloat(0.5f, 2.0f);
+	transform->Scale(scale, scale, scale);
+
+	ComponentMesh* mesh = (ComponentMesh*)go->AddComponent(Component::ComponentType::Mesh);
+	mesh->resource_mesh = (ResourceMesh*)App->resources->GetResource(cube->GetUID());
+
+	objects.push_back(go);
+
+	return go;
+}
@@ -0,0 +1,57 @@
+#ifndef __BENCHMARK_SCENE_H__
+#define __BENCHMARK_SCENE_H__
+
+#include "Globals.h"
+#include "Math.h"
+#include <vector>
+
+class GameObject;
+class ComponentCamera;
+class ResourceMesh;
+
+#define BENCHMARK_GROUP_SIZE 4 // Objects per hierarchy group, a root and its children
+#define BENCHMARK_WORLD_EXTENT 90.0f // Inside the scene manager's octree boundaries
+#define BENCHMARK_RAYS 64
+
+// --- Brings up the engine modules that do not need a window or a GL context ---
+// --- and fills the current scene with a procedural, seeded set of game objects ---
+class BenchmarkScene
+{
+public:
+
+	BenchmarkScene();
+	~BenchmarkScene();
+
+	bool Init(uint seed);
+	void CleanUp();
+
+	// --- Creates count objects in groups, every other group is static and goes into the octree ---
+	void Build(uint count);
+	void Clear();
+
+	// --- Flat grid with at least the given amount of vertices, saved to the library ---
+	ResourceMesh* CreateGridMesh(uint vertices);
+	void DestroyMesh(ResourceMesh* mesh);
+
+	void EndFrame();
+
+	// --- Always the same sequence for the same seed ---
+	float RandomFloat(float min, float max);
+
+public:
+
+	std::vector<GameObject*> objects;
+	std::vector<LineSegment> rays;
+	ComponentCamera* camera = nullptr;
+
+private:
+
+	GameObject* CreateObject(GameObject* parent, const float3& position);
+
+private:
+
+	LCG random;
+	ResourceMesh* cube = nullptr;
+};
+
+#endif
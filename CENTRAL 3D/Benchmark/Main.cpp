@@ -0,0 +1,704 @@
+#include <stdlib.h>
+#include <string.h>
+#include <filesystem>
+#include "Application.h"
+#include "Globals.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "ModuleSceneManager.h"
+#include "ModuleResourceManager.h"
+
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentCamera.h"
+#include "ResourceMesh.h"
+#include "ResourceScene.h"
+#include "ImporterMesh.h"
+#include "ImporterScene.h"
+#include "ImporterModel.h"
+#include "MeshCodec.h"
+#include "ImageDecoder.h"
+#include "Kernels.h"
+#include "FrameScheduler.h"
+#include "FrameAllocator.h"
+
+#include "Assimp/include/scene.h"
+#include "DevIL/include/il.h"
+#include "DevIL/include/ilu.h"
+
+#include <fstream>
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+#include "mmgr/mmgr.h"
+
+// --- Scene load resolves parents with a linear search per object, past this it takes minutes ---
+#define BENCHMARK_SCENE_LOAD_MAX 10000
+
+// --- How far the JPG decoder may be from DevIL's libjpeg, IDCTs and chroma upsampling round differently ---
+#define BENCHMARK_JPG_MAX_ERROR 8
+#define BENCHMARK_JPG_MEAN_ERROR 1.0
+
+// --- Frames played before the heap call count of a frame is expected to be 0, and frames checked after that ---
+#define BENCHMARK_WARM_FRAMES 8
+#define BENCHMARK_STEADY_FRAMES 32
+
+// --- Models and images the codec and decoder cases run on, set by CMake to the editor's sample assets ---
+#ifndef BENCHMARK_ASSETS_DIR
+#define BENCHMARK_ASSETS_DIR "../Game/Assets"
+#endif
+
+Application* App = NULL;
+
+struct BenchmarkOptions
+{
+	std::string out = "benchmark_results.json";
+	std::string workdir = "BenchmarkData";
+	std::string assets = BENCHMARK_ASSETS_DIR;
+	std::string filter;
+	std::vector<uint> sizes = { 1000, 10000, 100000 };
+	uint seed = 1234;
+	uint iterations = BENCHMARK_MIN_ITERATIONS;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: Benchmark [options]\n");
+	printf("  --out <file>        Results json, relative to the launch directory (default benchmark_results.json)\n");
+	printf("  --workdir <dir>     Where the engine writes its library files (default BenchmarkData)\n");
+	printf("  --assets <dir>      Models and images for the codec and decoder cases (default %s)\n", BENCHMARK_ASSETS_DIR);
+	printf("  --sizes <a,b,...>   Scene sizes in objects (default 1000,10000,100000)\n");
+	printf("  --seed <n>          Seed for the procedural scene and UIDs (default 1234)\n");
+	printf("  --filter <text>     Only run cases whose name contains text\n");
+	printf("  --iterations <n>    Minimum measured iterations per case (default %u)\n", BENCHMARK_MIN_ITERATIONS);
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+			return false;
+
+		if (!value)
+		{
+			printf("Missing value for %s\n", arg);
+			return false;
+		}
+
+		if (strcmp(arg, "--out") == 0)
+			options.out = value;
+		else if (strcmp(arg, "--workdir") == 0)
+			options.workdir = value;
+		else if (strcmp(arg, "--assets") == 0)
+			options.assets = value;
+		else if (strcmp(arg, "--filter") == 0)
+			options.filter = value;
+		else if (strcmp(arg, "--seed") == 0)
+			options.seed = strtoul(value, nullptr, 10);
+		else if (strcmp(arg, "--iterations") == 0)
+			options.iterations = strtoul(value, nullptr, 10);
+		else if (strcmp(arg, "--sizes") == 0)
+		{
+			options.sizes.clear();
+			std::string list = value;
+			size_t start = 0;
+
+			while (start < list.size())
+			{
+				size_t end = list.find(',', start);
+				end = end == std::string::npos ? list.size() : end;
+
+				uint size = strtoul(list.substr(start, end - start).c_str(), nullptr, 10);
+
+				if (size > 0)
+					options.sizes.push_back(size);
+
+				start = end + 1;
+			}
+		}
+		else
+		{
+			printf("Unknown option %s\n", arg);
+			return false;
+		}
+
+		++i;
+	}
+
+	return !options.sizes.empty();
+}
+
+// --- Checks with no timing, a failure makes the run fail ---
+static void RunSceneChecks(Benchmark& benchmark, BenchmarkScene& scene)
+{
+	ModuleSceneManager* scene_manager = App->scene_manager;
+
+	// --- A parent and its child deleted in the same frame, the child queued on both sides of the parent ---
+	if (benchmark.IsEnabled("scene_delete"))
+	{
+		scene.Build(BENCHMARK_GROUP_SIZE * 2);
+		scene.EndFrame();
+
+		GameObject* parent = scene_manager->GetRootGO()->childs[0];
+		GameObject* child = parent->childs[0];
+		uint detached = scene_manager->GetDetachedCount();
+
+		scene_manager->SetSelectedGameObject(parent);
+		scene_manager->SendToDelete(child);
+		scene_manager->SendToDelete(parent);
+		scene_manager->SendToDelete(child);
+
+		// --- The same frame order as the editor, events first ---
+		scene.EndFrame();
+		scene_manager->PreUpdate(0.0f);
+
+		if (scene_manager->GetDetachedCount() - detached != BENCHMARK_GROUP_SIZE)
+			benchmark.Fail("scene_delete detached %u objects, expected %u", scene_manager->GetDetachedCount() - detached, BENCHMARK_GROUP_SIZE);
+
+		if (scene_manager->GetRootGO()->childs.size() != 1 || scene_manager->GetSelectedGameObject() != nullptr)
+			benchmark.Fail("scene_delete left the deleted branch in the scene");
+
+		FrameScheduler::Get().Flush();
+
+		if (scene_manager->GetDetachedCount() != 0)
+			benchmark.Fail("scene_delete left %u objects unfreed", scene_manager->GetDetachedCount());
+
+		scene.Clear();
+		scene.EndFrame();
+	}
+
+	// --- Once warm, moving the scene and ending the frame should find everything in the frame arenas ---
+	if (benchmark.IsEnabled("frame_heap_calls"))
+	{
+		scene.Build(BENCHMARK_GROUP_SIZE * 64);
+		scene.EndFrame();
+
+		GameObject* root = scene_manager->GetRootGO();
+		uint frames_with_calls = 0;
+		uint64 calls = 0;
+
+		for (uint frame = 0; frame < BENCHMARK_WARM_FRAMES + BENCHMARK_STEADY_FRAMES; ++frame)
+		{
+			for (uint i = 0; i < root->childs.size(); ++i)
+				root->childs[i]->GetComponent<ComponentTransform>()->update_transform = true;
+
+			root->Update(0.0f);
+			scene.EndFrame();
+
+			if (frame >= BENCHMARK_WARM_FRAMES && FrameMemory::GetHeapCalls() > 0)
+			{
+				frames_with_calls++;
+				calls += FrameMemory::GetHeapCalls();
+			}
+		}
+
+		if (frames_with_calls > 0)
+			benchmark.Fail("frame_heap_calls: %u of %u warm frames made %llu heap calls", frames_with_calls, BENCHMARK_STEADY_FRAMES, calls);
+
+		scene.Clear();
+		scene.EndFrame();
+	}
+}
+
+static void RunSceneCases(Benchmark& benchmark, BenchmarkScene& scene, uint size)
+{
+	ModuleSceneManager* scene_manager = App->scene_manager;
+	GameObject* root = scene_manager->GetRootGO();
+	const AABB world(float3(-100, -100, -100), float3(100, 100, 100));
+
+	scene.Build(size);
+	scene.EndFrame();
+
+	// --- Octree ---
+	Quadtree tree;
+
+	benchmark.Run("octree_insert", size, "objects", [&]()
+	{
+		for (uint i = 0; i < scene.objects.size(); ++i)
+			tree.Insert(scene.objects[i]);
+	},
+	[&]() { tree.SetBoundaries(world); });
+
+	benchmark.Run("octree_erase", size, "objects", [&]()
+	{
+		for (uint i = 0; i < scene.objects.size(); ++i)
+			tree.Erase(scene.objects[i]);
+	},
+	[&]()
+	{
+		tree.SetBoundaries(world);
+
+		for (uint i = 0; i < scene.objects.size(); ++i)
+			tree.Insert(scene.objects[i]);
+	});
+
+	tree.SetBoundaries(world);
+
+	for (uint i = 0; i < scene.objects.size(); ++i)
+		tree.Insert(scene.objects[i]);
+
+	std::vector<GameObject*> hits;
+	hits.reserve(scene.objects.size());
+
+	benchmark.Run("octree_query_frustum", size, "objects", [&]()
+	{
+		hits.clear();
+		tree.CollectIntersections(hits, scene.camera->frustum);
+	});
+
+	benchmark.Run("octree_query_ray", size, "objects", [&]()
+	{
+		for (uint i = 0; i < scene.rays.size(); ++i)
+		{
+			std::map<float, GameObject*> ray_hits;
+			tree.CollectIntersections(ray_hits, scene.rays[i]);
+		}
+	});
+
+	// --- What the renderer tests for every non static object ---
+	std::vector<AABB> boxes(scene.objects.size());
+	std::vector<unsigned char> visible(scene.objects.size());
+	Plane planes[6];
+
+	benchmark.Run("frustum_culling", size, "objects", [&]()
+	{
+		hits.clear();
+
+		for (uint i = 0; i < scene.objects.size(); ++i)
+			boxes[i] = scene.objects[i]->GetAABB();
+
+		scene.camera->frustum.GetPlanes(planes);
+		Kernels::CullAABBs(planes, boxes.data(), visible.data(), boxes.size());
+
+		for (uint i = 0; i < scene.objects.size(); ++i)
+		{
+			if (visible[i])
+				hits.push_back(scene.objects[i]);
+		}
+	});
+
+	// --- Scene graph ---
+	benchmark.Run("transform_propagation", size, "objects", [&]()
+	{
+		root->Update(0.0f);
+	},
+	[&]()
+	{
+		for (uint i = 0; i < root->childs.size(); ++i)
+			root->childs[i]->GetComponent<ComponentTransform>()->update_transform = true;
+	});
+
+	benchmark.Run("select_from_ray", size, "objects", [&]()
+	{
+		for (uint i = 0; i < scene.rays.size(); ++i)
+			scene_manager->SelectFromRay(scene.rays[i]);
+	},
+	[&]() { scene.EndFrame(); });
+
+	// --- Serialization ---
+	ImporterScene* scene_importer = App->resources->GetImporter<ImporterScene>();
+
+	benchmark.Run("scene_save", size, "objects", [&]()
+	{
+		scene_importer->SaveSceneToFile(scene_manager->currentScene);
+	});
+
+	if (benchmark.IsEnabled("scene_load"))
+	{
+		if (size <= BENCHMARK_SCENE_LOAD_MAX)
+		{
+			// --- Runs last, loading replaces the procedural objects ---
+			scene_importer->SaveSceneToFile(scene_manager->currentScene);
+
+			benchmark.Run("scene_load", size, "objects", [&]()
+			{
+				scene_manager->currentScene->LoadInMemory();
+			},
+			[&]() { scene.Clear(); });
+		}
+		else
+			CONSOLE_LOG("![Warning]: Benchmark: skipping scene_load at %u objects, above BENCHMARK_SCENE_LOAD_MAX", size);
+	}
+
+	scene.Clear();
+	scene.EndFrame();
+}
+
+static void RunResourceCases(Benchmark& benchmark, BenchmarkScene& scene, uint size)
+{
+	ImporterMesh* mesh_importer = App->resources->GetImporter<ImporterMesh>();
+
+	// --- Mesh serialization, size counts vertices ---
+	if (benchmark.IsEnabled("mesh_save") || benchmark.IsEnabled("mesh_load"))
+	{
+		ResourceMesh* grid = scene.CreateGridMesh(size);
+
+		benchmark.Run("mesh_save", size, "vertices", [&]()
+		{
+			mesh_importer->Save(grid);
+		});
+
+		benchmark.Run("mesh_load", size, "vertices", [&]()
+		{
+			mesh_importer->LoadData(grid);
+		},
+		[&]()
+		{
+			// --- Loads map the file, the mesh owns the mapping from then on ---
+			grid->FreeMemory();
+		});
+	}
+
+	// --- Resource table lookups, size counts registered resources ---
+	if (benchmark.IsEnabled("resource_lookup"))
+	{
+		std::vector<uint> uids;
+		uids.reserve(size);
+
+		for (uint i = 0; i < size; ++i)
+			uids.push_back(App->resources->CreateResource(Resource::ResourceType::MESH, "BenchmarkLookup")->GetUID());
+
+		benchmark.Run("resource_lookup", size, "lookups", [&]()
+		{
+			uint found = 0;
+
+			for (uint i = 0; i < uids.size(); ++i)
+			{
+				if (App->resources->GetResource(uids[i], false))
+					found++;
+			}
+
+			if (found != uids.size())
+				benchmark.Fail("resource_lookup found %u of %u resources", found, (uint)uids.size());
+		});
+	}
+
+	scene.EndFrame();
+}
+
+// --- Library mesh codec on every mesh of the sample models, size counts vertices ---
+static void RunCodecCases(Benchmark& benchmark, const std::string& assets)
+{
+	if (!benchmark.IsEnabled("mesh_codec_roundtrip") && !benchmark.IsEnabled("mesh_codec_decode") && !benchmark.IsEnabled("mesh_raw_decode"))
+		return;
+
+	struct CodecMesh
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint> indices;
+		std::vector<unsigned char> encoded_vertices;
+		std::vector<unsigned char> encoded_indices;
+	};
+
+	std::vector<CodecMesh> meshes;
+	uint vertex_count = 0;
+	std::error_code error;
+
+	for (std::filesystem::recursive_directory_iterator it(assets, error), end; !error && it != end; it.increment(error))
+	{
+		std::string extension = it->path().extension().string();
+
+		for (uint i = 0; i < extension.size(); ++i)
+			extension[i] = (char)tolower(extension[i]);
+
+		if (extension != ".fbx" && extension != ".obj")
+			continue;
+
+		const aiScene* ai_scene = ImporterModel::ImportScene(it->path().string().c_str());
+
+		if (ai_scene == nullptr)
+			continue;
+
+		for (uint i = 0; i < ai_scene->mNumMeshes; ++i)
+		{
+			const aiMesh* ai_mesh = ai_scene->mMeshes[i];
+			meshes.push_back(CodecMesh());
+			CodecMesh& mesh = meshes.back();
+
+			mesh.vertices.resize(ai_mesh->mNumVertices);
+			Kernels::PackVertices((const float*)ai_mesh->mVertices, ai_mesh->HasNormals() ? (const float*)ai_mesh->mNormals : nullptr,
+				ai_mesh->HasTextureCoords(0) ? (const float*)ai_mesh->mTextureCoords[0] : nullptr, mesh.vertices.data(), ai_mesh->mNumVertices);
+
+			for (uint j = 0; j < ai_mesh->mNumFaces; ++j)
+			{
+				if (ai_mesh->mFaces[j].mNumIndices == 3)
+					mesh.indices.insert(mesh.indices.end(), ai_mesh->mFaces[j].mIndices, ai_mesh->mFaces[j].mIndices + 3);
+			}
+
+			MeshCodec::EncodeVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), mesh.encoded_vertices);
+			MeshCodec::EncodeIndices(mesh.indices.data(), mesh.indices.size(), mesh.encoded_indices);
+			vertex_count += mesh.vertices.size();
+		}
+
+		ImporterModel::ReleaseScene(ai_scene);
+	}
+
+	if (meshes.empty())
+	{
+		CONSOLE_LOG("![Warning]: Benchmark: no models in %s, skipping the mesh codec cases", assets.c_str());
+		return;
+	}
+
+	uint64 raw_bytes = 0;
+	uint64 encoded_bytes = 0;
+	uint largest = 0;
+
+	for (uint i = 0; i < meshes.size(); ++i)
+	{
+		raw_bytes += meshes[i].vertices.size() * sizeof(Vertex) + meshes[i].indices.size() * sizeof(uint);
+		encoded_bytes += meshes[i].encoded_vertices.size() + meshes[i].encoded_indices.size();
+		largest = meshes[i].vertices.size() > largest ? meshes[i].vertices.size() : largest;
+	}
+
+	// --- Sized for the largest mesh, every case writes its meshes here one after another ---
+	std::vector<Vertex> vertices(largest);
+	std::vector<uint> indices;
+
+	for (uint i = 0; i < meshes.size(); ++i)
+		indices.resize(meshes[i].indices.size() > indices.size() ? meshes[i].indices.size() : indices.size());
+
+	benchmark.Run("mesh_codec_roundtrip", vertex_count, "vertices", [&]()
+	{
+		for (uint i = 0; i < meshes.size(); ++i)
+		{
+			CodecMesh& mesh = meshes[i];
+			std::vector<unsigned char> encoded;
+			MeshCodec::EncodeVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), encoded);
+
+			bool ok = MeshCodec::DecodeVertices(encoded.data(), encoded.size(), vertices.data(), mesh.vertices.size(), sizeof(Vertex))
+				&& memcmp(vertices.data(), mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex)) == 0;
+
+			encoded.clear();
+			MeshCodec::EncodeIndices(mesh.indices.data(), mesh.indices.size(), encoded);
+
+			ok = ok && MeshCodec::DecodeIndices(encoded.data(), encoded.size(), indices.data(), mesh.indices.size())
+				&& memcmp(indices.data(), mesh.indices.data(), mesh.indices.size() * sizeof(uint)) == 0;
+
+			if (!ok)
+				benchmark.Fail("mesh %u did not survive the codec round trip", i);
+		}
+	});
+
+	benchmark.Run("mesh_codec_decode", vertex_count, "vertices", [&]()
+	{
+		for (uint i = 0; i < meshes.size(); ++i)
+		{
+			MeshCodec::DecodeVertices(meshes[i].encoded_vertices.data(), meshes[i].encoded_vertices.size(), vertices.data(), meshes[i].vertices.size(), sizeof(Vertex));
+			MeshCodec::DecodeIndices(meshes[i].encoded_indices.data(), meshes[i].encoded_indices.size(), indices.data(), meshes[i].indices.size());
+		}
+	});
+
+	double decode_ms = benchmark.IsEnabled("mesh_codec_decode") ? benchmark.GetResults().back().median : 0.0;
+
+	// --- What a load of the raw format does with the same bytes ---
+	benchmark.Run("mesh_raw_decode", vertex_count, "vertices", [&]()
+	{
+		for (uint i = 0; i < meshes.size(); ++i)
+		{
+			memcpy(vertices.data(), meshes[i].vertices.data(), meshes[i].vertices.size() * sizeof(Vertex));
+			memcpy(indices.data(), meshes[i].indices.data(), meshes[i].indices.size() * sizeof(uint));
+		}
+	});
+
+	double raw_ms = benchmark.IsEnabled("mesh_raw_decode") ? benchmark.GetResults().back().median : 0.0;
+
+	CONSOLE_LOG("Benchmark: mesh codec on %u meshes, %llu bytes raw, %llu coded, ratio %.2f", (uint)meshes.size(), raw_bytes, encoded_bytes, (double)raw_bytes / encoded_bytes);
+
+	if (decode_ms > 0.0 && raw_ms > 0.0)
+		CONSOLE_LOG("Benchmark: mesh codec decodes %.2f GB/s, raw copies %.2f GB/s", raw_bytes / (decode_ms * 1000000.0), raw_bytes / (raw_ms * 1000000.0));
+}
+
+// --- The engine's PNG and JPG decoders checked against DevIL on the sample images, size counts pixels ---
+static void RunImageCases(Benchmark& benchmark, const std::string& assets)
+{
+	if (!benchmark.IsEnabled("image_decode") && !benchmark.IsEnabled("image_decode_devil"))
+		return;
+
+	// --- Only DevIL's core, ModuleTextures is not started without a GL context ---
+	ilInit();
+	iluInit();
+
+	ImageDecoderPNG png;
+	ImageDecoderJPG jpg;
+	ImageDecoderDevIL devil;
+
+	struct SampleImage
+	{
+		std::string path;
+		std::vector<unsigned char> data;
+		const ImageDecoder* decoder = nullptr;
+		ImageInfo info;
+	};
+
+	std::vector<SampleImage> images;
+	uint pixels = 0;
+	std::error_code error;
+
+	for (std::filesystem::recursive_directory_iterator it(assets, error), end; !error && it != end; it.increment(error))
+	{
+		std::string extension = it->path().extension().string();
+
+		for (uint i = 0; i < extension.size(); ++i)
+			extension[i] = (char)tolower(extension[i]);
+
+		extension = extension.empty() ? extension : extension.substr(1);
+
+		if (extension != "png" && extension != "jpg" && extension != "jpeg")
+			continue;
+
+		SampleImage image;
+		image.path = it->path().string();
+
+		std::ifstream file(image.path, std::ios::binary);
+		image.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		image.decoder = png.CanDecode(image.data.data(), image.data.size(), extension.c_str()) ? (const ImageDecoder*)&png : (const ImageDecoder*)&jpg;
+
+		ImageInfo devil_info;
+
+		// --- ModuleTextures hands what the decoders reject to DevIL, not a failure ---
+		if (!image.decoder->CanDecode(image.data.data(), image.data.size(), extension.c_str()) || !image.decoder->ReadInfo(image.data.data(), image.data.size(), image.info))
+		{
+			CONSOLE_LOG("![Warning]: Benchmark: %s decoder does not take %s, DevIL loads it", image.decoder->GetName(), image.path.c_str());
+			continue;
+		}
+
+		if (!devil.ReadInfo(image.data.data(), image.data.size(), devil_info) || devil_info.width != image.info.width || devil_info.height != image.info.height)
+		{
+			benchmark.Fail("%s is %ux%u, DevIL reads %ux%u", image.path.c_str(), image.info.width, image.info.height, devil_info.width, devil_info.height);
+			continue;
+		}
+
+		// --- Same pixels, PNG is lossless so exactly the same ---
+		std::vector<unsigned char> decoded((size_t)image.info.size);
+		std::vector<unsigned char> reference((size_t)image.info.size);
+
+		if (!image.decoder->Decode(image.data.data(), image.data.size(), image.info, decoded.data()) || !devil.Decode(image.data.data(), image.data.size(), image.info, reference.data()))
+		{
+			benchmark.Fail("could not decode %s", image.path.c_str());
+			continue;
+		}
+
+		uint max_error = 0;
+		uint64 total_error = 0;
+
+		for (uint i = 0; i < decoded.size(); ++i)
+		{
+			uint difference = decoded[i] > reference[i] ? decoded[i] - reference[i] : reference[i] - decoded[i];
+			max_error = difference > max_error ? difference : max_error;
+			total_error += difference;
+		}
+
+		double mean_error = decoded.empty() ? 0.0 : (double)total_error / decoded.size();
+		bool lossless = image.decoder == &png;
+
+		if (lossless ? max_error != 0 : (max_error > BENCHMARK_JPG_MAX_ERROR || mean_error > BENCHMARK_JPG_MEAN_ERROR))
+			benchmark.Fail("%s differs from DevIL, max %u mean %.3f", image.path.c_str(), max_error, mean_error);
+		else
+			CONSOLE_LOG("Benchmark: %s matches DevIL, max %u mean %.3f", image.path.c_str(), max_error, mean_error);
+
+		pixels += image.info.width * image.info.height;
+		images.push_back(image);
+	}
+
+	if (images.empty())
+	{
+		CONSOLE_LOG("![Warning]: Benchmark: no PNG or JPG images in %s, skipping the image cases", assets.c_str());
+		return;
+	}
+
+	std::vector<unsigned char> out;
+
+	for (uint i = 0; i < images.size(); ++i)
+		out.resize(images[i].info.size > out.size() ? (size_t)images[i].info.size : out.size());
+
+	benchmark.Run("image_decode", pixels, "pixels", [&]()
+	{
+		for (uint i = 0; i < images.size(); ++i)
+			images[i].decoder->Decode(images[i].data.data(), images[i].data.size(), images[i].info, out.data());
+	});
+
+	benchmark.Run("image_decode_devil", pixels, "pixels", [&]()
+	{
+		for (uint i = 0; i < images.size(); ++i)
+			devil.Decode(images[i].data.data(), images[i].data.size(), images[i].info, out.data());
+	});
+}
+
+int main(int argc, char** argv)
+{
+	Logger::Get().Start();
+	PROFILE_THREAD("Main Thread");
+
+	BenchmarkOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		Logger::Get().Stop();
+		return EXIT_FAILURE;
+	}
+
+	// --- The file system writes under the working directory, keep the library files out of the launch dir ---
+	std::error_code error;
+	std::filesystem::path out_path = std::filesystem::absolute(options.out, error);
+	std::string assets_path = std::filesystem::absolute(options.assets, error).string();
+	std::filesystem::create_directories(options.workdir, error);
+	std::filesystem::current_path(options.workdir, error);
+
+	if (error)
+	{
+		CONSOLE_LOG("|[error]: Benchmark: could not use %s as working directory: %s", options.workdir.c_str(), error.message().c_str());
+		Logger::Get().Stop();
+		return EXIT_FAILURE;
+	}
+
+	CONSOLE_LOG("Starting benchmark for '%s', seed %u", TITLE, options.seed);
+
+	App = new Application();
+
+	BenchmarkScene scene;
+	int main_return = EXIT_FAILURE;
+
+	if (scene.Init(options.seed))
+	{
+		Benchmark benchmark(options.iterations);
+		benchmark.SetFilter(options.filter.c_str());
+
+		RunSceneChecks(benchmark, scene);
+
+		for (uint i = 0; i < options.sizes.size(); ++i)
+		{
+			RunSceneCases(benchmark, scene, options.sizes[i]);
+			RunResourceCases(benchmark, scene, options.sizes[i]);
+		}
+
+		RunCodecCases(benchmark, assets_path);
+		RunImageCases(benchmark, assets_path);
+
+		if (benchmark.Save(out_path.string().c_str(), options.seed))
+		{
+			CONSOLE_LOG("Benchmark: %u results saved to %s", (uint)benchmark.GetResults().size(), out_path.string().c_str());
+			main_return = EXIT_SUCCESS;
+		}
+		else
+			CONSOLE_LOG("|[error]: Benchmark: could not save results to %s", out_path.string().c_str());
+
+		if (benchmark.GetFailures() > 0)
+		{
+			CONSOLE_LOG("|[error]: Benchmark: %u checks failed", benchmark.GetFailures());
+			main_return = EXIT_FAILURE;
+		}
+	}
+
+	scene.CleanUp();
+	delete App;
+
+	Logger::Get().Stop();
+
+	return main_return;
+}
@@ -0,0 +1,431 @@
+#include "Allocator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#if MEMORY_MMGR
+#include "mmgr/mmgr.h"
+#include "mmgr/nommgr.h"
+#endif
+
+// --- No mmgr here, this is what replaces it and its macros would route our own blocks through it ---
+
+#if MEMORY_DEBUG
+#define MEMORY_GUARD MEMORY_GUARD_SIZE
+#define MEMORY_GUARD_BYTE 0xFD
+#define MEMORY_MAGIC 0xA110CA7E
+#else
+#define MEMORY_GUARD 0
+#endif
+
+// --- Sits right before the user block (and its front guard in debug mode) ---
+struct AllocationHeader
+{
+	size_t size;
+	uint tag;
+	uint offset; // From the start of the backing block to the user block
+
+#if MEMORY_DEBUG
+	AllocationHeader* next;
+	AllocationHeader* prev;
+	const char* file;
+	int line;
+	uint64 number;
+	uint magic;
+#endif
+};
+
+static inline AllocationHeader* GetHeader(void* ptr)
+{
+	return (AllocationHeader*)((char*)ptr - MEMORY_GUARD - sizeof(AllocationHeader));
+}
+
+// --- Each thread gets its own set of counters, the last set is shared by any extra threads ---
+static std::atomic<int> memory_thread_count(0);
+static thread_local int memory_thread = -1;
+
+static inline int GetThreadSlot()
+{
+	if (memory_thread < 0)
+	{
+		int slot = memory_thread_count.fetch_add(1);
+		memory_thread = slot < MEMORY_MAX_THREADS - 1 ? slot : MEMORY_MAX_THREADS - 1;
+	}
+
+	return memory_thread;
+}
+
+// --- Calls that reached the system allocator, per thread so counting never contends ---
+struct alignas(64) HeapCallCounter
+{
+	std::atomic<uint64> calls;
+};
+
+static HeapCallCounter heap_calls[MEMORY_MAX_THREADS];
+
+static inline void CountHeapCall()
+{
+	heap_calls[GetThreadSlot()].calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- SystemAllocator ---
+
+void* SystemAllocator::Allocate(size_t size)
+{
+	CountHeapCall();
+	return malloc(size);
+}
+
+void SystemAllocator::Free(void* ptr)
+{
+	free(ptr);
+}
+
+// --- Heaps and the default allocator are never destroyed, objects may be freed during static destruction ---
+static Allocator* GetSystemAllocator()
+{
+	alignas(SystemAllocator) static char storage[sizeof(SystemAllocator)];
+	static Allocator* allocator = new (storage) SystemAllocator();
+	return allocator;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- TaggedHeap ---
+
+TaggedHeap::TaggedHeap(MemoryTag tag) : tag(tag)
+{
+	backing = GetSystemAllocator();
+	sampled_peak = 0;
+
+	for (uint i = 0; i < MEMORY_MAX_THREADS; ++i)
+	{
+		counters[i].bytes = 0;
+		counters[i].peak = 0;
+		counters[i].allocations = 0;
+		counters[i].frees = 0;
+	}
+}
+
+void* TaggedHeap::Allocate(size_t size, size_t alignment, const char* file, int line)
+{
+	if (alignment < MEMORY_DEFAULT_ALIGNMENT)
+		alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+	char* raw = (char*)backing->Allocate(sizeof(AllocationHeader) + MEMORY_GUARD * 2 + size + alignment);
+
+	if (!raw)
+		return nullptr;
+
+	// --- Align the user block, header goes right before it ---
+	size_t user = (size_t)(raw + sizeof(AllocationHeader) + MEMORY_GUARD);
+	user = (user + alignment - 1) & ~(alignment - 1);
+
+	AllocationHeader* header = GetHeader((void*)user);
+	header->size = size;
+	header->tag = (uint)tag;
+	header->offset = (uint)((char*)user - raw);
+
+#if MEMORY_DEBUG
+	header->file = file;
+	header->line = line;
+	header->magic = MEMORY_MAGIC;
+
+	memset((char*)user - MEMORY_GUARD, MEMORY_GUARD_BYTE, MEMORY_GUARD);
+	memset((char*)user + size, MEMORY_GUARD_BYTE, MEMORY_GUARD);
+
+	{
+		std::lock_guard<std::mutex> lock(live_mutex);
+		header->number = allocation_number++;
+		header->prev = nullptr;
+		header->next = live;
+
+		if (live)
+			live->prev = header;
+
+		live = header;
+	}
+#endif
+
+	Count((long long)size, true);
+
+	return (void*)user;
+}
+
+void TaggedHeap::Free(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	AllocationHeader* header = GetHeader(ptr);
+
+#if MEMORY_DEBUG
+	if (header->magic != MEMORY_MAGIC)
+	{
+		CONSOLE_LOG("|[error]: Memory: freeing a block not allocated by the %s heap, leaking it instead", Memory::GetTagName(tag));
+		return;
+	}
+
+	// --- Check nobody wrote past the block ---
+	unsigned char* front = (unsigned char*)ptr - MEMORY_GUARD;
+	unsigned char* back = (unsigned char*)ptr + header->size;
+
+	for (uint i = 0; i < MEMORY_GUARD; ++i)
+	{
+		if (front[i] != MEMORY_GUARD_BYTE || back[i] != MEMORY_GUARD_BYTE)
+		{
+			CONSOLE_LOG("|[error]: Memory: %s block of %u bytes from %s(%d) was overrun", Memory::GetTagName(tag), (uint)header->size, header->file ? header->file : "unknown", header->line);
+			break;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(live_mutex);
+
+		if (header->prev)
+			header->prev->next = header->next;
+		else
+			live = header->next;
+
+		if (header->next)
+			header->next->prev = header->prev;
+	}
+
+	header->magic = 0;
+#endif
+
+	Count(-(long long)header->size, false);
+
+	backing->Free((char*)ptr - header->offset);
+}
+
+bool TaggedHeap::SetBackingAllocator(Allocator* allocator)
+{
+	if (GetStats().live_blocks != 0)
+	{
+		CONSOLE_LOG("![Warning]: Memory: cannot change the allocator of the %s heap while it has live blocks", Memory::GetTagName(tag));
+		return false;
+	}
+
+	backing = allocator ? allocator : GetSystemAllocator();
+	return true;
+}
+
+Allocator* TaggedHeap::GetBackingAllocator() const
+{
+	return backing;
+}
+
+MemoryTag TaggedHeap::GetTag() const
+{
+	return tag;
+}
+
+MemoryStats TaggedHeap::GetStats() const
+{
+	MemoryStats stats;
+
+	for (uint i = 0; i < MEMORY_MAX_THREADS; ++i)
+	{
+		stats.bytes += counters[i].bytes.load(std::memory_order_relaxed);
+		stats.thread_peak_bytes += counters[i].peak.load(std::memory_order_relaxed);
+		stats.allocations += counters[i].allocations.load(std::memory_order_relaxed);
+		stats.frees += counters[i].frees.load(std::memory_order_relaxed);
+	}
+
+	stats.live_blocks = stats.allocations - stats.frees;
+
+	// --- Global peak is only as precise as how often stats are read ---
+	long long peak = sampled_peak.load();
+
+	while (stats.bytes > peak && !sampled_peak.compare_exchange_weak(peak, stats.bytes)) {}
+
+	stats.peak_bytes = stats.bytes > peak ? stats.bytes : peak;
+
+	return stats;
+}
+
+uint TaggedHeap::ReportLeaks() const
+{
+	uint count = 0;
+
+#if MEMORY_DEBUG
+	std::lock_guard<std::mutex> lock(live_mutex);
+
+	for (AllocationHeader* header = live; header; header = header->next)
+	{
+		// --- Don't flood the console, the total is what matters past a few ---
+		if (count < 20)
+			CONSOLE_LOG("|[error]: Memory leak on %s heap: %u bytes, allocation %u from %s(%d)", Memory::GetTagName(tag), (uint)header->size, (uint)header->number, header->file ? header->file : "unknown", header->line);
+
+		count++;
+	}
+
+	if (count > 0)
+		CONSOLE_LOG("|[error]: %u blocks leaked on %s heap", count, Memory::GetTagName(tag));
+#endif
+
+	return count;
+}
+
+void TaggedHeap::Count(long long bytes, bool allocation)
+{
+	int slot = GetThreadSlot();
+	Counters& c = counters[slot];
+
+	// --- Own counters, no one else writes them so a plain load/store is enough ---
+	if (slot < MEMORY_MAX_THREADS - 1)
+	{
+		long long current = c.bytes.load(std::memory_order_relaxed) + bytes;
+		c.bytes.store(current, std::memory_order_relaxed);
+
+		if (current > c.peak.load(std::memory_order_relaxed))
+			c.peak.store(current, std::memory_order_relaxed);
+
+		if (allocation)
+			c.allocations.store(c.allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		else
+			c.frees.store(c.frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	else
+	{
+		long long current = c.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		long long peak = c.peak.load(std::memory_order_relaxed);
+
+		while (current > peak && !c.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+
+		if (allocation)
+			c.allocations.fetch_add(1, std::memory_order_relaxed);
+		else
+			c.frees.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- Memory ---
+
+TaggedHeap& Memory::GetHeap(MemoryTag tag)
+{
+	alignas(TaggedHeap) static char storage[sizeof(TaggedHeap) * (uint)MemoryTag::count];
+
+	static TaggedHeap* heaps = []()
+	{
+		TaggedHeap* ret = (TaggedHeap*)storage;
+
+		for (uint i = 0; i < (uint)MemoryTag::count; ++i)
+			new (&ret[i]) TaggedHeap((MemoryTag)i);
+
+		return ret;
+	}();
+
+	return heaps[(uint)tag];
+}
+
+void* Memory::Allocate(MemoryTag tag, size_t size, size_t alignment, const char* file, int line)
+{
+	return GetHeap(tag).Allocate(size, alignment, file, line);
+}
+
+void Memory::Free(void* ptr)
+{
+	if (ptr)
+		GetHeap((MemoryTag)GetHeader(ptr)->tag).Free(ptr);
+}
+
+uint Memory::ReportLeaks()
+{
+	uint count = 0;
+
+	for (uint i = 0; i < (uint)MemoryTag::count; ++i)
+		count += GetHeap((MemoryTag)i).ReportLeaks();
+
+	return count;
+}
+
+const char* Memory::GetTagName(MemoryTag tag)
+{
+	static const char* names[] = { "Scene", "Resources", "Render", "Import", "Editor", "Transient" };
+	static_assert(sizeof(names) / sizeof(names[0]) == (uint)MemoryTag::count, "Memory tag names need to be updated!");
+
+	return names[(uint)tag];
+}
+
+uint64 Memory::GetHeapCalls()
+{
+	uint64 ret = 0;
+
+	for (uint i = 0; i < MEMORY_MAX_THREADS; ++i)
+		ret += heap_calls[i].calls.load(std::memory_order_relaxed);
+
+#if MEMORY_MMGR
+	// --- mmgr owns the global new in these builds, it keeps its own count ---
+	ret += m_getMemoryStatistics().accumulatedAllocUnitCount;
+#endif
+
+	return ret;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- Global new ---
+
+// --- Builds without mmgr route the global new through here so untagged allocations (STL, strings) are counted too ---
+#if !MEMORY_MMGR
+
+void* operator new(size_t size)
+{
+	CountHeapCall();
+	void* ret = malloc(size ? size : 1);
+
+	if (!ret)
+		throw std::bad_alloc();
+
+	return ret;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	CountHeapCall();
+	return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+#endif
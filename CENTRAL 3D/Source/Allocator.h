@@ -0,0 +1,173 @@
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <mutex>
+#include <stddef.h>
+
+// --- Debug mode adds guard bytes around every block and keeps a list of live blocks for leak reports ---
+#ifndef MEMORY_DEBUG
+#ifdef _DEBUG
+#define MEMORY_DEBUG 1
+#else
+#define MEMORY_DEBUG 0
+#endif
+#endif
+
+// --- mmgr replaces the global new in these builds (see mmgr/mmgr.h) ---
+#if defined(_DEBUG) && !defined(NO_MMGR)
+#define MEMORY_MMGR 1
+#else
+#define MEMORY_MMGR 0
+#endif
+
+#define MEMORY_MAX_THREADS 32 // Threads past this share a set of counters
+#define MEMORY_GUARD_SIZE 16
+#define MEMORY_DEFAULT_ALIGNMENT 16
+
+enum class MemoryTag
+{
+	Scene,
+	Resources,
+	Render,
+	Import,
+	Editor,
+	Transient,
+	count
+};
+
+// --- Where heaps get their memory from, swap it before the heap is used ---
+class Allocator
+{
+public:
+	virtual ~Allocator() {}
+
+	virtual void* Allocate(size_t size) = 0;
+	virtual void Free(void* ptr) = 0;
+	virtual const char* GetName() const = 0;
+};
+
+class SystemAllocator : public Allocator
+{
+public:
+	void* Allocate(size_t size) override;
+	void Free(void* ptr) override;
+	const char* GetName() const override { return "System"; }
+};
+
+struct MemoryStats
+{
+	long long bytes = 0; // Currently allocated
+	long long peak_bytes = 0; // Highest sampled value of bytes
+	long long thread_peak_bytes = 0; // Sum of per thread watermarks, cheap upper bound kept on every allocation
+	long long allocations = 0; // Total calls
+	long long frees = 0;
+	long long live_blocks = 0;
+};
+
+// --- Counts what a subsystem owns, each thread writes its own counters so allocating never contends ---
+class TaggedHeap
+{
+public:
+
+	TaggedHeap(MemoryTag tag);
+
+	void* Allocate(size_t size, size_t alignment = MEMORY_DEFAULT_ALIGNMENT, const char* file = nullptr, int line = 0);
+	void Free(void* ptr);
+
+	bool SetBackingAllocator(Allocator* allocator); // Fails if the heap has live blocks
+	Allocator* GetBackingAllocator() const;
+	MemoryTag GetTag() const;
+	MemoryStats GetStats() const;
+
+	// --- Debug mode only, logs every live block and returns how many there were ---
+	uint ReportLeaks() const;
+
+private:
+
+	struct alignas(64) Counters
+	{
+		std::atomic<long long> bytes;
+		std::atomic<long long> peak;
+		std::atomic<long long> allocations;
+		std::atomic<long long> frees;
+	};
+
+	void Count(long long bytes, bool allocation);
+
+private:
+
+	MemoryTag tag;
+	Allocator* backing = nullptr;
+	Counters counters[MEMORY_MAX_THREADS];
+	mutable std::atomic<long long> sampled_peak;
+
+#if MEMORY_DEBUG
+	struct AllocationHeader* live = nullptr;
+	mutable std::mutex live_mutex;
+	uint64 allocation_number = 0;
+#endif
+};
+
+// --- Entry point for engine code ---
+class Memory
+{
+public:
+
+	static TaggedHeap& GetHeap(MemoryTag tag);
+	static void* Allocate(MemoryTag tag, size_t size, size_t alignment = MEMORY_DEFAULT_ALIGNMENT, const char* file = nullptr, int line = 0);
+	static void Free(void* ptr); // The block knows its heap
+	static uint ReportLeaks();
+	static const char* GetTagName(MemoryTag tag);
+	static uint64 GetHeapCalls(); // Since startup, every thread: engine heaps plus the global new
+};
+
+#define ENGINE_ALLOC(tag, size) Memory::Allocate(tag, size, MEMORY_DEFAULT_ALIGNMENT, __FILE__, __LINE__)
+#define ENGINE_FREE(ptr) Memory::Free(ptr)
+
+// --- Put inside a class so it and everything deriving from it is allocated on the given heap ---
+#define MEMORY_TAG(tag) \
+	static void* operator new(size_t size) { return Memory::Allocate(tag, size, MEMORY_DEFAULT_ALIGNMENT, __FILE__, __LINE__); } \
+	static void* operator new[](size_t size) { return Memory::Allocate(tag, size, MEMORY_DEFAULT_ALIGNMENT, __FILE__, __LINE__); } \
+	static void* operator new(size_t size, void* where) { return where; } \
+	static void operator delete(void* ptr) { Memory::Free(ptr); } \
+	static void operator delete[](void* ptr) { Memory::Free(ptr); } \
+	static void operator delete(void* ptr, void* where) {}
+
+// --- STL adapter, std::vector<T, TaggedAllocator<T, MemoryTag::Render>> ---
+template<typename T, MemoryTag TAG>
+class TaggedAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef TaggedAllocator<U, TAG> other;
+	};
+
+	TaggedAllocator() {}
+
+	template<typename U>
+	TaggedAllocator(const TaggedAllocator<U, TAG>&) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(Memory::Allocate(TAG, count * sizeof(T), alignof(T) > MEMORY_DEFAULT_ALIGNMENT ? alignof(T) : MEMORY_DEFAULT_ALIGNMENT));
+	}
+
+	void deallocate(T* ptr, size_t)
+	{
+		Memory::Free(ptr);
+	}
+
+	template<typename U>
+	bool operator==(const TaggedAllocator<U, TAG>&) const { return true; }
+
+	template<typename U>
+	bool operator!=(const TaggedAllocator<U, TAG>&) const { return false; }
+};
+
+#endif
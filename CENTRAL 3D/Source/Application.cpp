@@ -11,15 +11,25 @@
 #include "ModuleRenderer3D.h"
 #include "ModuleTextures.h"
 #include "ModuleResourceManager.h"
+#include "ModuleJobs.h"
+#include "FrameAllocator.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "FrameScheduler.h"
+#include "ScenarioRunner.h"
 
 #include "Optick/include/optick.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
 #include "mmgr/mmgr.h"
 
 Application::Application()
 {
 	appName = "";
-	log = "Application Logs:";
 	configpath = "Settings/EditorConfig.json";
 	RandomNumber = new math::LCG();
 
@@ -35,12 +45,14 @@ Application::Application()
 	gui = new ModuleGui(true);
 	textures = new ModuleTextures(true);
 	resources = new ModuleResourceManager(true);
+	jobs = new ModuleJobs(true);
 
 	// The order of calls is very important!
 	// Modules will Init() Start() and Update in this order
 	// They will CleanUp() in reverse order
 
 	// Main Modules
+	AddModule(jobs); // first so it is available to every module and cleaned up last
 	AddModule(fs);
 	AddModule(event_manager);
 	AddModule(input);
@@ -60,6 +72,31 @@ Application::Application()
 
 	// Renderer last!
 	AddModule(renderer3D);
+
+	// --- Startup graph. Init and Start of modules that do not wait on each other overlap, see RunStartupPhase ---
+	// --- SDL video, DevIL's GL renderer and anything touching GL stay on the main thread ---
+	fs->SetStartup(ModulePhase::Init, ModuleThread::Any);
+	event_manager->SetStartup(ModulePhase::Init, ModuleThread::Any);
+	time->SetStartup(ModulePhase::Init, ModuleThread::Any);
+	hardware->SetStartup(ModulePhase::Init, ModuleThread::Any);
+	resources->SetStartup(ModulePhase::Init, ModuleThread::Any);
+	gui->SetStartup(ModulePhase::Init, ModuleThread::Any, { event_manager }); // Panels register listeners
+	window->SetStartup(ModulePhase::Init, ModuleThread::Main, { time }); // Caps the framerate
+
+	// --- Camera, scene manager and renderer draw UIDs from the app's generator, kept in this order so they do not change between runs ---
+	// --- Game objects go through the kernels hardware selects ---
+	scene_manager->SetStartup(ModulePhase::Init, ModuleThread::Main, { event_manager, gui, hardware, camera });
+	renderer3D->SetStartup(ModulePhase::Init, ModuleThread::Main, { window, textures, resources, camera, scene_manager });
+
+	// --- Every Start runs after every Init, most of them upload to GL ---
+	jobs->SetStartup(ModulePhase::Start, ModuleThread::Any);
+	fs->SetStartup(ModulePhase::Start, ModuleThread::Any);
+	event_manager->SetStartup(ModulePhase::Start, ModuleThread::Any);
+	time->SetStartup(ModulePhase::Start, ModuleThread::Main); // Asks SDL video for the refresh rate
+	hardware->SetStartup(ModulePhase::Start, ModuleThread::Any);
+	camera->SetStartup(ModulePhase::Start, ModuleThread::Any);
+	resources->SetStartup(ModulePhase::Start, ModuleThread::Main, { textures });
+	scene_manager->SetStartup(ModulePhase::Start, ModuleThread::Main, { resources });
 }
 
 Application::~Application()
@@ -77,6 +114,12 @@ Application::~Application()
 		delete RandomNumber;
 		RandomNumber = nullptr;
 	}
+
+	if (scenario)
+	{
+		delete scenario;
+		scenario = nullptr;
+	}
 }
 
 bool Application::Init()
@@ -99,27 +142,24 @@ bool Application::Init()
 	std::string tmp2 = config["Application"]["Organization"];
 	orgName = tmp2;
 
-	// Call Init() in all modules
-
-	std::list<Module*>::const_iterator item = list_modules.begin();
+	// --- The job system runs the startup graph, so it comes up first on its own ---
+	ret = jobs->Init(config);
 
-	while(item != list_modules.end() && ret == true)
-	{
-		ret = (*item)->Init(config);
-		item++;
-	}
+	// Call Init() in all modules
+	if (ret)
+		ret = RunStartupPhase(ModulePhase::Init, config);
 
 	// After all Init calls we call Start() in all modules
 	CONSOLE_LOG("Application Start --------------");
-	item = list_modules.begin();
 
-	while(item != list_modules.end() && ret == true)
-	{
-		ret = (*item)->Start();
-		item++;
-	}
+	if (ret)
+		ret = RunStartupPhase(ModulePhase::Start, config);
+
+	// --- Headless frames run as fast as they can ---
+	time->SetMaxFramerate(headless ? 0 : time->GetRefreshRate());
 
-	time->SetMaxFramerate(App->window->GetDisplayRefreshRate());
+	if (ret && scenario)
+		ret = scenario->Start();
 
 	return ret;
 }
@@ -128,12 +168,28 @@ bool Application::Init()
 void Application::PrepareUpdate()
 {
 	time->PrepareUpdate();
+
+	// --- Recorded camera and input for this frame, before any module reads them ---
+	if (scenario)
+		scenario->BeginFrame();
 }
 
 // ---------------------------------------------
 void Application::FinishUpdate()
 {
 	time->FinishUpdate();
+
+	// --- Frame scratch memory from two frames ago is released ---
+	FrameMemory::EndFrame();
+
+	// --- Close the profiler frame, scopes recorded by any thread until now belong to it ---
+	Profiler::Get().EndFrame();
+
+	// --- Frame and module times, percentiles and hitches ---
+	FrameStats::Get().EndFrame();
+
+	if (scenario)
+		scenario->EndFrame();
 }
 
 void Application::SaveAllStatus()
@@ -193,38 +249,75 @@ update_status Application::Update()
 	
 	std::list<Module*>::const_iterator item = list_modules.begin();
 
+	{
+		PROFILE_SCOPE("PreUpdate");
+
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
+		{
+			PROFILE_SCOPE((*item)->GetName());
+			ret = (*item)->PreUpdate(time->GetRealTimeDt());
+			item++;
+		}
+	}
 
-	while(item != list_modules.end() && ret == UPDATE_CONTINUE)
+	// --- Fixed timestep simulation, as many steps as the accumulated game time asks for ---
+	if (ret == UPDATE_CONTINUE && time->GetFixedTimestep() > 0.0f)
 	{
-		ret = (*item)->PreUpdate(time->GetRealTimeDt());
-		item++;
+		PROFILE_SCOPE("FixedUpdate");
+
+		while (ret == UPDATE_CONTINUE && time->ConsumeFixedStep())
+		{
+			for (item = list_modules.begin(); item != list_modules.end() && ret == UPDATE_CONTINUE; ++item)
+			{
+				PROFILE_SCOPE((*item)->GetName());
+				ret = (*item)->FixedUpdate(time->GetFixedTimestep());
+			}
+		}
 	}
 
 	item = list_modules.begin();
 
-	while(item != list_modules.end() && ret == UPDATE_CONTINUE)
 	{
-		ret = (*item)->Update(time->GetRealTimeDt());
-		item++;
+		PROFILE_SCOPE("Update");
+
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
+		{
+			PROFILE_SCOPE((*item)->GetName());
+			ret = (*item)->Update(time->GetRealTimeDt());
+			item++;
+		}
 	}
 
 	item = list_modules.begin();
 
-	while(item != list_modules.end() && ret == UPDATE_CONTINUE)
 	{
-		ret = (*item)->PostUpdate(time->GetRealTimeDt());
-		item++;
+		PROFILE_SCOPE("PostUpdate");
+
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
+		{
+			PROFILE_SCOPE((*item)->GetName());
+			ret = (*item)->PostUpdate(time->GetRealTimeDt());
+			item++;
+		}
 	}
 
 	FinishUpdate();
 
+	if (ret == UPDATE_CONTINUE && scenario && scenario->IsFinished())
+		ret = UPDATE_STOP;
+
 	return ret;
 }
 
 bool Application::CleanUp()
 {
 	// --- Save all Status --- TODO: Should be called by user
-	SaveAllStatus();
+	// --- Headless runs leave the editor's settings as they were ---
+	if (!headless)
+		SaveAllStatus();
+
+	// --- Deferred work left in the queue finishes while every module is still up ---
+	FrameScheduler::Get().Flush();
 
 	bool ret = true;
 	std::list<Module*>::reverse_iterator item = list_modules.rbegin();
@@ -242,6 +335,179 @@ void Application::AddModule(Module* mod)
 	list_modules.push_back(mod);
 }
 
+bool Application::RunStartupPhase(ModulePhase phase, const json& config)
+{
+	PROFILE_SCOPE(phase == ModulePhase::Init ? "Init" : "Start");
+
+	PerfTimer phase_timer;
+	int p = (int)phase;
+
+	// --- Modules by list index, each one knows what waits on it ---
+	std::vector<Module*> modules(list_modules.begin(), list_modules.end());
+	uint count = modules.size();
+	std::vector<std::vector<uint>> dependants(count);
+	std::vector<uint> pending(count, 0);
+	std::vector<bool> done(count, false);
+
+	// --- The job system's Init already ran ---
+	for (uint i = 0; i < count; ++i)
+		done[i] = phase == ModulePhase::Init && modules[i] == jobs;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		if (done[i])
+			continue;
+
+		for (uint d = 0; d < modules[i]->startup.after[p].size(); ++d)
+		{
+			for (uint j = 0; j < count; ++j)
+			{
+				if (modules[j] == modules[i]->startup.after[p][d] && !done[j])
+				{
+					dependants[j].push_back(i);
+					pending[i]++;
+				}
+			}
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<bool> main_ready(count, false);
+	uint started = 0, finished = 0;
+	bool failed = false;
+
+	for (uint i = 0; i < count; ++i)
+		finished += done[i] ? 1 : 0;
+
+	started = finished;
+
+	std::function<void(uint)> run;
+
+	// --- Under the lock, a module whose dependencies finished. Workers get theirs once it is released, Schedule may run a job right away ---
+	auto ready = [&](uint i, std::vector<uint>& to_schedule)
+	{
+		if (modules[i]->startup.thread[p] == ModuleThread::Any)
+		{
+			started++;
+			to_schedule.push_back(i);
+		}
+		else
+			main_ready[i] = true;
+	};
+
+	auto schedule = [&](const std::vector<uint>& to_schedule)
+	{
+		for (uint i = 0; i < to_schedule.size(); ++i)
+		{
+			uint index = to_schedule[i];
+			jobs->Schedule([&run, index]() { run(index); });
+		}
+	};
+
+	run = [&](uint i)
+	{
+		Module* module = modules[i];
+		PerfTimer timer;
+		bool ok = true;
+
+		{
+			PROFILE_SCOPE(module->GetName());
+			ok = phase == ModulePhase::Init ? module->Init(config) : module->Start();
+		}
+
+		module->startup.ms[p] = timer.ReadMs();
+		module->startup.on_worker[p] = !jobs->IsMainThread();
+
+		std::vector<uint> to_schedule;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished++;
+
+			if (!ok)
+			{
+				CONSOLE_LOG("|[error]: %s failed to %s", module->GetName(), phase == ModulePhase::Init ? "Init" : "Start");
+				failed = true;
+			}
+
+			// --- A failure stops anything new from starting, what is running finishes ---
+			for (uint d = 0; d < dependants[i].size() && !failed; ++d)
+			{
+				if (--pending[dependants[i][d]] == 0)
+					ready(dependants[i][d], to_schedule);
+			}
+
+			condition.notify_all();
+		}
+
+		schedule(to_schedule);
+	};
+
+	std::vector<uint> to_schedule;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		if (!done[i] && pending[i] == 0)
+			ready(i, to_schedule);
+	}
+
+	lock.unlock();
+	schedule(to_schedule);
+	lock.lock();
+
+	// --- The main thread runs its own modules in list order and otherwise waits for the workers ---
+	while (true)
+	{
+		uint next = count;
+
+		for (uint i = 0; i < count && !failed && next == count; ++i)
+		{
+			if (main_ready[i])
+				next = i;
+		}
+
+		if (next < count)
+		{
+			main_ready[next] = false;
+			started++;
+
+			lock.unlock();
+			run(next);
+			lock.lock();
+			continue;
+		}
+
+		if (finished == started)
+		{
+			// --- Nothing running and nothing ready, a cycle or a dependency on a module that failed ---
+			if (finished < count && !failed)
+			{
+				CONSOLE_LOG("|[error]: Startup graph has a dependency cycle, %u modules never ran %s", count - finished, phase == ModulePhase::Init ? "Init" : "Start");
+				failed = true;
+			}
+
+			break;
+		}
+
+		condition.wait(lock);
+	}
+
+	lock.unlock();
+
+	// --- Startup report, slowest first ---
+	std::vector<Module*> sorted = modules;
+	std::sort(sorted.begin(), sorted.end(), [p](const Module* a, const Module* b) { return a->startup.ms[p] > b->startup.ms[p]; });
+
+	CONSOLE_LOG("Startup: %s took %.2f ms", phase == ModulePhase::Init ? "Init" : "Start", phase_timer.ReadMs());
+
+	for (uint i = 0; i < sorted.size(); ++i)
+		CONSOLE_LOG("Startup:    %-18s %8.2f ms on %s", sorted[i]->GetName(), sorted[i]->startup.ms[p], sorted[i]->startup.on_worker[p] ? "a worker" : "main");
+
+	return !failed;
+}
+
 
 const char * Application::GetAppName() const
 {
@@ -259,22 +525,23 @@ void Application::SetOrganizationName(const char* name)
 	orgName = name;
 }
 
-void Application::Log(const char * entry)
-{	
-	if (logs.size() > 1000)
-		logs.erase(logs.begin());
+bool Application::SetScenario(const char* path)
+{
+	if (scenario)
+		delete scenario;
 
-	// --- Append all logs to a string so we can print them on console --- 
-	log.append(entry);
+	scenario = new ScenarioRunner;
 
-	std::string to_add = entry;
-	logs.push_back(to_add);
-}
+	if (!scenario->Load(path))
+	{
+		delete scenario;
+		scenario = nullptr;
+		return false;
+	}
 
-void Application::ClearLogsFromConsole()
-{
-	logs.erase(logs.begin(), logs.end());
-	logs.clear();
+	headless = true;
+
+	return true;
 }
 
 const char* Application::GetOrganizationName() const
@@ -308,18 +575,24 @@ json Application::GetDefaultConfig() const
 		}},
 
 		{"Renderer3D", {
-			{"VSync", true}
+			{"VSync", true},
+			{"Pipelined", false}
+		}},
+
+		{"Time", {
+			{"SmoothDt", true},
+			{"FixedTimestep", 0.0f},
+			{"DeferredBudget", SCHEDULER_DEFAULT_BUDGET_MS}
+		}},
+
+		{"Hardware", {
+			{"Kernels", json::object()}
 		}},
 	};
 
 	return config;
 }
 
-std::vector<std::string>& Application::GetLogs()
-{
-	return logs;
-}
-
 // ---------------------------------------------
 LCG & Application::GetRandom()
 {
@@ -336,4 +609,12 @@ AppState & Application::GetAppState()
 	return EngineState;
 }
 
+bool Application::IsHeadless() const
+{
+	return headless;
+}
 
+ScenarioRunner* Application::GetScenario() const
+{
+	return scenario;
+}
@@ -39,6 +39,9 @@ class ModuleSceneManager;
 class ModuleResourceManager;
 class ModuleTimeManager;
 class ModuleEventManager;
+class ModuleJobs;
+class ScenarioRunner;
+enum class ModulePhase;
 
 class Application
 {
@@ -48,16 +51,18 @@ public:
 	const char * GetAppName() const;
 	const char* GetOrganizationName() const;
 	json GetDefaultConfig() const;
-	std::vector<std::string>& GetLogs();
 	LCG& GetRandom();
 	JSONLoader* GetJLoader();
 	AppState& GetAppState();
+	bool IsHeadless() const;
+	ScenarioRunner* GetScenario() const;
 
 	// --- Setters ---
 	void SetAppName(const char* name);
 	void SetOrganizationName(const char* name);
-	void Log(const char* entry);
-	void ClearLogsFromConsole();
+
+	// --- Before Init. Runs the scenario headless and stops once it is done ---
+	bool SetScenario(const char* path);
 
 public:
 
@@ -73,6 +78,7 @@ public:
 	ModuleResourceManager* resources = nullptr;
 	ModuleTimeManager* time = nullptr;
 	ModuleEventManager* event_manager = nullptr;
+	ModuleJobs* jobs = nullptr;
 
 private:
 
@@ -85,11 +91,11 @@ private:
 
 	LCG*		  RandomNumber = nullptr;
 
-	std::string			log;
-	std::vector<std::string> logs;
-
 	AppState EngineState = AppState::EDITOR;
 
+	ScenarioRunner* scenario = nullptr;
+	bool headless = false;
+
 
 public:
 
@@ -104,6 +110,7 @@ public:
 private:
 
 	void AddModule(Module* mod);
+	bool RunStartupPhase(ModulePhase phase, const json& config);
 	void PrepareUpdate();
 	void FinishUpdate();
 	void SaveAllStatus();
@@ -0,0 +1,491 @@
+#include "AssetDatabase.h"
+#include "Application.h"
+#include "ModuleResourceManager.h"
+#include "ResourceMeta.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "mmgr/mmgr.h"
+
+#define ASSET_DATABASE_MAGIC 0x42443343 // "C3DB"
+
+AssetDatabase::AssetDatabase() : hits(0), misses(0)
+{
+}
+
+AssetDatabase::~AssetDatabase()
+{
+}
+
+bool AssetDatabase::Open(const char* file)
+{
+	Close();
+
+	if (!App->fs->Exists(file) || !App->fs->MapFile(file, mapped))
+		return false;
+
+	DiskHeader header;
+	bool ret = mapped.size >= sizeof(DiskHeader);
+
+	if (ret)
+	{
+		memcpy(&header, mapped.data, sizeof(DiskHeader));
+		ret = header.magic == ASSET_DATABASE_MAGIC && header.version == ASSET_DATABASE_VERSION
+			&& mapped.size == sizeof(DiskHeader) + (uint64)header.count * sizeof(DiskEntry) + header.blob_size;
+	}
+
+	if (!ret)
+	{
+		CONSOLE_LOG("![Warning]: Asset database %s is from another version or damaged, it will be rebuilt from the metas", file);
+		Close();
+		return false;
+	}
+
+	entries = (const DiskEntry*)(mapped.data + sizeof(DiskHeader));
+	blob = (const char*)(entries + header.count);
+	count = header.count;
+
+	// --- Nothing may point out of the file ---
+	for (uint i = 0; i < count && ret; ++i)
+	{
+		const DiskEntry& entry = entries[i];
+
+		ret = (uint64)entry.asset_offset + entry.asset_size <= header.blob_size
+			&& (uint64)entry.source_offset + entry.source_length <= header.blob_size
+			&& (uint64)entry.data_offset + entry.data_size <= header.blob_size
+			&& (uint64)entry.produced_offset + (uint64)entry.produced_count * sizeof(uint) <= header.blob_size;
+	}
+
+	if (!ret)
+	{
+		CONSOLE_LOG("![Warning]: Asset database %s is damaged, it will be rebuilt from the metas", file);
+		Close();
+		return false;
+	}
+
+	ResetStates(EntryState::Unchecked);
+
+	return true;
+}
+
+bool AssetDatabase::Save(const char* file)
+{
+	PROFILE_FUNCTION();
+
+	std::vector<AssetRecord> records;
+
+	// --- Mapped entries that are still good and were not replaced, then everything written this session ---
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (uint i = 0; i < count; ++i)
+		{
+			if (states[i] != EntryState::Valid && states[i] != EntryState::Saved)
+				continue;
+
+			std::string asset(blob + entries[i].asset_offset, entries[i].asset_size);
+
+			if (overlay.find(asset) != overlay.end() || removed.find(asset) != removed.end())
+				continue;
+
+			records.push_back(AssetRecord());
+			ReadMapped(i, records.back());
+		}
+
+		for (std::map<std::string, AssetRecord>::const_iterator it = overlay.begin(); it != overlay.end(); ++it)
+			records.push_back(it->second);
+	}
+
+	std::sort(records.begin(), records.end(), [](const AssetRecord& a, const AssetRecord& b) { return a.asset < b.asset; });
+
+	// --- Strings, CBOR and produced UIDs all go to the blob after the entries ---
+	std::vector<DiskEntry> disk_entries(records.size());
+	std::string data;
+
+	for (uint i = 0; i < records.size(); ++i)
+	{
+		const AssetRecord& record = records[i];
+		DiskEntry& entry = disk_entries[i];
+		memset(&entry, 0, sizeof(DiskEntry));
+
+		entry.source_time = record.source_time;
+		entry.source_size = record.source_size;
+		entry.source_hash = record.source_hash;
+		entry.meta_time = record.meta_time;
+		entry.meta_size = record.meta_size;
+		entry.meta_hash = record.meta_hash;
+		entry.UID = record.UID;
+		entry.type = (uint32)record.type;
+		entry.Date = record.Date;
+		entry.fileFormatVersion = record.fileFormatVersion;
+
+		entry.asset_offset = data.size();
+		entry.asset_size = record.asset.size();
+		data.append(record.asset);
+
+		entry.source_offset = data.size();
+		entry.source_length = record.source.size();
+		data.append(record.source);
+
+		if (!record.ResourceData.is_null())
+		{
+			std::vector<uint8_t> cbor = json::to_cbor(record.ResourceData);
+			entry.data_offset = data.size();
+			entry.data_size = cbor.size();
+			data.append((const char*)cbor.data(), cbor.size());
+		}
+
+		entry.produced_offset = data.size();
+		entry.produced_count = record.produced.size();
+		data.append((const char*)record.produced.data(), record.produced.size() * sizeof(uint));
+	}
+
+	DiskHeader header;
+	header.magic = ASSET_DATABASE_MAGIC;
+	header.version = ASSET_DATABASE_VERSION;
+	header.count = records.size();
+	header.blob_size = data.size();
+
+	std::string buffer;
+	buffer.reserve(sizeof(DiskHeader) + disk_entries.size() * sizeof(DiskEntry) + data.size());
+	buffer.append((const char*)&header, sizeof(DiskHeader));
+	buffer.append((const char*)disk_entries.data(), disk_entries.size() * sizeof(DiskEntry));
+	buffer.append(data);
+
+	// --- The mapping keeps the file locked ---
+	Close();
+
+	bool ret = App->fs->Save(file, buffer.data(), buffer.size()) == buffer.size();
+
+	// --- Everything that went in was valid, a later Save keeps it unless it turns stale when asked for again ---
+	if (ret)
+	{
+		if (Open(file))
+			ResetStates(EntryState::Saved);
+	}
+	else
+		CONSOLE_LOG("|[error]: Could not save asset database %s", file);
+
+	return ret;
+}
+
+void AssetDatabase::Close()
+{
+	App->fs->UnmapFile(mapped);
+
+	entries = nullptr;
+	blob = nullptr;
+	count = 0;
+	states.clear();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	overlay.clear();
+	removed.clear();
+}
+
+bool AssetDatabase::Find(const char* asset, AssetRecord& record)
+{
+	std::string key;
+	Normalize(asset, key);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::map<std::string, AssetRecord>::const_iterator it = overlay.find(key);
+
+		if (it != overlay.end())
+		{
+			record = it->second;
+			hits++;
+			return true;
+		}
+
+		if (removed.find(key) != removed.end())
+		{
+			misses++;
+			return false;
+		}
+	}
+
+	int index = FindMapped(key);
+
+	if (index < 0 || !ValidateMapped(index))
+	{
+		misses++;
+		return false;
+	}
+
+	ReadMapped(index, record);
+	hits++;
+
+	return true;
+}
+
+void AssetDatabase::Store(const ResourceMeta* meta, const char* meta_data, uint meta_size)
+{
+	if (meta == nullptr)
+		return;
+
+	// --- A meta is its asset's path plus the extension ---
+	std::string meta_file = meta->GetResourceFile();
+	std::string asset = meta_file.substr(0, meta_file.find_last_of("."));
+
+	AssetRecord record;
+	Normalize(asset.c_str(), record.asset);
+
+	if (!App->fs->GetFileStat(meta_file.c_str(), record.meta_time, record.meta_size))
+		return;
+
+	// --- Hashed from what was just written or read back ---
+	record.meta_hash = meta_data ? App->fs->Hash(meta_data, meta_size) : App->fs->HashFile(meta_file.c_str());
+
+	App->fs->GetFileStat(asset.c_str(), record.source_time, record.source_size);
+
+	record.source = meta->GetOriginalFile();
+	record.UID = meta->GetUID();
+	record.Date = meta->Date;
+	record.fileFormatVersion = meta->fileFormatVersion;
+	record.ResourceData = meta->ResourceData;
+	record.type = App->resources->GetResourceTypeFromPath(asset.c_str());
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// --- Rewriting a meta does not change what its asset produced, nor the source's hash while the source is the same ---
+	std::map<std::string, AssetRecord>::iterator it = overlay.find(record.asset);
+	uint64 source_time = 0, source_size = 0, source_hash = 0;
+
+	if (it != overlay.end())
+	{
+		record.produced.swap(it->second.produced);
+		source_time = it->second.source_time;
+		source_size = it->second.source_size;
+		source_hash = it->second.source_hash;
+	}
+	else
+	{
+		int index = FindMapped(record.asset);
+
+		if (index >= 0 && removed.find(record.asset) == removed.end())
+		{
+			const DiskEntry& entry = entries[index];
+			record.produced.resize(entry.produced_count);
+			memcpy(record.produced.data(), blob + entry.produced_offset, entry.produced_count * sizeof(uint));
+			source_time = entry.source_time;
+			source_size = entry.source_size;
+			source_hash = entry.source_hash;
+		}
+	}
+
+	if (source_time == record.source_time && source_size == record.source_size)
+		record.source_hash = source_hash;
+
+	removed.erase(record.asset);
+	overlay[record.asset] = record;
+}
+
+void AssetDatabase::SetProduced(const char* asset, Resource::ResourceType type, const std::vector<uint>& produced)
+{
+	std::string key;
+	Normalize(asset, key);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::map<std::string, AssetRecord>::iterator it = overlay.find(key);
+
+	if (it == overlay.end())
+	{
+		// --- Only for assets that have an entry already, the meta is what makes one ---
+		int index = FindMapped(key);
+
+		if (index < 0 || (states[index] != EntryState::Valid && states[index] != EntryState::Saved) || removed.find(key) != removed.end())
+			return;
+
+		it = overlay.insert(std::pair<std::string, AssetRecord>(key, AssetRecord())).first;
+		ReadMapped(index, it->second);
+	}
+
+	it->second.type = type;
+	it->second.produced = produced;
+}
+
+void AssetDatabase::SetSource(const char* asset, uint64 time, uint64 size, uint64 hash)
+{
+	std::string key;
+	Normalize(asset, key);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::map<std::string, AssetRecord>::iterator it = overlay.find(key);
+
+	if (it == overlay.end())
+	{
+		int index = FindMapped(key);
+
+		if (index < 0 || (states[index] != EntryState::Valid && states[index] != EntryState::Saved) || removed.find(key) != removed.end())
+			return;
+
+		it = overlay.insert(std::pair<std::string, AssetRecord>(key, AssetRecord())).first;
+		ReadMapped(index, it->second);
+	}
+
+	it->second.source_time = time;
+	it->second.source_size = size;
+	it->second.source_hash = hash;
+}
+
+void AssetDatabase::Remove(const char* asset)
+{
+	std::string key;
+	Normalize(asset, key);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	overlay.erase(key);
+	removed.insert(key);
+}
+
+uint AssetDatabase::GetEntryCount() const
+{
+	return count;
+}
+
+uint AssetDatabase::GetHits() const
+{
+	return hits;
+}
+
+uint AssetDatabase::GetMisses() const
+{
+	return misses;
+}
+
+int AssetDatabase::FindMapped(const std::string& asset) const
+{
+	// --- Entries are sorted, binary search straight on the mapped strings ---
+	int low = 0;
+	int high = (int)count - 1;
+
+	while (low <= high)
+	{
+		int mid = (low + high) / 2;
+		int comparison = asset.compare(0, asset.size(), blob + entries[mid].asset_offset, entries[mid].asset_size);
+
+		if (comparison == 0)
+			return mid;
+
+		if (comparison < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+
+	return -1;
+}
+
+void AssetDatabase::ReadMapped(uint index, AssetRecord& record) const
+{
+	const DiskEntry& entry = entries[index];
+
+	record.asset.assign(blob + entry.asset_offset, entry.asset_size);
+	record.source.assign(blob + entry.source_offset, entry.source_length);
+	record.UID = entry.UID;
+	record.type = (Resource::ResourceType)entry.type;
+	record.Date = entry.Date;
+	record.fileFormatVersion = entry.fileFormatVersion;
+	record.source_time = entry.source_time;
+	record.source_size = entry.source_size;
+	record.source_hash = entry.source_hash;
+	record.meta_time = entry.meta_time;
+	record.meta_size = entry.meta_size;
+	record.meta_hash = entry.meta_hash;
+
+	record.ResourceData = json();
+
+	if (entry.data_size > 0)
+	{
+		const uint8_t* data = (const uint8_t*)(blob + entry.data_offset);
+
+		try
+		{
+			record.ResourceData = json::from_cbor(data, data + entry.data_size);
+		}
+		catch (json::parse_error& error)
+		{
+			CONSOLE_LOG("|[error]: Asset database: could not read the data of %s: %s", record.asset.c_str(), error.what());
+		}
+	}
+
+	record.produced.resize(entry.produced_count);
+
+	if (entry.produced_count > 0)
+		memcpy(record.produced.data(), blob + entry.produced_offset, entry.produced_count * sizeof(uint));
+}
+
+bool AssetDatabase::ValidateMapped(uint index)
+{
+	// --- Entries are independent, each is validated by whoever asks for it first ---
+	EntryState state = states[index].load(std::memory_order_relaxed);
+
+	if (state == EntryState::Valid || state == EntryState::Stale)
+		return state == EntryState::Valid;
+
+	const DiskEntry& entry = entries[index];
+	std::string meta_file(blob + entry.asset_offset, entry.asset_size);
+	meta_file.append(".meta");
+
+	uint64 time = 0;
+	bool valid = IsMetaUnchanged(meta_file, entry.meta_time, entry.meta_size, entry.meta_hash, time);
+
+	// --- Touched but the same, the new date goes in so the next start does not read it again ---
+	if (valid && time != entry.meta_time)
+	{
+		AssetRecord record;
+		ReadMapped(index, record);
+		record.meta_time = time;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (overlay.find(record.asset) == overlay.end())
+			overlay[record.asset] = record;
+	}
+
+	states[index].store(valid ? EntryState::Valid : EntryState::Stale, std::memory_order_relaxed);
+
+	return valid;
+}
+
+void AssetDatabase::ResetStates(EntryState state)
+{
+	// --- Atomics cannot be copied, so the vector is rebuilt rather than assigned ---
+	std::vector<std::atomic<EntryState>> fresh(count);
+
+	for (uint i = 0; i < count; ++i)
+		fresh[i].store(state, std::memory_order_relaxed);
+
+	states.swap(fresh);
+}
+
+bool AssetDatabase::IsMetaUnchanged(const std::string& meta_file, uint64 time, uint64 size, uint64 hash, uint64& new_time) const
+{
+	uint64 meta_size = 0;
+
+	if (!App->fs->GetFileStat(meta_file.c_str(), new_time, meta_size) || meta_size != size)
+		return false;
+
+	if (new_time == time)
+		return true;
+
+	// --- A checkout or a copy changes the date, same bytes is still the same meta ---
+	return App->fs->HashFile(meta_file.c_str()) == hash;
+}
+
+void AssetDatabase::Normalize(const char* asset, std::string& key)
+{
+	key = asset ? asset : "";
+	App->fs->NormalizePath(key);
+
+	// --- Folders are imported by their path with a /, their metas are named without ---
+	if (!key.empty() && key.back() == '/')
+		key.pop_back();
+}
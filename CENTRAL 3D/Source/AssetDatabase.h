@@ -0,0 +1,134 @@
+#ifndef __ASSET_DATABASE_H__
+#define __ASSET_DATABASE_H__
+
+#include "Resource.h"
+#include "ModuleFileSystem.h"
+#include "JSONLoader.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#define ASSET_DATABASE_FILE LIBRARY_FOLDER "assets.db" // Rebuilt from the metas when missing, not meant for version control
+#define ASSET_DATABASE_VERSION 2 // Bump on any layout change, files of other versions are ignored
+
+class ResourceMeta;
+
+// --- What a meta said about an asset, plus what is needed to tell whether the meta changed since ---
+struct AssetRecord
+{
+	std::string asset; // Normalized path, the key
+	std::string source; // The meta's SOURCE
+	uint UID = 0;
+	Resource::ResourceType type = Resource::ResourceType::UNKNOWN;
+	uint Date = 0;
+	uint fileFormatVersion = 0;
+	json ResourceData;
+
+	uint64 source_time = 0;
+	uint64 source_size = 0;
+	uint64 source_hash = 0; // 0 until a change to the source is seen
+	uint64 meta_time = 0;
+	uint64 meta_size = 0;
+	uint64 meta_hash = 0; // Of the meta's bytes, a meta that was touched but not changed is still good
+
+	std::vector<uint> produced; // Resources the asset brought in
+};
+
+// --- Binary cache of every meta in the project, kept in the library and mapped at startup ---
+// --- Metas stay the source of truth, an entry is only used while its meta is the one it was built from ---
+class AssetDatabase
+{
+public:
+
+	AssetDatabase();
+	~AssetDatabase();
+
+	bool Open(const char* file);
+	bool Save(const char* file); // Writes every entry seen this session and opens the result again
+	void Close();
+
+	// --- Any thread. False when there is no entry or its meta changed, one stat the first time an entry is asked for ---
+	bool Find(const char* asset, AssetRecord& record);
+
+	// --- Main thread, after a meta is read or written ---
+	void Store(const ResourceMeta* meta, const char* meta_data = nullptr, uint meta_size = 0);
+	void SetProduced(const char* asset, Resource::ResourceType type, const std::vector<uint>& produced);
+	void SetSource(const char* asset, uint64 time, uint64 size, uint64 hash); // What the watcher saw last
+	void Remove(const char* asset);
+
+	// --- Stats ---
+	uint GetEntryCount() const; // In the file that was opened
+	uint GetHits() const;
+	uint GetMisses() const;
+
+private:
+
+	// --- As laid out in the file, offsets point past the entries ---
+	struct DiskEntry
+	{
+		uint64 source_time;
+		uint64 source_size;
+		uint64 source_hash;
+		uint64 meta_time;
+		uint64 meta_size;
+		uint64 meta_hash;
+		uint32 asset_offset;
+		uint32 asset_size;
+		uint32 source_offset;
+		uint32 source_length;
+		uint32 data_offset; // ResourceData as CBOR
+		uint32 data_size;
+		uint32 produced_offset;
+		uint32 produced_count;
+		uint32 UID;
+		uint32 type;
+		uint32 Date;
+		uint32 fileFormatVersion;
+	};
+
+	struct DiskHeader
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 count;
+		uint32 blob_size;
+	};
+
+	enum class EntryState : unsigned char
+	{
+		Unchecked = 0,
+		Saved, // Written by this session's last Save, checked again when asked for
+		Valid,
+		Stale
+	};
+
+	int FindMapped(const std::string& asset) const;
+	void ReadMapped(uint index, AssetRecord& record) const;
+	bool ValidateMapped(uint index);
+	void ResetStates(EntryState state);
+	bool IsMetaUnchanged(const std::string& meta_file, uint64 time, uint64 size, uint64 hash, uint64& new_time) const;
+	static void Normalize(const char* asset, std::string& key);
+
+private:
+
+	MappedFile mapped;
+	const DiskEntry* entries = nullptr; // Sorted by asset
+	const char* blob = nullptr;
+	uint count = 0;
+	// --- One per mapped entry. Sized on the main thread before any job validates, then each slot is written 
+	// by whoever validates its entry. Two workers on the same entry reach the same answer, the atomics keep that benign ---
+	std::vector<std::atomic<EntryState>> states;
+
+	// --- Entries read or written this session, they shadow the mapped ones ---
+	mutable std::mutex mutex;
+	std::map<std::string, AssetRecord> overlay;
+	std::set<std::string> removed;
+
+	std::atomic<uint> hits;
+	std::atomic<uint> misses;
+};
+
+#endif
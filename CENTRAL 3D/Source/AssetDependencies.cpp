@@ -0,0 +1,356 @@
+#include "AssetDependencies.h"
+#include "Application.h"
+#include "ModuleFileSystem.h"
+#include "JSONLoader.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "mmgr/mmgr.h"
+
+AssetDependencyGraph::AssetDependencyGraph()
+{
+}
+
+AssetDependencyGraph::~AssetDependencyGraph()
+{
+}
+
+bool AssetDependencyGraph::Load(const char* file)
+{
+	PROFILE_FUNCTION();
+
+	nodes.clear();
+	dirty = false;
+
+	if (!App->fs->Exists(file))
+		return false;
+
+	json graph = App->GetJLoader()->Load(file);
+
+	if (!graph.is_object())
+		return false;
+
+	for (json::iterator it = graph.begin(); it != graph.end(); ++it)
+	{
+		uint UID = std::stoul(it.key());
+		json& entry = it.value();
+		Node& node = nodes[UID];
+
+		if (entry["settings"].is_number())
+			node.settings_hash = entry["settings"].get<uint64>();
+
+		if (entry["cause"].is_number())
+			node.reason.cause = entry["cause"].get<uint>();
+
+		if (entry["reason"].is_string())
+			node.reason.description = entry["reason"].get<std::string>();
+
+		if (!entry["dependencies"].is_array())
+			continue;
+
+		for (json::iterator dep = entry["dependencies"].begin(); dep != entry["dependencies"].end(); ++dep)
+			node.dependencies.push_back((*dep).get<uint>());
+	}
+
+	// --- Only one side is written, the other one is rebuilt ---
+	for (std::unordered_map<uint, Node>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		for (uint i = 0; i < it->second.dependencies.size(); ++i)
+			nodes[it->second.dependencies[i]].dependents.push_back(it->first);
+	}
+
+	return true;
+}
+
+bool AssetDependencyGraph::Save(const char* file)
+{
+	PROFILE_FUNCTION();
+
+	if (!dirty)
+		return true;
+
+	json graph = json::object();
+
+	for (std::unordered_map<uint, Node>::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		const Node& node = it->second;
+
+		if (node.dependencies.empty() && node.settings_hash == 0 && node.reason.description.empty())
+			continue;
+
+		json& entry = graph[std::to_string(it->first)];
+		entry["dependencies"] = node.dependencies;
+		entry["settings"] = node.settings_hash;
+
+		if (!node.reason.description.empty())
+		{
+			entry["cause"] = node.reason.cause;
+			entry["reason"] = node.reason.description;
+		}
+	}
+
+	std::string data;
+	App->GetJLoader()->Serialize(graph, data);
+
+	bool ret = App->fs->Save(file, data.data(), data.length()) == data.length();
+
+	if (ret)
+		dirty = false;
+	else
+		CONSOLE_LOG("|[error]: Could not save asset dependencies to %s", file);
+
+	return ret;
+}
+
+void AssetDependencyGraph::SetDependencies(uint UID, const std::vector<uint>& dependencies)
+{
+	std::vector<uint> sorted = dependencies;
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	// --- 0 is what resources hold when they hold nothing, and nothing depends on itself ---
+	Erase(sorted, 0);
+	Erase(sorted, UID);
+
+	Node& node = nodes[UID];
+
+	if (node.dependencies == sorted)
+		return;
+
+	for (uint i = 0; i < node.dependencies.size(); ++i)
+		Erase(nodes[node.dependencies[i]].dependents, UID);
+
+	node.dependencies = sorted;
+
+	for (uint i = 0; i < sorted.size(); ++i)
+		nodes[sorted[i]].dependents.push_back(UID);
+
+	dirty = true;
+}
+
+bool AssetDependencyGraph::SetSettingsHash(uint UID, uint64 hash)
+{
+	Node& node = nodes[UID];
+
+	if (node.settings_hash == hash)
+		return false;
+
+	// --- The first one seen is not a change ---
+	bool changed = node.settings_hash != 0;
+	node.settings_hash = hash;
+	dirty = true;
+
+	return changed;
+}
+
+void AssetDependencyGraph::Remove(uint UID)
+{
+	std::unordered_map<uint, Node>::iterator it = nodes.find(UID);
+
+	if (it == nodes.end())
+		return;
+
+	for (uint i = 0; i < it->second.dependencies.size(); ++i)
+		Erase(nodes[it->second.dependencies[i]].dependents, UID);
+
+	for (uint i = 0; i < it->second.dependents.size(); ++i)
+		Erase(nodes[it->second.dependents[i]].dependencies, UID);
+
+	nodes.erase(UID);
+	dirty = true;
+}
+
+void AssetDependencyGraph::GetDependencies(uint UID, std::vector<uint>& dependencies) const
+{
+	std::unordered_map<uint, Node>::const_iterator it = nodes.find(UID);
+
+	if (it != nodes.end())
+		dependencies = it->second.dependencies;
+	else
+		dependencies.clear();
+}
+
+void AssetDependencyGraph::GetDependents(uint UID, std::vector<uint>& dependents, bool transitive) const
+{
+	dependents.clear();
+
+	std::unordered_set<uint> seen;
+	seen.insert(UID);
+
+	std::vector<uint> queue(1, UID);
+
+	for (uint i = 0; i < queue.size(); ++i)
+	{
+		std::unordered_map<uint, Node>::const_iterator it = nodes.find(queue[i]);
+
+		if (it == nodes.end())
+			continue;
+
+		for (uint j = 0; j < it->second.dependents.size(); ++j)
+		{
+			uint dependent = it->second.dependents[j];
+
+			if (!seen.insert(dependent).second)
+				continue;
+
+			dependents.push_back(dependent);
+
+			if (transitive)
+				queue.push_back(dependent);
+		}
+	}
+}
+
+bool AssetDependencyGraph::GetReimportReason(uint UID, ReimportReason& reason) const
+{
+	std::unordered_map<uint, Node>::const_iterator it = nodes.find(UID);
+
+	if (it == nodes.end() || it->second.reason.description.empty())
+		return false;
+
+	reason = it->second.reason;
+
+	return true;
+}
+
+void AssetDependencyGraph::GetReimportChain(uint UID, std::vector<uint>& chain) const
+{
+	chain.clear();
+
+	ReimportReason reason;
+
+	while (std::find(chain.begin(), chain.end(), UID) == chain.end() && GetReimportReason(UID, reason))
+	{
+		chain.push_back(UID);
+
+		if (reason.cause == 0)
+			break;
+
+		UID = reason.cause;
+	}
+}
+
+void AssetDependencyGraph::Invalidate(const std::vector<uint>& changed, const char* reason, std::vector<std::vector<uint>>& levels)
+{
+	PROFILE_FUNCTION();
+
+	levels.clear();
+
+	std::unordered_set<uint> sources(changed.begin(), changed.end());
+
+	for (uint i = 0; i < changed.size(); ++i)
+	{
+		std::unordered_map<uint, Node>::iterator it = nodes.find(changed[i]);
+
+		if (it != nodes.end())
+		{
+			it->second.reason.cause = 0;
+			it->second.reason.description = reason;
+			dirty = true;
+		}
+	}
+
+	// --- Breadth first, the first path that reaches a resource is the one reported as its cause ---
+	std::unordered_map<uint, uint> reached;
+	std::vector<uint> queue = changed;
+
+	for (uint i = 0; i < queue.size(); ++i)
+	{
+		std::unordered_map<uint, Node>::const_iterator it = nodes.find(queue[i]);
+
+		if (it == nodes.end())
+			continue;
+
+		for (uint j = 0; j < it->second.dependents.size(); ++j)
+		{
+			uint dependent = it->second.dependents[j];
+
+			if (sources.count(dependent) || reached.count(dependent))
+				continue;
+
+			reached[dependent] = queue[i];
+			queue.push_back(dependent);
+		}
+	}
+
+	if (reached.empty())
+		return;
+
+	// --- Only dependencies that are refreshed too hold a resource back ---
+	std::unordered_map<uint, uint> waiting;
+	std::vector<uint> ready;
+
+	for (std::unordered_map<uint, uint>::iterator it = reached.begin(); it != reached.end(); ++it)
+	{
+		Node& node = nodes[it->first];
+		node.reason.cause = it->second;
+		node.reason.description = reason;
+
+		uint count = 0;
+
+		for (uint i = 0; i < node.dependencies.size(); ++i)
+			count += reached.count(node.dependencies[i]) ? 1 : 0;
+
+		waiting[it->first] = count;
+
+		if (count == 0)
+			ready.push_back(it->first);
+	}
+
+	uint placed = 0;
+
+	while (!ready.empty())
+	{
+		std::sort(ready.begin(), ready.end());
+		levels.push_back(ready);
+		placed += ready.size();
+
+		std::vector<uint> next;
+
+		for (uint i = 0; i < ready.size(); ++i)
+		{
+			const Node& node = nodes[ready[i]];
+
+			for (uint j = 0; j < node.dependents.size(); ++j)
+			{
+				std::unordered_map<uint, uint>::iterator wait = waiting.find(node.dependents[j]);
+
+				if (wait != waiting.end() && wait->second > 0 && --wait->second == 0)
+					next.push_back(wait->first);
+			}
+		}
+
+		ready.swap(next);
+	}
+
+	// --- A cycle never gets ready, refresh it last rather than never ---
+	if (placed < reached.size())
+	{
+		std::vector<uint> cycle;
+
+		for (std::unordered_map<uint, uint>::iterator it = waiting.begin(); it != waiting.end(); ++it)
+		{
+			if (it->second > 0)
+				cycle.push_back(it->first);
+		}
+
+		std::sort(cycle.begin(), cycle.end());
+		levels.push_back(cycle);
+
+		CONSOLE_LOG("![Warning]: %u resources depend on each other in a cycle, they are refreshed last", (uint)cycle.size());
+	}
+
+	dirty = true;
+}
+
+uint AssetDependencyGraph::GetNodeCount() const
+{
+	return nodes.size();
+}
+
+void AssetDependencyGraph::Erase(std::vector<uint>& list, uint UID)
+{
+	list.erase(std::remove(list.begin(), list.end(), UID), list.end());
+}
@@ -0,0 +1,64 @@
+#ifndef __ASSET_DEPENDENCIES_H__
+#define __ASSET_DEPENDENCIES_H__
+
+#include "Globals.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define ASSET_DEPENDENCIES_FILE LIBRARY_FOLDER "dependencies.json" // Rebuilt as importers run when missing
+
+// --- Why a resource was last reimported, cause is 0 when it changed itself ---
+struct ReimportReason
+{
+	uint cause = 0;
+	std::string description;
+};
+
+// --- Which resource uses which, recorded by the importers. Main thread only ---
+// --- A resource depends on another when it has to be refreshed after that one changes (material on its shader, scene on its models...) ---
+class AssetDependencyGraph
+{
+public:
+
+	AssetDependencyGraph();
+	~AssetDependencyGraph();
+
+	bool Load(const char* file);
+	bool Save(const char* file);
+
+	// --- Recording ---
+	void SetDependencies(uint UID, const std::vector<uint>& dependencies); // Replaces whatever was recorded before
+	bool SetSettingsHash(uint UID, uint64 hash); // True when it differs from the one recorded last
+	void Remove(uint UID);
+
+	// --- Queries ---
+	void GetDependencies(uint UID, std::vector<uint>& dependencies) const;
+	void GetDependents(uint UID, std::vector<uint>& dependents, bool transitive = false) const;
+	bool GetReimportReason(uint UID, ReimportReason& reason) const;
+	void GetReimportChain(uint UID, std::vector<uint>& chain) const; // From the resource back to what started it
+
+	// --- Everything downstream of what changed, in levels. A level only depends on the ones before it, never on itself ---
+	void Invalidate(const std::vector<uint>& changed, const char* reason, std::vector<std::vector<uint>>& levels);
+
+	uint GetNodeCount() const;
+
+private:
+
+	struct Node
+	{
+		std::vector<uint> dependencies;
+		std::vector<uint> dependents;
+		uint64 settings_hash = 0;
+		ReimportReason reason;
+	};
+
+	static void Erase(std::vector<uint>& list, uint UID);
+
+private:
+
+	std::unordered_map<uint, Node> nodes;
+	bool dirty = false;
+};
+
+#endif
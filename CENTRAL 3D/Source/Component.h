@@ -4,12 +4,15 @@
 #include "Globals.h"
 #include "JSONLoader.h"
 #include "Resource.h"
+#include "Allocator.h"
 
 class GameObject;
 
 class Component
 {
 public:
+	MEMORY_TAG(MemoryTag::Scene)
+
 	enum class ComponentType
 	{
 		Transform,
@@ -40,6 +43,7 @@ public:
 	virtual json Save() const = 0;
 	virtual void Load(json& node) = 0;
 	virtual void ONResourceEvent(uint UID, Resource::ResourceNotificationType type) {};
+	virtual void GatherDependencies(std::vector<uint>& dependencies) const {}; // UIDs of the resources it uses
 	virtual void CreateInspectorNode() = 0;
 	virtual void DrawComponent() {};
 
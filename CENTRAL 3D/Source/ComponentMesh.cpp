@@ -69,12 +69,13 @@ void ComponentMesh::ONResourceEvent(uint UID, Resource::ResourceNotificationType
 	switch (type)
 	{
 	case Resource::ResourceNotificationType::Overwrite:
-		if (resource_mesh && UID == resource_mesh->GetUID())
+		// --- The overwritten resource may already be gone, match by the UID the handle keeps ---
+		if (UID == resource_mesh.GetUID())
 			resource_mesh = (ResourceMesh*)App->resources->GetResource(UID);
 		break;
 
 	case Resource::ResourceNotificationType::Deletion:
-		if (resource_mesh && UID == resource_mesh->GetUID())
+		if (UID == resource_mesh.GetUID())
 			resource_mesh = nullptr;
 		break;
 
@@ -83,13 +84,17 @@ void ComponentMesh::ONResourceEvent(uint UID, Resource::ResourceNotificationType
 	}
 }
 
+void ComponentMesh::GatherDependencies(std::vector<uint>& dependencies) const
+{
+	if (resource_mesh.GetUID())
+		dependencies.push_back(resource_mesh.GetUID());
+}
+
 void ComponentMesh::CreateInspectorNode()
 {
 	if (resource_mesh)
 	{
-		std::string Triangle_count = "Triangles   ";
-		Triangle_count.append(std::to_string(resource_mesh->IndicesSize / 3));
-		ImGui::Text(Triangle_count.data());
+		ImGui::Text("Triangles   %u", resource_mesh->IndicesSize / 3);
 	}
 
 	//ImGui::SetCursorPosX(ImGui::GetWindowContentRegionWidth() / 2 - 100);
@@ -4,6 +4,7 @@
 #include "Component.h"
 #include "Math.h"
 #include "ResourceMesh.h"
+#include "ResourceHandle.h"
 
 
 class ComponentMesh : public Component
@@ -18,12 +19,13 @@ public:
 	json Save() const override;
 	void Load(json& node) override;
 	void ONResourceEvent(uint UID, Resource::ResourceNotificationType type) override;
+	void GatherDependencies(std::vector<uint>& dependencies) const override;
 	void CreateInspectorNode() override;
 
 
 	static inline Component::ComponentType GetType() { return Component::ComponentType::Mesh; };
 public:
-	ResourceMesh* resource_mesh = nullptr;
+	ResourceHandle<ResourceMesh> resource_mesh;
 };
 
 #endif
@@ -162,12 +162,13 @@ void ComponentMeshRenderer::ONResourceEvent(uint UID, Resource::ResourceNotifica
 	switch (type)
 	{
 	case Resource::ResourceNotificationType::Overwrite:
-		if (material && UID == material->GetUID())
+		// --- The overwritten resource may already be gone, match by the UID the handle keeps ---
+		if (UID == material.GetUID())
 			material = (ResourceMaterial*)App->resources->GetResource(UID);
 		break;
 
 	case Resource::ResourceNotificationType::Deletion:
-		if (material && UID == material->GetUID())
+		if (UID == material.GetUID())
 			material = nullptr;
 		break;
 
@@ -176,6 +177,12 @@ void ComponentMeshRenderer::ONResourceEvent(uint UID, Resource::ResourceNotifica
 	}
 }
 
+void ComponentMeshRenderer::GatherDependencies(std::vector<uint>& dependencies) const
+{
+	if (material.GetUID())
+		dependencies.push_back(material.GetUID());
+}
+
 void ComponentMeshRenderer::CreateInspectorNode()
 {
 	ImGui::Checkbox("Vertex Normals", &draw_vertexnormals);
@@ -276,9 +283,9 @@ void ComponentMeshRenderer::CreateInspectorNode()
 					textSizeY = material->resource_diffuse->Texture_height;
 				}
 
-				ImGui::Text(std::to_string(textSizeX).c_str());
+				ImGui::Text("%u", textSizeX);
 				ImGui::SameLine();
-				ImGui::Text(std::to_string(textSizeY).c_str());
+				ImGui::Text("%u", textSizeY);
 
 				// --- Texture Preview ---
 				if (material->resource_diffuse)
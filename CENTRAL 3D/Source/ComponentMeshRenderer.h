@@ -2,6 +2,7 @@
 #define __COMPONENT_MESHRENDERER_H__
 
 #include "Component.h"
+#include "ResourceHandle.h"
 
 // Specifying normal vectors length (used when drawing normals)
 #define NORMAL_LENGTH 0.5
@@ -26,6 +27,7 @@ public:
 	json Save() const override;
 	void Load(json& node) override;
 	void ONResourceEvent(uint UID, Resource::ResourceNotificationType type) override;
+	void GatherDependencies(std::vector<uint>& dependencies) const override;
 	void CreateInspectorNode() override;
 
 	static inline Component::ComponentType GetType() { return Component::ComponentType::MeshRenderer; };
@@ -34,7 +36,7 @@ public:
 	bool draw_vertexnormals = false;
 	bool draw_facenormals = false;
 	bool checkers = false;
-	ResourceMaterial* material = nullptr;
+	ResourceHandle<ResourceMaterial> material;
 };
 
 #endif
\ No newline at end of file
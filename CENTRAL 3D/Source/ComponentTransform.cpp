@@ -94,6 +94,10 @@ void ComponentTransform::SetGlobalTransform(float4x4 new_transform)
 	Local_transform = localTransform;
 	Global_transform = new_transform;
 	update_transform = true;
+
+	// --- Static objects are left out of propagation, their box follows right away ---
+	if (GO->Static)
+		GO->UpdateAABB();
 }
 
 void ComponentTransform::UpdateLocalTransform()
@@ -102,9 +106,9 @@ void ComponentTransform::UpdateLocalTransform()
 	update_transform = true;
 }
 
-void ComponentTransform::OnUpdateTransform(const float4x4 & ParentGlobal)
+void ComponentTransform::OnUpdateTransform(const float4x4 & global)
 {
-	Global_transform = ParentGlobal * Local_transform;
+	Global_transform = global;
 	UpdateTRS();
 
 	update_transform = false;
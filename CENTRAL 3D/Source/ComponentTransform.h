@@ -24,7 +24,7 @@ public:
 	void			SetRotation(float3 euler_angles);
 	void			Scale(float x, float y, float z);
 	void			SetGlobalTransform(float4x4 new_transform);
-	void			OnUpdateTransform(const float4x4& ParentGlobal);
+	void			OnUpdateTransform(const float4x4& global); // Parent's global times local, see GameObject::UpdateTransforms
 	void			SetQuatRotation(Quat rotation);
 
 	// --- Save & Load ---
@@ -0,0 +1,467 @@
+#include "FileWatcher.h"
+#include "Application.h"
+#include "ModuleFileSystem.h"
+#include "Logger.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#include "mmgr/mmgr.h"
+
+FileWatcher::FileWatcher()
+{
+#ifdef _WIN32
+	memset(&overlapped, 0, sizeof(overlapped));
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+bool FileWatcher::Watch(const char* directory)
+{
+	Stop();
+
+	root = directory ? directory : "";
+
+	if (!root.empty() && root.back() != '/')
+		root.push_back('/');
+
+#ifdef _WIN32
+	directory_handle = CreateFileA(root.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+	if (directory_handle != INVALID_HANDLE_VALUE)
+	{
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+		buffer = new DWORD[FILE_WATCHER_BUFFER_SIZE / sizeof(DWORD)];
+		native = Issue();
+	}
+
+	if (!native)
+	{
+		CONSOLE_LOG("![Warning]: File Watcher: could not watch %s natively (%i), falling back to polling", root.c_str(), GetLastError());
+		Stop();
+	}
+#elif defined(__linux__)
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (inotify_fd >= 0)
+	{
+		buffer = new char[FILE_WATCHER_BUFFER_SIZE];
+
+		std::string base = root;
+		base.pop_back();
+		AddWatches(base);
+
+		native = !watches.empty();
+	}
+
+	if (!native)
+	{
+		CONSOLE_LOG("![Warning]: File Watcher: could not watch %s with inotify, falling back to polling", root.c_str());
+		Stop();
+	}
+#endif
+
+	if (!native)
+		StartPolling();
+
+	watching = true;
+	LOG_INFO(LogCategory::Resources, "File Watcher: watching %s through %s", root.c_str(), GetBackendName());
+
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+#ifdef _WIN32
+	if (directory_handle != INVALID_HANDLE_VALUE)
+	{
+		// --- The OS writes to the buffer until the read is cancelled ---
+		DWORD bytes = 0;
+		CancelIo(directory_handle);
+		GetOverlappedResult(directory_handle, &overlapped, &bytes, TRUE);
+		CloseHandle(directory_handle);
+		directory_handle = INVALID_HANDLE_VALUE;
+	}
+
+	if (overlapped.hEvent)
+		CloseHandle(overlapped.hEvent);
+
+	memset(&overlapped, 0, sizeof(overlapped));
+#elif defined(__linux__)
+	if (inotify_fd >= 0)
+		close(inotify_fd);
+
+	inotify_fd = -1;
+	watches.clear();
+#endif
+
+#if defined(_WIN32) || defined(__linux__)
+	if (buffer)
+		delete[] buffer;
+
+	buffer = nullptr;
+#endif
+
+	tree.clear();
+	watching = false;
+	native = false;
+}
+
+void FileWatcher::Poll(std::vector<FileEvent>& events)
+{
+	if (!watching)
+		return;
+
+	if (!native)
+	{
+		PollTree(events);
+		return;
+	}
+
+#ifdef _WIN32
+	DWORD bytes = 0;
+
+	while (GetOverlappedResult(directory_handle, &overlapped, &bytes, FALSE))
+	{
+		// --- Nothing read means the buffer overflowed ---
+		if (bytes == 0)
+		{
+			FileEvent event;
+			event.type = FileEventType::Rescan;
+			event.path = root;
+			events.push_back(event);
+		}
+
+		const char* entry = (const char*)buffer;
+
+		while (bytes > 0)
+		{
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+
+			int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), nullptr, 0, nullptr, nullptr);
+			std::string name(length, '\0');
+			WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), &name[0], length, nullptr, nullptr);
+			App->fs->NormalizePath(name);
+
+			FileEvent event;
+			event.path = root + name;
+
+			switch (info->Action)
+			{
+			case FILE_ACTION_ADDED:
+				event.type = FileEventType::Created;
+				events.push_back(event);
+				break;
+
+			case FILE_ACTION_REMOVED:
+				event.type = FileEventType::Deleted;
+				events.push_back(event);
+				break;
+
+			case FILE_ACTION_MODIFIED:
+				event.type = FileEventType::Modified;
+				events.push_back(event);
+				break;
+
+			case FILE_ACTION_RENAMED_OLD_NAME:
+				rename_from = event.path;
+				break;
+
+			case FILE_ACTION_RENAMED_NEW_NAME:
+				event.type = FileEventType::Renamed;
+				event.old_path = rename_from;
+				events.push_back(event);
+				break;
+
+			default:
+				break;
+			}
+
+			if (info->NextEntryOffset == 0)
+				break;
+
+			entry += info->NextEntryOffset;
+		}
+
+		ResetEvent(overlapped.hEvent);
+
+		if (!Issue())
+		{
+			CONSOLE_LOG("|[error]: File Watcher: ReadDirectoryChangesW failed (%i), falling back to polling", GetLastError());
+			Stop();
+			StartPolling();
+			return;
+		}
+	}
+#elif defined(__linux__)
+	// --- A move is a pair of events sharing a cookie, the first one stands as a deletion until the second shows up ---
+	std::map<uint32, uint> moves;
+
+	while (true)
+	{
+		ssize_t length = read(inotify_fd, buffer, FILE_WATCHER_BUFFER_SIZE);
+
+		if (length <= 0)
+			break;
+
+		for (const char* entry = buffer; entry < buffer + length; entry += sizeof(inotify_event) + ((const inotify_event*)entry)->len)
+		{
+			const inotify_event* info = (const inotify_event*)entry;
+
+			if (info->mask & IN_Q_OVERFLOW)
+			{
+				FileEvent event;
+				event.type = FileEventType::Rescan;
+				event.path = root;
+				events.push_back(event);
+				continue;
+			}
+
+			std::map<int, std::string>::iterator watch = watches.find(info->wd);
+
+			if (watch == watches.end())
+				continue;
+
+			if (info->mask & IN_IGNORED)
+			{
+				watches.erase(watch);
+				continue;
+			}
+
+			// --- Events about the watched directory itself, its parent reports them too ---
+			if (info->len == 0)
+				continue;
+
+			FileEvent event;
+			event.path = watch->second + "/" + info->name;
+			event.directory = (info->mask & IN_ISDIR) != 0;
+
+			if (info->mask & IN_CREATE)
+			{
+				event.type = FileEventType::Created;
+				events.push_back(event);
+
+				if (event.directory)
+					AddWatches(event.path);
+			}
+			else if (info->mask & IN_DELETE)
+			{
+				event.type = FileEventType::Deleted;
+				events.push_back(event);
+			}
+			else if (info->mask & (IN_MODIFY | IN_CLOSE_WRITE))
+			{
+				event.type = FileEventType::Modified;
+				events.push_back(event);
+			}
+			else if (info->mask & IN_MOVED_FROM)
+			{
+				event.type = FileEventType::Deleted;
+				moves[info->cookie] = events.size();
+				events.push_back(event);
+			}
+			else if (info->mask & IN_MOVED_TO)
+			{
+				std::map<uint32, uint>::iterator move = moves.find(info->cookie);
+
+				if (move != moves.end())
+				{
+					FileEvent& from = events[move->second];
+					from.type = FileEventType::Renamed;
+					from.old_path = from.path;
+					from.path = event.path;
+					moves.erase(move);
+
+					if (from.directory)
+						RenameWatches(from.old_path, from.path);
+				}
+				else
+				{
+					// --- Moved in from outside the tree ---
+					event.type = FileEventType::Created;
+					events.push_back(event);
+
+					if (event.directory)
+						AddWatches(event.path);
+				}
+			}
+		}
+	}
+
+	// --- Moved out of the tree, whatever is still watched under it would report the old paths ---
+	for (std::map<uint32, uint>::const_iterator move = moves.begin(); move != moves.end(); ++move)
+	{
+		if (events[move->second].directory)
+			RenameWatches(events[move->second].path, std::string());
+	}
+#endif
+}
+
+bool FileWatcher::IsWatching() const
+{
+	return watching;
+}
+
+const char* FileWatcher::GetBackendName() const
+{
+#ifdef _WIN32
+	if (native)
+		return "ReadDirectoryChangesW";
+#elif defined(__linux__)
+	if (native)
+		return "inotify";
+#endif
+
+	return "polling";
+}
+
+void FileWatcher::StartPolling()
+{
+	// --- Without a native backend the tree is walked every so often and compared with the last walk ---
+	tree.clear();
+	WalkTree(root, tree);
+	poll_timer.Start();
+
+	native = false;
+	watching = true;
+}
+
+void FileWatcher::PollTree(std::vector<FileEvent>& events)
+{
+	if (poll_timer.Read() < FILE_WATCHER_POLL_MS)
+		return;
+
+	poll_timer.Start();
+
+	std::map<std::string, FileEvent> current;
+	WalkTree(root, current);
+
+	for (std::map<std::string, FileEvent>::const_iterator it = current.begin(); it != current.end(); ++it)
+	{
+		std::map<std::string, FileEvent>::const_iterator last = tree.find(it->first);
+
+		if (last == tree.end())
+		{
+			FileEvent event = it->second;
+			event.type = FileEventType::Created;
+			events.push_back(event);
+		}
+		else if (!it->second.directory && (last->second.time != it->second.time || last->second.size != it->second.size))
+		{
+			FileEvent event = it->second;
+			event.type = FileEventType::Modified;
+			events.push_back(event);
+		}
+	}
+
+	for (std::map<std::string, FileEvent>::const_iterator it = tree.begin(); it != tree.end(); ++it)
+	{
+		if (current.find(it->first) == current.end())
+		{
+			FileEvent event;
+			event.type = FileEventType::Deleted;
+			event.path = it->first;
+			event.directory = it->second.directory;
+			events.push_back(event);
+		}
+	}
+
+	tree.swap(current);
+}
+
+void FileWatcher::WalkTree(const std::string& directory, std::map<std::string, FileEvent>& tree) const
+{
+	std::vector<std::string> files;
+	std::vector<std::string> dirs;
+
+	App->fs->DiscoverFiles(directory.c_str(), files, dirs);
+
+	for (uint i = 0; i < dirs.size(); ++i)
+	{
+		FileEvent& event = tree[directory + dirs[i]];
+		event.path = directory + dirs[i];
+		event.directory = true;
+
+		WalkTree(event.path + "/", tree);
+	}
+
+	for (uint i = 0; i < files.size(); ++i)
+	{
+		FileEvent& event = tree[directory + files[i]];
+		event.path = directory + files[i];
+		App->fs->GetFileStat(event.path.c_str(), event.time, event.size);
+	}
+}
+
+#ifdef _WIN32
+bool FileWatcher::Issue()
+{
+	return ReadDirectoryChangesW(directory_handle, buffer, FILE_WATCHER_BUFFER_SIZE, TRUE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION,
+		nullptr, &overlapped, nullptr) != 0;
+}
+#endif
+
+#if defined(__linux__)
+void FileWatcher::AddWatches(const std::string& directory)
+{
+	// --- inotify is not recursive, every directory gets its own watch ---
+	int descriptor = inotify_add_watch(inotify_fd, directory.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+
+	if (descriptor < 0)
+		return;
+
+	watches[descriptor] = directory;
+
+	DIR* handle = opendir(directory.c_str());
+
+	if (handle == nullptr)
+		return;
+
+	while (dirent* entry = readdir(handle))
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+
+		std::string child = directory + "/" + entry->d_name;
+		struct stat info;
+
+		if (stat(child.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+			AddWatches(child);
+	}
+
+	closedir(handle);
+}
+
+void FileWatcher::RenameWatches(const std::string& old_path, const std::string& new_path)
+{
+	// --- Watches follow the directory, only their paths go stale. No new path means it left the tree ---
+	for (std::map<int, std::string>::iterator it = watches.begin(); it != watches.end();)
+	{
+		const std::string& path = it->second;
+
+		if (path == old_path || path.compare(0, old_path.size() + 1, old_path + "/") == 0)
+		{
+			if (new_path.empty())
+			{
+				inotify_rm_watch(inotify_fd, it->first);
+				it = watches.erase(it);
+				continue;
+			}
+
+			it->second = new_path + path.substr(old_path.size());
+		}
+
+		++it;
+	}
+}
+#endif
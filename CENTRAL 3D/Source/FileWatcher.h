@@ -0,0 +1,87 @@
+#ifndef __FILE_WATCHER_H__
+#define __FILE_WATCHER_H__
+
+#include "Globals.h"
+#include "Timer.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define FILE_WATCHER_BUFFER_SIZE 65536 // Bytes of notifications the OS can queue between polls, more and it reports an overflow
+#define FILE_WATCHER_POLL_MS 1000 // Between walks of the tree, only when there is no native backend
+
+enum class FileEventType
+{
+	Created = 0,
+	Modified,
+	Deleted,
+	Renamed,
+	Rescan // The OS dropped notifications, anything may have changed
+};
+
+struct FileEvent
+{
+	FileEventType type = FileEventType::Modified;
+	std::string path; // Relative to the working directory, / separated, no trailing / on directories
+	std::string old_path; // Renamed only
+	bool directory = false; // Not known for deleted paths
+
+	// --- Filled once changes settle, zero for what is gone ---
+	uint64 time = 0;
+	uint64 size = 0;
+	uint64 hash = 0; // Content, files only
+};
+
+// --- Recursive directory watcher. ReadDirectoryChangesW on Windows, inotify on Linux, a timed walk of the tree elsewhere ---
+// --- Never blocks, Poll hands out whatever the OS reported since the last call ---
+class FileWatcher
+{
+public:
+
+	FileWatcher();
+	~FileWatcher();
+
+	bool Watch(const char* directory);
+	void Stop();
+
+	void Poll(std::vector<FileEvent>& events);
+
+	bool IsWatching() const;
+	const char* GetBackendName() const;
+
+private:
+
+	void StartPolling();
+	void PollTree(std::vector<FileEvent>& events);
+	void WalkTree(const std::string& directory, std::map<std::string, FileEvent>& tree) const;
+
+#if defined(__linux__)
+	void AddWatches(const std::string& directory);
+	void RenameWatches(const std::string& old_path, const std::string& new_path);
+#endif
+
+private:
+
+	std::string root; // With its trailing /
+	bool watching = false;
+	bool native = false;
+
+#ifdef _WIN32
+	HANDLE directory_handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped;
+	DWORD* buffer = nullptr; // Notifications must be DWORD aligned
+	std::string rename_from;
+
+	bool Issue();
+#elif defined(__linux__)
+	int inotify_fd = -1;
+	std::map<int, std::string> watches; // Descriptor to directory
+	char* buffer = nullptr;
+#endif
+
+	// --- Polling fallback ---
+	Timer poll_timer;
+	std::map<std::string, FileEvent> tree; // Last walk, by path
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include "FrameAllocator.h"
+#include <string.h>
+
+#include "mmgr/mmgr.h"
+
+#define FRAME_DEAD_BYTE 0xDD
+
+// --- Block moves debug mode makes on every reset, left out of the per frame heap call count ---
+static std::atomic<uint64> debug_block_moves(0);
+
+// ----------------------------------------------------------------------------------------------------------
+// --- LinearArena ---
+
+LinearArena::LinearArena()
+{
+}
+
+LinearArena::~LinearArena()
+{
+	while (overflow)
+	{
+		OverflowBlock* next = overflow->next;
+		Memory::Free(overflow);
+		overflow = next;
+	}
+
+	Memory::Free(block);
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+	if (alignment < MEMORY_DEFAULT_ALIGNMENT)
+		alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+	if (!block)
+	{
+		capacity = FRAME_ARENA_SIZE;
+		block = (char*)Memory::Allocate(MemoryTag::Transient, capacity);
+	}
+
+	size_t address = ((size_t)block + offset + alignment - 1) & ~(alignment - 1);
+	size_t end = address - (size_t)block + size;
+
+	if (end <= capacity)
+	{
+		offset = end;
+
+		if (offset + overflow_bytes > peak)
+			peak = offset + overflow_bytes;
+
+		return (void*)address;
+	}
+
+	// --- Out of space, take a block from the heap for this round and grow on reset ---
+	OverflowBlock* extra = (OverflowBlock*)Memory::Allocate(MemoryTag::Transient, sizeof(OverflowBlock) + size + alignment);
+	extra->next = overflow;
+	extra->size = size + alignment;
+	overflow = extra;
+	overflow_bytes += size + alignment;
+
+	if (offset + overflow_bytes > peak)
+		peak = offset + overflow_bytes;
+
+	return (void*)(((size_t)(extra + 1) + alignment - 1) & ~(alignment - 1));
+}
+
+void LinearArena::Reset()
+{
+	if (!block)
+		return;
+
+	while (overflow)
+	{
+		OverflowBlock* next = overflow->next;
+		Memory::Free(overflow);
+		overflow = next;
+	}
+
+#if MEMORY_DEBUG
+	// --- Anyone still reading last frame's data gets garbage, and a new block so stale pointers never alias new data ---
+	memset(block, FRAME_DEAD_BYTE, offset);
+	bool move = true;
+#else
+	bool move = overflow_bytes > 0;
+#endif
+
+	if (move)
+	{
+		// --- Room for everything this round needed plus some slack ---
+		if (overflow_bytes > 0)
+			capacity = (capacity + overflow_bytes) * 3 / 2;
+
+		if (overflow_bytes == 0)
+			debug_block_moves.fetch_add(1, std::memory_order_relaxed);
+
+		char* old_block = block;
+		block = (char*)Memory::Allocate(MemoryTag::Transient, capacity);
+		Memory::Free(old_block);
+	}
+
+	overflow_bytes = 0;
+	offset = 0;
+}
+
+bool LinearArena::Owns(const void* ptr) const
+{
+	if (ptr >= block && ptr < block + offset)
+		return true;
+
+	for (OverflowBlock* extra = overflow; extra; extra = extra->next)
+	{
+		if (ptr >= (const void*)(extra + 1) && ptr < (const void*)((char*)(extra + 1) + extra->size))
+			return true;
+	}
+
+	return false;
+}
+
+size_t LinearArena::GetUsed() const
+{
+	return offset + overflow_bytes;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+	return capacity;
+}
+
+size_t LinearArena::GetPeak() const
+{
+	return peak;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- FrameMemory ---
+
+static std::atomic<uint64> frame_number(1);
+static uint64 heap_calls_mark = 0;
+static uint64 frame_heap_calls = 0;
+
+// --- Arena used on frame N is reset the next time the thread allocates on frame N + 2 ---
+struct ThreadArenas
+{
+	LinearArena arenas[2];
+	uint64 stamps[2] = { 0, 0 };
+
+	LinearArena& Get(uint64 frame)
+	{
+		uint index = (uint)(frame & 1);
+
+		if (stamps[index] != frame)
+		{
+			arenas[index].Reset();
+			stamps[index] = frame;
+		}
+
+		return arenas[index];
+	}
+};
+
+static thread_local ThreadArenas thread_arenas;
+
+void* FrameMemory::Allocate(size_t size, size_t alignment)
+{
+	return thread_arenas.Get(frame_number.load(std::memory_order_relaxed)).Allocate(size, alignment);
+}
+
+void FrameMemory::EndFrame()
+{
+	uint64 heap_calls = Memory::GetHeapCalls() - debug_block_moves.load(std::memory_order_relaxed);
+	frame_heap_calls = heap_calls - heap_calls_mark;
+	heap_calls_mark = heap_calls;
+
+	uint64 frame = frame_number.fetch_add(1) + 1;
+
+	// --- Workers reset theirs on their next allocation ---
+	thread_arenas.Get(frame);
+}
+
+uint64 FrameMemory::GetHeapCalls()
+{
+	return frame_heap_calls;
+}
+
+uint64 FrameMemory::GetFrame()
+{
+	return frame_number.load(std::memory_order_relaxed);
+}
+
+bool FrameMemory::IsAlive(const void* ptr)
+{
+	uint64 frame = GetFrame();
+
+	for (uint i = 0; i < 2; ++i)
+	{
+		if (thread_arenas.stamps[i] + 1 >= frame && thread_arenas.arenas[i].Owns(ptr))
+			return true;
+	}
+
+	return false;
+}
+
+size_t FrameMemory::GetUsed()
+{
+	return thread_arenas.Get(GetFrame()).GetUsed();
+}
+
+size_t FrameMemory::GetPeak()
+{
+	size_t a = thread_arenas.arenas[0].GetPeak();
+	size_t b = thread_arenas.arenas[1].GetPeak();
+
+	return a > b ? a : b;
+}
@@ -0,0 +1,113 @@
+#ifndef __FRAME_ALLOCATOR_H__
+#define __FRAME_ALLOCATOR_H__
+
+#include "Allocator.h"
+#include <vector>
+#include <map>
+#include <string>
+
+#define FRAME_ARENA_SIZE 256 * 1024 // Starting size of each thread's arenas, they grow to what a frame needed
+
+// --- Bump allocator, frees everything at once ---
+class LinearArena
+{
+public:
+
+	LinearArena();
+	~LinearArena();
+
+	void* Allocate(size_t size, size_t alignment);
+
+	// --- O(1) unless the arena overflowed last time, then it grows so the next round fits in one block ---
+	// --- Debug mode poisons what was used and moves to a new block every time ---
+	void Reset();
+
+	bool Owns(const void* ptr) const;
+	size_t GetUsed() const;
+	size_t GetCapacity() const;
+	size_t GetPeak() const;
+
+private:
+
+	struct OverflowBlock
+	{
+		OverflowBlock* next;
+		size_t size;
+	};
+
+	char* block = nullptr;
+	size_t capacity = 0;
+	size_t offset = 0;
+	size_t peak = 0;
+
+	// --- Blocks taken when the main one ran out, released on reset ---
+	OverflowBlock* overflow = nullptr;
+	size_t overflow_bytes = 0;
+};
+
+// --- Each thread gets two arenas and alternates them every frame ---
+// --- Memory from frame N is valid until frame N + 1 ends, never keep it longer than that ---
+class FrameMemory
+{
+public:
+
+	static void* Allocate(size_t size, size_t alignment = MEMORY_DEFAULT_ALIGNMENT);
+
+	// --- Called once per frame by the main thread, at Application::FinishUpdate ---
+	static void EndFrame();
+
+	static uint64 GetFrame();
+	static uint64 GetHeapCalls(); // Heap allocations made by every thread during the last finished frame, should stay at 0 once warm
+	static bool IsAlive(const void* ptr); // Whether ptr belongs to one of the calling thread's live arenas
+	static size_t GetUsed(); // Calling thread's current arena
+	static size_t GetPeak();
+};
+
+// --- STL adapter, containers using it must be local to a frame (or the next one) ---
+// --- In debug mode the container remembers the frame it was created on and complains if it is still growing later ---
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef FrameAllocator<U> other;
+	};
+
+	FrameAllocator() : frame(FrameMemory::GetFrame()) {}
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : frame(other.frame) {}
+
+	T* allocate(size_t count)
+	{
+#if MEMORY_DEBUG
+		if (FrameMemory::GetFrame() > frame + 1)
+			CONSOLE_LOG("|[error]: FrameMemory: container created on frame %u is still in use on frame %u", (uint)frame, (uint)FrameMemory::GetFrame());
+#endif
+		return static_cast<T*>(FrameMemory::Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* ptr, size_t) {}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>&) const { return true; }
+
+	template<typename U>
+	bool operator!=(const FrameAllocator<U>&) const { return false; }
+
+	uint64 frame;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+template<typename Key, typename T>
+using FrameMap = std::map<Key, T, std::less<Key>, FrameAllocator<std::pair<const Key, T>>>;
+
+typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+
+#endif
@@ -0,0 +1,363 @@
+#include "FrameScheduler.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "mmgr/mmgr.h"
+
+// --- Slices of a flush, nothing else is waiting for the frame ---
+#define SCHEDULER_FLUSH_SLICE_MS 1000000.0
+
+DeferredSlice::DeferredSlice(double budget_ms) : budget_ms(budget_ms)
+{
+}
+
+bool DeferredSlice::OutOfTime() const
+{
+	return timer.ReadMs() >= budget_ms;
+}
+
+double DeferredSlice::GetRemainingMs() const
+{
+	double remaining = budget_ms - timer.ReadMs();
+	return remaining > 0.0 ? remaining : 0.0;
+}
+
+FrameScheduler& FrameScheduler::Get()
+{
+	static FrameScheduler scheduler;
+	return scheduler;
+}
+
+FrameScheduler::FrameScheduler()
+{
+	memset(history, 0, sizeof(history));
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	for (uint i = 0; i < entries.size(); ++i)
+		delete entries[i];
+
+	entries.clear();
+}
+
+DeferredTaskId FrameScheduler::Schedule(const char* name, DeferredPriority priority, DeferredTask task, bool unique)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (unique)
+	{
+		for (uint i = 0; i < entries.size(); ++i)
+		{
+			// --- One already in the middle of a slice may have read its input, that one does not count ---
+			if (!entries[i]->cancelled && entries[i] != running && strcmp(entries[i]->info.name, name) == 0)
+				return entries[i]->info.id;
+		}
+	}
+
+	Entry* entry = new Entry;
+	entry->info.id = next_id++;
+	entry->info.name = name;
+	entry->info.priority = priority;
+	entry->task = task;
+	entry->sequence = entry->info.id;
+	entries.push_back(entry);
+
+	return entry->info.id;
+}
+
+bool FrameScheduler::Cancel(DeferredTaskId id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		Entry* entry = entries[i];
+
+		if (entry->info.id != id || entry->cancelled)
+			continue;
+
+		cancelled++;
+
+		if (entry == running)
+			entry->cancelled = true;
+		else
+		{
+			entries.erase(entries.begin() + i);
+			delete entry;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+uint FrameScheduler::CancelAll(const char* name)
+{
+	std::vector<DeferredTaskId> ids;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (uint i = 0; i < entries.size(); ++i)
+		{
+			if (!entries[i]->cancelled && strcmp(entries[i]->info.name, name) == 0)
+				ids.push_back(entries[i]->info.id);
+		}
+	}
+
+	uint count = 0;
+
+	for (uint i = 0; i < ids.size(); ++i)
+		count += Cancel(ids[i]) ? 1 : 0;
+
+	return count;
+}
+
+bool FrameScheduler::IsPending(DeferredTaskId id) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i]->info.id == id)
+			return !entries[i]->cancelled;
+	}
+
+	return false;
+}
+
+void FrameScheduler::RunFrame(double available_ms)
+{
+	PROFILE_SCOPE("Deferred Work");
+
+	PerfTimer timer;
+	frame++;
+
+	// --- Whatever the frame can spare, up to the budget ---
+	granted_ms = available_ms < budget_ms ? available_ms : budget_ms;
+	granted_ms = granted_ms > 0.0 ? granted_ms : 0.0;
+
+	bool ran = false;
+
+	// --- Every task gets at most a slice per frame, one that is waiting on something does not spin the rest of the budget away ---
+	while (true)
+	{
+		double remaining = granted_ms - timer.ReadMs();
+
+		if (remaining >= SCHEDULER_MIN_SLICE_MS)
+		{
+			Entry* next = PickNext(false);
+
+			if (next == nullptr)
+				break;
+
+			RunSlice(next, remaining);
+			ran = true;
+			continue;
+		}
+
+		// --- Out of time. Frames that never have any left would starve the queue, the longest waiting task still gets a slice ---
+		if (!ran)
+		{
+			Entry* next = PickNext(true);
+
+			if (next)
+				RunSlice(next, SCHEDULER_MIN_SLICE_MS);
+		}
+
+		break;
+	}
+
+	// --- What did not run this frame waited one more ---
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (uint i = 0; i < entries.size(); ++i)
+		{
+			if (entries[i]->ran_frame != frame)
+				entries[i]->info.waited++;
+		}
+	}
+
+	used_ms = timer.ReadMs();
+	history[history_count % SCHEDULER_HISTORY] = (float)used_ms;
+	history_count++;
+}
+
+void FrameScheduler::Flush()
+{
+	PROFILE_SCOPE("Deferred Flush");
+
+	// --- Tasks may schedule more, run until nothing is left ---
+	while (GetQueueDepth() > 0)
+	{
+		frame++;
+
+		while (Entry* next = PickNext(false))
+			RunSlice(next, SCHEDULER_FLUSH_SLICE_MS);
+	}
+}
+
+bool FrameScheduler::RunsBefore(const Entry* a, const Entry* b)
+{
+	// --- Starving tasks first, longest waiting first. Then by priority and in the order they were scheduled ---
+	bool starving_a = a->info.waited >= SCHEDULER_STARVATION_FRAMES;
+	bool starving_b = b->info.waited >= SCHEDULER_STARVATION_FRAMES;
+
+	if (starving_a != starving_b)
+		return starving_a;
+
+	if (starving_a && a->info.waited != b->info.waited)
+		return a->info.waited > b->info.waited;
+
+	if (a->info.priority != b->info.priority)
+		return a->info.priority < b->info.priority;
+
+	return a->sequence < b->sequence;
+}
+
+FrameScheduler::Entry* FrameScheduler::PickNext(bool starving_only)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Entry* best = nullptr;
+
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		Entry* entry = entries[i];
+
+		if (entry->cancelled || entry->ran_frame == frame)
+			continue;
+
+		if (starving_only && entry->info.waited < SCHEDULER_STARVATION_FRAMES)
+			continue;
+
+		if (best == nullptr || RunsBefore(entry, best))
+			best = entry;
+	}
+
+	running = best;
+
+	return best;
+}
+
+void FrameScheduler::RunSlice(Entry* entry, double budget_ms)
+{
+	PerfTimer timer;
+	bool done = false;
+
+	// --- Outside the lock, tasks schedule and cancel others ---
+	{
+		PROFILE_SCOPE(entry->info.name);
+		DeferredSlice slice(budget_ms);
+		done = entry->task(slice);
+	}
+
+	double ms = timer.ReadMs();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	running = nullptr;
+
+	entry->info.slices++;
+	entry->info.ms += ms;
+	entry->info.waited = 0;
+	entry->ran_frame = frame;
+
+	if (done || entry->cancelled)
+	{
+		completed += done && !entry->cancelled ? 1 : 0;
+		entries.erase(std::find(entries.begin(), entries.end(), entry));
+		delete entry;
+	}
+}
+
+float FrameScheduler::GetBudgetMs() const
+{
+	return budget_ms;
+}
+
+void FrameScheduler::SetBudgetMs(float ms)
+{
+	budget_ms = ms > 0.0f ? ms : 0.0f;
+}
+
+uint FrameScheduler::GetQueueDepth() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint count = 0;
+
+	for (uint i = 0; i < entries.size(); ++i)
+		count += entries[i]->cancelled ? 0 : 1;
+
+	return count;
+}
+
+uint FrameScheduler::GetQueueDepth(DeferredPriority priority) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint count = 0;
+
+	for (uint i = 0; i < entries.size(); ++i)
+		count += !entries[i]->cancelled && entries[i]->info.priority == priority ? 1 : 0;
+
+	return count;
+}
+
+void FrameScheduler::GetTasks(std::vector<DeferredTaskInfo>& tasks) const
+{
+	std::vector<const Entry*> sorted;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		if (!entries[i]->cancelled)
+			sorted.push_back(entries[i]);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), RunsBefore);
+
+	tasks.clear();
+
+	for (uint i = 0; i < sorted.size(); ++i)
+		tasks.push_back(sorted[i]->info);
+}
+
+double FrameScheduler::GetGrantedMs() const
+{
+	return granted_ms;
+}
+
+double FrameScheduler::GetUsedMs() const
+{
+	return used_ms;
+}
+
+float FrameScheduler::GetUsedMs(uint index) const
+{
+	uint count = GetHistoryCount();
+	uint first = history_count - count;
+
+	return history[(first + index) % SCHEDULER_HISTORY];
+}
+
+uint FrameScheduler::GetHistoryCount() const
+{
+	return history_count < SCHEDULER_HISTORY ? history_count : SCHEDULER_HISTORY;
+}
+
+uint64 FrameScheduler::GetCompleted() const
+{
+	return completed;
+}
+
+uint64 FrameScheduler::GetCancelled() const
+{
+	return cancelled;
+}
@@ -0,0 +1,125 @@
+#ifndef __FRAME_SCHEDULER_H__
+#define __FRAME_SCHEDULER_H__
+
+#include "Globals.h"
+#include "PerfTimer.h"
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#define SCHEDULER_DEFAULT_BUDGET_MS 2.0f // Most a frame gives to deferred work, less when the frame has less time left
+#define SCHEDULER_MARGIN_MS 1.0 // Kept free before the frame's deadline, pacing needs it to wake up on time
+#define SCHEDULER_STARVATION_FRAMES 30 // Frames a task waits before it goes ahead of every priority
+#define SCHEDULER_MIN_SLICE_MS 0.5 // A starving task gets at least this much, even from a frame with no time left
+#define SCHEDULER_HISTORY 128 // Frames of budget use kept for the editor
+
+enum class DeferredPriority
+{
+	High = 0,
+	Normal,
+	Low,
+	count
+};
+
+// --- Handed to each slice, a task checks it between units of work and returns once it is out of time ---
+class DeferredSlice
+{
+public:
+
+	DeferredSlice(double budget_ms);
+
+	bool OutOfTime() const;
+	double GetRemainingMs() const;
+
+private:
+
+	PerfTimer timer;
+	double budget_ms = 0.0;
+};
+
+// --- One slice of a task, true once it is done. False to be called again on a later frame ---
+typedef std::function<bool(const DeferredSlice& slice)> DeferredTask;
+typedef uint64 DeferredTaskId; // 0 is never a task
+
+struct DeferredTaskInfo
+{
+	DeferredTaskId id = 0;
+	const char* name = nullptr;
+	DeferredPriority priority = DeferredPriority::Normal;
+	uint waited = 0; // Frames since it last ran
+	uint slices = 0;
+	double ms = 0.0; // Spent on it so far
+};
+
+// --- Expensive but non urgent work, run a slice at a time inside what is left of each frame ---
+// --- Scheduling and cancelling is thread safe, tasks always run on the main thread ---
+class FrameScheduler
+{
+public:
+
+	static FrameScheduler& Get();
+
+	// --- name must outlive the scheduler, a literal. Unique tasks are not added twice, scheduling one by the name of a pending one returns that one ---
+	DeferredTaskId Schedule(const char* name, DeferredPriority priority, DeferredTask task, bool unique = false);
+	bool Cancel(DeferredTaskId id); // A task in the middle of a slice is dropped once it returns
+	uint CancelAll(const char* name); // Every task by that name
+	bool IsPending(DeferredTaskId id) const;
+
+	// --- Main thread, once per frame. available_ms is what frame pacing can spare, the budget caps it ---
+	void RunFrame(double available_ms);
+
+	// --- Main thread, runs everything to completion ---
+	void Flush();
+
+	// --- Budget ---
+	float GetBudgetMs() const;
+	void SetBudgetMs(float ms);
+
+	// --- Stats, main thread ---
+	uint GetQueueDepth() const;
+	uint GetQueueDepth(DeferredPriority priority) const;
+	void GetTasks(std::vector<DeferredTaskInfo>& tasks) const; // In the order they would run
+	double GetGrantedMs() const; // Last frame
+	double GetUsedMs() const; // Last frame
+	float GetUsedMs(uint index) const; // 0 is the oldest frame in the history
+	uint GetHistoryCount() const;
+	uint64 GetCompleted() const;
+	uint64 GetCancelled() const;
+
+private:
+
+	FrameScheduler();
+	~FrameScheduler();
+
+	struct Entry
+	{
+		DeferredTaskInfo info;
+		DeferredTask task;
+		uint64 sequence = 0;
+		uint64 ran_frame = 0;
+		bool cancelled = false;
+	};
+
+	static bool RunsBefore(const Entry* a, const Entry* b);
+	Entry* PickNext(bool starving_only);
+	void RunSlice(Entry* entry, double budget_ms);
+
+private:
+
+	mutable std::mutex mutex;
+	std::vector<Entry*> entries; // Added to by any thread, only removed from by the main thread
+	Entry* running = nullptr;
+
+	DeferredTaskId next_id = 1;
+	uint64 frame = 0;
+	float budget_ms = SCHEDULER_DEFAULT_BUDGET_MS;
+
+	double granted_ms = 0.0;
+	double used_ms = 0.0;
+	float history[SCHEDULER_HISTORY];
+	uint history_count = 0;
+	uint64 completed = 0;
+	uint64 cancelled = 0;
+};
+
+#endif
@@ -0,0 +1,353 @@
+#include "FrameStats.h"
+#include "Application.h"
+#include "ModuleEventManager.h"
+#include "Math.h"
+
+#include <fstream>
+#include <math.h>
+#include <string.h>
+
+#include "mmgr/mmgr.h"
+
+// --- Growth between consecutive buckets, bucket 0 takes everything under FRAME_STATS_MIN_MS ---
+static const double bucket_ratio = pow((double)FRAME_STATS_MAX_MS / FRAME_STATS_MIN_MS, 1.0 / (FRAME_STATS_BUCKETS - 2));
+
+FrameStats& FrameStats::Get()
+{
+	static FrameStats stats;
+	return stats;
+}
+
+FrameStats::FrameStats()
+{
+	Clear();
+}
+
+FrameStats::~FrameStats()
+{
+}
+
+void FrameStats::EndFrame()
+{
+	float ms = (float)frame_timer.ReadMs();
+	frame_timer.Start();
+
+	if (series_count == 0)
+		AddSeries("Frame");
+
+	// --- Compared against the frames before this one ---
+	float median = GetPercentile(50.0f);
+	bool hitch = frame_count >= FRAME_STATS_WARMUP && ms > median * hitch_factor;
+
+	// --- The oldest frame leaves the window ---
+	uint slot = frame_count % FRAME_STATS_FRAMES;
+
+	if (frame_count >= FRAME_STATS_FRAMES)
+	{
+		for (uint i = 0; i < series_count; ++i)
+			histograms[i][GetBucket(frame_ms[slot][i])]--;
+	}
+
+	memset(frame_ms[slot], 0, sizeof(frame_ms[slot]));
+	frame_ms[slot][FRAME_STATS_FRAME_SERIES] = ms;
+	frame_hitch[slot] = hitch;
+
+	// --- Module times, from the scopes Application::Update opens around each of them ---
+	Profiler& profiler = Profiler::Get();
+	ProfileFrame profile_frame;
+	bool profiled = profiler.GetFrameCount() > last_profiler_frame && profiler.GetFrame(profiler.GetFrameCount() - 1, profile_frame);
+
+	if (profiled)
+	{
+		last_profiler_frame = profiler.GetFrameCount();
+		uint main_thread = profiler.GetThreadIndex();
+
+		for (uint64 i = profile_frame.first_event; i < profile_frame.end_event; ++i)
+		{
+			const ProfileEvent& event = profiler.GetEvent(i);
+
+			if (event.thread != main_thread || event.depth != 1)
+				continue;
+
+			uint series = GetSeries(event.name);
+
+			if (series == FRAME_STATS_MAX_SERIES)
+				series = AddSeries(event.name);
+
+			if (series < FRAME_STATS_MAX_SERIES)
+				frame_ms[slot][series] += (event.end - event.start) / 1000000.0f;
+		}
+	}
+
+	for (uint i = 0; i < series_count; ++i)
+		histograms[i][GetBucket(frame_ms[slot][i])]++;
+
+	frame_count++;
+
+	if (hitch)
+	{
+		CaptureHitch(ms, median, profiled ? &profile_frame : nullptr);
+		CONSOLE_LOG("Hitch on frame %llu: %.2f ms, %.1f times the median", frame_count - 1, ms, ms / median);
+	}
+}
+
+uint FrameStats::GetSeriesCount() const
+{
+	return series_count;
+}
+
+const char* FrameStats::GetSeriesName(uint series) const
+{
+	return series < series_count ? series_names[series] : "";
+}
+
+uint FrameStats::GetSeries(const char* name) const
+{
+	for (uint i = 0; i < series_count; ++i)
+	{
+		// --- Module names are the same pointer every frame, compare text only when they differ ---
+		if (series_names[i] == name || strcmp(series_names[i], name) == 0)
+			return i;
+	}
+
+	return FRAME_STATS_MAX_SERIES;
+}
+
+FrameStatsSummary FrameStats::GetSummary(uint series) const
+{
+	FrameStatsSummary summary;
+	summary.samples = GetFrameCount();
+
+	if (series >= series_count || summary.samples == 0)
+		return summary;
+
+	double sum = 0.0;
+
+	for (uint i = 0; i < summary.samples; ++i)
+	{
+		float ms = GetFrameMs(i, series);
+		sum += ms;
+
+		if (ms > summary.max)
+			summary.max = ms;
+	}
+
+	summary.mean = (float)(sum / summary.samples);
+
+	// --- Bucket interpolation can land past the real maximum, which is exact ---
+	summary.p50 = math::Min(GetPercentile(50.0f, series), summary.max);
+	summary.p95 = math::Min(GetPercentile(95.0f, series), summary.max);
+	summary.p99 = math::Min(GetPercentile(99.0f, series), summary.max);
+
+	return summary;
+}
+
+float FrameStats::GetPercentile(float percent, uint series) const
+{
+	uint count = GetFrameCount();
+
+	if (series >= series_count || count == 0)
+		return 0.0f;
+
+	// --- Nearest rank, placed linearly inside its bucket ---
+	uint rank = (uint)ceil(percent / 100.0f * count);
+	rank = rank < 1 ? 1 : (rank > count ? count : rank);
+
+	uint below = 0;
+
+	for (uint i = 0; i < FRAME_STATS_BUCKETS; ++i)
+	{
+		uint bucket_count = histograms[series][i];
+
+		if (below + bucket_count >= rank)
+		{
+			float start = GetBucketStart(i);
+			float end = i + 1 < FRAME_STATS_BUCKETS ? GetBucketStart(i + 1) : FRAME_STATS_MAX_MS;
+			return start + (end - start) * (float)(rank - below) / bucket_count;
+		}
+
+		below += bucket_count;
+	}
+
+	return FRAME_STATS_MAX_MS;
+}
+
+const uint* FrameStats::GetHistogram(uint series) const
+{
+	return histograms[series < FRAME_STATS_MAX_SERIES ? series : FRAME_STATS_FRAME_SERIES];
+}
+
+float FrameStats::GetBucketStart(uint bucket)
+{
+	return bucket == 0 ? 0.0f : (float)(FRAME_STATS_MIN_MS * pow(bucket_ratio, bucket - 1));
+}
+
+uint FrameStats::GetFrameCount() const
+{
+	return frame_count < FRAME_STATS_FRAMES ? (uint)frame_count : FRAME_STATS_FRAMES;
+}
+
+float FrameStats::GetFrameMs(uint index, uint series) const
+{
+	uint count = GetFrameCount();
+
+	if (index >= count || series >= series_count)
+		return 0.0f;
+
+	return frame_ms[(frame_count - count + index) % FRAME_STATS_FRAMES][series];
+}
+
+uint64 FrameStats::GetTotalFrames() const
+{
+	return frame_count;
+}
+
+const std::vector<FrameHitch>& FrameStats::GetHitches() const
+{
+	return hitches;
+}
+
+float FrameStats::GetHitchFactor() const
+{
+	return hitch_factor;
+}
+
+void FrameStats::SetHitchFactor(float factor)
+{
+	hitch_factor = factor > 1.0f ? factor : 1.0f;
+}
+
+void FrameStats::Clear()
+{
+	frame_count = 0;
+	series_count = 0;
+	last_profiler_frame = Profiler::Get().GetFrameCount();
+	hitches.clear();
+
+	memset(frame_hitch, 0, sizeof(frame_hitch));
+	memset(histograms, 0, sizeof(histograms));
+	frame_timer.Start();
+}
+
+bool FrameStats::ExportCSV(const char* path) const
+{
+	std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+
+	if (!file.is_open())
+	{
+		CONSOLE_LOG("|[error]: FrameStats: could not open %s to export frame times", path);
+		return false;
+	}
+
+	file << "Frame,Hitch";
+
+	for (uint i = 0; i < series_count; ++i)
+		file << "," << series_names[i];
+
+	file << "\n";
+
+	uint count = GetFrameCount();
+
+	for (uint i = 0; i < count; ++i)
+	{
+		uint64 frame = frame_count - count + i;
+		file << frame << "," << (frame_hitch[frame % FRAME_STATS_FRAMES] ? 1 : 0);
+
+		for (uint j = 0; j < series_count; ++j)
+			file << "," << GetFrameMs(i, j);
+
+		file << "\n";
+	}
+
+	CONSOLE_LOG("FrameStats: %u frames exported to %s", count, path);
+
+	return true;
+}
+
+bool FrameStats::ExportSummaryCSV(const char* path) const
+{
+	std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+
+	if (!file.is_open())
+	{
+		CONSOLE_LOG("|[error]: FrameStats: could not open %s to export the summary", path);
+		return false;
+	}
+
+	file << "Series,P50,P95,P99,Max,Mean,Samples\n";
+
+	for (uint i = 0; i < series_count; ++i)
+	{
+		FrameStatsSummary summary = GetSummary(i);
+		file << series_names[i] << "," << summary.p50 << "," << summary.p95 << "," << summary.p99 << "," << summary.max << "," << summary.mean << "," << summary.samples << "\n";
+	}
+
+	file << "Hitches," << hitches.size() << "\n";
+
+	CONSOLE_LOG("FrameStats: summary exported to %s", path);
+
+	return true;
+}
+
+uint FrameStats::AddSeries(const char* name)
+{
+	if (series_count == FRAME_STATS_MAX_SERIES)
+		return FRAME_STATS_MAX_SERIES;
+
+	// --- Frames already in the window did not have it, they count as zero. Added while a frame is being recorded, that
+	// one is counted when it ends and the frame it replaces has already left the window ---
+	series_names[series_count] = name;
+	histograms[series_count][0] = frame_count < FRAME_STATS_FRAMES ? (uint)frame_count : FRAME_STATS_FRAMES - 1;
+
+	return series_count++;
+}
+
+uint FrameStats::GetBucket(float ms)
+{
+	if (ms < FRAME_STATS_MIN_MS)
+		return 0;
+
+	uint bucket = 1 + (uint)(log(ms / FRAME_STATS_MIN_MS) / log(bucket_ratio));
+
+	return bucket < FRAME_STATS_BUCKETS ? bucket : FRAME_STATS_BUCKETS - 1;
+}
+
+void FrameStats::CaptureHitch(float ms, float median, const ProfileFrame* frame)
+{
+	if (hitches.size() == FRAME_STATS_HITCHES)
+		hitches.erase(hitches.begin());
+
+	hitches.push_back(FrameHitch());
+	FrameHitch& hitch = hitches.back();
+	hitch.frame = frame_count - 1;
+	hitch.ms = ms;
+	hitch.median = median;
+
+	// --- Every scope of the frame, on every thread ---
+	if (frame)
+	{
+		hitch.scopes.reserve((uint)(frame->end_event - frame->first_event));
+
+		for (uint64 i = frame->first_event; i < frame->end_event; ++i)
+			hitch.scopes.push_back(Profiler::Get().GetEvent(i));
+	}
+
+	// --- Events dispatched this frame, grouped by type ---
+	if (App && App->event_manager)
+	{
+		uint counts[EVENT_TYPES] = { 0 };
+		const std::vector<Event>& events = App->event_manager->GetDispatchedEvents();
+
+		for (uint i = 0; i < events.size(); ++i)
+		{
+			if (events[i].type != Event::EventType::invalid)
+				counts[(uint)events[i].type]++;
+		}
+
+		for (uint i = 0; i < EVENT_TYPES; ++i)
+		{
+			if (counts[i] > 0)
+				hitch.events.push_back(std::string(ModuleEventManager::GetTypeName((Event::EventType)i)) + " x" + std::to_string(counts[i]));
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef __FRAME_STATS_H__
+#define __FRAME_STATS_H__
+
+#include "Globals.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+#include <string>
+#include <vector>
+
+#define FRAME_STATS_FRAMES 1024 // Rolling window of frames
+#define FRAME_STATS_MAX_SERIES 32 // The frame plus every module
+#define FRAME_STATS_BUCKETS 128 // Logarithmic, from FRAME_STATS_MIN_MS to FRAME_STATS_MAX_MS
+#define FRAME_STATS_MIN_MS 0.25f
+#define FRAME_STATS_MAX_MS 1000.0f
+#define FRAME_STATS_HITCHES 16 // Latest captures kept
+#define FRAME_STATS_HITCH_FACTOR 2.0f // Default, frames this many times the median are hitches
+#define FRAME_STATS_WARMUP 60 // Frames before hitches are detected, the median needs history first
+#define FRAME_STATS_FILE SETTINGS_FOLDER "frame_stats.csv"
+#define FRAME_STATS_SUMMARY_FILE SETTINGS_FOLDER "frame_stats_summary.csv"
+
+// --- Series 0 is the whole frame, the rest are modules in the order they first ran ---
+#define FRAME_STATS_FRAME_SERIES 0
+
+struct FrameStatsSummary
+{
+	float p50 = 0.0f;
+	float p95 = 0.0f;
+	float p99 = 0.0f;
+	float max = 0.0f;
+	float mean = 0.0f;
+	uint samples = 0;
+};
+
+// --- A frame past the hitch threshold, with what ran during it ---
+struct FrameHitch
+{
+	uint64 frame = 0;
+	float ms = 0.0f;
+	float median = 0.0f;
+	std::vector<ProfileEvent> scopes; // Every thread, ProfileEvent::thread indexes Profiler::GetThreadName
+	std::vector<std::string> events; // Event manager dispatches, "Type x count"
+};
+
+// --- Frame and per module times for the last FRAME_STATS_FRAMES frames ---
+// --- Percentiles come from a histogram kept up to date as frames enter and leave the window ---
+class FrameStats
+{
+public:
+
+	static FrameStats& Get();
+
+	// --- Main thread, once per frame after the profiler closed it ---
+	void EndFrame();
+
+	// --- Queries, main thread ---
+	uint GetSeriesCount() const;
+	const char* GetSeriesName(uint series) const;
+	uint GetSeries(const char* name) const; // FRAME_STATS_MAX_SERIES if it does not exist
+	FrameStatsSummary GetSummary(uint series = FRAME_STATS_FRAME_SERIES) const;
+	float GetPercentile(float percent, uint series = FRAME_STATS_FRAME_SERIES) const;
+	const uint* GetHistogram(uint series = FRAME_STATS_FRAME_SERIES) const; // FRAME_STATS_BUCKETS counts
+	static float GetBucketStart(uint bucket); // ms
+
+	uint GetFrameCount() const; // In the window
+	float GetFrameMs(uint index, uint series = FRAME_STATS_FRAME_SERIES) const; // 0 is the oldest frame in the window
+	uint64 GetTotalFrames() const;
+
+	const std::vector<FrameHitch>& GetHitches() const; // Oldest first
+	float GetHitchFactor() const;
+	void SetHitchFactor(float factor);
+	void Clear();
+
+	// --- One row per frame in the window, and one row per series with its percentiles ---
+	bool ExportCSV(const char* path = FRAME_STATS_FILE) const;
+	bool ExportSummaryCSV(const char* path = FRAME_STATS_SUMMARY_FILE) const;
+
+private:
+
+	FrameStats();
+	~FrameStats();
+
+	uint AddSeries(const char* name);
+	static uint GetBucket(float ms);
+	void CaptureHitch(float ms, float median, const ProfileFrame* frame);
+
+private:
+
+	PerfTimer frame_timer;
+
+	// --- Ring, frame_ms[i][series] ---
+	float frame_ms[FRAME_STATS_FRAMES][FRAME_STATS_MAX_SERIES];
+	bool frame_hitch[FRAME_STATS_FRAMES];
+	uint64 frame_count = 0;
+	uint64 last_profiler_frame = 0;
+
+	const char* series_names[FRAME_STATS_MAX_SERIES];
+	uint series_count = 0;
+	uint histograms[FRAME_STATS_MAX_SERIES][FRAME_STATS_BUCKETS];
+
+	float hitch_factor = FRAME_STATS_HITCH_FACTOR;
+	std::vector<FrameHitch> hitches;
+};
+
+#endif
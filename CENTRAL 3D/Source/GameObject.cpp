@@ -8,6 +8,8 @@
 #include "ModuleRenderer3D.h"
 
 #include "Math.h"
+#include "Kernels.h"
+#include "FrameAllocator.h"
 
 #include "ResourceModel.h"
 #include "ResourceScene.h"
@@ -54,9 +56,22 @@ GameObject::~GameObject()
 
 void GameObject::Update(float dt)
 {
+	// --- Only something no parent propagated to is still dirty here, the root or an object just moved under it ---
 	if (GetComponent<ComponentTransform>()->update_transform)
 		this->OnUpdateTransform();
 
+	// --- Children moved since last frame are propagated together ---
+	FrameVector<GameObject*> dirty;
+
+	for (std::vector<GameObject*>::iterator it = childs.begin(); it != childs.end(); ++it)
+	{
+		if (!(*it)->Static && (*it)->GetComponent<ComponentTransform>()->update_transform)
+			dirty.push_back(*it);
+	}
+
+	if (!dirty.empty())
+		UpdateTransforms(dirty.data(), dirty.size());
+
 	// --- Update components ---
 	for (int i = 0; i < components.size(); ++i)
 	{
@@ -125,26 +140,137 @@ void GameObject::OnUpdateTransform()
 	if (Static)
 		return;
 
+	if (parent)
+	{
+		GameObject* self = this;
+		UpdateTransforms(&self, 1);
+		return;
+	}
+
+	// --- The root has nothing to inherit, its children start the propagation ---
 	ComponentTransform* transform = GetComponent<ComponentTransform>();
+	transform->update_transform = false;
+
+	FrameVector<GameObject*> level;
+	level.reserve(childs.size());
 
-	if(parent)
-	transform->OnUpdateTransform(parent->GetComponent<ComponentTransform>()->GetGlobalTransform());
+	for (std::vector<GameObject*>::iterator it = childs.begin(); it != childs.end(); ++it)
+	{
+		if (!(*it)->Static)
+			level.push_back(*it);
+	}
 
-	ComponentCamera* camera = GetComponent<ComponentCamera>();
+	if (!level.empty())
+		UpdateTransforms(level.data(), level.size());
 
-	if(camera)
-	camera->OnUpdateTransform(transform->GetGlobalTransform());
+	GameObject* self = this;
+	UpdateAABBs(&self, 1);
+}
 
-	// --- Update all children ---
-	if (childs.size() > 0)
+void GameObject::UpdateTransforms(GameObject* const* gos, uint count)
+{
+	FrameVector<GameObject*> level(gos, gos + count);
+	FrameVector<GameObject*> next;
+	FrameVector<GameObject*> updated;
+	FrameVector<float4x4> locals;
+	FrameVector<float4x4> globals;
+
+	while (!level.empty())
 	{
-		for (std::vector<GameObject*>::iterator it = childs.begin(); it != childs.end(); ++it)
+		locals.resize(level.size());
+		globals.resize(level.size());
+
+		for (uint i = 0; i < level.size(); ++i)
+			locals[i] = level[i]->GetComponent<ComponentTransform>()->GetLocalTransform();
+
+		// --- One kernel call per run of siblings, their parent's global is already up to date ---
+		uint first = 0;
+
+		while (first < level.size())
 		{
-			(*it)->OnUpdateTransform();	
+			GameObject* level_parent = level[first]->parent;
+			uint last = first + 1;
+
+			while (last < level.size() && level[last]->parent == level_parent)
+				++last;
+
+			Kernels::MulMatrices(level_parent->GetComponent<ComponentTransform>()->GetGlobalTransform(), &locals[first], &globals[first], last - first);
+			first = last;
+		}
+
+		// --- Hand the results back and gather the next level, static objects keep theirs along with everything under them ---
+		next.clear();
+
+		for (uint i = 0; i < level.size(); ++i)
+		{
+			GameObject* go = level[i];
+			go->GetComponent<ComponentTransform>()->OnUpdateTransform(globals[i]);
+
+			ComponentCamera* camera = go->GetComponent<ComponentCamera>();
+
+			if (camera)
+				camera->OnUpdateTransform(globals[i]);
+
+			updated.push_back(go);
+
+			for (std::vector<GameObject*>::iterator it = go->childs.begin(); it != go->childs.end(); ++it)
+			{
+				if (!(*it)->Static)
+					next.push_back(*it);
+			}
 		}
+
+		level.swap(next);
 	}
 
-	UpdateAABB();
+	UpdateAABBs(updated.data(), updated.size());
+}
+
+void GameObject::UpdateAABBs(GameObject* const* gos, uint count)
+{
+	FrameVector<GameObject*> meshed;
+	FrameVector<AABB> locals;
+	FrameVector<float4x4> globals;
+	meshed.reserve(count);
+	locals.reserve(count);
+	globals.reserve(count);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		GameObject* go = gos[i];
+		ComponentMesh* mesh = go->GetComponent<ComponentMesh>();
+		ComponentTransform* transform = go->GetComponent<ComponentTransform>();
+
+		go->aabb_mesh = mesh ? mesh->resource_mesh.Get() : nullptr;
+
+		if (mesh)
+		{
+			go->aabb_local = mesh->GetAABB();
+			meshed.push_back(go);
+			locals.push_back(go->aabb_local);
+			globals.push_back(transform->GetGlobalTransform());
+		}
+		else
+		{
+			go->aabb.SetNegativeInfinity();
+			go->aabb.SetFromCenterAndSize(transform->GetGlobalPosition(), float3(1, 1, 1));
+			go->obb = go->aabb;
+		}
+	}
+
+	if (meshed.empty())
+		return;
+
+	// --- Same boxes as enclosing the obbs, straight from the local ones ---
+	FrameVector<AABB> boxes(meshed.size());
+	Kernels::TransformAABBs(locals.data(), globals.data(), boxes.data(), boxes.size());
+
+	for (uint i = 0; i < meshed.size(); ++i)
+	{
+		meshed[i]->aabb = boxes[i];
+		meshed[i]->obb = locals[i];
+		meshed[i]->obb.Transform(globals[i]);
+	}
 }
 
 void GameObject::RemoveChildGO(GameObject * GO)
@@ -401,14 +527,20 @@ void GameObject::SetUID(uint uid)
 	}
 }
 
-std::string GameObject::GetName() const
+const std::string& GameObject::GetName() const
 {
 	return name;
 }
 
 const AABB & GameObject::GetAABB()
 {
-	UpdateAABB();
+	// --- Moves reach the box through UpdateTransforms, what is left is the mesh changing under the object ---
+	ComponentMesh* mesh = GetComponent<ComponentMesh>();
+	const ResourceMesh* source = mesh ? mesh->resource_mesh.Get() : nullptr;
+
+	if (source != aabb_mesh || (source && !source->aabb.BitEquals(aabb_local)))
+		UpdateAABB();
+
 	return aabb;
 }
 
@@ -435,23 +567,17 @@ void GameObject::SetName(const char* name)
 
 void GameObject::UpdateAABB()
 {
-	ComponentMesh* mesh = GetComponent<ComponentMesh>();
-	ComponentTransform* transform = GetComponent<ComponentTransform>();
+	GameObject* self = this;
+	UpdateAABBs(&self, 1);
+}
 
-	if (mesh)
-	{
-		obb = mesh->GetAABB();
-		obb.Transform(transform->GetGlobalTransform());
+void GameObject::GatherDependencies(std::vector<uint>& dependencies) const
+{
+	if (model)
+		dependencies.push_back(model->GetUID());
 
-		aabb.SetNegativeInfinity();
-		aabb.Enclose(obb);
-	}
-	if(!mesh)
-	{
-		aabb.SetNegativeInfinity();
-		aabb.SetFromCenterAndSize(transform->GetGlobalPosition(), float3(1, 1, 1));
-		obb = aabb;
-	}
+	for (uint i = 0; i < components.size(); ++i)
+		components[i]->GatherDependencies(dependencies);
 }
 
 void GameObject::ONResourceEvent(uint uid, Resource::ResourceNotificationType type)
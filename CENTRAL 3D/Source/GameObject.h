@@ -6,13 +6,16 @@
 #include "Math.h"
 #include <vector>
 #include "Resource.h"
+#include "Allocator.h"
 
 class ResourceModel;
+class ResourceMesh;
 
 class GameObject
 {
 
 public:
+	MEMORY_TAG(MemoryTag::Scene)
 
 	GameObject(const char* name);
 	GameObject(const char* name, uint UID);
@@ -25,7 +28,7 @@ public:
 	// --- Getters ---
 	uint&			GetUID();
 	void			SetUID(uint uid);
-	std::string		GetName() const;
+	const std::string& GetName() const;
 	const AABB&	    GetAABB();
 	const OBB&      GetOBB() const;
 
@@ -60,6 +63,11 @@ public:
 	// --- Utilities ---
 	void RecursiveDelete(bool target = true);
 	void OnUpdateTransform();
+
+	// --- Propagates the given objects' transforms to everything under them, a level at a time ---
+	// --- Siblings sit next to each other so each parent's children go through the kernel in one call ---
+	static void UpdateTransforms(GameObject* const* gos, uint count);
+	static void UpdateAABBs(GameObject* const* gos, uint count);
 	void RemoveChildGO(GameObject* GO);
 	void AddChildGO(GameObject* GO, int index = -1); // note that specifying index will remove any go at index
 	void InsertChildGO(GameObject* GO, int index);
@@ -68,6 +76,7 @@ public:
 	void UpdateAABB();
 
 	void ONResourceEvent(uint uid, Resource::ResourceNotificationType type);
+	void GatherDependencies(std::vector<uint>& dependencies) const; // Resources its components and model use
 
 public:
 	GameObject* parent = nullptr;
@@ -87,6 +96,10 @@ private:
 	bool active = false;
 	AABB						aabb;
 	OBB							obb;
+
+	// --- What aabb was last built from, a mesh swapped or loaded under the object rebuilds it ---
+	const ResourceMesh*			aabb_mesh = nullptr;
+	AABB						aabb_local;
 };
 
 #endif
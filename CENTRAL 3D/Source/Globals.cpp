@@ -1,20 +1,54 @@
 #include "Globals.h"
-#include "Application.h"
+#include "Logger.h"
+#include <string.h>
+
+// --- Guess the category from the file name, so plain CONSOLE_LOG calls can be filtered too ---
+static LogCategory GetCategoryFromFile(const char* file)
+{
+	const char* name = file;
+
+	for (const char* c = file; *c; ++c)
+	{
+		if (*c == '\\' || *c == '/')
+			name = c + 1;
+	}
+
+	static const struct { const char* prefix; LogCategory category; } categories[] =
+	{
+		{ "Importer", LogCategory::Importers },
+		{ "ModuleResourceManager", LogCategory::Resources },
+		{ "Resource", LogCategory::Resources },
+		{ "ModuleTextures", LogCategory::Resources },
+		{ "ModuleRenderer3D", LogCategory::Render },
+		{ "ModuleSceneManager", LogCategory::Scene },
+		{ "GameObject", LogCategory::Scene },
+		{ "Component", LogCategory::Scene },
+		{ "ModuleGui", LogCategory::Editor },
+		{ "Panel", LogCategory::Editor },
+		{ "ModuleJobs", LogCategory::Jobs },
+	};
+
+	for (uint i = 0; i < sizeof(categories) / sizeof(categories[0]); ++i)
+	{
+		if (strncmp(name, categories[i].prefix, strlen(categories[i].prefix)) == 0)
+			return categories[i].category;
+	}
+
+	return LogCategory::General;
+}
 
 void _log(const char file[], int line, const char* format, ...)
 {
-	static char tmp_string[MAX_BUF_SIZE];
-	static char tmp_string2[MAX_BUF_SIZE];
-	static va_list  ap;
+	// --- Severity comes from the "|[error]" and "![Warning]" prefixes ---
+	LogLevel level = LogLevel::Info;
 
-	// Construct the string from variable arguments
+	if (format[0] == '|')
+		level = LogLevel::Error;
+	else if (format[0] == '!')
+		level = LogLevel::Warning;
+
+	va_list ap;
 	va_start(ap, format);
-	vsprintf_s(tmp_string, MAX_BUF_SIZE, format, ap);
+	Logger::Get().WriteV(level, GetCategoryFromFile(file), file, line, format, ap);
 	va_end(ap);
-	sprintf_s(tmp_string2, MAX_BUF_SIZE, "\n%s(%d) : %s", file, line, tmp_string);
-	OutputDebugString(tmp_string2);
-	if (App) {
-		sprintf_s(tmp_string2, MAX_BUF_SIZE, "\n%s", tmp_string);
-		App->Log(tmp_string2);
-	}
-}
\ No newline at end of file
+}
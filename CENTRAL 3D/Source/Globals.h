@@ -4,10 +4,14 @@
 #pragma warning( disable : 4577 ) // Warning that exceptions are disabled
 #pragma warning( disable : 4530 )
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include "Platform.h"
+#endif
 #include <stdio.h>
 
-#define CONSOLE_LOG(format, ...) _log(__FILE__, __LINE__, format, __VA_ARGS__);
+#define CONSOLE_LOG(format, ...) _log(__FILE__, __LINE__, format, ##__VA_ARGS__);
 
 void _log(const char file[], int line, const char* format, ...);
 
@@ -20,8 +24,8 @@ void _log(const char file[], int line, const char* format, ...);
 
 typedef unsigned int uint;
 typedef unsigned long ulong;
-typedef unsigned __int64 uint64;
-typedef unsigned __int32 uint32;
+typedef unsigned long long uint64;
+typedef unsigned int uint32;
 
 enum update_status
 {
@@ -0,0 +1,737 @@
+#include "ImageDecoder.h"
+#include "Application.h"
+
+#include "DevIL/include/il.h"
+#include "DevIL/include/ilu.h"
+
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+#define DDS_HEADER_SIZE 128 // Magic plus header
+#define DDS_HEADER_DX10_SIZE 20 // Follows the header when the FourCC is DX10
+#define DDS_BOTTOM_UP_TAG "C3DU" // First reserved field of library files from before KTX2, rows are bottom first
+#define DDS_FLAG_MIPMAPCOUNT 0x20000
+#define DDS_PF_ALPHAPIXELS 0x1
+#define DDS_PF_FOURCC 0x4
+#define DDS_PF_RGB 0x40
+#define DDS_PF_LUMINANCE 0x20000
+#define DDS_CAPS2_CUBEMAP 0x200
+#define DDS_CAPS2_VOLUME 0x200000
+#define DDS_DIMENSION_TEXTURE2D 3
+#define DDS_MISC_TEXTURECUBE 0x4
+
+static inline uint ReadU16(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8);
+}
+
+static inline uint ReadU32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint)data[3] << 24);
+}
+
+// --- Shared helpers ---
+
+uint ImageDecoder::GetBlockBytes(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::BC1:
+	case PixelFormat::BC4:
+		return 8;
+	case PixelFormat::BC2:
+	case PixelFormat::BC3:
+	case PixelFormat::BC5:
+	case PixelFormat::BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+uint64 ImageDecoder::GetLevelSize(PixelFormat format, uint width, uint height)
+{
+	uint block_bytes = GetBlockBytes(format);
+
+	if (block_bytes > 0)
+		return (uint64)((width + 3) / 4) * ((height + 3) / 4) * block_bytes;
+
+	return format == PixelFormat::RGBA8 ? (uint64)width * height * 4 : 0;
+}
+
+uint64 ImageDecoder::GetImageSize(PixelFormat format, uint width, uint height, uint levels)
+{
+	uint64 size = 0;
+
+	for (uint level = 0; level < levels; ++level)
+	{
+		size += GetLevelSize(format, width, height);
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return size;
+}
+
+static void DecodeColorBlock(const unsigned char* block, unsigned char colors[4][4], bool allow_transparent)
+{
+	uint c0 = ReadU16(block);
+	uint c1 = ReadU16(block + 2);
+
+	for (uint i = 0; i < 2; ++i)
+	{
+		uint c = i == 0 ? c0 : c1;
+		colors[i][0] = (unsigned char)(((c >> 11) & 31) * 255 / 31);
+		colors[i][1] = (unsigned char)(((c >> 5) & 63) * 255 / 63);
+		colors[i][2] = (unsigned char)((c & 31) * 255 / 31);
+		colors[i][3] = 255;
+	}
+
+	for (uint channel = 0; channel < 3; ++channel)
+	{
+		if (c0 > c1 || !allow_transparent)
+		{
+			colors[2][channel] = (unsigned char)((2 * colors[0][channel] + colors[1][channel]) / 3);
+			colors[3][channel] = (unsigned char)((colors[0][channel] + 2 * colors[1][channel]) / 3);
+		}
+		else
+		{
+			colors[2][channel] = (unsigned char)((colors[0][channel] + colors[1][channel]) / 2);
+			colors[3][channel] = 0;
+		}
+	}
+
+	colors[2][3] = 255;
+	colors[3][3] = c0 > c1 || !allow_transparent ? 255 : 0;
+}
+
+// --- BC3 alpha, also BC4 and BC5 channels. Two endpoints and 3 bit indices ---
+static void DecodeAlphaBlock(const unsigned char* block, unsigned char values[8], uint64& bits)
+{
+	values[0] = block[0];
+	values[1] = block[1];
+
+	for (uint i = 2; i < 8; ++i)
+	{
+		if (values[0] > values[1])
+			values[i] = (unsigned char)(((8 - i) * values[0] + (i - 1) * values[1]) / 7);
+		else if (i < 6)
+			values[i] = (unsigned char)(((6 - i) * values[0] + (i - 1) * values[1]) / 5);
+		else
+			values[i] = i == 6 ? 0 : 255;
+	}
+
+	bits = 0;
+
+	for (uint i = 0; i < 6; ++i)
+		bits |= (uint64)block[2 + i] << (8 * i);
+}
+
+void ImageDecoder::DecompressBlocks(PixelFormat format, const unsigned char* blocks, uint width, uint height, unsigned char* rgba)
+{
+	if (format == PixelFormat::BC7)
+		return;
+
+	uint block_bytes = GetBlockBytes(format);
+	uint blocks_x = (width + 3) / 4;
+	uint blocks_y = (height + 3) / 4;
+
+	for (uint by = 0; by < blocks_y; ++by)
+	{
+		for (uint bx = 0; bx < blocks_x; ++bx)
+		{
+			const unsigned char* block = blocks + ((uint64)by * blocks_x + bx) * block_bytes;
+
+			// --- Channel blocks, decoded as GL samples them ---
+			if (format == PixelFormat::BC4 || format == PixelFormat::BC5)
+			{
+				unsigned char reds[8], greens[8];
+				uint64 red_bits = 0, green_bits = 0;
+				DecodeAlphaBlock(block, reds, red_bits);
+
+				if (format == PixelFormat::BC5)
+					DecodeAlphaBlock(block + 8, greens, green_bits);
+
+				for (uint y = 0; y < 4 && by * 4 + y < height; ++y)
+				{
+					for (uint x = 0; x < 4 && bx * 4 + x < width; ++x)
+					{
+						uint pixel = y * 4 + x;
+						unsigned char* out = rgba + (((uint64)(by * 4 + y) * width) + bx * 4 + x) * 4;
+						out[0] = reds[(red_bits >> (3 * pixel)) & 7];
+						out[1] = format == PixelFormat::BC5 ? greens[(green_bits >> (3 * pixel)) & 7] : 0;
+						out[2] = 0;
+						out[3] = 255;
+					}
+				}
+
+				continue;
+			}
+
+			const unsigned char* color_block = format == PixelFormat::BC1 ? block : block + 8;
+
+			unsigned char colors[4][4];
+			DecodeColorBlock(color_block, colors, format == PixelFormat::BC1);
+
+			unsigned char alphas[8];
+			uint64 alpha_bits = 0;
+
+			if (format == PixelFormat::BC3)
+				DecodeAlphaBlock(block, alphas, alpha_bits);
+
+			for (uint y = 0; y < 4 && by * 4 + y < height; ++y)
+			{
+				uint row = color_block[4 + y];
+
+				for (uint x = 0; x < 4 && bx * 4 + x < width; ++x)
+				{
+					uint pixel = y * 4 + x;
+					unsigned char* out = rgba + (((uint64)(by * 4 + y) * width) + bx * 4 + x) * 4;
+					memcpy(out, colors[(row >> (2 * x)) & 3], 4);
+
+					if (format == PixelFormat::BC2)
+						out[3] = (unsigned char)(((block[pixel / 2] >> (4 * (pixel & 1))) & 15) * 17);
+					else if (format == PixelFormat::BC3)
+						out[3] = alphas[(alpha_bits >> (3 * pixel)) & 7];
+				}
+			}
+		}
+	}
+}
+
+static void FlipAlphaBlock(unsigned char* block, uint rows)
+{
+	uint64 bits = 0;
+
+	for (uint i = 0; i < 6; ++i)
+		bits |= (uint64)block[2 + i] << (8 * i);
+
+	uint64 flipped = bits;
+
+	for (uint i = 0; i < rows; ++i)
+	{
+		uint64 row = (bits >> (12 * (rows - 1 - i))) & 0xFFF;
+		flipped &= ~((uint64)0xFFF << (12 * i));
+		flipped |= row << (12 * i);
+	}
+
+	for (uint i = 0; i < 6; ++i)
+		block[2 + i] = (unsigned char)(flipped >> (8 * i));
+}
+
+// --- Reverses the first rows of a 4x4 block ---
+static void FlipBlock(PixelFormat format, unsigned char* block, uint rows)
+{
+	if (format == PixelFormat::BC4 || format == PixelFormat::BC5)
+	{
+		FlipAlphaBlock(block, rows);
+
+		if (format == PixelFormat::BC5)
+			FlipAlphaBlock(block + 8, rows);
+
+		return;
+	}
+
+	unsigned char* color = format == PixelFormat::BC1 ? block : block + 8;
+
+	for (uint i = 0; i < rows / 2; ++i)
+	{
+		unsigned char swap = color[4 + i];
+		color[4 + i] = color[4 + rows - 1 - i];
+		color[4 + rows - 1 - i] = swap;
+	}
+
+	if (format == PixelFormat::BC2)
+	{
+		for (uint i = 0; i < rows / 2; ++i)
+		{
+			for (uint byte = 0; byte < 2; ++byte)
+			{
+				unsigned char swap = block[i * 2 + byte];
+				block[i * 2 + byte] = block[(rows - 1 - i) * 2 + byte];
+				block[(rows - 1 - i) * 2 + byte] = swap;
+			}
+		}
+	}
+	else if (format == PixelFormat::BC3)
+		FlipAlphaBlock(block, rows);
+}
+
+bool ImageDecoder::CanFlipBlocks(uint width, uint height, uint levels)
+{
+	for (uint level = 0; level < levels; ++level)
+	{
+		if (height > 4 && height % 4 != 0)
+			return false;
+
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return true;
+}
+
+void ImageDecoder::FlipLevel(PixelFormat format, const unsigned char* source, uint width, uint height, unsigned char* out)
+{
+	if (format == PixelFormat::RGBA8)
+	{
+		for (uint y = 0; y < height; ++y)
+			memcpy(out + (uint64)(height - 1 - y) * width * 4, source + (uint64)y * width * 4, (size_t)width * 4);
+
+		return;
+	}
+
+	uint block_bytes = GetBlockBytes(format);
+	uint blocks_x = (width + 3) / 4;
+	uint blocks_y = (height + 3) / 4;
+	uint64 row_bytes = (uint64)blocks_x * block_bytes;
+
+	for (uint by = 0; by < blocks_y; ++by)
+	{
+		unsigned char* row = out + (uint64)(blocks_y - 1 - by) * row_bytes;
+		memcpy(row, source + by * row_bytes, (size_t)row_bytes);
+
+		for (uint bx = 0; bx < blocks_x; ++bx)
+			FlipBlock(format, row + bx * block_bytes, height < 4 ? height : 4);
+	}
+}
+
+// --- TGA ---
+
+bool ImageDecoderTGA::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	return size >= 18 && strcmp(extension, "tga") == 0;
+}
+
+bool ImageDecoderTGA::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	if (size < 18)
+		return false;
+
+	uint type = data[2] & ~8u; // RLE bit off
+	uint bpp = data[16];
+	bool valid = false;
+
+	if (type == 1)
+		valid = data[1] == 1 && bpp == 8 && (data[7] == 15 || data[7] == 16 || data[7] == 24 || data[7] == 32);
+	else if (type == 2)
+		valid = bpp == 15 || bpp == 16 || bpp == 24 || bpp == 32;
+	else if (type == 3)
+		valid = bpp == 8 || bpp == 16;
+
+	info.width = ReadU16(data + 12);
+	info.height = ReadU16(data + 14);
+	info.format = PixelFormat::RGBA8;
+	info.levels = 1;
+	info.size = GetImageSize(info.format, info.width, info.height, 1);
+
+	return valid && info.width > 0 && info.height > 0 && info.width <= IMAGE_DECODER_MAX_SIZE && info.height <= IMAGE_DECODER_MAX_SIZE;
+}
+
+static void ReadTGAColor(const unsigned char* source, uint bytes, bool gray, unsigned char* rgba)
+{
+	if (gray)
+	{
+		rgba[0] = rgba[1] = rgba[2] = source[0];
+		rgba[3] = bytes == 2 ? source[1] : 255;
+	}
+	else if (bytes == 2)
+	{
+		uint value = ReadU16(source);
+		rgba[0] = (unsigned char)(((value >> 10) & 31) * 255 / 31);
+		rgba[1] = (unsigned char)(((value >> 5) & 31) * 255 / 31);
+		rgba[2] = (unsigned char)((value & 31) * 255 / 31);
+		rgba[3] = 255;
+	}
+	else
+	{
+		rgba[0] = source[2];
+		rgba[1] = source[1];
+		rgba[2] = source[0];
+		rgba[3] = bytes == 4 ? source[3] : 255;
+	}
+}
+
+bool ImageDecoderTGA::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	uint type = data[2] & ~8u;
+	bool rle = (data[2] & 8) != 0;
+	bool top_first = (data[17] & 0x20) != 0;
+	uint bytes = (data[16] + 7) / 8;
+
+	if (size < 18 + (uint64)data[0])
+		return false;
+
+	const unsigned char* cursor = data + 18 + data[0];
+	const unsigned char* end = data + size;
+
+	// --- Color map, converted up front ---
+	std::vector<unsigned char> palette;
+
+	if (data[1] == 1)
+	{
+		uint first = ReadU16(data + 3);
+		uint length = ReadU16(data + 5);
+		uint entry_bytes = (data[7] + 7) / 8;
+
+		if ((uint64)(end - cursor) < (uint64)length * entry_bytes)
+			return false;
+
+		palette.resize(((uint64)first + length) * 4, 0);
+
+		for (uint i = 0; i < length; ++i)
+			ReadTGAColor(cursor + i * entry_bytes, entry_bytes, false, &palette[((uint64)first + i) * 4]);
+
+		cursor += (uint64)length * entry_bytes;
+	}
+
+	uint64 pixels = (uint64)info.width * info.height;
+	uint64 pixel = 0;
+	unsigned char color[4] = { 0, 0, 0, 255 };
+
+	while (pixel < pixels)
+	{
+		// --- Uncompressed data is one raw packet ---
+		uint64 count = pixels - pixel;
+		bool repeat = false;
+
+		if (rle)
+		{
+			if (cursor >= end)
+				return false;
+
+			repeat = (*cursor & 0x80) != 0;
+			count = (*cursor & 0x7F) + 1;
+			++cursor;
+		}
+
+		for (uint64 i = 0; i < count && pixel < pixels; ++i, ++pixel)
+		{
+			// --- A repeat packet stores its pixel once ---
+			if (i == 0 || !repeat)
+			{
+				if ((uint64)(end - cursor) < bytes)
+					return false;
+
+				if (type == 1)
+				{
+					if ((uint64)cursor[0] * 4 + 4 > palette.size())
+						return false;
+
+					memcpy(color, &palette[(size_t)cursor[0] * 4], 4);
+				}
+				else
+					ReadTGAColor(cursor, bytes, type == 3, color);
+
+				cursor += bytes;
+			}
+
+			uint x = (uint)(pixel % info.width);
+			uint row = (uint)(pixel / info.width);
+			uint y = top_first ? info.height - 1 - row : row;
+			memcpy(out + ((uint64)y * info.width + x) * 4, color, 4);
+		}
+	}
+
+	return true;
+}
+
+// --- DDS ---
+
+bool ImageDecoderDDS::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	return size >= DDS_HEADER_SIZE && memcmp(data, "DDS ", 4) == 0;
+}
+
+static bool HasDX10Header(const unsigned char* data)
+{
+	return (ReadU32(data + 4 + 76) & DDS_PF_FOURCC) && memcmp(data + 4 + 80, "DX10", 4) == 0;
+}
+
+static uint GetDDSDataOffset(const unsigned char* data)
+{
+	return DDS_HEADER_SIZE + (HasDX10Header(data) ? DDS_HEADER_DX10_SIZE : 0);
+}
+
+static bool IsBottomUp(const unsigned char* data)
+{
+	return memcmp(data + 4 + 28, DDS_BOTTOM_UP_TAG, 4) == 0;
+}
+
+// --- Format as stored in the file ---
+static PixelFormat GetDDSFormat(const unsigned char* data, uint64 size)
+{
+	const unsigned char* header = data + 4;
+	uint pf_flags = ReadU32(header + 76);
+	uint bits = ReadU32(header + 84);
+
+	if (HasDX10Header(data))
+	{
+		const unsigned char* dx10 = data + DDS_HEADER_SIZE;
+
+		if (size < DDS_HEADER_SIZE + DDS_HEADER_DX10_SIZE || ReadU32(dx10 + 4) != DDS_DIMENSION_TEXTURE2D || (ReadU32(dx10 + 8) & DDS_MISC_TEXTURECUBE) || ReadU32(dx10 + 12) > 1)
+			return PixelFormat::Unknown;
+
+		// --- DXGI formats, typeless, unorm and srgb of each ---
+		switch (ReadU32(dx10))
+		{
+		case 70: case 71: case 72:
+			return PixelFormat::BC1;
+		case 73: case 74: case 75:
+			return PixelFormat::BC2;
+		case 76: case 77: case 78:
+			return PixelFormat::BC3;
+		case 79: case 80:
+			return PixelFormat::BC4;
+		case 82: case 83:
+			return PixelFormat::BC5;
+		case 97: case 98: case 99:
+			return PixelFormat::BC7;
+		default:
+			return PixelFormat::Unknown;
+		}
+	}
+
+	if (pf_flags & DDS_PF_FOURCC)
+	{
+		if (memcmp(header + 80, "DXT1", 4) == 0)
+			return PixelFormat::BC1;
+		if (memcmp(header + 80, "DXT3", 4) == 0)
+			return PixelFormat::BC2;
+		if (memcmp(header + 80, "DXT5", 4) == 0)
+			return PixelFormat::BC3;
+		if (memcmp(header + 80, "ATI1", 4) == 0 || memcmp(header + 80, "BC4U", 4) == 0)
+			return PixelFormat::BC4;
+		if (memcmp(header + 80, "ATI2", 4) == 0 || memcmp(header + 80, "BC5U", 4) == 0)
+			return PixelFormat::BC5;
+
+		return PixelFormat::Unknown;
+	}
+
+	if ((pf_flags & (DDS_PF_RGB | DDS_PF_LUMINANCE)) && (bits == 8 || bits == 16 || bits == 24 || bits == 32))
+		return PixelFormat::RGBA8;
+
+	return PixelFormat::Unknown;
+}
+
+bool ImageDecoderDDS::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	const unsigned char* header = data + 4;
+
+	if (size < DDS_HEADER_SIZE || ReadU32(header) != 124 || (ReadU32(header + 108) & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME)))
+		return false;
+
+	PixelFormat source = GetDDSFormat(data, size);
+
+	if (source == PixelFormat::Unknown)
+		return false;
+
+	info.width = ReadU32(header + 12);
+	info.height = ReadU32(header + 8);
+	info.levels = 1;
+
+	if (info.width == 0 || info.height == 0 || info.width > IMAGE_DECODER_MAX_SIZE || info.height > IMAGE_DECODER_MAX_SIZE)
+		return false;
+
+	if (ReadU32(header + 4) & DDS_FLAG_MIPMAPCOUNT)
+	{
+		uint levels = ReadU32(header + 24);
+		uint largest = info.width > info.height ? info.width : info.height;
+		uint max_levels = 1;
+
+		while (largest > 1)
+		{
+			largest /= 2;
+			++max_levels;
+		}
+
+		info.levels = levels == 0 ? 1 : (levels < max_levels ? levels : max_levels);
+	}
+
+	// --- What the file holds has to be there ---
+	uint source_bytes = source == PixelFormat::RGBA8 ? ReadU32(header + 84) / 8 : 0;
+	uint64 source_size = source == PixelFormat::RGBA8 ? GetImageSize(source, info.width, info.height, info.levels) / 4 * source_bytes : GetImageSize(source, info.width, info.height, info.levels);
+
+	if (size - GetDDSDataOffset(data) < source_size)
+		return false;
+
+	// --- Blocks that cannot be flipped are decompressed, except BC7 which has no decompressor ---
+	bool bottom_up = source != PixelFormat::RGBA8 && IsBottomUp(data);
+
+	if (source == PixelFormat::BC7 && !bottom_up)
+		return false;
+
+	info.format = source == PixelFormat::RGBA8 || bottom_up || CanFlipBlocks(info.width, info.height, info.levels) ? source : PixelFormat::RGBA8;
+	info.size = GetImageSize(info.format, info.width, info.height, info.levels);
+
+	return true;
+}
+
+static uint GetMaskShift(uint mask)
+{
+	uint shift = 0;
+
+	while (mask && (mask & 1) == 0)
+	{
+		mask >>= 1;
+		++shift;
+	}
+
+	return shift;
+}
+
+static unsigned char ReadMasked(uint pixel, uint mask)
+{
+	if (mask == 0)
+		return 0;
+
+	uint shift = GetMaskShift(mask);
+	uint max = mask >> shift;
+
+	return (unsigned char)((((pixel & mask) >> shift) * 255 + max / 2) / max);
+}
+
+bool ImageDecoderDDS::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	const unsigned char* header = data + 4;
+	PixelFormat source = GetDDSFormat(data, size);
+	const unsigned char* cursor = data + GetDDSDataOffset(data);
+
+	// --- Already in the order GL wants ---
+	if (source == info.format && source != PixelFormat::RGBA8 && IsBottomUp(data))
+	{
+		memcpy(out, cursor, (size_t)info.size);
+		return true;
+	}
+
+	uint width = info.width;
+	uint height = info.height;
+
+	for (uint level = 0; level < info.levels; ++level)
+	{
+		uint64 level_size = GetLevelSize(info.format, width, height);
+
+		if (source == PixelFormat::RGBA8)
+		{
+			uint bytes = ReadU32(header + 84) / 8;
+			uint pf_flags = ReadU32(header + 76);
+			uint masks[4] = { ReadU32(header + 88), ReadU32(header + 92), ReadU32(header + 96), (pf_flags & DDS_PF_ALPHAPIXELS) ? ReadU32(header + 100) : 0 };
+
+			for (uint y = 0; y < height; ++y)
+			{
+				unsigned char* row = out + (uint64)(height - 1 - y) * width * 4;
+
+				for (uint x = 0; x < width; ++x, cursor += bytes)
+				{
+					uint pixel = 0;
+					memcpy(&pixel, cursor, bytes);
+
+					if (pf_flags & DDS_PF_LUMINANCE)
+						row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = ReadMasked(pixel, masks[0]);
+					else
+					{
+						row[x * 4] = ReadMasked(pixel, masks[0]);
+						row[x * 4 + 1] = ReadMasked(pixel, masks[1]);
+						row[x * 4 + 2] = ReadMasked(pixel, masks[2]);
+					}
+
+					row[x * 4 + 3] = masks[3] ? ReadMasked(pixel, masks[3]) : 255;
+				}
+			}
+		}
+		else if (info.format == PixelFormat::RGBA8)
+		{
+			// --- Blocks that cannot be flipped as they are, decompressed first ---
+			std::vector<unsigned char> rgba((size_t)level_size);
+			DecompressBlocks(source, cursor, width, height, rgba.data());
+			FlipLevel(PixelFormat::RGBA8, rgba.data(), width, height, out);
+
+			cursor += GetLevelSize(source, width, height);
+		}
+		else
+		{
+			FlipLevel(source, cursor, width, height, out);
+			cursor += level_size;
+		}
+
+		out += level_size;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return true;
+}
+
+// --- DevIL ---
+
+std::mutex& ImageDecoderDevIL::GetLock()
+{
+	static std::mutex lock;
+	return lock;
+}
+
+bool ImageDecoderDevIL::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	// --- Last resort, it tells the format from the data ---
+	return size > 0 && size <= 0xFFFFFFFF;
+}
+
+bool ImageDecoderDevIL::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	std::lock_guard<std::mutex> lock(GetLock());
+
+	ILuint image = 0;
+	ilGenImages(1, &image);
+	ilBindImage(image);
+
+	bool ret = ilLoadL(IL_TYPE_UNKNOWN, data, (ILuint)size) == IL_TRUE;
+
+	if (ret)
+	{
+		info.format = PixelFormat::RGBA8;
+		info.width = ilGetInteger(IL_IMAGE_WIDTH);
+		info.height = ilGetInteger(IL_IMAGE_HEIGHT);
+		info.levels = 1;
+		info.size = GetImageSize(info.format, info.width, info.height, 1);
+		ret = info.width > 0 && info.height > 0;
+	}
+
+	ilDeleteImages(1, &image);
+
+	return ret;
+}
+
+bool ImageDecoderDevIL::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	std::lock_guard<std::mutex> lock(GetLock());
+
+	ILuint image = 0;
+	ilGenImages(1, &image);
+	ilBindImage(image);
+
+	bool ret = ilLoadL(IL_TYPE_UNKNOWN, data, (ILuint)size) == IL_TRUE;
+
+	if (ret)
+	{
+		// --- Same as before DevIL was behind this interface, upper left origins are flipped ---
+		ILinfo image_info;
+		iluGetImageInfo(&image_info);
+
+		if (image_info.Origin == IL_ORIGIN_UPPER_LEFT)
+			iluFlipImage();
+
+		ret = ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE) == IL_TRUE
+			&& (uint)ilGetInteger(IL_IMAGE_WIDTH) == info.width && (uint)ilGetInteger(IL_IMAGE_HEIGHT) == info.height;
+
+		if (ret)
+			ilCopyPixels(0, 0, 0, info.width, info.height, 1, IL_RGBA, IL_UNSIGNED_BYTE, out);
+	}
+
+	if (!ret)
+		CONSOLE_LOG("|[error]: DevIL could not decode the image. ERROR: %s", iluErrorString(ilGetError()));
+
+	ilDeleteImages(1, &image);
+
+	return ret;
+}
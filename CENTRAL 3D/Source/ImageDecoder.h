@@ -0,0 +1,145 @@
+#ifndef __IMAGE_DECODER_H__
+#define __IMAGE_DECODER_H__
+
+#include "Globals.h"
+#include <mutex>
+#include <vector>
+
+#define IMAGE_DECODER_MAX_SIZE 16384 // Widest or tallest image accepted, past what GL can take anyway
+
+enum class PixelFormat
+{
+	Unknown = 0,
+	RGBA8,
+	BC1, // DXT1
+	BC2, // DXT3
+	BC3, // DXT5
+	BC4, // One channel
+	BC5, // Two channels
+	BC7  // RGBA at higher quality than BC3
+};
+
+// --- What a decode produces, known before decoding so the caller can provide the memory ---
+struct ImageInfo
+{
+	PixelFormat format = PixelFormat::Unknown;
+	uint width = 0;
+	uint height = 0;
+	uint levels = 1; // Mips stored in the file, largest first and packed one after the other
+	uint64 size = 0; // Bytes of every level together
+};
+
+// --- Pixels are bottom row first, as GL expects them ---
+struct DecodedImage : public ImageInfo
+{
+	unsigned char* pixels = nullptr;
+	bool owned = false; // Allocated by the decode, free it through ModuleTextures::FreeImage
+};
+
+// --- One image format. Decoders keep no state between calls, thread safe ones are called from any thread at once ---
+class ImageDecoder
+{
+public:
+
+	virtual ~ImageDecoder() {}
+
+	virtual const char* GetName() const = 0;
+	virtual bool IsThreadSafe() const { return true; }
+
+	// --- Cheap, signature and extension only. Extension is lower case without the dot ---
+	virtual bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const = 0;
+
+	// --- Header only. False for variants the decoder does not handle, the next decoder gets a chance ---
+	virtual bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const = 0;
+
+	// --- Out holds info.size bytes ---
+	virtual bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const = 0;
+
+	// --- Helpers shared by the decoders ---
+	static uint GetBlockBytes(PixelFormat format); // Per 4x4 block, 0 for formats that are not block compressed
+	static uint64 GetLevelSize(PixelFormat format, uint width, uint height);
+	static uint64 GetImageSize(PixelFormat format, uint width, uint height, uint levels);
+	static void DecompressBlocks(PixelFormat format, const unsigned char* blocks, uint width, uint height, unsigned char* rgba); // Top row first in and out, BC7 is not handled
+	static bool CanFlipBlocks(uint width, uint height, uint levels); // False when a level splits its last block row
+	static void FlipLevel(PixelFormat format, const unsigned char* source, uint width, uint height, unsigned char* out); // Rows or block rows reversed, BC7 is not handled
+};
+
+// --- Truevision TGA, uncompressed and RLE, 8 to 32 bits per pixel ---
+class ImageDecoderTGA : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "TGA"; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+};
+
+// --- DirectDraw surfaces, BC1 to BC5 and BC7 are kept compressed, 24 and 32 bit ones become RGBA8. No cubemaps, volumes or arrays.
+// BC7 is only read from files the engine wrote, others would need decompressing to be flipped ---
+class ImageDecoderDDS : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "DDS"; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+};
+
+// --- Khronos KTX2, what the library keeps. 2D, RGBA8 or BC1 to BC5 and BC7, no supercompression.
+// Files the engine writes are oriented bottom row first, their levels are uploaded straight from the file ---
+class ImageDecoderKTX2 : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "KTX2"; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+
+	// --- Where each level is in data, largest first. False unless they are in the order GL wants, decode those instead ---
+	static bool GetLevels(const unsigned char* data, uint64 size, ImageInfo& info, std::vector<const unsigned char*>& levels);
+
+	// --- Levels as they are, oriented bottom row first. sRGB only marks the data, it is still uploaded as UNORM ---
+	static bool Write(const DecodedImage& image, bool srgb, std::vector<unsigned char>& out);
+};
+
+// --- PNG, every color type, bit depth and interlacing ---
+class ImageDecoderPNG : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "PNG"; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+};
+
+// --- Baseline JPEG, gray or YCbCr with any subsampling. Progressive and arithmetic coded ones are left to the next decoder ---
+class ImageDecoderJPG : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "JPG"; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+};
+
+// --- Anything else DevIL reads. Its bound image is global, calls are serialized through the lock ---
+class ImageDecoderDevIL : public ImageDecoder
+{
+public:
+
+	const char* GetName() const override { return "DevIL"; }
+	bool IsThreadSafe() const override { return false; }
+	bool CanDecode(const unsigned char* data, uint64 size, const char* extension) const override;
+	bool ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const override;
+	bool Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const override;
+
+	// --- Held by any other code that uses DevIL ---
+	static std::mutex& GetLock();
+};
+
+#endif
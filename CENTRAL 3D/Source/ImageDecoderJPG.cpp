@@ -0,0 +1,767 @@
+#include "ImageDecoder.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+#define JPG_FAST_BITS 9 // Codes this long or shorter are resolved with one table lookup
+#define JPG_MAX_COMPONENTS 3
+
+static const unsigned char zigzag[64] =
+{
+	0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static inline uint ReadBE16(const unsigned char* data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+struct JPGHuffman
+{
+	unsigned char fast[1 << JPG_FAST_BITS]; // Index into values, 255 when the code is longer
+	unsigned char values[256];
+	unsigned char size[257];
+	uint maxcode[18];
+	int delta[17]; // First index minus first code, per length
+	bool valid = false;
+};
+
+struct JPGComponent
+{
+	uint id = 0;
+	uint h = 1;
+	uint v = 1;
+	uint quant = 0;
+	uint dc_table = 0;
+	uint ac_table = 0;
+	int dc_prediction = 0;
+
+	uint width = 0; // Of the plane, whole blocks
+	uint height = 0;
+	std::vector<unsigned char> plane;
+};
+
+struct JPGBits
+{
+	const unsigned char* data = nullptr;
+	const unsigned char* end = nullptr;
+	uint buffer = 0; // Left aligned
+	int count = 0;
+	bool marker = false; // Reached one, only zeros come after
+};
+
+struct JPGDecoder
+{
+	uint width = 0;
+	uint height = 0;
+	uint component_count = 0;
+	uint hmax = 1;
+	uint vmax = 1;
+	uint restart_interval = 0;
+	bool frame = false;
+
+	JPGComponent components[JPG_MAX_COMPONENTS];
+	JPGHuffman dc[4];
+	JPGHuffman ac[4];
+	unsigned short quant[4][64]; // Zigzag order, as stored
+};
+
+static bool BuildHuffman(JPGHuffman& huffman, const unsigned char* counts)
+{
+	uint k = 0;
+
+	for (uint length = 0; length < 16; ++length)
+	{
+		for (uint i = 0; i < counts[length]; ++i)
+		{
+			if (k >= 256)
+				return false;
+
+			huffman.size[k++] = (unsigned char)(length + 1);
+		}
+	}
+
+	huffman.size[k] = 0;
+
+	uint code = 0;
+	unsigned short codes[256];
+	k = 0;
+
+	for (uint length = 1; length <= 16; ++length)
+	{
+		huffman.delta[length] = (int)k - (int)code;
+
+		while (huffman.size[k] == length)
+			codes[k++] = (unsigned short)code++;
+
+		// --- More codes than the length can hold ---
+		if (code > (1u << length))
+			return false;
+
+		huffman.maxcode[length] = code << (16 - length);
+		code <<= 1;
+	}
+
+	huffman.maxcode[17] = 0xFFFFFFFF;
+
+	memset(huffman.fast, 255, sizeof(huffman.fast));
+
+	for (uint i = 0; i < k; ++i)
+	{
+		uint length = huffman.size[i];
+
+		if (length > JPG_FAST_BITS)
+			continue;
+
+		uint first = codes[i] << (JPG_FAST_BITS - length);
+		uint count = 1 << (JPG_FAST_BITS - length);
+
+		for (uint j = 0; j < count; ++j)
+			huffman.fast[first + j] = (unsigned char)i;
+	}
+
+	huffman.valid = true;
+
+	return true;
+}
+
+static inline void FillBits(JPGBits& bits)
+{
+	while (bits.count <= 24)
+	{
+		uint byte = 0;
+
+		if (!bits.marker && bits.data < bits.end)
+		{
+			byte = *bits.data;
+
+			if (byte == 0xFF)
+			{
+				uint next = bits.data + 1 < bits.end ? bits.data[1] : 0xD9;
+
+				// --- A stuffed zero keeps the 0xFF, anything else is a marker and the data is over ---
+				if (next == 0x00)
+					bits.data += 2;
+				else
+				{
+					bits.marker = true;
+					byte = 0;
+				}
+			}
+			else
+				++bits.data;
+		}
+
+		bits.buffer |= byte << (24 - bits.count);
+		bits.count += 8;
+	}
+}
+
+static inline int DecodeSymbol(JPGBits& bits, const JPGHuffman& huffman)
+{
+	if (bits.count < 16)
+		FillBits(bits);
+
+	uint index = huffman.fast[bits.buffer >> (32 - JPG_FAST_BITS)];
+
+	if (index < 255)
+	{
+		uint length = huffman.size[index];
+		bits.buffer <<= length;
+		bits.count -= length;
+		return huffman.values[index];
+	}
+
+	uint top = bits.buffer >> 16;
+	uint length = JPG_FAST_BITS + 1;
+
+	while (top >= huffman.maxcode[length])
+		++length;
+
+	if (length == 17)
+		return -1;
+
+	int k = (int)(bits.buffer >> (32 - length)) + huffman.delta[length];
+
+	if (k < 0 || k > 255 || huffman.size[k] != length)
+		return -1;
+
+	bits.buffer <<= length;
+	bits.count -= length;
+
+	return huffman.values[k];
+}
+
+// --- Reads a magnitude category's extra bits as a signed value ---
+static inline int Receive(JPGBits& bits, uint length)
+{
+	if (length == 0)
+		return 0;
+
+	if (bits.count < (int)length)
+		FillBits(bits);
+
+	int value = (int)(bits.buffer >> (32 - length));
+	bits.buffer <<= length;
+	bits.count -= length;
+
+	if (value < (1 << (length - 1)))
+		value -= (1 << length) - 1;
+
+	return value;
+}
+
+// --- cos_table[x][u] = C(u) / 2 * cos((2x + 1) * u * pi / 16) ---
+struct JPGCosTable
+{
+	float values[8][8];
+
+	JPGCosTable()
+	{
+		for (uint x = 0; x < 8; ++x)
+		{
+			for (uint u = 0; u < 8; ++u)
+				values[x][u] = (u == 0 ? 0.70710678f : 1.0f) * 0.5f * cosf((2 * x + 1) * u * 3.14159265f / 16.0f);
+		}
+	}
+};
+
+// --- Separable float IDCT, rows then columns ---
+static void IDCT(const float* coefficients, unsigned char* out, uint stride)
+{
+	static const JPGCosTable table;
+	const float (*cos_table)[8] = table.values;
+
+	float rows[64];
+
+	for (uint v = 0; v < 8; ++v)
+	{
+		for (uint x = 0; x < 8; ++x)
+		{
+			float sum = 0.0f;
+
+			for (uint u = 0; u < 8; ++u)
+				sum += cos_table[x][u] * coefficients[v * 8 + u];
+
+			rows[v * 8 + x] = sum;
+		}
+	}
+
+	for (uint y = 0; y < 8; ++y)
+	{
+		for (uint x = 0; x < 8; ++x)
+		{
+			float sum = 128.5f;
+
+			for (uint v = 0; v < 8; ++v)
+				sum += cos_table[y][v] * rows[v * 8 + x];
+
+			out[y * stride + x] = (unsigned char)(sum < 0.0f ? 0 : (sum > 255.0f ? 255 : (int)sum));
+		}
+	}
+}
+
+static bool DecodeBlock(JPGBits& bits, JPGDecoder& decoder, JPGComponent& component, unsigned char* out, uint stride)
+{
+	const JPGHuffman& dc = decoder.dc[component.dc_table];
+	const JPGHuffman& ac = decoder.ac[component.ac_table];
+	const unsigned short* quant = decoder.quant[component.quant];
+
+	if (!dc.valid || !ac.valid)
+		return false;
+
+	int category = DecodeSymbol(bits, dc);
+
+	if (category < 0 || category > 11)
+		return false;
+
+	component.dc_prediction += Receive(bits, category);
+
+	float coefficients[64];
+	memset(coefficients, 0, sizeof(coefficients));
+	coefficients[0] = (float)(component.dc_prediction * quant[0]);
+
+	bool dc_only = true;
+
+	for (uint k = 1; k < 64;)
+	{
+		int symbol = DecodeSymbol(bits, ac);
+
+		if (symbol < 0)
+			return false;
+
+		uint run = symbol >> 4;
+		uint length = symbol & 15;
+
+		if (length == 0)
+		{
+			// --- End of block, or 16 zeros ---
+			if (run != 15)
+				break;
+
+			k += 16;
+			continue;
+		}
+
+		k += run;
+
+		if (k > 63)
+			return false;
+
+		coefficients[zigzag[k]] = (float)(Receive(bits, length) * quant[k]);
+		dc_only = false;
+		++k;
+	}
+
+	if (dc_only)
+	{
+		float value = coefficients[0] * 0.125f + 128.5f;
+		unsigned char flat = (unsigned char)(value < 0.0f ? 0 : (value > 255.0f ? 255 : (int)value));
+
+		for (uint y = 0; y < 8; ++y)
+			memset(out + y * stride, flat, 8);
+	}
+	else
+		IDCT(coefficients, out, stride);
+
+	return true;
+}
+
+static void Restart(JPGBits& bits, JPGDecoder& decoder)
+{
+	bits.buffer = 0;
+	bits.count = 0;
+	bits.marker = false;
+
+	while (bits.data + 1 < bits.end && !(bits.data[0] == 0xFF && bits.data[1] >= 0xD0 && bits.data[1] <= 0xD7))
+		++bits.data;
+
+	if (bits.data + 1 < bits.end)
+		bits.data += 2;
+
+	for (uint i = 0; i < decoder.component_count; ++i)
+		decoder.components[i].dc_prediction = 0;
+}
+
+static bool DecodeScan(JPGDecoder& decoder, JPGComponent** scan, uint scan_count, const unsigned char*& cursor, const unsigned char* end)
+{
+	JPGBits bits;
+	bits.data = cursor;
+	bits.end = end;
+
+	for (uint i = 0; i < decoder.component_count; ++i)
+		decoder.components[i].dc_prediction = 0;
+
+	uint restart_left = decoder.restart_interval;
+
+	if (scan_count == 1)
+	{
+		// --- Not interleaved, one block per unit and only the blocks that cover the image ---
+		JPGComponent& component = *scan[0];
+		uint blocks_x = ((decoder.width * component.h + decoder.hmax - 1) / decoder.hmax + 7) / 8;
+		uint blocks_y = ((decoder.height * component.v + decoder.vmax - 1) / decoder.vmax + 7) / 8;
+
+		for (uint by = 0; by < blocks_y; ++by)
+		{
+			for (uint bx = 0; bx < blocks_x; ++bx)
+			{
+				if (!DecodeBlock(bits, decoder, component, &component.plane[((size_t)by * 8 * component.width) + bx * 8], component.width))
+					return false;
+
+				if (decoder.restart_interval && --restart_left == 0)
+				{
+					Restart(bits, decoder);
+					restart_left = decoder.restart_interval;
+				}
+			}
+		}
+	}
+	else
+	{
+		uint mcus_x = (decoder.width + 8 * decoder.hmax - 1) / (8 * decoder.hmax);
+		uint mcus_y = (decoder.height + 8 * decoder.vmax - 1) / (8 * decoder.vmax);
+
+		for (uint my = 0; my < mcus_y; ++my)
+		{
+			for (uint mx = 0; mx < mcus_x; ++mx)
+			{
+				for (uint c = 0; c < scan_count; ++c)
+				{
+					JPGComponent& component = *scan[c];
+
+					for (uint by = 0; by < component.v; ++by)
+					{
+						for (uint bx = 0; bx < component.h; ++bx)
+						{
+							uint x = (mx * component.h + bx) * 8;
+							uint y = (my * component.v + by) * 8;
+
+							if (!DecodeBlock(bits, decoder, component, &component.plane[(size_t)y * component.width + x], component.width))
+								return false;
+						}
+					}
+				}
+
+				if (decoder.restart_interval && --restart_left == 0)
+				{
+					Restart(bits, decoder);
+					restart_left = decoder.restart_interval;
+				}
+			}
+		}
+	}
+
+	// --- Continue from the marker that ended the scan ---
+	cursor = bits.data;
+
+	while (cursor + 1 < end && !(cursor[0] == 0xFF && cursor[1] != 0x00 && !(cursor[1] >= 0xD0 && cursor[1] <= 0xD7)))
+		++cursor;
+
+	return true;
+}
+
+// --- Walks the segments. Stops after the frame header when only the info is wanted ---
+static bool ParseJPG(const unsigned char* data, uint64 size, JPGDecoder& decoder, bool info_only)
+{
+	if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+		return false;
+
+	const unsigned char* cursor = data + 2;
+	const unsigned char* end = data + size;
+
+	while (cursor + 4 <= end)
+	{
+		if (cursor[0] != 0xFF)
+		{
+			++cursor;
+			continue;
+		}
+
+		uint marker = cursor[1];
+
+		// --- Fill bytes ---
+		if (marker == 0xFF)
+		{
+			++cursor;
+			continue;
+		}
+
+		cursor += 2;
+
+		if (marker == 0xD9)
+			break;
+
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+			continue;
+
+		uint length = ReadBE16(cursor);
+
+		if (length < 2 || cursor + length > end)
+			return false;
+
+		const unsigned char* segment = cursor + 2;
+		const unsigned char* segment_end = cursor + length;
+		cursor = segment_end;
+
+		switch (marker)
+		{
+		case 0xC0: // Baseline
+		case 0xC1: // Extended sequential, Huffman
+		{
+			if (length < 8 || segment[0] != 8)
+				return false;
+
+			decoder.height = ReadBE16(segment + 1);
+			decoder.width = ReadBE16(segment + 3);
+			decoder.component_count = segment[5];
+
+			if (decoder.width == 0 || decoder.height == 0 || decoder.width > IMAGE_DECODER_MAX_SIZE || decoder.height > IMAGE_DECODER_MAX_SIZE || (decoder.component_count != 1 && decoder.component_count != 3) || length < 8 + 3 * decoder.component_count)
+				return false;
+
+			for (uint i = 0; i < decoder.component_count; ++i)
+			{
+				JPGComponent& component = decoder.components[i];
+				component.id = segment[6 + i * 3];
+				component.h = segment[7 + i * 3] >> 4;
+				component.v = segment[7 + i * 3] & 15;
+				component.quant = segment[8 + i * 3];
+
+				if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quant > 3)
+					return false;
+
+				decoder.hmax = component.h > decoder.hmax ? component.h : decoder.hmax;
+				decoder.vmax = component.v > decoder.vmax ? component.v : decoder.vmax;
+			}
+
+			decoder.frame = true;
+
+			if (info_only)
+				return true;
+
+			uint mcus_x = (decoder.width + 8 * decoder.hmax - 1) / (8 * decoder.hmax);
+			uint mcus_y = (decoder.height + 8 * decoder.vmax - 1) / (8 * decoder.vmax);
+
+			for (uint i = 0; i < decoder.component_count; ++i)
+			{
+				JPGComponent& component = decoder.components[i];
+				component.width = mcus_x * component.h * 8;
+				component.height = mcus_y * component.v * 8;
+				component.plane.assign((size_t)component.width * component.height, 128);
+			}
+
+			break;
+		}
+		case 0xC4: // Huffman tables
+		{
+			while (segment + 17 <= segment_end)
+			{
+				uint table_class = segment[0] >> 4;
+				uint table_id = segment[0] & 15;
+				uint count = 0;
+
+				for (uint i = 0; i < 16; ++i)
+					count += segment[1 + i];
+
+				if (table_class > 1 || table_id > 3 || count > 256 || segment + 17 + count > segment_end)
+					return false;
+
+				JPGHuffman& huffman = table_class == 0 ? decoder.dc[table_id] : decoder.ac[table_id];
+				memcpy(huffman.values, segment + 17, count);
+
+				if (!BuildHuffman(huffman, segment + 1))
+					return false;
+
+				segment += 17 + count;
+			}
+
+			break;
+		}
+		case 0xDB: // Quantization tables
+		{
+			while (segment < segment_end)
+			{
+				uint precision = segment[0] >> 4;
+				uint table_id = segment[0] & 15;
+				uint bytes = precision ? 2 : 1;
+
+				if (table_id > 3 || segment + 1 + 64 * bytes > segment_end)
+					return false;
+
+				for (uint i = 0; i < 64; ++i)
+					decoder.quant[table_id][i] = (unsigned short)(precision ? ReadBE16(segment + 1 + i * 2) : segment[1 + i]);
+
+				segment += 1 + 64 * bytes;
+			}
+
+			break;
+		}
+		case 0xDD: // Restart interval
+			if (length < 4)
+				return false;
+
+			decoder.restart_interval = ReadBE16(segment);
+			break;
+
+		case 0xDA: // Scan, its entropy coded data follows the header
+		{
+			if (!decoder.frame || length < 6)
+				return false;
+
+			uint scan_count = segment[0];
+			JPGComponent* scan[JPG_MAX_COMPONENTS] = { nullptr };
+
+			if (scan_count < 1 || scan_count > decoder.component_count || length < 6 + 2 * scan_count)
+				return false;
+
+			for (uint i = 0; i < scan_count; ++i)
+			{
+				uint id = segment[1 + i * 2];
+				uint tables = segment[2 + i * 2];
+
+				for (uint c = 0; c < decoder.component_count; ++c)
+				{
+					if (decoder.components[c].id == id)
+						scan[i] = &decoder.components[c];
+				}
+
+				if (scan[i] == nullptr || (tables >> 4) > 3 || (tables & 15) > 3)
+					return false;
+
+				scan[i]->dc_table = tables >> 4;
+				scan[i]->ac_table = tables & 15;
+			}
+
+			if (!DecodeScan(decoder, scan, scan_count, cursor, end))
+				return false;
+
+			break;
+		}
+		default:
+			// --- Progressive, lossless, arithmetic coding and hierarchical frames ---
+			if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+				return false;
+
+			// --- APPn, comments and anything else that can be skipped ---
+			break;
+		}
+	}
+
+	return decoder.frame && !info_only;
+}
+
+// --- Subsampled planes are stretched with bilinear filtering around sample centers, like libjpeg's fancy upsampling ---
+struct JPGTap
+{
+	uint first = 0;
+	uint second = 0;
+	uint weight = 0; // Of second, out of 256
+};
+
+static void BuildTaps(uint size, uint factor, uint max_factor, std::vector<JPGTap>& taps)
+{
+	uint samples = (size * factor + max_factor - 1) / max_factor;
+	taps.resize(size);
+
+	for (uint i = 0; i < size; ++i)
+	{
+		// --- Position in the plane, in 1/256 of a sample ---
+		int position = (int)(((2 * i + 1) * factor * 256) / (2 * max_factor)) - 128;
+
+		if (position < 0)
+			position = 0;
+
+		uint first = position >> 8;
+		JPGTap& tap = taps[i];
+		tap.first = first < samples ? first : samples - 1;
+		tap.second = first + 1 < samples ? first + 1 : samples - 1;
+		tap.weight = position & 255;
+	}
+}
+
+static void StretchRow(const JPGComponent& component, const JPGTap& vertical, const std::vector<JPGTap>& taps, unsigned char* row)
+{
+	const unsigned char* top = &component.plane[(size_t)vertical.first * component.width];
+	const unsigned char* bottom = &component.plane[(size_t)vertical.second * component.width];
+	uint weight = vertical.weight;
+
+	for (uint x = 0; x < taps.size(); ++x)
+	{
+		const JPGTap& h = taps[x];
+		uint upper = top[h.first] * (256 - h.weight) + top[h.second] * h.weight;
+		uint lower = bottom[h.first] * (256 - h.weight) + bottom[h.second] * h.weight;
+		row[x] = (unsigned char)((upper * (256 - weight) + lower * weight + 32768) >> 16);
+	}
+}
+
+bool ImageDecoderJPG::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	return size >= 4 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+bool ImageDecoderJPG::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	JPGDecoder decoder;
+
+	if (!ParseJPG(data, size, decoder, true))
+		return false;
+
+	info.format = PixelFormat::RGBA8;
+	info.width = decoder.width;
+	info.height = decoder.height;
+	info.levels = 1;
+	info.size = GetImageSize(info.format, info.width, info.height, 1);
+
+	return true;
+}
+
+bool ImageDecoderJPG::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	JPGDecoder decoder;
+
+	if (!ParseJPG(data, size, decoder, false) || decoder.width != info.width || decoder.height != info.height)
+		return false;
+
+	// --- Planes to RGBA. Components named R, G and B are already RGB ---
+	bool rgb = decoder.component_count == 3 && decoder.components[0].id == 'R' && decoder.components[1].id == 'G' && decoder.components[2].id == 'B';
+
+	std::vector<JPGTap> taps[JPG_MAX_COMPONENTS];
+	std::vector<JPGTap> row_taps[JPG_MAX_COMPONENTS];
+	std::vector<unsigned char> stretched[JPG_MAX_COMPONENTS];
+
+	for (uint c = 0; c < decoder.component_count; ++c)
+	{
+		if (decoder.components[c].h != decoder.hmax || decoder.components[c].v != decoder.vmax)
+		{
+			BuildTaps(decoder.width, decoder.components[c].h, decoder.hmax, taps[c]);
+			BuildTaps(decoder.height, decoder.components[c].v, decoder.vmax, row_taps[c]);
+			stretched[c].resize(decoder.width);
+		}
+	}
+
+	for (uint y = 0; y < decoder.height; ++y)
+	{
+		unsigned char* target = out + (uint64)(decoder.height - 1 - y) * decoder.width * 4;
+		const unsigned char* rows[JPG_MAX_COMPONENTS];
+
+		for (uint c = 0; c < decoder.component_count; ++c)
+		{
+			const JPGComponent& component = decoder.components[c];
+
+			if (taps[c].empty())
+				rows[c] = &component.plane[(size_t)y * component.width];
+			else
+			{
+				StretchRow(component, row_taps[c][y], taps[c], stretched[c].data());
+				rows[c] = stretched[c].data();
+			}
+		}
+
+		if (decoder.component_count == 1)
+		{
+			for (uint x = 0; x < decoder.width; ++x, target += 4)
+			{
+				target[0] = target[1] = target[2] = rows[0][x];
+				target[3] = 255;
+			}
+
+			continue;
+		}
+
+		for (uint x = 0; x < decoder.width; ++x, target += 4)
+		{
+			int c0 = rows[0][x];
+			int c1 = rows[1][x];
+			int c2 = rows[2][x];
+
+			if (rgb)
+			{
+				target[0] = (unsigned char)c0;
+				target[1] = (unsigned char)c1;
+				target[2] = (unsigned char)c2;
+			}
+			else
+			{
+				// --- JFIF YCbCr, 16.16 fixed point ---
+				int cb = c1 - 128;
+				int cr = c2 - 128;
+				int r = c0 + ((91881 * cr + 32768) >> 16);
+				int g = c0 - ((22554 * cb + 46802 * cr - 32768) >> 16);
+				int b = c0 + ((116130 * cb + 32768) >> 16);
+
+				target[0] = (unsigned char)(r < 0 ? 0 : (r > 255 ? 255 : r));
+				target[1] = (unsigned char)(g < 0 ? 0 : (g > 255 ? 255 : g));
+				target[2] = (unsigned char)(b < 0 ? 0 : (b > 255 ? 255 : b));
+			}
+
+			target[3] = 255;
+		}
+	}
+
+	return true;
+}
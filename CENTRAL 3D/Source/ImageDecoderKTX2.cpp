@@ -0,0 +1,438 @@
+#include "ImageDecoder.h"
+
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+#define KTX2_HEADER_SIZE 80 // Identifier, header and index
+#define KTX2_LEVEL_SIZE 24 // Offset, length and uncompressed length of one level
+#define KTX2_MAX_LEVELS 32
+#define KTX2_ORIENTATION_KEY "KTXorientation"
+#define KTX2_ORIENTATION_BOTTOM_UP "ru" // x right, y up
+
+// --- Vulkan formats, UNORM and then sRGB ---
+#define VK_FORMAT_R8G8B8A8_UNORM 37
+#define VK_FORMAT_R8G8B8A8_SRGB 43
+#define VK_FORMAT_BC1_RGB_UNORM_BLOCK 131
+#define VK_FORMAT_BC1_RGB_SRGB_BLOCK 132
+#define VK_FORMAT_BC1_RGBA_UNORM_BLOCK 133
+#define VK_FORMAT_BC1_RGBA_SRGB_BLOCK 134
+#define VK_FORMAT_BC2_UNORM_BLOCK 135
+#define VK_FORMAT_BC2_SRGB_BLOCK 136
+#define VK_FORMAT_BC3_UNORM_BLOCK 137
+#define VK_FORMAT_BC3_SRGB_BLOCK 138
+#define VK_FORMAT_BC4_UNORM_BLOCK 139
+#define VK_FORMAT_BC5_UNORM_BLOCK 141
+#define VK_FORMAT_BC7_UNORM_BLOCK 145
+#define VK_FORMAT_BC7_SRGB_BLOCK 146
+
+// --- Data format descriptor, what the spec requires of every file ---
+#define KDF_MODEL_RGBSDA 1
+#define KDF_MODEL_BC1A 128
+#define KDF_MODEL_BC2 129
+#define KDF_MODEL_BC3 130
+#define KDF_MODEL_BC4 131
+#define KDF_MODEL_BC5 132
+#define KDF_MODEL_BC7 134
+#define KDF_PRIMARIES_BT709 1
+#define KDF_TRANSFER_LINEAR 1
+#define KDF_TRANSFER_SRGB 2
+#define KDF_CHANNEL_ALPHA 15 // RGBSDA, BC2 and BC3
+#define KDF_SAMPLE_LINEAR 0x10 // Alpha of sRGB data
+
+static const unsigned char ktx2_identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// --- What ReadInfo, Decode and GetLevels need from a file ---
+struct KTX2Header
+{
+	PixelFormat format = PixelFormat::Unknown;
+	uint width = 0;
+	uint height = 0;
+	uint levels = 0;
+	bool bottom_up = false;
+	uint64 offsets[KTX2_MAX_LEVELS] = {}; // Largest first
+};
+
+static inline uint ReadU32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint)data[3] << 24);
+}
+
+static inline uint64 ReadU64(const unsigned char* data)
+{
+	return ReadU32(data) | ((uint64)ReadU32(data + 4) << 32);
+}
+
+static void PutU32(std::vector<unsigned char>& out, uint value)
+{
+	for (uint i = 0; i < 4; ++i)
+		out.push_back((unsigned char)(value >> (8 * i)));
+}
+
+static void PutU64(std::vector<unsigned char>& out, uint64 value)
+{
+	PutU32(out, (uint)value);
+	PutU32(out, (uint)(value >> 32));
+}
+
+static PixelFormat GetKTX2Format(uint vk_format)
+{
+	switch (vk_format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		return PixelFormat::RGBA8;
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		return PixelFormat::BC1;
+	case VK_FORMAT_BC2_UNORM_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+		return PixelFormat::BC2;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		return PixelFormat::BC3;
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		return PixelFormat::BC4;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		return PixelFormat::BC5;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return PixelFormat::BC7;
+	default:
+		return PixelFormat::Unknown;
+	}
+}
+
+// --- Orientation is top row first unless the key says otherwise ---
+static bool IsBottomUp(const unsigned char* data, uint64 size)
+{
+	uint64 offset = ReadU32(data + 56);
+	uint64 length = ReadU32(data + 60);
+
+	if (offset + length > size)
+		return false;
+
+	const unsigned char* cursor = data + offset;
+	const unsigned char* end = cursor + length;
+	uint key_size = sizeof(KTX2_ORIENTATION_KEY);
+
+	while (end - cursor >= 4)
+	{
+		uint entry = ReadU32(cursor);
+		cursor += 4;
+
+		if (entry > (uint64)(end - cursor))
+			break;
+
+		if (entry > key_size + 1 && memcmp(cursor, KTX2_ORIENTATION_KEY, key_size) == 0)
+			return cursor[key_size + 1] == KTX2_ORIENTATION_BOTTOM_UP[1];
+
+		cursor += (entry + 3) & ~3u;
+	}
+
+	return false;
+}
+
+static bool ReadKTX2Header(const unsigned char* data, uint64 size, KTX2Header& header)
+{
+	if (size < KTX2_HEADER_SIZE || memcmp(data, ktx2_identifier, sizeof(ktx2_identifier)) != 0)
+		return false;
+
+	// --- 2D only, no arrays, cubemaps or supercompression ---
+	if (ReadU32(data + 28) != 0 || ReadU32(data + 32) > 1 || ReadU32(data + 36) != 1 || ReadU32(data + 44) != 0)
+		return false;
+
+	header.format = GetKTX2Format(ReadU32(data + 12));
+	header.width = ReadU32(data + 20);
+	header.height = ReadU32(data + 24);
+	header.levels = ReadU32(data + 40);
+
+	if (header.levels == 0)
+		header.levels = 1;
+
+	if (header.format == PixelFormat::Unknown || header.width == 0 || header.height == 0 || header.width > IMAGE_DECODER_MAX_SIZE || header.height > IMAGE_DECODER_MAX_SIZE)
+		return false;
+
+	uint largest = header.width > header.height ? header.width : header.height;
+	uint max_levels = 1;
+
+	while (largest > 1)
+	{
+		largest /= 2;
+		++max_levels;
+	}
+
+	if (header.levels > max_levels || KTX2_HEADER_SIZE + (uint64)header.levels * KTX2_LEVEL_SIZE > size)
+		return false;
+
+	// --- What the index points to has to be there ---
+	uint width = header.width;
+	uint height = header.height;
+
+	for (uint level = 0; level < header.levels; ++level)
+	{
+		const unsigned char* entry = data + KTX2_HEADER_SIZE + level * KTX2_LEVEL_SIZE;
+		uint64 offset = ReadU64(entry);
+		uint64 length = ReadU64(entry + 8);
+
+		if (length < ImageDecoder::GetLevelSize(header.format, width, height) || offset > size || length > size - offset)
+			return false;
+
+		header.offsets[level] = offset;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	header.bottom_up = IsBottomUp(data, size);
+
+	return true;
+}
+
+bool ImageDecoderKTX2::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	return size >= KTX2_HEADER_SIZE && memcmp(data, ktx2_identifier, sizeof(ktx2_identifier)) == 0;
+}
+
+bool ImageDecoderKTX2::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	KTX2Header header;
+
+	if (!ReadKTX2Header(data, size, header))
+		return false;
+
+	// --- Top down blocks that cannot be flipped are decompressed, except BC7 which has no decompressor ---
+	bool keep = header.bottom_up || header.format == PixelFormat::RGBA8 || CanFlipBlocks(header.width, header.height, header.levels);
+
+	if (!keep && header.format == PixelFormat::BC7)
+		return false;
+
+	info.format = keep ? header.format : PixelFormat::RGBA8;
+	info.width = header.width;
+	info.height = header.height;
+	info.levels = header.levels;
+	info.size = GetImageSize(info.format, info.width, info.height, info.levels);
+
+	return true;
+}
+
+bool ImageDecoderKTX2::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	KTX2Header header;
+
+	if (!ReadKTX2Header(data, size, header))
+		return false;
+
+	uint width = info.width;
+	uint height = info.height;
+
+	for (uint level = 0; level < info.levels; ++level)
+	{
+		const unsigned char* source = data + header.offsets[level];
+		uint64 level_size = GetLevelSize(info.format, width, height);
+
+		if (header.bottom_up)
+			memcpy(out, source, (size_t)level_size);
+		else if (info.format != header.format)
+		{
+			std::vector<unsigned char> rgba((size_t)level_size);
+			DecompressBlocks(header.format, source, width, height, rgba.data());
+			FlipLevel(PixelFormat::RGBA8, rgba.data(), width, height, out);
+		}
+		else
+			FlipLevel(info.format, source, width, height, out);
+
+		out += level_size;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return true;
+}
+
+bool ImageDecoderKTX2::GetLevels(const unsigned char* data, uint64 size, ImageInfo& info, std::vector<const unsigned char*>& levels)
+{
+	KTX2Header header;
+
+	if (!ReadKTX2Header(data, size, header) || !header.bottom_up)
+		return false;
+
+	info.format = header.format;
+	info.width = header.width;
+	info.height = header.height;
+	info.levels = header.levels;
+	info.size = GetImageSize(info.format, info.width, info.height, info.levels);
+
+	levels.resize(header.levels);
+
+	for (uint level = 0; level < header.levels; ++level)
+		levels[level] = data + header.offsets[level];
+
+	return true;
+}
+
+// --- Basic descriptor block, one sample per channel or per half of a block ---
+static void PutDataFormat(std::vector<unsigned char>& out, PixelFormat format, bool srgb)
+{
+	struct Sample { uint offset, bits, channel; };
+
+	uint alpha = KDF_CHANNEL_ALPHA | (srgb ? KDF_SAMPLE_LINEAR : 0);
+	Sample samples[4] = {};
+	uint count = 0;
+	uint model = KDF_MODEL_RGBSDA;
+
+	switch (format)
+	{
+	case PixelFormat::BC1:
+		model = KDF_MODEL_BC1A;
+		samples[count++] = { 0, 64, 0 };
+		break;
+	case PixelFormat::BC2:
+	case PixelFormat::BC3:
+		model = format == PixelFormat::BC2 ? KDF_MODEL_BC2 : KDF_MODEL_BC3;
+		samples[count++] = { 0, 64, alpha };
+		samples[count++] = { 64, 64, 0 };
+		break;
+	case PixelFormat::BC4:
+		model = KDF_MODEL_BC4;
+		samples[count++] = { 0, 64, 0 };
+		break;
+	case PixelFormat::BC5:
+		model = KDF_MODEL_BC5;
+		samples[count++] = { 0, 64, 0 };
+		samples[count++] = { 64, 64, 1 };
+		break;
+	case PixelFormat::BC7:
+		model = KDF_MODEL_BC7;
+		samples[count++] = { 0, 128, 0 };
+		break;
+	default:
+		samples[count++] = { 0, 8, 0 };
+		samples[count++] = { 8, 8, 1 };
+		samples[count++] = { 16, 8, 2 };
+		samples[count++] = { 24, 8, alpha };
+		break;
+	}
+
+	bool blocks = format != PixelFormat::RGBA8;
+	uint block_size = 24 + 16 * count;
+
+	PutU32(out, 4 + block_size);
+	PutU32(out, 0);
+	PutU32(out, 2 | (block_size << 16));
+	PutU32(out, model | (KDF_PRIMARIES_BT709 << 8) | ((srgb ? KDF_TRANSFER_SRGB : KDF_TRANSFER_LINEAR) << 16));
+	PutU32(out, blocks ? 0x0303 : 0);
+	PutU32(out, blocks ? ImageDecoder::GetBlockBytes(format) : 4);
+	PutU32(out, 0);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		PutU32(out, samples[i].offset | ((samples[i].bits - 1) << 16) | (samples[i].channel << 24));
+		PutU32(out, 0);
+		PutU32(out, 0);
+		PutU32(out, blocks ? 0xFFFFFFFF : 255);
+	}
+}
+
+static void PutKeyValue(std::vector<unsigned char>& out, const char* key, const char* value)
+{
+	uint key_size = (uint)strlen(key) + 1;
+	uint value_size = (uint)strlen(value) + 1;
+
+	PutU32(out, key_size + value_size);
+	out.insert(out.end(), key, key + key_size);
+	out.insert(out.end(), value, value + value_size);
+
+	while (out.size() % 4)
+		out.push_back(0);
+}
+
+bool ImageDecoderKTX2::Write(const DecodedImage& image, bool srgb, std::vector<unsigned char>& out)
+{
+	uint vk_format = 0;
+
+	switch (image.format)
+	{
+	case PixelFormat::RGBA8: vk_format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM; break;
+	case PixelFormat::BC1: vk_format = srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK; break;
+	case PixelFormat::BC2: vk_format = srgb ? VK_FORMAT_BC2_SRGB_BLOCK : VK_FORMAT_BC2_UNORM_BLOCK; break;
+	case PixelFormat::BC3: vk_format = srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK; break;
+	case PixelFormat::BC4: vk_format = VK_FORMAT_BC4_UNORM_BLOCK; srgb = false; break;
+	case PixelFormat::BC5: vk_format = VK_FORMAT_BC5_UNORM_BLOCK; srgb = false; break;
+	case PixelFormat::BC7: vk_format = srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK; break;
+	default:
+		return false;
+	}
+
+	if (image.pixels == nullptr || image.levels == 0 || image.levels > KTX2_MAX_LEVELS)
+		return false;
+
+	std::vector<unsigned char> dfd, kvd;
+	PutDataFormat(dfd, image.format, srgb);
+	PutKeyValue(kvd, KTX2_ORIENTATION_KEY, KTX2_ORIENTATION_BOTTOM_UP);
+	PutKeyValue(kvd, "KTXwriter", "CENTRAL 3D");
+
+	uint dfd_offset = KTX2_HEADER_SIZE + image.levels * KTX2_LEVEL_SIZE;
+	uint kvd_offset = dfd_offset + (uint)dfd.size();
+
+	out.clear();
+	out.insert(out.end(), ktx2_identifier, ktx2_identifier + sizeof(ktx2_identifier));
+	PutU32(out, vk_format);
+	PutU32(out, 1);
+	PutU32(out, image.width);
+	PutU32(out, image.height);
+	PutU32(out, 0);
+	PutU32(out, 0);
+	PutU32(out, 1);
+	PutU32(out, image.levels);
+	PutU32(out, 0);
+	PutU32(out, dfd_offset);
+	PutU32(out, (uint)dfd.size());
+	PutU32(out, kvd_offset);
+	PutU32(out, (uint)kvd.size());
+	PutU64(out, 0);
+	PutU64(out, 0);
+
+	// --- Level index is largest first, the data smallest first, each level aligned to its block size ---
+	uint alignment = image.format == PixelFormat::RGBA8 ? 4 : GetBlockBytes(image.format);
+	uint64 offsets[KTX2_MAX_LEVELS] = {};
+	uint64 sizes[KTX2_MAX_LEVELS] = {};
+	uint64 source_offsets[KTX2_MAX_LEVELS] = {};
+	uint64 cursor = kvd_offset + kvd.size();
+	uint64 source = 0;
+
+	for (uint level = 0; level < image.levels; ++level)
+	{
+		sizes[level] = GetLevelSize(image.format, image.width >> level ? image.width >> level : 1, image.height >> level ? image.height >> level : 1);
+		source_offsets[level] = source;
+		source += sizes[level];
+	}
+
+	if (source > image.size)
+		return false;
+
+	for (uint level = image.levels; level-- > 0;)
+	{
+		cursor = (cursor + alignment - 1) / alignment * alignment;
+		offsets[level] = cursor;
+		cursor += sizes[level];
+	}
+
+	for (uint level = 0; level < image.levels; ++level)
+	{
+		PutU64(out, offsets[level]);
+		PutU64(out, sizes[level]);
+		PutU64(out, sizes[level]);
+	}
+
+	out.insert(out.end(), dfd.begin(), dfd.end());
+	out.insert(out.end(), kvd.begin(), kvd.end());
+	out.resize((size_t)cursor, 0);
+
+	for (uint level = 0; level < image.levels; ++level)
+		memcpy(&out[(size_t)offsets[level]], image.pixels + source_offsets[level], (size_t)sizes[level]);
+
+	return true;
+}
@@ -0,0 +1,637 @@
+#include "ImageDecoder.h"
+
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+#define INFLATE_FAST_BITS 9 // Codes this long or shorter are resolved with one table lookup
+#define INFLATE_MAX_SYMBOLS 288
+
+static const unsigned char png_signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+static inline uint ReadBE32(const unsigned char* data)
+{
+	return ((uint)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+// --- Inflate, enough of zlib for PNG. Output goes to a buffer of known size, never past it ---
+
+struct InflateHuffman
+{
+	unsigned short fast[1 << INFLATE_FAST_BITS]; // (length << 9) | symbol, 0 when the code is longer
+	unsigned short firstcode[16];
+	int maxcode[17];
+	unsigned short firstsymbol[16];
+	unsigned char size[INFLATE_MAX_SYMBOLS];
+	unsigned short value[INFLATE_MAX_SYMBOLS];
+};
+
+struct InflateStream
+{
+	const unsigned char* data = nullptr;
+	const unsigned char* end = nullptr;
+	uint64 bits = 0;
+	uint count = 0;
+	uint padding = 0; // Zero bytes fed past the end of the input
+
+	unsigned char* out = nullptr;
+	unsigned char* out_cursor = nullptr;
+	unsigned char* out_end = nullptr;
+};
+
+static const uint length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint distance_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const unsigned char code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static inline uint ReverseBits(uint value, uint bits)
+{
+	uint reversed = 0;
+
+	for (uint i = 0; i < bits; ++i)
+	{
+		reversed = (reversed << 1) | (value & 1);
+		value >>= 1;
+	}
+
+	return reversed;
+}
+
+static bool BuildHuffman(InflateHuffman& huffman, const unsigned char* lengths, uint count)
+{
+	int sizes[17] = { 0 };
+	int next_code[16] = { 0 };
+
+	memset(huffman.fast, 0, sizeof(huffman.fast));
+
+	for (uint i = 0; i < count; ++i)
+		++sizes[lengths[i]];
+
+	sizes[0] = 0;
+
+	for (uint i = 1; i < 16; ++i)
+	{
+		if (sizes[i] > (1 << i))
+			return false;
+	}
+
+	int code = 0;
+	int symbol = 0;
+
+	for (uint i = 1; i < 16; ++i)
+	{
+		next_code[i] = code;
+		huffman.firstcode[i] = (unsigned short)code;
+		huffman.firstsymbol[i] = (unsigned short)symbol;
+		code += sizes[i];
+
+		if (sizes[i] > 0 && code - 1 >= (1 << i))
+			return false;
+
+		huffman.maxcode[i] = code << (16 - i);
+		code <<= 1;
+		symbol += sizes[i];
+	}
+
+	huffman.maxcode[16] = 0x10000;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		uint length = lengths[i];
+
+		if (length == 0)
+			continue;
+
+		uint index = next_code[length] - huffman.firstcode[length] + huffman.firstsymbol[length];
+		huffman.size[index] = (unsigned char)length;
+		huffman.value[index] = (unsigned short)i;
+
+		if (length <= INFLATE_FAST_BITS)
+		{
+			unsigned short fast = (unsigned short)((length << 9) | i);
+
+			for (uint j = ReverseBits(next_code[length], length); j < (1 << INFLATE_FAST_BITS); j += 1 << length)
+				huffman.fast[j] = fast;
+		}
+
+		++next_code[length];
+	}
+
+	return true;
+}
+
+static inline void FillBits(InflateStream& stream)
+{
+	while (stream.count <= 56)
+	{
+		if (stream.data < stream.end)
+			stream.bits |= (uint64)*stream.data++ << stream.count;
+		else
+			++stream.padding;
+
+		stream.count += 8;
+	}
+}
+
+// --- Padding sits on top of the buffer, once any of it is consumed the input ran out ---
+static inline bool IsOverrun(const InflateStream& stream)
+{
+	return stream.padding * 8 > stream.count;
+}
+
+static inline uint GetBits(InflateStream& stream, uint count)
+{
+	if (stream.count < count)
+		FillBits(stream);
+
+	uint value = (uint)(stream.bits & ((1ull << count) - 1));
+	stream.bits >>= count;
+	stream.count -= count;
+
+	return value;
+}
+
+static inline int DecodeSymbol(InflateStream& stream, const InflateHuffman& huffman)
+{
+	if (stream.count < 16)
+		FillBits(stream);
+
+	uint fast = huffman.fast[stream.bits & ((1 << INFLATE_FAST_BITS) - 1)];
+
+	if (fast)
+	{
+		uint length = fast >> 9;
+		stream.bits >>= length;
+		stream.count -= length;
+		return fast & 511;
+	}
+
+	// --- Longer codes, compared as left aligned 16 bit values ---
+	uint code = ReverseBits((uint)(stream.bits & 0xFFFF), 16);
+	uint length = INFLATE_FAST_BITS + 1;
+
+	while (length < 16 && (int)code >= huffman.maxcode[length])
+		++length;
+
+	if (length >= 16)
+		return -1;
+
+	uint index = (code >> (16 - length)) - huffman.firstcode[length] + huffman.firstsymbol[length];
+
+	if (index >= INFLATE_MAX_SYMBOLS || huffman.size[index] != length)
+		return -1;
+
+	stream.bits >>= length;
+	stream.count -= length;
+
+	return huffman.value[index];
+}
+
+static bool InflateCodes(InflateStream& stream, const InflateHuffman& lengths, const InflateHuffman& distances)
+{
+	for (;;)
+	{
+		int symbol = DecodeSymbol(stream, lengths);
+
+		if (symbol < 0 || IsOverrun(stream))
+			return false;
+
+		if (symbol < 256)
+		{
+			if (stream.out_cursor >= stream.out_end)
+				return false;
+
+			*stream.out_cursor++ = (unsigned char)symbol;
+			continue;
+		}
+
+		if (symbol == 256)
+			return true;
+
+		symbol -= 257;
+
+		if (symbol >= 29)
+			return false;
+
+		uint length = length_base[symbol] + GetBits(stream, length_extra[symbol]);
+		int distance_symbol = DecodeSymbol(stream, distances);
+
+		if (distance_symbol < 0 || distance_symbol >= 30)
+			return false;
+
+		uint distance = distance_base[distance_symbol] + GetBits(stream, distance_extra[distance_symbol]);
+
+		if (distance > (uint64)(stream.out_cursor - stream.out) || length > (uint64)(stream.out_end - stream.out_cursor))
+			return false;
+
+		// --- Overlapping copies repeat what was just written, byte by byte ---
+		const unsigned char* source = stream.out_cursor - distance;
+
+		for (uint i = 0; i < length; ++i)
+			stream.out_cursor[i] = source[i];
+
+		stream.out_cursor += length;
+	}
+}
+
+static bool ReadDynamicTables(InflateStream& stream, InflateHuffman& lengths, InflateHuffman& distances)
+{
+	uint literal_count = GetBits(stream, 5) + 257;
+	uint distance_count = GetBits(stream, 5) + 1;
+	uint code_length_count = GetBits(stream, 4) + 4;
+
+	if (literal_count > 286 || distance_count > 30)
+		return false;
+
+	unsigned char code_lengths[19] = { 0 };
+
+	for (uint i = 0; i < code_length_count; ++i)
+		code_lengths[code_length_order[i]] = (unsigned char)GetBits(stream, 3);
+
+	InflateHuffman code_huffman;
+
+	if (!BuildHuffman(code_huffman, code_lengths, 19))
+		return false;
+
+	unsigned char all_lengths[286 + 30] = { 0 };
+	uint total = literal_count + distance_count;
+	uint filled = 0;
+
+	while (filled < total)
+	{
+		int symbol = DecodeSymbol(stream, code_huffman);
+
+		if (symbol < 0 || IsOverrun(stream))
+			return false;
+
+		if (symbol < 16)
+		{
+			all_lengths[filled++] = (unsigned char)symbol;
+			continue;
+		}
+
+		uint repeat = 0;
+		unsigned char value = 0;
+
+		if (symbol == 16)
+		{
+			if (filled == 0)
+				return false;
+
+			repeat = GetBits(stream, 2) + 3;
+			value = all_lengths[filled - 1];
+		}
+		else if (symbol == 17)
+			repeat = GetBits(stream, 3) + 3;
+		else
+			repeat = GetBits(stream, 7) + 11;
+
+		if (filled + repeat > total)
+			return false;
+
+		memset(all_lengths + filled, value, repeat);
+		filled += repeat;
+	}
+
+	return BuildHuffman(lengths, all_lengths, literal_count) && BuildHuffman(distances, all_lengths + literal_count, distance_count);
+}
+
+static bool Inflate(const unsigned char* data, uint64 size, unsigned char* out, uint64 out_size)
+{
+	// --- zlib header, deflate with no preset dictionary ---
+	if (size < 2 || (data[0] & 15) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 32))
+		return false;
+
+	InflateStream stream;
+	stream.data = data + 2;
+	stream.end = data + size;
+	stream.out = stream.out_cursor = out;
+	stream.out_end = out + out_size;
+
+	InflateHuffman lengths;
+	InflateHuffman distances;
+	bool last = false;
+
+	while (!last)
+	{
+		last = GetBits(stream, 1) != 0;
+		uint type = GetBits(stream, 2);
+
+		if (type == 0)
+		{
+			// --- Stored, from the next byte boundary ---
+			GetBits(stream, stream.count % 8);
+			uint length = GetBits(stream, 16);
+			uint inverse = GetBits(stream, 16);
+
+			if ((length ^ 0xFFFF) != inverse || length > (uint64)(stream.out_end - stream.out_cursor))
+				return false;
+
+			for (uint i = 0; i < length; ++i)
+				*stream.out_cursor++ = (unsigned char)GetBits(stream, 8);
+		}
+		else if (type == 1)
+		{
+			unsigned char fixed[INFLATE_MAX_SYMBOLS + 32];
+			memset(fixed, 8, 144);
+			memset(fixed + 144, 9, 112);
+			memset(fixed + 256, 7, 24);
+			memset(fixed + 280, 8, 8);
+			memset(fixed + INFLATE_MAX_SYMBOLS, 5, 32);
+
+			if (!BuildHuffman(lengths, fixed, INFLATE_MAX_SYMBOLS) || !BuildHuffman(distances, fixed + INFLATE_MAX_SYMBOLS, 32) || !InflateCodes(stream, lengths, distances))
+				return false;
+		}
+		else if (type == 2)
+		{
+			if (!ReadDynamicTables(stream, lengths, distances) || !InflateCodes(stream, lengths, distances))
+				return false;
+		}
+		else
+			return false;
+
+		if (IsOverrun(stream))
+			return false;
+	}
+
+	return stream.out_cursor == stream.out_end;
+}
+
+// --- PNG ---
+
+struct PNGHeader
+{
+	uint width = 0;
+	uint height = 0;
+	uint depth = 0;
+	uint color_type = 0;
+	uint interlace = 0;
+};
+
+static uint GetPNGChannels(uint color_type)
+{
+	switch (color_type)
+	{
+	case 0: return 1; // Gray
+	case 2: return 3; // RGB
+	case 3: return 1; // Palette
+	case 4: return 2; // Gray alpha
+	case 6: return 4; // RGBA
+	default: return 0;
+	}
+}
+
+static bool ReadPNGHeader(const unsigned char* data, uint64 size, PNGHeader& header)
+{
+	// --- IHDR is always the first chunk ---
+	if (size < 33 || memcmp(data, png_signature, 8) != 0 || ReadBE32(data + 8) != 13 || memcmp(data + 12, "IHDR", 4) != 0)
+		return false;
+
+	const unsigned char* ihdr = data + 16;
+	header.width = ReadBE32(ihdr);
+	header.height = ReadBE32(ihdr + 4);
+	header.depth = ihdr[8];
+	header.color_type = ihdr[9];
+	header.interlace = ihdr[12];
+
+	bool depth_valid = false;
+
+	switch (header.color_type)
+	{
+	case 0: depth_valid = header.depth == 1 || header.depth == 2 || header.depth == 4 || header.depth == 8 || header.depth == 16; break;
+	case 3: depth_valid = header.depth == 1 || header.depth == 2 || header.depth == 4 || header.depth == 8; break;
+	case 2: case 4: case 6: depth_valid = header.depth == 8 || header.depth == 16; break;
+	}
+
+	return depth_valid && header.interlace <= 1 && ihdr[10] == 0 && ihdr[11] == 0 && header.width > 0 && header.height > 0 && header.width <= IMAGE_DECODER_MAX_SIZE && header.height <= IMAGE_DECODER_MAX_SIZE;
+}
+
+bool ImageDecoderPNG::CanDecode(const unsigned char* data, uint64 size, const char* extension) const
+{
+	return size >= 8 && memcmp(data, png_signature, 8) == 0;
+}
+
+bool ImageDecoderPNG::ReadInfo(const unsigned char* data, uint64 size, ImageInfo& info) const
+{
+	PNGHeader header;
+
+	if (!ReadPNGHeader(data, size, header) || header.interlace > 1)
+		return false;
+
+	info.format = PixelFormat::RGBA8;
+	info.width = header.width;
+	info.height = header.height;
+	info.levels = 1;
+	info.size = GetImageSize(info.format, info.width, info.height, 1);
+
+	return true;
+}
+
+static inline unsigned char Paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = p > a ? p - a : a - p;
+	int pb = p > b ? p - b : b - p;
+	int pc = p > c ? p - c : c - p;
+
+	if (pa <= pb && pa <= pc)
+		return (unsigned char)a;
+
+	return (unsigned char)(pb <= pc ? b : c);
+}
+
+// --- Raw sample, 16 bit ones whole ---
+static inline uint ReadSample(const unsigned char* row, uint index, uint depth)
+{
+	if (depth == 8)
+		return row[index];
+
+	if (depth == 16)
+		return (row[index * 2] << 8) | row[index * 2 + 1];
+
+	uint bit = index * depth;
+
+	return (row[bit / 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1);
+}
+
+static inline unsigned char ToByte(uint sample, uint depth)
+{
+	if (depth == 8)
+		return (unsigned char)sample;
+
+	if (depth == 16)
+		return (unsigned char)(sample >> 8);
+
+	return (unsigned char)(sample * 255 / ((1 << depth) - 1));
+}
+
+bool ImageDecoderPNG::Decode(const unsigned char* data, uint64 size, const ImageInfo& info, unsigned char* out) const
+{
+	PNGHeader header;
+
+	// --- out is sized from info, a header that says otherwise would write past it ---
+	if (!ReadPNGHeader(data, size, header) || header.width != info.width || header.height != info.height || info.format != PixelFormat::RGBA8)
+		return false;
+
+	// --- Walk the chunks, image data may be split across many ---
+	std::vector<unsigned char> compressed;
+	unsigned char palette[256 * 4];
+	uint palette_size = 0;
+	uint transparent[3] = { 0, 0, 0 };
+	bool has_transparent = false;
+
+	memset(palette, 255, sizeof(palette));
+
+	uint64 cursor = 8;
+
+	while (cursor + 12 <= size)
+	{
+		uint length = ReadBE32(data + cursor);
+		const unsigned char* type = data + cursor + 4;
+		const unsigned char* chunk = data + cursor + 8;
+
+		if (length > size - cursor - 12)
+			return false;
+
+		if (memcmp(type, "IDAT", 4) == 0)
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			palette_size = length / 3 < 256 ? length / 3 : 256;
+
+			for (uint i = 0; i < palette_size; ++i)
+				memcpy(palette + i * 4, chunk + i * 3, 3);
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			if (header.color_type == 3)
+			{
+				for (uint i = 0; i < length && i < 256; ++i)
+					palette[i * 4 + 3] = chunk[i];
+			}
+			else if ((header.color_type == 0 && length >= 2) || (header.color_type == 2 && length >= 6))
+			{
+				for (uint i = 0; i < (header.color_type == 0 ? 1u : 3u); ++i)
+					transparent[i] = (chunk[i * 2] << 8) | chunk[i * 2 + 1];
+
+				has_transparent = true;
+			}
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+			break;
+
+		cursor += 12 + (uint64)length;
+	}
+
+	uint channels = GetPNGChannels(header.color_type);
+	uint bits_per_pixel = channels * header.depth;
+	uint filter_bytes = bits_per_pixel >= 8 ? bits_per_pixel / 8 : 1;
+
+	// --- Adam7 passes as first column, first row and steps, a plain image is a single pass over everything ---
+	static const uint adam7[7][4] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+	static const uint single[1][4] = { { 0, 0, 1, 1 } };
+
+	const uint(*passes)[4] = header.interlace ? adam7 : single;
+	uint pass_count = header.interlace ? 7 : 1;
+
+	uint64 raw_size = 0;
+
+	for (uint pass = 0; pass < pass_count; ++pass)
+	{
+		uint width = header.width > passes[pass][0] ? (header.width - passes[pass][0] + passes[pass][2] - 1) / passes[pass][2] : 0;
+		uint height = header.height > passes[pass][1] ? (header.height - passes[pass][1] + passes[pass][3] - 1) / passes[pass][3] : 0;
+
+		if (width > 0 && height > 0)
+			raw_size += (((uint64)width * bits_per_pixel + 7) / 8 + 1) * height;
+	}
+
+	std::vector<unsigned char> raw((size_t)raw_size);
+
+	if (compressed.empty() || !Inflate(compressed.data(), compressed.size(), raw.data(), raw.size()))
+		return false;
+
+	unsigned char* filter = raw.data();
+
+	for (uint pass = 0; pass < pass_count; ++pass)
+	{
+		uint x0 = passes[pass][0];
+		uint y0 = passes[pass][1];
+		uint step_x = passes[pass][2];
+		uint step_y = passes[pass][3];
+		uint width = header.width > x0 ? (header.width - x0 + step_x - 1) / step_x : 0;
+		uint height = header.height > y0 ? (header.height - y0 + step_y - 1) / step_y : 0;
+
+		if (width == 0 || height == 0)
+			continue;
+
+		uint64 row_bytes = ((uint64)width * bits_per_pixel + 7) / 8;
+		const unsigned char* previous = nullptr;
+
+		// --- Unfilter in place, each row against the one above it, then expand to RGBA ---
+		for (uint y = 0; y < height; ++y, filter += row_bytes + 1)
+		{
+			unsigned char* row = filter + 1;
+
+			for (uint64 i = 0; i < row_bytes; ++i)
+			{
+				int left = i >= filter_bytes ? row[i - filter_bytes] : 0;
+				int up = previous ? previous[i] : 0;
+				int up_left = previous && i >= filter_bytes ? previous[i - filter_bytes] : 0;
+
+				switch (*filter)
+				{
+				case 0: break;
+				case 1: row[i] = (unsigned char)(row[i] + left); break;
+				case 2: row[i] = (unsigned char)(row[i] + up); break;
+				case 3: row[i] = (unsigned char)(row[i] + ((left + up) >> 1)); break;
+				case 4: row[i] = (unsigned char)(row[i] + Paeth(left, up, up_left)); break;
+				default: return false;
+				}
+			}
+
+			previous = row;
+
+			uint image_y = y0 + y * step_y;
+			unsigned char* target = out + ((uint64)(header.height - 1 - image_y) * header.width + x0) * 4;
+
+			for (uint x = 0; x < width; ++x, target += step_x * 4)
+			{
+				switch (header.color_type)
+				{
+				case 0:
+				{
+					uint gray = ReadSample(row, x, header.depth);
+					target[0] = target[1] = target[2] = ToByte(gray, header.depth);
+					target[3] = has_transparent && gray == transparent[0] ? 0 : 255;
+					break;
+				}
+				case 2:
+				{
+					uint rgb[3] = { ReadSample(row, x * 3, header.depth), ReadSample(row, x * 3 + 1, header.depth), ReadSample(row, x * 3 + 2, header.depth) };
+
+					for (uint i = 0; i < 3; ++i)
+						target[i] = ToByte(rgb[i], header.depth);
+
+					target[3] = has_transparent && rgb[0] == transparent[0] && rgb[1] == transparent[1] && rgb[2] == transparent[2] ? 0 : 255;
+					break;
+				}
+				case 3:
+					memcpy(target, palette + ReadSample(row, x, header.depth) * 4, 4);
+					break;
+				case 4:
+					target[0] = target[1] = target[2] = ToByte(ReadSample(row, x * 2, header.depth), header.depth);
+					target[3] = ToByte(ReadSample(row, x * 2 + 1, header.depth), header.depth);
+					break;
+				case 6:
+					for (uint i = 0; i < 4; ++i)
+						target[i] = ToByte(ReadSample(row, x * 4 + i, header.depth), header.depth);
+					break;
+				}
+			}
+		}
+	}
+
+	return true;
+}
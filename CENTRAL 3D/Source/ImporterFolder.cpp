@@ -7,6 +7,7 @@
 
 #include "ResourceMeta.h"
 #include "ResourceFolder.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -21,6 +22,8 @@ ImporterFolder::~ImporterFolder()
 
 Resource* ImporterFolder::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	Resource* folder = nullptr;
 
 	folder = App->resources->CreateResource(Resource::ResourceType::FOLDER, IData.path);
@@ -41,6 +44,8 @@ Resource* ImporterFolder::Import(ImportData& IData) const
 
 Resource* ImporterFolder::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceFolder* folder = nullptr;
 
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
@@ -50,7 +55,7 @@ Resource* ImporterFolder::Load(const char* path) const
 	new_path.pop_back();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(new_path.c_str());
 
-	folder = App->resources->folders.find(meta->GetUID()) != App->resources->folders.end() ? App->resources->folders.find(meta->GetUID())->second : (ResourceFolder*)App->resources->CreateResourceGivenUID(Resource::ResourceType::FOLDER, path, meta->GetUID());
+	folder = (ResourceFolder*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::FOLDER, path, meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(folder->GetOriginalFile()))
@@ -67,7 +72,7 @@ void ImporterFolder::Save(ResourceFolder* folder) const
 {
 	if (folder)
 	{
-		App->fs->CreateDirectoryA(folder->GetResourceFile());
+		App->fs->CreateDirectory(folder->GetResourceFile());
 
 		std::string new_path = folder->GetOriginalFile();
 		new_path.pop_back();
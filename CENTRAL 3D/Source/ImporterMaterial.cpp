@@ -21,6 +21,7 @@
 #include "OpenGL.h"
 
 #include "Assimp/include/scene.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -35,6 +36,8 @@ ImporterMaterial::~ImporterMaterial()
 // --- Create Material from Scene and path to file ---
 Resource* ImporterMaterial::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	ImportMaterialData* MatData = (ImportMaterialData*)&IData;
 
 	// --- Get Directory from filename ---
@@ -103,6 +106,8 @@ Resource* ImporterMaterial::Import(ImportData& IData) const
 
 Resource* ImporterMaterial::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceMaterial* mat = nullptr;
 	ResourceTexture* diffuse = nullptr;
 
@@ -114,7 +119,7 @@ Resource* ImporterMaterial::Load(const char* path) const
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(path);
 
 	// --- Extract data from .mat file (json) and create mat ---
-	mat = App->resources->materials.find(meta->GetUID()) != App->resources->materials.end() ? App->resources->materials.find(meta->GetUID())->second : (ResourceMaterial*)App->resources->CreateResourceGivenUID(Resource::ResourceType::MATERIAL, meta->GetOriginalFile(), meta->GetUID());
+	mat = (ResourceMaterial*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::MATERIAL, meta->GetOriginalFile(), meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(mat->GetOriginalFile()))
@@ -254,11 +259,15 @@ Resource* ImporterMaterial::Load(const char* path) const
 	if (diffuse)
 		mat->resource_diffuse = diffuse;	
 
+	RecordDependencies(mat);
+
 	return mat;
 }
 
 void ImporterMaterial::Save(ResourceMaterial* mat) const
 {
+	PROFILE_FUNCTION();
+
 	if (mat->GetUID() == App->resources->DefaultMaterial->GetUID())
 		return;
 
@@ -273,8 +282,7 @@ void ImporterMaterial::Save(ResourceMaterial* mat) const
 	tmpgo->GetComponent<ComponentMeshRenderer>()->material = (ResourceMaterial*)App->resources->GetResource(mat->GetUID());
 
 	// --- Destroy texture first ---
-	uint prevTexID = mat->GetPreviewTexID();
-	glDeleteTextures(1, (GLuint*)&prevTexID);
+	mat->ReleasePreviewTexture();
 
 	App->fs->Remove(mat->previewTexPath.c_str());
 
@@ -387,6 +395,8 @@ void ImporterMaterial::Save(ResourceMaterial* mat) const
 
 	App->fs->Save(mat->GetResourceFile(), buffer, size);
 
+	RecordDependencies(mat);
+
 	// --- Update meta ---
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(mat->GetOriginalFile());
@@ -399,3 +409,16 @@ void ImporterMaterial::Save(ResourceMaterial* mat) const
 	else
 		CONSOLE_LOG("|[error]: Could not load meta from: %s", mat->GetResourceFile());
 }
+
+void ImporterMaterial::RecordDependencies(const ResourceMaterial* mat) const
+{
+	// --- Shader and textures, the material is refreshed when any of them is reimported ---
+	std::vector<uint> dependencies;
+
+	if (mat->shader)
+		dependencies.push_back(mat->shader->GetUID());
+
+	dependencies.push_back(mat->resource_diffuse.GetUID());
+
+	App->resources->GetDependencyGraph().SetDependencies(mat->GetUID(), dependencies);
+}
@@ -27,6 +27,9 @@ public:
 	void Save(ResourceMaterial* mat) const;
 
 	static inline Importer::ImporterType GetType() { return Importer::ImporterType::Material; };
+
+private:
+	void RecordDependencies(const ResourceMaterial* mat) const;
 };
 
 #endif
@@ -8,9 +8,16 @@
 #include "Assimp/include/scene.h"
 
 #include "Math.h"
+#include "Allocator.h"
+#include "Profiler.h"
+#include "Kernels.h"
+#include "FrameScheduler.h"
+#include "MeshCodec.h"
 
 #include "mmgr/mmgr.h"
 
+#define MESH_FILE_MAGIC 0x4D443343 // "C3DM", never a plausible source name length, which is what older files start with
+
 ImporterMesh::ImporterMesh() : Importer(Importer::ImporterType::Mesh)
 {
 }
@@ -21,9 +28,12 @@ ImporterMesh::~ImporterMesh()
 
 Resource* ImporterMesh::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	ImportMeshData data = (ImportMeshData&)IData;
 
 	ResourceMesh* resource_mesh = (ResourceMesh*)App->resources->CreateResource(Resource::ResourceType::MESH, IData.path);
+	resource_mesh->compressed = data.compress;
 
 	resource_mesh->vertices = new Vertex[data.mesh->mNumVertices];
 	resource_mesh->VerticesSize = data.mesh->mNumVertices;
@@ -31,36 +41,20 @@ Resource* ImporterMesh::Import(ImportData& IData) const
 	resource_mesh->IndicesSize = data.mesh->mNumFaces * 3;
 	resource_mesh->Indices = new uint[resource_mesh->IndicesSize];
 
-	for (uint i = 0; i < data.mesh->mNumVertices; ++i)
-	{
-		// --- Vertices ---
-		resource_mesh->vertices[i].position[0] = data.mesh->mVertices[i].x;
-		resource_mesh->vertices[i].position[1] = data.mesh->mVertices[i].y;
-		resource_mesh->vertices[i].position[2] = data.mesh->mVertices[i].z;
-
-		// --- Normals ---
-		if (data.mesh->HasNormals())
-		{
-			resource_mesh->vertices[i].normal[0] = data.mesh->mNormals[i].x;
-			resource_mesh->vertices[i].normal[1] = data.mesh->mNormals[i].y;
-			resource_mesh->vertices[i].normal[2] = data.mesh->mNormals[i].z;
-		}
+	// --- Vertices, normals and texture coordinates, missing ones are zero and colors white ---
+	Kernels::PackVertices((const float*)data.mesh->mVertices, data.mesh->HasNormals() ? (const float*)data.mesh->mNormals : nullptr,
+		data.mesh->HasTextureCoords(0) ? (const float*)data.mesh->mTextureCoords[0] : nullptr, resource_mesh->vertices, data.mesh->mNumVertices);
 
-		// --- Colors ---
-		if (data.mesh->HasVertexColors(0))
+	// --- Colors ---
+	if (data.mesh->HasVertexColors(0))
+	{
+		for (uint i = 0; i < data.mesh->mNumVertices; ++i)
 		{
 			resource_mesh->vertices[i].color[0] = data.mesh->mColors[0][i].r;
 			resource_mesh->vertices[i].color[1] = data.mesh->mColors[0][i].g;
 			resource_mesh->vertices[i].color[2] = data.mesh->mColors[0][i].b;
 			resource_mesh->vertices[i].color[3] = data.mesh->mColors[0][i].a;
 		}
-
-		// --- Texture Coordinates ---
-		if (data.mesh->HasTextureCoords(0))
-		{
-			resource_mesh->vertices[i].texCoord[0] = data.mesh->mTextureCoords[0][i].x;
-			resource_mesh->vertices[i].texCoord[1] = data.mesh->mTextureCoords[0][i].y;
-		}
 	}
 
 	// --- Indices ---
@@ -90,137 +84,416 @@ Resource* ImporterMesh::Import(ImportData& IData) const
 
 void ImporterMesh::Save(ResourceMesh * mesh) const
 {
-	uint sourcefilename_length = std::string(mesh->GetOriginalFile()).size();
+	PROFILE_FUNCTION();
+
+	// --- The file may be the one the mesh is mapped from ---
+	mesh->DetachMapping();
+
+	Write(mesh->GetResourceFile(), mesh->GetOriginalFile(), mesh->vertices, mesh->VerticesSize, mesh->Indices, mesh->IndicesSize, mesh->compressed);
 
-	// amount of indices / vertices / normals / texture_coords / AABB
-	uint ranges[3] = { sourcefilename_length, mesh->IndicesSize, mesh->VerticesSize};
+	mesh->CreateAABB();
+	mesh->CreateBoundingSphere();
+}
+
+bool ImporterMesh::Write(const char* file, const char* source, const Vertex* vertices, uint vertex_count, const uint* indices, uint index_count, bool compress) const
+{
+	static_assert(sizeof(MeshHeader) % MESH_BLOCK_ALIGNMENT == 0, "Mesh blocks must stay aligned after the header");
+	static_assert(sizeof(Vertex) == 36, "Mesh file vertices must match the Vertex struct, bump MESH_FILE_VERSION on any change");
 
-	uint size =  sizeof(ranges) + sizeof(const char) * sourcefilename_length + sizeof(uint) * mesh->IndicesSize + sizeof(float) * 3 * mesh->VerticesSize + sizeof(float) * 3 * mesh->VerticesSize + sizeof(unsigned char) * 4 * mesh->VerticesSize + sizeof(float) * 2 * mesh->VerticesSize;
+	MeshHeader header;
+	memset(&header, 0, sizeof(header));
 
-	char* data = new char[size]; // Allocate
-	float* Vertices = new float[mesh->VerticesSize*3];
-	float* Normals = new float[mesh->VerticesSize*3];
-	unsigned char* Colors = new unsigned char[mesh->VerticesSize*4];
-	float* TexCoords = new float[mesh->VerticesSize*2];
-	char* cursor = data;
+	uint source_length = std::string(source).size();
 
-	// --- Fill temporal arrays ---
+	// --- Compressed blocks are coded up front, their sizes decide the layout ---
+	std::vector<unsigned char> packed_vertices;
+	std::vector<unsigned char> packed_indices;
+	uint64 vertex_bytes = (uint64)sizeof(Vertex) * vertex_count;
+	uint64 index_bytes = (uint64)sizeof(uint) * index_count;
 
-	for (uint i = 0; i < mesh->VerticesSize; ++i)
+	if (compress)
 	{
-		// --- Vertices ---
-		Vertices[i * 3] =	mesh->vertices[i].position[0];
-		Vertices[(i * 3) + 1] = mesh->vertices[i].position[1];
-		Vertices[(i * 3) + 2] = mesh->vertices[i].position[2];
-
-		// --- Normals ---
-		Normals[i * 3] = mesh->vertices[i].normal[0];
-		Normals[(i * 3) + 1] = mesh->vertices[i].normal[1];
-		Normals[(i * 3) + 2] = mesh->vertices[i].normal[2];
-
-		// --- Colors ---
-		Colors[i * 4] = mesh->vertices[i].color[0];
-		Colors[(i * 4) + 1] = mesh->vertices[i].color[1];
-		Colors[(i * 4) + 2] = mesh->vertices[i].color[2];
-		Colors[(i * 4) + 3] = mesh->vertices[i].color[3];
-
-		// --- Texture Coordinates ---
-		TexCoords[i * 2] = mesh->vertices[i].texCoord[0];
-		TexCoords[(i * 2) + 1] = mesh->vertices[i].texCoord[1];
+		MeshCodec::EncodeVertices(vertices, vertex_count, sizeof(Vertex), packed_vertices);
+		MeshCodec::EncodeIndices(indices, index_count, packed_indices);
+		vertex_bytes = packed_vertices.size();
+		index_bytes = packed_indices.size();
+		header.flags |= MESH_FLAG_COMPRESSED;
 	}
 
+	// --- Source name, then every block aligned so the mapping can be handed to GL as is ---
+	uint64 cursor = sizeof(MeshHeader);
+	header.source_offset = cursor;
+	cursor += source_length;
+	cursor = (cursor + MESH_BLOCK_ALIGNMENT - 1) & ~(uint64)(MESH_BLOCK_ALIGNMENT - 1);
+	header.vertex_offset = cursor;
+	cursor += vertex_bytes;
+	cursor = (cursor + MESH_BLOCK_ALIGNMENT - 1) & ~(uint64)(MESH_BLOCK_ALIGNMENT - 1);
+	header.index_offset = cursor;
+	cursor += index_bytes;
+	cursor = (cursor + MESH_BLOCK_ALIGNMENT - 1) & ~(uint64)(MESH_BLOCK_ALIGNMENT - 1);
+	header.submesh_offset = cursor;
+
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.header_size = sizeof(MeshHeader);
+	header.vertex_count = vertex_count;
+	header.vertex_stride = sizeof(Vertex);
+	header.index_count = index_count;
+	header.index_stride = sizeof(uint);
+	header.submesh_count = 0;
+	header.source_length = source_length;
+	header.data_size = cursor - sizeof(MeshHeader);
+
+	// --- Bounds, so loading never walks the vertices ---
+	float min[3] = { 0.0f, 0.0f, 0.0f };
+	float max[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (uint i = 0; i < vertex_count; ++i)
+	{
+		for (uint axis = 0; axis < 3; ++axis)
+		{
+			float value = vertices[i].position[axis];
+			min[axis] = i == 0 || value < min[axis] ? value : min[axis];
+			max[axis] = i == 0 || value > max[axis] ? value : max[axis];
+		}
+	}
 
-	// --- Store everything ---
+	float radius_sq = 0.0f;
 
-	// --- Store ranges ---
-	uint bytes = sizeof(ranges);
-	memcpy(cursor, ranges, bytes);
+	for (uint axis = 0; axis < 3; ++axis)
+	{
+		header.aabb_min[axis] = min[axis];
+		header.aabb_max[axis] = max[axis];
+		header.sphere_center[axis] = (min[axis] + max[axis]) * 0.5f;
+	}
 
-	// --- Store original filename ---
-	cursor += bytes;
-	bytes = sizeof(const char) * sourcefilename_length;
-	memcpy(cursor, mesh->GetOriginalFile(), bytes);
+	for (uint i = 0; i < vertex_count; ++i)
+	{
+		float dx = vertices[i].position[0] - header.sphere_center[0];
+		float dy = vertices[i].position[1] - header.sphere_center[1];
+		float dz = vertices[i].position[2] - header.sphere_center[2];
+		float distance_sq = dx * dx + dy * dy + dz * dz;
+		radius_sq = distance_sq > radius_sq ? distance_sq : radius_sq;
+	}
 
-	// --- Store Indices ---
-	cursor += bytes; 
-	bytes = sizeof(uint) * mesh->IndicesSize;
-	memcpy(cursor, mesh->Indices, bytes);
+	header.sphere_radius = sqrtf(radius_sq);
 
-	// --- Store Vertices ---
-	cursor += bytes; 
-	bytes = sizeof(float) * mesh->VerticesSize * 3;
-	memcpy(cursor,Vertices, bytes);
+	// --- Temporal buffer, accounted on the import heap. Padding stays zeroed so the checksum is stable ---
+	char* data = (char*)ENGINE_ALLOC(MemoryTag::Import, (size_t)cursor);
+	memset(data, 0, (size_t)cursor);
 
-	// --- Store Normals ---
-	cursor += bytes;
-	bytes = sizeof(float) * mesh->VerticesSize * 3;
-	memcpy(cursor, Normals, bytes);
+	memcpy(data + header.source_offset, source, source_length);
+	memcpy(data + header.vertex_offset, compress ? (const void*)packed_vertices.data() : vertices, (size_t)vertex_bytes);
+	memcpy(data + header.index_offset, compress ? (const void*)packed_indices.data() : indices, (size_t)index_bytes);
 
-	// --- Store Colors ---
-	cursor += bytes;
-	bytes = sizeof(unsigned char) * mesh->VerticesSize * 4;
-	memcpy(cursor, Colors, bytes);
+	header.checksum = App->fs->Hash(data + sizeof(MeshHeader), header.data_size);
+	memcpy(data, &header, sizeof(MeshHeader));
+
+	bool ret = App->fs->Save(file, data, (uint)cursor) == cursor;
+
+	if (!ret)
+		CONSOLE_LOG("|[error]: Importer Mesh could not write %s", file);
+
+	ENGINE_FREE(data);
+
+	return ret;
+}
 
-	// --- Store TexCoords ---
+const ImporterMesh::MeshHeader* ImporterMesh::ReadHeader(const MappedFile& mapped) const
+{
+	if (mapped.size < sizeof(MeshHeader))
+		return nullptr;
+
+	const MeshHeader* header = (const MeshHeader*)mapped.data;
+
+	if (header->magic != MESH_FILE_MAGIC)
+		return nullptr;
+
+	if (header->version != MESH_FILE_VERSION || header->header_size != sizeof(MeshHeader) || header->vertex_stride != sizeof(Vertex) || header->index_stride != sizeof(uint))
+	{
+		CONSOLE_LOG("![Warning]: Importer Mesh found a mesh file of version %u, expected %u", header->version, MESH_FILE_VERSION);
+		return nullptr;
+	}
+
+	// --- Nothing may point out of the file. Compressed blocks run up to the next one ---
+	bool compressed = (header->flags & MESH_FLAG_COMPRESSED) != 0;
+	uint64 vertex_end = compressed ? header->index_offset : header->vertex_offset + (uint64)header->vertex_count * sizeof(Vertex);
+	uint64 index_end = compressed ? header->submesh_offset : header->index_offset + (uint64)header->index_count * sizeof(uint);
+
+	bool valid = sizeof(MeshHeader) + header->data_size <= mapped.size
+		&& header->source_offset + header->source_length <= mapped.size
+		&& header->vertex_offset <= vertex_end && vertex_end <= mapped.size
+		&& header->index_offset <= index_end && index_end <= mapped.size
+		&& header->submesh_offset + (uint64)header->submesh_count * sizeof(MeshSubmesh) <= mapped.size
+		&& header->vertex_offset % MESH_BLOCK_ALIGNMENT == 0 && header->index_offset % MESH_BLOCK_ALIGNMENT == 0;
+
+	// --- Checking every byte would undo the point of mapping, debug builds still do ---
+#ifdef _DEBUG
+	valid = valid && App->fs->Hash(mapped.data + sizeof(MeshHeader), header->data_size) == header->checksum;
+#endif
+
+	if (!valid)
+	{
+		CONSOLE_LOG("|[error]: Importer Mesh found a damaged mesh file");
+		return nullptr;
+	}
+
+	return header;
+}
+
+bool ImporterMesh::ReadLegacy(const MappedFile& mapped, std::string& source, std::vector<Vertex>& vertices, std::vector<uint>& indices) const
+{
+	// amount of indices / vertices / normals / texture_coords
+	uint ranges[3];
+	uint64 bytes = sizeof(ranges);
+
+	if (mapped.size < bytes)
+		return false;
+
+	memcpy(ranges, mapped.data, sizeof(ranges));
+
+	uint64 size = bytes + ranges[0] + sizeof(uint) * (uint64)ranges[1] + (sizeof(float) * 8 + sizeof(unsigned char) * 4) * (uint64)ranges[2];
+
+	if (size > mapped.size)
+		return false;
+
+	const char* cursor = mapped.data + bytes;
+
+	// --- Read the original file's name ---
+	source.assign(cursor, ranges[0]);
+	cursor += ranges[0];
+
+	// --- Load indices ---
+	indices.resize(ranges[1]);
+	bytes = sizeof(uint) * indices.size();
+	memcpy(indices.data(), cursor, (size_t)bytes);
 	cursor += bytes;
-	bytes = sizeof(float) * mesh->VerticesSize * 2;
-	memcpy(cursor, TexCoords, bytes);
-	
-	App->fs->Save(mesh->GetResourceFile(), data, size);
 
-	// --- Delete buffer data ---
-	if (data)
+	// --- Separate arrays of positions, normals, colors and texture coordinates ---
+	vertices.resize(ranges[2]);
+	uint count = vertices.size();
+
+	// --- Not aligned, the source name comes first ---
+	const char* Vertices = cursor;
+	const char* Normals = Vertices + sizeof(float) * 3 * count;
+	const char* Colors = Normals + sizeof(float) * 3 * count;
+	const char* TexCoords = Colors + sizeof(unsigned char) * 4 * count;
+
+	// --- Fill Vertex array ---
+	for (uint i = 0; i < count; ++i)
 	{
-		delete[] data;
-		data = nullptr;
-		cursor = nullptr;
+		memcpy(vertices[i].position, Vertices + sizeof(float) * 3 * i, sizeof(float) * 3);
+		memcpy(vertices[i].normal, Normals + sizeof(float) * 3 * i, sizeof(float) * 3);
+		memcpy(vertices[i].color, Colors + sizeof(unsigned char) * 4 * i, sizeof(unsigned char) * 4);
+		memcpy(vertices[i].texCoord, TexCoords + sizeof(float) * 2 * i, sizeof(float) * 2);
 	}
 
-	delete[] Vertices;
-	delete[] Normals;
-	delete[] Colors;
-	delete[] TexCoords;
+	return true;
 }
 
 Resource* ImporterMesh::Load(const char * path) const
 {
+	PROFILE_FUNCTION();
+
 	Resource* mesh = nullptr;
-	char* buffer = nullptr;
+	MappedFile mapped;
+
+	if (App->fs->Exists(path) && App->fs->MapFile(path, mapped))
+	{
+		// --- Only the original file's name is needed here ---
+		std::string source_file;
+		const MeshHeader* header = ReadHeader(mapped);
+
+		if (header)
+			source_file.assign(mapped.data + header->source_offset, header->source_length);
+		else if (mapped.size >= sizeof(uint) * 3 && *(const uint*)mapped.data <= mapped.size - sizeof(uint) * 3)
+			source_file.assign(mapped.data + sizeof(uint) * 3, *(const uint*)mapped.data);
+
+		App->fs->UnmapFile(mapped);
 
-	if (App->fs->Exists(path))
+		// --- Extract UID from path ---
+		std::string uid = path;
+		App->fs->SplitFilePath(path, nullptr, &uid);
+		uid = uid.substr(0, uid.find_last_of("."));
+
+		mesh = App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::MESH, std::string(source_file), std::stoi(uid));
+	}
+
+	return mesh;
+}
+
+bool ImporterMesh::LoadData(ResourceMesh* mesh) const
+{
+	PROFILE_FUNCTION();
+
+	MappedFile mapped;
+
+	if (!App->fs->MapFile(mesh->GetResourceFile(), mapped))
+		return false;
+
+	const MeshHeader* header = ReadHeader(mapped);
+
+	// --- Compressed, decoded into memory of the mesh's own, the mapping is not needed after ---
+	if (header && (header->flags & MESH_FLAG_COMPRESSED))
 	{
-		App->fs->Load(path, &buffer);
+		mesh->VerticesSize = header->vertex_count;
+		mesh->IndicesSize = header->index_count;
+		mesh->vertices = new Vertex[mesh->VerticesSize];
+		mesh->Indices = new uint[mesh->IndicesSize];
+		mesh->compressed = true;
+
+		const unsigned char* data = (const unsigned char*)mapped.data;
+		bool ret = MeshCodec::DecodeVertices(data + header->vertex_offset, header->index_offset - header->vertex_offset, mesh->vertices, mesh->VerticesSize, sizeof(Vertex))
+			&& MeshCodec::DecodeIndices(data + header->index_offset, header->submesh_offset - header->index_offset, mesh->Indices, mesh->IndicesSize);
 
-		if (buffer)
+		mesh->aabb = AABB(float3(header->aabb_min), float3(header->aabb_max));
+		mesh->sphere = Sphere(float3(header->sphere_center), header->sphere_radius);
+		App->fs->UnmapFile(mapped);
+
+		if (!ret)
 		{
-			// --- Read ranges first ---
-			char* cursor = buffer;
-			uint ranges[3];
-			uint bytes = sizeof(ranges);
-			memcpy(ranges, cursor, bytes);
-
-			// --- Read the original file's name ---
-			std::string source_file;
-			source_file.resize(ranges[0]);
-			cursor += bytes;
-			bytes = sizeof(char) * ranges[0];
-			memcpy((char*)source_file.c_str(), cursor, bytes);
-
-			// --- Extract UID from path ---
-			std::string uid = path;
-			App->fs->SplitFilePath(path, nullptr, &uid);
-			uid = uid.substr(0, uid.find_last_of("."));
-
-
-			mesh = App->resources->meshes.find(std::stoi(uid)) != App->resources->meshes.end() ? App->resources->meshes.find(std::stoi(uid))->second : App->resources->CreateResourceGivenUID(Resource::ResourceType::MESH, std::string(source_file), std::stoi(uid));
-
-			delete[] buffer;
-			buffer = nullptr;
-            cursor = nullptr;
+			CONSOLE_LOG("|[error]: Importer Mesh could not decode %s", mesh->GetResourceFile());
+			delete[] mesh->vertices;
+			delete[] mesh->Indices;
+			mesh->vertices = nullptr;
+			mesh->Indices = nullptr;
+			mesh->VerticesSize = mesh->IndicesSize = 0;
 		}
 
+		return ret;
 	}
 
-	return mesh;
+	// --- Current format, vertices and indices are used where they are in the file ---
+	if (header)
+	{
+		mesh->compressed = false;
+		mesh->VerticesSize = header->vertex_count;
+		mesh->IndicesSize = header->index_count;
+		mesh->vertices = (Vertex*)(mapped.data + header->vertex_offset);
+		mesh->Indices = (uint*)(mapped.data + header->index_offset);
+
+		mesh->aabb = AABB(float3(header->aabb_min), float3(header->aabb_max));
+		mesh->sphere = Sphere(float3(header->sphere_center), header->sphere_radius);
+		mesh->AttachMapping(mapped);
+
+		return true;
+	}
+
+	// --- Older format, read it and write it back in the current one ---
+	std::string source;
+	std::vector<Vertex> vertices;
+	std::vector<uint> indices;
+
+	bool ret = ReadLegacy(mapped, source, vertices, indices);
+	App->fs->UnmapFile(mapped);
+
+	if (!ret)
+	{
+		CONSOLE_LOG("|[error]: Importer Mesh could not read %s", mesh->GetResourceFile());
+		return false;
+	}
+
+	mesh->VerticesSize = vertices.size();
+	mesh->IndicesSize = indices.size();
+	mesh->vertices = new Vertex[mesh->VerticesSize];
+	mesh->Indices = new uint[mesh->IndicesSize];
+	memcpy(mesh->vertices, vertices.data(), sizeof(Vertex) * vertices.size());
+	memcpy(mesh->Indices, indices.data(), sizeof(uint) * indices.size());
+
+	Save(mesh);
+
+	return true;
 }
 
+bool ImporterMesh::SetCompression(ResourceMesh* mesh, bool compress) const
+{
+	if (mesh->compressed == compress)
+		return true;
+
+	// --- Meshes nobody uses are loaded just for this and freed after ---
+	bool loaded = mesh->vertices != nullptr;
+
+	if (!loaded && !LoadData(mesh))
+		return false;
+
+	uint64 time = 0;
+	uint64 before = 0;
+	uint64 after = 0;
+	App->fs->GetFileStat(mesh->GetResourceFile(), time, before);
+
+	mesh->compressed = compress;
+	Save(mesh);
+
+	App->fs->GetFileStat(mesh->GetResourceFile(), time, after);
+	CONSOLE_LOG("Mesh %s rewritten %s compression, %u to %u bytes", mesh->GetName(), compress ? "with" : "without", (uint)before, (uint)after);
+
+	if (!loaded)
+		mesh->FreeMemory();
+
+	return true;
+}
+
+bool ImporterMesh::ConvertFile(const char* file) const
+{
+	MappedFile mapped;
+
+	if (!App->fs->MapFile(file, mapped))
+		return false;
+
+	// --- Already current. Loads only hash the file in debug builds, this sweep is where release builds find damage ---
+	if (mapped.size >= sizeof(uint) && *(const uint*)mapped.data == MESH_FILE_MAGIC)
+	{
+		const MeshHeader* header = ReadHeader(mapped);
+
+		if (header && App->fs->Hash(mapped.data + sizeof(MeshHeader), header->data_size) != header->checksum)
+			CONSOLE_LOG("|[error]: Importer Mesh: %s is damaged, reimport its asset", file);
+
+		App->fs->UnmapFile(mapped);
+		return false;
+	}
+
+	std::string source;
+	std::vector<Vertex> vertices;
+	std::vector<uint> indices;
+
+	bool ret = ReadLegacy(mapped, source, vertices, indices);
+	App->fs->UnmapFile(mapped);
+
+	if (ret)
+		ret = Write(file, source.c_str(), vertices.data(), vertices.size(), indices.data(), indices.size(), false);
+	else
+		CONSOLE_LOG("|[error]: Importer Mesh could not convert %s", file);
+
+	return ret;
+}
+
+void ImporterMesh::ConvertLibrary() const
+{
+	std::vector<std::string> files;
+	std::vector<std::string> dirs;
+	App->fs->DiscoverFiles(MESHES_FOLDER, files, dirs);
+
+	conversions.clear();
+
+	for (uint i = 0; i < files.size(); ++i)
+		conversions.push_back(std::string(MESHES_FOLDER).append(files[i]));
+
+	if (conversions.empty())
+		return;
+
+	FrameScheduler::Get().Schedule("Convert Meshes", DeferredPriority::Low, [this](const DeferredSlice& slice)
+	{
+		uint converted = 0;
+
+		while (!conversions.empty() && !slice.OutOfTime())
+		{
+			converted += ConvertFile(conversions.back().c_str()) ? 1 : 0;
+			conversions.pop_back();
+		}
+
+		if (converted > 0)
+			CONSOLE_LOG("Converted %u meshes to mesh format v%u", converted, MESH_FILE_VERSION);
+
+		return conversions.empty();
+	}, true);
+}
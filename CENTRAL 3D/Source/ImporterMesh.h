@@ -2,17 +2,26 @@
 #define __IMPORTER_MESH_H__
 
 #include "Importer.h"
+#include <string>
+#include <vector>
+
+#define MESH_FILE_VERSION 2 // Library meshes of older versions are still read, and rewritten the first time they are
+#define MESH_BLOCK_ALIGNMENT 16 // Of every block inside a mesh file, they are handed to GL straight from the mapping
+#define MESH_FLAG_COMPRESSED 0x1 // Vertex and index blocks are MeshCodec streams, decoded on load instead of mapped
 
 struct aiMesh;
 class ResourceMesh;
 class Resource;
 class ResourceMesh;
+struct Vertex;
+struct MappedFile;
 
 struct ImportMeshData : public Importer::ImportData
 {
 	ImportMeshData(const char* path) : Importer::ImportData(path) {};
 
 	aiMesh* mesh = nullptr;
+	bool compress = false; // The model's CompressMeshes setting
 };
 
 class ImporterMesh : public Importer
@@ -27,7 +36,59 @@ public:
 	void Save(ResourceMesh* mesh) const;
     Resource* Load(const char* path) const override;
 
+	// --- Maps the mesh's library file, vertices and indices point into it. No GPU work ---
+	bool LoadData(ResourceMesh* mesh) const;
+
+	// --- Rewrites the mesh's library file with or without the codec, loading its data if needed ---
+	bool SetCompression(ResourceMesh* mesh, bool compress) const;
+
+	// --- Rewrites library meshes of older versions, a few per frame ---
+	bool ConvertFile(const char* file) const;
+	void ConvertLibrary() const;
+
 	static inline Importer::ImporterType GetType() { return Importer::ImporterType::Mesh; };
+
+private:
+
+	// --- As laid out in the file. Offsets are from its start, the checksum covers everything past the header ---
+	struct MeshHeader
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 header_size;
+		uint32 flags;
+		uint32 vertex_count;
+		uint32 vertex_stride;
+		uint32 index_count;
+		uint32 index_stride;
+		uint32 submesh_count;
+		uint32 source_length;
+		uint64 vertex_offset;
+		uint64 index_offset;
+		uint64 submesh_offset;
+		uint64 source_offset;
+		uint64 data_size;
+		uint64 checksum;
+		float aabb_min[3];
+		float aabb_max[3];
+		float sphere_center[3];
+		float sphere_radius;
+	};
+
+	// --- Ranges of the index block drawn with one material. Written empty, one mesh per aiMesh is imported today ---
+	struct MeshSubmesh
+	{
+		uint32 index_offset;
+		uint32 index_count;
+		uint32 base_vertex;
+		uint32 material;
+	};
+
+	bool Write(const char* file, const char* source, const Vertex* vertices, uint vertex_count, const uint* indices, uint index_count, bool compress) const;
+	const MeshHeader* ReadHeader(const MappedFile& mapped) const;
+	bool ReadLegacy(const MappedFile& mapped, std::string& source, std::vector<Vertex>& vertices, std::vector<uint>& indices) const;
+
+	mutable std::vector<std::string> conversions; // Library files left to check
 };
 
 #endif
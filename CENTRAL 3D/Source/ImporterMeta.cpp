@@ -5,6 +5,7 @@
 
 #include "ResourceMeta.h"
 #include "JSONLoader.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -24,8 +25,33 @@ Resource* ImporterMeta::Import(ImportData& IData) const
 
 Resource* ImporterMeta::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceMeta* resource = nullptr;
 
+	// --- Straight from the asset database while the meta is the one it was built from ---
+	AssetRecord record;
+
+	if (App->resources->GetAssetDatabase().Find(path, record))
+	{
+		resource = (ResourceMeta*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::META, record.source.c_str(), record.UID);
+
+		if (resource)
+		{
+			resource->Date = record.Date;
+			resource->fileFormatVersion = record.fileFormatVersion;
+
+			if (!record.ResourceData.is_null())
+				resource->ResourceData = record.ResourceData;
+
+			// --- A folder has been renamed ---
+			if (!App->fs->Exists(record.source.c_str()))
+				resource->SetOriginalFile(path);
+		}
+
+		return resource;
+	}
+
 	std::string meta = path;
 	meta.append(".meta");
 
@@ -57,7 +83,7 @@ Resource* ImporterMeta::Load(const char* path) const
 		UID = std::stoi(UID_node.get<std::string>());
 
 	// Date is retrieved on resource meta constructor
-	resource = App->resources->metas.find(UID) != App->resources->metas.end() ? App->resources->metas.find(UID)->second : (ResourceMeta*)App->resources->CreateResourceGivenUID(Resource::ResourceType::META, (source_file.get<std::string>()).c_str(), UID);
+	resource = (ResourceMeta*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::META, (source_file.get<std::string>()).c_str(), UID);
 
 	// --- Fill meta ---
 	if (resource)
@@ -76,11 +102,15 @@ Resource* ImporterMeta::Load(const char* path) const
 	if (!App->fs->Exists(source_file.get<std::string>().c_str()))
 		resource->SetOriginalFile(path);
 
+	App->resources->GetAssetDatabase().Store(resource);
+
 	return resource;
 }
 
 void ImporterMeta::Save(ResourceMeta* meta) const
 {
+	PROFILE_FUNCTION();
+
 	json jsonmeta;
 	std::string jsondata;
 	char* meta_buffer = nullptr;
@@ -95,5 +125,15 @@ void ImporterMeta::Save(ResourceMeta* meta) const
 	App->GetJLoader()->Serialize(jsonmeta, jsondata);
 	meta_buffer = (char*)jsondata.c_str();
 
+	App->GetJLoader()->DropPrefetched(meta->GetResourceFile());
 	App->fs->Save(meta->GetResourceFile(), meta_buffer, jsondata.length());
+
+	meta->fileFormatVersion = App->resources->fileFormatVersion;
+	App->resources->GetAssetDatabase().Store(meta, meta_buffer, jsondata.length());
+
+	// --- Import settings changed, whatever was built from the asset is stale ---
+	std::string settings = meta->ResourceData.dump();
+
+	if (App->resources->GetDependencyGraph().SetSettingsHash(meta->GetUID(), App->fs->Hash(settings.data(), settings.size())))
+		App->resources->ReimportDependents(std::vector<uint>(1, meta->GetUID()), "Import settings changed");
 }
@@ -22,9 +22,13 @@
 #include "ResourceModel.h"
 #include "ResourceMeta.h"
 #include "ResourceMaterial.h"
+#include "Profiler.h"
+#include "FrameScheduler.h"
 
 #include "mmgr/mmgr.h"
 
+std::mutex ImporterModel::assimp_mutex;
+
 
 ImporterModel::ImporterModel() : Importer(Importer::ImporterType::Model)
 {
@@ -32,18 +36,23 @@ ImporterModel::ImporterModel() : Importer(Importer::ImporterType::Model)
 
 ImporterModel::~ImporterModel()
 {
+	ReleasePrefetchedScenes();
 }
 
 // --- Import external file ---
 Resource* ImporterModel::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	ImportModelData MData = (ImportModelData&)IData;
 	ResourceModel* model = nullptr;
 	const aiScene* scene = nullptr;
 
-	// --- Import scene from path ---
-	if (App->fs->Exists(MData.path))
-		scene = aiImportFile(MData.path, aiProcessPreset_TargetRealtime_MaxQuality);
+	// --- Import scene from path, unless the startup scan already did ---
+	scene = TakePrefetchedScene(MData.path);
+
+	if (scene == nullptr && App->fs->Exists(MData.path))
+		scene = ImportScene(MData.path);
 
 	GameObject* rootnode = nullptr;
 
@@ -69,7 +78,7 @@ Resource* ImporterModel::Import(ImportData& IData) const
 
 		// --- Load all meshes ---
 		std::map<uint, ResourceMesh*> model_meshes;
-		LoadSceneMeshes(scene, model_meshes, MData.path);
+		LoadSceneMeshes(scene, model_meshes, MData.path, model->GetCompressMeshes());
 
 		// --- Load all materials ---
 		std::map<uint, ResourceMaterial*> model_mats;
@@ -101,7 +110,7 @@ Resource* ImporterModel::Import(ImportData& IData) const
 		App->scene_manager->DestroyGameObject(rootnode);
 
 		// --- Free scene ---
-		aiReleaseImport(scene);
+		ReleaseScene(scene);
 
 		// --- Create meta ---
 		if (MData.model_overwrite == nullptr)
@@ -120,7 +129,66 @@ Resource* ImporterModel::Import(ImportData& IData) const
 	return model;
 }
 
-void ImporterModel::LoadSceneMeshes(const aiScene* scene, std::map<uint, ResourceMesh*>& scene_meshes, const char* source_file) const
+const aiScene* ImporterModel::ImportScene(const char* path)
+{
+	std::lock_guard<std::mutex> lock(assimp_mutex);
+	return aiImportFile(path, aiProcessPreset_TargetRealtime_MaxQuality);
+}
+
+void ImporterModel::ReleaseScene(const aiScene* scene)
+{
+	std::lock_guard<std::mutex> lock(assimp_mutex);
+	aiReleaseImport(scene);
+}
+
+void ImporterModel::PrefetchScene(const char* path) const
+{
+	PROFILE_FUNCTION();
+
+	const aiScene* scene = ImportScene(path);
+
+	if (scene == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(scenes_mutex);
+
+	std::map<std::string, const aiScene*>::iterator it = prefetched_scenes.find(path);
+
+	if (it != prefetched_scenes.end())
+	{
+		ReleaseScene(it->second);
+		it->second = scene;
+	}
+	else
+		prefetched_scenes[path] = scene;
+}
+
+void ImporterModel::ReleasePrefetchedScenes() const
+{
+	std::lock_guard<std::mutex> lock(scenes_mutex);
+
+	for (std::map<std::string, const aiScene*>::iterator it = prefetched_scenes.begin(); it != prefetched_scenes.end(); ++it)
+		ReleaseScene(it->second);
+
+	prefetched_scenes.clear();
+}
+
+const aiScene* ImporterModel::TakePrefetchedScene(const char* path) const
+{
+	std::lock_guard<std::mutex> lock(scenes_mutex);
+
+	std::map<std::string, const aiScene*>::iterator it = prefetched_scenes.find(path);
+
+	if (it == prefetched_scenes.end())
+		return nullptr;
+
+	const aiScene* scene = it->second;
+	prefetched_scenes.erase(it);
+
+	return scene;
+}
+
+void ImporterModel::LoadSceneMeshes(const aiScene* scene, std::map<uint, ResourceMesh*>& scene_meshes, const char* source_file, bool compress) const
 {
 	ImporterMesh* IMesh = App->resources->GetImporter<ImporterMesh>();
 
@@ -128,6 +196,7 @@ void ImporterModel::LoadSceneMeshes(const aiScene* scene, std::map<uint, Resourc
 	{
 		ImportMeshData MData(source_file);
 		MData.mesh = scene->mMeshes[i];
+		MData.compress = compress;
 
 		// --- Else, Import mesh data (fill new_mesh) ---
 		if (IMesh)
@@ -135,28 +204,47 @@ void ImporterModel::LoadSceneMeshes(const aiScene* scene, std::map<uint, Resourc
 			scene_meshes[i] = (ResourceMesh*)IMesh->Import(MData);
 			scene_meshes[i]->SetName(scene->mMeshes[i]->mName.C_Str());
 
-			// --- Create preview Texture ---
-
-			std::vector<GameObject*> gos;
-			gos.push_back(App->scene_manager->CreateEmptyGameObject());
-
-			// --- Create new Component Mesh to store current scene mesh data ---
-			ComponentMesh* new_mesh = (ComponentMesh*)gos[0]->AddComponent(Component::ComponentType::Mesh);
-			ComponentMeshRenderer* Renderer = (ComponentMeshRenderer*)gos[0]->AddComponent(Component::ComponentType::MeshRenderer);
-
-			// --- Assign previously loaded mesh ---
-			new_mesh->resource_mesh = scene_meshes[i];
-
+			// --- Reloaded from the library with its buffers, the model's own preview draws it ---
 			scene_meshes[i]->FreeMemory();
 			scene_meshes[i]->LoadInMemory();
-			scene_meshes[i]->SetPreviewTexID(App->renderer3D->RenderSceneToTexture(gos, scene_meshes[i]->previewTexPath));
 
-			App->scene_manager->DestroyGameObject(gos[0]);
+			// --- Create preview Texture, as deferred work. Its path is decided now so the model file can point to it ---
+			uint mesh_uid = scene_meshes[i]->GetUID();
+			uint preview_uid = App->GetRandom().Int();
+			App->textures->GetLibraryPath(preview_uid, scene_meshes[i]->previewTexPath);
+
+			FrameScheduler::Get().Schedule("Mesh Preview", DeferredPriority::Low, [mesh_uid, preview_uid](const DeferredSlice& slice) { RenderMeshPreview(mesh_uid, preview_uid); return true; });
 		}
 
 	}
 }
 
+void ImporterModel::RenderMeshPreview(uint mesh_uid, uint preview_uid)
+{
+	// --- The mesh may have been deleted or reimported since it was scheduled ---
+	ResourceMesh* mesh = (ResourceMesh*)App->resources->GetResource(mesh_uid, false);
+
+	if (mesh == nullptr || mesh->GetType() != Resource::ResourceType::MESH)
+		return;
+
+	std::vector<GameObject*> gos;
+	gos.push_back(App->scene_manager->CreateEmptyGameObject());
+
+	// --- Create new Component Mesh to store current scene mesh data ---
+	ComponentMesh* new_mesh = (ComponentMesh*)gos[0]->AddComponent(Component::ComponentType::Mesh);
+	ComponentMeshRenderer* Renderer = (ComponentMeshRenderer*)gos[0]->AddComponent(Component::ComponentType::MeshRenderer);
+
+	// --- Assign the mesh, loaded for as long as the preview takes ---
+	mesh->LoadToMemory();
+	new_mesh->resource_mesh = mesh;
+
+	mesh->SetPreviewTexID(App->renderer3D->RenderSceneToTexture(gos, mesh->previewTexPath, preview_uid));
+
+	new_mesh->resource_mesh = nullptr;
+	App->scene_manager->DestroyGameObject(gos[0]);
+	mesh->Release();
+}
+
 void ImporterModel::FreeSceneMeshes(std::map<uint, ResourceMesh*>* scene_meshes) const
 {
 	for (std::map<uint, ResourceMesh*>::iterator it = scene_meshes->begin(); it != scene_meshes->end();)
@@ -287,12 +375,14 @@ void ImporterModel::LoadNodes(const aiNode* node, GameObject* parent, const aiSc
 // --- Load file from library ---
 Resource* ImporterModel::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceModel* resource = nullptr;
 
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(path);
 
-	resource = App->resources->models.find(meta->GetUID()) != App->resources->models.end() ? App->resources->models.find(meta->GetUID())->second : (ResourceModel*)App->resources->CreateResourceGivenUID(Resource::ResourceType::MODEL, meta->GetOriginalFile(), meta->GetUID());
+	resource = (ResourceModel*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::MODEL, meta->GetOriginalFile(), meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(resource->GetOriginalFile()))
@@ -381,6 +471,14 @@ Resource* ImporterModel::Load(const char* path) const
 			}
 
 		}
+
+		// --- Models imported before dependencies were recorded get theirs here ---
+		std::vector<uint> dependencies;
+
+		for (uint i = 0; i < resource->GetResources()->size(); ++i)
+			dependencies.push_back((*resource->GetResources())[i]->GetUID());
+
+		App->resources->GetDependencyGraph().SetDependencies(resource->GetUID(), dependencies);
 	}
 
 	return resource;
@@ -425,7 +523,11 @@ GameObject* ImporterModel::InstanceOnCurrentScene(const char* model_path, Resour
 				}
 
 				if (!file[it.key()]["Model"].is_null())
-					go->model = (ResourceModel*)App->resources->ImportAssets(ImportData(file[it.key()]["Model"].get<std::string>().c_str()));
+				{
+					std::string model_path = file[it.key()]["Model"].get<std::string>();
+					ImportData IData(model_path.c_str());
+					go->model = (ResourceModel*)App->resources->ImportAssets(IData);
+				}
 
 				// --- Retrieve GO's name ---
 				std::string name = file[it.key()]["Name"];
@@ -497,8 +599,10 @@ GameObject* ImporterModel::InstanceOnCurrentScene(const char* model_path, Resour
 	return parent;
 }
 
-void ImporterModel::Save(ResourceModel* model, std::vector<GameObject*>& model_gos, std::string& model_name) const
+void ImporterModel::Save(ResourceModel* model, std::vector<GameObject*>& model_gos, const std::string& model_name) const
 {
+	PROFILE_FUNCTION();
+
 	// --- Save Model to file ---
 
 	json file;
@@ -507,24 +611,25 @@ void ImporterModel::Save(ResourceModel* model, std::vector<GameObject*>& model_g
 
 	for (int i = 0; i < model_gos.size(); ++i)
 	{
-		// --- Create GO Structure ---
-		file[std::to_string(model_gos[i]->GetUID())];
-		file[std::to_string(model_gos[i]->GetUID())]["Name"] = model_gos[i]->GetName();
-		file[std::to_string(model_gos[i]->GetUID())]["Parent"] = std::to_string(model_gos[i]->parent->GetUID());
-		file[std::to_string(model_gos[i]->GetUID())]["Components"];
-		file[std::to_string(model_gos[i]->GetUID())]["PrefabChild"] = model_gos[i]->is_prefab_child;
-		file[std::to_string(model_gos[i]->GetUID())]["PrefabInstance"] = model_gos[i]->is_prefab_instance;
+		// --- Create GO Structure, keys are built once per object ---
+		json& node = file[std::to_string(model_gos[i]->GetUID())];
+		node["Name"] = model_gos[i]->GetName();
+		node["Parent"] = std::to_string(model_gos[i]->parent->GetUID());
+		node["Components"];
+		node["PrefabChild"] = model_gos[i]->is_prefab_child;
+		node["PrefabInstance"] = model_gos[i]->is_prefab_instance;
 
 		if(model_gos[i]->model)
-			file[std::to_string(model_gos[i]->GetUID())]["Model"] = std::string(model_gos[i]->model->GetOriginalFile());
+			node["Model"] = model_gos[i]->model->GetOriginalFile();
 
-		std::vector<Component*> go_components = model_gos[i]->GetComponents();
+		const std::vector<Component*>& go_components = model_gos[i]->GetComponents();
 
 		for (int j = 0; j < go_components.size(); ++j)
 		{
 			// --- Save Components to file ---
-			file[std::to_string(model_gos[i]->GetUID())]["Components"][std::to_string(go_components[j]->GetUID())] = go_components[j]->Save();
-			file[std::to_string(model_gos[i]->GetUID())]["Components"][std::to_string(go_components[j]->GetUID())]["Type"] = (uint)go_components[j]->GetType();
+			json& component = node["Components"][std::to_string(go_components[j]->GetUID())];
+			component = go_components[j]->Save();
+			component["Type"] = (uint)go_components[j]->GetType();
 		}
 
 	}
@@ -538,6 +643,14 @@ void ImporterModel::Save(ResourceModel* model, std::vector<GameObject*>& model_g
 	uint size = data.length();
 
 	App->fs->Save(model->GetResourceFile(), buffer, size);
+
+	// --- Meshes and materials its objects use ---
+	std::vector<uint> dependencies;
+
+	for (uint i = 0; i < model_gos.size(); ++i)
+		model_gos[i]->GatherDependencies(dependencies);
+
+	App->resources->GetDependencyGraph().SetDependencies(model->GetUID(), dependencies);
 }
 
 
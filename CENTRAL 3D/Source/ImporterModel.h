@@ -3,6 +3,7 @@
 
 #include "Importer.h"
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -34,16 +35,33 @@ public:
 
 	GameObject* InstanceOnCurrentScene(const char* model_path, ResourceModel* model) const;
 
-	void Save(ResourceModel* model,std::vector<GameObject*>& model_gos, std::string& model_name) const;
+	void Save(ResourceModel* model,std::vector<GameObject*>& model_gos, const std::string& model_name) const;
+
+	// --- Any thread. The startup scan decodes new models ahead of time, Import takes the scene instead of reading the file again ---
+	void PrefetchScene(const char* path) const;
+	void ReleasePrefetchedScenes() const; // Those no import took
+
+	// --- The bundled Assimp is built with ASSIMP_BUILD_SINGLETHREADED and its C API keeps global state (last error, log
+	// streams), every import and release in the engine goes through these, one at a time ---
+	static const aiScene* ImportScene(const char* path);
+	static void ReleaseScene(const aiScene* scene);
 
 	static inline Importer::ImporterType GetType() { return Importer::ImporterType::Model; };
 
 private:
 	void LoadNodes(const aiNode* node, GameObject* parent, const aiScene* scene, std::vector<GameObject*>& scene_gos, const char* path, std::map<uint, ResourceMesh*>& scene_meshes, std::map<uint, ResourceMaterial*>& scene_mats) const;
-	void LoadSceneMeshes(const aiScene* scene, std::map<uint, ResourceMesh*>& scene_meshes, const char* source_file) const;
+	void LoadSceneMeshes(const aiScene* scene, std::map<uint, ResourceMesh*>& scene_meshes, const char* source_file, bool compress) const;
 	void FreeSceneMeshes(std::map<uint, ResourceMesh*>* scene_meshes) const;
+	static void RenderMeshPreview(uint mesh_uid, uint preview_uid);
 	void LoadSceneMaterials(const aiScene* scene, std::map<uint, ResourceMaterial*>& scene_mats, const char* source_file, bool library_deleted) const;
 	void FreeSceneMaterials(std::map<uint, ResourceMaterial*>* scene_mats) const;
+	const aiScene* TakePrefetchedScene(const char* path) const;
+
+private:
+
+	static std::mutex assimp_mutex;
+	mutable std::mutex scenes_mutex;
+	mutable std::map<std::string, const aiScene*> prefetched_scenes;
 };
 
 #endif
@@ -11,6 +11,7 @@
 #include "ResourceModel.h"
 
 #include "GameObject.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -30,12 +31,14 @@ Resource* ImporterPrefab::Import(ImportData& IData) const
 
 Resource* ImporterPrefab::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourcePrefab* prefab = nullptr;
 
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(path);
 
-	prefab = App->resources->prefabs.find(meta->GetUID()) != App->resources->prefabs.end() ? (ResourcePrefab*)App->resources->GetResource(meta->GetUID()) : (ResourcePrefab*)App->resources->CreateResourceGivenUID(Resource::ResourceType::PREFAB, path, meta->GetUID());
+	prefab = App->resources->FindResource(meta->GetUID(), Resource::ResourceType::PREFAB) ? (ResourcePrefab*)App->resources->GetResource(meta->GetUID()) : (ResourcePrefab*)App->resources->CreateResourceGivenUID(Resource::ResourceType::PREFAB, path, meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(prefab->GetOriginalFile()))
@@ -68,6 +71,8 @@ Resource* ImporterPrefab::Load(const char* path) const
 
 void ImporterPrefab::Save(ResourcePrefab* prefab) const
 {
+	PROFILE_FUNCTION();
+
 	if (prefab && prefab->parentgo)
 	{
 		// --- Get all game objects inside parent ---
@@ -91,24 +96,25 @@ void ImporterPrefab::Save(ResourcePrefab* prefab) const
 
 		for (int i = 0; i < prefab_gos.size(); ++i)
 		{
-			// --- Create GO Structure ---
-			file[std::to_string(prefab_gos[i]->GetUID())];
-			file[std::to_string(prefab_gos[i]->GetUID())]["Name"] = prefab_gos[i]->GetName();
-			file[std::to_string(prefab_gos[i]->GetUID())]["Parent"] = std::to_string(prefab_gos[i]->parent->GetUID());
-			file[std::to_string(prefab_gos[i]->GetUID())]["Components"];
-			file[std::to_string(prefab_gos[i]->GetUID())]["PrefabChild"] = prefab_gos[i]->is_prefab_child;
-			file[std::to_string(prefab_gos[i]->GetUID())]["PrefabInstance"] = prefab_gos[i]->is_prefab_instance;
+			// --- Create GO Structure, keys are built once per object ---
+			json& node = file[std::to_string(prefab_gos[i]->GetUID())];
+			node["Name"] = prefab_gos[i]->GetName();
+			node["Parent"] = std::to_string(prefab_gos[i]->parent->GetUID());
+			node["Components"];
+			node["PrefabChild"] = prefab_gos[i]->is_prefab_child;
+			node["PrefabInstance"] = prefab_gos[i]->is_prefab_instance;
 
 			if (prefab_gos[i]->model)
-				file[std::to_string(prefab_gos[i]->GetUID())]["Model"] = std::string(prefab_gos[i]->model->GetOriginalFile());
+				node["Model"] = prefab_gos[i]->model->GetOriginalFile();
 
-			std::vector<Component*> go_components = prefab_gos[i]->GetComponents();
+			const std::vector<Component*>& go_components = prefab_gos[i]->GetComponents();
 
 			for (int j = 0; j < go_components.size(); ++j)
 			{
 				// --- Save Components to file ---
-				file[std::to_string(prefab_gos[i]->GetUID())]["Components"][std::to_string(go_components[j]->GetUID())] = go_components[j]->Save();
-				file[std::to_string(prefab_gos[i]->GetUID())]["Components"][std::to_string(go_components[j]->GetUID())]["Type"] = (uint)go_components[j]->GetType();
+				json& component = node["Components"][std::to_string(go_components[j]->GetUID())];
+				component = go_components[j]->Save();
+				component["Type"] = (uint)go_components[j]->GetType();
 			}
 
 		}
@@ -127,5 +133,13 @@ void ImporterPrefab::Save(ResourcePrefab* prefab) const
 		uint size = data.length();
 
 		App->fs->Save(prefab->GetResourceFile(), buffer, size);
+
+		// --- Models, meshes and materials its objects use ---
+		std::vector<uint> dependencies;
+
+		for (uint i = 0; i < prefab_gos.size(); ++i)
+			prefab_gos[i]->GatherDependencies(dependencies);
+
+		App->resources->GetDependencyGraph().SetDependencies(prefab->GetUID(), dependencies);
 	}
 }
@@ -8,6 +8,7 @@
 #include "GameObject.h"
 #include "ImporterMeta.h"
 #include "ResourceMeta.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -33,6 +34,8 @@ Resource* ImporterScene::Import(ImportData& IData) const
 
 Resource* ImporterScene::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceScene* scene = nullptr;
 
 	// --- Load Scene file ---
@@ -43,7 +46,7 @@ Resource* ImporterScene::Load(const char* path) const
 
 		if (meta)
 		{
-			scene = App->resources->scenes.find(meta->GetUID()) != App->resources->scenes.end() ? App->resources->scenes.find(meta->GetUID())->second : (ResourceScene*)App->resources->CreateResourceGivenUID(Resource::ResourceType::SCENE, meta->GetOriginalFile(), meta->GetUID());
+			scene = (ResourceScene*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::SCENE, meta->GetOriginalFile(), meta->GetUID());
 		}
 		else
 		{
@@ -58,72 +61,73 @@ Resource* ImporterScene::Load(const char* path) const
 
 void ImporterScene::SaveSceneToFile(ResourceScene* scene) const
 {
+	PROFILE_FUNCTION();
+
 	// --- Save Scene/Model to file ---
 
 	json file;
 
 	for (std::unordered_map<uint, GameObject*>::iterator it = scene->NoStaticGameObjects.begin(); it != scene->NoStaticGameObjects.end(); ++it)
 	{
-		std::string string_uid = std::to_string((*it).second->GetUID());
-		// --- Create GO Structure ---
-		file[string_uid];
-		file[string_uid]["Name"] = (*it).second->GetName();
-		file[string_uid]["Active"] = (*it).second->GetActive();
-		file[string_uid]["Static"] = (*it).second->Static;
-		file[string_uid]["Index"] = (*it).second->index;
-		file[string_uid]["PrefabChild"] = (*it).second->is_prefab_child;
-		file[string_uid]["PrefabInstance"] = (*it).second->is_prefab_instance;
+		// --- Create GO Structure, keys are built once per object ---
+		json& node = file[std::to_string((*it).second->GetUID())];
+		node["Name"] = (*it).second->GetName();
+		node["Active"] = (*it).second->GetActive();
+		node["Static"] = (*it).second->Static;
+		node["Index"] = (*it).second->index;
+		node["PrefabChild"] = (*it).second->is_prefab_child;
+		node["PrefabInstance"] = (*it).second->is_prefab_instance;
 
 		if ((*it).second->parent != App->scene_manager->GetRootGO())
-			file[string_uid]["Parent"] = std::to_string((*it).second->parent->GetUID());
+			node["Parent"] = std::to_string((*it).second->parent->GetUID());
 		else
-			file[string_uid]["Parent"] = "-1";
+			node["Parent"] = "-1";
 
-		file[string_uid]["Components"];
+		node["Components"];
 
-		std::vector<Component*> go_components = (*it).second->GetComponents();
+		const std::vector<Component*>& go_components = (*it).second->GetComponents();
 
 		for (uint i = 0; i < go_components.size(); ++i)
 		{
 			// --- Save Components to file ---
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())] = go_components[i]->Save();
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Index"] = i;
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Type"] = (uint)go_components[i]->GetType();
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Active"] = go_components[i]->GetActive();
+			json& component = node["Components"][std::to_string(go_components[i]->GetUID())];
+			component = go_components[i]->Save();
+			component["Index"] = i;
+			component["Type"] = (uint)go_components[i]->GetType();
+			component["Active"] = go_components[i]->GetActive();
 		}
 	}
 
 	for (std::unordered_map<uint, GameObject*>::iterator it = scene->StaticGameObjects.begin(); it != scene->StaticGameObjects.end(); ++it)
 	{
-		std::string string_uid = std::to_string((*it).second->GetUID());
-
-		// --- Create GO Structure ---
-		file[string_uid];
-		file[string_uid]["Name"] = (*it).second->GetName();
-		file[string_uid]["Active"] = (*it).second->GetActive();
-		file[string_uid]["Static"] = (*it).second->Static;
-		file[string_uid]["Parent"] = std::to_string((*it).second->parent->GetUID());
-		file[string_uid]["Index"] = (*it).second->index;
-		file[string_uid]["PrefabChild"] = (*it).second->is_prefab_child;
-		file[string_uid]["PrefabInstance"] = (*it).second->is_prefab_instance;
+		// --- Create GO Structure, keys are built once per object ---
+		json& node = file[std::to_string((*it).second->GetUID())];
+		node["Name"] = (*it).second->GetName();
+		node["Active"] = (*it).second->GetActive();
+		node["Static"] = (*it).second->Static;
+		node["Parent"] = std::to_string((*it).second->parent->GetUID());
+		node["Index"] = (*it).second->index;
+		node["PrefabChild"] = (*it).second->is_prefab_child;
+		node["PrefabInstance"] = (*it).second->is_prefab_instance;
 
 		if ((*it).second->parent != App->scene_manager->GetRootGO())
-			file[string_uid]["Parent"] = std::to_string((*it).second->parent->GetUID());
+			node["Parent"] = std::to_string((*it).second->parent->GetUID());
 		else
-			file[string_uid]["Parent"] = "-1";
+			node["Parent"] = "-1";
 
 
-		file[string_uid]["Components"];
+		node["Components"];
 
-		std::vector<Component*> go_components = (*it).second->GetComponents();
+		const std::vector<Component*>& go_components = (*it).second->GetComponents();
 
 		for (uint i = 0; i < go_components.size(); ++i)
 		{
 			// --- Save Components to file ---
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())] = go_components[i]->Save();
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Index"] = i;
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Type"] = (uint)go_components[i]->GetType();
-			file[string_uid]["Components"][std::to_string(go_components[i]->GetUID())]["Active"] = go_components[i]->GetActive();
+			json& component = node["Components"][std::to_string(go_components[i]->GetUID())];
+			component = go_components[i]->Save();
+			component["Index"] = i;
+			component["Type"] = (uint)go_components[i]->GetType();
+			component["Active"] = go_components[i]->GetActive();
 		}
 	}
 
@@ -138,6 +142,17 @@ void ImporterScene::SaveSceneToFile(ResourceScene* scene) const
 	App->fs->Save(scene->GetResourceFile(), buffer, size);
 	scene->SetOriginalFile(scene->GetResourceFile());
 
+	// --- Models, prefabs' objects, meshes and materials in the scene ---
+	std::vector<uint> dependencies;
+
+	for (std::unordered_map<uint, GameObject*>::iterator it = scene->NoStaticGameObjects.begin(); it != scene->NoStaticGameObjects.end(); ++it)
+		(*it).second->GatherDependencies(dependencies);
+
+	for (std::unordered_map<uint, GameObject*>::iterator it = scene->StaticGameObjects.begin(); it != scene->StaticGameObjects.end(); ++it)
+		(*it).second->GatherDependencies(dependencies);
+
+	App->resources->GetDependencyGraph().SetDependencies(scene->GetUID(), dependencies);
+
 	// --- Create meta ---
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)App->resources->CreateResourceGivenUID(Resource::ResourceType::META, scene->GetResourceFile(), scene->GetUID());
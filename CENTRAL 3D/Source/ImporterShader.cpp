@@ -11,6 +11,7 @@
 #include "ResourceShader.h"
 
 #include "OpenGL.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -24,6 +25,8 @@ ImporterShader::~ImporterShader()
 
 Resource* ImporterShader::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	if (!App->fs->Exists(IData.path))
 		return nullptr;
 
@@ -46,12 +49,14 @@ Resource* ImporterShader::Import(ImportData& IData) const
 
 Resource* ImporterShader::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceShader* shader = nullptr;
 
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(path);
 
-	shader = App->resources->shaders.find(meta->GetUID()) != App->resources->shaders.end() ? App->resources->shaders.find(meta->GetUID())->second : (ResourceShader*)App->resources->CreateResourceGivenUID(Resource::ResourceType::SHADER, path, meta->GetUID());
+	shader = (ResourceShader*)App->resources->GetOrCreateResourceGivenUID(Resource::ResourceType::SHADER, path, meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(shader->GetOriginalFile()))
@@ -67,6 +72,8 @@ Resource* ImporterShader::Load(const char* path) const
 
 void ImporterShader::Save(ResourceShader* shader) const
 {
+	PROFILE_FUNCTION();
+
 	GLint buffer_size;
 	glGetProgramiv(shader->ID, GL_PROGRAM_BINARY_LENGTH, &buffer_size);
 
@@ -7,6 +7,7 @@
 #include "ImporterMeta.h"
 #include "ResourceMeta.h"
 #include "ResourceTexture.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -20,6 +21,8 @@ ImporterTexture::~ImporterTexture()
 
 Resource* ImporterTexture::Import(ImportData& IData) const
 {
+	PROFILE_FUNCTION();
+
 	if (!App->fs->Exists(IData.path))
 		return nullptr;
 
@@ -41,12 +44,14 @@ Resource* ImporterTexture::Import(ImportData& IData) const
 
 Resource* ImporterTexture::Load(const char* path) const
 {
+	PROFILE_FUNCTION();
+
 	ResourceTexture* texture = nullptr;
 
 	ImporterMeta* IMeta = App->resources->GetImporter<ImporterMeta>();
 	ResourceMeta* meta = (ResourceMeta*)IMeta->Load(path);
 
-	texture = App->resources->textures.find(meta->GetUID()) != App->resources->textures.end() ? (ResourceTexture*)App->resources->GetResource(meta->GetUID()) : (ResourceTexture*)App->resources->CreateResourceGivenUID(Resource::ResourceType::TEXTURE, path, meta->GetUID());
+	texture = App->resources->FindResource(meta->GetUID(), Resource::ResourceType::TEXTURE) ? (ResourceTexture*)App->resources->GetResource(meta->GetUID()) : (ResourceTexture*)App->resources->CreateResourceGivenUID(Resource::ResourceType::TEXTURE, path, meta->GetUID());
 
 	// --- A folder has been renamed ---
 	if (!App->fs->Exists(texture->GetOriginalFile()))
@@ -61,5 +66,7 @@ Resource* ImporterTexture::Load(const char* path) const
 
 void ImporterTexture::Save(ResourceTexture* texture) const
 {
+	PROFILE_FUNCTION();
+
 	// Nothing to save ? (being saved by ModuleTextures)
 }
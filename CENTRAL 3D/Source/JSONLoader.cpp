@@ -15,6 +15,23 @@ json JSONLoader::Load(const char * File) const
 	// --- Create JSON object ---
 	json jsonfile;
 
+	if (File != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(prefetch_mutex);
+
+		if (!prefetched.empty())
+		{
+			std::unordered_map<std::string, json>::iterator it = prefetched.find(File);
+
+			if (it != prefetched.end())
+			{
+				jsonfile.swap(it->second);
+				prefetched.erase(it);
+				return jsonfile;
+			}
+		}
+	}
+
 	if (File == nullptr)
 	{
 		ret = false;
@@ -62,6 +79,8 @@ bool JSONLoader::Save(const char * File, json jsonfile)
 
 	bool ret = true;
 
+	DropPrefetched(File);
+
 	std::ofstream file;
 	file.open(File);
 
@@ -83,3 +102,21 @@ void JSONLoader::Serialize(const json& jsonfile, std::string& jsonserialized)
 {
 	jsonserialized = jsonfile.dump(4);
 }
+
+void JSONLoader::Prefetch(const char* File, json& jsonfile)
+{
+	std::lock_guard<std::mutex> lock(prefetch_mutex);
+	prefetched[File].swap(jsonfile);
+}
+
+void JSONLoader::DropPrefetched(const char* File)
+{
+	std::lock_guard<std::mutex> lock(prefetch_mutex);
+	prefetched.erase(File);
+}
+
+void JSONLoader::ClearPrefetched()
+{
+	std::lock_guard<std::mutex> lock(prefetch_mutex);
+	prefetched.clear();
+}
@@ -3,6 +3,9 @@
 
 #include "Globals.h"
 #include "json/json.hpp"
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 // for convenience
 using json = nlohmann::json;
@@ -19,6 +22,16 @@ public:
 	bool Save(const char* File, json jsonfile);
 
 	void Serialize(const json& jsonfile, std::string& jsonserialized);
+
+	// --- Documents parsed ahead of time by other threads, Load hands each one out once ---
+	void Prefetch(const char* File, json& jsonfile);
+	void DropPrefetched(const char* File); // The file changed on disk since
+	void ClearPrefetched();
+
+private:
+
+	mutable std::mutex prefetch_mutex;
+	mutable std::unordered_map<std::string, json> prefetched;
 };
 
 #endif
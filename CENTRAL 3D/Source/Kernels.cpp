@@ -0,0 +1,664 @@
+#include "Kernels.h"
+#include "ModuleHardware.h"
+#include "ResourceMesh.h"
+#include "Logger.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+// --- Variants read these as plain floats ---
+static_assert(sizeof(AABB) == 6 * sizeof(float), "Kernels expect AABB as minPoint, maxPoint");
+static_assert(sizeof(Plane) == 4 * sizeof(float), "Kernels expect Plane as normal, d");
+static_assert(sizeof(float4x4) == 16 * sizeof(float), "Kernels expect a row major float4x4");
+static_assert(sizeof(Vertex) == 9 * sizeof(float), "Kernels expect Vertex as position, normal, color, texCoord");
+
+#define KERNELS_RAY_EPSILON 1e-9f // Smaller determinants are rays parallel to the triangle
+
+// --- Scalar references, SIMD variants follow the same operation order so they agree to the bit on most hardware ---
+
+static void TransformAABBsScalar(const AABB* local, const float4x4* transforms, AABB* out, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&local[i];
+		const float* m = (const float*)&transforms[i];
+		float* result = (float*)&out[i];
+
+		float c[3], e[3];
+
+		for (uint j = 0; j < 3; ++j)
+		{
+			c[j] = (box[j] + box[j + 3]) * 0.5f;
+			e[j] = (box[j + 3] - box[j]) * 0.5f;
+		}
+
+		// --- Arvo, the center is transformed and the extents grow with the rotation ---
+		for (uint r = 0; r < 3; ++r)
+		{
+			const float* row = m + r * 4;
+			float center = ((row[0] * c[0] + row[1] * c[1]) + row[2] * c[2]) + row[3];
+			float extent = (fabsf(row[0]) * e[0] + fabsf(row[1]) * e[1]) + fabsf(row[2]) * e[2];
+
+			result[r] = center - extent;
+			result[r + 3] = center + extent;
+		}
+	}
+}
+
+static void CullAABBsScalar(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count)
+{
+	const float* p = (const float*)planes;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&boxes[i];
+
+		float c[3], e[3];
+
+		for (uint j = 0; j < 3; ++j)
+		{
+			c[j] = (box[j] + box[j + 3]) * 0.5f;
+			e[j] = (box[j + 3] - box[j]) * 0.5f;
+		}
+
+		bool outside = false;
+
+		// --- Outside when the center is further out than the box reaches towards the plane ---
+		for (uint j = 0; j < 6; ++j)
+		{
+			const float* plane = p + j * 4;
+			float distance = ((plane[0] * c[0] + plane[1] * c[1]) + plane[2] * c[2]) - plane[3];
+			float radius = (fabsf(plane[0]) * e[0] + fabsf(plane[1]) * e[1]) + fabsf(plane[2]) * e[2];
+			outside |= distance > radius;
+		}
+
+		visible[i] = outside ? 0 : 1;
+	}
+}
+
+static void MulMatricesScalar(const float4x4& parent, const float4x4* local, float4x4* global, uint count)
+{
+	const float* p = (const float*)&parent;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* l = (const float*)&local[i];
+		float result[16];
+
+		for (uint r = 0; r < 4; ++r)
+		{
+			for (uint c = 0; c < 4; ++c)
+				result[r * 4 + c] = ((p[r * 4] * l[c] + p[r * 4 + 1] * l[4 + c]) + p[r * 4 + 2] * l[8 + c]) + p[r * 4 + 3] * l[12 + c];
+		}
+
+		// --- Through a copy, global may be local ---
+		memcpy((float*)&global[i], result, sizeof(result));
+	}
+}
+
+static void PackVerticesScalar(const float* positions, const float* normals, const float* coords, Vertex* out, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+	{
+		Vertex& vertex = out[i];
+
+		vertex.position[0] = positions[i * 3];
+		vertex.position[1] = positions[i * 3 + 1];
+		vertex.position[2] = positions[i * 3 + 2];
+
+		vertex.normal[0] = normals ? normals[i * 3] : 0.0f;
+		vertex.normal[1] = normals ? normals[i * 3 + 1] : 0.0f;
+		vertex.normal[2] = normals ? normals[i * 3 + 2] : 0.0f;
+
+		memset(vertex.color, 255, sizeof(vertex.color));
+
+		vertex.texCoord[0] = coords ? coords[i * 3] : 0.0f;
+		vertex.texCoord[1] = coords ? coords[i * 3 + 1] : 0.0f;
+	}
+}
+
+static bool RayTrianglesScalar(const float3& origin, const float3& dir, float max_t, const Vertex* vertices, const uint* indices, uint triangles, float& t, uint& triangle)
+{
+	float best = FLT_MAX;
+
+	for (uint i = 0; i < triangles; ++i)
+	{
+		const float* a = vertices[indices[i * 3]].position;
+		const float* b = vertices[indices[i * 3 + 1]].position;
+		const float* c = vertices[indices[i * 3 + 2]].position;
+
+		// --- Möller-Trumbore ---
+		float e1x = b[0] - a[0], e1y = b[1] - a[1], e1z = b[2] - a[2];
+		float e2x = c[0] - a[0], e2y = c[1] - a[1], e2z = c[2] - a[2];
+
+		float px = dir.y * e2z - dir.z * e2y;
+		float py = dir.z * e2x - dir.x * e2z;
+		float pz = dir.x * e2y - dir.y * e2x;
+
+		float det = (e1x * px + e1y * py) + e1z * pz;
+
+		if (!(fabsf(det) >= KERNELS_RAY_EPSILON))
+			continue;
+
+		float inv = 1.0f / det;
+		float sx = origin.x - a[0], sy = origin.y - a[1], sz = origin.z - a[2];
+		float u = ((sx * px + sy * py) + sz * pz) * inv;
+
+		float qx = sy * e1z - sz * e1y;
+		float qy = sz * e1x - sx * e1z;
+		float qz = sx * e1y - sy * e1x;
+
+		float v = ((dir.x * qx + dir.y * qy) + dir.z * qz) * inv;
+		float distance = ((e2x * qx + e2y * qy) + e2z * qz) * inv;
+
+		// --- Strictly nearer, on a tie the first triangle wins ---
+		if (u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f && distance >= 0.0f && distance <= max_t && distance < best)
+		{
+			best = distance;
+			triangle = i;
+		}
+	}
+
+	if (best == FLT_MAX)
+		return false;
+
+	t = best;
+	return true;
+}
+
+static float BlockIndicesScalar(const float (*channels)[16], const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices)
+{
+	float error = 0.0f;
+
+	for (uint pixel = 0; pixel < 16; ++pixel)
+	{
+		float best = FLT_MAX;
+
+		for (uint p = 0; p < palette_size; ++p)
+		{
+			float distance = 0.0f;
+
+			for (uint c = first; c < first + count; ++c)
+			{
+				float difference = channels[c][pixel] - palette[p][c];
+				distance += difference * difference;
+			}
+
+			if (distance < best)
+			{
+				best = distance;
+				indices[pixel] = (unsigned char)p;
+			}
+		}
+
+		error += best;
+	}
+
+	return error;
+}
+
+void Kernels::GetScalarKernels(KernelTable& kernels)
+{
+	kernels.TransformAABBs = TransformAABBsScalar;
+	kernels.CullAABBs = CullAABBsScalar;
+	kernels.MulMatrices = MulMatricesScalar;
+	kernels.PackVertices = PackVerticesScalar;
+	kernels.RayTriangles = RayTrianglesScalar;
+	kernels.BlockIndices = BlockIndicesScalar;
+}
+
+// --- Scalar until Init, so anything running before it (or without it, like the benchmark) is still correct ---
+KernelTable Kernels::table = { TransformAABBsScalar, CullAABBsScalar, MulMatricesScalar, PackVerticesScalar, RayTrianglesScalar, BlockIndicesScalar };
+
+static KernelTable variants[(uint)KernelLevel::count];
+static bool supported[(uint)KernelLevel::count] = { true };
+static bool validated[(uint)KernelId::count][(uint)KernelLevel::count];
+static KernelLevel levels[(uint)KernelId::count];
+static KernelLevel best_levels[(uint)KernelId::count];
+
+// --- Highest preference first ---
+static const KernelLevel preference[] = { KernelLevel::AVX2, KernelLevel::SSE41, KernelLevel::NEON, KernelLevel::Scalar };
+
+static const char* kernel_names[] = { "TransformAABBs", "CullAABBs", "MulMatrices", "PackVertices", "RayTriangles", "BlockIndices" };
+static const char* level_names[] = { "Scalar", "SSE4.1", "AVX2", "NEON" };
+
+static_assert(sizeof(kernel_names) / sizeof(kernel_names[0]) == (uint)KernelId::count, "A kernel is missing its name");
+static_assert(sizeof(level_names) / sizeof(level_names[0]) == (uint)KernelLevel::count, "A level is missing its name");
+
+static bool HasKernel(const KernelTable& kernels, KernelId kernel)
+{
+	switch (kernel)
+	{
+		case KernelId::TransformAABBs: return kernels.TransformAABBs != nullptr;
+		case KernelId::CullAABBs: return kernels.CullAABBs != nullptr;
+		case KernelId::MulMatrices: return kernels.MulMatrices != nullptr;
+		case KernelId::PackVertices: return kernels.PackVertices != nullptr;
+		case KernelId::RayTriangles: return kernels.RayTriangles != nullptr;
+		case KernelId::BlockIndices: return kernels.BlockIndices != nullptr;
+		default: return false;
+	}
+}
+
+static void CopyKernel(KernelTable& dst, const KernelTable& src, KernelId kernel)
+{
+	switch (kernel)
+	{
+		case KernelId::TransformAABBs: dst.TransformAABBs = src.TransformAABBs; break;
+		case KernelId::CullAABBs: dst.CullAABBs = src.CullAABBs; break;
+		case KernelId::MulMatrices: dst.MulMatrices = src.MulMatrices; break;
+		case KernelId::PackVertices: dst.PackVertices = src.PackVertices; break;
+		case KernelId::RayTriangles: dst.RayTriangles = src.RayTriangles; break;
+		case KernelId::BlockIndices: dst.BlockIndices = src.BlockIndices; break;
+		default: break;
+	}
+}
+
+// --- Validation input, deterministic so a failure can be reproduced from its seed ---
+struct KernelRandom
+{
+	uint state;
+
+	float Next(float min, float max)
+	{
+		state = state * 1664525u + 1013904223u;
+		return min + (max - min) * ((state >> 8) / 16777216.0f);
+	}
+};
+
+static bool NearlyEqual(float a, float b)
+{
+	return fabsf(a - b) <= 1e-4f * (1.0f + fabsf(a) + fabsf(b));
+}
+
+static bool NearlyEqual(const float* a, const float* b, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+	{
+		if (!NearlyEqual(a[i], b[i]))
+			return false;
+	}
+
+	return true;
+}
+
+static void RandomTransform(KernelRandom& random, float4x4& transform)
+{
+	Quat rotation = Quat::FromEulerXYZ(random.Next(-3.14f, 3.14f), random.Next(-3.14f, 3.14f), random.Next(-3.14f, 3.14f));
+	float3 scale(random.Next(0.1f, 4.0f), random.Next(0.1f, 4.0f), random.Next(0.1f, 4.0f));
+	float3 position(random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f));
+	transform = float4x4::FromTRS(position, rotation, scale);
+}
+
+static void RandomAABB(KernelRandom& random, AABB& box)
+{
+	float3 center(random.Next(-200.0f, 200.0f), random.Next(-200.0f, 200.0f), random.Next(-200.0f, 200.0f));
+	float3 extent(random.Next(0.0f, 20.0f), random.Next(0.0f, 20.0f), random.Next(0.0f, 20.0f));
+	box.minPoint = center - extent;
+	box.maxPoint = center + extent;
+}
+
+static bool ValidateTransformAABBs(const KernelTable& kernels, KernelRandom& random)
+{
+	std::vector<AABB> local(KERNELS_VALIDATION_SIZE), expected(KERNELS_VALIDATION_SIZE), result(KERNELS_VALIDATION_SIZE);
+	std::vector<float4x4> transforms(KERNELS_VALIDATION_SIZE);
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE; ++i)
+	{
+		RandomAABB(random, local[i]);
+		RandomTransform(random, transforms[i]);
+	}
+
+	// --- Every count up to a few times the widest variant, so tails are covered ---
+	for (uint count = 0; count <= 17; ++count)
+	{
+		TransformAABBsScalar(local.data(), transforms.data(), expected.data(), count);
+		kernels.TransformAABBs(local.data(), transforms.data(), result.data(), count);
+
+		if (!NearlyEqual((const float*)expected.data(), (const float*)result.data(), count * 6))
+			return false;
+	}
+
+	TransformAABBsScalar(local.data(), transforms.data(), expected.data(), KERNELS_VALIDATION_SIZE);
+	kernels.TransformAABBs(local.data(), transforms.data(), result.data(), KERNELS_VALIDATION_SIZE);
+
+	return NearlyEqual((const float*)expected.data(), (const float*)result.data(), KERNELS_VALIDATION_SIZE * 6);
+}
+
+static bool ValidateCullAABBs(const KernelTable& kernels, KernelRandom& random)
+{
+	std::vector<AABB> boxes(KERNELS_VALIDATION_SIZE);
+	std::vector<unsigned char> expected(KERNELS_VALIDATION_SIZE), result(KERNELS_VALIDATION_SIZE);
+
+	Frustum frustum;
+	frustum.SetKind(FrustumSpaceGL, FrustumRightHanded);
+	frustum.SetViewPlaneDistances(0.1f, 300.0f);
+	frustum.SetPerspective(1.2f, 0.9f);
+	frustum.SetFrame(float3(random.Next(-10.0f, 10.0f), 0.0f, random.Next(-10.0f, 10.0f)), float3::unitZ, float3::unitY);
+
+	Plane planes[6];
+	frustum.GetPlanes(planes);
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE; ++i)
+		RandomAABB(random, boxes[i]);
+
+	for (uint count = 0; count <= 17; ++count)
+	{
+		CullAABBsScalar(planes, boxes.data(), expected.data(), count);
+		kernels.CullAABBs(planes, boxes.data(), result.data(), count);
+
+		if (memcmp(expected.data(), result.data(), count) != 0)
+			return false;
+	}
+
+	CullAABBsScalar(planes, boxes.data(), expected.data(), KERNELS_VALIDATION_SIZE);
+	kernels.CullAABBs(planes, boxes.data(), result.data(), KERNELS_VALIDATION_SIZE);
+
+	// --- A box touching a plane may land either side of it with different rounding, those are not compared ---
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE; ++i)
+	{
+		if (expected[i] == result[i])
+			continue;
+
+		const float* box = (const float*)&boxes[i];
+		bool borderline = false;
+
+		for (uint j = 0; j < 6; ++j)
+		{
+			const float* plane = (const float*)&planes[j];
+			float distance = 0.0f, radius = 0.0f;
+
+			for (uint k = 0; k < 3; ++k)
+			{
+				distance += plane[k] * (box[k] + box[k + 3]) * 0.5f;
+				radius += fabsf(plane[k]) * (box[k + 3] - box[k]) * 0.5f;
+			}
+
+			borderline |= NearlyEqual(distance - plane[3], radius);
+		}
+
+		if (!borderline)
+			return false;
+	}
+
+	return true;
+}
+
+static bool ValidateMulMatrices(const KernelTable& kernels, KernelRandom& random)
+{
+	std::vector<float4x4> local(KERNELS_VALIDATION_SIZE), expected(KERNELS_VALIDATION_SIZE), result(KERNELS_VALIDATION_SIZE);
+	float4x4 parent;
+	RandomTransform(random, parent);
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE; ++i)
+		RandomTransform(random, local[i]);
+
+	for (uint count = 0; count <= 17; ++count)
+	{
+		MulMatricesScalar(parent, local.data(), expected.data(), count);
+		kernels.MulMatrices(parent, local.data(), result.data(), count);
+
+		if (!NearlyEqual((const float*)expected.data(), (const float*)result.data(), count * 16))
+			return false;
+	}
+
+	// --- In place, the way transforms are updated ---
+	result = local;
+	MulMatricesScalar(parent, local.data(), expected.data(), KERNELS_VALIDATION_SIZE);
+	kernels.MulMatrices(parent, result.data(), result.data(), KERNELS_VALIDATION_SIZE);
+
+	return NearlyEqual((const float*)expected.data(), (const float*)result.data(), KERNELS_VALIDATION_SIZE * 16);
+}
+
+static bool ValidatePackVertices(const KernelTable& kernels, KernelRandom& random)
+{
+	std::vector<float> positions(KERNELS_VALIDATION_SIZE * 3), normals(KERNELS_VALIDATION_SIZE * 3), coords(KERNELS_VALIDATION_SIZE * 3);
+	std::vector<Vertex> expected(KERNELS_VALIDATION_SIZE), result(KERNELS_VALIDATION_SIZE);
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE * 3; ++i)
+	{
+		positions[i] = random.Next(-100.0f, 100.0f);
+		normals[i] = random.Next(-1.0f, 1.0f);
+		coords[i] = random.Next(0.0f, 1.0f);
+	}
+
+	// --- Pure copies, has to match exactly, with and without the optional streams ---
+	for (uint pass = 0; pass < 4; ++pass)
+	{
+		const float* pass_normals = pass & 1 ? nullptr : normals.data();
+		const float* pass_coords = pass & 2 ? nullptr : coords.data();
+
+		for (uint count = 0; count <= 17; ++count)
+		{
+			PackVerticesScalar(positions.data(), pass_normals, pass_coords, expected.data(), count);
+			kernels.PackVertices(positions.data(), pass_normals, pass_coords, result.data(), count);
+
+			if (memcmp(expected.data(), result.data(), count * sizeof(Vertex)) != 0)
+				return false;
+		}
+
+		PackVerticesScalar(positions.data(), pass_normals, pass_coords, expected.data(), KERNELS_VALIDATION_SIZE);
+		kernels.PackVertices(positions.data(), pass_normals, pass_coords, result.data(), KERNELS_VALIDATION_SIZE);
+
+		if (memcmp(expected.data(), result.data(), KERNELS_VALIDATION_SIZE * sizeof(Vertex)) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+static bool ValidateRayTriangles(const KernelTable& kernels, KernelRandom& random)
+{
+	// --- A cloud of triangles around the origin, rays are shot through it from outside ---
+	std::vector<Vertex> vertices(KERNELS_VALIDATION_SIZE);
+	std::vector<uint> indices(KERNELS_VALIDATION_SIZE * 3);
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE; ++i)
+	{
+		for (uint j = 0; j < 3; ++j)
+			vertices[i].position[j] = random.Next(-10.0f, 10.0f);
+	}
+
+	for (uint i = 0; i < KERNELS_VALIDATION_SIZE * 3; ++i)
+		indices[i] = (uint)random.Next(0.0f, KERNELS_VALIDATION_SIZE - 1.0f);
+
+	for (uint ray = 0; ray < 64; ++ray)
+	{
+		float3 origin(random.Next(-20.0f, 20.0f), random.Next(-20.0f, 20.0f), -30.0f);
+		float3 target(random.Next(-5.0f, 5.0f), random.Next(-5.0f, 5.0f), 30.0f);
+		uint triangles = ray < 18 ? ray : KERNELS_VALIDATION_SIZE;
+
+		float expected_t = -1.0f, result_t = -1.0f;
+		uint expected_triangle = 0, result_triangle = 0;
+
+		bool expected_hit = RayTrianglesScalar(origin, target - origin, 1.0f, vertices.data(), indices.data(), triangles, expected_t, expected_triangle);
+		bool result_hit = kernels.RayTriangles(origin, target - origin, 1.0f, vertices.data(), indices.data(), triangles, result_t, result_triangle);
+
+		if (expected_hit != result_hit)
+			return false;
+
+		// --- Two triangles at the same distance may swap with different rounding, the distance is what matters ---
+		if (expected_hit && !NearlyEqual(expected_t, result_t))
+			return false;
+	}
+
+	return true;
+}
+
+static bool ValidateBlockIndices(const KernelTable& kernels, KernelRandom& random)
+{
+	// --- The palettes the compressor searches: BC1 colors, BC4/BC5 channels and BC7 mode 6 ---
+	static const uint shapes[][3] = { { 4, 0, 3 }, { 8, 0, 1 }, { 8, 1, 1 }, { 8, 3, 1 }, { 16, 0, 4 }, { 1, 0, 4 } }; // Size, first, count
+
+	float channels[4][16];
+	float palette[16][4];
+	unsigned char expected[16], result[16];
+
+	for (uint block = 0; block < KERNELS_VALIDATION_SIZE / 16; ++block)
+	{
+		// --- Whole values half the time, like pixels and endpoints, so distances tie and the first entry has to win ---
+		bool whole = (block & 1) == 0;
+
+		for (uint c = 0; c < 4; ++c)
+		{
+			for (uint pixel = 0; pixel < 16; ++pixel)
+				channels[c][pixel] = whole ? floorf(random.Next(0.0f, 8.0f)) : random.Next(0.0f, 255.0f);
+		}
+
+		for (uint p = 0; p < 16; ++p)
+		{
+			for (uint c = 0; c < 4; ++c)
+				palette[p][c] = whole ? floorf(random.Next(0.0f, 8.0f)) : random.Next(0.0f, 255.0f);
+		}
+
+		for (uint s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s)
+		{
+			float expected_error = BlockIndicesScalar(channels, palette, shapes[s][0], shapes[s][1], shapes[s][2], expected);
+			float result_error = kernels.BlockIndices(channels, palette, shapes[s][0], shapes[s][1], shapes[s][2], result);
+
+			if (!NearlyEqual(expected_error, result_error))
+				return false;
+
+			// --- Fractional distances may round the other way on a near tie, the error already says the pick is as good ---
+			if (whole && memcmp(expected, result, sizeof(expected)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void Kernels::Init(const hw_info& info)
+{
+	GetScalarKernels(variants[(uint)KernelLevel::Scalar]);
+
+#if KERNELS_X86
+	supported[(uint)KernelLevel::SSE41] = info.sse41;
+	supported[(uint)KernelLevel::AVX2] = info.avx && info.avx2;
+	GetSSE41Kernels(variants[(uint)KernelLevel::SSE41]);
+	GetAVX2Kernels(variants[(uint)KernelLevel::AVX2]);
+#endif
+
+#if KERNELS_NEON
+	supported[(uint)KernelLevel::NEON] = info.neon;
+	GetNEONKernels(variants[(uint)KernelLevel::NEON]);
+#endif
+
+	for (uint k = 0; k < (uint)KernelId::count; ++k)
+	{
+		KernelId kernel = (KernelId)k;
+		best_levels[k] = KernelLevel::Scalar;
+		validated[k][(uint)KernelLevel::Scalar] = true;
+
+		for (uint p = 0; p < sizeof(preference) / sizeof(preference[0]); ++p)
+		{
+			KernelLevel level = preference[p];
+
+			if (level == KernelLevel::Scalar || !HasVariant(kernel, level))
+				continue;
+
+			validated[k][(uint)level] = Validate(kernel, level);
+
+			if (!validated[k][(uint)level])
+			{
+				CONSOLE_LOG("|[error]: Kernels: %s %s disagrees with the scalar reference, not used", GetLevelName(level), GetKernelName(kernel));
+			}
+			else if (best_levels[k] == KernelLevel::Scalar)
+				best_levels[k] = level;
+		}
+
+		levels[k] = best_levels[k];
+		CopyKernel(table, variants[(uint)best_levels[k]], kernel);
+
+		LOG_DEBUG(LogCategory::General, "Kernels: %s uses %s", GetKernelName(kernel), GetLevelName(best_levels[k]));
+	}
+}
+
+bool Kernels::IsSupported(KernelLevel level)
+{
+	return level < KernelLevel::count && supported[(uint)level];
+}
+
+bool Kernels::HasVariant(KernelId kernel, KernelLevel level)
+{
+	return kernel < KernelId::count && IsSupported(level) && HasKernel(variants[(uint)level], kernel);
+}
+
+KernelLevel Kernels::GetLevel(KernelId kernel)
+{
+	return kernel < KernelId::count ? levels[(uint)kernel] : KernelLevel::Scalar;
+}
+
+KernelLevel Kernels::GetBestLevel(KernelId kernel)
+{
+	return kernel < KernelId::count ? best_levels[(uint)kernel] : KernelLevel::Scalar;
+}
+
+bool Kernels::SetLevel(KernelId kernel, KernelLevel level)
+{
+	if (!HasVariant(kernel, level) || !validated[(uint)kernel][(uint)level])
+		return false;
+
+	levels[(uint)kernel] = level;
+	CopyKernel(table, variants[(uint)level], kernel);
+
+	return true;
+}
+
+bool Kernels::Validate(KernelId kernel, KernelLevel level, uint seed)
+{
+	if (!HasVariant(kernel, level))
+		return false;
+
+	// --- Only the kernel under test comes from the variant ---
+	KernelTable kernels;
+	GetScalarKernels(kernels);
+	CopyKernel(kernels, variants[(uint)level], kernel);
+
+	KernelRandom random = { seed };
+
+	switch (kernel)
+	{
+		case KernelId::TransformAABBs: return ValidateTransformAABBs(kernels, random);
+		case KernelId::CullAABBs: return ValidateCullAABBs(kernels, random);
+		case KernelId::MulMatrices: return ValidateMulMatrices(kernels, random);
+		case KernelId::PackVertices: return ValidatePackVertices(kernels, random);
+		case KernelId::RayTriangles: return ValidateRayTriangles(kernels, random);
+		case KernelId::BlockIndices: return ValidateBlockIndices(kernels, random);
+		default: return false;
+	}
+}
+
+const char* Kernels::GetKernelName(KernelId kernel)
+{
+	return kernel < KernelId::count ? kernel_names[(uint)kernel] : "";
+}
+
+const char* Kernels::GetLevelName(KernelLevel level)
+{
+	return level < KernelLevel::count ? level_names[(uint)level] : "";
+}
+
+KernelLevel Kernels::GetLevelFromName(const char* name)
+{
+	for (uint i = 0; i < (uint)KernelLevel::count; ++i)
+	{
+		if (strcmp(level_names[i], name) == 0)
+			return (KernelLevel)i;
+	}
+
+	return KernelLevel::count;
+}
+
+// --- Builds without an instruction set still link, those variants just do not exist ---
+#if !KERNELS_X86
+void Kernels::GetSSE41Kernels(KernelTable& kernels) {}
+void Kernels::GetAVX2Kernels(KernelTable& kernels) {}
+#endif
+
+#if !KERNELS_NEON
+void Kernels::GetNEONKernels(KernelTable& kernels) {}
+#endif
@@ -0,0 +1,113 @@
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+#include "Globals.h"
+#include "Math.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define KERNELS_X86 1
+#else
+#define KERNELS_X86 0
+#endif
+
+#if (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define KERNELS_NEON 1
+#else
+#define KERNELS_NEON 0
+#endif
+
+#define KERNELS_VALIDATION_SIZE 1024 // Elements each variant is checked with at startup
+
+struct hw_info;
+struct Vertex;
+
+enum class KernelLevel
+{
+	Scalar = 0,
+	SSE41,
+	AVX2,
+	NEON,
+	count
+};
+
+enum class KernelId
+{
+	TransformAABBs = 0,
+	CullAABBs,
+	MulMatrices,
+	PackVertices,
+	RayTriangles,
+	BlockIndices,
+	count
+};
+
+// --- Kernel signatures, every variant of a kernel computes the same thing as its scalar reference ---
+
+// --- Boxes of transformed boxes, out[i] encloses local[i] transformed by transforms[i] ---
+typedef void(*TransformAABBsKernel)(const AABB* local, const float4x4* transforms, AABB* out, uint count);
+
+// --- visible[i] is 0 if boxes[i] is fully outside any of the 6 planes, normals point out of the frustum ---
+typedef void(*CullAABBsKernel)(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count);
+
+// --- global[i] = parent * local[i] ---
+typedef void(*MulMatricesKernel)(const float4x4& parent, const float4x4* local, float4x4* global, uint count);
+
+// --- Interleaves tightly packed xyz positions, normals and uvw coordinates (assimp's layout), normals and coords may be null ---
+typedef void(*PackVerticesKernel)(const float* positions, const float* normals, const float* coords, Vertex* out, uint count);
+
+// --- Nearest triangle hit by origin + t * dir with t in [0, max_t], false if none ---
+typedef bool(*RayTrianglesKernel)(const float3& origin, const float3& dir, float max_t, const Vertex* vertices, const uint* indices, uint triangles, float& t, uint& triangle);
+
+// --- Nearest palette entry for each pixel of a 4x4 block over channels [first, first + count), the first entry on a tie.
+// channels holds the block one channel after the other. Returns the summed squared distance ---
+typedef float(*BlockIndicesKernel)(const float (*channels)[16], const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices);
+
+struct KernelTable
+{
+	TransformAABBsKernel TransformAABBs = nullptr;
+	CullAABBsKernel CullAABBs = nullptr;
+	MulMatricesKernel MulMatrices = nullptr;
+	PackVerticesKernel PackVertices = nullptr;
+	RayTrianglesKernel RayTriangles = nullptr;
+	BlockIndicesKernel BlockIndices = nullptr;
+};
+
+// --- Picks the best variant of each kernel the CPU runs, once at startup ---
+// --- Variants are checked against the scalar reference first, one that disagrees is never used ---
+namespace Kernels
+{
+	void Init(const hw_info& info);
+
+	bool IsSupported(KernelLevel level); // By this CPU and this build
+	bool HasVariant(KernelId kernel, KernelLevel level);
+	KernelLevel GetLevel(KernelId kernel);
+	KernelLevel GetBestLevel(KernelId kernel); // What Init selected
+
+	// --- Forces a variant, for testing and comparing. False if it does not exist, is not supported or failed validation ---
+	bool SetLevel(KernelId kernel, KernelLevel level);
+
+	// --- Runs a variant against the scalar reference on generated input ---
+	bool Validate(KernelId kernel, KernelLevel level, uint seed = 1);
+
+	const char* GetKernelName(KernelId kernel);
+	const char* GetLevelName(KernelLevel level);
+	KernelLevel GetLevelFromName(const char* name); // KernelLevel::count if unknown
+
+	// --- The selected variants, callers go through these ---
+	extern KernelTable table;
+
+	inline void TransformAABBs(const AABB* local, const float4x4* transforms, AABB* out, uint count) { table.TransformAABBs(local, transforms, out, count); }
+	inline void CullAABBs(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count) { table.CullAABBs(planes, boxes, visible, count); }
+	inline void MulMatrices(const float4x4& parent, const float4x4* local, float4x4* global, uint count) { table.MulMatrices(parent, local, global, count); }
+	inline void PackVertices(const float* positions, const float* normals, const float* coords, Vertex* out, uint count) { table.PackVertices(positions, normals, coords, out, count); }
+	inline bool RayTriangles(const float3& origin, const float3& dir, float max_t, const Vertex* vertices, const uint* indices, uint triangles, float& t, uint& triangle) { return table.RayTriangles(origin, dir, max_t, vertices, indices, triangles, t, triangle); }
+	inline float BlockIndices(const float (*channels)[16], const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices) { return table.BlockIndices(channels, palette, palette_size, first, count, indices); }
+
+	// --- Variants, defined in Kernels.cpp (scalar) and one file per instruction set. Null where a kernel has none ---
+	void GetScalarKernels(KernelTable& kernels);
+	void GetSSE41Kernels(KernelTable& kernels);
+	void GetAVX2Kernels(KernelTable& kernels);
+	void GetNEONKernels(KernelTable& kernels);
+}
+
+#endif
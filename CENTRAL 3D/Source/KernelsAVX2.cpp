@@ -0,0 +1,273 @@
+#include "Kernels.h"
+
+#if KERNELS_X86
+
+#include "ResourceMesh.h"
+
+#include <float.h>
+#include <immintrin.h>
+
+#include "mmgr/mmgr.h"
+
+// --- Everything above is built for the baseline, only what follows may use AVX2 ---
+// --- Not set for the whole file on MSVC, inline functions from the headers would be built with it too ---
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+static inline __m256 Abs(__m256 v)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+static inline __m256 Combine(__m128 low, __m128 high)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static void CullAABBsAVX2(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count)
+{
+	// --- One plane per lane, the last two are planes nothing is ever outside of ---
+	const float* p = (const float*)planes;
+	float soa[4][8] = {};
+
+	for (uint j = 0; j < 6; ++j)
+	{
+		for (uint k = 0; k < 4; ++k)
+			soa[k][j] = p[j * 4 + k];
+	}
+
+	const __m256 nx = _mm256_loadu_ps(soa[0]), ny = _mm256_loadu_ps(soa[1]), nz = _mm256_loadu_ps(soa[2]), d = _mm256_loadu_ps(soa[3]);
+	const __m256 ax = Abs(nx), ay = Abs(ny), az = Abs(nz);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&boxes[i];
+
+		__m256 cx = _mm256_set1_ps((box[0] + box[3]) * 0.5f);
+		__m256 cy = _mm256_set1_ps((box[1] + box[4]) * 0.5f);
+		__m256 cz = _mm256_set1_ps((box[2] + box[5]) * 0.5f);
+		__m256 ex = _mm256_set1_ps((box[3] - box[0]) * 0.5f);
+		__m256 ey = _mm256_set1_ps((box[4] - box[1]) * 0.5f);
+		__m256 ez = _mm256_set1_ps((box[5] - box[2]) * 0.5f);
+
+		__m256 distance = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)), _mm256_mul_ps(nz, cz)), d);
+		__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, ex), _mm256_mul_ps(ay, ey)), _mm256_mul_ps(az, ez));
+
+		visible[i] = _mm256_movemask_ps(_mm256_cmp_ps(distance, radius, _CMP_GT_OQ)) ? 0 : 1;
+	}
+
+	_mm256_zeroupper();
+}
+
+static void MulMatricesAVX2(const float4x4& parent, const float4x4* local, float4x4* global, uint count)
+{
+	// --- Two rows of the result per register, rows 0-1 and 2-3 ---
+	const float* p = (const float*)&parent;
+	__m256 scale[2][4];
+
+	for (uint r = 0; r < 2; ++r)
+	{
+		for (uint k = 0; k < 4; ++k)
+			scale[r][k] = Combine(_mm_set1_ps(p[r * 8 + k]), _mm_set1_ps(p[r * 8 + 4 + k]));
+	}
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* l = (const float*)&local[i];
+		float* result = (float*)&global[i];
+
+		// --- Loaded before anything is stored, global may be local ---
+		__m256 l0 = _mm256_broadcast_ps((const __m128*)l);
+		__m256 l1 = _mm256_broadcast_ps((const __m128*)(l + 4));
+		__m256 l2 = _mm256_broadcast_ps((const __m128*)(l + 8));
+		__m256 l3 = _mm256_broadcast_ps((const __m128*)(l + 12));
+
+		for (uint r = 0; r < 2; ++r)
+		{
+			__m256 sum = _mm256_add_ps(_mm256_mul_ps(scale[r][0], l0), _mm256_mul_ps(scale[r][1], l1));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(scale[r][2], l2));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(scale[r][3], l3));
+			_mm256_storeu_ps(result + r * 8, sum);
+		}
+	}
+
+	_mm256_zeroupper();
+}
+
+static bool RayTrianglesAVX2(const float3& origin, const float3& dir, float max_t, const Vertex* vertices, const uint* indices, uint triangles, float& t, uint& triangle)
+{
+	const float* o = (const float*)&origin;
+	const float* d = (const float*)&dir;
+
+	const __m256 ox = _mm256_set1_ps(o[0]), oy = _mm256_set1_ps(o[1]), oz = _mm256_set1_ps(o[2]);
+	const __m256 dx = _mm256_set1_ps(d[0]), dy = _mm256_set1_ps(d[1]), dz = _mm256_set1_ps(d[2]);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 epsilon = _mm256_set1_ps(1e-9f);
+	const __m256 limit = _mm256_set1_ps(max_t);
+
+	__m256 best = _mm256_set1_ps(FLT_MAX);
+	__m256i best_index = _mm256_setzero_si256();
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	// --- Gathered straight from the vertex buffer, 9 floats apart ---
+	const float* position = (const float*)vertices;
+	const __m256i stride = _mm256_set1_epi32(sizeof(Vertex) / sizeof(float));
+	const __m256i triangle_stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+	uint wide = triangles & ~7u;
+
+	// --- Eight triangles a time, one per lane ---
+	for (uint i = 0; i < wide; i += 8)
+	{
+		const int* corners = (const int*)(indices + i * 3);
+		__m256i ia = _mm256_mullo_epi32(_mm256_i32gather_epi32(corners, triangle_stride, 4), stride);
+		__m256i ib = _mm256_mullo_epi32(_mm256_i32gather_epi32(corners + 1, triangle_stride, 4), stride);
+		__m256i ic = _mm256_mullo_epi32(_mm256_i32gather_epi32(corners + 2, triangle_stride, 4), stride);
+
+		__m256 ax = _mm256_i32gather_ps(position, ia, 4), ay = _mm256_i32gather_ps(position + 1, ia, 4), az = _mm256_i32gather_ps(position + 2, ia, 4);
+
+		__m256 e1x = _mm256_sub_ps(_mm256_i32gather_ps(position, ib, 4), ax);
+		__m256 e1y = _mm256_sub_ps(_mm256_i32gather_ps(position + 1, ib, 4), ay);
+		__m256 e1z = _mm256_sub_ps(_mm256_i32gather_ps(position + 2, ib, 4), az);
+		__m256 e2x = _mm256_sub_ps(_mm256_i32gather_ps(position, ic, 4), ax);
+		__m256 e2y = _mm256_sub_ps(_mm256_i32gather_ps(position + 1, ic, 4), ay);
+		__m256 e2z = _mm256_sub_ps(_mm256_i32gather_ps(position + 2, ic, 4), az);
+
+		__m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+		__m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+		__m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+
+		__m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+		__m256 hit = _mm256_cmp_ps(Abs(det), epsilon, _CMP_GE_OQ);
+
+		__m256 inv = _mm256_div_ps(one, det);
+		__m256 sx = _mm256_sub_ps(ox, ax), sy = _mm256_sub_ps(oy, ay), sz = _mm256_sub_ps(oz, az);
+		__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inv);
+
+		__m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+		__m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+		__m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+
+		__m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inv);
+		__m256 distance = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inv);
+
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(distance, zero, _CMP_GE_OQ), _mm256_cmp_ps(distance, limit, _CMP_LE_OQ)));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(distance, best, _CMP_LT_OQ));
+
+		best = _mm256_blendv_ps(best, distance, hit);
+		best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(hit));
+		index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+	}
+
+	// --- Nearest lane, the lowest triangle on a tie like the scalar loop ---
+	float lane_t[8];
+	uint lane_index[8];
+	_mm256_storeu_ps(lane_t, best);
+	_mm256_storeu_si256((__m256i*)lane_index, best_index);
+	_mm256_zeroupper();
+
+	float nearest = FLT_MAX;
+	uint nearest_index = 0;
+
+	for (uint k = 0; k < 8; ++k)
+	{
+		if (lane_t[k] < nearest || (lane_t[k] == nearest && lane_t[k] != FLT_MAX && lane_index[k] < nearest_index))
+		{
+			nearest = lane_t[k];
+			nearest_index = lane_index[k];
+		}
+	}
+
+	// --- The rest through the reference, later triangles only win when strictly nearer ---
+	float tail_t = 0.0f;
+	uint tail_index = 0;
+	KernelTable scalar;
+	Kernels::GetScalarKernels(scalar);
+
+	if (wide < triangles && scalar.RayTriangles(origin, dir, max_t, vertices, indices + wide * 3, triangles - wide, tail_t, tail_index) && tail_t < nearest)
+	{
+		nearest = tail_t;
+		nearest_index = wide + tail_index;
+	}
+
+	if (nearest == FLT_MAX)
+		return false;
+
+	t = nearest;
+	triangle = nearest_index;
+	return true;
+}
+
+// --- The whole block in two registers, each palette entry is broadcast once for both ---
+static float BlockIndicesAVX2(const float (*channels)[16], const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices)
+{
+	__m256 best_low = _mm256_set1_ps(FLT_MAX), best_high = best_low;
+	__m256i index_low = _mm256_setzero_si256(), index_high = index_low;
+
+	for (uint p = 0; p < palette_size; ++p)
+	{
+		__m256 distance_low = _mm256_setzero_ps(), distance_high = distance_low;
+
+		for (uint c = first; c < first + count; ++c)
+		{
+			__m256 entry = _mm256_set1_ps(palette[p][c]);
+			__m256 difference_low = _mm256_sub_ps(_mm256_loadu_ps(&channels[c][0]), entry);
+			__m256 difference_high = _mm256_sub_ps(_mm256_loadu_ps(&channels[c][8]), entry);
+			distance_low = _mm256_add_ps(distance_low, _mm256_mul_ps(difference_low, difference_low));
+			distance_high = _mm256_add_ps(distance_high, _mm256_mul_ps(difference_high, difference_high));
+		}
+
+		// --- Strictly closer, on a tie the first entry stays ---
+		__m256i entry_index = _mm256_set1_epi32((int)p);
+		__m256 closer_low = _mm256_cmp_ps(distance_low, best_low, _CMP_LT_OQ);
+		__m256 closer_high = _mm256_cmp_ps(distance_high, best_high, _CMP_LT_OQ);
+
+		best_low = _mm256_blendv_ps(best_low, distance_low, closer_low);
+		best_high = _mm256_blendv_ps(best_high, distance_high, closer_high);
+		index_low = _mm256_blendv_epi8(index_low, entry_index, _mm256_castps_si256(closer_low));
+		index_high = _mm256_blendv_epi8(index_high, entry_index, _mm256_castps_si256(closer_high));
+	}
+
+	int lanes[16];
+	float distances[16];
+	_mm256_storeu_si256((__m256i*)lanes, index_low);
+	_mm256_storeu_si256((__m256i*)(lanes + 8), index_high);
+	_mm256_storeu_ps(distances, best_low);
+	_mm256_storeu_ps(distances + 8, best_high);
+	_mm256_zeroupper();
+
+	// --- Summed in pixel order, like the scalar loop ---
+	float error = 0.0f;
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		indices[i] = (unsigned char)lanes[i];
+		error += distances[i];
+	}
+
+	return error;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+void Kernels::GetAVX2Kernels(KernelTable& kernels)
+{
+	// --- Boxes and vertices are one at a time, 128 bits already covers them and those stay on SSE4.1 ---
+	kernels.CullAABBs = CullAABBsAVX2;
+	kernels.MulMatrices = MulMatricesAVX2;
+	kernels.RayTriangles = RayTrianglesAVX2;
+	kernels.BlockIndices = BlockIndicesAVX2;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "Kernels.h"
+
+#if KERNELS_NEON
+
+#if defined(_M_ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+
+#include "mmgr/mmgr.h"
+
+// --- NEON is part of every ARMv8 target, nothing to enable ---
+
+static inline float32x4_t Load3(const float* p)
+{
+	// --- Never reads past the third float ---
+	return vcombine_f32(vld1_f32(p), vld1_lane_f32(p + 2, vdup_n_f32(0.0f), 0));
+}
+
+static inline void Store3(float* p, float32x4_t v)
+{
+	vst1_f32(p, vget_low_f32(v));
+	vst1q_lane_f32(p + 2, v, 2);
+}
+
+static void TransformAABBsNEON(const AABB* local, const float4x4* transforms, AABB* out, uint count)
+{
+	const float32x4_t half = vdupq_n_f32(0.5f);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&local[i];
+		const float* m = (const float*)&transforms[i];
+		float* result = (float*)&out[i];
+
+		float32x4_t min = Load3(box);
+		float32x4_t max = Load3(box + 3);
+		float32x4_t c = vmulq_f32(vaddq_f32(min, max), half);
+		float32x4_t e = vmulq_f32(vsubq_f32(max, min), half);
+
+		// --- Columns of the matrix, lane r of the result is row r ---
+		float32x4x4_t columns = vld4q_f32(m);
+
+		float32x4_t center = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_laneq_f32(columns.val[0], c, 0), vmulq_laneq_f32(columns.val[1], c, 1)), vmulq_laneq_f32(columns.val[2], c, 2)), columns.val[3]);
+		float32x4_t extent = vaddq_f32(vaddq_f32(vmulq_laneq_f32(vabsq_f32(columns.val[0]), e, 0), vmulq_laneq_f32(vabsq_f32(columns.val[1]), e, 1)), vmulq_laneq_f32(vabsq_f32(columns.val[2]), e, 2));
+
+		Store3(result, vsubq_f32(center, extent));
+		Store3(result + 3, vaddq_f32(center, extent));
+	}
+}
+
+static void CullAABBsNEON(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count)
+{
+	// --- Planes 0-3 in one set of registers, 4-5 and two planes nothing is ever outside of in the other ---
+	float soa[2][4][4] = {};
+	const float* p = (const float*)planes;
+
+	for (uint j = 0; j < 6; ++j)
+	{
+		for (uint k = 0; k < 4; ++k)
+			soa[j / 4][k][j % 4] = p[j * 4 + k];
+	}
+
+	float32x4_t nx[2], ny[2], nz[2], d[2], ax[2], ay[2], az[2];
+
+	for (uint j = 0; j < 2; ++j)
+	{
+		nx[j] = vld1q_f32(soa[j][0]); ny[j] = vld1q_f32(soa[j][1]); nz[j] = vld1q_f32(soa[j][2]); d[j] = vld1q_f32(soa[j][3]);
+		ax[j] = vabsq_f32(nx[j]); ay[j] = vabsq_f32(ny[j]); az[j] = vabsq_f32(nz[j]);
+	}
+
+	const float32x4_t half = vdupq_n_f32(0.5f);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&boxes[i];
+
+		float32x4_t min = Load3(box);
+		float32x4_t max = Load3(box + 3);
+		float32x4_t c = vmulq_f32(vaddq_f32(min, max), half);
+		float32x4_t e = vmulq_f32(vsubq_f32(max, min), half);
+
+		uint32x4_t outside = vdupq_n_u32(0);
+
+		for (uint j = 0; j < 2; ++j)
+		{
+			float32x4_t distance = vsubq_f32(vaddq_f32(vaddq_f32(vmulq_laneq_f32(nx[j], c, 0), vmulq_laneq_f32(ny[j], c, 1)), vmulq_laneq_f32(nz[j], c, 2)), d[j]);
+			float32x4_t radius = vaddq_f32(vaddq_f32(vmulq_laneq_f32(ax[j], e, 0), vmulq_laneq_f32(ay[j], e, 1)), vmulq_laneq_f32(az[j], e, 2));
+			outside = vorrq_u32(outside, vcgtq_f32(distance, radius));
+		}
+
+		visible[i] = vmaxvq_u32(outside) ? 0 : 1;
+	}
+}
+
+static void MulMatricesNEON(const float4x4& parent, const float4x4* local, float4x4* global, uint count)
+{
+	const float* p = (const float*)&parent;
+	float32x4_t rows[4] = { vld1q_f32(p), vld1q_f32(p + 4), vld1q_f32(p + 8), vld1q_f32(p + 12) };
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* l = (const float*)&local[i];
+		float* result = (float*)&global[i];
+
+		// --- Loaded before anything is stored, global may be local ---
+		float32x4_t l0 = vld1q_f32(l);
+		float32x4_t l1 = vld1q_f32(l + 4);
+		float32x4_t l2 = vld1q_f32(l + 8);
+		float32x4_t l3 = vld1q_f32(l + 12);
+
+		for (uint r = 0; r < 4; ++r)
+		{
+			// --- Separate multiply and add, a fused one would round differently from the reference ---
+			float32x4_t sum = vaddq_f32(vmulq_laneq_f32(l0, rows[r], 0), vmulq_laneq_f32(l1, rows[r], 1));
+			sum = vaddq_f32(sum, vmulq_laneq_f32(l2, rows[r], 2));
+			sum = vaddq_f32(sum, vmulq_laneq_f32(l3, rows[r], 3));
+			vst1q_f32(result + r * 4, sum);
+		}
+	}
+}
+
+void Kernels::GetNEONKernels(KernelTable& kernels)
+{
+	// --- Vertices and rays stay on the scalar reference on ARM ---
+	kernels.TransformAABBs = TransformAABBsNEON;
+	kernels.CullAABBs = CullAABBsNEON;
+	kernels.MulMatrices = MulMatricesNEON;
+}
+
+#endif
@@ -0,0 +1,354 @@
+#include "Kernels.h"
+
+#if KERNELS_X86
+
+#include "ResourceMesh.h"
+
+#include <float.h>
+#include <smmintrin.h>
+
+#include "mmgr/mmgr.h"
+
+// --- Everything above is built for the baseline, only what follows may use SSE4.1 ---
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+static inline __m128 Load3(const float* p)
+{
+	// --- Never reads past the third float ---
+	return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double*)p)), _mm_load_ss(p + 2));
+}
+
+static inline void Store3(float* p, __m128 v)
+{
+	_mm_storel_pi((__m64*)p, v);
+	_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+
+static inline __m128 Abs(__m128 v)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static void TransformAABBsSSE41(const AABB* local, const float4x4* transforms, AABB* out, uint count)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&local[i];
+		const float* m = (const float*)&transforms[i];
+		float* result = (float*)&out[i];
+
+		__m128 min = Load3(box);
+		__m128 max = Load3(box + 3);
+		__m128 c = _mm_mul_ps(_mm_add_ps(min, max), half);
+		__m128 e = _mm_mul_ps(_mm_sub_ps(max, min), half);
+
+		// --- Columns of the matrix, lane r of the result is row r ---
+		__m128 col0 = _mm_loadu_ps(m);
+		__m128 col1 = _mm_loadu_ps(m + 4);
+		__m128 col2 = _mm_loadu_ps(m + 8);
+		__m128 col3 = _mm_loadu_ps(m + 12);
+		_MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+		__m128 cx = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 cy = _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 cz = _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 ex = _mm_shuffle_ps(e, e, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 ey = _mm_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 ez = _mm_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2));
+
+		__m128 center = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, cx), _mm_mul_ps(col1, cy)), _mm_mul_ps(col2, cz)), col3);
+		__m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Abs(col0), ex), _mm_mul_ps(Abs(col1), ey)), _mm_mul_ps(Abs(col2), ez));
+
+		Store3(result, _mm_sub_ps(center, extent));
+		Store3(result + 3, _mm_add_ps(center, extent));
+	}
+}
+
+static void CullAABBsSSE41(const Plane* planes, const AABB* boxes, unsigned char* visible, uint count)
+{
+	// --- Planes 0-3 in one set of registers, 4-5 and two planes nothing is ever outside of in the other ---
+	const float* p = (const float*)planes;
+
+	__m128 nx[2], ny[2], nz[2], d[2], ax[2], ay[2], az[2];
+
+	for (uint j = 0; j < 2; ++j)
+	{
+		__m128 p0 = _mm_loadu_ps(p + j * 16);
+		__m128 p1 = _mm_loadu_ps(p + j * 16 + 4);
+		__m128 p2 = j == 0 ? _mm_loadu_ps(p + 8) : _mm_setzero_ps();
+		__m128 p3 = j == 0 ? _mm_loadu_ps(p + 12) : _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+		nx[j] = p0; ny[j] = p1; nz[j] = p2; d[j] = p3;
+		ax[j] = Abs(p0); ay[j] = Abs(p1); az[j] = Abs(p2);
+	}
+
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* box = (const float*)&boxes[i];
+
+		__m128 min = Load3(box);
+		__m128 max = Load3(box + 3);
+		__m128 c = _mm_mul_ps(_mm_add_ps(min, max), half);
+		__m128 e = _mm_mul_ps(_mm_sub_ps(max, min), half);
+
+		__m128 cx = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 cy = _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 cz = _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 ex = _mm_shuffle_ps(e, e, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 ey = _mm_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 ez = _mm_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2));
+
+		int outside = 0;
+
+		for (uint j = 0; j < 2; ++j)
+		{
+			__m128 distance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[j], cx), _mm_mul_ps(ny[j], cy)), _mm_mul_ps(nz[j], cz)), d[j]);
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[j], ex), _mm_mul_ps(ay[j], ey)), _mm_mul_ps(az[j], ez));
+			outside |= _mm_movemask_ps(_mm_cmpgt_ps(distance, radius));
+		}
+
+		visible[i] = outside ? 0 : 1;
+	}
+}
+
+static void MulMatricesSSE41(const float4x4& parent, const float4x4* local, float4x4* global, uint count)
+{
+	const float* p = (const float*)&parent;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const float* l = (const float*)&local[i];
+		float* result = (float*)&global[i];
+
+		// --- Loaded before anything is stored, global may be local ---
+		__m128 l0 = _mm_loadu_ps(l);
+		__m128 l1 = _mm_loadu_ps(l + 4);
+		__m128 l2 = _mm_loadu_ps(l + 8);
+		__m128 l3 = _mm_loadu_ps(l + 12);
+
+		for (uint r = 0; r < 4; ++r)
+		{
+			const float* row = p + r * 4;
+			__m128 sum = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), l0), _mm_mul_ps(_mm_set1_ps(row[1]), l1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[2]), l2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[3]), l3));
+			_mm_storeu_ps(result + r * 4, sum);
+		}
+	}
+}
+
+static void PackVerticesSSE41(const float* positions, const float* normals, const float* coords, Vertex* out, uint count)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 white = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+	// --- Whole 4 float loads, the last vertex would read past the streams so it goes through the scalar path ---
+	uint wide = count > 0 ? count - 1 : 0;
+
+	for (uint i = 0; i < wide; ++i)
+	{
+		float* vertex = (float*)&out[i];
+
+		__m128 position = _mm_loadu_ps(positions + i * 3);
+		__m128 normal = normals ? _mm_loadu_ps(normals + i * 3) : zero;
+		__m128 coord = coords ? _mm_loadu_ps(coords + i * 3) : zero;
+
+		// --- px py pz nx | ny nz color u | v ---
+		__m128 first = _mm_insert_ps(position, normal, _MM_MK_INSERTPS_NDX(0, 3, 0));
+		__m128 second = _mm_shuffle_ps(normal, normal, _MM_SHUFFLE(3, 3, 2, 1));
+		second = _mm_insert_ps(second, white, _MM_MK_INSERTPS_NDX(0, 2, 0));
+		second = _mm_insert_ps(second, coord, _MM_MK_INSERTPS_NDX(0, 3, 0));
+
+		_mm_storeu_ps(vertex, first);
+		_mm_storeu_ps(vertex + 4, second);
+		_mm_store_ss(vertex + 8, _mm_shuffle_ps(coord, coord, _MM_SHUFFLE(1, 1, 1, 1)));
+	}
+
+	for (uint i = wide; i < count; ++i)
+	{
+		float* vertex = (float*)&out[i];
+
+		Store3(vertex, Load3(positions + i * 3));
+		Store3(vertex + 3, normals ? Load3(normals + i * 3) : zero);
+		_mm_store_ss(vertex + 6, white);
+		_mm_store_ss(vertex + 7, coords ? _mm_load_ss(coords + i * 3) : zero);
+		_mm_store_ss(vertex + 8, coords ? _mm_load_ss(coords + i * 3 + 1) : zero);
+	}
+}
+
+static bool RayTrianglesSSE41(const float3& origin, const float3& dir, float max_t, const Vertex* vertices, const uint* indices, uint triangles, float& t, uint& triangle)
+{
+	const float* o = (const float*)&origin;
+	const float* d = (const float*)&dir;
+
+	const __m128 ox = _mm_set1_ps(o[0]), oy = _mm_set1_ps(o[1]), oz = _mm_set1_ps(o[2]);
+	const __m128 dx = _mm_set1_ps(d[0]), dy = _mm_set1_ps(d[1]), dz = _mm_set1_ps(d[2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 epsilon = _mm_set1_ps(1e-9f);
+	const __m128 limit = _mm_set1_ps(max_t);
+
+	__m128 best = _mm_set1_ps(FLT_MAX);
+	__m128i best_index = _mm_setzero_si128();
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+
+	uint wide = triangles & ~3u;
+
+	// --- Four triangles a time, one per lane ---
+	for (uint i = 0; i < wide; i += 4)
+	{
+		float a[3][4], b[3][4], c[3][4];
+
+		for (uint k = 0; k < 4; ++k)
+		{
+			const float* va = vertices[indices[(i + k) * 3]].position;
+			const float* vb = vertices[indices[(i + k) * 3 + 1]].position;
+			const float* vc = vertices[indices[(i + k) * 3 + 2]].position;
+
+			for (uint j = 0; j < 3; ++j)
+			{
+				a[j][k] = va[j];
+				b[j][k] = vb[j];
+				c[j][k] = vc[j];
+			}
+		}
+
+		__m128 ax = _mm_loadu_ps(a[0]), ay = _mm_loadu_ps(a[1]), az = _mm_loadu_ps(a[2]);
+
+		__m128 e1x = _mm_sub_ps(_mm_loadu_ps(b[0]), ax), e1y = _mm_sub_ps(_mm_loadu_ps(b[1]), ay), e1z = _mm_sub_ps(_mm_loadu_ps(b[2]), az);
+		__m128 e2x = _mm_sub_ps(_mm_loadu_ps(c[0]), ax), e2y = _mm_sub_ps(_mm_loadu_ps(c[1]), ay), e2z = _mm_sub_ps(_mm_loadu_ps(c[2]), az);
+
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+		__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		__m128 hit = _mm_cmpge_ps(Abs(det), epsilon);
+
+		__m128 inv = _mm_div_ps(one, det);
+		__m128 sx = _mm_sub_ps(ox, ax), sy = _mm_sub_ps(oy, ay), sz = _mm_sub_ps(oz, az);
+		__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+		__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+		__m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(distance, zero), _mm_cmple_ps(distance, limit)));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(distance, best));
+
+		best = _mm_blendv_ps(best, distance, hit);
+		best_index = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(best_index), _mm_castsi128_ps(index), hit));
+		index = _mm_add_epi32(index, _mm_set1_epi32(4));
+	}
+
+	// --- Nearest lane, the lowest triangle on a tie like the scalar loop ---
+	float lane_t[4];
+	uint lane_index[4];
+	_mm_storeu_ps(lane_t, best);
+	_mm_storeu_si128((__m128i*)lane_index, best_index);
+
+	float nearest = FLT_MAX;
+	uint nearest_index = 0;
+
+	for (uint k = 0; k < 4; ++k)
+	{
+		if (lane_t[k] < nearest || (lane_t[k] == nearest && lane_t[k] != FLT_MAX && lane_index[k] < nearest_index))
+		{
+			nearest = lane_t[k];
+			nearest_index = lane_index[k];
+		}
+	}
+
+	// --- The rest through the reference, later triangles only win when strictly nearer ---
+	float tail_t = 0.0f;
+	uint tail_index = 0;
+	KernelTable scalar;
+	Kernels::GetScalarKernels(scalar);
+
+	if (wide < triangles && scalar.RayTriangles(origin, dir, max_t, vertices, indices + wide * 3, triangles - wide, tail_t, tail_index) && tail_t < nearest)
+	{
+		nearest = tail_t;
+		nearest_index = wide + tail_index;
+	}
+
+	if (nearest == FLT_MAX)
+		return false;
+
+	t = nearest;
+	triangle = nearest_index;
+	return true;
+}
+
+// --- Four pixels at a time, the running nearest entry is kept per lane ---
+static float BlockIndicesSSE41(const float (*channels)[16], const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices)
+{
+	float error = 0.0f;
+
+	for (uint group = 0; group < 16; group += 4)
+	{
+		__m128 best = _mm_set1_ps(FLT_MAX);
+		__m128 best_index = _mm_setzero_ps();
+
+		for (uint p = 0; p < palette_size; ++p)
+		{
+			__m128 distance = _mm_setzero_ps();
+
+			for (uint c = first; c < first + count; ++c)
+			{
+				__m128 difference = _mm_sub_ps(_mm_loadu_ps(&channels[c][group]), _mm_set1_ps(palette[p][c]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+			}
+
+			// --- Strictly closer, on a tie the first entry stays ---
+			__m128 closer = _mm_cmplt_ps(distance, best);
+			best = _mm_blendv_ps(best, distance, closer);
+			best_index = _mm_blendv_ps(best_index, _mm_castsi128_ps(_mm_set1_epi32((int)p)), closer);
+		}
+
+		int lanes[4];
+		float distances[4];
+		_mm_storeu_si128((__m128i*)lanes, _mm_castps_si128(best_index));
+		_mm_storeu_ps(distances, best);
+
+		for (uint i = 0; i < 4; ++i)
+		{
+			indices[group + i] = (unsigned char)lanes[i];
+			error += distances[i];
+		}
+	}
+
+	return error;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+void Kernels::GetSSE41Kernels(KernelTable& kernels)
+{
+	kernels.TransformAABBs = TransformAABBsSSE41;
+	kernels.CullAABBs = CullAABBsSSE41;
+	kernels.MulMatrices = MulMatricesSSE41;
+	kernels.PackVertices = PackVerticesSSE41;
+	kernels.RayTriangles = RayTrianglesSSE41;
+	kernels.BlockIndices = BlockIndicesSSE41;
+}
+
+#endif
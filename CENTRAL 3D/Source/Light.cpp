@@ -1,6 +1,6 @@
 #include "Globals.h"
 #include "Light.h"
-#include <gl/GL.h>
+#include "OpenGL.h"
 
 Light::Light() : ref(-1), on(false), position(0.0f, 0.0f, 0.0f)
 {}
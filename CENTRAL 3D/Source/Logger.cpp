@@ -0,0 +1,350 @@
+#include "Logger.h"
+#include <algorithm>
+
+#include "Optick/include/optick.h"
+
+#include "mmgr/mmgr.h"
+
+// ----------------------------------------------------------------------------------------------------------
+// --- LogRing ---
+
+LogRing::LogRing()
+{
+	in_use = false;
+	dropped = 0;
+	head = 0;
+	tail = 0;
+}
+
+LogEntry* LogRing::Reserve()
+{
+	uint t = tail.load(std::memory_order_relaxed);
+
+	// --- Full, the sink did not catch up ---
+	if (t - head.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+		return nullptr;
+
+	return &entries[t & (LOG_RING_SIZE - 1)];
+}
+
+void LogRing::Commit()
+{
+	tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool LogRing::Pop(LogEntry& entry)
+{
+	uint h = head.load(std::memory_order_relaxed);
+
+	if (h == tail.load(std::memory_order_acquire))
+		return false;
+
+	entry = entries[h & (LOG_RING_SIZE - 1)];
+	head.store(h + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool LogRing::Empty() const
+{
+	return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+bool LogRing::HalfFull() const
+{
+	return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) >= LOG_RING_SIZE / 2;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- Logger ---
+
+// --- Gives the thread's ring back when the thread exits ---
+struct ThreadRing
+{
+	LogRing* ring = nullptr;
+
+	~ThreadRing()
+	{
+		if (ring)
+			ring->in_use = false;
+	}
+};
+
+static thread_local ThreadRing thread_ring;
+
+Logger& Logger::Get()
+{
+	static Logger logger;
+	return logger;
+}
+
+Logger::Logger()
+{
+	static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two!");
+
+	for (uint i = 0; i < LOG_MAX_THREADS; ++i)
+		rings[i] = nullptr;
+
+	ring_count = 0;
+	sequence = 0;
+	min_level = LOG_MIN_LEVEL;
+	category_mask = ~0u;
+	running = false;
+}
+
+Logger::~Logger()
+{
+	Stop();
+
+	for (uint i = 0; i < LOG_MAX_THREADS; ++i)
+		delete rings[i];
+}
+
+void Logger::Start()
+{
+	if (running)
+		return;
+
+	running = true;
+	sink = std::thread(&Logger::SinkLoop, this);
+}
+
+void Logger::Stop()
+{
+	if (!running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sink_mutex);
+		running = false;
+	}
+
+	sink_condition.notify_one();
+
+	if (sink.joinable())
+		sink.join();
+
+	// --- Anything logged while the sink was exiting ---
+	Drain();
+}
+
+void Logger::Write(LogLevel level, LogCategory category, const char* file, int line, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	WriteV(level, category, file, line, format, args);
+	va_end(args);
+}
+
+void Logger::WriteV(LogLevel level, LogCategory category, const char* file, int line, const char* format, va_list args)
+{
+	if ((int)level < min_level.load(std::memory_order_relaxed) || !(category_mask.load(std::memory_order_relaxed) & (1 << (uint)category)))
+		return;
+
+	LogRing* ring = GetThreadRing();
+	bool shared = ring == &shared_ring;
+
+	if (shared)
+		shared_mutex.lock();
+
+	LogEntry* entry = ring->Reserve();
+
+	// --- Ring is full, warnings and errors wait a bit for the sink, anything else is dropped ---
+	for (uint i = 0; !entry && level >= LogLevel::Warning && running && i < 100; ++i)
+	{
+		sink_condition.notify_one();
+		std::this_thread::yield();
+		entry = ring->Reserve();
+	}
+
+	if (entry)
+	{
+		entry->level = level;
+		entry->category = category;
+		entry->file = file;
+		entry->line = line;
+		vsnprintf(entry->text, LOG_ENTRY_SIZE, format, args);
+		entry->sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+		ring->Commit();
+	}
+	else
+		ring->dropped.fetch_add(1, std::memory_order_relaxed);
+
+	if (shared)
+		shared_mutex.unlock();
+
+	// --- No sink thread, flush right away. Otherwise only wake it up for errors or when the ring is filling ---
+	if (!running)
+		Drain();
+	else if (level >= LogLevel::Error || !entry || ring->HalfFull())
+		sink_condition.notify_one();
+}
+
+void Logger::SetMinLevel(LogLevel level)
+{
+	min_level = (int)level < LOG_MIN_LEVEL ? LOG_MIN_LEVEL : (int)level;
+}
+
+LogLevel Logger::GetMinLevel() const
+{
+	return (LogLevel)min_level.load();
+}
+
+void Logger::SetCategoryEnabled(LogCategory category, bool enabled)
+{
+	if (enabled)
+		category_mask.fetch_or(1 << (uint)category);
+	else
+		category_mask.fetch_and(~(1 << (uint)category));
+}
+
+bool Logger::IsCategoryEnabled(LogCategory category) const
+{
+	return category_mask.load() & (1 << (uint)category);
+}
+
+std::mutex& Logger::GetHistoryMutex()
+{
+	return history_mutex;
+}
+
+uint64 Logger::GetHistoryBegin() const
+{
+	return history_end - history_begin > LOG_HISTORY_SIZE ? history_end - LOG_HISTORY_SIZE : history_begin;
+}
+
+uint64 Logger::GetHistoryEnd() const
+{
+	return history_end;
+}
+
+const LogEntry& Logger::GetHistoryEntry(uint64 index) const
+{
+	return history[index % LOG_HISTORY_SIZE];
+}
+
+void Logger::ClearHistory()
+{
+	std::lock_guard<std::mutex> lock(history_mutex);
+	history_begin = history_end;
+}
+
+const char* Logger::GetLevelName(LogLevel level)
+{
+	static const char* names[] = { "Debug", "Info", "Warning", "Error" };
+	static_assert(sizeof(names) / sizeof(names[0]) == (uint)LogLevel::count, "Log level names need to be updated!");
+
+	return names[(uint)level];
+}
+
+const char* Logger::GetCategoryName(LogCategory category)
+{
+	static const char* names[] = { "General", "Render", "Resources", "Importers", "Scene", "Editor", "Jobs" };
+	static_assert(sizeof(names) / sizeof(names[0]) == (uint)LogCategory::count, "Log category names need to be updated!");
+
+	return names[(uint)category];
+}
+
+LogRing* Logger::GetThreadRing()
+{
+	if (thread_ring.ring)
+		return thread_ring.ring;
+
+	// --- First log from this thread, reuse the ring of a thread that exited or create a new one ---
+	std::lock_guard<std::mutex> lock(register_mutex);
+
+	for (uint i = 0; i < ring_count; ++i)
+	{
+		if (!rings[i]->in_use)
+		{
+			rings[i]->in_use = true;
+			thread_ring.ring = rings[i];
+			return rings[i];
+		}
+	}
+
+	if (ring_count < LOG_MAX_THREADS)
+	{
+		LogRing* ring = new LogRing;
+		ring->in_use = true;
+		rings[ring_count] = ring;
+		ring_count.fetch_add(1, std::memory_order_release);
+		thread_ring.ring = ring;
+		return ring;
+	}
+
+	// --- Out of rings, not cached so the thread gets a ring of its own once one is released ---
+	return &shared_ring;
+}
+
+void Logger::SinkLoop()
+{
+	OPTICK_THREAD("Log Sink");
+
+	while (running)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sink_mutex);
+			sink_condition.wait_for(lock, std::chrono::milliseconds(16));
+		}
+
+		Drain();
+	}
+}
+
+void Logger::Drain()
+{
+	std::lock_guard<std::mutex> drain_lock(drain_mutex);
+
+	pending.clear();
+
+	LogEntry entry;
+	uint count = ring_count.load(std::memory_order_acquire);
+
+	for (uint i = 0; i <= count; ++i)
+	{
+		LogRing* ring = i < count ? rings[i] : &shared_ring;
+
+		while (ring->Pop(entry))
+			pending.push_back(entry);
+
+		// --- Let the user know something went missing ---
+		uint dropped = ring->dropped.exchange(0);
+
+		if (dropped > 0)
+		{
+			entry.level = LogLevel::Warning;
+			entry.category = LogCategory::General;
+			entry.file = __FILE__;
+			entry.line = __LINE__;
+			entry.sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+			snprintf(entry.text, LOG_ENTRY_SIZE, "![Warning]: Logger dropped %u messages, log less or raise LOG_RING_SIZE", dropped);
+			pending.push_back(entry);
+		}
+	}
+
+	if (pending.empty())
+		return;
+
+	// --- Each ring is in order, interleave what this drain got by the order messages were written ---
+	std::sort(pending.begin(), pending.end(), [](const LogEntry& a, const LogEntry& b) { return a.sequence < b.sequence; });
+
+	for (uint i = 0; i < pending.size(); ++i)
+		Output(pending[i]);
+
+	std::lock_guard<std::mutex> lock(history_mutex);
+
+	for (uint i = 0; i < pending.size(); ++i)
+	{
+		history[history_end % LOG_HISTORY_SIZE] = pending[i];
+		history_end++;
+	}
+}
+
+void Logger::Output(const LogEntry& entry)
+{
+	static char tmp_string[MAX_BUF_SIZE];
+
+	sprintf_s(tmp_string, MAX_BUF_SIZE, "\n%s(%d) : %s", entry.file, entry.line, entry.text);
+	OutputDebugString(tmp_string);
+}
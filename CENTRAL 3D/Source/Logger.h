@@ -0,0 +1,165 @@
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <stdarg.h>
+
+#define LOG_ENTRY_SIZE 256 // Longer messages are truncated
+#define LOG_RING_SIZE 512 // Per thread, must be a power of two
+#define LOG_MAX_THREADS 32 // Threads past this share a locked ring
+#define LOG_HISTORY_SIZE 4096 // Entries kept for the console
+
+// --- Debug messages are compiled out of release builds ---
+#ifndef LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+#if LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(category, format, ...) Logger::Get().Write(LogLevel::Debug, category, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#else
+#define LOG_DEBUG(category, format, ...)
+#endif
+
+#define LOG_INFO(category, format, ...) Logger::Get().Write(LogLevel::Info, category, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#define LOG_WARNING(category, format, ...) Logger::Get().Write(LogLevel::Warning, category, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#define LOG_ERROR(category, format, ...) Logger::Get().Write(LogLevel::Error, category, __FILE__, __LINE__, format, ##__VA_ARGS__);
+
+enum class LogLevel
+{
+	Debug,
+	Info,
+	Warning,
+	Error,
+	count
+};
+
+enum class LogCategory
+{
+	General,
+	Render,
+	Resources,
+	Importers,
+	Scene,
+	Editor,
+	Jobs,
+	count
+};
+
+struct LogEntry
+{
+	LogLevel level = LogLevel::Info;
+	LogCategory category = LogCategory::General;
+	uint64 sequence = 0; // Global order, entries from different threads are sorted by it
+	const char* file = nullptr; // __FILE__, static storage
+	int line = 0;
+	char text[LOG_ENTRY_SIZE];
+};
+
+// --- Single producer (the owning thread), single consumer (the sink thread) ring ---
+class LogRing
+{
+public:
+
+	LogRing();
+
+	// --- Producer, fill the returned entry then Commit ---
+	LogEntry* Reserve();
+	void Commit();
+
+	// --- Consumer ---
+	bool Pop(LogEntry& entry);
+	bool Empty() const;
+	bool HalfFull() const;
+
+public:
+
+	std::atomic<bool> in_use;
+	std::atomic<uint> dropped;
+
+private:
+
+	LogEntry entries[LOG_RING_SIZE];
+	std::atomic<uint> head; // Consumer
+	std::atomic<uint> tail; // Producer
+};
+
+class Logger
+{
+public:
+
+	static Logger& Get();
+
+	// --- Sink thread, before Start and after Stop logs are flushed on the calling thread ---
+	void Start();
+	void Stop();
+
+	// --- Safe to call from any thread ---
+	void Write(LogLevel level, LogCategory category, const char* file, int line, const char* format, ...);
+	void WriteV(LogLevel level, LogCategory category, const char* file, int line, const char* format, va_list args);
+
+	// --- Runtime filters, messages not passing them are not even formatted ---
+	void SetMinLevel(LogLevel level);
+	LogLevel GetMinLevel() const;
+	void SetCategoryEnabled(LogCategory category, bool enabled);
+	bool IsCategoryEnabled(LogCategory category) const;
+
+	// --- History, lock GetHistoryMutex while reading entries ---
+	std::mutex& GetHistoryMutex();
+	uint64 GetHistoryBegin() const;
+	uint64 GetHistoryEnd() const;
+	const LogEntry& GetHistoryEntry(uint64 index) const;
+	void ClearHistory();
+
+	static const char* GetLevelName(LogLevel level);
+	static const char* GetCategoryName(LogCategory category);
+
+private:
+
+	Logger();
+	~Logger();
+
+	LogRing* GetThreadRing();
+	void SinkLoop();
+	void Drain();
+	void Output(const LogEntry& entry);
+
+private:
+
+	// --- Rings are handed out once per thread and reused when the thread exits ---
+	LogRing* rings[LOG_MAX_THREADS];
+	std::atomic<uint> ring_count;
+	std::mutex register_mutex;
+
+	// --- Shared by threads that did not get a ring of their own ---
+	LogRing shared_ring;
+	std::mutex shared_mutex;
+
+	std::atomic<uint64> sequence;
+	std::atomic<int> min_level;
+	std::atomic<uint> category_mask;
+
+	// --- Sink ---
+	std::thread sink;
+	std::mutex drain_mutex;
+	std::mutex sink_mutex;
+	std::condition_variable sink_condition;
+	std::atomic<bool> running;
+	std::vector<LogEntry> pending;
+
+	// --- Console history, a fixed ring indexed by absolute entry count ---
+	mutable std::mutex history_mutex;
+	LogEntry history[LOG_HISTORY_SIZE];
+	uint64 history_begin = 0;
+	uint64 history_end = 0;
+};
+
+#endif
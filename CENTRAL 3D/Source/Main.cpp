@@ -1,6 +1,10 @@
 #include <stdlib.h>
 #include "Application.h"
 #include "Globals.h"
+#include "Logger.h"
+#include "Allocator.h"
+#include "Profiler.h"
+#include "ScenarioRunner.h"
 #include "Optick/include/optick.h"
 
 #include "mmgr/mmgr.h"
@@ -20,8 +24,60 @@ enum main_states
 
 Application* App = NULL;
 
+// --- Command line ---
+// --- --scenario <name or file> [--out <file>]: runs a scenario from Settings/Scenarios headless and saves its results ---
+// --- --compare <base> <current> [--threshold <percent>]: compares two results, exits with an error on regression ---
+struct MainOptions
+{
+	const char* scenario = nullptr;
+	const char* out = SCENARIO_RESULTS_FILE;
+	const char* base = nullptr;
+	const char* current = nullptr;
+	float threshold = -1.0f;
+};
+
+static bool ParseOptions(int argc, char** argv, MainOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--scenario" && i + 1 < argc)
+			options.scenario = argv[++i];
+		else if (arg == "--out" && i + 1 < argc)
+			options.out = argv[++i];
+		else if (arg == "--compare" && i + 2 < argc)
+		{
+			options.base = argv[++i];
+			options.current = argv[++i];
+		}
+		else if (arg == "--threshold" && i + 1 < argc)
+			options.threshold = (float)atof(argv[++i]);
+		else
+		{
+			printf("Unknown option %s\n", argv[i]);
+			printf("Usage: --scenario <name or file> [--out <file>] | --compare <base> <current> [--threshold <percent>]\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 int main(int argc, char ** argv)
 {
+	MainOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+		return EXIT_FAILURE;
+
+	// --- Comparing needs no engine at all ---
+	if (options.base)
+		return ScenarioRunner::Compare(options.base, options.current, options.threshold) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	Logger::Get().Start();
+	PROFILE_THREAD("Main Thread");
+
 	CONSOLE_LOG("Starting app '%s'...", TITLE);
 
 	int main_return = EXIT_FAILURE;
@@ -37,6 +93,10 @@ int main(int argc, char ** argv)
 			CONSOLE_LOG("-------------- Application Creation --------------");
 			App = new Application();
 			state = MAIN_START;
+
+			if (options.scenario && !App->SetScenario(options.scenario))
+				state = MAIN_EXIT;
+
 			break;
 
 		case MAIN_START:
@@ -73,17 +133,20 @@ int main(int argc, char ** argv)
 			break;
 
 		case MAIN_FINISH:
+		{
+			// --- Results before CleanUp, modules are still alive ---
+			bool saved = !App->GetScenario() || (App->GetScenario()->Save(options.out) && App->GetScenario()->Passed());
 
 			CONSOLE_LOG("-------------- Application CleanUp --------------");
 			if (App->CleanUp() == false)
 			{
 				CONSOLE_LOG("|[error]: Application CleanUp exits with ERROR");
 			}
-			else
+			else if (saved)
 				main_return = EXIT_SUCCESS;
 
 			state = MAIN_EXIT;
-
+		}
 			break;
 
 		}
@@ -91,5 +154,13 @@ int main(int argc, char ** argv)
 	CONSOLE_LOG("Exiting app '%s'...\n", TITLE);
 
 	delete App;
+
+#if MEMORY_DEBUG
+	// --- Anything still on the engine heaps was never released ---
+	Memory::ReportLeaks();
+#endif
+
+	Logger::Get().Stop();
+
 	return main_return;
 }
\ No newline at end of file
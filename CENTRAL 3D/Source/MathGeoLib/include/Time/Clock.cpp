@@ -35,7 +35,9 @@
 #include <mach/mach_time.h>
 #endif
 
+#ifdef _WIN32
 #include "../Math/InclWindows.h" // LIBCHANGE
+#endif
 #include "Clock.h"
 #include "../Math/myassert.h"
 #include "../Math/assume.h"
@@ -0,0 +1,416 @@
+#include "MeshCodec.h"
+#include "Application.h"
+#include "ModuleJobs.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "mmgr/mmgr.h"
+
+#define MESH_CODEC_MAX_LITERALS 128 // Token values 0 to 127
+#define MESH_CODEC_MAX_RUN (127 + MESH_CODEC_MIN_RUN) // Token values 128 to 255
+#define MESH_CODEC_SLACK 16 // Bytes past the planes the run decoder may write, it copies in whole 16 byte blocks
+#define MESH_CODEC_MAX_SIMD_STRIDE 64 // Largest vertex the vectorized un-delta handles, bigger ones take the scalar loop
+
+// --- Chunk table, how many chunks there are and where each one ends, from the end of the table ---
+
+static size_t BeginTable(std::vector<unsigned char>& out, uint chunks)
+{
+	size_t table = out.size();
+	out.resize(table + sizeof(uint32) * (chunks + 1), 0);
+	memcpy(out.data() + table, &chunks, sizeof(uint32));
+
+	return table;
+}
+
+static void EndChunk(std::vector<unsigned char>& out, size_t table, uint chunk, uint chunks)
+{
+	uint32 end = (uint32)(out.size() - table - sizeof(uint32) * (chunks + 1));
+	memcpy(out.data() + table + sizeof(uint32) * (chunk + 1), &end, sizeof(uint32));
+}
+
+static bool ReadTable(const unsigned char* data, uint64 size, uint chunks, std::vector<uint64>& ends, const unsigned char*& payload)
+{
+	uint32 count = 0;
+	uint64 table_size = sizeof(uint32) * ((uint64)chunks + 1);
+
+	if (size < table_size)
+		return false;
+
+	memcpy(&count, data, sizeof(uint32));
+
+	if (count != chunks)
+		return false;
+
+	ends.resize(chunks);
+	uint64 previous = 0;
+
+	for (uint i = 0; i < chunks; ++i)
+	{
+		uint32 end = 0;
+		memcpy(&end, data + sizeof(uint32) * (i + 1), sizeof(uint32));
+
+		if (end < previous || end > size - table_size)
+			return false;
+
+		ends[i] = previous = end;
+	}
+
+	payload = data + table_size;
+
+	return true;
+}
+
+// --- Run length stage. A token under 128 is followed by token + 1 literals, any other by a byte repeated token - 128 + MIN_RUN times ---
+
+static void WriteLiterals(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+	while (size > 0)
+	{
+		size_t length = size < MESH_CODEC_MAX_LITERALS ? size : MESH_CODEC_MAX_LITERALS;
+		out.push_back((unsigned char)(length - 1));
+		out.insert(out.end(), data, data + length);
+		data += length;
+		size -= length;
+	}
+}
+
+static void EncodeRuns(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+	size_t literals = 0;
+	size_t i = 0;
+
+	while (i < size)
+	{
+		size_t run = 1;
+
+		while (i + run < size && run < MESH_CODEC_MAX_RUN && data[i + run] == data[i])
+			++run;
+
+		if (run >= MESH_CODEC_MIN_RUN)
+		{
+			WriteLiterals(data + literals, i - literals, out);
+			out.push_back((unsigned char)(128 + run - MESH_CODEC_MIN_RUN));
+			out.push_back(data[i]);
+			literals = i + run;
+		}
+
+		i += run;
+	}
+
+	WriteLiterals(data + literals, size - literals, out);
+}
+
+// --- out has MESH_CODEC_SLACK bytes past out_size. Tokens are short, fixed size copies beat a library call for each ---
+static bool DecodeRuns(const unsigned char* data, uint64 size, unsigned char* out, uint64 out_size)
+{
+	const unsigned char* end = data + size;
+	unsigned char* out_end = out + out_size;
+
+	while (out < out_end)
+	{
+		if (data >= end)
+			return false;
+
+		uint token = *data++;
+
+		if (token < 128)
+		{
+			uint64 length = token + 1;
+			uint64 blocks = (length + 15) & ~(uint64)15;
+
+			if (length > (uint64)(end - data) || length > (uint64)(out_end - out))
+				return false;
+
+			// --- Whole blocks when the input has them, the last token of a chunk is usually short of that ---
+			if (blocks <= (uint64)(end - data))
+			{
+				for (uint64 i = 0; i < blocks; i += 16)
+					memcpy(out + i, data + i, 16);
+			}
+			else
+				memcpy(out, data, (size_t)length);
+
+			data += length;
+			out += length;
+		}
+		else
+		{
+			uint64 length = token - 128 + MESH_CODEC_MIN_RUN;
+
+			if (data >= end || length > (uint64)(out_end - out))
+				return false;
+
+			unsigned char block[16];
+			memset(block, *data++, 16);
+
+			for (uint64 i = 0; i < length; i += 16)
+				memcpy(out + i, block, 16);
+
+			out += length;
+		}
+	}
+
+	return data == end;
+}
+
+// --- Undo the deltas along each plane while putting its bytes back in their vertices ---
+static void UndeltaPlanes(const unsigned char* planes, uint count, uint stride, unsigned char* vertices)
+{
+	uint first = 0;
+
+#ifdef MESH_CODEC_SSE2
+	// --- 16 vertices at a time. Each plane gets a prefix sum, then 4 planes are interleaved into a dword per vertex
+	// and 4x4 blocks of dwords are transposed so whole vertex rows are stored ---
+	if (stride % 4 == 0 && stride <= MESH_CODEC_MAX_SIMD_STRIDE)
+	{
+		uint groups = stride / 4;
+		__m128i carry[MESH_CODEC_MAX_SIMD_STRIDE];
+		__m128i sums[MESH_CODEC_MAX_SIMD_STRIDE];
+		__m128i words[MESH_CODEC_MAX_SIMD_STRIDE / 4][4];
+
+		for (uint byte = 0; byte < stride; ++byte)
+			carry[byte] = _mm_setzero_si128();
+
+		for (; first + 16 <= count; first += 16)
+		{
+			for (uint byte = 0; byte < stride; ++byte)
+			{
+				__m128i x = _mm_loadu_si128((const __m128i*)(planes + (size_t)byte * count + first));
+				x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+				x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+				x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+				x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+				x = _mm_add_epi8(x, carry[byte]);
+
+				// --- Last byte to every lane ---
+				__m128i last = _mm_unpackhi_epi8(x, x);
+				last = _mm_shufflehi_epi16(last, 0xFF);
+				carry[byte] = _mm_unpackhi_epi64(last, last);
+				sums[byte] = x;
+			}
+
+			for (uint group = 0; group < groups; ++group)
+			{
+				__m128i low = _mm_unpacklo_epi8(sums[group * 4], sums[group * 4 + 1]);
+				__m128i high = _mm_unpackhi_epi8(sums[group * 4], sums[group * 4 + 1]);
+				__m128i low2 = _mm_unpacklo_epi8(sums[group * 4 + 2], sums[group * 4 + 3]);
+				__m128i high2 = _mm_unpackhi_epi8(sums[group * 4 + 2], sums[group * 4 + 3]);
+
+				words[group][0] = _mm_unpacklo_epi16(low, low2);
+				words[group][1] = _mm_unpackhi_epi16(low, low2);
+				words[group][2] = _mm_unpacklo_epi16(high, high2);
+				words[group][3] = _mm_unpackhi_epi16(high, high2);
+			}
+
+			for (uint quad = 0; quad < 4; ++quad)
+			{
+				unsigned char* out = vertices + (size_t)(first + quad * 4) * stride;
+				uint group = 0;
+
+				for (; group + 4 <= groups; group += 4)
+				{
+					__m128i t0 = _mm_unpacklo_epi32(words[group][quad], words[group + 1][quad]);
+					__m128i t1 = _mm_unpackhi_epi32(words[group][quad], words[group + 1][quad]);
+					__m128i t2 = _mm_unpacklo_epi32(words[group + 2][quad], words[group + 3][quad]);
+					__m128i t3 = _mm_unpackhi_epi32(words[group + 2][quad], words[group + 3][quad]);
+
+					_mm_storeu_si128((__m128i*)(out + group * 4), _mm_unpacklo_epi64(t0, t2));
+					_mm_storeu_si128((__m128i*)(out + stride + group * 4), _mm_unpackhi_epi64(t0, t2));
+					_mm_storeu_si128((__m128i*)(out + stride * 2 + group * 4), _mm_unpacklo_epi64(t1, t3));
+					_mm_storeu_si128((__m128i*)(out + stride * 3 + group * 4), _mm_unpackhi_epi64(t1, t3));
+				}
+
+				for (; group < groups; ++group)
+				{
+					uint32 dwords[4];
+					_mm_storeu_si128((__m128i*)dwords, words[group][quad]);
+
+					for (uint vertex = 0; vertex < 4; ++vertex)
+						memcpy(out + stride * vertex + group * 4, &dwords[vertex], 4);
+				}
+			}
+		}
+	}
+#endif
+
+	// --- What is left, each plane carries on from the last vertex written ---
+	for (uint byte = 0; byte < stride; ++byte)
+	{
+		const unsigned char* plane = planes + (size_t)byte * count;
+		unsigned char* out = vertices + (size_t)first * stride + byte;
+		unsigned char value = first > 0 ? out[-(int)stride] : 0;
+
+		for (uint i = first; i < count; ++i, out += stride)
+		{
+			value += plane[i];
+			*out = value;
+		}
+	}
+}
+
+void MeshCodec::EncodeVertices(const void* vertices, uint count, uint stride, std::vector<unsigned char>& out)
+{
+	PROFILE_FUNCTION();
+
+	const unsigned char* source = (const unsigned char*)vertices;
+	uint chunks = (count + MESH_CODEC_CHUNK_VERTICES - 1) / MESH_CODEC_CHUNK_VERTICES;
+	size_t table = BeginTable(out, chunks);
+
+	std::vector<unsigned char> planes;
+
+	for (uint chunk = 0; chunk < chunks; ++chunk)
+	{
+		uint first = chunk * MESH_CODEC_CHUNK_VERTICES;
+		uint size = count - first < MESH_CODEC_CHUNK_VERTICES ? count - first : MESH_CODEC_CHUNK_VERTICES;
+		const unsigned char* chunk_vertices = source + (size_t)first * stride;
+
+		planes.resize((size_t)size * stride);
+
+		for (uint i = 0; i < size; ++i)
+		{
+			const unsigned char* vertex = chunk_vertices + (size_t)i * stride;
+
+			for (uint byte = 0; byte < stride; ++byte)
+				planes[(size_t)byte * size + i] = (unsigned char)(vertex[byte] - (i > 0 ? vertex[(int)byte - (int)stride] : 0));
+		}
+
+		EncodeRuns(planes.data(), planes.size(), out);
+		EndChunk(out, table, chunk, chunks);
+	}
+}
+
+bool MeshCodec::DecodeVertices(const unsigned char* data, uint64 size, void* vertices, uint count, uint stride)
+{
+	PROFILE_FUNCTION();
+
+	uint chunks = (count + MESH_CODEC_CHUNK_VERTICES - 1) / MESH_CODEC_CHUNK_VERTICES;
+	std::vector<uint64> ends;
+	const unsigned char* payload = nullptr;
+
+	if (!ReadTable(data, size, chunks, ends, payload))
+		return false;
+
+	unsigned char* target = (unsigned char*)vertices;
+	std::atomic<bool> failed(false);
+
+	App->jobs->ParallelFor(chunks, 1, [&](uint begin, uint end)
+	{
+		std::vector<unsigned char> planes;
+
+		for (uint chunk = begin; chunk < end && !failed; ++chunk)
+		{
+			uint first = chunk * MESH_CODEC_CHUNK_VERTICES;
+			uint chunk_size = count - first < MESH_CODEC_CHUNK_VERTICES ? count - first : MESH_CODEC_CHUNK_VERTICES;
+			uint64 chunk_begin = chunk > 0 ? ends[chunk - 1] : 0;
+
+			uint64 planes_size = (uint64)chunk_size * stride;
+			planes.resize((size_t)planes_size + MESH_CODEC_SLACK);
+
+			if (!DecodeRuns(payload + chunk_begin, ends[chunk] - chunk_begin, planes.data(), planes_size))
+			{
+				failed = true;
+				break;
+			}
+
+			UndeltaPlanes(planes.data(), chunk_size, stride, target + (size_t)first * stride);
+		}
+	});
+
+	return !failed;
+}
+
+void MeshCodec::EncodeIndices(const uint* indices, uint count, std::vector<unsigned char>& out)
+{
+	PROFILE_FUNCTION();
+
+	uint chunks = (count + MESH_CODEC_CHUNK_INDICES - 1) / MESH_CODEC_CHUNK_INDICES;
+	size_t table = BeginTable(out, chunks);
+
+	for (uint chunk = 0; chunk < chunks; ++chunk)
+	{
+		uint first = chunk * MESH_CODEC_CHUNK_INDICES;
+		uint size = count - first < MESH_CODEC_CHUNK_INDICES ? count - first : MESH_CODEC_CHUNK_INDICES;
+		uint previous = 0;
+
+		for (uint i = first; i < first + size; ++i)
+		{
+			int delta = (int)(indices[i] - previous);
+			uint value = ((uint)delta << 1) ^ (uint)(delta >> 31);
+			previous = indices[i];
+
+			while (value >= 0x80)
+			{
+				out.push_back((unsigned char)(value | 0x80));
+				value >>= 7;
+			}
+
+			out.push_back((unsigned char)value);
+		}
+
+		EndChunk(out, table, chunk, chunks);
+	}
+}
+
+bool MeshCodec::DecodeIndices(const unsigned char* data, uint64 size, uint* indices, uint count)
+{
+	PROFILE_FUNCTION();
+
+	uint chunks = (count + MESH_CODEC_CHUNK_INDICES - 1) / MESH_CODEC_CHUNK_INDICES;
+	std::vector<uint64> ends;
+	const unsigned char* payload = nullptr;
+
+	if (!ReadTable(data, size, chunks, ends, payload))
+		return false;
+
+	std::atomic<bool> failed(false);
+
+	App->jobs->ParallelFor(chunks, 1, [&](uint begin, uint end)
+	{
+		for (uint chunk = begin; chunk < end && !failed; ++chunk)
+		{
+			uint first = chunk * MESH_CODEC_CHUNK_INDICES;
+			uint chunk_size = count - first < MESH_CODEC_CHUNK_INDICES ? count - first : MESH_CODEC_CHUNK_INDICES;
+			const unsigned char* cursor = payload + (chunk > 0 ? ends[chunk - 1] : 0);
+			const unsigned char* chunk_end = payload + ends[chunk];
+			uint previous = 0;
+
+			for (uint i = first; i < first + chunk_size; ++i)
+			{
+				uint value = 0;
+				uint shift = 0;
+				unsigned char byte = 0;
+
+				do
+				{
+					if (cursor >= chunk_end || shift > 28)
+					{
+						failed = true;
+						return;
+					}
+
+					byte = *cursor++;
+					value |= (uint)(byte & 0x7F) << shift;
+					shift += 7;
+				} while (byte & 0x80);
+
+				previous += (value >> 1) ^ (0u - (value & 1));
+				indices[i] = previous;
+			}
+
+			if (cursor != chunk_end)
+			{
+				failed = true;
+				return;
+			}
+		}
+	});
+
+	return !failed;
+}
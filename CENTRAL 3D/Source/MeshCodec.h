@@ -0,0 +1,25 @@
+#ifndef __MESH_CODEC_H__
+#define __MESH_CODEC_H__
+
+#include "Globals.h"
+#include <vector>
+
+#define MESH_CODEC_CHUNK_VERTICES 16384 // Per chunk, chunks are coded on their own so they can be decoded in parallel
+#define MESH_CODEC_CHUNK_INDICES 49152 // Per chunk, a multiple of 3 so no triangle is split
+#define MESH_CODEC_MIN_RUN 3 // Shorter runs of a byte are cheaper as literals
+
+// --- Lossless coding of library mesh blocks. Both streams are a chunk table followed by the chunks ---
+// --- Decoding never reads or writes out of the given buffers, a damaged stream only makes it fail ---
+namespace MeshCodec
+{
+	// --- Every byte of a vertex in its own plane, delta coded against the previous vertex, then run length coded ---
+	// --- Exponents and sign bits barely change between neighbours, their planes end up as runs of zeros ---
+	void EncodeVertices(const void* vertices, uint count, uint stride, std::vector<unsigned char>& out);
+	bool DecodeVertices(const unsigned char* data, uint64 size, void* vertices, uint count, uint stride);
+
+	// --- Zigzag deltas of consecutive indices as variable length integers, neighbours are mostly 1 or 2 bytes ---
+	void EncodeIndices(const uint* indices, uint count, std::vector<unsigned char>& out);
+	bool DecodeIndices(const unsigned char* data, uint64 size, uint* indices, uint count);
+}
+
+#endif
@@ -1,9 +1,33 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "JSONLoader.h"
 
 struct Event;
+class Module;
+
+enum class ModuleThread
+{
+	Main = 0, // Owns the window and the GL context
+	Any
+};
+
+enum class ModulePhase
+{
+	Init = 0,
+	Start,
+	count
+};
+
+// --- How Application::Init runs a module's Init and Start, declared by Application's constructor ---
+struct ModuleStartup
+{
+	ModuleThread thread[(int)ModulePhase::count] = { ModuleThread::Main, ModuleThread::Main };
+	std::vector<Module*> after[(int)ModulePhase::count]; // Their same phase finishes first
+	double ms[(int)ModulePhase::count] = { 0.0, 0.0 };
+	bool on_worker[(int)ModulePhase::count] = { false, false }; // Where it actually ran
+};
 
 class Module
 {
@@ -35,6 +59,12 @@ public:
 		return UPDATE_CONTINUE;
 	}
 
+	// --- Fixed timestep simulation, zero or more times a frame. Render state blends with App->time->GetInterpolationAlpha() ---
+	virtual update_status FixedUpdate(float step)
+	{
+		return UPDATE_CONTINUE;
+	}
+
 	virtual update_status Update(float dt)
 	{
 		return UPDATE_CONTINUE;
@@ -54,6 +84,20 @@ public:
 
 	virtual void LoadStatus(const json & file) {}
 
+	const char* GetName() const
+	{
+		return name.c_str();
+	}
+
+	// --- Startup graph, main thread modules without dependencies run in list order ---
+	void SetStartup(ModulePhase phase, ModuleThread thread, const std::vector<Module*>& after = {})
+	{
+		startup.thread[(int)phase] = thread;
+		startup.after[(int)phase] = after;
+	}
+
+	ModuleStartup startup;
+
 protected:
 
 	std::string name = "Undefined";
@@ -22,6 +22,7 @@
 
 ModuleCamera3D::ModuleCamera3D(bool start_enabled) : Module(start_enabled)
 {
+	name = "Camera3D";
 }
 
 ModuleCamera3D::~ModuleCamera3D()
@@ -62,19 +63,28 @@ bool ModuleCamera3D::CleanUp()
 // -----------------------------------------------------------------
 update_status ModuleCamera3D::Update(float dt)
 {
-	if (App->GetAppState() == AppState::EDITOR && App->gui->panelScene->SceneHovered)
+	if (App->GetAppState() == AppState::EDITOR && HasInputFocus())
 	{
 		speed = 10.0f * dt;
 		if (App->input->GetKey(SDL_SCANCODE_LSHIFT) == KEY_REPEAT)
 			speed *= 2.0f;
 	}
 
+	// --- No scene panel to drive us when headless, recorded input moves the camera from here ---
+	if (App->IsHeadless() && App->input->IsPlayingBack())
+		UpdateCamera();
+
 	return UPDATE_CONTINUE;
 }
 
+bool ModuleCamera3D::HasInputFocus() const
+{
+	return App->gui->panelScene->SceneHovered || App->input->IsPlayingBack();
+}
+
 void ModuleCamera3D::UpdateCamera()
 {
-	if (App->GetAppState() == AppState::EDITOR && App->gui->panelScene->SceneHovered)
+	if (App->GetAppState() == AppState::EDITOR && HasInputFocus())
 	{
 		float3 newPos(0, 0, 0);
 
@@ -131,8 +141,15 @@ void ModuleCamera3D::OnMouseClick(const float mouse_x, const float mouse_y)
 	// MYTODO: Make this easy to understand / explain
 
 	// Scene window relative coords
-	float normalized_x = (mouse_x - App->gui->panelScene->posX) / App->gui->panelScene->width * (float)App->window->GetWindowWidth();
-	float normalized_y = (mouse_y - App->gui->panelScene->posY) / App->gui->panelScene->height * (float)App->window->GetWindowHeight();
+	float normalized_x = mouse_x;
+	float normalized_y = mouse_y;
+
+	// --- Headless runs have no scene panel, the window stands in for it ---
+	if (!App->IsHeadless())
+	{
+		normalized_x = (mouse_x - App->gui->panelScene->posX) / App->gui->panelScene->width * (float)App->window->GetWindowWidth();
+		normalized_y = (mouse_y - App->gui->panelScene->posY) / App->gui->panelScene->height * (float)App->window->GetWindowHeight();
+	}
 
 	// mouse pos in range -1 - 1
 	normalized_x = ((normalized_x / (float)App->window->GetWindowWidth()) - 0.5) * 2;
@@ -24,6 +24,7 @@ public:
 	void OnMouseClick(const float mouse_x, const float mouse_y);
 
 private:
+	bool HasInputFocus() const;
 	void CameraPan(float speed);
 	void CameraZoom(float speed);
 	void CameraLookAround(float speed, float3 reference);
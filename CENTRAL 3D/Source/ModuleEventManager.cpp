@@ -1,13 +1,102 @@
 #include "ModuleEventManager.h"
+#include "Application.h"
+#include "ModuleJobs.h"
+#include <thread>
 
 #include "mmgr/mmgr.h"
 
+// ----------------------------------------------------------------------------------------------------------
+// --- Event ---
+
+uint64 Event::GetKey() const
+{
+	switch (type)
+	{
+	case EventType::GameObject_selected:
+		return (uint64)go;
+
+	case EventType::Resource_selected:
+		return (uint64)resource;
+
+	case EventType::GameObject_destroyed:
+	case EventType::Resource_destroyed:
+	case EventType::Resource_loaded:
+		return uid;
+
+	default:
+		return 0;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- EventQueue ---
+
+EventQueue::EventQueue()
+{
+	static_assert((EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) == 0, "EVENT_QUEUE_SIZE must be a power of two!");
+
+	for (uint i = 0; i < EVENT_QUEUE_SIZE; ++i)
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+
+	enqueue_pos.store(0, std::memory_order_relaxed);
+}
+
+bool EventQueue::Push(const Event& event)
+{
+	uint pos = enqueue_pos.load(std::memory_order_relaxed);
+	Cell* cell = nullptr;
+
+	while (true)
+	{
+		cell = &cells[pos & (EVENT_QUEUE_SIZE - 1)];
+		uint sequence = cell->sequence.load(std::memory_order_acquire);
+		int diff = (int)(sequence - pos);
+
+		// --- Cell is free, try to claim it ---
+		if (diff == 0)
+		{
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		// --- Consumer did not get here yet, queue is full ---
+		else if (diff < 0)
+			return false;
+		// --- Another producer took it, retry with the new position ---
+		else
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+	}
+
+	cell->event = event;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool EventQueue::Pop(Event& event)
+{
+	Cell* cell = &cells[dequeue_pos & (EVENT_QUEUE_SIZE - 1)];
+	uint sequence = cell->sequence.load(std::memory_order_acquire);
+
+	// --- Empty, or the producer that claimed the cell is still writing ---
+	if ((int)(sequence - (dequeue_pos + 1)) < 0)
+		return false;
+
+	event = cell->event;
+	cell->sequence.store(dequeue_pos + EVENT_QUEUE_SIZE, std::memory_order_release);
+	dequeue_pos++;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- ModuleEventManager ---
+
 ModuleEventManager::ModuleEventManager(bool start_enabled)
 {
+	name = "Event Manager";
 	static_assert(static_cast<int>(Event::EventType::invalid) == EVENT_TYPES-1, "EVENT_TYPES macro needs to be updated!");
 
-	head = 0;
-	tail = 0;
+	overflowed = false;
 }
 
 ModuleEventManager::~ModuleEventManager()
@@ -16,7 +105,7 @@ ModuleEventManager::~ModuleEventManager()
 
 bool ModuleEventManager::Init(json file)
 {
-
+	batch.reserve(EVENT_QUEUE_SIZE);
 
 	return true;
 }
@@ -28,24 +117,70 @@ bool ModuleEventManager::Start()
 
 update_status ModuleEventManager::PreUpdate(float dt)
 {
-	while (head != tail)
+	// --- Grab everything pushed until now, events pushed by listeners are handled next frame ---
+	batch.clear();
+
+	Event event;
+
+	while (queue.Pop(event))
+		batch.push_back(event);
+
+	if (overflowed.load())
 	{
-		// Process events
+		std::lock_guard<std::mutex> lock(overflow_mutex);
+		batch.insert(batch.end(), overflow.begin(), overflow.end());
+		overflow.clear();
+		overflowed = false;
+	}
 
-		int EventType = static_cast<int>(events[head].type);
+	Coalesce(batch);
+
+	// --- Process events ---
+	for (uint i = 0; i < batch.size(); ++i)
+	{
+		if (batch[i].type == Event::EventType::invalid)
+			continue;
+
+		int EventType = static_cast<int>(batch[i].type);
 
 		for (std::vector<Function>::iterator it = listeners[EventType].listeners.begin(); it != listeners[EventType].listeners.end(); ++it)
 		{
 			// MYTODO: check if we can call the function first, delete listener if it is inaccessible
-			(*it)(events[head]);
+			(*it)(batch[i]);
 		}
-
-		head = (head + 1) % MAX_EVENTS;
 	}
 
 	return update_status::UPDATE_CONTINUE;
 }
 
+const std::vector<Event>& ModuleEventManager::GetDispatchedEvents() const
+{
+	return batch;
+}
+
+const char* ModuleEventManager::GetTypeName(Event::EventType type)
+{
+	switch (type)
+	{
+	case Event::EventType::GameObject_destroyed:
+		return "GameObject_destroyed";
+	case Event::EventType::GameObject_selected:
+		return "GameObject_selected";
+	case Event::EventType::Resource_selected:
+		return "Resource_selected";
+	case Event::EventType::Resource_destroyed:
+		return "Resource_destroyed";
+	case Event::EventType::Window_resize:
+		return "Window_resize";
+	case Event::EventType::File_dropped:
+		return "File_dropped";
+	case Event::EventType::Resource_loaded:
+		return "Resource_loaded";
+	default:
+		return "invalid";
+	}
+}
+
 bool ModuleEventManager::CleanUp()
 {
 	for (uint i = 0; i < EVENT_TYPES; ++i)
@@ -56,11 +191,23 @@ bool ModuleEventManager::CleanUp()
 	return true;
 }
 
-void ModuleEventManager::PushEvent(Event& new_event)
+void ModuleEventManager::PushEvent(const Event& new_event)
 {
-	// --- Add given event to the end of the list ---
-	events[tail] = new_event;
-	tail = (tail + 1) % MAX_EVENTS;
+	// --- Add given event to the end of the queue, other threads retry a bit if full before falling back to the locked list ---
+	// --- The main thread is the only consumer, waiting on itself would be pointless ---
+	uint retries = App->jobs->IsMainThread() ? 1 : 64;
+
+	for (uint i = 0; i < retries; ++i)
+	{
+		if (queue.Push(new_event))
+			return;
+
+		std::this_thread::yield();
+	}
+
+	std::lock_guard<std::mutex> lock(overflow_mutex);
+	overflow.push_back(new_event);
+	overflowed = true;
 }
 
 void ModuleEventManager::AddListener(Event::EventType type, Function callback)
@@ -94,3 +241,29 @@ void ModuleEventManager::RemoveListener(Event::EventType type, Function callback
 		}
 	}
 }
+
+void ModuleEventManager::Coalesce(std::vector<Event>& events)
+{
+	for (uint i = 0; i < EVENT_TYPES; ++i)
+		coalesce_keys[i].clear();
+
+	// --- Walk backwards so the last event of each type/key pair is the one kept, the rest are invalidated ---
+	for (int i = (int)events.size() - 1; i >= 0; --i)
+	{
+		switch (events[i].type)
+		{
+		case Event::EventType::GameObject_destroyed:
+		case Event::EventType::Resource_destroyed:
+		case Event::EventType::Resource_loaded:
+		case Event::EventType::Window_resize:
+			break;
+
+		default:
+			continue;
+		}
+
+		// --- insert fails if the key was already seen ---
+		if (!coalesce_keys[static_cast<int>(events[i].type)].insert(events[i].GetKey()).second)
+			events[i].type = Event::EventType::invalid;
+	}
+}
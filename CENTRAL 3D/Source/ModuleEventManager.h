@@ -3,9 +3,13 @@
 
 #include "Module.h"
 #include "Globals.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
 
-#define MAX_EVENTS 1000
-#define EVENT_TYPES 7
+#define EVENT_QUEUE_SIZE 4096 // Must be a power of two
+#define EVENT_TYPES 8
 
 typedef void (*Function)(const Event & e);
 
@@ -23,18 +27,28 @@ struct Event
 		Resource_destroyed,
 		Window_resize,
 		File_dropped,
+		Resource_loaded, // Imported by a scan, loaded into memory or streamed more texture levels
 		invalid
-	} type = EventType::invalid;	
+	} type = EventType::invalid;
 
+	// --- Payload, which member is valid depends on type ---
 	union
 	{
-		GameObject* go = nullptr;
-		Resource* resource;
-		uint uid; // For overwrite case
+		GameObject* go = nullptr; // GameObject_selected
+		Resource* resource; // Resource_selected
+		uint uid; // GameObject_destroyed, Resource_destroyed, Resource_loaded (safe to post from any thread, and never reused like a freed address)
+		struct
+		{
+			int width;
+			int height;
+		} window; // Window_resize
 	};
 
 	Event(EventType type) : type(type) {}
 	Event() {}
+
+	// --- Identifies what the event is about, used to coalesce duplicates ---
+	uint64 GetKey() const;
 };
 
 struct Listeners
@@ -42,6 +56,29 @@ struct Listeners
 	std::vector<Function> listeners;
 };
 
+// --- Bounded multi-producer single-consumer ring, each cell carries a sequence number so producers never lock ---
+class EventQueue
+{
+public:
+
+	EventQueue();
+
+	bool Push(const Event& event);
+	bool Pop(Event& event);
+
+private:
+
+	struct Cell
+	{
+		std::atomic<uint> sequence;
+		Event event;
+	};
+
+	Cell cells[EVENT_QUEUE_SIZE];
+	std::atomic<uint> enqueue_pos;
+	uint dequeue_pos = 0; // Consumer only
+};
+
 class ModuleEventManager : public Module
 {
 public:
@@ -55,16 +92,31 @@ public:
 	update_status PreUpdate(float dt) override;
 	bool CleanUp() override;
 
-	void PushEvent(Event& new_event);
+	// --- Safe to call from any thread, listeners are called on the main thread at PreUpdate ---
+	void PushEvent(const Event& new_event);
+
+	// --- Main thread only ---
 	void AddListener(Event::EventType type, Function callback);
 	void RemoveListener(Event::EventType type, Function callback);
+	const std::vector<Event>& GetDispatchedEvents() const; // Handled at the last PreUpdate, coalesced ones are invalid
+
+	static const char* GetTypeName(Event::EventType type);
+
+private:
+	void Coalesce(std::vector<Event>& events);
 
 private:
-	Event events[MAX_EVENTS];
+	EventQueue queue;
 	Listeners listeners[EVENT_TYPES];
 
-	uint head;
-	uint tail;
+	// --- Events that did not fit in the queue, rare so a lock is fine ---
+	std::mutex overflow_mutex;
+	std::vector<Event> overflow;
+	std::atomic<bool> overflowed;
+
+	// --- Reused every frame ---
+	std::vector<Event> batch;
+	std::unordered_set<uint64> coalesce_keys[EVENT_TYPES];
 };
 
-#endif
\ No newline at end of file
+#endif
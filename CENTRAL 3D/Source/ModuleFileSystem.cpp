@@ -1,8 +1,23 @@
 #include <fstream>
 #include "Globals.h"
+#include "Logger.h"
 #include "Application.h"
 #include "ModuleFileSystem.h"
 #include "ModuleResourceManager.h"
+#include "FrameScheduler.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <atomic>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "PhysFS/include/physfs.h"
 #include "Assimp/include/cfileio.h"
@@ -12,6 +27,9 @@
 
 #include "mmgr/mmgr.h"
 
+#define FS_TEMP_EXTENSION ".tmp" // Whole file saves are written here first, then moved over the old file
+#define FS_REPLACED_EXTENSION ".old" // Windows only, where a still mapped file is moved aside to
+
 
 using namespace std;
 
@@ -94,54 +112,33 @@ bool ModuleFileSystem::Init(json config)
 
 update_status ModuleFileSystem::PreUpdate(float dt)
 {
-	// Wait for notification.
+	// --- Changes come in bursts, saving a file from another program touches it a few times. React once they settle ---
+	uint count = watched_events.size();
+	watcher.Poll(watched_events);
 
-	dwWaitStatus = WaitForMultipleObjects(1, dwChangeHandles,
-		FALSE, 0);
-
-	switch (dwWaitStatus)
+	if (watched_events.size() > count)
 	{
-		case WAIT_OBJECT_0:
-			started_wait = true;
-			wait_timer.Start();
-
-			if (FindNextChangeNotification(dwChangeHandles[0]) == FALSE)
-			{
-				CONSOLE_LOG("ERROR: FindNextChangeNotification function failed.");
-				FindCloseChangeNotification(dwChangeHandles[0]);
-				CONSOLE_LOG("%i", GetLastError());
-			}
-
-		break;
-
-		case WAIT_TIMEOUT:
-
-			// --- When the changes on watched directory are completed, react ---
-			if (started_wait && wait_timer.Read() > wait_time)
-			{
-				// A file was created, renamed, or deleted in the directory.
-				// Refresh this directory and restart the notification.
-				
-				// A directory was created, renamed, or deleted.
-				// Refresh the tree and restart the notification.
+		started_wait = true;
+		wait_timer.Start();
+	}
 
-				CONSOLE_LOG("Importing files... Rebuilding links...");
+	if (started_wait && wait_timer.Read() > wait_time)
+	{
+		LOG_INFO(LogCategory::Resources, "Importing files... Rebuilding links...");
 
-				App->resources->HandleFsChanges();			
+		CoalesceEvents(watched_events);
 
-				started_wait = false;
-			}
+		{
+			std::lock_guard<std::mutex> lock(events_mutex);
+			settled_events.insert(settled_events.end(), watched_events.begin(), watched_events.end());
+		}
 
-			// A timeout occurred, this would happen if some value other 
-			// than INFINITE is used in the Wait call and no changes occur.
-			// In a single-threaded environment you might not want an
-			// INFINITE wait.
+		watched_events.clear();
 
-		break;
+		// --- Changes settling meanwhile are picked up by the same pass ---
+		FrameScheduler::Get().Schedule("Handle FS Changes", DeferredPriority::Low, [](const DeferredSlice& slice) { App->resources->HandleFsEvents(); return true; }, true);
 
-		default:
-			 CONSOLE_LOG("ERROR: Unhandled dwWaitStatus.");
-		break;
+		started_wait = false;
 	}
 
 	return update_status::UPDATE_CONTINUE;
@@ -152,6 +149,8 @@ bool ModuleFileSystem::CleanUp()
 {
 	//LOG("Freeing File System subsystem");
 
+	watcher.Stop();
+
 	return true;
 }
 
@@ -173,6 +172,13 @@ bool ModuleFileSystem::AddPath(const char* path_or_zip)
 // Check if a file exists
 bool ModuleFileSystem::Exists(const char* file) const
 {
+	{
+		std::lock_guard<std::mutex> lock(known_mutex);
+
+		if (!known_files.empty() && known_files.find(file) != known_files.end())
+			return true;
+	}
+
 	return PHYSFS_exists(file) != 0;
 }
 
@@ -256,7 +262,7 @@ bool ModuleFileSystem::CopyFromOutsideFS(const char * full_path, const char * de
 		PHYSFS_close(dest);
 		ret = true;
 
-		CONSOLE_LOG("File System copied file [%s] to [%s]", full_path, destination);
+		LOG_DEBUG(LogCategory::General, "File System copied file [%s] to [%s]", full_path, destination);
 	}
 	else
 		CONSOLE_LOG("File System error while copy from [%s] to [%s]", full_path, destination);
@@ -283,7 +289,7 @@ bool ModuleFileSystem::Copy(const char * source, const char * destination)
 		PHYSFS_close(dst);
 		ret = true;
 
-		CONSOLE_LOG("File System copied file [%s] to [%s]", source, destination);
+		LOG_DEBUG(LogCategory::General, "File System copied file [%s] to [%s]", source, destination);
 	}
 	else
 		CONSOLE_LOG("File System error while copy from [%s] to [%s]", source, destination);
@@ -362,35 +368,211 @@ uint ModuleFileSystem::GetLastModificationTime(const char * file)
 	return PHYSFS_getLastModTime(file);
 }
 
+bool ModuleFileSystem::GetFileStat(const char* file, uint64& modification_time, uint64& size) const
+{
+	// --- Straight to the OS, PhysFS would stat once for the date and open the file for its size ---
+	const char* real_dir = PHYSFS_getRealDir(file);
+
+	if (real_dir == nullptr)
+		return false;
+
+	string real_path = real_dir;
+	real_path.append("/");
+	real_path.append(file);
+
+#ifdef _WIN32
+	struct _stat64 info;
+
+	if (_stat64(real_path.c_str(), &info) != 0)
+		return false;
+#else
+	struct stat info;
+
+	if (stat(real_path.c_str(), &info) != 0)
+		return false;
+#endif
+
+	modification_time = (uint64)info.st_mtime;
+	size = (uint64)info.st_size;
+
+	return true;
+}
+
+void ModuleFileSystem::SetKnownFiles(std::unordered_set<std::string>& files)
+{
+	std::lock_guard<std::mutex> lock(known_mutex);
+	known_files.swap(files);
+}
+
+void ModuleFileSystem::ClearKnownFiles()
+{
+	std::lock_guard<std::mutex> lock(known_mutex);
+	known_files.clear();
+}
+
 void ModuleFileSystem::WatchDirectory(const char* directory)
 {
-	// Watch the directory for file creation and deletion. 
-	// Watch the subtree for directory creation and deletion. 
+	watcher.Watch(directory);
+}
+
+void ModuleFileSystem::TakeFileEvents(std::vector<FileEvent>& events)
+{
+	{
+		std::lock_guard<std::mutex> lock(events_mutex);
+		events.swap(settled_events);
+		settled_events.clear();
+	}
+
+	// --- Batches that settled before the last one was handled may touch the same paths ---
+	CoalesceEvents(events);
+
+	for (uint i = 0; i < events.size(); ++i)
+	{
+		FileEvent& event = events[i];
+
+		if (event.type == FileEventType::Deleted || event.type == FileEventType::Rescan)
+			continue;
+
+		event.time = event.size = 0;
+
+		if (GetFileStat(event.path.c_str(), event.time, event.size))
+			event.directory = event.directory || IsDirectory(event.path.c_str());
+	}
+}
+
+void ModuleFileSystem::CoalesceEvents(std::vector<FileEvent>& events) const
+{
+	std::vector<FileEvent> result;
+	std::vector<bool> dropped;
+	std::map<std::string, uint> latest; // Path to its event in result
+
+	for (uint i = 0; i < events.size(); ++i)
+	{
+		FileEvent event = events[i];
+
+		// --- Anything may have changed, the rest tells nothing more ---
+		if (event.type == FileEventType::Rescan)
+		{
+			events.clear();
+			events.push_back(event);
+			return;
+		}
+
+		// --- Renaming something that only appeared in this batch is creating it under the new name ---
+		if (event.type == FileEventType::Renamed)
+		{
+			std::map<std::string, uint>::iterator from = latest.find(event.old_path);
+
+			if (from != latest.end())
+			{
+				FileEvent& previous = result[from->second];
+
+				if (previous.type == FileEventType::Created)
+				{
+					dropped[from->second] = true;
+					latest.erase(from);
+					event.type = FileEventType::Created;
+					event.directory = event.directory || previous.directory;
+					event.old_path.clear();
+				}
+				else if (previous.type == FileEventType::Renamed)
+				{
+					event.old_path = previous.old_path;
+					dropped[from->second] = true;
+					latest.erase(from);
+				}
+			}
+		}
+
+		std::map<std::string, uint>::iterator it = latest.find(event.path);
+
+		if (it == latest.end())
+		{
+			latest[event.path] = result.size();
+			result.push_back(event);
+			dropped.push_back(false);
+			continue;
+		}
+
+		FileEvent& previous = result[it->second];
+		previous.directory = previous.directory || event.directory;
+
+		switch (event.type)
+		{
+		case FileEventType::Created:
+		case FileEventType::Modified:
+			// --- Deleted and created again is an overwrite, anything else keeps what it was ---
+			if (previous.type == FileEventType::Deleted)
+				previous.type = FileEventType::Modified;
+			break;
+
+		case FileEventType::Deleted:
+			if (previous.type == FileEventType::Created)
+			{
+				dropped[it->second] = true;
+				latest.erase(it);
+			}
+			else if (previous.type == FileEventType::Renamed)
+			{
+				// --- What was there before the rename is what is gone ---
+				previous.type = FileEventType::Deleted;
+				previous.path = previous.old_path;
+				previous.old_path.clear();
+				latest.erase(it);
+				latest[previous.path] = it->second;
+			}
+			else
+				previous.type = FileEventType::Deleted;
+			break;
 
-	dwChangeHandles[0] = FindFirstChangeNotification(
-		directory,                       // directory to watch 
-		TRUE,                          // watch the subtree 
-		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME 
-		| FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_LAST_WRITE
-		| FILE_NOTIFY_CHANGE_SIZE
-	);
+		case FileEventType::Renamed:
+			// --- Moved over something, the target is replaced ---
+			dropped[it->second] = true;
+			latest[event.path] = result.size();
+			result.push_back(event);
+			dropped.push_back(false);
+			break;
 
-	if (dwChangeHandles[0] == INVALID_HANDLE_VALUE)
+		default:
+			break;
+		}
+	}
+
+	events.clear();
+
+	for (uint i = 0; i < result.size(); ++i)
 	{
-		CONSOLE_LOG("ERROR: FindFirstChangeNotification function failed.");
-		FindCloseChangeNotification(dwChangeHandles[0]);
-		CONSOLE_LOG("%i", GetLastError());
+		if (!dropped[i])
+			events.push_back(result[i]);
 	}
+}
 
-	// Make a final validation check on our handles.
+uint64 ModuleFileSystem::Hash(const char* data, uint64 size) const
+{
+	// --- FNV-1a ---
+	uint64 hash = 14695981039346656037ULL;
 
-	if ((dwChangeHandles[0] == NULL) )
+	for (uint64 i = 0; i < size; ++i)
 	{
-		CONSOLE_LOG("ERROR: Unexpected NULL from FindFirstChangeNotification.");
-		FindCloseChangeNotification(dwChangeHandles[0]);
-		CONSOLE_LOG("%i", GetLastError());
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
 	}
 
+	return hash;
+}
+
+uint64 ModuleFileSystem::HashFile(const char* file) const
+{
+	char* buffer = nullptr;
+	uint size = Load(file, &buffer);
+
+	if (buffer == nullptr)
+		return 0;
+
+	uint64 hash = Hash(buffer, size);
+	delete[] buffer;
+
+	return hash;
 }
 
 
@@ -440,6 +622,101 @@ uint ModuleFileSystem::Load(const char* file, char** buffer) const
 	return ret;
 }
 
+bool ModuleFileSystem::MapFile(const char* file, MappedFile& mapped) const
+{
+	mapped = MappedFile();
+
+	const char* real_dir = PHYSFS_getRealDir(file);
+
+	if (real_dir == nullptr)
+		return false;
+
+	string real_path = real_dir;
+	real_path.append("/");
+	real_path.append(file);
+
+#ifdef _WIN32
+	// --- Sharing delete lets a save move the file aside while it is still mapped, see MoveIntoPlace ---
+	HANDLE handle = CreateFileA(real_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+
+	if (GetFileSizeEx(handle, &size) == 0 || size.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (view == nullptr)
+	{
+		CONSOLE_LOG("|[error]: File System: could not map %s: %i", file, GetLastError());
+
+		if (mapping)
+			CloseHandle(mapping);
+
+		CloseHandle(handle);
+		return false;
+	}
+
+	mapped.data = (const char*)view;
+	mapped.size = (uint64)size.QuadPart;
+	mapped.file = handle;
+	mapped.mapping = mapping;
+#else
+	int handle = ::open(real_path.c_str(), O_RDONLY);
+
+	if (handle < 0)
+		return false;
+
+	struct stat info;
+
+	if (fstat(handle, &info) != 0 || info.st_size == 0)
+	{
+		::close(handle);
+		return false;
+	}
+
+	// --- The mapping outlives the descriptor ---
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+	::close(handle);
+
+	if (view == MAP_FAILED)
+	{
+		CONSOLE_LOG("|[error]: File System: could not map %s: %s", file, strerror(errno));
+		return false;
+	}
+
+	mapped.data = (const char*)view;
+	mapped.size = (uint64)info.st_size;
+	mapped.mapping = view;
+#endif
+
+	return true;
+}
+
+void ModuleFileSystem::UnmapFile(MappedFile& mapped) const
+{
+#ifdef _WIN32
+	if (mapped.mapping)
+	{
+		UnmapViewOfFile(mapped.data);
+		CloseHandle(mapped.mapping);
+		CloseHandle(mapped.file);
+	}
+#else
+	if (mapped.mapping)
+		munmap(mapped.mapping, (size_t)mapped.size);
+#endif
+
+	mapped = MappedFile();
+}
+
 // Read a whole file and put it in a new buffer
 SDL_RWops* ModuleFileSystem::Load(const char* file) const
 {
@@ -477,7 +754,14 @@ uint ModuleFileSystem::Save(const char* file, const void* buffer, unsigned int s
 	unsigned int ret = 0;
 
 	bool overwrite = PHYSFS_exists(file) != 0;
-	PHYSFS_file* fs_file = (append) ? PHYSFS_openAppend(file) : PHYSFS_openWrite(file);
+
+	// --- Whole files are written next to the old one and then replace it, readers may have the old one mapped ---
+	string temp_file = file;
+
+	if (!append)
+		temp_file.append(FS_TEMP_EXTENSION);
+
+	PHYSFS_file* fs_file = (append) ? PHYSFS_openAppend(file) : PHYSFS_openWrite(temp_file.c_str());
 
 	if (fs_file != nullptr)
 	{
@@ -492,19 +776,33 @@ uint ModuleFileSystem::Save(const char* file, const void* buffer, unsigned int s
 		{
 			if (append == true)
 			{
-				CONSOLE_LOG("Added %u data to [%s%s]", size, PHYSFS_getWriteDir(), file);
+				LOG_DEBUG(LogCategory::General, "Added %u data to [%s%s]", size, PHYSFS_getWriteDir(), file);
 			}
 			//else if(overwrite == true)
 				//LOG("File [%s%s] overwritten with %u bytes", PHYSFS_getWriteDir(), file, size);
 
 			else if (overwrite == false)
-				CONSOLE_LOG("New file created [%s%s] of %u bytes", PHYSFS_getWriteDir(), file, size);
+				LOG_DEBUG(LogCategory::General, "New file created [%s%s] of %u bytes", PHYSFS_getWriteDir(), file, size);
 
 			ret = written;
 		}
 
 		if (PHYSFS_close(fs_file) == 0)
+		{
 			CONSOLE_LOG("File System error while closing file %s: %s", file, PHYSFS_getLastError());
+
+			if (!append)
+				ret = 0;
+		}
+
+		if (!append)
+		{
+			if (written != size || ret != written || !MoveIntoPlace(temp_file.c_str(), file))
+			{
+				PHYSFS_delete(temp_file.c_str());
+				ret = 0;
+			}
+		}
 	}
 	else
 		CONSOLE_LOG("File System error while opening file %s: %s", file, PHYSFS_getLastError());
@@ -512,6 +810,48 @@ uint ModuleFileSystem::Save(const char* file, const void* buffer, unsigned int s
 	return ret;
 }
 
+bool ModuleFileSystem::MoveIntoPlace(const char* temp_file, const char* file) const
+{
+	string write_dir = PHYSFS_getWriteDir();
+	write_dir.append("/");
+
+	string from = write_dir + temp_file;
+	string to = write_dir + file;
+
+#ifdef _WIN32
+	if (MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING))
+		return true;
+
+	// --- A reader still has the old file mapped. It shares delete so it can be renamed: move it aside, 
+	// put the new one in its place and delete the old one, which goes away once the last reader unmaps it ---
+	static std::atomic<uint> replaced_count(0);
+
+	string aside = to + FS_REPLACED_EXTENSION + std::to_string(replaced_count.fetch_add(1));
+
+	if (MoveFileExA(to.c_str(), aside.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		if (MoveFileExA(from.c_str(), to.c_str(), 0))
+		{
+			DeleteFileA(aside.c_str());
+			return true;
+		}
+
+		// --- Put the old one back rather than leave nothing ---
+		MoveFileExA(aside.c_str(), to.c_str(), 0);
+	}
+
+	CONSOLE_LOG("|[error]: File System: could not replace %s: %i", file, GetLastError());
+	return false;
+#else
+	// --- Atomic, mappings of the old file keep its contents until they are unmapped ---
+	if (rename(from.c_str(), to.c_str()) == 0)
+		return true;
+
+	CONSOLE_LOG("|[error]: File System: could not replace %s: %s", file, strerror(errno));
+	return false;
+#endif
+}
+
 //bool ModuleFileSystem::SaveUnique(string& name, const void * buffer, uint size, const char * path, const char * prefix, const char * extension)
 //{
 //	char result[250];
@@ -532,9 +872,14 @@ bool ModuleFileSystem::Remove(const char * file)
 
 	if (file != nullptr)
 	{
+		{
+			std::lock_guard<std::mutex> lock(known_mutex);
+			known_files.erase(file);
+		}
+
 		if (PHYSFS_delete(file) != 0)
 		{
-			CONSOLE_LOG("File deleted: [%s]", file);
+			LOG_DEBUG(LogCategory::General, "File deleted: [%s]", file);
 			ret = true;
 		}
 		else
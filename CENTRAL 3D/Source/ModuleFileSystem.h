@@ -2,13 +2,27 @@
 #define __MODULEFILESYSTEM_H__
 
 #include "Module.h"
+#include "Timer.h"
+#include "FileWatcher.h"
 #include <vector>
+#include <mutex>
+#include <unordered_set>
 
 struct SDL_RWops;
 int close_sdl_rwops(SDL_RWops *rw);
 
 struct aiFileIO;
 
+// --- Read only view of a whole file, mapped by the OS ---
+struct MappedFile
+{
+	const char* data = nullptr;
+	uint64 size = 0;
+
+	void* file = nullptr; // Windows only, POSIX closes the descriptor once mapped
+	void* mapping = nullptr;
+};
+
 class ModuleFileSystem : public Module
 {
 public:
@@ -40,13 +54,23 @@ public:
 	void NormalizePath(char* full_path, bool lowercase = false) const;
 	void NormalizePath(std::string& full_path, bool lowercase = false) const;
 	uint GetLastModificationTime(const char* file);
+	bool GetFileStat(const char* file, uint64& modification_time, uint64& size) const; // One stat, false if the file is not there
 	void WatchDirectory(const char* directory);
+	void TakeFileEvents(std::vector<FileEvent>& events); // Changes that settled, one event per path
+	uint64 Hash(const char* data, uint64 size) const;
+	uint64 HashFile(const char* file) const; // 0 if it cannot be read
 	const char* GetWorkingDirectory() const;
 
+	// --- While a project scan runs, files it listed are known to exist without asking the OS. Misses still do ---
+	void SetKnownFiles(std::unordered_set<std::string>& files);
+	void ClearKnownFiles();
+
 	// Open for Read/Write
 	unsigned int Load(const char* path, const char* file, char** buffer) const;
 	unsigned int Load(const char* file, char** buffer) const;
 	SDL_RWops* Load(const char* file) const;
+	bool MapFile(const char* file, MappedFile& mapped) const;
+	void UnmapFile(MappedFile& mapped) const;
 
 	// IO interfaces for other libs to handle files via PHYSfs
 	aiFileIO* GetAssimpIO();
@@ -60,9 +84,16 @@ public:
 	const char* GetReadPaths() const;
 
 private:
-	// --- FS Windows Watcher ---
-	ulong dwWaitStatus; 
-	HANDLE dwChangeHandles[1]; // void*
+
+	void CoalesceEvents(std::vector<FileEvent>& events) const;
+	bool MoveIntoPlace(const char* temp_file, const char* file) const; // Replaces file with temp_file, both relative to the write dir
+
+private:
+	// --- FS Watcher ---
+	FileWatcher watcher;
+	std::vector<FileEvent> watched_events; // Since changes started coming in
+	std::mutex events_mutex;
+	std::vector<FileEvent> settled_events; // Waiting for the resource manager
 
 	bool started_wait = false;
 	Timer wait_timer;
@@ -71,6 +102,10 @@ private:
 	// --- Working directory ---
 	std::string working_directory;
 
+	// --- Known files, see SetKnownFiles ---
+	mutable std::mutex known_mutex;
+	std::unordered_set<std::string> known_files;
+
 	void CreateAssimpIO();
 
 private:
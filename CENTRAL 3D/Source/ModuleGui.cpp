@@ -13,17 +13,30 @@
 #include "Panels.h"
 
 #include "Imgui/imgui.h"
-#include "imgui/imgui_impl_sdl.h"
-#include "imgui/imgui_impl_opengl3.h"
+#include "Imgui/imgui_impl_sdl.h"
+#include "Imgui/imgui_impl_opengl3.h"
 #include "Imgui/imgui_internal.h"
 #include "Imgui/ImGuizmo/ImGuizmo.h"
 
 #include "OpenGL.h"
+#include "Allocator.h"
+#include "FrameScheduler.h"
 
 #include "mmgr/mmgr.h"
 
 
 
+// --- ImGui allocations are accounted on the editor heap ---
+static void* ImGuiAlloc(size_t size, void* user_data)
+{
+	return Memory::Allocate(MemoryTag::Editor, size);
+}
+
+static void ImGuiFree(void* ptr, void* user_data)
+{
+	Memory::Free(ptr);
+}
+
 ModuleGui::ModuleGui(bool start_enabled) : Module(start_enabled)
 {
 	name = "GUI";
@@ -66,6 +79,12 @@ bool ModuleGui::Init(json file)
 	panelResources = new PanelResources("Resources");
 	panels.push_back(panelResources);
 
+	panelProfiler = new PanelProfiler("Profiler");
+	panels.push_back(panelProfiler);
+
+	panelTextureStreaming = new PanelTextureStreaming("TextureStreaming");
+	panels.push_back(panelTextureStreaming);
+
 	LoadStatus(file);
 
 	return true;
@@ -78,6 +97,7 @@ bool ModuleGui::Start()
 	// --- Initialize ImGui ---
 
 	IMGUI_CHECKVERSION();
+	ImGui::SetAllocatorFunctions(ImGuiAlloc, ImGuiFree);
 	ImGuiContext * context = ImGui::CreateContext();
 
 	if (context)
@@ -144,6 +164,10 @@ bool ModuleGui::Start()
 
 update_status ModuleGui::PreUpdate(float dt)
 {  
+	// --- Headless runs have no editor, the renderer never draws a gui frame ---
+	if (App->IsHeadless())
+		return UPDATE_CONTINUE;
+
 	// --- Start the frame ---
 
 	ImGui_ImplOpenGL3_NewFrame();
@@ -165,6 +189,9 @@ update_status ModuleGui::PreUpdate(float dt)
 
 update_status ModuleGui::Update(float dt)
 {
+	if (App->IsHeadless())
+		return UPDATE_CONTINUE;
+
 	// --- Create Main Menu Bar ---
 
 	update_status status = UPDATE_CONTINUE;
@@ -236,7 +263,7 @@ update_status ModuleGui::Update(float dt)
 					}
 
 					if (ImGui::MenuItem("Redo Octree"))
-						App->scene_manager->RedoOctree();
+						FrameScheduler::Get().Schedule("Redo Octree", DeferredPriority::High, [](const DeferredSlice& slice) { App->scene_manager->RedoOctree(); return true; }, true);
 
 					ImGui::EndMenu();
 				}
@@ -290,6 +317,16 @@ update_status ModuleGui::Update(float dt)
 					panelResources->OnOff();
 				}
 
+				if (ImGui::MenuItem("Profiler"))
+				{
+					panelProfiler->OnOff();
+				}
+
+				if (ImGui::MenuItem("TextureStreaming"))
+				{
+					panelTextureStreaming->OnOff();
+				}
+
 				ImGui::EndMenu();
 			}
 
@@ -362,6 +399,9 @@ update_status ModuleGui::Update(float dt)
 
 update_status ModuleGui::PostUpdate(float dt)
 {
+	if (App->IsHeadless())
+		return UPDATE_CONTINUE;
+
 	// --- Iterate panels and draw ---
 	for (uint i = 0; i < panels.size(); ++i)
 	{
@@ -396,24 +436,29 @@ bool ModuleGui::CleanUp()
 	panelToolbar = nullptr;
 	panelProject = nullptr;
 	panelShaderEditor = nullptr;
+	panelProfiler = nullptr;
+	panelTextureStreaming = nullptr;
 
 	// --- Delete editor textures ---
-	glDeleteTextures(1, &materialTexID);
-	glDeleteTextures(1, &folderTexID);
-	glDeleteTextures(1, &defaultfileTexID);
-	glDeleteTextures(1, &prefabTexID);
-	glDeleteTextures(1, &playbuttonTexID);
-	glDeleteTextures(1, &sceneTexID);
-	glDeleteTextures(1, &shaderTexID);
-	glDeleteTextures(1, &closebuttonTexID);
-	glDeleteTextures(1, &minimizebuttonTexID);
-	glDeleteTextures(1, &minimizesizebuttonTexID);
-	glDeleteTextures(1, &maximizesizebuttonTexID);
-
-	// --- ShutDown ImGui ---
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplSDL2_Shutdown();
-	ImGui::DestroyContext();
+	App->renderer3D->ReleaseTexture(materialTexID);
+	App->renderer3D->ReleaseTexture(folderTexID);
+	App->renderer3D->ReleaseTexture(defaultfileTexID);
+	App->renderer3D->ReleaseTexture(prefabTexID);
+	App->renderer3D->ReleaseTexture(playbuttonTexID);
+	App->renderer3D->ReleaseTexture(sceneTexID);
+	App->renderer3D->ReleaseTexture(shaderTexID);
+	App->renderer3D->ReleaseTexture(closebuttonTexID);
+	App->renderer3D->ReleaseTexture(minimizebuttonTexID);
+	App->renderer3D->ReleaseTexture(minimizesizebuttonTexID);
+	App->renderer3D->ReleaseTexture(maximizesizebuttonTexID);
+
+	// --- ShutDown ImGui, headless tools never Start the gui ---
+	if (ImGui::GetCurrentContext())
+	{
+		ImGui_ImplOpenGL3_Shutdown();
+		ImGui_ImplSDL2_Shutdown();
+		ImGui::DestroyContext();
+	}
 
 	return ret;
 }
@@ -431,6 +476,43 @@ void ModuleGui::Draw() const
 
 }
 
+ImDrawData* ModuleGui::CloneDrawData() const
+{
+	ImGui::Render();
+
+	ImDrawData* source = ImGui::GetDrawData();
+
+	if (source == nullptr || !source->Valid)
+		return nullptr;
+
+	// --- Draw lists are reused by the next ImGui frame, so deep copy them ---
+	ImDrawData* draw_data = new ImDrawData(*source);
+	draw_data->CmdLists = draw_data->CmdListsCount > 0 ? new ImDrawList*[draw_data->CmdListsCount] : nullptr;
+
+	for (int i = 0; i < draw_data->CmdListsCount; ++i)
+		draw_data->CmdLists[i] = source->CmdLists[i]->CloneOutput();
+
+	return draw_data;
+}
+
+void ModuleGui::DrawData(ImDrawData* draw_data) const
+{
+	if (draw_data)
+		ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+}
+
+void ModuleGui::FreeDrawData(ImDrawData* draw_data) const
+{
+	if (draw_data == nullptr)
+		return;
+
+	for (int i = 0; i < draw_data->CmdListsCount; ++i)
+		IM_DELETE(draw_data->CmdLists[i]);
+
+	delete[] draw_data->CmdLists;
+	delete draw_data;
+}
+
 void ModuleGui::DockSpace() const
 {
 	// --- Adapt to Window changes like resizing ---
@@ -460,16 +542,14 @@ void ModuleGui::DockSpace() const
 
 void ModuleGui::RequestBrowser(const char * url) const
 {
+#ifdef _WIN32
 	ShellExecuteA(NULL, "open", url, NULL, NULL, SW_SHOWNORMAL);
+#else
+	CONSOLE_LOG("Open %s in a browser", url);
+#endif
 }
 
 
-void ModuleGui::LogFPS(float fps, float ms)
-{
-	if (panelSettings != nullptr)
-		panelSettings->AddFPS(fps, ms);
-}
-
 void ModuleGui::SaveStatus(json &file) const  
 {
 	for (uint i = 0; i < panels.size(); ++i)
@@ -520,3 +600,8 @@ void ModuleGui::CreateIcons()
 	// REMEMBER to gldeletetex them at cleanup!
 }
 
+bool ModuleGui::IsEditorIcon(uint texID) const
+{
+	return texID == folderTexID || texID == defaultfileTexID || texID == materialTexID || texID == prefabTexID || texID == sceneTexID || texID == shaderTexID;
+}
+
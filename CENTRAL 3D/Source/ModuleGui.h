@@ -16,6 +16,9 @@ class PanelToolbar;
 class PanelProject;
 class PanelShaderEditor;
 class PanelResources;
+class PanelProfiler;
+class PanelTextureStreaming;
+struct ImDrawData;
 
 class ModuleGui : public Module
 {
@@ -32,11 +35,15 @@ public:
 	bool CleanUp() override;
 
 	void Draw() const;
+
+	// --- Pipelined frames, the render thread draws a copy of this frame's ImGui output ---
+	ImDrawData* CloneDrawData() const;
+	void DrawData(ImDrawData* draw_data) const;
+	void FreeDrawData(ImDrawData* draw_data) const;
+
 	void DockSpace() const;
 	void RequestBrowser(const char * url) const;
 
-	void LogFPS(float fps, float ms);
-
 	void SaveStatus(json &file) const override;
 
 	void LoadStatus(const json & file) override;
@@ -47,6 +54,7 @@ public:
 	bool IsMouseCaptured() const;
 
 	void CreateIcons();
+	bool IsEditorIcon(uint texID) const; // Shared by every resource of a type, never released by them
 
 public:
 
@@ -60,6 +68,8 @@ public:
 	PanelProject*		panelProject = nullptr;
 	PanelShaderEditor*  panelShaderEditor = nullptr;
 	PanelResources*		panelResources = nullptr;
+	PanelProfiler*		panelProfiler = nullptr;
+	PanelTextureStreaming* panelTextureStreaming = nullptr;
 	
 	uint materialTexID = 0;
 	uint folderTexID = 0;
@@ -1,5 +1,6 @@
 #include "Globals.h"
 #include "ModuleHardware.h"
+#include "Kernels.h"
 #include "SDL/include/SDL.h"
 
 #include "OpenGL.h"
@@ -8,6 +9,8 @@
 
 ModuleHardware::ModuleHardware(bool start_enabled) : Module(start_enabled)
 {
+	name = "Hardware";
+
 	// --- Retrieve SDL Version ---
 	SDL_version version;
 	SDL_GetVersion(&version);
@@ -28,13 +31,59 @@ ModuleHardware::ModuleHardware(bool start_enabled) : Module(start_enabled)
 	info.sse42 = SDL_HasSSE42() == SDL_TRUE;
 	info.avx = SDL_HasAVX() == SDL_TRUE;
 	info.avx2 = SDL_HasAVX2() == SDL_TRUE;
-
+	info.neon = SDL_HasNEON() == SDL_TRUE;
 }
 
 // Destructor
 ModuleHardware::~ModuleHardware()
 {}
 
+bool ModuleHardware::Init(json file)
+{
+	// --- CPU features are known since construction, GetInfo would need the GL context ---
+	Kernels::Init(info);
+
+	// --- Forced variants, by kernel name ---
+	if (file["Hardware"].find("Kernels") != file["Hardware"].end())
+	{
+		for (json::iterator it = file["Hardware"]["Kernels"].begin(); it != file["Hardware"]["Kernels"].end(); ++it)
+		{
+			for (uint i = 0; i < (uint)KernelId::count; ++i)
+			{
+				KernelId kernel = (KernelId)i;
+
+				if (it.key() != Kernels::GetKernelName(kernel))
+					continue;
+
+				std::string level = it.value();
+
+				if (Kernels::SetLevel(kernel, Kernels::GetLevelFromName(level.c_str())))
+				{
+					CONSOLE_LOG("Kernels: %s forced to %s", Kernels::GetKernelName(kernel), level.c_str());
+				}
+				else
+					CONSOLE_LOG("![Warning]: Kernels: could not force %s to %s, keeping %s", Kernels::GetKernelName(kernel), level.c_str(), Kernels::GetLevelName(Kernels::GetLevel(kernel)));
+			}
+		}
+	}
+
+	return true;
+}
+
+void ModuleHardware::SaveStatus(json& file) const
+{
+	// --- Only what differs from the automatic choice, a new CPU picks its own best otherwise ---
+	file["Hardware"]["Kernels"] = json::object();
+
+	for (uint i = 0; i < (uint)KernelId::count; ++i)
+	{
+		KernelId kernel = (KernelId)i;
+
+		if (Kernels::GetLevel(kernel) != Kernels::GetBestLevel(kernel))
+			file["Hardware"]["Kernels"][Kernels::GetKernelName(kernel)] = Kernels::GetLevelName(Kernels::GetLevel(kernel));
+	}
+}
+
 const hw_info & ModuleHardware::GetInfo() const
 {
 	// --- Retrieve GPU Information ---
@@ -63,3 +112,9 @@ const hw_info & ModuleHardware::GetInfo() const
 	return info;
 }
 
+
+uint ModuleHardware::GetCPUCount() const
+{
+	// --- Safe to call before the GL context exists, unlike GetInfo ---
+	return info.cpu_count;
+}
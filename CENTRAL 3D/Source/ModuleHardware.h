@@ -20,6 +20,7 @@ struct hw_info {
 	bool sse42 = false;
 	bool avx = false;
 	bool avx2 = false;
+	bool neon = false;
 	std::string gpu_vendor;
 	std::string gpu_driver;
 	std::string gpu_brand;
@@ -37,7 +38,11 @@ public:
 	ModuleHardware(bool start_enabled = true);
 	~ModuleHardware();
 
+	bool Init(json file) override;
+	void SaveStatus(json& file) const override;
+
 	const hw_info& GetInfo() const;
+	uint GetCPUCount() const;
 
 private:
 
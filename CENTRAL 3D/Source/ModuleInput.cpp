@@ -3,19 +3,20 @@
 #include "ModuleInput.h"
 #include "ModuleGui.h"
 #include "ModuleWindow.h"
+#include "ModuleEventManager.h"
 
 #include "ModuleResourceManager.h"
 #include "Importer.h"
 
 #include "mmgr/mmgr.h"
 
-#define MAX_KEYS 300
-
 ModuleInput::ModuleInput(bool start_enabled) : Module(start_enabled)
 {
+	name = "Input";
 	keyboard = new KEY_STATE[MAX_KEYS];
 	memset(keyboard, KEY_IDLE, sizeof(KEY_STATE) * MAX_KEYS);
 	memset(mouse_buttons, KEY_IDLE, sizeof(KEY_STATE) * MAX_MOUSE_BUTTONS);
+	memset(playback_keys, 0, sizeof(playback_keys));
 }
 
 // Destructor
@@ -45,7 +46,7 @@ update_status ModuleInput::PreUpdate(float dt)
 {
 	SDL_PumpEvents();
 
-	const Uint8* keys = SDL_GetKeyboardState(NULL);
+	const Uint8* keys = playback ? playback_keys : SDL_GetKeyboardState(NULL);
 	
 	for(int i = 0; i < MAX_KEYS; ++i)
 	{
@@ -65,11 +66,24 @@ update_status ModuleInput::PreUpdate(float dt)
 		}
 	}
 
-	Uint32 buttons = SDL_GetMouseState(&mouse_x, &mouse_y);
+	int last_x = mouse_x;
+	int last_y = mouse_y;
+	Uint32 buttons = 0;
 
-	mouse_x /= SCREEN_SIZE;
-	mouse_y /= SCREEN_SIZE;
-	mouse_wheel = 0;
+	if (playback)
+	{
+		buttons = playback_buttons;
+		mouse_x = playback_x;
+		mouse_y = playback_y;
+		mouse_wheel = playback_wheel;
+	}
+	else
+	{
+		buttons = SDL_GetMouseState(&mouse_x, &mouse_y);
+		mouse_x /= SCREEN_SIZE;
+		mouse_y /= SCREEN_SIZE;
+		mouse_wheel = 0;
+	}
 
 	for(int i = 0; i < 5; ++i)
 	{
@@ -91,6 +105,13 @@ update_status ModuleInput::PreUpdate(float dt)
 
 	mouse_x_motion = mouse_y_motion = 0;
 
+	// --- Recorded positions have no events, motion is what moved since last frame ---
+	if (playback)
+	{
+		mouse_x_motion = mouse_x - last_x;
+		mouse_y_motion = mouse_y - last_y;
+	}
+
 	bool quit = false;
 	SDL_Event e;
 	while(SDL_PollEvent(&e))
@@ -101,10 +122,14 @@ update_status ModuleInput::PreUpdate(float dt)
 		switch(e.type)
 		{
 			case SDL_MOUSEWHEEL:
-			mouse_wheel = e.wheel.y;
+			if (!playback)
+				mouse_wheel = e.wheel.y;
 			break;
 
 			case SDL_MOUSEMOTION:
+			if (playback)
+				break;
+
 			mouse_x = e.motion.x / SCREEN_SIZE;
 			mouse_y = e.motion.y / SCREEN_SIZE;
 
@@ -123,6 +148,11 @@ update_status ModuleInput::PreUpdate(float dt)
 					App->window->SetWindowWidth(e.window.data1);
 					App->window->SetWindowHeight(e.window.data2);
 					App->window->UpdateWindowSize();
+
+					Event resize(Event::EventType::Window_resize);
+					resize.window.width = e.window.data1;
+					resize.window.height = e.window.data2;
+					App->event_manager->PushEvent(resize);
 				}
 
 				if (e.window.event == SDL_WINDOWEVENT_MAXIMIZED)
@@ -156,6 +186,47 @@ update_status ModuleInput::PreUpdate(float dt)
 	return UPDATE_CONTINUE;
 }
 
+void ModuleInput::SetPlayback(bool enabled)
+{
+	playback = enabled;
+	memset(playback_keys, 0, sizeof(playback_keys));
+	playback_buttons = 0;
+	playback_wheel = 0;
+}
+
+bool ModuleInput::IsPlayingBack() const
+{
+	return playback;
+}
+
+void ModuleInput::SetPlaybackKey(int scancode, bool down)
+{
+	if (scancode >= 0 && scancode < MAX_KEYS)
+		playback_keys[scancode] = down ? 1 : 0;
+}
+
+void ModuleInput::SetPlaybackMouseButton(int button, bool down)
+{
+	if (button <= 0 || button >= MAX_MOUSE_BUTTONS)
+		return;
+
+	if (down)
+		playback_buttons |= SDL_BUTTON(button);
+	else
+		playback_buttons &= ~SDL_BUTTON(button);
+}
+
+void ModuleInput::SetPlaybackMouse(int x, int y)
+{
+	playback_x = x;
+	playback_y = y;
+}
+
+void ModuleInput::SetPlaybackWheel(int wheel)
+{
+	playback_wheel = wheel;
+}
+
 // Called before quitting
 bool ModuleInput::CleanUp()
 {
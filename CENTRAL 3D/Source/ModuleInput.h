@@ -3,6 +3,7 @@
 #include "Globals.h"
 
 #define MAX_MOUSE_BUTTONS 5
+#define MAX_KEYS 300
 
 enum KEY_STATE
 {
@@ -58,6 +59,14 @@ public:
 		return mouse_y_motion;
 	}
 
+	// --- Playback, recorded devices replace SDL's state. Window and quit events are still handled ---
+	void SetPlayback(bool enabled);
+	bool IsPlayingBack() const;
+	void SetPlaybackKey(int scancode, bool down);
+	void SetPlaybackMouseButton(int button, bool down);
+	void SetPlaybackMouse(int x, int y);
+	void SetPlaybackWheel(int wheel);
+
 private:
 	KEY_STATE* keyboard;
 	KEY_STATE mouse_buttons[MAX_MOUSE_BUTTONS];
@@ -67,4 +76,11 @@ private:
 	int mouse_x_motion;
 	int mouse_y_motion;
 	//int mouse_z_motion;
+
+	bool playback = false;
+	Uint8 playback_keys[MAX_KEYS];
+	Uint32 playback_buttons = 0;
+	int playback_x = 0;
+	int playback_y = 0;
+	int playback_wheel = 0;
 };
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "ModuleJobs.h"
+#include "Application.h"
+#include "ModuleHardware.h"
+
+#include "Optick/include/optick.h"
+#include "Profiler.h"
+
+#include "mmgr/mmgr.h"
+
+// --- Index of the calling thread's queue, -1 for threads the job system does not own ---
+static thread_local int queue_index = -1;
+
+// ----------------------------------------------------------------------------------------------------------
+// --- JobQueue ---
+
+JobQueue::JobQueue()
+{
+	top = 0;
+	bottom = 0;
+
+	for (uint i = 0; i < JOB_QUEUE_SIZE; ++i)
+		jobs[i] = nullptr;
+}
+
+bool JobQueue::Push(Job* job)
+{
+	long long b = bottom.load(std::memory_order_relaxed);
+	long long t = top.load(std::memory_order_acquire);
+
+	// --- Full, caller has to deal with the job ---
+	if (b - t >= JOB_QUEUE_SIZE)
+		return false;
+
+	jobs[b & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+
+	return true;
+}
+
+Job* JobQueue::Pop()
+{
+	long long b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long t = top.load(std::memory_order_relaxed);
+
+	Job* job = nullptr;
+
+	if (t <= b)
+	{
+		job = jobs[b & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+
+		// --- Last job, race against thieves ---
+		if (t == b)
+		{
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+		bottom.store(b + 1, std::memory_order_relaxed);
+
+	return job;
+}
+
+Job* JobQueue::Steal()
+{
+	long long t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long b = bottom.load(std::memory_order_acquire);
+
+	Job* job = nullptr;
+
+	if (t < b)
+	{
+		job = jobs[t & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+
+		// --- Someone else got it first ---
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+	}
+
+	return job;
+}
+
+bool JobQueue::Empty() const
+{
+	return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- ModuleJobs ---
+
+ModuleJobs::ModuleJobs(bool start_enabled) : Module(start_enabled)
+{
+	name = "Jobs";
+
+	running = false;
+	deferred_count = 0;
+	foreign_count = 0;
+	queued_jobs = 0;
+	sleeping_workers = 0;
+}
+
+ModuleJobs::~ModuleJobs()
+{
+}
+
+bool ModuleJobs::Init(json file)
+{
+	// --- The main thread helps while waiting, so one worker per remaining hardware thread ---
+	uint cpu_count = App->hardware->GetCPUCount();
+	uint worker_count = cpu_count > 1 ? cpu_count - 1 : 1;
+
+	CONSOLE_LOG("Starting Job System with %i workers", worker_count);
+
+	queue_index = 0;
+	running = true;
+
+	for (uint i = 0; i <= worker_count; ++i)
+		queues.push_back(new JobQueue());
+
+	for (uint i = 1; i <= worker_count; ++i)
+		workers.push_back(std::thread(&ModuleJobs::WorkerLoop, this, i));
+
+	return true;
+}
+
+bool ModuleJobs::CleanUp()
+{
+	// --- Finish whatever is left on the main thread's queue ---
+	while (RunPendingJob(0)) {}
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		running = false;
+	}
+
+	wake_condition.notify_all();
+
+	for (uint i = 0; i < workers.size(); ++i)
+	{
+		if (workers[i].joinable())
+			workers[i].join();
+	}
+
+	workers.clear();
+
+	// --- Jobs nobody ran are dropped, their counters are never signaled ---
+	for (uint i = 0; i < queues.size(); ++i)
+	{
+		Job* job = nullptr;
+
+		while ((job = queues[i]->Pop()) != nullptr)
+			delete job;
+
+		delete queues[i];
+	}
+
+	queues.clear();
+
+	for (uint i = 0; i < foreign_jobs.size(); ++i)
+		delete foreign_jobs[i];
+
+	foreign_jobs.clear();
+
+	for (uint i = 0; i < deferred_jobs.size(); ++i)
+		delete deferred_jobs[i];
+
+	deferred_jobs.clear();
+
+	return true;
+}
+
+void ModuleJobs::Schedule(const std::function<void()>& task, JobCounter* counter, JobCounter* dependency)
+{
+	Job* job = new Job;
+	job->task = task;
+	job->counter = counter;
+	job->dependency = dependency;
+
+	if (counter)
+		counter->fetch_add(1);
+
+	// --- Hold the job back until its dependency is done. Counted before the check, so a dependency finishing
+	// in between sees a deferred job and comes for it once we let go of the lock ---
+	if (dependency)
+	{
+		std::lock_guard<std::mutex> lock(deferred_mutex);
+		deferred_count.fetch_add(1);
+
+		if (dependency->load() > 0)
+		{
+			deferred_jobs.push_back(job);
+			return;
+		}
+
+		deferred_count.fetch_sub(1);
+	}
+
+	Enqueue(job);
+}
+
+void ModuleJobs::ParallelFor(uint count, uint grain_size, const std::function<void(uint begin, uint end)>& task, JobCounter* counter)
+{
+	if (count == 0)
+		return;
+
+	if (grain_size == 0)
+		grain_size = 1;
+
+	// --- Not worth splitting ---
+	if (count <= grain_size)
+	{
+		task(0, count);
+		return;
+	}
+
+	JobCounter local_counter(0);
+	JobCounter* target = counter ? counter : &local_counter;
+
+	for (uint begin = 0; begin < count; begin += grain_size)
+	{
+		uint end = begin + grain_size < count ? begin + grain_size : count;
+		Schedule([task, begin, end]() { task(begin, end); }, target);
+	}
+
+	// --- Without a counter from the caller the call is blocking ---
+	if (!counter)
+		Wait(local_counter);
+}
+
+void ModuleJobs::Wait(JobCounter& counter)
+{
+	OPTICK_CATEGORY("Job Wait", Optick::Category::Wait);
+
+	while (counter.load() > 0)
+	{
+		if (!RunPendingJob(queue_index))
+			std::this_thread::yield();
+	}
+}
+
+uint ModuleJobs::GetWorkerCount() const
+{
+	return workers.size();
+}
+
+int ModuleJobs::GetThreadIndex() const
+{
+	return queue_index;
+}
+
+bool ModuleJobs::IsMainThread() const
+{
+	return queue_index == 0;
+}
+
+void ModuleJobs::WorkerLoop(int index)
+{
+	queue_index = index;
+
+	std::string thread_name = "Worker " + std::to_string(index);
+	OPTICK_THREAD(thread_name.c_str());
+	PROFILE_THREAD(thread_name.c_str());
+
+	while (running)
+	{
+		if (RunPendingJob(index))
+			continue;
+
+		// --- Nothing to do, sleep until a job is queued ---
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleeping_workers.fetch_add(1);
+		wake_condition.wait(lock, [this]() { return queued_jobs.load() > 0 || !running; });
+		sleeping_workers.fetch_sub(1);
+	}
+}
+
+bool ModuleJobs::RunPendingJob(int index)
+{
+	Job* job = GetJob(index);
+
+	if (job)
+	{
+		Execute(job);
+		return true;
+	}
+
+	return false;
+}
+
+Job* ModuleJobs::GetJob(int index)
+{
+	if (queues.empty())
+		return nullptr;
+
+	Job* job = nullptr;
+
+	// --- Own queue first, only its owner may pop from it ---
+	if (index >= 0)
+		job = queues[index]->Pop();
+
+	// --- Then jobs pushed from outside ---
+	if (!job && foreign_count.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(foreign_mutex);
+
+		if (!foreign_jobs.empty())
+		{
+			job = foreign_jobs.back();
+			foreign_jobs.pop_back();
+			foreign_count.fetch_sub(1);
+		}
+	}
+
+	// --- Then try to steal from everyone else, starting by our neighbour ---
+	uint start = index >= 0 ? (uint)index : 0;
+
+	for (uint i = 1; !job && i <= queues.size(); ++i)
+	{
+		uint victim = (start + i) % queues.size();
+
+		if ((int)victim != index)
+			job = queues[victim]->Steal();
+	}
+
+	if (job)
+		queued_jobs.fetch_sub(1);
+
+	return job;
+}
+
+void ModuleJobs::Enqueue(Job* job)
+{
+	// --- Workers not running yet, just do it now ---
+	if (!running)
+	{
+		Execute(job);
+		return;
+	}
+
+	if (queue_index >= 0)
+	{
+		// --- Queue is full, just do it now ---
+		if (!queues[queue_index]->Push(job))
+		{
+			Execute(job);
+			return;
+		}
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(foreign_mutex);
+		foreign_jobs.push_back(job);
+		foreign_count.fetch_add(1);
+	}
+
+	queued_jobs.fetch_add(1);
+
+	if (sleeping_workers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		wake_condition.notify_one();
+	}
+}
+
+void ModuleJobs::Execute(Job* job)
+{
+	{
+		PROFILE_SCOPE("Job");
+		job->task();
+	}
+
+	// --- If this was the last job of the counter, release anyone that depends on it ---
+	if (job->counter && job->counter->fetch_sub(1) == 1 && deferred_count.load() > 0)
+		QueueReadyDependants();
+
+	delete job;
+}
+
+void ModuleJobs::QueueReadyDependants()
+{
+	std::vector<Job*> ready;
+
+	{
+		std::lock_guard<std::mutex> lock(deferred_mutex);
+
+		for (std::vector<Job*>::iterator it = deferred_jobs.begin(); it != deferred_jobs.end();)
+		{
+			if ((*it)->dependency->load() <= 0)
+			{
+				ready.push_back(*it);
+				it = deferred_jobs.erase(it);
+				deferred_count.fetch_sub(1);
+			}
+			else
+				++it;
+		}
+	}
+
+	for (uint i = 0; i < ready.size(); ++i)
+		Enqueue(ready[i]);
+}
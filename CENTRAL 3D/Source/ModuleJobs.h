@@ -0,0 +1,100 @@
+#ifndef __MODULE_JOBS_H__
+#define __MODULE_JOBS_H__
+
+#include "Module.h"
+#include "Globals.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#define JOB_QUEUE_SIZE 4096 // Per thread, must be a power of two
+
+// --- Counts jobs still to finish, Wait on it or use it as a dependency ---
+typedef std::atomic<int> JobCounter;
+
+struct Job
+{
+	std::function<void()> task;
+	JobCounter* counter = nullptr; // Decremented once the job has run
+	JobCounter* dependency = nullptr; // The job won't be queued until this reaches zero
+};
+
+// --- Lock-free work stealing deque (Chase-Lev), the owner pushes/pops at the bottom, thieves steal from the top ---
+class JobQueue
+{
+public:
+
+	JobQueue();
+
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+	bool Empty() const;
+
+private:
+
+	std::atomic<long long> top;
+	std::atomic<long long> bottom;
+	std::atomic<Job*> jobs[JOB_QUEUE_SIZE];
+};
+
+class ModuleJobs : public Module
+{
+public:
+
+	// --- Basic ---
+	ModuleJobs(bool start_enabled = true);
+	~ModuleJobs();
+
+	bool Init(json file) override;
+	bool CleanUp() override;
+
+	// --- Scheduling ---
+	void Schedule(const std::function<void()>& task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	void ParallelFor(uint count, uint grain_size, const std::function<void(uint begin, uint end)>& task, JobCounter* counter = nullptr);
+
+	// --- Blocks until counter reaches zero, running pending jobs meanwhile ---
+	void Wait(JobCounter& counter);
+
+	// --- Getters ---
+	uint GetWorkerCount() const;
+	int GetThreadIndex() const; // -1 for threads the job system does not own
+	bool IsMainThread() const;
+
+private:
+
+	void WorkerLoop(int index);
+	bool RunPendingJob(int index);
+	Job* GetJob(int index);
+	void Enqueue(Job* job);
+	void Execute(Job* job);
+	void QueueReadyDependants();
+
+private:
+
+	// --- Queue 0 belongs to the main thread, 1..N to workers ---
+	std::vector<JobQueue*> queues;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running;
+
+	// --- Jobs from threads without a queue ---
+	std::mutex foreign_mutex;
+	std::vector<Job*> foreign_jobs;
+	std::atomic<int> foreign_count;
+
+	// --- Jobs waiting on a dependency ---
+	std::mutex deferred_mutex;
+	std::vector<Job*> deferred_jobs;
+	std::atomic<int> deferred_count;
+
+	// --- Idle workers sleep until something is queued ---
+	std::mutex sleep_mutex;
+	std::condition_variable wake_condition;
+	std::atomic<int> queued_jobs;
+	std::atomic<int> sleeping_workers;
+};
+
+#endif
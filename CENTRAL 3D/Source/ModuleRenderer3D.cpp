@@ -8,6 +8,7 @@
 #include "ModuleResourceManager.h"
 #include "ModuleTextures.h"
 #include "ModuleTimeManager.h"
+#include "ModuleJobs.h"
 
 #include "GameObject.h"
 #include "ComponentCamera.h"
@@ -28,6 +29,8 @@
 #include "OpenGL.h"
 
 #include "Optick/include/optick.h"
+#include "Profiler.h"
+#include "FrameAllocator.h"
 
 #include "mmgr/mmgr.h"
 
@@ -38,9 +41,51 @@
 
 // ------------------------------ Basic --------------------------------------------------------
 
+RenderMesh::RenderMesh(float4x4 transform, const ResourceMesh* mesh, uint material, const RenderMeshFlags flags) : transform(transform), material(material), flags(flags)
+{
+	VAO = mesh->VAO;
+	VBO = mesh->VBO;
+	EBO = mesh->EBO;
+	IndicesSize = mesh->vertices && mesh->Indices ? mesh->IndicesSize : 0;
+}
+
+void RenderSnapshot::ClearOrders()
+{
+	// --- Keep per mesh lists and material slots with their capacity, only what went unused for a whole frame is released ---
+	for (RenderMap<uint, RenderMeshes>::iterator it = meshes.begin(); it != meshes.end();)
+	{
+		if ((*it).second.empty())
+			it = meshes.erase(it);
+		else
+		{
+			(*it).second.clear();
+			++it;
+		}
+	}
+
+	for (RenderMap<uint, uint>::iterator it = material_indices.begin(); it != material_indices.end();)
+	{
+		if ((*it).second == RENDER_INVALID_INDEX)
+			it = material_indices.erase(it);
+		else
+		{
+			(*it).second = RENDER_INVALID_INDEX;
+			++it;
+		}
+	}
+
+	material_count = 0;
+	outline.clear();
+	aabbs.clear();
+	obbs.clear();
+	frustums.clear();
+	lines.clear();
+}
+
 ModuleRenderer3D::ModuleRenderer3D(bool start_enabled) : Module(start_enabled) 
 {
 	name = "Renderer3D";
+	vsync_changed = false;
 }
 
 // Destructor
@@ -55,9 +100,33 @@ bool ModuleRenderer3D::Init(json file)
 
 	bool ret = true;
 
+	if (file["Renderer3D"].find("Pipelined") != file["Renderer3D"].end())
+		pipelined = file["Renderer3D"]["Pipelined"];
+
+	if (file["Renderer3D"].find("VSync") != file["Renderer3D"].end())
+		vsync = file["Renderer3D"]["VSync"];
+
+	// --- Headless runs never present, nothing to pace or hand to another thread ---
+	if (App->IsHeadless())
+		pipelined = vsync = false;
+
 	//Create context
 	context = SDL_GL_CreateContext(App->window->window);
 
+	// --- The render thread's context shares buffers, textures and programs with ours ---
+	if (context && pipelined)
+	{
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+		render_context = SDL_GL_CreateContext(App->window->window);
+		SDL_GL_MakeCurrent(App->window->window, context);
+
+		if (render_context == NULL)
+		{
+			CONSOLE_LOG("![Warning]: Could not create render thread context, pipelined frames disabled. SDL_Error: %s\n", SDL_GetError());
+			pipelined = false;
+		}
+	}
+
 	if (context == NULL) 
 	{
 		CONSOLE_LOG("|[error]: OpenGL context could not be created! SDL_Error: %s\n", SDL_GetError());
@@ -80,14 +149,8 @@ bool ModuleRenderer3D::Init(json file)
 		}
 
 	}
-	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-
-	// --- z values from 0 to 1 and not -1 to 1, more precision in far ranges ---
-	glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
 
-	// --- Enable stencil testing, set to replace ---
-	glEnable(GL_STENCIL_TEST);
-	glStencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
+	SetupContextState();
 
 	// --- Check if graphics driver supports shaders in binary format ---
 	//GLint formats = 0;
@@ -100,27 +163,16 @@ bool ModuleRenderer3D::Init(json file)
 	CONSOLE_LOG("OpenGL Version: %s", glGetString(GL_VERSION));
 	CONSOLE_LOG("Glew Version: %s", glewGetString(GLEW_VERSION));
 
-	// --- Multitexturing ---
-	glGetIntegerv(GL_MAX_TEXTURE_UNITS, (GLint*)&maxSimultaneousTextures);
-
-	for (uint i = 0; i < maxSimultaneousTextures; ++i)
-	{
-		glActiveTexture(GL_TEXTURE0 + i);
-		glEnable(GL_TEXTURE_2D);
-	}
-
-	glActiveTexture(GL_TEXTURE0);
-
-
 	//Projection matrix for
 	OnResize(App->window->GetWindowWidth(), App->window->GetWindowHeight());
 
 	// --- Create adaptive grid ---
-	glGenVertexArrays(1, &Grid_VAO);
+	glGenVertexArrays(1, &main_objects.grid_VAO);
 	glGenBuffers(1, &Grid_VBO);
 	CreateGrid(10.0f);
 
-	glGenVertexArrays(1, &PointLineVAO);
+	glGenVertexArrays(1, &main_objects.pointline_VAO);
+	glGenBuffers(1, &main_objects.pointline_VBO);
 
 	// --- Create camera to take model/meshes screenshots ---
 	screenshot_camera = new ComponentCamera(nullptr);
@@ -128,30 +180,17 @@ bool ModuleRenderer3D::Init(json file)
 	screenshot_camera->SetFOV(60.0f);
 	screenshot_camera->Look({ 0.0f, 0.0f, 0.0f });
 
-	// --- Load skybox textures ---
-	uint width, height = 0;
-	ResourceTexture* Texright = (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexRight");
-	ResourceTexture* Texleft = (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexLeft");
-	ResourceTexture* Texback= (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexBack");
-	ResourceTexture* Texfront = (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexFront");
-	ResourceTexture* Textop = (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexTop");
-	ResourceTexture* Texbottom = (ResourceTexture*)App->resources->CreateResource(Resource::ResourceType::TEXTURE, "SkyboxTexBottom");
-
-	Texright->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/right.jpg", width, height, -1));
-	Texleft->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/left.jpg", width, height, -1));
-	Texback->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/back.jpg", width, height, -1));
-	Texfront->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/front.jpg", width, height, -1));
-	Textop->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/top.jpg", width, height, -1));
-	Texbottom->SetTextureID(App->textures->CreateTextureFromFile("Settings/Skybox/bottom.jpg", width, height, -1));
-	
-	std::vector<uint> cubemaptexIDs;
-	cubemaptexIDs.push_back(Texright->GetTexID());
-	cubemaptexIDs.push_back(Texleft->GetTexID());
-	cubemaptexIDs.push_back(Texbottom->GetTexID());
-	cubemaptexIDs.push_back(Textop->GetTexID());
-	cubemaptexIDs.push_back(Texfront->GetTexID());
-	cubemaptexIDs.push_back(Texback->GetTexID());
+	// --- Decode the skybox faces in parallel, in cubemap order ---
+	std::vector<std::string> skybox_faces;
+	skybox_faces.push_back("Settings/Skybox/right.jpg");
+	skybox_faces.push_back("Settings/Skybox/left.jpg");
+	skybox_faces.push_back("Settings/Skybox/bottom.jpg");
+	skybox_faces.push_back("Settings/Skybox/top.jpg");
+	skybox_faces.push_back("Settings/Skybox/front.jpg");
+	skybox_faces.push_back("Settings/Skybox/back.jpg");
 
+	std::vector<DecodedImage> skybox_images;
+	App->textures->DecodeImages(skybox_faces, skybox_images);
 
 	float skyboxVertices[] = {
 		// positions          
@@ -199,9 +238,9 @@ bool ModuleRenderer3D::Init(json file)
 	};
 
 	// skybox VAO
-	glGenVertexArrays(1, &skyboxVAO);
+	glGenVertexArrays(1, &main_objects.skybox_VAO);
 	glGenBuffers(1, &skyboxVBO);
-	glBindVertexArray(skyboxVAO);
+	glBindVertexArray(main_objects.skybox_VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
 	glEnableVertexAttribArray(0);
@@ -209,7 +248,18 @@ bool ModuleRenderer3D::Init(json file)
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	cubemapTexID = App->textures->CreateCubemap(cubemaptexIDs);
+	cubemapTexID = App->textures->CreateCubemap(skybox_images);
+
+	for (uint i = 0; i < skybox_images.size(); ++i)
+		App->textures->FreeImage(skybox_images[i]);
+
+	// --- Start drawing on the render thread, it takes over its own context ---
+	if (pipelined)
+	{
+		CONSOLE_LOG("Renderer: pipelined frames enabled");
+		render_thread_running = true;
+		render_thread = std::thread(&ModuleRenderer3D::RenderThreadLoop, this);
+	}
 
 	return ret;
 }
@@ -219,24 +269,16 @@ update_status ModuleRenderer3D::PreUpdate(float dt)
 {
 	OPTICK_CATEGORY("Renderer PreUpdate", Optick::Category::Rendering);
 
-	// --- Update OpenGL Capabilities ---
-	UpdateGLCapabilities();
-
-	// --- Clear stencil buffer, enable write ---
-	glStencilMask(0xFF);
-	glClearStencil(0);
+	// --- Headless, orders are built but nothing is drawn ---
+	if (App->IsHeadless())
+		TakeSnapshot();
 
-	// --- Clear framebuffers ---
-	float backColor = 0.65f;
-	glClearColor(backColor, backColor, backColor, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-	glClearDepth(0.0f);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	glClearColor(backColor, backColor, backColor, 1.0f);
-	glClearDepth(0.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// --- With pipelined frames the render thread clears its own framebuffers ---
+	else if (!render_thread_running)
+	{
+		TakeSnapshot();
+		ClearFramebuffers(*snapshot, main_objects);
+	}
 
 	return UPDATE_CONTINUE;
 }
@@ -246,61 +288,41 @@ update_status ModuleRenderer3D::PostUpdate(float dt)
 {
 	OPTICK_CATEGORY("Renderer PostUpdate", Optick::Category::Rendering);
 
-	// --- Set Shader Matrices ---
-	GLint viewLoc = glGetUniformLocation(defaultShader->ID, "view");
-	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, App->renderer3D->active_camera->GetOpenGLViewMatrix().ptr());
-
-	float nearp = App->renderer3D->active_camera->GetNearPlane();
-
-	// right handed projection matrix (just different standard)
-	float f = 1.0f / tan(App->renderer3D->active_camera->GetFOV() * DEGTORAD / 2.0f);
-	float4x4 proj_RH(
-		f / App->renderer3D->active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-		0.0f, f, 0.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, -1.0f,
-		0.0f, 0.0f, nearp, 0.0f);
-
-	GLint projectLoc = glGetUniformLocation(defaultShader->ID, "projection");
-	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
-
-	GLint modelLoc = glGetUniformLocation(defaultShader->ID, "model_matrix");
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.Transposed().ptr());
-
-	// --- Bind fbo ---
-	if (renderfbo)
-		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-	// --- Do not write to the stencil buffer ---
-	glStencilMask(0x00);
-
-	DrawSkybox(); // could not manage to draw it after scene with reversed-z ...
-
-	// --- Set depth filter to greater (Passes if the incoming depth value is greater than the stored depth value) ---
-	glDepthFunc(GL_GREATER);
+	// --- Camera and flags for this frame ---
+	TakeSnapshot();
 
 	// --- Issue Render orders ---
 	App->scene_manager->DrawScene();
 
-	// --- Draw Grid ---
-	if (display_grid)
-		DrawGrid();
-
-	// --- Draw ---
-	DrawRenderMeshes();
-	DrawRenderLines();
-	DrawRenderBoxes();
-
 	// --- Selected Object Outlining ---
-	HandleObjectOutlining();
+	GameObject* selected = App->scene_manager->GetSelectedGameObject();
 
+	if (selected && selected->GetActive())
+	{
+		ComponentMeshRenderer* MeshRenderer = selected->GetComponent<ComponentMeshRenderer>();
+		ComponentMesh* cmesh = selected->GetComponent<ComponentMesh>();
 
-	// --- Back to defaults ---
-	glDepthFunc(GL_LESS);
+		if (MeshRenderer && MeshRenderer->IsEnabled() && cmesh && cmesh->resource_mesh && MeshRenderer->material)
+			snapshot->outline.push_back(RenderMesh(selected->GetComponent<ComponentTransform>()->GetGlobalTransform(), cmesh->resource_mesh, GetMaterialIndex(MeshRenderer->material), outline));
+	}
 
+	// --- Null renderer, the CPU side of the frame is all a headless run measures ---
+	if (App->IsHeadless())
+	{
+		ClearRenderOrders();
+		return UPDATE_CONTINUE;
+	}
 
-	// --- Unbind fbo ---
-	if (renderfbo)
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (render_thread_running)
+	{
+		// --- Hand the frame to the render thread, simulation of the next one starts right away ---
+		snapshot->gui = App->gui->CloneDrawData();
+		SubmitSnapshot();
+		return UPDATE_CONTINUE;
+	}
+
+	// --- Draw ---
+	DrawSnapshot(*snapshot, main_objects);
 
 	// --- Draw GUI and swap buffers ---
 	App->gui->Draw();
@@ -320,20 +342,51 @@ bool ModuleRenderer3D::CleanUp()
 {
 	CONSOLE_LOG("Destroying 3D Renderer");
 
+	// --- Stop the render thread, it releases its context objects on the way out ---
+	if (render_thread_running)
+	{
+		WaitForRenderThread();
+
+		{
+			std::lock_guard<std::mutex> lock(render_mutex);
+			render_thread_running = false;
+		}
+
+		render_condition.notify_all();
+		render_thread.join();
+
+		SDL_GL_DeleteContext(render_context);
+		render_context = nullptr;
+	}
+
+	for (uint i = 0; i < 2; ++i)
+	{
+		App->gui->FreeDrawData(snapshots[i].gui);
+		snapshots[i].gui = nullptr;
+
+		if (snapshots[i].upload_fence)
+			glDeleteSync(snapshots[i].upload_fence);
+
+		snapshots[i].upload_fence = nullptr;
+	}
+
 	delete screenshot_camera;
 
 	glDeleteBuffers(1, (GLuint*)&Grid_VBO);
-	glDeleteVertexArrays(1, &Grid_VAO);
+	glDeleteBuffers(1, &skyboxVBO);
+	DestroyContextObjects(main_objects);
 
-	glDeleteVertexArrays(1, &skyboxVAO);
-	glDeleteBuffers(1, &skyboxVAO);
-
-	glDeleteFramebuffers(1, &fbo);
 	SDL_GL_DeleteContext(context);
 
 	return true;
 }
 
+void ModuleRenderer3D::SaveStatus(json& file) const
+{
+	file["Renderer3D"]["VSync"] = vsync;
+	file["Renderer3D"]["Pipelined"] = pipelined;
+}
+
 void ModuleRenderer3D::OnResize(int width, int height)
 {
 	// --- Called by UpdateWindowSize() in Window module this when resizing windows to prevent rendering issues ---
@@ -346,8 +399,21 @@ void ModuleRenderer3D::OnResize(int width, int height)
 	else
 		active_camera->SetAspectRatio(height / width);
 
-	glDeleteFramebuffers(1, &fbo);
+	// --- The render thread may still be drawing to the old render target ---
+	WaitForRenderThread();
+
+	if (rendertexture)
+		ReleaseTexture(rendertexture);
+
+	if (depthbuffer)
+		ReleaseTexture(depthbuffer);
+
+	glDeleteFramebuffers(1, &main_objects.fbo);
 	CreateFramebuffer();
+
+	// --- Tell the render thread to rebuild its own fbo ---
+	fbo_generation++;
+	main_objects.fbo_generation = fbo_generation;
 }
 
 // ----------------------------------------------------
@@ -361,6 +427,13 @@ bool ModuleRenderer3D::SetVSync(bool _vsync)
 
 	vsync = _vsync;
 
+	// --- Swap interval belongs to the context that presents, the render thread applies it ---
+	if (render_thread_running)
+	{
+		vsync_changed = true;
+		return ret;
+	}
+
 	if (vsync) {
 
 		if (SDL_GL_SetSwapInterval(1) == -1)
@@ -420,6 +493,67 @@ bool ModuleRenderer3D::GetVSync() const
 	return vsync;
 }
 
+bool ModuleRenderer3D::IsPipelined() const
+{
+	return render_thread_running;
+}
+
+bool ModuleRenderer3D::HasContext() const
+{
+	return context != nullptr;
+}
+
+// ----------------------------------------------------
+
+
+// ------------------------------ GL ownership --------------------------------------------------------
+
+void ModuleRenderer3D::ReleaseBuffer(uint buffer)
+{
+	if (buffer == 0)
+		return;
+
+	// --- Frames in flight may still use it, delete once the next snapshot has been drawn ---
+	if (render_thread_running)
+		pending_buffers.push_back(buffer);
+	else
+		glDeleteBuffers(1, (GLuint*)&buffer);
+}
+
+void ModuleRenderer3D::ReleaseTexture(uint texture)
+{
+	if (texture == 0)
+		return;
+
+	if (render_thread_running)
+		pending_textures.push_back(texture);
+	else
+		glDeleteTextures(1, (GLuint*)&texture);
+}
+
+void ModuleRenderer3D::ReleaseProgram(uint program)
+{
+	if (program == 0)
+		return;
+
+	if (render_thread_running)
+		pending_programs.push_back(program);
+	else
+		glDeleteProgram(program);
+}
+
+void ModuleRenderer3D::WaitForRenderThread()
+{
+	if (!render_thread_running)
+		return;
+
+	OPTICK_CATEGORY("Wait Render Thread", Optick::Category::Wait);
+	PROFILE_SCOPE("Wait Render Thread");
+
+	std::unique_lock<std::mutex> lock(render_mutex);
+	render_condition.wait(lock, [this]() { return !frame_ready; });
+}
+
 // ----------------------------------------------------
 
 
@@ -431,45 +565,43 @@ void ModuleRenderer3D::DrawMesh(const float4x4 transform, const ResourceMesh* me
 	// --- Check data validity
 	if (transform.IsFinite() && mesh && mat)
 	{
-		// --- Add given instance to relevant vector ---
-		if (render_meshes.find(mesh->GetUID()) != render_meshes.end())
-		{
-			RenderMesh rmesh = RenderMesh(transform, mesh, mat, flags);
-			render_meshes[mesh->GetUID()].push_back(rmesh);
-		}
-		else
+		// --- Add given instance to relevant vector, operator[] builds it if this is the first instance ---
+		snapshot->meshes[mesh->GetUID()].push_back(RenderMesh(transform, mesh, GetMaterialIndex(mat), flags));
+
+		// --- Height in pixels of the bounding sphere on screen, the texture streamer loads levels for it ---
+		if (mat->resource_diffuse)
 		{
-			// --- Build new vector to store mesh's instances ---
-			std::vector<RenderMesh> new_vec;
-			RenderMesh rmesh = RenderMesh(transform, mesh, mat, flags);
-			new_vec.push_back(rmesh);
-			render_meshes[mesh->GetUID()] = new_vec;
+			float radius = mesh->aabb.Size().Length() * 0.5f * transform.GetScale().MaxElement();
+			float distance = transform.TransformPos(mesh->aabb.CenterPoint()).Distance(snapshot->camera_pos);
+			float screen_size = distance > radius ? radius / distance * snapshot->projection[1][1] * snapshot->height : (float)snapshot->height;
+
+			App->textures->streamer.Request(mat->resource_diffuse.GetUID(), screen_size);
 		}
 	}
 }
 
 void ModuleRenderer3D::DrawLine(const float4x4 transform, const float3 a, const float3 b, const Color& color)
 {
-	render_lines.push_back(RenderLine(transform, a, b, color));
+	snapshot->lines.push_back(RenderLine(transform, a, b, color));
 }
 
 void ModuleRenderer3D::DrawAABB(const AABB& box, const Color& color)
 {
 	if (box.IsFinite())
-		render_aabbs.push_back(RenderBox<AABB>(&box, color));
+		snapshot->aabbs.push_back(RenderBox<AABB>(box, color));
 }
 void ModuleRenderer3D::DrawOBB(const OBB& box, const Color& color)
 {
 	if (box.IsFinite())
-		render_obbs.push_back(RenderBox<OBB>(&box, color));
+		snapshot->obbs.push_back(RenderBox<OBB>(box, color));
 }
 void ModuleRenderer3D::DrawFrustum(const Frustum& box, const Color& color)
 {
 	if (box.IsFinite())
-		render_frustums.push_back(RenderBox<Frustum>(&box, color));
+		snapshot->frustums.push_back(RenderBox<Frustum>(box, color));
 }
 
-uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos, std::string& out_path)
+uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos, std::string& out_path, uint UID)
 {
 	if (scene_gos.size() == 0)
 		return 0;
@@ -501,32 +633,17 @@ uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos,
 
 	if (Movement.IsFinite())
 		screenshot_camera->frustum.SetPos(center - Movement);
-	
-	PreUpdate(0.0f);
 
-	// --- Set Shader Matrices ---
-	GLint viewLoc = glGetUniformLocation(defaultShader->ID, "view");
-	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, App->renderer3D->active_camera->GetOpenGLViewMatrix().ptr());
+	// --- Drawn on the main context, keep the render thread off the render target meanwhile ---
+	WaitForRenderThread();
 
-	float nearp = App->renderer3D->active_camera->GetNearPlane();
-
-	// right handed projection matrix (just different standard)
-	float f = 1.0f / tan(App->renderer3D->active_camera->GetFOV() * DEGTORAD / 2.0f);
-	float4x4 proj_RH(
-		f / App->renderer3D->active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-		0.0f, f, 0.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, -1.0f,
-		0.0f, 0.0f, nearp, 0.0f);
-
-	GLint projectLoc = glGetUniformLocation(defaultShader->ID, "projection");
-	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
-
-	GLint modelLoc = glGetUniformLocation(defaultShader->ID, "model_matrix");
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.Transposed().ptr());
+	TakeSnapshot();
+	ClearFramebuffers(*snapshot, main_objects);
+	SetShaderMatrices(*snapshot);
 
 	// --- Bind fbo ---
 	if (renderfbo)
-		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, main_objects.fbo);
 
 	// --- Set depth filter to greater (Passes if the incoming depth value is greater than the stored depth value) ---
 	glDepthFunc(GL_GREATER);
@@ -538,7 +655,7 @@ uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos,
 	//DrawGrid();
 
 	// --- Draw ---
-	DrawRenderMeshes();
+	DrawRenderMeshes(*snapshot, main_objects);
 
 	// --- Back to defaults ---
 	glDepthFunc(GL_LESS);
@@ -552,23 +669,28 @@ uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos,
 
 	SDL_Surface* surface = SDL_GetWindowSurface(App->window->window);
 
-	GLubyte* pixels = new GLubyte[surface->w * surface->h * 3];
+	GLubyte* pixels = new GLubyte[surface->w * surface->h * 4];
 
 	glBindTexture(GL_TEXTURE_2D, rendertexture);
 
-	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	uint uid = App->GetRandom().Int();
-	uint texID =  App->textures->CreateTextureFromPixels(GL_RGB, surface->w, surface->h, GL_RGB, pixels);
-	App->textures->CreateAndSaveTextureFromPixels(uid, GL_RGB, surface->w, surface->h, GL_RGB, (void*)pixels, out_path);
+	// --- Previews are opaque, whatever the clear left in alpha ---
+	for (int i = 0; i < surface->w * surface->h; ++i)
+		pixels[i * 4 + 3] = 255;
+
+	// --- The preview shown is the compressed one saved to the library ---
+	uint uid = UID ? UID : App->GetRandom().Int();
+	uint texID = App->textures->CreateAndSaveTextureFromPixels(uid, GL_RGBA, surface->w, surface->h, GL_RGBA, (void*)pixels, out_path);
 
 	delete[] pixels;
 
 	SetActiveCamera(previous_cam);
 
-	PreUpdate(0.0f);
+	TakeSnapshot();
+	ClearFramebuffers(*snapshot, main_objects);
 
 	return texID;
 }
@@ -580,39 +702,82 @@ uint ModuleRenderer3D::RenderSceneToTexture(std::vector<GameObject*>& scene_gos,
 
 void ModuleRenderer3D::ClearRenderOrders()
 {
-	render_meshes.clear();
-	render_obbs.clear();
-	render_aabbs.clear();
-	render_frustums.clear();
-	render_lines.clear();
+	snapshot->ClearOrders();
+}
+
+void ModuleRenderer3D::SetupContextState() const
+{
+	// --- Called once on every context we draw with ---
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	// --- z values from 0 to 1 and not -1 to 1, more precision in far ranges ---
+	glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+
+	// --- Enable stencil testing, set to replace ---
+	glEnable(GL_STENCIL_TEST);
+	glStencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
+
+	// --- Multitexturing ---
+	GLint texture_units = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_UNITS, &texture_units);
+
+	for (int i = 0; i < texture_units; ++i)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glEnable(GL_TEXTURE_2D);
+	}
+
+	glActiveTexture(GL_TEXTURE0);
 }
 
-void ModuleRenderer3D::UpdateGLCapabilities() const
+void ModuleRenderer3D::UpdateGLCapabilities(const RenderSnapshot& snapshot) const
 {
 	// --- Enable/Disable OpenGL Capabilities ---
 
-	if (!depth)
+	if (!snapshot.depth)
 		glDisable(GL_DEPTH_TEST);
 	else
 		glEnable(GL_DEPTH_TEST);
 
-	if (!cull_face)
+	if (!snapshot.cull_face)
 		glDisable(GL_CULL_FACE);
 	else
 		glEnable(GL_CULL_FACE);
 
-	if (!lighting)
+	if (!snapshot.lighting)
 		glDisable(GL_LIGHTING);
 	else
 		glEnable(GL_LIGHTING);
 
-	if (!color_material)
+	if (!snapshot.color_material)
 		glDisable(GL_COLOR_MATERIAL);
 	else
 		glEnable(GL_COLOR_MATERIAL);
 
 }
 
+void ModuleRenderer3D::ClearFramebuffers(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const
+{
+	// --- Update OpenGL Capabilities ---
+	UpdateGLCapabilities(snapshot);
+
+	// --- Clear stencil buffer, enable write ---
+	glStencilMask(0xFF);
+	glClearStencil(0);
+
+	// --- Clear framebuffers ---
+	float backColor = 0.65f;
+	glClearColor(backColor, backColor, backColor, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	glClearDepth(0.0f);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, objects.fbo);
+	glClearColor(backColor, backColor, backColor, 1.0f);
+	glClearDepth(0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 uint ModuleRenderer3D::CreateBufferFromData(uint Targetbuffer, uint size, void* data) const
 {
 	uint ID = 0;
@@ -640,14 +805,253 @@ void ModuleRenderer3D::CreateFramebuffer()
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	// --- Generate framebuffer object (fbo) ---
-	glGenFramebuffers(1, &fbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glGenFramebuffers(1, &main_objects.fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, main_objects.fbo);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rendertexture, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthbuffer, 0);
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void ModuleRenderer3D::CreateContextObjects(RenderContextObjects& objects) const
+{
+	// --- Same objects the main context builds at Init, on top of the shared buffers ---
+	glGenVertexArrays(1, &objects.grid_VAO);
+	glBindVertexArray(objects.grid_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, Grid_VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glGenVertexArrays(1, &objects.skybox_VAO);
+	glBindVertexArray(objects.skybox_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenVertexArrays(1, &objects.pointline_VAO);
+	glGenBuffers(1, &objects.pointline_VBO);
+}
+
+void ModuleRenderer3D::DestroyContextObjects(RenderContextObjects& objects) const
+{
+	glDeleteVertexArrays(1, &objects.grid_VAO);
+	glDeleteVertexArrays(1, &objects.skybox_VAO);
+	glDeleteVertexArrays(1, &objects.pointline_VAO);
+	glDeleteBuffers(1, &objects.pointline_VBO);
+	glDeleteFramebuffers(1, &objects.fbo);
+
+	for (std::map<uint, uint>::iterator it = objects.mesh_VAOs.begin(); it != objects.mesh_VAOs.end(); ++it)
+		glDeleteVertexArrays(1, &(*it).second);
+
+	objects.mesh_VAOs.clear();
+	objects.grid_VAO = objects.skybox_VAO = objects.pointline_VAO = objects.pointline_VBO = objects.fbo = 0;
+}
+
+uint ModuleRenderer3D::GetMaterialIndex(ResourceMaterial* mat)
+{
+	// --- Copy material state once per frame, the render thread reads the copy ---
+	RenderMap<uint, uint>::iterator it = snapshot->material_indices.find(mat->GetUID());
+
+	if (it == snapshot->material_indices.end())
+		it = snapshot->material_indices.insert(std::pair<const uint, uint>(mat->GetUID(), RENDER_INVALID_INDEX)).first;
+	else if ((*it).second != RENDER_INVALID_INDEX)
+		return (*it).second;
+
+	// --- Reuse last frame's slot, assigning uniforms keeps their storage ---
+	if (snapshot->material_count == snapshot->materials.size())
+		snapshot->materials.push_back(RenderMaterial());
+
+	uint index = snapshot->material_count++;
+	(*it).second = index;
+
+	RenderMaterial& rmat = snapshot->materials[index];
+	rmat.shader = mat->shader ? mat->shader->ID : 0;
+	rmat.diffuse = mat->resource_diffuse ? mat->resource_diffuse->GetTexID() : 0;
+	rmat.color = mat->color;
+	rmat.reflective = mat->reflective;
+	rmat.refractive = mat->refractive;
+
+	rmat.uniforms.resize(mat->shader ? mat->uniforms.size() : 0);
+
+	for (uint i = 0; i < rmat.uniforms.size(); ++i)
+		rmat.uniforms[i] = *mat->uniforms[i];
+
+	return index;
+}
+
+void ModuleRenderer3D::TakeSnapshot()
+{
+	// --- Camera ---
+	snapshot->view = active_camera->GetOpenGLViewMatrix();
+	snapshot->camera_pos = active_camera->frustum.Pos();
+	snapshot->nearp = active_camera->GetNearPlane();
+	snapshot->farp = active_camera->GetFarPlane();
+
+	// right handed projection matrix (just different standard)
+	float f = 1.0f / tan(active_camera->GetFOV() * DEGTORAD / 2.0f);
+	snapshot->projection = float4x4(
+		f / active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
+		0.0f, f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, -1.0f,
+		0.0f, 0.0f, snapshot->nearp, 0.0f);
+
+	snapshot->time = App->time->time;
+	snapshot->width = App->window->GetWindowWidth();
+	snapshot->height = App->window->GetWindowHeight();
+
+	// --- Flags ---
+	snapshot->depth = depth;
+	snapshot->cull_face = cull_face;
+	snapshot->lighting = lighting;
+	snapshot->color_material = color_material;
+	snapshot->wireframe = wireframe;
+	snapshot->zdrawer = zdrawer;
+	snapshot->renderfbo = renderfbo;
+	snapshot->display_grid = display_grid;
+}
+
+// ----------------------------------------------------
+
+
+// ------------------------------ Pipelining --------------------------------------------------------
+
+void ModuleRenderer3D::SubmitSnapshot()
+{
+	OPTICK_CATEGORY("Submit Snapshot", Optick::Category::Rendering);
+	PROFILE_SCOPE("Submit Snapshot");
+
+	// --- Make our uploads visible to the render context ---
+	snapshot->upload_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	snapshot->released_buffers.swap(pending_buffers);
+	snapshot->released_textures.swap(pending_textures);
+	snapshot->released_programs.swap(pending_programs);
+
+	// --- Only one frame in flight, the render thread must be done with the previous one ---
+	WaitForRenderThread();
+
+	{
+		std::lock_guard<std::mutex> lock(render_mutex);
+		render_snapshot = snapshot;
+		frame_ready = true;
+	}
+
+	render_condition.notify_all();
+
+	// --- Build the next frame on the other snapshot, the render thread is done with it ---
+	snapshot = (snapshot == &snapshots[0]) ? &snapshots[1] : &snapshots[0];
+
+	App->gui->FreeDrawData(snapshot->gui);
+	snapshot->gui = nullptr;
+	snapshot->ClearOrders();
+}
+
+void ModuleRenderer3D::RenderThreadLoop()
+{
+	OPTICK_THREAD("Render Thread");
+	PROFILE_THREAD("Render Thread");
+
+	SDL_GL_MakeCurrent(App->window->window, render_context);
+	SDL_GL_SetSwapInterval(vsync ? 1 : 0);
+
+	SetupContextState();
+	CreateContextObjects(render_objects);
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(render_mutex);
+			render_condition.wait(lock, [this]() { return frame_ready || !render_thread_running; });
+
+			if (!render_thread_running)
+				break;
+		}
+
+		OPTICK_FRAME("Render Thread");
+		PROFILE_SCOPE("Render Frame");
+
+		RenderSnapshot& frame = *render_snapshot;
+
+		// --- Wait for the uploads the main thread did while building this frame ---
+		if (frame.upload_fence)
+		{
+			glWaitSync(frame.upload_fence, 0, GL_TIMEOUT_IGNORED);
+			glDeleteSync(frame.upload_fence);
+			frame.upload_fence = nullptr;
+		}
+
+		if (vsync_changed.exchange(false))
+			SDL_GL_SetSwapInterval(vsync ? 1 : 0);
+
+		// --- Our fbo is not shared, rebuild it when the main thread resized the render target ---
+		if (render_objects.fbo_generation != fbo_generation)
+		{
+			glDeleteFramebuffers(1, &render_objects.fbo);
+			glGenFramebuffers(1, &render_objects.fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, render_objects.fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rendertexture, 0);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthbuffer, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			render_objects.fbo_generation = fbo_generation;
+		}
+
+		glViewport(0, 0, frame.width, frame.height);
+
+		ClearFramebuffers(frame, render_objects);
+		DrawSnapshot(frame, render_objects);
+		App->gui->DrawData(frame.gui);
+
+		SDL_GL_SwapWindow(App->window->window);
+
+		// --- No frame in flight references these anymore ---
+		ReleaseObjects(frame, render_objects);
+
+		{
+			std::lock_guard<std::mutex> lock(render_mutex);
+			frame_ready = false;
+		}
+
+		render_condition.notify_all();
+	}
+
+	DestroyContextObjects(render_objects);
+	SDL_GL_MakeCurrent(App->window->window, nullptr);
+}
+
+void ModuleRenderer3D::ReleaseObjects(RenderSnapshot& frame, RenderContextObjects& objects) const
+{
+	for (uint i = 0; i < frame.released_buffers.size(); ++i)
+	{
+		// --- Drop the VAO we built for this vertex buffer ---
+		std::map<uint, uint>::iterator it = objects.mesh_VAOs.find(frame.released_buffers[i]);
+
+		if (it != objects.mesh_VAOs.end())
+		{
+			glDeleteVertexArrays(1, &(*it).second);
+			objects.mesh_VAOs.erase(it);
+		}
+	}
+
+	if (!frame.released_buffers.empty())
+		glDeleteBuffers(frame.released_buffers.size(), frame.released_buffers.data());
+
+	if (!frame.released_textures.empty())
+		glDeleteTextures(frame.released_textures.size(), frame.released_textures.data());
+
+	for (uint i = 0; i < frame.released_programs.size(); ++i)
+		glDeleteProgram(frame.released_programs[i]);
+
+	frame.released_buffers.clear();
+	frame.released_textures.clear();
+	frame.released_programs.clear();
+}
+
+// ----------------------------------------------------
+
 void ModuleRenderer3D::CreateDefaultShaders()
 {
 	ImporterShader* IShader = App->resources->GetImporter<ImporterShader>();
@@ -987,7 +1391,7 @@ void ModuleRenderer3D::CreateGrid(float target_distance)
 	// --- Configure vertex attributes ---
 
 	// bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-	glBindVertexArray(Grid_VAO);
+	glBindVertexArray(main_objects.grid_VAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, Grid_VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_DYNAMIC_DRAW);
@@ -1005,32 +1409,84 @@ void ModuleRenderer3D::CreateGrid(float target_distance)
 // ------------------------------ Draw --------------------------------------------------------
 
 
-void ModuleRenderer3D::DrawRenderMeshes()
+void ModuleRenderer3D::DrawSnapshot(const RenderSnapshot& snapshot, RenderContextObjects& objects)
+{
+	SetShaderMatrices(snapshot);
+
+	// --- Bind fbo ---
+	if (snapshot.renderfbo)
+		glBindFramebuffer(GL_FRAMEBUFFER, objects.fbo);
+
+	// --- Do not write to the stencil buffer ---
+	glStencilMask(0x00);
+
+	DrawSkybox(snapshot, objects); // could not manage to draw it after scene with reversed-z ...
+
+	// --- Set depth filter to greater (Passes if the incoming depth value is greater than the stored depth value) ---
+	glDepthFunc(GL_GREATER);
+
+	// --- Draw Grid ---
+	if (snapshot.display_grid)
+		DrawGrid(objects);
+
+	// --- Draw ---
+	DrawRenderMeshes(snapshot, objects);
+	DrawRenderLines(snapshot, objects);
+	DrawRenderBoxes(snapshot, objects);
+
+	// --- Selected Object Outlining ---
+	HandleObjectOutlining(snapshot, objects);
+
+	// --- Back to defaults ---
+	glDepthFunc(GL_LESS);
+
+	// --- Unbind fbo ---
+	if (snapshot.renderfbo)
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ModuleRenderer3D::SetShaderMatrices(const RenderSnapshot& snapshot) const
+{
+	// --- Set Shader Matrices ---
+	glUseProgram(defaultShader->ID);
+
+	GLint viewLoc = glGetUniformLocation(defaultShader->ID, "view");
+	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, snapshot.view.ptr());
+
+	GLint projectLoc = glGetUniformLocation(defaultShader->ID, "projection");
+	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, snapshot.projection.ptr());
+
+	GLint modelLoc = glGetUniformLocation(defaultShader->ID, "model_matrix");
+	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.Transposed().ptr());
+}
+
+void ModuleRenderer3D::DrawRenderMeshes(const RenderSnapshot& snapshot, RenderContextObjects& objects)
 {
 	// --- Activate wireframe mode ---
-	if (wireframe)
+	if (snapshot.wireframe)
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
 	// --- Draw Game Object Meshes ---
-	for (std::map<uint, std::vector<RenderMesh>>::const_iterator it = render_meshes.begin(); it != render_meshes.end(); ++it)
+	for (RenderMap<uint, RenderMeshes>::const_iterator it = snapshot.meshes.begin(); it != snapshot.meshes.end(); ++it)
 	{
-		DrawRenderMesh((*it).second);
+		DrawRenderMesh(snapshot, objects, (*it).second);
 	}
 
 	// --- DeActivate wireframe mode ---
-	if (wireframe)
+	if (snapshot.wireframe)
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
 }
 
-void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
+void ModuleRenderer3D::DrawRenderMesh(const RenderSnapshot& snapshot, RenderContextObjects& objects, const RenderMeshes& meshInstances)
 {
 	for (uint i = 0; i < meshInstances.size(); ++i)
 	{
-		RenderMesh* mesh = &meshInstances[i];
+		const RenderMesh* mesh = &meshInstances[i];
+		const RenderMaterial& mat = snapshot.materials[mesh->material];
 		uint shader = defaultShader->ID;
 		float4x4 model = mesh->transform;
-		Color color = meshInstances[i].mat->color;
+		Color color = mat.color;
 
 		// --- Select/Outline ---
 		if (mesh->flags & RenderMeshFlags_::selected)
@@ -1040,15 +1496,15 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 		}
 
 		// --- Get Mesh Material ---
-		if (mesh->mat->shader)
+		if (mat.shader)
 		{
-			shader = mesh->mat->shader->ID;
-			mesh->mat->UpdateUniforms();
+			shader = mat.shader;
+			UploadUniforms(mat);
 		}
 
-		if(mesh->mat->reflective)
+		if(mat.reflective)
 			shader = SkyboxReflectionShader->ID;
-		else if (mesh->mat->refractive)
+		else if (mat.refractive)
 			shader = SkyboxRefractionShader->ID;
 
 		if (mesh->flags & RenderMeshFlags_::outline)
@@ -1062,7 +1518,7 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 		}
 
 		// --- Display Z buffer ---
-		if (zdrawer)
+		if (snapshot.zdrawer)
 		{
 			shader = ZDrawerShader->ID;
 		}
@@ -1074,34 +1530,23 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, model.Transposed().ptr()); // model matrix
 
 		GLint viewLoc = glGetUniformLocation(shader, "view");
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, active_camera->GetOpenGLViewMatrix().ptr());
+		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, snapshot.view.ptr());
 
 		GLint timeLoc = glGetUniformLocation(shader, "time");
-		glUniform1f(timeLoc, App->time->time);
+		glUniform1f(timeLoc, snapshot.time);
 
 		int TextureSupportLocation = glGetUniformLocation(shader, "Texture"); // as of now, this is only on DefaultShader!
 		int vertexColorLocation = glGetUniformLocation(shader, "Color");
 
-		float farp = active_camera->GetFarPlane();
-		float nearp = active_camera->GetNearPlane();
-
 		// --- Give ZDrawer near and far camera frustum planes pos ---
-		if (zdrawer)
+		if (snapshot.zdrawer)
 		{
 			int nearfarLoc = glGetUniformLocation(shader, "nearfar");
-			glUniform2f(nearfarLoc, nearp, farp);
+			glUniform2f(nearfarLoc, snapshot.nearp, snapshot.farp);
 		}
 
-		// right handed projection matrix
-		float f = 1.0f / tan(active_camera->GetFOV() * DEGTORAD / 2.0f);
-		float4x4 proj_RH(
-			f / active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-			0.0f, f, 0.0f, 0.0f,
-			0.0f, 0.0f, 0.0f, -1.0f,
-			0.0f, 0.0f, nearp, 0.0f);
-
 		GLint projectLoc = glGetUniformLocation(shader, "projection");
-		glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
+		glUniformMatrix4fv(projectLoc, 1, GL_FALSE, snapshot.projection.ptr());
 
 		//Send Color
 		glUniform3f(vertexColorLocation, color.r, color.g, color.b);
@@ -1110,13 +1555,11 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
 		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexID);
-		glUniform3f(glGetUniformLocation(shader, "cameraPos"), active_camera->frustum.Pos().x, active_camera->frustum.Pos().y, active_camera->frustum.Pos().z);
+		glUniform3f(glGetUniformLocation(shader, "cameraPos"), snapshot.camera_pos.x, snapshot.camera_pos.y, snapshot.camera_pos.z);
 
-		if (mesh->resource_mesh->vertices && mesh->resource_mesh->Indices)
+		if (mesh->IndicesSize > 0)
 		{
-			const ResourceMesh* rmesh = mesh->resource_mesh;
-
-			glBindVertexArray(rmesh->VAO);
+			glBindVertexArray(GetMeshVAO(*mesh, objects));
 
 			if (mesh->flags & RenderMeshFlags_::texture)
 			{
@@ -1124,8 +1567,8 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 					glBindTexture(GL_TEXTURE_2D, App->textures->GetCheckerTextureID()); // start using texture
 				else
 				{
-					if(mesh->mat->resource_diffuse)
-						glBindTexture(GL_TEXTURE_2D, mesh->mat->resource_diffuse->GetTexID());	
+					if(mat.diffuse)
+						glBindTexture(GL_TEXTURE_2D, mat.diffuse);	
 					else
 						glBindTexture(GL_TEXTURE_2D, App->textures->GetDefaultTextureID());
 				}
@@ -1133,8 +1576,8 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 			else
 				glUniform1i(TextureSupportLocation, -1);
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rmesh->EBO);
-			glDrawElements(GL_TRIANGLES, rmesh->IndicesSize, GL_UNSIGNED_INT, NULL); // render primitives from array data
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+			glDrawElements(GL_TRIANGLES, mesh->IndicesSize, GL_UNSIGNED_INT, NULL); // render primitives from array data
 
 			glBindVertexArray(0);
 			glBindTexture(GL_TEXTURE_2D, 0); // Stop using buffer (texture)
@@ -1159,12 +1602,75 @@ void ModuleRenderer3D::DrawRenderMesh(std::vector<RenderMesh> meshInstances)
 	glUseProgram(defaultShader->ID);
 }
 
-void ModuleRenderer3D::HandleObjectOutlining()
+void ModuleRenderer3D::UploadUniforms(const RenderMaterial& material) const
 {
-	GameObject* selected = App->scene_manager->GetSelectedGameObject();
+	glUseProgram(material.shader);
+
+	for (uint i = 0; i < material.uniforms.size(); ++i)
+	{
+		const Uniform& uniform = material.uniforms[i];
 
+		switch (uniform.type)
+		{
+		case GL_INT:
+			glUniform1i(uniform.location, uniform.value.intU);
+			break;
+
+		case GL_FLOAT:
+			glUniform1f(uniform.location, uniform.value.floatU);
+			break;
+
+		case GL_FLOAT_VEC2:
+			glUniform2f(uniform.location, uniform.value.vec2U.x, uniform.value.vec2U.y);
+			break;
+
+		case GL_FLOAT_VEC3:
+			glUniform3f(uniform.location, uniform.value.vec3U.x, uniform.value.vec3U.y, uniform.value.vec3U.z);
+			break;
+
+		case GL_FLOAT_VEC4:
+			glUniform4f(uniform.location, uniform.value.vec4U.x, uniform.value.vec4U.y, uniform.value.vec4U.z, uniform.value.vec4U.w);
+			break;
+
+		case GL_INT_VEC2:
+			glUniform2i(uniform.location, uniform.value.vec2U.x, uniform.value.vec2U.y);
+			break;
+
+		case GL_INT_VEC3:
+			glUniform3i(uniform.location, uniform.value.vec3U.x, uniform.value.vec3U.y, uniform.value.vec3U.z);
+			break;
+
+		case GL_INT_VEC4:
+			glUniform4i(uniform.location, uniform.value.vec4U.x, uniform.value.vec4U.y, uniform.value.vec4U.z, uniform.value.vec4U.w);
+			break;
+		}
+	}
+
+	glUseProgram(defaultShader->ID);
+}
+
+uint ModuleRenderer3D::GetMeshVAO(const RenderMesh& mesh, RenderContextObjects& objects) const
+{
+	// --- Main context uses the mesh's own VAO ---
+	if (&objects == &main_objects)
+		return mesh.VAO;
+
+	// --- Render context builds its own the first time it draws the mesh ---
+	std::map<uint, uint>::const_iterator it = objects.mesh_VAOs.find(mesh.VBO);
+
+	if (it != objects.mesh_VAOs.end())
+		return (*it).second;
+
+	uint VAO = ResourceMesh::CreateVertexArray(mesh.VBO);
+	objects.mesh_VAOs[mesh.VBO] = VAO;
+
+	return VAO;
+}
+
+void ModuleRenderer3D::HandleObjectOutlining(const RenderSnapshot& snapshot, RenderContextObjects& objects)
+{
 	// --- Selected Object Outlining ---
-	if(selected)
+	if(!snapshot.outline.empty())
 	{
 		// --- Draw slightly scaled-up versions of the objects, disable stencil writing
 		// The stencil buffer is filled with several 1s. The parts that are 1 are not drawn, only the objects size
@@ -1173,131 +1679,147 @@ void ModuleRenderer3D::HandleObjectOutlining()
 		glStencilMask(0x00);
 		glDisable(GL_DEPTH_TEST);
 
-		// --- Search for Renderer Component ---
-		ComponentMeshRenderer* MeshRenderer = selected->GetComponent<ComponentMeshRenderer>();
-
-		// --- If Found, draw the mesh ---
-		if (MeshRenderer && MeshRenderer->IsEnabled() && selected->GetActive())
-		{
-			std::vector<RenderMesh> meshInstances;
-
-			ComponentMesh* cmesh = selected->GetComponent<ComponentMesh>();
-			RenderMeshFlags flags = outline;
-
-			if (cmesh && cmesh->resource_mesh && MeshRenderer->material)
-			{
-				meshInstances.push_back(RenderMesh(selected->GetComponent<ComponentTransform>()->GetGlobalTransform(), cmesh->resource_mesh, MeshRenderer->material, flags));
-				DrawRenderMesh(meshInstances);
-			}
-		}
+		DrawRenderMesh(snapshot, objects, snapshot.outline);
 
 		glStencilFunc(GL_ALWAYS, 1, 0xFF);
 		glEnable(GL_DEPTH_TEST);
 	}
 }
 
-void ModuleRenderer3D::DrawRenderLines()
+void ModuleRenderer3D::DrawRenderLines(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const
 {
-	// MYTODO: performance wise this is unacceptable, change it
+	if (snapshot.lines.empty())
+		return;
+
 	// --- Use linepoint shader ---
-	glUseProgram(App->renderer3D->linepointShader->ID);
+	glUseProgram(linepointShader->ID);
 
 	// --- Get Uniform locations ---
-	GLint modelLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "model_matrix");
-	GLint viewLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "view");
-	int vertexColorLocation = glGetUniformLocation(App->renderer3D->linepointShader->ID, "Color");
-	GLint projectLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "projection");
-
-	// --- Set Right handed projection matrix ---
-
-	float nearp = App->renderer3D->active_camera->GetNearPlane();
-
-	float f = 1.0f / tan(App->renderer3D->active_camera->GetFOV() * DEGTORAD / 2.0f);
-	float4x4 proj_RH(
-		f / App->renderer3D->active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-		0.0f, f, 0.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, -1.0f,
-		0.0f, 0.0f, nearp, 0.0f);
+	GLint modelLoc = glGetUniformLocation(linepointShader->ID, "model_matrix");
+	GLint viewLoc = glGetUniformLocation(linepointShader->ID, "view");
+	int vertexColorLocation = glGetUniformLocation(linepointShader->ID, "Color");
+	GLint projectLoc = glGetUniformLocation(linepointShader->ID, "projection");
 
 	// --- Set Uniforms ---
-	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
-	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, App->renderer3D->active_camera->GetOpenGLViewMatrix().ptr());
-
-	// --- Initialize vars, prepare buffer ---
-	float3* vertices = new float3[2];
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	glBindVertexArray(PointLineVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, snapshot.projection.ptr());
+	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, snapshot.view.ptr());
 
-	// --- Draw Lines ---
-	for (std::vector<RenderLine>::const_iterator it = render_lines.begin(); it != render_lines.end(); ++it)
+	// --- Every line's a and b, sent in one go ---
+	FrameVector<float3> vertices;
+	vertices.reserve(snapshot.lines.size() * 2);
+
+	for (RenderVector<RenderLine>::const_iterator it = snapshot.lines.begin(); it != snapshot.lines.end(); ++it)
 	{
-		// --- Assign color and model matrix ---
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (*it).transform.Transposed().ptr());
-		glUniform3f(vertexColorLocation, (*it).color.r / 255.0f, (*it).color.g / 255.0f, (*it).color.b / 255.0f);
+		vertices.push_back((*it).a);
+		vertices.push_back((*it).b);
+	}
 
-		// --- Assign line vertices, a and b ---
-		vertices[0] = (*it).a;
-		vertices[1] = (*it).b;
+	UploadLineVertices(vertices.data(), vertices.size(), objects);
 
-		// --- Send data ---
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * 2, vertices, GL_DYNAMIC_DRAW);
+	// --- Draw Lines, each keeps its own color and model matrix ---
+	glLineWidth(3.0f);
 
-		// --- Draw lines ---
-		glLineWidth(3.0f);
-		glDrawArrays(GL_LINES, 0, 2);
-		glLineWidth(1.0f);
+	for (uint i = 0; i < snapshot.lines.size(); ++i)
+	{
+		const RenderLine& line = snapshot.lines[i];
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, line.transform.Transposed().ptr());
+		glUniform3f(vertexColorLocation, line.color.r / 255.0f, line.color.g / 255.0f, line.color.b / 255.0f);
+		glDrawArrays(GL_LINES, i * 2, 2);
 	}
 
+	glLineWidth(1.0f);
+
 	// --- Reset stuff ---
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 
-	// --- Delete VBO and vertices ---
-	glDeleteBuffers(1, &VBO);
-	delete[] vertices;
-
 	// --- Back to default ---
-	glUseProgram(App->renderer3D->defaultShader->ID);
+	glUseProgram(defaultShader->ID);
 }
 
-void ModuleRenderer3D::DrawRenderBoxes()
+// --- Box corners to the 12 edges, as pairs of GL_LINES vertices ---
+static const uint wire_edges[24] = { 1, 5, 7, 3, 4, 0, 2, 6, 5, 4, 6, 7, 0, 1, 3, 2, 1, 3, 0, 2, 5, 7, 4, 6 };
+
+template <typename Box>
+static void AppendWire(FrameVector<float3>& vertices, FrameVector<Color>& colors, const RenderBox<Box>& render_box)
 {
-	for (uint i = 0; i < render_obbs.size(); ++i)
-	{
-		DrawWire(*render_obbs[i].box, render_obbs[i].color, PointLineVAO);
-	}
-	for (uint i = 0; i < render_aabbs.size(); ++i)
-	{
-		DrawWire(*render_aabbs[i].box, render_aabbs[i].color, PointLineVAO);
-	}
+	float3 corners[8];
+	render_box.box.GetCornerPoints(corners);
+
+	for (uint i = 0; i < 24; ++i)
+		vertices.push_back(corners[wire_edges[i]]);
+
+	colors.push_back(render_box.color);
+}
+
+void ModuleRenderer3D::DrawRenderBoxes(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const
+{
+	uint count = snapshot.obbs.size() + snapshot.aabbs.size() + snapshot.frustums.size();
+
+	if (count == 0)
+		return;
 
-	for (uint i = 0; i < render_frustums.size(); ++i)
+	// --- Every box's wire, sent in one go ---
+	FrameVector<float3> vertices;
+	FrameVector<Color> colors;
+	vertices.reserve(count * 24);
+	colors.reserve(count);
+
+	for (uint i = 0; i < snapshot.obbs.size(); ++i)
+		AppendWire(vertices, colors, snapshot.obbs[i]);
+
+	for (uint i = 0; i < snapshot.aabbs.size(); ++i)
+		AppendWire(vertices, colors, snapshot.aabbs[i]);
+
+	for (uint i = 0; i < snapshot.frustums.size(); ++i)
+		AppendWire(vertices, colors, snapshot.frustums[i]);
+
+	// --- Set Uniforms ---
+	glUseProgram(linepointShader->ID);
+
+	GLint modelLoc = glGetUniformLocation(linepointShader->ID, "model_matrix");
+	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.ptr());
+
+	GLint viewLoc = glGetUniformLocation(linepointShader->ID, "view");
+	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, snapshot.view.ptr());
+
+	GLint projectLoc = glGetUniformLocation(linepointShader->ID, "projection");
+	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, snapshot.projection.ptr());
+
+	int vertexColorLocation = glGetUniformLocation(linepointShader->ID, "Color");
+
+	UploadLineVertices(vertices.data(), vertices.size(), objects);
+
+	// --- Draw lines ---
+	glLineWidth(3.0f);
+
+	for (uint i = 0; i < count; ++i)
 	{
-		DrawWire(*render_frustums[i].box, render_frustums[i].color, PointLineVAO);
+		glUniform3f(vertexColorLocation, colors[i].r, colors[i].g, colors[i].b);
+		glDrawArrays(GL_LINES, i * 24, 24);
 	}
+
+	glLineWidth(1.0f);
+	glBindVertexArray(0);
+
+	glUseProgram(defaultShader->ID);
 }
 
-void ModuleRenderer3D::DrawGrid()
+void ModuleRenderer3D::DrawGrid(const RenderContextObjects& objects) const
 {
-	//App->renderer3D->defaultShader->use();
-	glUseProgram(App->renderer3D->defaultShader->ID);
+	glUseProgram(defaultShader->ID);
 
-	GLint modelLoc = glGetUniformLocation(App->renderer3D->defaultShader->ID, "model_matrix");
+	GLint modelLoc = glGetUniformLocation(defaultShader->ID, "model_matrix");
 	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.ptr());
 
 	float gridColor = 0.8f;
-	GLint vertexColorLocation = glGetUniformLocation(App->renderer3D->defaultShader->ID, "Color");
+	GLint vertexColorLocation = glGetUniformLocation(defaultShader->ID, "Color");
 	glUniform3f(vertexColorLocation, gridColor, gridColor, gridColor);
 
-	int TextureSupportLocation = glGetUniformLocation(App->renderer3D->defaultShader->ID, "Texture");
+	int TextureSupportLocation = glGetUniformLocation(defaultShader->ID, "Texture");
 	glUniform1i(TextureSupportLocation, (int)false);
 
 	glLineWidth(1.7f);
-	glBindVertexArray(Grid_VAO);
+	glBindVertexArray(objects.grid_VAO);
 	glDrawArrays(GL_LINES, 0, 164);
 	glBindVertexArray(0);
 	glLineWidth(1.0f);
@@ -1306,147 +1828,51 @@ void ModuleRenderer3D::DrawGrid()
 	glUniform1i(TextureSupportLocation, (int)false);
 }
 
-void ModuleRenderer3D::DrawSkybox()
+void ModuleRenderer3D::DrawSkybox(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const
 {
 	if (!SkyboxShader)
 		return;
 
 	glDepthMask(GL_FALSE);
 
-	float3 prevpos = active_camera->frustum.Pos();
-
-	App->renderer3D->active_camera->frustum.SetPos(float3::zero);
-
-	SkyboxShader->use();
+	glUseProgram(SkyboxShader->ID);
 	// draw skybox as last
 	glDepthFunc(GL_GEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
-	//view = glm::mat4(glm::mat3(camera.GetViewMatrix())); // remove translation from the view matrix
-	float4x4 view = App->renderer3D->active_camera->GetOpenGLViewMatrix();
-	view.SetTranslatePart(float4::zero);
 
-	float nearp = App->renderer3D->active_camera->GetNearPlane();
-
-	// right handed projection matrix
-	float f = 1.0f / tan(App->renderer3D->active_camera->GetFOV() * DEGTORAD / 2.0f);
-	float4x4 proj_RH(
-		f / App->renderer3D->active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-		0.0f, f, 0.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, -1.0f,
-		0.0f, 0.0f, nearp, 0.0f);
+	// --- Remove translation from the view matrix, skybox is always centered on the camera ---
+	float4x4 view = snapshot.view;
+	view.SetTranslatePart(float4::zero);
 
-	GLint viewLoc = glGetUniformLocation(App->renderer3D->SkyboxShader->ID, "view");
+	GLint viewLoc = glGetUniformLocation(SkyboxShader->ID, "view");
 	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, view.ptr());
 
-	GLint projectLoc = glGetUniformLocation(App->renderer3D->SkyboxShader->ID, "projection");
-	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
+	GLint projectLoc = glGetUniformLocation(SkyboxShader->ID, "projection");
+	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, snapshot.projection.ptr());
 
 
 	// skybox cube
-	glBindVertexArray(skyboxVAO);
+	glBindVertexArray(objects.skybox_VAO);
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexID);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 	glBindVertexArray(0);
 	//glDepthFunc(GL_LESS); // set depth function back to default
 
-	defaultShader->use();
+	glUseProgram(defaultShader->ID);
 
-	App->renderer3D->active_camera->frustum.SetPos(prevpos);
 	glDepthMask(GL_TRUE);
 
 }
 
-void ModuleRenderer3D::DrawWireFromVertices(const float3* corners, Color color, uint VAO) {
-	float3 vertices[24] =
-	{
-		//Between-planes right
-		corners[1],
-		corners[5],
-		corners[7],
-		corners[3],
-
-		//Between-planes left
-		corners[4],
-		corners[0],
-		corners[2],
-		corners[6],
-
-		// Far plane horizontal
-		corners[5],
-		corners[4],
-		corners[6],
-		corners[7],
-
-		//Near plane horizontal
-		corners[0],
-		corners[1],
-		corners[3],
-		corners[2],
-
-		//Near plane vertical
-		corners[1],
-		corners[3],
-		corners[0],
-		corners[2],
-
-		//Far plane vertical
-		corners[5],
-		corners[7],
-		corners[4],
-		corners[6]
-	};
-
-	// --- Set Uniforms ---
-	glUseProgram(App->renderer3D->linepointShader->ID);
-
-	float nearp = App->renderer3D->active_camera->GetNearPlane();
-
-	// right handed projection matrix
-	float f = 1.0f / tan(App->renderer3D->active_camera->GetFOV() * DEGTORAD / 2.0f);
-	float4x4 proj_RH(
-		f / App->renderer3D->active_camera->GetAspectRatio(), 0.0f, 0.0f, 0.0f,
-		0.0f, f, 0.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, -1.0f,
-		0.0f, 0.0f, nearp, 0.0f);
-
-	GLint modelLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "model_matrix");
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, float4x4::identity.ptr());
-
-	GLint viewLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "view");
-	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, App->renderer3D->active_camera->GetOpenGLViewMatrix().ptr());
-
-	GLint projectLoc = glGetUniformLocation(App->renderer3D->linepointShader->ID, "projection");
-	glUniformMatrix4fv(projectLoc, 1, GL_FALSE, proj_RH.ptr());
-
-	int vertexColorLocation = glGetUniformLocation(App->renderer3D->linepointShader->ID, "Color");
-	glUniform3f(vertexColorLocation, color.r, color.g, color.b);
-
-	// --- Create VAO, VBO ---
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	// bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_DYNAMIC_DRAW);
+void ModuleRenderer3D::UploadLineVertices(const float3* vertices, uint count, const RenderContextObjects& objects) const
+{
+	// --- Orphan last frame's storage so the driver does not wait for draws still reading it ---
+	glBindVertexArray(objects.pointline_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, objects.pointline_VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float3) * count, vertices, GL_STREAM_DRAW);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-
 	glEnableVertexAttribArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	// --- Draw lines ---
-
-	glLineWidth(3.0f);
-	glBindVertexArray(VAO);
-	glDrawArrays(GL_LINES, 0, 24);
-	glBindVertexArray(0);
-	glLineWidth(1.0f);
-
-	// --- Delete VBO ---
-	glDeleteBuffers(1, &VBO);
-
-	glUseProgram(App->renderer3D->defaultShader->ID);
 }
 
 // ----------------------------------------------------
@@ -5,8 +5,15 @@
 #include "Globals.h"
 #include "Light.h"
 #include "JSONLoader.h"
+#include "ResourceShader.h"
+#include "Allocator.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #define MAX_LIGHTS 8
+#define RENDER_INVALID_INDEX 0xFFFFFFFF
 
 class ComponentCamera;
 class ResourceShader;
@@ -14,6 +21,8 @@ class ResourceMesh;
 class ResourceMaterial;
 class math::float4x4;
 class GameObject;
+struct ImDrawData;
+typedef struct __GLsync *GLsync;
 
 typedef int RenderMeshFlags;
 
@@ -29,23 +38,39 @@ enum  RenderMeshFlags_
 
 struct  RenderMesh
 {
-	RenderMesh(float4x4 transform, const ResourceMesh* mesh, ResourceMaterial* mat, const RenderMeshFlags flags = 0) : transform(transform), resource_mesh(mesh), mat(mat), flags(flags){}
+	RenderMesh(float4x4 transform, const ResourceMesh* mesh, uint material, const RenderMeshFlags flags = 0);
 
 	float4x4 transform;
-	const ResourceMesh* resource_mesh = nullptr;
-	ResourceMaterial* mat = nullptr;
+
+	// --- Copied from the mesh, so the render thread never touches the resource ---
+	uint VAO = 0; // Only valid on the main context
+	uint VBO = 0;
+	uint EBO = 0;
+	uint IndicesSize = 0;
+
+	uint material = 0; // Index into RenderSnapshot::materials
 	//	Color color; // force a color draw, useful if no texture is given
 
 	// --- Add rendering options here ---
 	RenderMeshFlags flags = None;
 };
 
+struct RenderMaterial
+{
+	uint shader = 0;
+	uint diffuse = 0;
+	Color color;
+	bool reflective = false;
+	bool refractive = false;
+	std::vector<Uniform> uniforms;
+};
+
 template <typename Box>
 struct  RenderBox
 {
-	RenderBox(const Box* box, const Color& color) : box(box), color(color) {}
+	RenderBox(const Box& box, const Color& color) : box(box), color(color) {}
 
-	const Box* box;
+	Box box;
 	Color color;
 };
 
@@ -59,6 +84,80 @@ struct  RenderLine
 	Color color;
 };
 
+// --- Render orders are rebuilt every frame, they are accounted on the render heap ---
+template <typename T>
+using RenderVector = std::vector<T, TaggedAllocator<T, MemoryTag::Render>>;
+
+template <typename Key, typename T>
+using RenderMap = std::map<Key, T, std::less<Key>, TaggedAllocator<std::pair<const Key, T>, MemoryTag::Render>>;
+
+typedef RenderVector<RenderMesh> RenderMeshes;
+
+// --- Everything needed to draw a frame, built by the main thread and never modified once submitted ---
+struct RenderSnapshot
+{
+	void ClearOrders();
+
+	// --- Camera ---
+	float4x4 view = float4x4::identity;
+	float4x4 projection = float4x4::identity;
+	float3 camera_pos = float3::zero;
+	float nearp = 0.0f;
+	float farp = 0.0f;
+	float time = 0.0f;
+	int width = 0;
+	int height = 0;
+
+	// --- Flags ---
+	bool depth = true;
+	bool cull_face = true;
+	bool lighting = false;
+	bool color_material = true;
+	bool wireframe = false;
+	bool zdrawer = false;
+	bool renderfbo = true;
+	bool display_grid = true;
+
+	// --- Render orders ---
+	RenderMap<uint, RenderMeshes> meshes;
+	RenderMeshes outline;
+	RenderVector<RenderMaterial> materials; // Only the first material_count are this frame's
+	uint material_count = 0;
+	RenderMap<uint, uint> material_indices; // Material UID to index into materials, RENDER_INVALID_INDEX if unused this frame
+	RenderVector<RenderBox<AABB>> aabbs;
+	RenderVector<RenderBox<OBB>> obbs;
+	RenderVector<RenderBox<Frustum>> frustums;
+	RenderVector<RenderLine> lines;
+
+	// --- Editor ---
+	ImDrawData* gui = nullptr;
+
+	// --- Pipelined only, uploads to wait for and GL objects to delete once drawn ---
+	GLsync upload_fence = nullptr;
+	std::vector<uint> released_buffers;
+	std::vector<uint> released_textures;
+	std::vector<uint> released_programs;
+};
+
+// --- GL container objects (VAOs, FBOs) are not shared between contexts, each context keeps its own ---
+struct RenderContextObjects
+{
+	uint fbo = 0;
+	uint fbo_generation = 0;
+	uint grid_VAO = 0;
+	uint skybox_VAO = 0;
+	uint pointline_VAO = 0;
+	uint pointline_VBO = 0; // Lines and wires, refilled every frame
+	std::map<uint, uint> mesh_VAOs; // VBO to VAO, only used by the render thread's context
+};
+
+// --- GL ownership ---
+// Buffers, textures and shader programs are created on the main thread's context, by ResourceMesh::LoadInMemory, 
+// ModuleTextures and ResourceShader. With pipelined frames the render thread has its own context sharing them, 
+// which sees every upload made before a snapshot is submitted. Shared objects must never be deleted directly, 
+// release them through ReleaseBuffer/ReleaseTexture/ReleaseProgram so they outlive the frames still in flight. 
+// VAOs and FBOs belong to the context that created them.
+
 class ModuleRenderer3D : public Module
 {
 	friend class ModuleResourceManager;
@@ -72,6 +171,7 @@ public:
 	update_status PreUpdate(float dt) override;
 	update_status PostUpdate(float dt) override;
 	bool CleanUp() override;
+	void SaveStatus(json& file) const override;
 
 	void OnResize(int width, int height);
 
@@ -82,6 +182,14 @@ public:
 
 	// --- Getters ---
 	bool GetVSync() const;
+	bool IsPipelined() const;
+	bool HasContext() const; // False in headless tools, which never Init the renderer
+
+	// --- GL ownership ---
+	void ReleaseBuffer(uint buffer);
+	void ReleaseTexture(uint texture);
+	void ReleaseProgram(uint program);
+	void WaitForRenderThread();
 
 	// --- Render orders --- // Deformable mesh is Temporal!
 	void DrawMesh(const float4x4 transform, const ResourceMesh* mesh, ResourceMaterial* mat, const RenderMeshFlags flags = 0);
@@ -89,38 +197,45 @@ public:
 	void DrawAABB(const AABB& box, const Color& color);
 	void DrawOBB(const OBB& box, const Color& color);
 	void DrawFrustum(const Frustum& box, const Color& color);
-	uint RenderSceneToTexture(std::vector<GameObject*>& scene_gos, std::string & out_path);
+	uint RenderSceneToTexture(std::vector<GameObject*>& scene_gos, std::string & out_path, uint UID = 0); // UID of the saved texture, 0 draws a new one
 
 private:
 	// --- Utilities ---
 	void ClearRenderOrders();
-	void UpdateGLCapabilities() const;
+	void SetupContextState() const;
+	void UpdateGLCapabilities(const RenderSnapshot& snapshot) const;
+	void ClearFramebuffers(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const;
 	uint CreateBufferFromData(uint Targetbuffer, uint size, void* data) const;
 	void CreateFramebuffer();
+	void CreateContextObjects(RenderContextObjects& objects) const;
+	void DestroyContextObjects(RenderContextObjects& objects) const;
+	uint GetMaterialIndex(ResourceMaterial* mat);
+	void TakeSnapshot();
+
+	// --- Pipelining ---
+	void SubmitSnapshot();
+	void RenderThreadLoop();
+	void ReleaseObjects(RenderSnapshot& snapshot, RenderContextObjects& objects) const;
 	void CreateDefaultShaders();
 	void CreateGrid(float target_distance);
 
 private:
 
 	// --- Draw ---
-	void DrawRenderMeshes();
-	void DrawRenderMesh(std::vector<RenderMesh> meshInstances);
-	void HandleObjectOutlining();
-	void DrawRenderLines();
-	void DrawRenderBoxes();
-	void DrawGrid();
-	void DrawSkybox();
-
-	// --- Draw Wireframe using given vertices ---
-	template <typename Box>
-	static void DrawWire(const Box& box, Color color, uint VAO)
-	{
-		float3 corners[8];
-		box.GetCornerPoints(corners);
-		DrawWireFromVertices(corners, color, VAO);
-	};
-
-	static void DrawWireFromVertices(const float3* corners, Color color, uint VAO);
+	void DrawSnapshot(const RenderSnapshot& snapshot, RenderContextObjects& objects);
+	void SetShaderMatrices(const RenderSnapshot& snapshot) const;
+	void DrawRenderMeshes(const RenderSnapshot& snapshot, RenderContextObjects& objects);
+	void DrawRenderMesh(const RenderSnapshot& snapshot, RenderContextObjects& objects, const RenderMeshes& meshInstances);
+	void HandleObjectOutlining(const RenderSnapshot& snapshot, RenderContextObjects& objects);
+	void DrawRenderLines(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const;
+	void DrawRenderBoxes(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const;
+	void DrawGrid(const RenderContextObjects& objects) const;
+	void DrawSkybox(const RenderSnapshot& snapshot, const RenderContextObjects& objects) const;
+	void UploadUniforms(const RenderMaterial& material) const;
+	uint GetMeshVAO(const RenderMesh& mesh, RenderContextObjects& objects) const;
+
+	// --- Lines and wires of a frame share one buffer, filled once and drawn in ranges ---
+	void UploadLineVertices(const float3* vertices, uint count, const RenderContextObjects& objects) const;
 
 public:
 	// --- Default Shader ---
@@ -139,7 +254,8 @@ public:
 	ComponentCamera* culling_camera = nullptr;
 	ComponentCamera* screenshot_camera = nullptr;
 
-	SDL_GLContext context;
+	SDL_GLContext context = nullptr;
+	SDL_GLContext render_context = nullptr;
 
 	// --- Flags ---
 	bool vsync = true;
@@ -152,24 +268,35 @@ public:
 	bool renderfbo = true;
 	bool display_boundingboxes = false;
 	bool display_grid = true;
+	bool pipelined = false; // Saved setting, the render thread is only created at Init
 
 	uint rendertexture = 0;
 
 private:
-	std::map<uint, std::vector<RenderMesh>> render_meshes;
-
-	std::vector<RenderBox<AABB>> render_aabbs;
-	std::vector<RenderBox<OBB>> render_obbs;
-	std::vector<RenderBox<Frustum>> render_frustums;
-	std::vector<RenderLine> render_lines;
-
-	uint fbo = 0;
+	// --- Main thread builds one snapshot while the render thread draws the other ---
+	RenderSnapshot snapshots[2];
+	RenderSnapshot* snapshot = &snapshots[0];
+	RenderSnapshot* render_snapshot = nullptr;
+
+	std::vector<uint> pending_buffers;
+	std::vector<uint> pending_textures;
+	std::vector<uint> pending_programs;
+
+	RenderContextObjects main_objects;
+	RenderContextObjects render_objects;
+
+	// --- Render thread ---
+	std::thread render_thread;
+	std::mutex render_mutex;
+	std::condition_variable render_condition;
+	bool frame_ready = false;
+	bool render_thread_running = false;
+	std::atomic<bool> vsync_changed;
+
+	uint fbo_generation = 0;
 	uint cubemapTexID = 0;
-	uint skyboxVAO = 0;
 	uint skyboxVBO = 0;
 	uint depthbuffer = 0;
-	uint PointLineVAO = 0;
-	uint Grid_VAO = 0;
 	uint Grid_VBO = 0;
 	uint maxSimultaneousTextures = 0;
 };
@@ -5,6 +5,10 @@
 #include "ModuleTextures.h"
 #include "ModuleSceneManager.h"
 #include "ModuleRenderer3D.h"
+#include "ModuleEventManager.h"
+#include "ModuleJobs.h"
+#include "FrameScheduler.h"
+#include "Logger.h"
 
 #include "Importers.h"
 #include "Resources.h"
@@ -14,16 +18,20 @@
 #include "Assimp/include/cimport.h"
 
 #pragma comment (lib, "Assimp/libx86/assimp-vc142-mt.lib")
+#include "Profiler.h"
+#include "PerfTimer.h"
+
+#include <unordered_set>
 
 #include "mmgr/mmgr.h"
 
 // --- Get Assimp LOGS and print them to console ---
 void MyAssimpCallback(const char* msg, char* userData)
 {
-	CONSOLE_LOG("[Assimp]: %s", msg);
+	LOG_DEBUG(LogCategory::Importers, "[Assimp]: %s", msg);
 }
 
-ModuleResourceManager::ModuleResourceManager(bool start_enabled)
+ModuleResourceManager::ModuleResourceManager(bool start_enabled) : scan_decoded_bytes(0)
 {
 	name = "Resource Manager";
 }
@@ -37,6 +45,7 @@ bool ModuleResourceManager::Init(json file)
 	// --- Stream LOG messages to MyAssimpCallback, that sends them to console ---
 	struct aiLogStream stream;
 	stream.callback = MyAssimpCallback;
+	stream.user = nullptr;
 	aiAttachLogStream(&stream);
 
     
@@ -56,6 +65,8 @@ bool ModuleResourceManager::Init(json file)
 
 bool ModuleResourceManager::Start()
 {
+	PROFILE_FUNCTION();
+
 	// --- Import all resources in Assets at startup ---
 	App->gui->CreateIcons();
 
@@ -96,11 +107,20 @@ bool ModuleResourceManager::Start()
 	filters.push_back("glsl");
 
 	// --- Import files and folders ---
-	AssetsFolder = SearchAssets(nullptr, ASSETS_FOLDER, filters);
+	asset_db.Open(ASSET_DATABASE_FILE);
+	dependencies.Load(ASSET_DEPENDENCIES_FILE);
+	AssetsFolder = ScanAssets(ASSETS_FOLDER, filters);
+
+	// --- Library meshes of older versions, over the next frames ---
+	GetImporter<ImporterMesh>()->ConvertLibrary();
 
 	// --- Manage changes ---
 	HandleFsChanges();
 
+	// --- Written now too, a crash would otherwise throw away what this start learned ---
+	asset_db.Save(ASSET_DATABASE_FILE);
+	dependencies.Save(ASSET_DEPENDENCIES_FILE);
+
 	// --- Tell Windows to notify us when changes to given directory and subtree occur ---
 	App->fs->WatchDirectory(ASSETS_FOLDER);
 
@@ -124,72 +144,273 @@ std::string ModuleResourceManager::DuplicateIntoGivenFolder(const char* path, co
 	return new_path;
 }
 
-// --- Sweep over all files in given directory, if those files pass the given filters, call Import and if it succeeds add them to the given resource folder ---
-ResourceFolder* ModuleResourceManager::SearchAssets(ResourceFolder* parent, const char* directory, std::vector<std::string>& filters)
+// --- Sweep over all files in given directory, those that pass the given filters are imported into a resource folder tree ---
+// --- Directories are listed, metas and library files parsed and new models decoded on workers. Resources are created on
+// the main thread, a folder before its subfolders and then its files sorted by name, so UIDs drawn on import do not change ---
+ResourceFolder* ModuleResourceManager::ScanAssets(const char* directory, std::vector<std::string>& filters)
 {
-	std::vector<std::string> files;
-	std::vector<std::string> dirs;
+	PROFILE_FUNCTION();
 
-	std::string dir((directory) ? directory : "");
+	PerfTimer timer;
 
-	App->fs->DiscoverFiles(dir.c_str(), files, dirs);
+	std::vector<ScanDirectory> directories;
+	std::unordered_set<std::string> known_files;
 
-	// --- Import folder ---
-	Importer::ImportData IData(dir.c_str());
-	ResourceFolder* folder = (ResourceFolder*)ImportFolder(IData);
+	// --- The library is listed too, most of what importers check for lives there ---
+	directories.resize(2);
+	directories[0].path = directory ? directory : "";
+	directories[1].path = LIBRARY_FOLDER;
+	directories[1].library = true;
 
-	// --- If parent is not nullptr add ourselves as childs ---
-	if (parent)
-		parent->AddChild(folder);
+	// --- A level of the tree at a time, every directory in it on its own job ---
+	uint level_begin = 0;
 
-	for (std::vector<std::string>::const_iterator it = dirs.begin(); it != dirs.end(); ++it)
+	while (level_begin < directories.size())
 	{
-		SearchAssets(folder,(dir + (*it) + "/").c_str(), filters);
+		uint level_end = directories.size();
+
+		App->jobs->ParallelFor(level_end - level_begin, 1, [this, &directories, &filters, level_begin](uint begin, uint end)
+		{
+			for (uint i = begin; i < end; ++i)
+				ListScanDirectory(directories[level_begin + i], filters);
+		});
+
+		// --- Children are numbered in listing order ---
+		for (uint i = level_begin; i < level_end; ++i)
+		{
+			known_files.insert(directories[i].listed.begin(), directories[i].listed.end());
+
+			for (uint j = 0; j < directories[i].dirs.size(); ++j)
+			{
+				ScanDirectory child;
+				child.path = directories[i].path + directories[i].dirs[j] + "/";
+				child.parent = i;
+				child.library = directories[i].library;
+
+				directories[i].children.push_back(directories.size());
+				directories.push_back(child);
+			}
+		}
+
+		level_begin = level_end;
 	}
 
-	// --- Now import all of its engine-supported files ---
-	std::sort(files.begin(), files.end());
+	uint listed_files = known_files.size();
+	App->fs->SetKnownFiles(known_files);
 
-	for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+	// --- A folder, its subfolders and then its files ---
+	std::vector<ScanStep> steps;
+	FlattenScan(0, directories, steps);
+
+	std::vector<ResourceFolder*> scanned_folders(directories.size(), nullptr);
+	ImporterModel* IModel = GetImporter<ImporterModel>();
+
+	for (uint first = 0; first < steps.size(); first += ASSET_SCAN_CHUNK)
 	{
-		const std::string& str = *it;
+		uint count = steps.size() - first < ASSET_SCAN_CHUNK ? steps.size() - first : ASSET_SCAN_CHUNK;
 
-		bool pass_filter = false;
+		// --- Models are decoded one at a time (see ImporterModel::ImportScene), alongside the rest of the chunk's work ---
+		scan_decoded_bytes = 0;
 
-		if (filters.size() > 0)
+		App->jobs->ParallelFor(count, 1, [this, &steps, first](uint begin, uint end)
 		{
-			for (uint i = 0; i < filters.size(); ++i)
+			for (uint i = begin; i < end; ++i)
+				PrepareScanStep(steps[first + i]);
+		});
+
+		for (uint i = first; i < first + count; ++i)
+		{
+			ScanStep& step = steps[i];
+
+			if (!step.meta.is_null())
+				App->GetJLoader()->Prefetch(step.meta_file.c_str(), step.meta);
+
+			if (!step.resource.is_null())
+				App->GetJLoader()->Prefetch(step.resource_file.c_str(), step.resource);
+
+			if (step.image.pixels)
+				App->textures->PrefetchImage(step.path.c_str(), step.image);
+		}
+
+		// --- Import in order on the main thread, this is where UIDs are drawn and GL is touched ---
+		for (uint i = first; i < first + count; ++i)
+		{
+			ScanStep& step = steps[i];
+			Importer::ImportData IData(step.path.c_str());
+
+			if (step.folder)
 			{
-				std::string extension = (str.substr(str.find_last_of(".") + 1));
-				App->fs->NormalizePath(extension, true);
+				ResourceFolder* folder = (ResourceFolder*)ImportFolder(IData);
+				scanned_folders[step.directory] = folder;
 
-				if (extension == filters[i])
+				int parent = directories[step.directory].parent;
+
+				if (parent >= 0 && scanned_folders[parent])
+					scanned_folders[parent]->AddChild(folder);
+			}
+			else
+			{
+				Resource* resource = ImportAssets(IData);
+
+				if (resource)
 				{
-					pass_filter = true;
-					break;
+					Event e(Event::EventType::Resource_loaded);
+					e.uid = resource->GetUID();
+					App->event_manager->PushEvent(e);
 				}
 			}
 		}
+
+		// --- What no importer asked for ---
+		App->GetJLoader()->ClearPrefetched();
+		App->textures->ClearPrefetchedImages();
+
+		if (IModel)
+			IModel->ReleasePrefetchedScenes();
+	}
+
+	App->fs->ClearKnownFiles();
+
+	CONSOLE_LOG("Scanned %u directories, %u files and imported %u assets in %.2f ms, %u metas up to date in the asset database", directories.size(), listed_files, steps.size(), timer.ReadMs(), asset_db.GetHits());
+
+	return scanned_folders[0];
+}
+
+void ModuleResourceManager::ListScanDirectory(ScanDirectory& directory, const std::vector<std::string>& filters) const
+{
+	std::vector<std::string> files;
+	App->fs->DiscoverFiles(directory.path.c_str(), files, directory.dirs);
+
+	for (uint i = 0; i < files.size(); ++i)
+		directory.listed.push_back(directory.path + files[i]);
+
+	if (directory.library)
+		return;
+
+	for (uint i = 0; i < files.size(); ++i)
+	{
+		if (PassesFilters(files[i], filters))
+			directory.files.push_back(files[i]);
+	}
+
+	std::sort(directory.files.begin(), directory.files.end());
+}
+
+void ModuleResourceManager::FlattenScan(uint index, const std::vector<ScanDirectory>& directories, std::vector<ScanStep>& steps) const
+{
+	const ScanDirectory& directory = directories[index];
+
+	ScanStep step;
+	step.path = directory.path;
+	step.directory = index;
+	step.folder = true;
+	steps.push_back(step);
+
+	for (uint i = 0; i < directory.children.size(); ++i)
+		FlattenScan(directory.children[i], directories, steps);
+
+	for (uint i = 0; i < directory.files.size(); ++i)
+	{
+		ScanStep file_step;
+		file_step.path = directory.path + directory.files[i];
+		file_step.directory = index;
+		steps.push_back(file_step);
+	}
+}
+
+// --- Worker side of the scan, only reads. Anything it gets wrong is read again by the importer ---
+void ModuleResourceManager::PrepareScanStep(ScanStep& step)
+{
+	PROFILE_FUNCTION();
+
+	// --- A folder's meta sits next to it ---
+	std::string asset = step.path;
+
+	if (step.folder)
+		asset.pop_back();
+
+	step.meta_file = asset + ".meta";
+
+	uint UID = 0;
+	AssetRecord record;
+
+	// --- Metas the asset database is up to date with are not read at all ---
+	if (asset_db.Find(asset.c_str(), record))
+		UID = record.UID;
+
+	else if (App->fs->Exists(step.meta_file.c_str()))
+	{
+		step.meta = App->GetJLoader()->Load(step.meta_file.c_str());
+
+		if (step.meta.is_object() && step.meta.find("UID") != step.meta.end())
+		{
+			const json& UID_node = step.meta["UID"];
+
+			if (UID_node.is_number_unsigned())
+				UID = UID_node.get<uint>();
+			else if (UID_node.is_string())
+				UID = strtoul(UID_node.get<std::string>().c_str(), nullptr, 10);
+		}
+	}
+
+	if (step.folder)
+		return;
+
+	switch (GetResourceTypeFromPath(step.path.c_str()))
+	{
+	case Resource::ResourceType::MODEL:
+		// --- Imported models are loaded from their library file, the rest are decoded here ---
+		if (UID != 0 && App->fs->Exists((MODELS_FOLDER + std::to_string(UID) + ".model").c_str()))
+		{
+			step.resource_file = MODELS_FOLDER + std::to_string(UID) + ".model";
+			step.resource = App->GetJLoader()->Load(step.resource_file.c_str());
+		}
 		else
-		pass_filter = true;
+		{
+			ImporterModel* IModel = GetImporter<ImporterModel>();
 
+			if (IModel)
+				IModel->PrefetchScene(step.path.c_str());
+		}
+		break;
 
-		// --- If the given file has a compatible extension, try to import it ---
-		if (pass_filter)
+	case Resource::ResourceType::MATERIAL:
+	case Resource::ResourceType::PREFAB:
+		// --- Read from the asset itself ---
+		if (UID != 0)
 		{
-			std::string path = directory;
-			path.append((*it).data());
-			Importer::ImportData IData2(path.c_str());
-			Resource* resource = ImportAssets(IData2);
+			step.resource_file = step.path;
+			step.resource = App->GetJLoader()->Load(step.resource_file.c_str());
 		}
+		break;
+
+	case Resource::ResourceType::TEXTURE:
+	{
+		// --- Textures load as soon as they are imported, those not compressed into the library yet are decoded here ---
+		std::string library_file;
+
+		if (UID != 0)
+			App->textures->GetLibraryPath(UID, library_file);
+
+		ImageInfo info;
+
+		if ((UID == 0 || !App->fs->Exists(library_file.c_str())) && App->textures->ReadImageInfo(step.path.c_str(), info)
+			&& scan_decoded_bytes.fetch_add(info.size) + info.size <= ASSET_SCAN_DECODE_BUDGET)
+			App->textures->DecodeImage(step.path.c_str(), step.image);
+
+		break;
 	}
 
-	return folder;
+	default:
+		break;
+	}
 }
 
 // --- Identify resource by file extension, call relevant importer, prepare everything for its use ---
 Resource* ModuleResourceManager::ImportAssets(Importer::ImportData& IData)
 {
+	PROFILE_FUNCTION();
+
 	static_assert(static_cast<int>(Resource::ResourceType::UNKNOWN) == 9, "Resource Import Switch needs to be updated");
 
 	// --- Only standalone resources go through import here, mesh and some materials are imported through model's importer ---
@@ -251,7 +472,24 @@ Resource* ModuleResourceManager::ImportAssets(Importer::ImportData& IData)
 		if(type != Resource::ResourceType::META)
 			AddResourceToFolder(resource);
 
-		CONSOLE_LOG("Imported successfully: %s", IData.path);
+		// --- Remember what the asset brought in ---
+		if (type != Resource::ResourceType::META)
+		{
+			std::vector<uint> produced;
+			produced.push_back(resource->GetUID());
+
+			if (type == Resource::ResourceType::MODEL)
+			{
+				std::vector<Resource*>* model_resources = ((ResourceModel*)resource)->GetResources();
+
+				for (uint i = 0; i < model_resources->size(); ++i)
+					produced.push_back((*model_resources)[i]->GetUID());
+			}
+
+			asset_db.SetProduced(IData.path, type, produced);
+		}
+
+		LOG_DEBUG(LogCategory::Resources, "Imported successfully: %s", IData.path);
 	}
 	else
 		CONSOLE_LOG("![Warning]: Could not import: %s", IData.path);
@@ -462,6 +700,8 @@ Resource* ModuleResourceManager::ImportMeta(Importer::ImportData& IData)
 
 void ModuleResourceManager::HandleFsChanges()
 {
+	PROFILE_FUNCTION();
+
 	// --- First retrieve all windows fs files and directories in ASSETS ---
 	std::map<std::string, std::vector<std::string>> dirs;
 
@@ -470,6 +710,7 @@ void ModuleResourceManager::HandleFsChanges()
 
 	// --- Now compare to engine's, we need to handle overwrite/creation/deletion ---
 	// Same strategy as Unity, no support for movement/rename of elements
+	std::vector<uint> reimported;
 
 	for (std::map<uint, ResourceMeta*>::iterator meta = metas.begin(); meta != metas.end(); ++meta)
 	{
@@ -537,6 +778,8 @@ void ModuleResourceManager::HandleFsChanges()
 							// Update meta
 							Resource* meta_res = (*meta).second;
 							meta_res->OnOverwrite();
+
+							reimported.push_back(resource->GetUID());
 						}
 					}
 
@@ -582,6 +825,8 @@ void ModuleResourceManager::HandleFsChanges()
 
 	}
 
+	ReimportDependents(reimported, "Source changed");
+
 	// ---  Delete all metas that are now orphan :( ---
 	for (std::map<uint, ResourceMeta*>::iterator meta = metas.begin(); meta != metas.end();)
 	{
@@ -623,6 +868,366 @@ void ModuleResourceManager::HandleFsChanges()
 	}
 }
 
+bool ModuleResourceManager::PassesFilters(const std::string& file, const std::vector<std::string>& filters) const
+{
+	bool pass_filter = filters.empty();
+
+	std::string extension = (file.substr(file.find_last_of(".") + 1));
+	App->fs->NormalizePath(extension, true);
+
+	for (uint j = 0; j < filters.size() && !pass_filter; ++j)
+		pass_filter = extension == filters[j];
+
+	return pass_filter;
+}
+
+void ModuleResourceManager::HandleFsEvents()
+{
+	PROFILE_FUNCTION();
+
+	std::vector<FileEvent> events;
+	App->fs->TakeFileEvents(events);
+
+	if (events.empty())
+		return;
+
+	// --- The OS lost track of something, only a full pass can tell what ---
+	for (uint i = 0; i < events.size(); ++i)
+	{
+		if (events[i].type == FileEventType::Rescan)
+		{
+			CONSOLE_LOG("![Warning]: Too many file changes at once, checking the whole project");
+			HandleFsChanges();
+			return;
+		}
+	}
+
+	PerfTimer timer;
+
+	// --- Hash what was written on workers, only assets we import ---
+	App->jobs->ParallelFor(events.size(), 1, [this, &events](uint begin, uint end)
+	{
+		for (uint i = begin; i < end; ++i)
+		{
+			FileEvent& event = events[i];
+			bool written = event.type == FileEventType::Created || event.type == FileEventType::Modified;
+
+			if (written && !event.directory && GetResourceTypeFromPath(event.path.c_str()) != Resource::ResourceType::META && PassesFilters(event.path, filters))
+				event.hash = App->fs->HashFile(event.path.c_str());
+		}
+	});
+
+	// --- Metas by the asset they describe, folders without their trailing / ---
+	MetaIndex index;
+
+	for (std::map<uint, ResourceMeta*>::iterator meta = metas.begin(); meta != metas.end(); ++meta)
+		index[IndexPath((*meta).second->GetOriginalFile())] = (*meta).second;
+
+	std::vector<uint> reimported;
+
+	for (uint i = 0; i < events.size(); ++i)
+	{
+		const FileEvent& event = events[i];
+
+		// --- Metas are written by the engine, one deleted by hand is written again while its asset is there ---
+		if (GetResourceTypeFromPath(event.path.c_str()) == Resource::ResourceType::META)
+		{
+			if (event.type == FileEventType::Deleted)
+			{
+				std::string asset = event.path.substr(0, event.path.find_last_of("."));
+				MetaIndex::iterator meta = index.find(asset);
+
+				if (meta != index.end() && App->fs->Exists(asset.c_str()) && !App->fs->Exists(event.path.c_str()))
+					GetImporter<ImporterMeta>()->Save((*meta).second);
+			}
+
+			continue;
+		}
+
+		switch (event.type)
+		{
+		case FileEventType::Created:
+		case FileEventType::Modified:
+			ImportChangedAsset(event, index, reimported);
+			break;
+
+		case FileEventType::Deleted:
+			DeleteMissingAsset(event.path, index);
+			break;
+
+		case FileEventType::Renamed:
+		{
+			std::string prefix = event.old_path + "/";
+			MetaIndex::iterator under = index.lower_bound(prefix);
+			bool tracked = index.find(event.old_path) != index.end() || (under != index.end() && (*under).first.compare(0, prefix.size(), prefix) == 0);
+
+			bool imports_new = event.directory || PassesFilters(event.path, filters);
+
+			// --- Renamed into something we do not import is as good as deleted, and the other way around ---
+			if (tracked && imports_new)
+				MoveAsset(event.old_path, event.path, index);
+			else
+			{
+				if (tracked)
+					DeleteMissingAsset(event.old_path, index);
+
+				if (imports_new)
+				{
+					FileEvent created = event;
+					created.type = FileEventType::Created;
+					created.hash = event.directory ? 0 : App->fs->HashFile(event.path.c_str());
+					ImportChangedAsset(created, index, reimported);
+				}
+			}
+
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	ReimportDependents(reimported, "Source changed");
+
+	CONSOLE_LOG("Handled %u file changes in %.3f ms", (uint)events.size(), timer.ReadMs());
+}
+
+void ModuleResourceManager::ImportChangedAsset(const FileEvent& event, MetaIndex& index, std::vector<uint>& reimported)
+{
+	if (event.directory)
+	{
+		// --- Folders only hold other assets, a new one may have come with everything in it ---
+		if (event.type == FileEventType::Created)
+			ImportNewDirectory(event.path, index);
+
+		return;
+	}
+
+	if (!PassesFilters(event.path, filters) || !App->fs->Exists(event.path.c_str()))
+		return;
+
+	MetaIndex::iterator meta = index.find(event.path);
+
+	if (meta == index.end())
+	{
+		Importer::ImportData IData(event.path.c_str());
+		Resource* resource = ImportAssets(IData);
+
+		if (resource && metas.find(resource->GetUID()) != metas.end())
+			index[event.path] = metas[resource->GetUID()];
+	}
+	else
+	{
+		AssetRecord record;
+		bool known = asset_db.Find(event.path.c_str(), record) && record.source_hash != 0;
+
+		// --- Touched but not changed, a save with the same bytes or a copy over itself ---
+		bool unchanged = known && record.source_hash == event.hash;
+
+		// --- First change seen for this asset, the meta's date is all there is ---
+		if (!known)
+			unchanged = (*meta).second->Date == App->fs->GetLastModificationTime(event.path.c_str());
+
+		if (!unchanged)
+		{
+			CONSOLE_LOG("Reimported file: %s", event.path.c_str());
+
+			Resource* resource = GetResource((*meta).second->GetUID(), false);
+
+			if (resource)
+			{
+				resource->OnOverwrite();
+
+				// Update meta
+				Resource* meta_res = (*meta).second;
+				meta_res->OnOverwrite();
+
+				reimported.push_back(resource->GetUID());
+			}
+		}
+	}
+
+	asset_db.SetSource(event.path.c_str(), event.time, event.size, event.hash);
+}
+
+void ModuleResourceManager::ImportNewDirectory(const std::string& directory, MetaIndex& index)
+{
+	std::map<std::string, std::vector<std::string>> dirs;
+	RetrieveFilesAndDirectories((directory + "/").c_str(), dirs);
+
+	// --- Parents sort before their children, so every folder finds the one it goes in ---
+	for (std::map<std::string, std::vector<std::string>>::iterator dir = dirs.begin(); dir != dirs.end(); ++dir)
+	{
+		std::string dir_name = (*dir).first;
+		dir_name.pop_back();
+
+		if (index.find(dir_name) == index.end())
+		{
+			Importer::ImportData IData((*dir).first.c_str());
+			Resource* resource = ImportAssets(IData);
+
+			if (resource && metas.find(resource->GetUID()) != metas.end())
+				index[dir_name] = metas[resource->GetUID()];
+		}
+
+		for (std::vector<std::string>::iterator files = (*dir).second.begin(); files != (*dir).second.end(); ++files)
+		{
+			if (index.find(*files) != index.end() || !App->fs->Exists((*files).c_str()))
+				continue;
+
+			Importer::ImportData IData((*files).c_str());
+			Resource* resource = ImportAssets(IData);
+
+			if (resource && metas.find(resource->GetUID()) != metas.end())
+				index[*files] = metas[resource->GetUID()];
+		}
+	}
+}
+
+void ModuleResourceManager::DeleteMissingAsset(const std::string& path, MetaIndex& index)
+{
+	// --- The asset, and everything that was under it if it was a directory. Deepest first, folders go last ---
+	std::vector<std::string> gone;
+
+	if (index.find(path) != index.end())
+		gone.push_back(path);
+
+	std::string prefix = path + "/";
+
+	for (MetaIndex::iterator meta = index.lower_bound(prefix); meta != index.end() && (*meta).first.compare(0, prefix.size(), prefix) == 0; ++meta)
+		gone.push_back((*meta).first);
+
+	std::sort(gone.begin(), gone.end(), [](const std::string& a, const std::string& b) { return a.size() > b.size(); });
+
+	// --- Whatever used them learns before they go, the graph forgets them on deletion ---
+	std::vector<uint> deleted;
+
+	for (uint i = 0; i < gone.size(); ++i)
+	{
+		if (!App->fs->Exists(index[gone[i]]->GetOriginalFile()))
+			deleted.push_back(index[gone[i]]->GetUID());
+	}
+
+	ReimportDependents(deleted, "Dependency deleted");
+
+	for (uint i = 0; i < gone.size(); ++i)
+	{
+		ResourceMeta* meta = index[gone[i]];
+
+		// --- Put back before the changes settled ---
+		if (App->fs->Exists(meta->GetOriginalFile()))
+			continue;
+
+		CONSOLE_LOG("![Warning]: A meta data file (.meta) exists but its asset: '%s' cannot be found. When moving or deleting files outside the engine, please ensure that the corresponding .meta file is moved or deleted along with it.", gone[i].c_str());
+
+		// --- Eliminate all lib files ---
+		Resource* resource = GetResource(meta->GetUID(), false);
+
+		if (resource && resource->GetUID() != App->scene_manager->defaultScene->GetUID()) // do not eliminate default scene
+		{
+			resource->OnDelete();
+			delete resource;
+		}
+
+		// --- Then the meta, unless the resource took it along ---
+		std::map<uint, ResourceMeta*>::iterator orphan = metas.find(meta->GetUID());
+
+		if (orphan != metas.end() && (*orphan).second == meta)
+		{
+			Resource* meta_res = meta;
+			metas.erase(orphan);
+			meta_res->OnDelete();
+			delete meta_res;
+		}
+
+		asset_db.Remove(gone[i].c_str());
+		index.erase(gone[i]);
+	}
+}
+
+void ModuleResourceManager::MoveAsset(const std::string& old_path, const std::string& new_path, MetaIndex& index)
+{
+	// --- The asset, and everything that was under it if it was a directory. Top first, it is the one that changes folder ---
+	std::vector<std::string> moved;
+
+	if (index.find(old_path) != index.end())
+		moved.push_back(old_path);
+
+	std::string prefix = old_path + "/";
+
+	for (MetaIndex::iterator meta = index.lower_bound(prefix); meta != index.end() && (*meta).first.compare(0, prefix.size(), prefix) == 0; ++meta)
+		moved.push_back((*meta).first);
+
+	for (uint i = 0; i < moved.size(); ++i)
+	{
+		ResourceMeta* meta = index[moved[i]];
+		std::string destination = new_path + moved[i].substr(old_path.size());
+		bool top = moved[i] == old_path;
+
+		CONSOLE_LOG("Moved file: %s to %s", moved[i].c_str(), destination.c_str());
+
+		Resource* resource = GetResource(meta->GetUID(), false);
+
+		if (resource)
+		{
+			if (top)
+			{
+				ResourceFolder* folder = resource->GetType() == Resource::ResourceType::FOLDER ? (ResourceFolder*)resource : nullptr;
+
+				if (folder && folder->GetParent())
+					folder->GetParent()->RemoveChild(folder);
+				else if (!folder)
+					RemoveResourceFromFolder(resource);
+			}
+
+			// --- Folders and scenes live where their asset is ---
+			std::string resource_file = resource->GetResourceFile();
+
+			if (resource_file.compare(0, old_path.size(), old_path) == 0)
+				resource->SetResourceFile((new_path + resource_file.substr(old_path.size())).c_str());
+
+			std::string original_file = resource->GetOriginalFile();
+			resource->SetOriginalFile((new_path + original_file.substr(old_path.size())).c_str());
+
+			std::string name;
+			App->fs->SplitFilePath(destination.c_str(), nullptr, &name);
+
+			if (resource->GetType() == Resource::ResourceType::FOLDER)
+				name.append("/");
+
+			resource->SetName(name.c_str());
+		}
+
+		// --- The OS moved the meta along with a directory, not along with a single file. Save writes it where it goes ---
+		std::string old_meta = meta->GetResourceFile();
+		std::string original_file = meta->GetOriginalFile();
+		meta->SetResourceFile((destination + ".meta").c_str());
+		meta->SetOriginalFile((new_path + original_file.substr(old_path.size())).c_str());
+
+		if (old_meta != meta->GetResourceFile() && App->fs->Exists(old_meta.c_str()))
+			App->fs->Remove(old_meta.c_str());
+
+		asset_db.Remove(moved[i].c_str());
+
+		if (resource && top)
+			AddResourceToFolder(resource);
+
+		index.erase(moved[i]);
+		index[destination] = meta;
+	}
+}
+
+std::string ModuleResourceManager::IndexPath(const char* original_file)
+{
+	std::string path = original_file;
+
+	if (!path.empty() && path.back() == '/')
+		path.pop_back();
+
+	return path;
+}
+
 void ModuleResourceManager::RetrieveFilesAndDirectories(const char* directory, std::map<std::string, std::vector<std::string>>& ret)
 {
 	std::vector<std::string> files;
@@ -688,20 +1293,10 @@ void ModuleResourceManager::RetrieveFilesAndDirectories(const char* directory, s
 
 Resource* ModuleResourceManager::GetResource(uint UID, bool loadinmemory) // loadinmem is used only when absolutely needed
 {
-	Resource* resource = nullptr;
-
 	static_assert(static_cast<int>(Resource::ResourceType::UNKNOWN) == 9, "Resource Get Switch needs to be updated");
 
-	// To clarify: resource = condition ? value to be assigned if true : value to be assigned if false
-
-	resource = folders.find(UID) == folders.end() ? resource : (*folders.find(UID)).second;
-	resource = resource ? resource : (scenes.find(UID) == scenes.end() ? resource : (*scenes.find(UID)).second);
-	resource = resource ? resource : (models.find(UID) == models.end() ? resource : (*models.find(UID)).second);
-	resource = resource ? resource : (prefabs.find(UID) == prefabs.end() ? resource : (*prefabs.find(UID)).second);
-	resource = resource ? resource : (materials.find(UID) == materials.end() ? resource : (*materials.find(UID)).second);
-	resource = resource ? resource : (shaders.find(UID) == shaders.end() ? resource : (*shaders.find(UID)).second);
-	resource = resource ? resource : (meshes.find(UID) == meshes.end() ? resource : (*meshes.find(UID)).second);
-	resource = resource ? resource : (textures.find(UID) == textures.end() ? resource : (*textures.find(UID)).second);
+	// --- Metas share UID with their resource and are never returned here ---
+	Resource* resource = table.Find(UID);
 
 	if (resource && loadinmemory)
 		resource->LoadToMemory();
@@ -712,6 +1307,23 @@ Resource* ModuleResourceManager::GetResource(uint UID, bool loadinmemory) // loa
 	return resource;
 }
 
+Resource* ModuleResourceManager::FindResource(uint UID, Resource::ResourceType type) const
+{
+	if (type == Resource::ResourceType::META)
+	{
+		std::map<uint, ResourceMeta*>::const_iterator it = metas.find(UID);
+		return it != metas.end() ? (Resource*)(*it).second : nullptr;
+	}
+
+	return table.Find(UID, type);
+}
+
+Resource* ModuleResourceManager::GetOrCreateResourceGivenUID(Resource::ResourceType type, std::string source_file, uint UID)
+{
+	Resource* resource = FindResource(UID, type);
+	return resource ? resource : CreateResourceGivenUID(type, source_file, UID);
+}
+
 Resource * ModuleResourceManager::CreateResource(Resource::ResourceType type, std::string source_file)
 {
 	// Note you CANNOT create a meta resource through this function, use CreateResourceGivenUID instead
@@ -771,6 +1383,9 @@ Resource * ModuleResourceManager::CreateResource(Resource::ResourceType type, st
 		break;
 	}
 
+	if (resource && type != Resource::ResourceType::META)
+		table.Insert(resource);
+
 	return resource;
 }
 
@@ -843,6 +1458,9 @@ Resource* ModuleResourceManager::CreateResourceGivenUID(Resource::ResourceType t
 		break;
 	}
 
+	if (resource && type != Resource::ResourceType::META)
+		table.Insert(resource);
+
 	return resource;
 }
 
@@ -871,6 +1489,16 @@ Resource::ResourceType ModuleResourceManager::GetResourceTypeFromPath(const char
 	return type;
 }
 
+AssetDatabase& ModuleResourceManager::GetAssetDatabase()
+{
+	return asset_db;
+}
+
+AssetDependencyGraph& ModuleResourceManager::GetDependencyGraph()
+{
+	return dependencies;
+}
+
 ResourceFolder* ModuleResourceManager::GetAssetsFolder()
 {
 	return AssetsFolder;
@@ -1116,6 +1744,13 @@ void ModuleResourceManager::ONResourceDestroyed(Resource* resource)
 {
 	static_assert(static_cast<int>(Resource::ResourceType::UNKNOWN) == 9, "Resource Destruction Switch needs to be updated");
 
+	// --- Handles to it go stale right away, even if the object is deleted later ---
+	table.Remove(resource);
+
+	// --- Metas share the UID of their resource, the node belongs to the resource ---
+	if (resource->GetType() != Resource::ResourceType::META)
+		dependencies.Remove(resource->GetUID());
+
 	switch (resource->GetType())
 	{
 	case Resource::ResourceType::FOLDER:
@@ -1148,14 +1783,7 @@ void ModuleResourceManager::ONResourceDestroyed(Resource* resource)
 
 	case Resource::ResourceType::TEXTURE:
 		textures.erase(resource->GetUID());
-
-		// --- Tell mats ---
-		for (std::map<uint, ResourceMaterial*>::iterator it = materials.begin(); it != materials.end(); ++it)
-		{
-			if ((*it).second->resource_diffuse && (*it).second->resource_diffuse->GetUID() == resource->GetUID())
-				(*it).second->resource_diffuse = nullptr;
-		}
-
+		// --- Materials hold a handle to their texture, no need to tell them ---
 		break;
 
 	case Resource::ResourceType::META:
@@ -1173,6 +1801,75 @@ void ModuleResourceManager::ONResourceDestroyed(Resource* resource)
 
 }
 
+void ModuleResourceManager::ReimportDependents(const std::vector<uint>& changed, const char* reason)
+{
+	std::vector<std::vector<uint>> levels;
+	dependencies.Invalidate(changed, reason, levels);
+
+	if (levels.empty())
+		return;
+
+	// --- The graph keeps one reason per node, a later change would overwrite it before this one is refreshed ---
+	for (uint i = 0; i < levels.size(); ++i)
+	{
+		pending_dependents.push_back(std::vector<PendingRefresh>(levels[i].size()));
+		std::vector<PendingRefresh>& level = pending_dependents.back();
+
+		for (uint j = 0; j < levels[i].size(); ++j)
+		{
+			ReimportReason reason;
+			dependencies.GetReimportReason(levels[i][j], reason);
+
+			level[j].UID = levels[i][j];
+			level[j].cause = reason.cause;
+		}
+	}
+
+	FrameScheduler::Get().Schedule("Reimport Dependents", DeferredPriority::Low, [this](const DeferredSlice& slice) { return RefreshDependents(slice); }, true);
+}
+
+bool ModuleResourceManager::RefreshDependents(const DeferredSlice& slice)
+{
+	PROFILE_FUNCTION();
+
+	// --- A level only waits on the ones before it, take them in order while the frame allows ---
+	// --- Entries of a level are independent but stay on the main thread: refreshing touches GL objects 
+	// (shader uniforms) and notifies components in the scene, neither of which is safe from a worker ---
+	while (!pending_dependents.empty())
+	{
+		std::vector<PendingRefresh> level;
+		level.swap(pending_dependents.front());
+		pending_dependents.erase(pending_dependents.begin());
+
+		for (uint i = 0; i < level.size(); ++i)
+		{
+			// --- Gone since it was queued ---
+			Resource* resource = table.Find(level[i].UID);
+
+			if (resource == nullptr)
+				continue;
+
+			resource->OnDependencyChanged(level[i].cause);
+		}
+
+		if (slice.OutOfTime())
+			break;
+	}
+
+	return pending_dependents.empty();
+}
+
+void ModuleResourceManager::UnregisterResource(Resource* resource)
+{
+	table.Remove(resource);
+}
+
+// --- Used by ResourceHandle ---
+Resource* ResolveResourceHandle(uint index, uint generation)
+{
+	return App->resources->ResolveHandle(index, generation);
+}
+
 // ----------------------------------------------------
 
 update_status ModuleResourceManager::Update(float dt)
@@ -1184,6 +1881,12 @@ bool ModuleResourceManager::CleanUp()
 {
 	static_assert(static_cast<int>(Resource::ResourceType::UNKNOWN) == 9, "Resource Clean Up needs to be updated");
 
+	// --- Metas changed during the session ---
+	asset_db.Save(ASSET_DATABASE_FILE);
+	asset_db.Close();
+	dependencies.Save(ASSET_DEPENDENCIES_FILE);
+	pending_dependents.clear();
+
 	// --- Delete resources ---
 	for (std::map<uint, ResourceFolder*>::iterator it = folders.begin(); it != folders.end();)
 	{
@@ -1267,6 +1970,8 @@ bool ModuleResourceManager::CleanUp()
 
 	metas.clear();
 
+	table.Clear();
+
 	// --- Delete importers ---
 	for (uint i = 0; i < importers.size(); ++i)
 	{
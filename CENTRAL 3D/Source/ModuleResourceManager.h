@@ -4,6 +4,14 @@
 #include "Module.h"
 #include "Resource.h"
 #include "Importer.h"
+#include "ResourceTable.h"
+#include "AssetDatabase.h"
+#include "FileWatcher.h"
+#include "AssetDependencies.h"
+#include "ImageDecoder.h"
+
+#define ASSET_SCAN_CHUNK 64 // Assets prepared on workers before the main thread imports them, bounds how many decoded models are held at once
+#define ASSET_SCAN_DECODE_BUDGET (256 * 1024 * 1024) // Bytes of texture pixels decoded ahead per chunk, the rest are decoded when imported
 
 class ResourceFolder;
 class ResourceFolder;
@@ -15,6 +23,7 @@ class ResourceMesh;
 class ResourceTexture;
 class ResourceMeta;
 class ResourcePrefab;
+class DeferredSlice;
 
 class ModuleResourceManager : public Module
 {
@@ -46,7 +55,7 @@ public:
 
 	// --- Importing ---
 	std::string DuplicateIntoGivenFolder(const char* path, const char* folder_path);
-	ResourceFolder* SearchAssets(ResourceFolder* parent, const char* directory, std::vector<std::string>& filters);
+	ResourceFolder* ScanAssets(const char* directory, std::vector<std::string>& filters); // File work is spread over the job system
 	Resource* ImportAssets(Importer::ImportData& IData);
 	Resource* ImportFolder(Importer::ImportData& IData);
 	Resource* ImportScene(Importer::ImportData& IData);
@@ -59,6 +68,7 @@ public:
 	Resource* ImportMeta(Importer::ImportData& IData);
 
 	void HandleFsChanges();
+	void HandleFsEvents(); // Only what the file watcher reported since the last call
 	void RetrieveFilesAndDirectories(const char* directory, std::map<std::string,std::vector<std::string>> & ret);
 
 	// For consistency, use this only on resource manager/importers 
@@ -78,6 +88,8 @@ public:
 
 	// --- Resource Handling ---
 	Resource* GetResource(uint UID, bool loadinmemory = true);
+	Resource* FindResource(uint UID, Resource::ResourceType type) const; // Does not load, nullptr if the UID is not of the given type
+	Resource* GetOrCreateResourceGivenUID(Resource::ResourceType type, std::string source_file, uint UID);
 	void AddResourceToFolder(Resource* resource);
 	void RemoveResourceFromFolder(Resource* resource);
 	Resource* CreateResource(Resource::ResourceType type, std::string source_file);
@@ -88,12 +100,70 @@ public:
 	void SaveResource(Resource* resource);
 
 	void ONResourceDestroyed(Resource* resource);
+	void UnregisterResource(Resource* resource);
+
+	// --- Refreshes whatever uses the given resources, deferred and in dependency order ---
+	void ReimportDependents(const std::vector<uint>& changed, const char* reason);
+	inline Resource* ResolveHandle(uint index, uint generation) const { return table.Resolve(index, generation); }
 
 	// --- Getters ---
 	ResourceFolder* GetAssetsFolder();
+	AssetDatabase& GetAssetDatabase();
+	AssetDependencyGraph& GetDependencyGraph();
 	uint GetFileFormatVersion();
 	uint GetDefaultMaterialUID();
 
+private:
+
+	// --- A dependent waiting for a refresh, and what it was queued for ---
+	struct PendingRefresh
+	{
+		uint UID = 0;
+		uint cause = 0;
+	};
+
+	// --- Startup scan ---
+	struct ScanDirectory
+	{
+		std::string path; // Ends in /
+		int parent = -1;
+		bool library = false; // Only listed, nothing in it is imported
+		std::vector<std::string> dirs;
+		std::vector<std::string> files; // Assets that pass the filters, sorted
+		std::vector<std::string> listed; // Every file, full path
+		std::vector<uint> children;
+	};
+
+	struct ScanStep
+	{
+		std::string path;
+		uint directory = 0;
+		bool folder = false;
+
+		// --- Read on workers, handed to the importers through the json loader ---
+		std::string meta_file;
+		json meta;
+		std::string resource_file;
+		json resource;
+		DecodedImage image; // Textures with nothing in the library yet, handed to ModuleTextures
+	};
+
+	void ListScanDirectory(ScanDirectory& directory, const std::vector<std::string>& filters) const;
+	void FlattenScan(uint index, const std::vector<ScanDirectory>& directories, std::vector<ScanStep>& steps) const;
+	void PrepareScanStep(ScanStep& step);
+	bool PassesFilters(const std::string& file, const std::vector<std::string>& filters) const;
+
+	// --- File watcher changes ---
+	typedef std::map<std::string, ResourceMeta*> MetaIndex; // By asset path, folders without their trailing /
+
+	void ImportChangedAsset(const FileEvent& event, MetaIndex& index, std::vector<uint>& reimported);
+	void ImportNewDirectory(const std::string& directory, MetaIndex& index);
+	void DeleteMissingAsset(const std::string& path, MetaIndex& index);
+	void MoveAsset(const std::string& old_path, const std::string& new_path, MetaIndex& index);
+	static std::string IndexPath(const char* original_file);
+
+	bool RefreshDependents(const DeferredSlice& slice);
+
 private:
 
 	// --- Available importers ---
@@ -106,6 +176,17 @@ private:
 	ResourceFolder* AssetsFolder = nullptr;
 	ResourceMaterial* DefaultMaterial = nullptr;
 
+	// --- What every meta said last time, so unchanged ones are not parsed again ---
+	AssetDatabase asset_db;
+	std::atomic<uint64> scan_decoded_bytes; // This chunk's, against ASSET_SCAN_DECODE_BUDGET
+
+	// --- Who uses what, and levels of dependents still waiting for a refresh ---
+	AssetDependencyGraph dependencies;
+	std::vector<std::vector<PendingRefresh>> pending_dependents;
+
+	// --- Every resource but metas, indexed by UID. Maps below are kept for per type iteration ---
+	ResourceTable table;
+
 	// --- Available resources ---
 	std::map<uint, ResourceFolder*> folders;
 	std::map<uint, ResourceScene*> scenes;
@@ -13,6 +13,9 @@
 #include "ModuleInput.h"
 #include "ModuleEventManager.h"
 #include "ComponentCamera.h"
+#include "FrameScheduler.h"
+
+#include <algorithm>
 
 #include "ModuleGui.h"
 
@@ -30,6 +33,10 @@
 #include "ResourceShader.h"
 #include "ResourceScene.h"
 
+#include "FrameAllocator.h"
+#include "Profiler.h"
+#include "Kernels.h"
+
 
 #include "mmgr/mmgr.h"
 
@@ -43,7 +50,10 @@ void ModuleSceneManager::ONResourceSelected(const Event& e)
 
 void ModuleSceneManager::ONGameObjectDestroyed(const Event& e)
 {
-	if (e.go->GetUID() == App->scene_manager->GetSelectedGameObject()->GetUID())
+	// --- The object may be gone by the time the event is dispatched, only its UID is kept ---
+	GameObject* selected = App->scene_manager->GetSelectedGameObject();
+
+	if (selected && selected->GetUID() == e.uid)
 		App->scene_manager->SetSelectedGameObject(nullptr);
 }
 
@@ -79,23 +89,37 @@ bool ModuleSceneManager::Start()
 	App->scene_manager->defaultScene->LoadToMemory();
 
 	// --- Create temporal scene for play/stop ---
-	App->scene_manager->temporalScene = (Resource*)new ResourceScene(App->GetRandom().Int(), "Temp/TemporalScene.scene");
+	App->scene_manager->temporalScene = new ResourceScene(App->GetRandom().Int(), "Temp/TemporalScene.scene");
 
 	return true;
 }
 
 update_status ModuleSceneManager::PreUpdate(float dt)
 {
-	// --- Delete flagged game objects ---
+	// --- Delete flagged game objects, they leave the scene now and are freed as deferred work ---
 	if (!App->scene_manager->go_to_delete.empty())
 	{
-		for (uint i = 0; i < App->scene_manager->go_to_delete.size(); ++i)
+		// --- Only the topmost of each queued branch, a child queued with its parent leaves with it and must not be freed twice ---
+		std::vector<GameObject*> branches;
+
+		for (uint i = 0; i < go_to_delete.size(); ++i)
 		{
-			DestroyGameObject(go_to_delete[i]);
+			GameObject* go = go_to_delete[i];
+			bool queued = std::find(branches.begin(), branches.end(), go) != branches.end();
+
+			for (GameObject* ancestor = go->parent; ancestor && !queued; ancestor = ancestor->parent)
+				queued = std::find(go_to_delete.begin(), go_to_delete.end(), ancestor) != go_to_delete.end();
+
+			if (!queued)
+				branches.push_back(go);
 		}
 
-		App->scene_manager->go_count -= App->scene_manager->go_to_delete.size();
-		App->scene_manager->go_to_delete.clear();
+		for (uint i = 0; i < branches.size(); ++i)
+			DetachGameObject(branches[i]);
+
+		go_to_delete.clear();
+
+		FrameScheduler::Get().Schedule("Free Game Objects", DeferredPriority::Normal, [this](const DeferredSlice& slice) { return FreeDetachedGameObjects(slice); }, true);
 	}
 
 	return UPDATE_CONTINUE;
@@ -111,6 +135,13 @@ update_status ModuleSceneManager::Update(float dt)
 
 bool ModuleSceneManager::CleanUp()
 {
+	FrameScheduler::Get().CancelAll("Free Game Objects");
+
+	for (uint i = 0; i < go_detached.size(); ++i)
+		delete go_detached[i];
+
+	go_detached.clear();
+
 	root->RecursiveDelete();
 
 	if (App->scene_manager->temporalScene != nullptr)
@@ -124,33 +155,54 @@ bool ModuleSceneManager::CleanUp()
 
 void ModuleSceneManager::DrawScene()
 {
+	PROFILE_FUNCTION();
+
 	if (display_tree)
 		RecursiveDrawQuadtree(tree.root);
 
 	// MYTODO: Support multiple go selection and draw outline accordingly
 	if (currentScene)
 	{
+		// --- Gather non-static boxes and cull them all at once ---
+		FrameVector<GameObject*> gos;
+		FrameVector<AABB> boxes;
+		gos.reserve(currentScene->NoStaticGameObjects.size());
+		boxes.reserve(currentScene->NoStaticGameObjects.size());
+
 		for (std::unordered_map<uint, GameObject*>::iterator it = currentScene->NoStaticGameObjects.begin(); it != currentScene->NoStaticGameObjects.end(); it++)
 		{
 			if ((*it).second->GetActive() && (*it).second->GetUID() != root->GetUID())
 			{
-				const AABB aabb = (*it).second->GetAABB();
+				const AABB& aabb = (*it).second->GetAABB();
 
 				// Careful! Some aabbs have NaN values inside, which triggers an assert in geolib's Intersects function
 
 				// MYTODO: Check why some aabbs have NaN values, found one with lots of them
 
-				if (aabb.IsFinite() && App->renderer3D->culling_camera->frustum.Intersects(aabb))
+				if (aabb.IsFinite())
 				{
-					// --- Issue render order ---
-					(*it).second->Draw();
+					gos.push_back((*it).second);
+					boxes.push_back(aabb);
 				}
 			}
 		}
-		std::vector<GameObject*> static_go;
+
+		Plane planes[6];
+		App->renderer3D->culling_camera->frustum.GetPlanes(planes);
+
+		FrameVector<unsigned char> visible(boxes.size());
+		Kernels::CullAABBs(planes, boxes.data(), visible.data(), boxes.size());
+
+		for (uint i = 0; i < gos.size(); ++i)
+		{
+			// --- Issue render order ---
+			if (visible[i])
+				gos[i]->Draw();
+		}
+		FrameVector<GameObject*> static_go;
 		tree.CollectIntersections(static_go, App->renderer3D->culling_camera->frustum);
 
-		for (std::vector<GameObject*>::iterator it = static_go.begin(); it != static_go.end(); it++)
+		for (FrameVector<GameObject*>::iterator it = static_go.begin(); it != static_go.end(); it++)
 		{
 			// --- Issue render order ---
 			if((*it)->GetActive())
@@ -167,6 +219,11 @@ GameObject * ModuleSceneManager::GetRootGO() const
 	return root;
 }
 
+uint ModuleSceneManager::GetDetachedCount() const
+{
+	return go_detached.size();
+}
+
 void ModuleSceneManager::RedoOctree()
 {
 	std::vector<GameObject*> NoStaticGameObjects;
@@ -224,7 +281,7 @@ void ModuleSceneManager::SelectFromRay(LineSegment & ray)
 	if (currentScene)
 	{
 		// --- Gather static gos ---
-		std::map<float, GameObject*> candidate_gos;
+		FrameMap<float, GameObject*> candidate_gos;
 		tree.CollectIntersections(candidate_gos, ray);
 
 		// --- Gather non-static gos ---
@@ -243,10 +300,10 @@ void ModuleSceneManager::SelectFromRay(LineSegment & ray)
 			}
 		}
 
-		std::map<float, GameObject*> triangles_touched;
+		FrameMap<float, GameObject*> triangles_touched;
 
 		GameObject* toSelect = nullptr;
-		for (std::map<float, GameObject*>::iterator it = candidate_gos.begin(); it != candidate_gos.end() && toSelect == nullptr; it++)
+		for (FrameMap<float, GameObject*>::iterator it = candidate_gos.begin(); it != candidate_gos.end() && toSelect == nullptr; it++)
 		{
 			// --- We have to test triangle by triangle ---
 			ComponentMesh* mesh = it->second->GetComponent<ComponentMesh>();
@@ -259,25 +316,14 @@ void ModuleSceneManager::SelectFromRay(LineSegment & ray)
 					LineSegment local = ray;
 					local.Transform(it->second->GetComponent<ComponentTransform>()->GetGlobalTransform().Inverted());
 
-					for (uint j = 0; j < mesh->resource_mesh->IndicesSize / 3; j++)
+					// --- Test ray/triangle intersection, nearest triangle of the mesh ---
+					float t = 0.0f;
+					uint triangle = 0;
+
+					if (Kernels::RayTriangles(local.a, local.b - local.a, 1.0f, mesh->resource_mesh->vertices, mesh->resource_mesh->Indices, mesh->resource_mesh->IndicesSize / 3, t, triangle))
 					{
-						float3 a = float3(mesh->resource_mesh->vertices[mesh->resource_mesh->Indices[j * 3]].position);
-						float3 b = float3(mesh->resource_mesh->vertices[mesh->resource_mesh->Indices[(j * 3) + 1]].position);
-						float3 c = float3(mesh->resource_mesh->vertices[mesh->resource_mesh->Indices[(j * 3) + 2]].position);
-
-						// --- Create Triangle given three vertices ---
-						Triangle triangle(a, b, c);
-
-						// --- Test ray/triangle intersection ---
-						if (local.Intersects(triangle, nullptr, nullptr))
-						{
-							// --- Check at what distance from ray origin is the triangle at ---
-							float3 pos = it->second->GetComponent<ComponentTransform>()->GetGlobalTransform().TranslatePart();
-							pos += triangle.CenterPoint();
-							triangles_touched[float3(math::Abs(pos - ray.a)).Length()] = it->second;
-
-							break;
-						}
+						// --- Same fraction of the segment in world space, the transform is affine ---
+						triangles_touched[t * ray.Length()] = it->second;
 					}
 				}
 			}
@@ -579,7 +625,7 @@ void ModuleSceneManager::CreateCylinder(float radius, float height, ResourceMesh
 void ModuleSceneManager::SendToDelete(GameObject* go)
 {
 	Event e(Event::EventType::GameObject_destroyed);
-	e.go = go;
+	e.uid = go->GetUID();
 	App->event_manager->PushEvent(e);
 
 	go_to_delete.push_back(go);
@@ -702,6 +748,56 @@ void ModuleSceneManager::DestroyGameObject(GameObject* go)
 	this->go_count--;
 }
 
+void ModuleSceneManager::DetachGameObject(GameObject* go)
+{
+	go->parent->RemoveChildGO(go);
+	go->parent = nullptr;
+
+	std::vector<GameObject*> gos;
+	GatherGameObjects(go, gos);
+
+	// --- The whole branch leaves, objects not created through the scene manager were never counted ---
+	go_count = go_count > gos.size() ? go_count - gos.size() : 0;
+
+	for (uint i = 0; i < gos.size(); ++i)
+	{
+		// --- Out of the octree and the scene's maps now, a scene loaded meanwhile may reuse their UIDs ---
+		if (gos[i]->Static)
+		{
+			currentScene->StaticGameObjects.erase(gos[i]->GetUID());
+			tree.Erase(gos[i]);
+		}
+		else
+			currentScene->NoStaticGameObjects.erase(gos[i]->GetUID());
+
+		// --- A camera being freed later must not be drawn from meanwhile ---
+		ComponentCamera* camera = gos[i]->GetComponent<ComponentCamera>();
+
+		if (camera && camera->active_camera)
+			App->renderer3D->SetActiveCamera(nullptr);
+
+		if (camera && camera->culling)
+			App->renderer3D->SetCullingCamera(nullptr);
+
+		go_detached.push_back(gos[i]);
+	}
+}
+
+bool ModuleSceneManager::FreeDetachedGameObjects(const DeferredSlice& slice)
+{
+	// --- Children were detached with their parents, each one is freed on its own ---
+	while (!go_detached.empty() && !slice.OutOfTime())
+	{
+		GameObject* go = go_detached.back();
+		go_detached.pop_back();
+
+		go->childs.clear();
+		delete go;
+	}
+
+	return go_detached.empty();
+}
+
 void ModuleSceneManager::GatherGameObjects(GameObject* go, std::vector<GameObject*>& gos_vec)
 {
 	gos_vec.push_back(go);
@@ -14,6 +14,7 @@ struct par_shapes_mesh_s;
 class ResourceMesh;
 class ResourceScene;
 struct Event;
+class DeferredSlice;
 
 class ModuleSceneManager : public Module
 {
@@ -47,6 +48,7 @@ public:
 	// --- Getters ---
 	GameObject* GetSelectedGameObject() const;
 	GameObject* GetRootGO() const;
+	uint GetDetachedCount() const; // Deleted and out of the scene, not freed yet
 
 	// --- Setters ---
 	void SetSelectedGameObject(GameObject* go);
@@ -85,6 +87,9 @@ private:
 private:
 
 	GameObject* CreateRootGameObject();
+	void DetachGameObject(GameObject* go);
+	bool FreeDetachedGameObjects(const DeferredSlice& slice);
+
 	// --- Primitives ---
 	void LoadParMesh(par_shapes_mesh_s* mesh, ResourceMesh* new_mesh) const;
 public:
@@ -110,6 +115,9 @@ private:
 	// Game objects to be deleted
 	std::vector<GameObject*> go_to_delete;
 
+	// --- Already out of the scene, freed a few at a time by deferred work ---
+	std::vector<GameObject*> go_detached;
+
 	uint go_count = 0;
 	GameObject* root = nullptr;
 	GameObject* SelectedGameObject = nullptr;
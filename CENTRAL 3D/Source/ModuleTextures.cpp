@@ -4,11 +4,18 @@
 #include "ModuleFileSystem.h"
 #include "ModuleResourceManager.h"
 #include "ResourceTexture.h"
+#include "ModuleJobs.h"
+#include "Allocator.h"
+#include "FrameScheduler.h"
+#include "Logger.h"
 
 #include "DevIL/include/il.h"
 #include "DevIL/include/ilu.h"
 #include "DevIL/include/ilut.h"
 
+#include <ctype.h>
+#include <string.h>
+
 #pragma comment (lib, "DevIL/libx86/DevIL.lib")
 #pragma comment (lib, "DevIL/libx86/ILU.lib")
 #pragma comment (lib, "DevIL/libx86/ILUT.lib")
@@ -21,9 +28,27 @@
 ModuleTextures::ModuleTextures(bool start_enabled) : Module(start_enabled)
 {
 	name = "Textures";
+
+	// --- Native decoders first, they run on any thread ---
+	decoders.push_back(new ImageDecoderKTX2());
+	decoders.push_back(new ImageDecoderTGA());
+	decoders.push_back(new ImageDecoderDDS());
+	decoders.push_back(new ImageDecoderPNG());
+	decoders.push_back(new ImageDecoderJPG());
+
+	fallback = new ImageDecoderDevIL();
 }
 
-ModuleTextures::~ModuleTextures() {}
+ModuleTextures::~ModuleTextures() 
+{
+	for (uint i = 0; i < decoders.size(); ++i)
+		delete decoders[i];
+
+	decoders.clear();
+
+	delete fallback;
+	fallback = nullptr;
+}
 
 bool ModuleTextures::Init(json file)
 {
@@ -51,6 +76,8 @@ bool ModuleTextures::Init(json file)
 	ilutInit();
 	ilutRenderer(ILUT_OPENGL);
 
+	if (file["Textures"].find("StreamingBudgetMB") != file["Textures"].end())
+		streamer.SetBudgetMB(file["Textures"]["StreamingBudgetMB"]);
 
 	return ret;
 }
@@ -61,15 +88,35 @@ bool ModuleTextures::Start()
 	CheckerTexID = LoadCheckImage();
 	DefaultTexture = LoadDefaultTexture();
 
+	// --- BC7 and immutable storage are core in GL 4.2 ---
+	bc7_supported = glewIsSupported("GL_ARB_texture_compression_bptc") == GL_TRUE;
+	texture_storage_supported = glewIsSupported("GL_ARB_texture_storage") == GL_TRUE;
+
 	return true;
 }
 
+update_status ModuleTextures::PreUpdate(float dt)
+{
+	// --- Residency for what last frame drew ---
+	streamer.Update();
+
+	return UPDATE_CONTINUE;
+}
+
 bool ModuleTextures::CleanUp()
 {
+	FrameScheduler::Get().CancelAll("Texture Streaming");
+	streamer.CleanUp();
+	ClearPrefetchedImages();
 
 	return true;
 }
 
+void ModuleTextures::SaveStatus(json& file) const
+{
+	file["Textures"]["StreamingBudgetMB"] = streamer.GetBudgetMB();
+}
+
 uint ModuleTextures::LoadCheckImage() const
 {
 	// --- Creating pixel data for checkers texture ---
@@ -118,36 +165,54 @@ uint ModuleTextures::GetDefaultTextureID() const
 
 uint ModuleTextures::CreateAndSaveTextureFromPixels(uint UID, int internalFormat, uint width, uint height, uint format, const void* pixels, std::string& out_path)
 {
-	out_path = TEXTURES_FOLDER;
-	out_path.append(std::to_string(UID));
-	out_path.append(".dds");
+	GetLibraryPath(UID, out_path);
 
-	ILuint img;
-	ilGenImages(1, &img);
-	ilBindImage(img);
-	ilTexImage(width, height, 1, 3, IL_RGB, IL_UNSIGNED_BYTE, (void*)pixels);
+	DecodedImage image;
+	image.format = PixelFormat::RGBA8;
+	image.width = width;
+	image.height = height;
+	image.size = (uint64)width * height * 4;
 
-	// --- Save to Lib ---
-	ILuint size;
-	ILubyte* data;
-	ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);// To pick a specific DXT compression use
-	size = ilSaveL(IL_DDS, NULL, 0); // Get the size of the data buffer
+	// --- The compressor takes RGBA ---
+	std::vector<unsigned char> rgba;
 
-	if (size > 0) 
+	if (format == GL_RGBA)
+		image.pixels = (unsigned char*)pixels;
+	else
 	{
-		data = new ILubyte[size]; // allocate data buffer
+		const unsigned char* rgb = (const unsigned char*)pixels;
+		rgba.resize((size_t)image.size);
 
-		if (ilSaveL(IL_DDS, data, size) > 0) // Save to buffer with the ilSaveIL function
-			App->fs->Save(out_path.c_str(), data, size);
+		for (uint64 i = 0; i < (uint64)width * height; ++i)
+		{
+			memcpy(&rgba[(size_t)i * 4], rgb + i * 3, 3);
+			rgba[(size_t)i * 4 + 3] = 255;
+		}
 
-		delete[] data;
+		image.pixels = rgba.data();
 	}
 
-	uint texID = ilutGLBindTexImage();
+	// --- Previews, speed over quality ---
+	TextureCompression compression;
+	compression.quality = CompressionQuality::Fast;
 
-	ilDeleteImages(1, &img);
+	uint texID = 0;
+	DecodedImage compressed;
+
+	if (SaveToLibrary(image, out_path, compression, compressed))
+	{
+		texID = UploadImage(compressed);
+		FreeImage(compressed);
+	}
+
+	return texID;
+}
 
-	return 	texID;
+void ModuleTextures::GetLibraryPath(uint UID, std::string& out_path) const
+{
+	out_path = TEXTURES_FOLDER;
+	out_path.append(std::to_string(UID));
+	out_path.append(".ktx2");
 }
 
 inline void ModuleTextures::SetTextureParameters(bool CheckersTexture) const
@@ -200,41 +265,51 @@ uint ModuleTextures::CreateTextureFromPixels(int internalFormat, uint width, uin
 	// --- Unbind texture ---
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	CONSOLE_LOG("Loaded Texture: ID: %i , Width: %i , Height: %i ", TextureID, width, height);
+	LOG_DEBUG(LogCategory::Resources, "Loaded Texture: ID: %i , Width: %i , Height: %i ", TextureID, width, height);
 
 	// --- Returning id so a mesh can use it (and destroy buffer when done) ---
 
 	return TextureID;
 }
 
-uint ModuleTextures::CreateCubemap(std::vector<uint>& cubemap_textures)
+static GLenum GetCompressedFormat(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::BC1:
+		return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case PixelFormat::BC2:
+		return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case PixelFormat::BC4:
+		return GL_COMPRESSED_RED_RGTC1;
+	case PixelFormat::BC5:
+		return GL_COMPRESSED_RG_RGTC2;
+	case PixelFormat::BC7:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+}
+
+uint ModuleTextures::CreateCubemap(const std::vector<DecodedImage>& faces) const
 {
 	uint texID = 0;
 
 	glGenTextures(1, &texID);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
 
-	for (uint i = 0; i < 6; i++)
+	for (uint i = 0; i < 6 && i < faces.size(); i++)
 	{
-		if (cubemap_textures[i] == 0)
-			continue;
-
-		glBindTexture(GL_TEXTURE_2D, cubemap_textures[i]);
-		int w, h;
-		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
-		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
-		GLubyte* pixels = new GLubyte[w * h * 3];
-
-		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+		const DecodedImage& face = faces[i];
 
-		glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
-
-		glTexImage2D(
-			GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-			0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels
-		);
+		if (face.pixels == nullptr)
+			continue;
 
-		delete[] pixels;
+		// --- Only the top level, the cubemap is not mipmapped ---
+		if (face.format == PixelFormat::RGBA8)
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, face.width, face.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, face.pixels);
+		else
+			glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GetCompressedFormat(face.format), face.width, face.height, 0, (GLsizei)ImageDecoder::GetLevelSize(face.format, face.width, face.height), face.pixels);
 	}
 
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -242,58 +317,155 @@ uint ModuleTextures::CreateCubemap(std::vector<uint>& cubemap_textures)
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
 	return texID;
 }
 
-inline void ModuleTextures::CreateTextureFromImage(uint &TextureID, uint &width, uint &height, std::string& path) const
+uint ModuleTextures::UploadImage(const DecodedImage& image) const
 {
-	// --- Attention!! If the image is flipped, we flip it back --- 
-	ILinfo imageInfo;
-	iluGetImageInfo(&imageInfo);
+	if (image.pixels == nullptr)
+		return 0;
 
-	width = imageInfo.Width;
-	height = imageInfo.Height;
+	// --- Every level the image holds, they are packed largest first ---
+	std::vector<const unsigned char*> levels(image.levels);
+	const unsigned char* level = image.pixels;
+	uint width = image.width;
+	uint height = image.height;
 
-	if (imageInfo.Origin == IL_ORIGIN_UPPER_LEFT)
-		iluFlipImage();
-
-	// --- Convert the image into a suitable format to work with ---
-	if (ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
+	for (uint i = 0; i < image.levels; ++i)
 	{
-		// --- Create the texture ---
-		TextureID = CreateTextureFromPixels(ilGetInteger(IL_IMAGE_FORMAT), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT), ilGetInteger(IL_IMAGE_FORMAT), ilGetData());
+		levels[i] = level;
+		level += ImageDecoder::GetLevelSize(image.format, width, height);
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
 
-		if (path != "")
-		{
-			iluFlipImage();
+	return UploadLevels(image, levels.data());
+}
 
-			// --- Save to Lib ---
-			ILuint size;
-			ILubyte *data;
-			ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);// To pick a specific DXT compression use
-			size = ilSaveL(IL_DDS, NULL, 0); // Get the size of the data buffer
+uint ModuleTextures::UploadLevels(const ImageInfo& info, const unsigned char* const* levels) const
+{
+	uint TextureID = 0;
 
-			if (size > 0) {
-				data = new ILubyte[size]; // allocate data buffer
+	glGenTextures(1, (GLuint*)&TextureID);
+	glBindTexture(GL_TEXTURE_2D, TextureID);
+
+	SetTextureParameters();
+
+	bool compressed = info.format != PixelFormat::RGBA8;
+	GLenum internal_format = compressed ? GetCompressedFormat(info.format) : GL_RGBA8;
 
-				if (ilSaveL(IL_DDS, data, size) > 0) // Save to buffer with the ilSaveIL function
-					App->fs->Save(path.c_str(), data, size);
+	// --- A lone RGBA8 level gets its mips from the driver, storage for them is allocated up front ---
+	bool generate = !compressed && info.levels == 1;
+	uint storage_levels = info.levels;
+
+	if (generate)
+	{
+		for (uint largest = info.width > info.height ? info.width : info.height; largest > 1; largest /= 2)
+			++storage_levels;
+	}
 
-				delete[] data;
-			}
+	if (texture_storage_supported)
+		glTexStorage2D(GL_TEXTURE_2D, storage_levels, internal_format, info.width, info.height);
 
+	uint width = info.width;
+	uint height = info.height;
+
+	for (uint i = 0; i < info.levels; ++i)
+	{
+		GLsizei level_size = (GLsizei)ImageDecoder::GetLevelSize(info.format, width, height);
+
+		if (texture_storage_supported)
+		{
+			if (compressed)
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, internal_format, level_size, levels[i]);
+			else
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, levels[i]);
 		}
+		else if (compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format, width, height, 0, level_size, levels[i]);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[i]);
+
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
 	}
+
+	if (generate)
+		glGenerateMipmap(GL_TEXTURE_2D);
 	else
-		CONSOLE_LOG("|[error]: Image conversion failed. ERROR: %s", iluErrorString(ilGetError()));
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, info.levels - 1);
+
+		// --- Compressed and without mips, drivers need not generate them ---
+		if (info.levels == 1)
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	LOG_DEBUG(LogCategory::Resources, "Loaded Texture: ID: %i , Width: %i , Height: %i ", TextureID, info.width, info.height);
+
+	return TextureID;
 }
 
-uint ModuleTextures::CreateTextureFromFile(const char* path, uint &width, uint &height, int UID) const
+uint ModuleTextures::CreateStreamedTexture(const ImageInfo& info, uint first) const
 {
-	// --- In this function we use devil to load an image using the path given, extract pixel data and then create texture using CreateTextureFromImage ---
+	if (!texture_storage_supported || first >= info.levels)
+		return 0;
+
+	uint TextureID = 0;
+
+	glGenTextures(1, (GLuint*)&TextureID);
+	glBindTexture(GL_TEXTURE_2D, TextureID);
+
+	SetTextureParameters();
+
+	// --- Only the resident levels are allocated, a residency change builds a new texture ---
+	uint width = info.width >> first ? info.width >> first : 1;
+	uint height = info.height >> first ? info.height >> first : 1;
+
+	glTexStorage2D(GL_TEXTURE_2D, info.levels - first, info.format == PixelFormat::RGBA8 ? GL_RGBA8 : GetCompressedFormat(info.format), width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, info.levels - first - 1);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return TextureID;
+}
+
+void ModuleTextures::UploadStreamedLevel(uint texture, const ImageInfo& info, uint first, uint level, const unsigned char* data) const
+{
+	uint width = info.width >> level ? info.width >> level : 1;
+	uint height = info.height >> level ? info.height >> level : 1;
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	if (info.format == PixelFormat::RGBA8)
+		glTexSubImage2D(GL_TEXTURE_2D, level - first, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	else
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, level - first, 0, 0, width, height, GetCompressedFormat(info.format), (GLsizei)ImageDecoder::GetLevelSize(info.format, width, height), data);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static const char* GetFormatName(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::BC1: return "BC1";
+	case PixelFormat::BC2: return "BC2";
+	case PixelFormat::BC3: return "BC3";
+	case PixelFormat::BC4: return "BC4";
+	case PixelFormat::BC5: return "BC5";
+	case PixelFormat::BC7: return "BC7";
+	default: return "RGBA8";
+	}
+}
+
+uint ModuleTextures::CreateTextureFromFile(const char* path, uint &width, uint &height, int UID, const TextureCompression& compression) const
+{
+	// --- Decode the file, upload its pixels and keep a copy in the library if asked ---
 
 	uint TextureID = 0;
 
@@ -303,33 +475,260 @@ uint ModuleTextures::CreateTextureFromFile(const char* path, uint &width, uint &
 		return TextureID;
 	}
 
-	// --- Generate the image name (ID for buffer) ---
-	uint ImageName = 0;
-	ilGenImages(1, (ILuint*)&ImageName);
+	// --- Decoded by the startup scan already ---
+	std::map<std::string, DecodedImage>::iterator prefetched = prefetched_images.find(path);
 
-	// --- Bind the image ---
-	ilBindImage(ImageName);
+	if (UID >= 0 && prefetched != prefetched_images.end())
+	{
+		DecodedImage image = prefetched->second;
+		prefetched_images.erase(prefetched);
 
-	std::string lib_path = "";
+		TextureID = CreateTextureFromImage(image, width, height, UID, compression);
+		FreeImage(image);
 
-	// --- Build path to library if asked ---
-	if (UID >= 0)
+		return TextureID;
+	}
+
+	MappedFile file;
+
+	if (!App->fs->MapFile(path, file))
 	{
-		lib_path = TEXTURES_FOLDER;
-		lib_path.append(std::to_string(UID));
-		lib_path.append(".dds");
+		CONSOLE_LOG("|[error]: Could not read image %s", path);
+		return TextureID;
 	}
 
-	// --- Load the image into binded buffer and create texture from its pixel data ---
-	if (ilLoadImage(path))
-		CreateTextureFromImage(TextureID, width,height, lib_path);
+	// --- Library files are uploaded straight from the mapped file, no decoding ---
+	ImageInfo info;
+	std::vector<const unsigned char*> levels;
+
+	if (UID < 0 && ImageDecoderKTX2::GetLevels((const unsigned char*)file.data, file.size, info, levels))
+	{
+		width = info.width;
+		height = info.height;
+		TextureID = UploadLevels(info, levels.data());
+		App->fs->UnmapFile(file);
+
+		return TextureID;
+	}
+
+	std::string extension;
+	App->fs->SplitFilePath(path, nullptr, nullptr, &extension);
+
+	DecodedImage image;
+
+	if (DecodeImage((const unsigned char*)file.data, file.size, extension.c_str(), image))
+	{
+		TextureID = CreateTextureFromImage(image, width, height, UID, compression);
+		FreeImage(image);
+	}
 	else
-		CONSOLE_LOG("|[error]: DevIL could not load the image. ERROR: %s", iluErrorString(ilGetError()));
+		CONSOLE_LOG("|[error]: Could not decode image %s", path);
 
-	// --- Release Image data (we have already extracted the necessary information) ---
-	ilDeleteImages(1, (const ILuint*)&ImageName);
+	App->fs->UnmapFile(file);
 
-	// --- Returning the Texture ID so a mesh can use it, note that this variable is filled by CreateTextureFromPixels ---
+	// --- Returning the Texture ID so a mesh can use it ---
 
 	return TextureID;
 }
+
+uint ModuleTextures::CreateTextureFromImage(const DecodedImage& image, uint& width, uint& height, int UID, const TextureCompression& compression) const
+{
+	uint TextureID = 0;
+	width = image.width;
+	height = image.height;
+
+	// --- Build path to library if asked, the compressed texture is uploaded so the first load looks like the next ones ---
+	if (UID >= 0)
+	{
+		std::string lib_path;
+		GetLibraryPath(UID, lib_path);
+
+		DecodedImage compressed;
+
+		if (SaveToLibrary(image, lib_path, compression, compressed))
+		{
+			TextureID = UploadImage(compressed);
+			FreeImage(compressed);
+		}
+	}
+
+	if (TextureID == 0)
+		TextureID = UploadImage(image);
+
+	return TextureID;
+}
+
+bool ModuleTextures::SaveToLibrary(const DecodedImage& image, const std::string& path, const TextureCompression& compression, DecodedImage& compressed) const
+{
+	bool srgb = compression.usage == TextureUsage::Albedo;
+	std::vector<unsigned char> ktx2;
+
+	// --- Block compressed sources are already what the library keeps, only the container changes ---
+	if (image.format != PixelFormat::RGBA8)
+	{
+		if (ImageDecoderKTX2::Write(image, srgb, ktx2))
+			App->fs->Save(path.c_str(), ktx2.data(), (uint)ktx2.size());
+		else
+			CONSOLE_LOG("|[error]: Could not save texture %s", path.c_str());
+
+		return false;
+	}
+
+	PixelFormat format = TextureCompressor::ChooseFormat(compression, TextureCompressor::HasAlpha(image), bc7_supported);
+	CompressionStats stats;
+
+	if (!TextureCompressor::Compress(image, format, compression, compressed, &stats) || !ImageDecoderKTX2::Write(compressed, srgb, ktx2))
+	{
+		CONSOLE_LOG("|[error]: Could not compress texture %s", path.c_str());
+		FreeImage(compressed);
+		return false;
+	}
+
+	App->fs->Save(path.c_str(), ktx2.data(), (uint)ktx2.size());
+
+	CONSOLE_LOG("Compressed %s: %s %ix%i, %i levels in %.1f ms, PSNR %.2f dB", path.c_str(), GetFormatName(format), compressed.width, compressed.height, compressed.levels, stats.ms, stats.psnr);
+
+	return true;
+}
+
+// --- Decoding ---
+
+void ModuleTextures::RegisterDecoder(ImageDecoder* decoder)
+{
+	if (decoder)
+		decoders.push_back(decoder);
+}
+
+const ImageDecoder* ModuleTextures::FindDecoder(const unsigned char* data, uint64 size, const char* extension, ImageInfo& info) const
+{
+	for (uint i = 0; i < decoders.size(); ++i)
+	{
+		if (decoders[i]->CanDecode(data, size, extension) && decoders[i]->ReadInfo(data, size, info))
+			return decoders[i];
+	}
+
+	if (fallback && fallback->CanDecode(data, size, extension) && fallback->ReadInfo(data, size, info))
+		return fallback;
+
+	return nullptr;
+}
+
+bool ModuleTextures::ReadImageInfo(const char* path, ImageInfo& info) const
+{
+	MappedFile file;
+
+	if (path == nullptr || !App->fs->MapFile(path, file))
+		return false;
+
+	std::string extension;
+	App->fs->SplitFilePath(path, nullptr, nullptr, &extension);
+
+	bool ret = FindDecoder((const unsigned char*)file.data, file.size, extension.c_str(), info) != nullptr;
+
+	App->fs->UnmapFile(file);
+
+	return ret;
+}
+
+bool ModuleTextures::DecodeImage(const char* path, DecodedImage& image, void* buffer, uint64 buffer_size) const
+{
+	MappedFile file;
+
+	if (path == nullptr || !App->fs->MapFile(path, file))
+	{
+		CONSOLE_LOG("|[error]: Could not read image %s", path ? path : "");
+		return false;
+	}
+
+	std::string extension;
+	App->fs->SplitFilePath(path, nullptr, nullptr, &extension);
+
+	bool ret = DecodeImage((const unsigned char*)file.data, file.size, extension.c_str(), image, buffer, buffer_size);
+
+	App->fs->UnmapFile(file);
+
+	return ret;
+}
+
+bool ModuleTextures::DecodeImage(const unsigned char* data, uint64 size, const char* extension, DecodedImage& image, void* buffer, uint64 buffer_size) const
+{
+	image = DecodedImage();
+
+	if (data == nullptr || size == 0)
+		return false;
+
+	// --- Decoders expect the extension lower case ---
+	std::string ext = extension ? extension : "";
+
+	for (uint i = 0; i < ext.size(); ++i)
+		ext[i] = (char)tolower(ext[i]);
+
+	ImageInfo info;
+	const ImageDecoder* decoder = FindDecoder(data, size, ext.c_str(), info);
+
+	if (decoder == nullptr)
+		return false;
+
+	unsigned char* pixels = (unsigned char*)buffer;
+	bool owned = false;
+
+	if (pixels == nullptr || buffer_size < info.size)
+	{
+		pixels = (unsigned char*)ENGINE_ALLOC(MemoryTag::Import, (size_t)info.size);
+		owned = true;
+	}
+
+	if (!decoder->Decode(data, size, info, pixels))
+	{
+		CONSOLE_LOG("|[error]: %s decoder failed on a %ux%u image", decoder->GetName(), info.width, info.height);
+
+		if (owned)
+			ENGINE_FREE(pixels);
+
+		return false;
+	}
+
+	static_cast<ImageInfo&>(image) = info;
+	image.pixels = pixels;
+	image.owned = owned;
+
+	return true;
+}
+
+void ModuleTextures::DecodeImages(const std::vector<std::string>& paths, std::vector<DecodedImage>& images) const
+{
+	images.clear();
+	images.resize(paths.size());
+
+	App->jobs->ParallelFor((uint)paths.size(), 1, [&](uint begin, uint end)
+	{
+		for (uint i = begin; i < end; ++i)
+			DecodeImage(paths[i].c_str(), images[i]);
+	});
+}
+
+void ModuleTextures::FreeImage(DecodedImage& image) const
+{
+	if (image.owned && image.pixels)
+		ENGINE_FREE(image.pixels);
+
+	image = DecodedImage();
+}
+
+void ModuleTextures::PrefetchImage(const char* path, DecodedImage& image)
+{
+	DecodedImage& prefetched = prefetched_images[path];
+	FreeImage(prefetched);
+
+	prefetched = image;
+	image = DecodedImage();
+}
+
+void ModuleTextures::ClearPrefetchedImages()
+{
+	for (std::map<std::string, DecodedImage>::iterator it = prefetched_images.begin(); it != prefetched_images.end(); ++it)
+		FreeImage(it->second);
+
+	prefetched_images.clear();
+}
+
@@ -3,6 +3,9 @@
 
 #include "Module.h"
 #include "Globals.h"
+#include "TextureCompressor.h"
+#include "TextureStreaming.h"
+#include <map>
 #include <vector>
 
 #define CHECKERS_HEIGHT 32
@@ -17,15 +20,41 @@ public:
 
 	bool Init(json file) override;
 	bool Start() override;
+	update_status PreUpdate(float dt) override;
 	bool CleanUp() override;
+	void SaveStatus(json& file) const override;
 
-	uint CreateTextureFromFile(const char* path, uint &width, uint &height, int UID = -1) const;
+	// --- Textures are created on the main thread's context and shared with the render thread (see ModuleRenderer3D), 
+	// call these from the main thread only and release what they return through ModuleRenderer3D::ReleaseTexture ---
+	uint CreateTextureFromFile(const char* path, uint &width, uint &height, int UID = -1, const TextureCompression& compression = TextureCompression()) const; // With a UID it is compressed into the library
 	uint CreateTextureFromPixels(int internalFormat, uint width, uint height, uint format, const void* pixels, bool CheckersTexture = false) const;
-	uint CreateCubemap(std::vector<uint>& cubemap_textures);
+	uint CreateCubemap(const std::vector<DecodedImage>& faces) const; // +X, -X, +Y, -Y, +Z, -Z
+	uint UploadImage(const DecodedImage& image) const;
 	uint GetCheckerTextureID() const;
 	uint GetDefaultTextureID() const;
 
 	uint CreateAndSaveTextureFromPixels(uint UID, int internalFormat, uint width, uint height, uint format, const void* pixels, std::string& out_path);
+	void GetLibraryPath(uint UID, std::string& out_path) const; // Where CreateAndSaveTextureFromPixels saves a texture
+
+	// --- Decoding touches no GL state and may run on any thread. Pixels go to buffer when it is big enough, engine memory otherwise ---
+	bool ReadImageInfo(const char* path, ImageInfo& info) const;
+	bool DecodeImage(const char* path, DecodedImage& image, void* buffer = nullptr, uint64 buffer_size = 0) const;
+	bool DecodeImage(const unsigned char* data, uint64 size, const char* extension, DecodedImage& image, void* buffer = nullptr, uint64 buffer_size = 0) const;
+	void DecodeImages(const std::vector<std::string>& paths, std::vector<DecodedImage>& images) const; // In parallel, failed ones have no pixels
+	void FreeImage(DecodedImage& image) const;
+
+	void RegisterDecoder(ImageDecoder* decoder); // Takes ownership, tried before DevIL
+
+	// --- Main thread. The startup scan decodes sources ahead of time, CreateTextureFromFile takes them instead of reading the file again ---
+	void PrefetchImage(const char* path, DecodedImage& image); // Takes the pixels
+	void ClearPrefetchedImages(); // Those no load took
+
+	// --- Streaming, the texture holds levels first to the last of info. 0 without immutable storage ---
+	uint CreateStreamedTexture(const ImageInfo& info, uint first) const;
+	void UploadStreamedLevel(uint texture, const ImageInfo& info, uint first, uint level, const unsigned char* data) const;
+
+public:
+	TextureStreamer streamer; // Library textures with mips, see ResourceTexture::LoadInMemory
 
 private:
 	uint LoadCheckImage() const;
@@ -33,12 +62,22 @@ private:
 
 	uint CheckerTexID = 0;
 	uint DefaultTexture = 0;
+	bool bc7_supported = false;
+	bool texture_storage_supported = false;
 
 private:
 	// --- Called by CreateTextureFromPixels to split code ---
 	inline void SetTextureParameters(bool CheckersTexture = false) const;
+	uint CreateTextureFromImage(const DecodedImage& image, uint& width, uint& height, int UID, const TextureCompression& compression) const;
+	uint UploadLevels(const ImageInfo& info, const unsigned char* const* levels) const; // Largest first
+
+	const ImageDecoder* FindDecoder(const unsigned char* data, uint64 size, const char* extension, ImageInfo& info) const;
+	bool SaveToLibrary(const DecodedImage& image, const std::string& path, const TextureCompression& compression, DecodedImage& compressed) const; // KTX2, true when compressed holds what was saved
+
+	std::vector<ImageDecoder*> decoders;
+	ImageDecoder* fallback = nullptr; // DevIL, for whatever the others reject
 
-	inline void CreateTextureFromImage(uint & TextureID, uint &width, uint &height, std::string& path) const;
+	mutable std::map<std::string, DecodedImage> prefetched_images; // By source path
 };
 
 #endif
\ No newline at end of file
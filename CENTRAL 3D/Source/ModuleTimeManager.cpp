@@ -3,8 +3,15 @@
 #include "ModuleGui.h"
 #include "ModuleSceneManager.h"
 #include "ModuleFileSystem.h"
+#include "ModuleWindow.h"
+#include "ModuleRenderer3D.h"
 
 #include "ResourceScene.h"
+#include "FrameScheduler.h"
+
+#include <thread>
+#include <float.h>
+#include <math.h>
 
 #include "mmgr/mmgr.h"
 
@@ -14,21 +21,61 @@ ModuleTimeManager::ModuleTimeManager(bool start_enabled) : Module(start_enabled)
 
 	name = "TimeManager";
 	Realtime_clock.Start();
-	Gametime_clock.Start();
+	frame_clock.Start();
+	frequency = SDL_GetPerformanceFrequency();
 
 	frame_count = 0;
 	last_frame_ms = -1;
-	last_fps = -1;
-	capped_ms = 1000 / 60; // Get Display RR!!
-	fps_counter = 0;
+
+	SetMaxFramerate(TIME_DEFAULT_REFRESH);
 }
 
 ModuleTimeManager::~ModuleTimeManager() {}
 
+bool ModuleTimeManager::Init(json file)
+{
+	if (file["Time"].find("SmoothDt") != file["Time"].end())
+		smooth_dt = file["Time"]["SmoothDt"];
+
+	if (file["Time"].find("FixedTimestep") != file["Time"].end())
+		SetFixedTimestep(file["Time"]["FixedTimestep"]);
+
+	if (file["Time"].find("DeferredBudget") != file["Time"].end())
+		FrameScheduler::Get().SetBudgetMs(file["Time"]["DeferredBudget"]);
+
+	return true;
+}
+
+bool ModuleTimeManager::Start()
+{
+	// --- Window is up by now, its display decides the interval frames are snapped and paced to ---
+	uint refresh = App->window->GetDisplayRefreshRate();
+
+	if (refresh == 0)
+	{
+		CONSOLE_LOG("![Warning]: Display refresh rate unknown, assuming %i Hz", TIME_DEFAULT_REFRESH);
+		refresh = TIME_DEFAULT_REFRESH;
+	}
+
+	refresh_ms = 1000.0 / refresh;
+
+	return true;
+}
+
 void ModuleTimeManager::PrepareUpdate()
 {
-	game_dt = realtime_dt = (float)Gametime_clock.Read() / 1000.0f;
-	Gametime_clock.Start();
+	// --- Frame interval including the wait, what the user actually sees ---
+	interval_ms = frame_clock.ReadMs();
+	frame_clock.Start();
+
+	float dt = (float)(interval_ms / 1000.0);
+
+	dt = dt < TIME_MAX_DT ? dt : TIME_MAX_DT;
+	game_dt = realtime_dt = smooth_dt ? SmoothDt(dt) : dt;
+
+	// --- Scenarios step the same every run, however long frames really take ---
+	if (fixed_dt > 0.0f)
+		game_dt = realtime_dt = fixed_dt;
 
 	time += realtime_dt*Time_scale;
 
@@ -38,7 +85,7 @@ void ModuleTimeManager::PrepareUpdate()
 			App->GetAppState() = AppState::PLAY;
 			
 			// --- Create temporal directory/scene ---
-			App->fs->CreateDirectoryA("Temp");
+			App->fs->CreateDirectory("Temp");
 			App->scene_manager->currentScene->CopyInto(App->scene_manager->temporalScene);
 			App->scene_manager->SaveScene(App->scene_manager->temporalScene);
 
@@ -85,35 +132,128 @@ void ModuleTimeManager::PrepareUpdate()
 			break;
 
 	}
+
+	// --- Simulation steps due this frame, game_dt is already scaled and zero outside play ---
+	fixed_steps = 0;
+
+	if (fixed_step > 0.0f)
+	{
+		accumulator += game_dt;
+
+		while (accumulator >= fixed_step && fixed_steps < TIME_MAX_FIXED_STEPS)
+		{
+			accumulator -= fixed_step;
+			fixed_steps++;
+		}
+
+		// --- Could not catch up, drop the time instead of owing it to the next frames ---
+		if (accumulator >= fixed_step)
+			accumulator = fmodf(accumulator, fixed_step);
+	}
+}
+
+bool ModuleTimeManager::ConsumeFixedStep()
+{
+	if (fixed_steps == 0)
+		return false;
+
+	fixed_steps--;
+	return true;
 }
 
 void ModuleTimeManager::FinishUpdate()
 {
-	// --- Recap on framecount and fps ---
+	// --- Frame times and their statistics are kept by FrameStats ---
 	++frame_count;
-	++fps_counter;
 
-	if (fps_timer.Read() >= 1000)
+	last_frame_ms = (float)frame_clock.ReadMs();
+
+	// --- Cap fps. A vsynced swap already waits for the display, pacing on top of it only adds latency ---
+	bool display_paced = App->renderer3D->GetVSync() && capped_ms <= refresh_ms + TIME_SNAP_MS;
+
+	// --- Deferred work fills what is left before the deadline. Past a vsynced swap nothing is left to measure, those get their budget unless the last frame missed the display ---
+	double available = DBL_MAX;
+
+	if (display_paced)
+		available = interval_ms > refresh_ms + TIME_SNAP_MS ? 0.0 : DBL_MAX;
+	else if (capped_ms > 0.0)
+		available = capped_ms - last_frame_ms - SCHEDULER_MARGIN_MS;
+
+	FrameScheduler::Get().RunFrame(available);
+
+	if (capped_ms > 0.0 && !display_paced)
+		WaitForDeadline();
+	else
+		next_deadline = 0;
+}
+
+float ModuleTimeManager::SmoothDt(float dt)
+{
+	// --- Vsynced frames last whole refresh intervals, anything else is measuring noise ---
+	if (refresh_ms > 0.0)
 	{
-		last_fps = fps_counter;
-		fps_counter = 0;
-		fps_timer.Start();
+		double interval = refresh_ms / 1000.0;
+		double intervals = floor(dt / interval + 0.5);
+
+		if (intervals >= 1.0 && fabs(dt - intervals * interval) * 1000.0 < TIME_SNAP_MS)
+			dt = (float)(intervals * interval);
 	}
 
-	last_frame_ms = Gametime_clock.Read();
+	// --- Average of the last frames, a single hitch is spread instead of jerking everything forward ---
+	dt_history[dt_count % TIME_DT_HISTORY] = dt;
+	dt_count++;
+
+	uint count = dt_count < TIME_DT_HISTORY ? dt_count : TIME_DT_HISTORY;
+	float sum = 0.0f;
 
-	// --- Cap fps ---
-	if (capped_ms > 0 && (last_frame_ms < capped_ms))
-		SDL_Delay(capped_ms - last_frame_ms);
+	for (uint i = 0; i < count; ++i)
+		sum += dt_history[i];
 
-	// --- Send data to GUI-PanelSettings Historiograms
-	App->gui->LogFPS((float)last_fps, (float)last_frame_ms);
+	return sum / count;
+}
+
+void ModuleTimeManager::WaitForDeadline()
+{
+	Uint64 period = (Uint64)(capped_ms * frequency / 1000.0);
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	// --- Deadlines follow each other so a late frame is made up by the next one, unless we are a whole frame late ---
+	if (next_deadline == 0 || now > next_deadline + period)
+	{
+		next_deadline = now + period;
+		return;
+	}
+
+	// --- Sleep most of the wait, SDL_Delay oversleeps by a ms or two so the rest is spent spinning ---
+	while (now < next_deadline)
+	{
+		double remaining_ms = (next_deadline - now) * 1000.0 / frequency;
+
+		if (remaining_ms > spin_ms + 1.0)
+		{
+			Uint32 sleep_ms = (Uint32)(remaining_ms - spin_ms);
+			SDL_Delay(sleep_ms);
+
+			// --- Learn how late the OS wakes us up, forget it slowly ---
+			Uint64 woken = SDL_GetPerformanceCounter();
+			double oversleep = (woken - now) * 1000.0 / frequency - sleep_ms;
+			double needed = oversleep + 0.25;
+			spin_ms = needed > spin_ms ? needed : spin_ms - 0.01;
+			spin_ms = spin_ms < TIME_MIN_SPIN_MS ? TIME_MIN_SPIN_MS : (spin_ms > TIME_MAX_SPIN_MS ? TIME_MAX_SPIN_MS : spin_ms);
+		}
+		else
+			std::this_thread::yield();
+
+		now = SDL_GetPerformanceCounter();
+	}
+
+	next_deadline += period;
 }
 
 uint ModuleTimeManager::GetMaxFramerate() const
 {
-	if (capped_ms > 0)
-		return (uint)((1.0f / (float)capped_ms) * 1000.0f);
+	if (capped_ms > 0.0)
+		return (uint)(1000.0 / capped_ms + 0.5);
 	else
 		return 0;
 }
@@ -123,17 +263,40 @@ float ModuleTimeManager::GetTimeScale() const
 	return Time_scale;
 }
 
+uint ModuleTimeManager::GetRefreshRate() const
+{
+	return refresh_ms > 0.0 ? (uint)(1000.0 / refresh_ms + 0.5) : 0;
+}
+
+bool ModuleTimeManager::GetSmoothDt() const
+{
+	return smooth_dt;
+}
+
+float ModuleTimeManager::GetFixedTimestep() const
+{
+	return fixed_step;
+}
+
+float ModuleTimeManager::GetInterpolationAlpha() const
+{
+	return fixed_step > 0.0f ? accumulator / fixed_step : 1.0f;
+}
+
 void ModuleTimeManager::CapMs(float ms)
 {
 	capped_ms = ms;
+	next_deadline = 0;
 }
 
 void ModuleTimeManager::SetMaxFramerate(uint maxFramerate)
 {
 	if (maxFramerate > 0)
-		capped_ms = 1000 / maxFramerate;
+		capped_ms = 1000.0 / maxFramerate;
 	else
-		capped_ms = 0;
+		capped_ms = 0.0;
+
+	next_deadline = 0;
 }
 
 void ModuleTimeManager::SetTimeScale(float scale)
@@ -141,6 +304,31 @@ void ModuleTimeManager::SetTimeScale(float scale)
 	Time_scale = scale;
 }
 
+void ModuleTimeManager::SetSmoothDt(bool smooth)
+{
+	smooth_dt = smooth;
+	dt_count = 0;
+}
+
+void ModuleTimeManager::SetFixedTimestep(float step)
+{
+	fixed_step = step > 0.0f ? step : 0.0f;
+	accumulator = 0.0f;
+	fixed_steps = 0;
+}
+
+void ModuleTimeManager::SetFixedDt(float dt)
+{
+	fixed_dt = dt;
+}
+
+void ModuleTimeManager::SaveStatus(json& file) const
+{
+	file["Time"]["SmoothDt"] = smooth_dt;
+	file["Time"]["FixedTimestep"] = fixed_step;
+	file["Time"]["DeferredBudget"] = FrameScheduler::Get().GetBudgetMs();
+}
+
 float ModuleTimeManager::GetGameDt() const
 {
 	return game_dt;
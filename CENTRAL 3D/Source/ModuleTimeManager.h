@@ -5,7 +5,13 @@
 #include "Timer.h"
 #include "PerfTimer.h"
 
-
+#define TIME_DT_HISTORY 8 // Frames averaged by dt smoothing
+#define TIME_MAX_DT 0.25f // Seconds, longer frames (breakpoints, loading) do not throw the simulation forward
+#define TIME_DEFAULT_REFRESH 60 // When the display does not report its refresh rate
+#define TIME_MAX_FIXED_STEPS 5 // Per frame, past this the simulation slows down instead of spiralling
+#define TIME_SNAP_MS 0.5 // Measured frames this close to a whole amount of refresh intervals are taken as exactly that
+#define TIME_MIN_SPIN_MS 0.5
+#define TIME_MAX_SPIN_MS 4.0
 
 class ModuleTimeManager : public Module
 {
@@ -14,35 +20,70 @@ public:
 	ModuleTimeManager(bool start_enabled = true);
 	~ModuleTimeManager();
 
+	bool Init(json file) override;
+	bool Start() override;
+
 	void PrepareUpdate();
 	void FinishUpdate();
 
+	// --- Fixed timestep, true once per simulation step due this frame ---
+	bool ConsumeFixedStep();
+
 	// --- Getters ---
 	float GetGameDt() const;
 	float GetRealTimeDt()const;
 	uint GetMaxFramerate() const;
 	float GetTimeScale() const;
+	uint GetRefreshRate() const;
+	bool GetSmoothDt() const;
+	float GetFixedTimestep() const;
+	float GetInterpolationAlpha() const; // Fraction of a fixed step left in the accumulator, to blend the last two states
 	void CapMs(float ms);
 
 	// --- Setters ---
 	void SetMaxFramerate(uint maxFramerate);
 	void SetTimeScale(float scale);
+	void SetSmoothDt(bool smooth);
+	void SetFixedTimestep(float step); // Seconds, 0 disables fixed updates
+	void SetFixedDt(float dt); // Seconds, replaces the measured dt. 0 goes back to the clock
+
+	void SaveStatus(json& file) const override;
 
 	float time = 0.0f;
+private:
+
+	float SmoothDt(float dt);
+	void WaitForDeadline();
+
 private:
 
 	Timer				Realtime_clock;
-	Timer				Gametime_clock;
+	PerfTimer			frame_clock;
 	float				Time_scale = 1.0f;
 
-	Timer				fps_timer;
 	float				game_dt = 0.0f;
 	float				realtime_dt = 0.0f;
+	float				fixed_dt = 0.0f;
 	Uint32				frame_count;
-	int					fps_counter;
-	int					last_fps;
-	float				capped_ms;
 	float				last_frame_ms;
+	double				interval_ms = 0.0; // Last frame, start to start and before smoothing
+
+	// --- Pacing ---
+	double				capped_ms = 0.0;
+	double				refresh_ms = 0.0;
+	double				spin_ms = 2.0; // Left to busy wait after sleeping, grows when the OS oversleeps
+	Uint64				next_deadline = 0;
+	Uint64				frequency = 0;
+
+	// --- Smoothing ---
+	bool				smooth_dt = true;
+	float				dt_history[TIME_DT_HISTORY];
+	uint				dt_count = 0;
+
+	// --- Fixed timestep ---
+	float				fixed_step = 0.0f;
+	float				accumulator = 0.0f;
+	uint				fixed_steps = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
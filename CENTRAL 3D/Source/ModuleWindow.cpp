@@ -8,6 +8,7 @@
 
 ModuleWindow::ModuleWindow(bool start_enabled) : Module(start_enabled)
 {
+	name = "Window";
 	window = NULL;
 	screen_surface = NULL;
 }
@@ -126,8 +127,10 @@ bool ModuleWindow::Init(json file)
 		screen_width = uint(display.w * 0.75f);
 		screen_height = uint(display.h * 0.75f);
 		RefreshRate = display.refresh_rate;
-		App->time->CapMs(1 / RefreshRate * 1000);
-		Uint32 flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN;
+		if (RefreshRate > 0)
+			App->time->CapMs(1000.0f / RefreshRate);
+		// --- Headless keeps a hidden window, resources still need a GL context to upload to ---
+		Uint32 flags = SDL_WINDOW_OPENGL | (App->IsHeadless() ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
 
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
@@ -3,7 +3,12 @@
 
 #include "glew/include/GL/glew.h"
 #include "SDL/include/SDL_opengl.h"
+#ifdef _WIN32
 #include <gl/GL.h>
 #include <gl/GLU.h>
+#else
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
 
 #endif // __OPENGL_H__
\ No newline at end of file
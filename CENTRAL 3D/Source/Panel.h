@@ -1,10 +1,12 @@
 #ifndef __PANEL_H__
 #define __PANEL_H__
 
+#include "Allocator.h"
 
 class Panel
 {
 public:
+	MEMORY_TAG(MemoryTag::Editor)
 
 	Panel(char* title);
 	virtual ~Panel();
@@ -6,6 +6,11 @@
 
 PanelConsole::PanelConsole(char * name) : Panel(name)
 {
+	for (uint i = 0; i < (uint)LogLevel::count; ++i)
+		show_level[i] = true;
+
+	for (uint i = 0; i < (uint)LogCategory::count; ++i)
+		show_category[i] = true;
 }
 
 PanelConsole::~PanelConsole()
@@ -28,7 +33,7 @@ bool PanelConsole::Draw()
 
 		ImGui::SameLine();
 
-		filter.Draw("Filter", 200.0f);
+		DrawFilters();
 
 		ImGui::Separator();
 
@@ -39,31 +44,35 @@ bool PanelConsole::Draw()
 		if (ImGui::BeginChild("Scrollbar", ImVec2(0, 0), false, scrollFlags))
 		{
 			// --- Print logs to console ---
+			Logger& logger = Logger::Get();
+			std::lock_guard<std::mutex> lock(logger.GetHistoryMutex());
+
+			UpdateVisibleEntries();
 
 			ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(2, 1)); // Tighten spacing
 
-			for (uint i = 0; i < App->GetLogs().size(); ++i)
+			// --- Only the entries in view are submitted ---
+			ImGuiListClipper clipper((int)visible.size());
+
+			while (clipper.Step())
 			{
-				const char* item = App->GetLogs().at(i).data();
-
-				// --- Display error messages in red color ---
-				if(item[1] == *error_key)
-					ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75, 0, 0, 255));
-				else if(item[1] == *warning_key)
-					ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75, 0.75, 0, 255));
-				else
-					ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 255, 255, 255));
-
-				// --- If text does not match the filter don't print it ---
-				if (!filter.PassFilter(item))
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 				{
+					const LogEntry& entry = logger.GetHistoryEntry(visible[i]);
+
+					// --- Display error messages in red color ---
+					if (entry.level == LogLevel::Error)
+						ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75, 0, 0, 255));
+					else if (entry.level == LogLevel::Warning)
+						ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75, 0.75, 0, 255));
+					else if (entry.level == LogLevel::Debug)
+						ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6, 0.6, 0.6, 255));
+					else
+						ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 255, 255, 255));
+
+					ImGui::TextUnformatted(entry.text);
 					ImGui::PopStyleColor();
-					continue;
 				}
-
-				ImGui::TextUnformatted(item);
-				ImGui::PopStyleColor();
-
 			}
 
 			ImGui::PopStyleVar();
@@ -84,5 +93,86 @@ bool PanelConsole::Draw()
 
 void PanelConsole::Clear()
 {
-	App->ClearLogsFromConsole();
+	Logger::Get().ClearHistory();
+	visible.clear();
+}
+
+void PanelConsole::DrawFilters()
+{
+	if (ImGui::SmallButton("Filters"))
+		ImGui::OpenPopup("Console Filters");
+
+	if (ImGui::BeginPopup("Console Filters"))
+	{
+		Logger& logger = Logger::Get();
+
+		// --- What is shown ---
+		ImGui::Text("Show");
+
+		for (uint i = 0; i < (uint)LogLevel::count; ++i)
+			filters_changed |= ImGui::Checkbox(Logger::GetLevelName((LogLevel)i), &show_level[i]);
+
+		ImGui::Separator();
+
+		for (uint i = 0; i < (uint)LogCategory::count; ++i)
+			filters_changed |= ImGui::Checkbox(Logger::GetCategoryName((LogCategory)i), &show_category[i]);
+
+		ImGui::Separator();
+
+		// --- What is recorded at all ---
+		ImGui::Text("Record");
+
+		int min_level = (int)logger.GetMinLevel();
+
+		if (ImGui::Combo("Min level", &min_level, "Debug\0Info\0Warning\0Error\0"))
+			logger.SetMinLevel((LogLevel)min_level);
+
+		for (uint i = 0; i < (uint)LogCategory::count; ++i)
+		{
+			bool enabled = logger.IsCategoryEnabled((LogCategory)i);
+			std::string label = std::string(Logger::GetCategoryName((LogCategory)i)) + "##record";
+
+			if (ImGui::Checkbox(label.c_str(), &enabled))
+				logger.SetCategoryEnabled((LogCategory)i, enabled);
+		}
+
+		ImGui::EndPopup();
+	}
+
+	ImGui::SameLine();
+
+	filters_changed |= filter.Draw("Filter", 200.0f);
+}
+
+void PanelConsole::UpdateVisibleEntries()
+{
+	Logger& logger = Logger::Get();
+	uint64 begin = logger.GetHistoryBegin();
+	uint64 end = logger.GetHistoryEnd();
+
+	// --- Filters changed, scan everything again. Otherwise only look at what arrived since last frame ---
+	if (filters_changed)
+	{
+		visible.clear();
+		scanned_end = begin;
+		filters_changed = false;
+	}
+
+	// --- Forget entries overwritten or cleared ---
+	while (!visible.empty() && visible.front() < begin)
+		visible.pop_front();
+
+	if (scanned_end < begin)
+		scanned_end = begin;
+
+	for (; scanned_end < end; ++scanned_end)
+	{
+		if (PassFilters(logger.GetHistoryEntry(scanned_end)))
+			visible.push_back(scanned_end);
+	}
+}
+
+bool PanelConsole::PassFilters(const LogEntry& entry) const
+{
+	return show_level[(uint)entry.level] && show_category[(uint)entry.category] && filter.PassFilter(entry.text);
 }
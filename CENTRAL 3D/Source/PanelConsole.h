@@ -3,6 +3,8 @@
 
 #include "Panel.h"
 #include "Imgui/imgui.h"
+#include "Logger.h"
+#include <deque>
 
 class PanelConsole : public Panel
 {
@@ -16,10 +18,18 @@ public:
 private:
 
 	void Clear();
+	void DrawFilters();
+	void UpdateVisibleEntries();
+	bool PassFilters(const LogEntry& entry) const;
+
 	ImGuiTextFilter filter;
-	char* error_key = "|";
-	char* warning_key = "!";
+	bool show_level[(uint)LogLevel::count];
+	bool show_category[(uint)LogCategory::count];
+
+	// --- History indices passing the filters, only the ones on screen are drawn ---
+	std::deque<uint64> visible;
+	uint64 scanned_end = 0;
+	bool filters_changed = true;
 };
 
 #endif
-
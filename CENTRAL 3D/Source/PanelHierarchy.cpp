@@ -128,7 +128,7 @@ void PanelHierarchy::DrawRecursive(GameObject* Go)
 		node_flags |= ImGuiTreeNodeFlags_Selected;
 
 	// --- Avoid displaying root ---
-	if (Go->GetName().c_str() == App->scene_manager->GetRootGO()->GetName())
+	if (Go == App->scene_manager->GetRootGO())
 	{
 		if (Go->childs.size() > 0)
 		{
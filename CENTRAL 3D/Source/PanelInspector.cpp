@@ -89,10 +89,12 @@ bool PanelInspector::Draw()
 						ImGui::PopID();
 
 						// --- Show component Active bool and component name ---
-						std::string a = "##Active";
-
 						if((*it)->name != "Transform")
-							ImGui::Checkbox((a + (*it)->name).c_str(), &(*it)->GetActive());
+						{
+							ImGui::PushID("##Active");
+							ImGui::Checkbox((*it)->name.c_str(), &(*it)->GetActive());
+							ImGui::PopID();
+						}
 
 						ImGui::SameLine();
 						ImGui::Text(((*it)->name).c_str());
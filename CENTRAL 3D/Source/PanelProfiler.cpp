@@ -0,0 +1,248 @@
+#include "PanelProfiler.h"
+#include "Imgui/imgui.h"
+#include "FrameAllocator.h"
+#include <algorithm>
+
+#include "mmgr/mmgr.h"
+
+#define PROFILER_HISTOGRAM_FRAMES 120
+
+struct ScopeTotal
+{
+	const char* name = nullptr;
+	uint64 total = 0;
+	uint calls = 0;
+};
+
+// --- Same scope, same color every frame ---
+static ImU32 GetScopeColor(const char* name)
+{
+	size_t hash = (size_t)name * 2654435761u;
+	float hue = (float)((hash >> 8) % 360) / 360.0f;
+
+	return ImColor::HSV(hue, 0.55f, 0.75f);
+}
+
+PanelProfiler::PanelProfiler(char * name) : Panel(name)
+{
+}
+
+PanelProfiler::~PanelProfiler()
+{
+}
+
+bool PanelProfiler::Draw()
+{
+	ImGuiWindowFlags profilerFlags = 0;
+	profilerFlags |= ImGuiWindowFlags_NoFocusOnAppearing;
+
+	if (ImGui::Begin(name, &enabled, profilerFlags))
+	{
+		Profiler& profiler = Profiler::Get();
+
+		bool paused = profiler.IsPaused();
+
+		if (ImGui::Checkbox("Pause", &paused))
+			profiler.SetPaused(paused);
+
+		ImGui::SameLine();
+
+		if (ImGui::SmallButton("Export Trace"))
+			profiler.ExportChromeTrace();
+
+		ImGui::SameLine();
+		ImGui::Text("Dropped events: %u", profiler.GetDroppedEvents());
+
+		DrawFrameSelector();
+
+		ProfileFrame frame;
+
+		if (profiler.GetFrame(selected_frame, frame))
+		{
+			ImGui::Separator();
+			ImGui::Text("Frame %llu: %.3f ms", selected_frame, (frame.end - frame.start) / 1000000.0);
+
+			DrawFlameGraph(frame);
+
+			ImGui::Separator();
+
+			DrawScopeTotals(frame);
+		}
+		else
+			ImGui::Text("No frames recorded");
+	}
+
+	ImGui::End();
+
+	return true;
+}
+
+void PanelProfiler::DrawFrameSelector()
+{
+	Profiler& profiler = Profiler::Get();
+	uint64 count = profiler.GetFrameCount();
+
+	if (count == 0)
+		return;
+
+	uint64 first = count > PROFILER_FRAMES ? count - PROFILER_FRAMES : 0;
+
+	if (follow_latest || selected_frame < first || selected_frame >= count)
+		selected_frame = count - 1;
+
+	// --- Frame times, most recent on the right. Click one to inspect it ---
+	uint64 start = count > PROFILER_HISTOGRAM_FRAMES ? count - PROFILER_HISTOGRAM_FRAMES : 0;
+
+	if (start < first)
+		start = first;
+
+	float times[PROFILER_HISTOGRAM_FRAMES];
+	uint size = 0;
+	ProfileFrame frame;
+
+	for (uint64 f = start; f < count; ++f)
+		times[size++] = profiler.GetFrame(f, frame) ? (frame.end - frame.start) / 1000000.0f : 0.0f;
+
+	ImGui::PlotHistogram("##FrameTimes", times, size, 0, "Frame times (ms)", 0.0f, 33.3f, ImVec2(ImGui::GetContentRegionAvail().x, 60));
+
+	if (ImGui::IsItemClicked() && size > 0)
+	{
+		float x = (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+		uint index = (uint)(x * size);
+
+		selected_frame = start + (index < size ? index : size - 1);
+		follow_latest = false;
+	}
+
+	ImGui::Checkbox("Follow latest", &follow_latest);
+	ImGui::SameLine();
+
+	int selected = (int)(selected_frame - first);
+
+	if (ImGui::SliderInt("Frame", &selected, 0, (int)(count - 1 - first)))
+	{
+		selected_frame = first + selected;
+		follow_latest = false;
+	}
+}
+
+void PanelProfiler::DrawFlameGraph(const ProfileFrame& frame)
+{
+	Profiler& profiler = Profiler::Get();
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+	float width = ImGui::GetContentRegionAvail().x;
+	double duration = frame.end > frame.start ? (double)(frame.end - frame.start) : 1.0;
+	double scale = width / duration;
+
+	for (uint t = 0; t < profiler.GetThreadCount(); ++t)
+	{
+		// --- Only threads that did something this frame get a lane ---
+		uint max_depth = 0;
+		bool active = false;
+
+		for (uint64 i = frame.first_event; i < frame.end_event; ++i)
+		{
+			const ProfileEvent& event = profiler.GetEvent(i);
+
+			if (event.thread == t)
+			{
+				active = true;
+				max_depth = event.depth > max_depth ? event.depth : max_depth;
+			}
+		}
+
+		if (!active)
+			continue;
+
+		ImGui::Text("%s", profiler.GetThreadName(t)[0] ? profiler.GetThreadName(t) : "Thread");
+
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		ImGui::PushID(t);
+		ImGui::InvisibleButton("##Lane", ImVec2(width, (max_depth + 1) * row_height));
+		ImGui::PopID();
+
+		for (uint64 i = frame.first_event; i < frame.end_event; ++i)
+		{
+			const ProfileEvent& event = profiler.GetEvent(i);
+
+			if (event.thread != t || event.end < frame.start)
+				continue;
+
+			// --- Scopes that started before the frame (long jobs) are clamped to it ---
+			uint64 begin = event.start > frame.start ? event.start - frame.start : 0;
+			uint64 end = event.end < frame.end ? event.end - frame.start : frame.end - frame.start;
+
+			ImVec2 a(origin.x + (float)(begin * scale), origin.y + event.depth * row_height);
+			ImVec2 b(origin.x + (float)(end * scale), a.y + row_height - 1.0f);
+
+			if (b.x - a.x < 1.0f)
+				b.x = a.x + 1.0f;
+
+			draw_list->AddRectFilled(a, b, GetScopeColor(event.name));
+
+			if (b.x - a.x > 20.0f)
+			{
+				draw_list->PushClipRect(a, b, true);
+				draw_list->AddText(ImVec2(a.x + 2.0f, a.y + 1.0f), IM_COL32_WHITE, event.name);
+				draw_list->PopClipRect();
+			}
+
+			if (ImGui::IsMouseHoveringRect(a, b))
+				ImGui::SetTooltip("%s\n%.3f ms", event.name, (event.end - event.start) / 1000000.0);
+		}
+	}
+}
+
+void PanelProfiler::DrawScopeTotals(const ProfileFrame& frame)
+{
+	Profiler& profiler = Profiler::Get();
+
+	// --- Group by name, scratch containers are gone next frame ---
+	FrameVector<ScopeTotal> totals;
+
+	for (uint64 i = frame.first_event; i < frame.end_event; ++i)
+	{
+		const ProfileEvent& event = profiler.GetEvent(i);
+		ScopeTotal total;
+		total.name = event.name;
+		total.total = event.end - event.start;
+		total.calls = 1;
+		totals.push_back(total);
+	}
+
+	std::sort(totals.begin(), totals.end(), [](const ScopeTotal& a, const ScopeTotal& b) { return a.name < b.name; });
+
+	uint merged = 0;
+
+	for (uint i = 0; i < totals.size(); ++i)
+	{
+		if (merged > 0 && totals[merged - 1].name == totals[i].name)
+		{
+			totals[merged - 1].total += totals[i].total;
+			totals[merged - 1].calls += totals[i].calls;
+		}
+		else
+			totals[merged++] = totals[i];
+	}
+
+	totals.resize(merged);
+	std::sort(totals.begin(), totals.end(), [](const ScopeTotal& a, const ScopeTotal& b) { return a.total > b.total; });
+
+	ImGui::Columns(4, "##ScopeTotals");
+	ImGui::Text("Scope"); ImGui::NextColumn();
+	ImGui::Text("Total ms"); ImGui::NextColumn();
+	ImGui::Text("Calls"); ImGui::NextColumn();
+	ImGui::Text("Avg ms"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (uint i = 0; i < totals.size(); ++i)
+	{
+		ImGui::TextColored(ImColor(GetScopeColor(totals[i].name)), "%s", totals[i].name); ImGui::NextColumn();
+		ImGui::Text("%.3f", totals[i].total / 1000000.0); ImGui::NextColumn();
+		ImGui::Text("%u", totals[i].calls); ImGui::NextColumn();
+		ImGui::Text("%.3f", totals[i].total / 1000000.0 / totals[i].calls); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
@@ -0,0 +1,27 @@
+#ifndef __PANEL_PROFILER_H__
+#define __PANEL_PROFILER_H__
+
+#include "Panel.h"
+#include "Profiler.h"
+
+class PanelProfiler : public Panel
+{
+public:
+
+	PanelProfiler(char* name);
+	~PanelProfiler();
+
+	bool Draw();
+
+private:
+
+	void DrawFrameSelector();
+	void DrawFlameGraph(const ProfileFrame& frame);
+	void DrawScopeTotals(const ProfileFrame& frame);
+
+	uint64 selected_frame = 0;
+	bool follow_latest = true;
+	float row_height = 18.0f;
+};
+
+#endif
@@ -536,7 +536,7 @@ void PanelProject::DrawFolder(ResourceFolder* folder)
 			ImGui::SetCursorPosX(vec.x + (i - row * maxColumns) * (imageSize_px + item_spacingX_px) + item_spacingX_px);
 			ImGui::SetCursorPosY(vec.y + row * (imageSize_px + item_spacingY_px) + item_spacingY_px);
 
-			std::string item_name = (*it)->GetName();
+			FrameString item_name((*it)->GetName());
 			item_name.pop_back();
 			LimitText(item_name);
 
@@ -653,7 +653,7 @@ void PanelProject::DrawFile(Resource* resource, uint i, uint row, ImVec2& cursor
 	ImGui::SetCursorPosX(cursor_pos.x + (i - row * maxColumns) * (imageSize_px + item_spacingX_px) + item_spacingX_px);
 	ImGui::SetCursorPosY(cursor_pos.y + row * (imageSize_px + item_spacingY_px) + item_spacingY_px);
 
-	std::string item_name = resource->GetName();
+	FrameString item_name(resource->GetName());
 	LimitText(item_name);
 
 	if (selected && selected->GetUID() == resource->GetUID())
@@ -730,7 +730,7 @@ void PanelProject::DrawFile(Resource* resource, uint i, uint row, ImVec2& cursor
 	ImGui::PopID();
 }
 
-void PanelProject::LimitText(std::string& text)
+void PanelProject::LimitText(FrameString& text)
 {
 	uint textSizeX_px = ImGui::CalcTextSize(text.c_str(), nullptr).x;
 	uint dotsSizeX_px = ImGui::CalcTextSize("...", nullptr, false, 0).x;
@@ -739,21 +739,19 @@ void PanelProject::LimitText(std::string& text)
 	if (imageSize_px < textSizeX_px)
 	{
 		uint charSizeX_px = textSizeX_px / text.size();
-		text = text.substr(0, (imageSize_px - dotsSizeX_px) / charSizeX_px);
+		text.resize((imageSize_px - dotsSizeX_px) / charSizeX_px);
 		text.append("...");
 	}
 }
 
 void PanelProject::RecursiveDirectoryDraw(ResourceFolder* folder)
 {
-	std::vector<ResourceFolder*> childs = folder->GetChilds();
+	std::vector<ResourceFolder*>& childs = folder->GetChilds();
 
 	for (std::vector<ResourceFolder*>::iterator it = childs.begin(); it != childs.end(); ++it) 
 	{
-		std::string dir_name = folder->GetName();
-		std::string child_name = (*it)->GetName();
-
-		if (ImGui::TreeNodeEx((dir_name + child_name).c_str(), 0, "%s", child_name.c_str())) 
+		// --- Folders are told apart by UID, names repeat across directories ---
+		if (ImGui::TreeNodeEx((void*)(uintptr_t)(*it)->GetUID(), 0, "%s", (*it)->GetName())) 
 		{
 			RecursiveDirectoryDraw(*it);
 			ImGui::TreePop();
@@ -3,6 +3,7 @@
 
 #include "Panel.h"
 #include "Globals.h"
+#include "FrameAllocator.h"
 #include <string>
 #include <vector>
 
@@ -45,7 +46,7 @@ private:
 
 	void DrawFolder(ResourceFolder* folder);
 	void DrawFile(Resource* resource, uint i, uint row, ImVec2& cursor_pos, ImVec4& color, bool child = false);
-	void LimitText(std::string& text);
+	void LimitText(FrameString& text);
 
 	void RecursiveDirectoryDraw(ResourceFolder* folder);
 
@@ -136,5 +136,5 @@ void PanelResources::DrawResourceNode(Resource* resource, ImVec4& color)
 	ImGui::SameLine();
 	ImGui::Text("Instances: ");
 	ImGui::SameLine();
-	ImGui::TextColored(color, std::to_string(resource->GetNumInstances()).c_str());
+	ImGui::TextColored(color, "%u", resource->GetNumInstances());
 }
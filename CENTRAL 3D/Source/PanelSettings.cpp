@@ -13,11 +13,15 @@
 #include "OpenGL.h"
 #include "DevIL/include/il.h"
 #include "Assimp/include/version.h"
+#include "FrameAllocator.h"
+#include "FrameStats.h"
+#include "FrameScheduler.h"
+#include "Kernels.h"
 
 #include "mmgr/mmgr.h"
 
 
-PanelSettings::PanelSettings(char * name): Panel(name) , FPS_Tracker(FPS_TRACKER_SIZE), MS_Tracker(FPS_TRACKER_SIZE)
+PanelSettings::PanelSettings(char * name): Panel(name)
 {
 
 }
@@ -101,33 +105,82 @@ inline void PanelSettings::ApplicationNode() const
 	ImGui::SameLine();
 	ImGui::TextColored(ImVec4(255,255,0,255), "%i", App->time->GetMaxFramerate());
 
+	// --- Frame pacing ---
+	bool smooth_dt = App->time->GetSmoothDt();
+	if (ImGui::Checkbox("Smooth dt", &smooth_dt))
+		App->time->SetSmoothDt(smooth_dt);
+
+	float fixed_step = App->time->GetFixedTimestep() * 1000.0f;
+	if (ImGui::DragFloat("Fixed timestep (ms)", &fixed_step, 0.1f, 0.0f, 100.0f, "%.2f"))
+		App->time->SetFixedTimestep(fixed_step / 1000.0f);
+
 	// --- Framerate && Ms ---
-	char title[25];
-	sprintf_s(title, 25, "Framerate %.1f", FPS_Tracker[FPS_Tracker.size() - 1]);
-	ImGui::PlotHistogram("##Framerate", &FPS_Tracker[0], FPS_Tracker.size(), 0, title, 0.0f, 100.0f, ImVec2(500, 75));
-	sprintf_s(title, 25, "Milliseconds %0.1f", MS_Tracker[MS_Tracker.size() - 1]);
-	ImGui::PlotHistogram("##Milliseconds", &MS_Tracker[0], MS_Tracker.size(), 0, title, 0.0f, 40.0f, ImVec2(500, 75));
+	FrameStatsNode();
+
+	ImGui::Separator();
+
+	// --- Deferred work ---
+	DeferredWorkNode();
 
 	// --- Memory ---
-	sMStats MemoryStats = m_getMemoryStatistics(); // Using mmgr 
+	MemoryStats tag_stats[(uint)MemoryTag::count];
+	MemoryStats total;
+
+	for (uint i = 0; i < (uint)MemoryTag::count; ++i)
+	{
+		tag_stats[i] = Memory::GetHeap((MemoryTag)i).GetStats();
+		total.bytes += tag_stats[i].bytes;
+		total.peak_bytes += tag_stats[i].peak_bytes;
+	}
+
 	static int speed = 0;
-	static std::vector<float> Memory(100); // Hom many units/lines we want in the plot
+	static std::vector<float> Memory_Tracker(100); // Hom many units/lines we want in the plot
 	if (++speed > 25) // How fast the plot is plotted :)
 	{
 		speed = 0;
-		if (Memory.size() == 100)
+		if (Memory_Tracker.size() == 100)
 		{
 			for (uint i = 0; i < 100 - 1; ++i)
-				Memory[i] = Memory[i + 1];
+				Memory_Tracker[i] = Memory_Tracker[i + 1];
 
-			Memory[100 - 1] = (float)MemoryStats.totalReportedMemory;
+			Memory_Tracker[100 - 1] = (float)total.bytes;
 		}
 		else
-			Memory.push_back((float)MemoryStats.totalReportedMemory);
+			Memory_Tracker.push_back((float)total.bytes);
+	}
+
+	ImGui::PlotHistogram("##Memory", &Memory_Tracker[0], Memory_Tracker.size(), 0, "Memory Consumption", 0.0f, (float)total.peak_bytes * 1.2f, ImVec2(500, 75));
+
+	// --- Engine heaps ---
+	ImGui::Columns(6, "##MemoryTags");
+	ImGui::Text("Heap"); ImGui::NextColumn();
+	ImGui::Text("KB"); ImGui::NextColumn();
+	ImGui::Text("Peak KB"); ImGui::NextColumn();
+	ImGui::Text("Allocs"); ImGui::NextColumn();
+	ImGui::Text("Frees"); ImGui::NextColumn();
+	ImGui::Text("Live"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (uint i = 0; i < (uint)MemoryTag::count; ++i)
+	{
+		ImGui::Text("%s", Memory::GetTagName((MemoryTag)i)); ImGui::NextColumn();
+		ImGui::Text("%.1f", tag_stats[i].bytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%.1f", tag_stats[i].peak_bytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%lld", tag_stats[i].allocations); ImGui::NextColumn();
+		ImGui::Text("%lld", tag_stats[i].frees); ImGui::NextColumn();
+		ImGui::Text("%lld", tag_stats[i].live_blocks); ImGui::NextColumn();
 	}
 
-	ImGui::PlotHistogram("##Memory", &Memory[0], Memory.size(), 0, "Memory Consumption", 0.0f, (float)MemoryStats.peakReportedMemory * 1.2f, ImVec2(500, 75));
+	ImGui::Columns(1);
+
+	ImGui::Text("Frame Scratch: %.1f KB (peak %.1f KB)", FrameMemory::GetUsed() / 1024.0f, FrameMemory::GetPeak() / 1024.0f);
+	ImGui::Text("Heap Calls Last Frame: %llu", FrameMemory::GetHeapCalls());
 
+#if defined(_DEBUG) && !defined(NO_MMGR)
+	// --- Everything else, using mmgr ---
+	sMStats MemoryStats = m_getMemoryStatistics();
+
+	ImGui::Separator();
 	ImGui::Text("Total Reported Memory: %u", MemoryStats.totalReportedMemory);
 	ImGui::Text("Total Actual Memory: %u", MemoryStats.totalActualMemory);
 	ImGui::Text("Peak Reported Memory: %u", MemoryStats.peakReportedMemory);
@@ -137,6 +190,7 @@ inline void PanelSettings::ApplicationNode() const
 	ImGui::Text("Accumulated Alloc Unit Count: %u", MemoryStats.accumulatedAllocUnitCount);
 	ImGui::Text("Total Alloc Unit Count: %u", MemoryStats.totalAllocUnitCount);
 	ImGui::Text("Peak Alloc Unit Count: %u", MemoryStats.peakAllocUnitCount);
+#endif
 }
 
 inline void PanelSettings::WindowNode() const
@@ -233,6 +287,10 @@ inline void PanelSettings::RendererNode() const
 	if (ImGui::Checkbox("FACE CULLING", &App->renderer3D->cull_face))
 	{ }
 
+	// --- Render thread is created at startup ---
+	if (ImGui::Checkbox("PIPELINED FRAMES (restart)", &App->renderer3D->pipelined))
+	{ }
+
 }
 
 
@@ -276,7 +334,33 @@ inline void PanelSettings::HardwareNode() const
 	if (hardware_info.avx)							   
 	ImGui::TextColored(ImVec4(255, 255, 0, 255), "%s", "avx");	ImGui::SameLine();
 	if (hardware_info.avx2)						
-	ImGui::TextColored(ImVec4(255, 255, 0, 255), "%s", "avx2");
+	ImGui::TextColored(ImVec4(255, 255, 0, 255), "%s", "avx2"); ImGui::SameLine();
+	if (hardware_info.neon)
+	ImGui::TextColored(ImVec4(255, 255, 0, 255), "%s", "neon");
+	ImGui::NewLine();
+
+	// --- Kernels, the variant each one runs. Picking another is for comparing them, the best validated one is the default ---
+	for (uint i = 0; i < (uint)KernelId::count; ++i)
+	{
+		KernelId kernel = (KernelId)i;
+		KernelLevel current = Kernels::GetLevel(kernel);
+
+		if (ImGui::BeginCombo(Kernels::GetKernelName(kernel), Kernels::GetLevelName(current)))
+		{
+			for (uint j = 0; j < (uint)KernelLevel::count; ++j)
+			{
+				KernelLevel level = (KernelLevel)j;
+
+				if (!Kernels::HasVariant(kernel, level))
+					continue;
+
+				if (ImGui::Selectable(Kernels::GetLevelName(level), level == current) && !Kernels::SetLevel(kernel, level))
+					CONSOLE_LOG("![Warning]: Kernels: %s %s failed validation at startup", Kernels::GetLevelName(level), Kernels::GetKernelName(kernel));
+			}
+
+			ImGui::EndCombo();
+		}
+	}
 
 	ImGui::Separator();
 	// --- RAM ---
@@ -349,23 +433,171 @@ inline void PanelSettings::LibrariesNode() const
 
 }
 
-void PanelSettings::AddFPS(float fps, float ms)
+// --- Plot getters, the last FPS_TRACKER_SIZE frames of the stats window ---
+static float GetTrackedMs(void* data, int index)
 {
-	static uint counter = 0;
+	FrameStats& stats = FrameStats::Get();
+	uint count = stats.GetFrameCount();
+	uint first = count > FPS_TRACKER_SIZE ? count - FPS_TRACKER_SIZE : 0;
+
+	return stats.GetFrameMs(first + index);
+}
+
+static float GetTrackedFPS(void* data, int index)
+{
+	float ms = GetTrackedMs(data, index);
+	return ms > 0.0f ? 1000.0f / ms : 0.0f;
+}
+
+static float GetHistogramBucket(void* data, int index)
+{
+	return (float)FrameStats::Get().GetHistogram()[index];
+}
+
+inline void PanelSettings::FrameStatsNode() const
+{
+	FrameStats& stats = FrameStats::Get();
+	uint count = stats.GetFrameCount();
+	int tracked = count < FPS_TRACKER_SIZE ? (int)count : FPS_TRACKER_SIZE;
+	float last_ms = count > 0 ? stats.GetFrameMs(count - 1) : 0.0f;
+
+	char title[25];
+	sprintf_s(title, 25, "Framerate %.1f", last_ms > 0.0f ? 1000.0f / last_ms : 0.0f);
+	ImGui::PlotHistogram("##Framerate", GetTrackedFPS, nullptr, tracked, 0, title, 0.0f, 100.0f, ImVec2(500, 75));
+	sprintf_s(title, 25, "Milliseconds %0.1f", last_ms);
+	ImGui::PlotHistogram("##Milliseconds", GetTrackedMs, nullptr, tracked, 0, title, 0.0f, 40.0f, ImVec2(500, 75));
+
+	// --- Percentiles over the whole window ---
+	FrameStatsSummary summary = stats.GetSummary();
+	ImGui::Text("Last %u frames:", summary.samples);
+	ImGui::Text("p50"); ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%.2f ms", summary.p50);
+	ImGui::SameLine(); ImGui::Text("p95"); ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%.2f ms", summary.p95);
+	ImGui::SameLine(); ImGui::Text("p99"); ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%.2f ms", summary.p99);
+	ImGui::SameLine(); ImGui::Text("max"); ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%.2f ms", summary.max);
 
-	// --- If the plot historiogram is already full we shift ---
-	if (counter == FPS_TRACKER_SIZE)
+	ImGui::PlotHistogram("##FrameHistogram", GetHistogramBucket, nullptr, FRAME_STATS_BUCKETS, 0, "Frame time histogram (log buckets)", 0.0f, FLT_MAX, ImVec2(500, 75));
+
+	if (ImGui::IsItemHovered())
+	{
+		// --- Bucket under the mouse ---
+		float x = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+		uint bucket = (uint)(x * FRAME_STATS_BUCKETS);
+		bucket = bucket < FRAME_STATS_BUCKETS ? bucket : FRAME_STATS_BUCKETS - 1;
+		ImGui::SetTooltip("From %.2f ms: %u frames", FrameStats::GetBucketStart(bucket), stats.GetHistogram()[bucket]);
+	}
+
+	// --- Modules ---
+	if (ImGui::TreeNode("Modules"))
+	{
+		ImGui::Columns(5, "##ModuleStats");
+		ImGui::Text("Module"); ImGui::NextColumn();
+		ImGui::Text("p50"); ImGui::NextColumn();
+		ImGui::Text("p95"); ImGui::NextColumn();
+		ImGui::Text("p99"); ImGui::NextColumn();
+		ImGui::Text("max"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		for (uint i = FRAME_STATS_FRAME_SERIES + 1; i < stats.GetSeriesCount(); ++i)
+		{
+			FrameStatsSummary module = stats.GetSummary(i);
+			ImGui::Text("%s", stats.GetSeriesName(i)); ImGui::NextColumn();
+			ImGui::Text("%.3f", module.p50); ImGui::NextColumn();
+			ImGui::Text("%.3f", module.p95); ImGui::NextColumn();
+			ImGui::Text("%.3f", module.p99); ImGui::NextColumn();
+			ImGui::Text("%.3f", module.max); ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+		ImGui::TreePop();
+	}
+
+	// --- Hitches ---
+	float factor = stats.GetHitchFactor();
+	if (ImGui::SliderFloat("Hitch threshold (x median)", &factor, 1.5f, 10.0f, "%.1f"))
+		stats.SetHitchFactor(factor);
+
+	const std::vector<FrameHitch>& hitches = stats.GetHitches();
+
+	if (ImGui::TreeNode("##Hitches", "Hitches (%u)", (uint)hitches.size()))
 	{
-		for (uint i = 0; i < FPS_TRACKER_SIZE - 1; ++i)
+		for (int i = (int)hitches.size() - 1; i >= 0; --i)
 		{
-			FPS_Tracker[i] = FPS_Tracker[i + 1];
-			MS_Tracker[i] = MS_Tracker[i + 1];
+			const FrameHitch& hitch = hitches[i];
+
+			if (!ImGui::TreeNode((void*)(intptr_t)hitch.frame, "Frame %llu: %.2f ms, %.1fx median", hitch.frame, hitch.ms, hitch.ms / hitch.median))
+				continue;
+
+			for (uint j = 0; j < hitch.events.size(); ++j)
+				ImGui::BulletText("Event %s", hitch.events[j].c_str());
+
+			for (uint j = 0; j < hitch.scopes.size(); ++j)
+			{
+				const ProfileEvent& scope = hitch.scopes[j];
+				ImGui::Text("%*s%s (%s) %.3f ms", scope.depth * 2, "", scope.name, Profiler::Get().GetThreadName(scope.thread), (scope.end - scope.start) / 1000000.0f);
+			}
+
+			ImGui::TreePop();
 		}
+
+		ImGui::TreePop();
 	}
-	else // We count until the max size is reached, then substitute values in the if above
-		++counter;
 
-	FPS_Tracker[counter - 1] = fps;
-	MS_Tracker[counter - 1] = ms;
+	if (ImGui::Button("Export CSV"))
+	{
+		stats.ExportCSV();
+		stats.ExportSummaryCSV();
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Clear##FrameStats"))
+		stats.Clear();
+}
+
+static float GetDeferredMs(void* data, int index)
+{
+	return FrameScheduler::Get().GetUsedMs(index);
 }
 
+inline void PanelSettings::DeferredWorkNode() const
+{
+	FrameScheduler& scheduler = FrameScheduler::Get();
+
+	float budget = scheduler.GetBudgetMs();
+	if (ImGui::DragFloat("Deferred budget (ms)", &budget, 0.1f, 0.0f, 16.0f, "%.1f"))
+		scheduler.SetBudgetMs(budget);
+
+	ImGui::Text("Queue:");
+	ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%u", scheduler.GetQueueDepth());
+	ImGui::SameLine(); ImGui::Text("(high %u, normal %u, low %u)", scheduler.GetQueueDepth(DeferredPriority::High), scheduler.GetQueueDepth(DeferredPriority::Normal), scheduler.GetQueueDepth(DeferredPriority::Low));
+
+	ImGui::Text("Last frame:");
+	ImGui::SameLine(); ImGui::TextColored(ImVec4(255, 255, 0, 255), "%.2f ms", scheduler.GetUsedMs());
+	ImGui::SameLine(); ImGui::Text("of %.2f ms granted, %llu done, %llu cancelled", scheduler.GetGrantedMs(), scheduler.GetCompleted(), scheduler.GetCancelled());
+
+	char title[25];
+	sprintf_s(title, 25, "Deferred %.2f ms", scheduler.GetUsedMs());
+	ImGui::PlotHistogram("##Deferred", GetDeferredMs, nullptr, scheduler.GetHistoryCount(), 0, title, 0.0f, budget * 2.0f, ImVec2(500, 75));
+
+	std::vector<DeferredTaskInfo> tasks;
+	scheduler.GetTasks(tasks);
+
+	if (ImGui::TreeNode("##DeferredTasks", "Tasks (%u)", (uint)tasks.size()))
+	{
+		static const char* priorities[] = { "High", "Normal", "Low" };
+
+		for (uint i = 0; i < tasks.size(); ++i)
+		{
+			ImGui::PushID((int)tasks[i].id);
+
+			if (ImGui::SmallButton("Cancel"))
+				scheduler.Cancel(tasks[i].id);
+
+			ImGui::SameLine();
+			ImGui::Text("%s (%s), waited %u frames, %u slices, %.2f ms", tasks[i].name, priorities[(int)tasks[i].priority], tasks[i].waited, tasks[i].slices, tasks[i].ms);
+			ImGui::PopID();
+		}
+
+		ImGui::TreePop();
+	}
+}
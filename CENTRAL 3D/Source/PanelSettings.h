@@ -14,7 +14,6 @@ public:
 	PanelSettings(char* name);
 	~PanelSettings();
 
-	void AddFPS(float fps, float ms);
 	bool Draw();
 
 private:
@@ -25,10 +24,8 @@ private:
 	inline void RendererNode() const;
 	inline void HardwareNode() const;
 	inline void LibrariesNode() const;
-
-private:
-	std::vector<float> FPS_Tracker;
-	std::vector<float> MS_Tracker;
+	inline void FrameStatsNode() const;
+	inline void DeferredWorkNode() const;
 };
 
 #endif
\ No newline at end of file
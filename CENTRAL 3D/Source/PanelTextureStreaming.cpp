@@ -0,0 +1,108 @@
+#include "PanelTextureStreaming.h"
+#include "Application.h"
+#include "ModuleTextures.h"
+#include "ModuleHardware.h"
+#include "ResourceTexture.h"
+
+#include "Imgui/imgui.h"
+
+#include "mmgr/mmgr.h"
+
+#define STREAMING_PANEL_MB (1024.0f * 1024.0f)
+
+PanelTextureStreaming::PanelTextureStreaming(char* name) : Panel(name)
+{
+}
+
+PanelTextureStreaming::~PanelTextureStreaming()
+{
+}
+
+bool PanelTextureStreaming::Draw()
+{
+	ImGuiWindowFlags streamingFlags = 0;
+	streamingFlags |= ImGuiWindowFlags_NoFocusOnAppearing;
+
+	if (ImGui::Begin(name, &enabled, streamingFlags))
+	{
+		TextureStreamer& streamer = App->textures->streamer;
+
+		int budget = (int)streamer.GetBudgetMB();
+
+		if (ImGui::DragInt("Budget (MB)", &budget, 8.0f, 16, 16384))
+			streamer.SetBudgetMB(budget < 16 ? 16 : (uint)budget);
+
+		// --- Resident against what the budget allows, the driver may leave less than asked for ---
+		float resident = streamer.GetResidentBytes() / STREAMING_PANEL_MB;
+		float effective = streamer.GetEffectiveBudget() / STREAMING_PANEL_MB;
+		char overlay[64];
+		sprintf_s(overlay, 64, "%.1f / %.1f MB", resident, effective);
+		ImGui::ProgressBar(effective > 0.0f ? resident / effective : 1.0f, ImVec2(-1.0f, 0.0f), overlay);
+
+		ImGui::Text("Requested: %.1f MB", streamer.GetRequestedBytes() / STREAMING_PANEL_MB);
+		ImGui::Text("Loads in flight: %u", streamer.GetLoadsInFlight());
+
+		const hw_info& info = App->hardware->GetInfo();
+
+		if (info.vram_mb_budget > 0.0f)
+			ImGui::Text("VRAM: %.1f MB used, %.1f MB available", info.vram_mb_usage, info.vram_mb_available);
+		else
+			ImGui::TextDisabled("VRAM: not reported by the driver");
+
+		ImGui::Separator();
+		ImGui::Checkbox("Only textures streaming", &only_streaming);
+
+		DrawTextures();
+	}
+
+	ImGui::End();
+
+	return true;
+}
+
+void PanelTextureStreaming::DrawTextures()
+{
+	TextureStreamer& streamer = App->textures->streamer;
+	const std::map<uint, StreamedTexture>& textures = streamer.GetTextures();
+
+	ImGui::BeginChild("Textures");
+	ImGui::Columns(7, "StreamedTextures");
+
+	ImGui::Text("Texture"); ImGui::NextColumn();
+	ImGui::Text("Size"); ImGui::NextColumn();
+	ImGui::Text("Resident"); ImGui::NextColumn();
+	ImGui::Text("Requested"); ImGui::NextColumn();
+	ImGui::Text("Target"); ImGui::NextColumn();
+	ImGui::Text("MB"); ImGui::NextColumn();
+	ImGui::Text("On screen"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	// --- Levels are shown by their width. Targets the budget lowered are red, a * marks a load in flight ---
+	for (std::map<uint, StreamedTexture>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		const StreamedTexture& texture = it->second;
+
+		if (only_streaming && texture.resident == texture.requested && !texture.load)
+			continue;
+
+		uint width = texture.info.width;
+		uint height = texture.info.height;
+
+		ImGui::Text("%s", texture.resource->GetName()); ImGui::NextColumn();
+		ImGui::Text("%ux%u", width, height); ImGui::NextColumn();
+		ImGui::Text("%u", width >> texture.resident ? width >> texture.resident : 1); ImGui::NextColumn();
+		ImGui::Text("%u", width >> texture.requested ? width >> texture.requested : 1); ImGui::NextColumn();
+
+		if (texture.target > texture.requested)
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%u", width >> texture.target ? width >> texture.target : 1);
+		else
+			ImGui::Text("%u", width >> texture.target ? width >> texture.target : 1);
+
+		ImGui::NextColumn();
+		ImGui::Text("%.2f%s", streamer.GetSize(texture, texture.resident) / STREAMING_PANEL_MB, texture.load ? " *" : ""); ImGui::NextColumn();
+		ImGui::Text("%.0f px", texture.on_screen); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+	ImGui::EndChild();
+}
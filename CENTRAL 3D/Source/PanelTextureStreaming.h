@@ -0,0 +1,22 @@
+#ifndef __PANEL_TEXTURE_STREAMING_H__
+#define __PANEL_TEXTURE_STREAMING_H__
+
+#include "Panel.h"
+
+class PanelTextureStreaming : public Panel
+{
+public:
+
+	PanelTextureStreaming(char* name);
+	~PanelTextureStreaming();
+
+	bool Draw();
+
+private:
+
+	void DrawTextures();
+
+	bool only_streaming = false; // Hide textures at the level they were requested at
+};
+
+#endif
@@ -12,5 +12,7 @@
 #include "PanelProject.h"
 #include "PanelShaderEditor.h"
 #include "PanelResources.h"
+#include "PanelProfiler.h"
+#include "PanelTextureStreaming.h"
 
 #endif // __PANELS_H__
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+// --- Included by Globals.h when building outside Windows (headless tools, benchmark) ---
+// --- Maps the few MSVC runtime calls the engine uses onto standard C ---
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#define sprintf_s snprintf
+#define vsprintf_s vsnprintf
+#define fread_s(buffer, buffer_size, element_size, count, file) fread(buffer, element_size, count, file)
+#define OutputDebugString(text) fputs(text, stderr)
+#define GetCurrentDirectoryA(size, buffer) getcwd(buffer, size)
+
+inline int strcpy_s(char* dest, size_t size, const char* src)
+{
+	if (!dest || size == 0)
+		return 1;
+
+	strncpy(dest, src, size - 1);
+	dest[size - 1] = '\0';
+	return 0;
+}
+
+inline int strcat_s(char* dest, size_t size, const char* src)
+{
+	size_t length = strlen(dest);
+
+	if (length >= size)
+		return 1;
+
+	return strcpy_s(dest + length, size - length, src);
+}
+
+inline int fopen_s(FILE** file, const char* path, const char* mode)
+{
+	*file = fopen(path, mode);
+	return *file ? 0 : 1;
+}
+
+#endif
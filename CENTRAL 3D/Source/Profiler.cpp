@@ -0,0 +1,339 @@
+#include "Profiler.h"
+#include <fstream>
+#include <string>
+
+#include "mmgr/mmgr.h"
+
+// ----------------------------------------------------------------------------------------------------------
+// --- ProfileRing ---
+
+ProfileRing::ProfileRing()
+{
+	in_use = false;
+	dropped = 0;
+	head = 0;
+	tail = 0;
+	thread_name[0] = '\0';
+}
+
+bool ProfileRing::Push(const ProfileEvent& event)
+{
+	uint t = tail.load(std::memory_order_relaxed);
+
+	// --- Full, the main thread did not drain it in time ---
+	if (t - head.load(std::memory_order_acquire) >= PROFILER_THREAD_EVENTS)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	events[t & (PROFILER_THREAD_EVENTS - 1)] = event;
+	tail.store(t + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool ProfileRing::Pop(ProfileEvent& event)
+{
+	uint h = head.load(std::memory_order_relaxed);
+
+	if (h == tail.load(std::memory_order_acquire))
+		return false;
+
+	event = events[h & (PROFILER_THREAD_EVENTS - 1)];
+	head.store(h + 1, std::memory_order_release);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- Profiler ---
+
+// --- Gives the thread's ring back when the thread exits ---
+struct ProfileThreadRing
+{
+	ProfileRing* ring = nullptr;
+	uint depth = 0;
+
+	~ProfileThreadRing()
+	{
+		if (ring)
+			ring->in_use = false;
+	}
+};
+
+static thread_local ProfileThreadRing profile_thread;
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+uint64 Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Get().origin).count();
+}
+
+Profiler::Profiler()
+{
+	static_assert((PROFILER_THREAD_EVENTS & (PROFILER_THREAD_EVENTS - 1)) == 0, "PROFILER_THREAD_EVENTS must be a power of two!");
+	static_assert((PROFILER_EVENTS & (PROFILER_EVENTS - 1)) == 0, "PROFILER_EVENTS must be a power of two!");
+
+	origin = std::chrono::steady_clock::now();
+
+	for (uint i = 0; i < PROFILER_MAX_THREADS; ++i)
+		rings[i] = nullptr;
+
+	ring_count = 0;
+	events = new ProfileEvent[PROFILER_EVENTS];
+}
+
+Profiler::~Profiler()
+{
+	for (uint i = 0; i < PROFILER_MAX_THREADS; ++i)
+		delete rings[i];
+
+	delete[] events;
+}
+
+void Profiler::Record(const char* name, uint64 start, uint64 end, uint depth)
+{
+	ProfileRing* ring = GetThreadRing();
+
+	if (!ring)
+		return;
+
+	ProfileEvent event;
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	event.depth = depth;
+	ring->Push(event);
+}
+
+void Profiler::EndFrame()
+{
+	uint64 now = Now();
+	uint count = ring_count.load(std::memory_order_acquire);
+
+	ProfileFrame frame;
+	frame.first_event = event_count;
+	frame.start = frame_start;
+	frame.end = now;
+
+	ProfileEvent event;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		// --- Always drain so rings do not fill while paused ---
+		while (rings[i]->Pop(event))
+		{
+			if (paused)
+				continue;
+
+			event.thread = i;
+			events[event_count & (PROFILER_EVENTS - 1)] = event;
+			event_count++;
+		}
+
+		dropped_events += rings[i]->dropped.exchange(0);
+	}
+
+	frame.end_event = event_count;
+	frame_start = now;
+
+	if (!paused)
+	{
+		frames[frame_count % PROFILER_FRAMES] = frame;
+		frame_count++;
+	}
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ProfileRing* ring = GetThreadRing();
+
+	if (ring)
+		strcpy_s(ring->thread_name, PROFILER_THREAD_NAME_SIZE, name);
+}
+
+void Profiler::SetPaused(bool paused)
+{
+	this->paused = paused;
+}
+
+bool Profiler::IsPaused() const
+{
+	return paused;
+}
+
+uint64 Profiler::GetFrameCount() const
+{
+	return frame_count;
+}
+
+bool Profiler::GetFrame(uint64 index, ProfileFrame& frame) const
+{
+	if (index >= frame_count || index + PROFILER_FRAMES < frame_count)
+		return false;
+
+	frame = frames[index % PROFILER_FRAMES];
+
+	// --- Newer frames may have pushed its events out ---
+	return frame.first_event + PROFILER_EVENTS >= event_count;
+}
+
+const ProfileEvent& Profiler::GetEvent(uint64 index) const
+{
+	return events[index & (PROFILER_EVENTS - 1)];
+}
+
+uint Profiler::GetThreadCount() const
+{
+	return ring_count.load(std::memory_order_acquire);
+}
+
+const char* Profiler::GetThreadName(uint thread) const
+{
+	return thread < GetThreadCount() ? rings[thread]->thread_name : "";
+}
+
+uint Profiler::GetThreadIndex()
+{
+	ProfileRing* ring = GetThreadRing();
+	uint count = ring_count.load(std::memory_order_acquire);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		if (rings[i] == ring)
+			return i;
+	}
+
+	return PROFILER_MAX_THREADS;
+}
+
+uint Profiler::GetDroppedEvents() const
+{
+	return dropped_events;
+}
+
+// --- Scope names are code identifiers, but keep the json valid whatever they are ---
+static void AppendEscaped(std::string& out, const char* text)
+{
+	for (const char* c = text; *c; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			out += '\\';
+
+		if ((unsigned char)*c >= 0x20)
+			out += *c;
+	}
+}
+
+bool Profiler::ExportChromeTrace(const char* path) const
+{
+	std::string json = "{\"traceEvents\":[\n";
+	char tmp[256];
+
+	// --- Thread names ---
+	for (uint i = 0; i < GetThreadCount(); ++i)
+	{
+		sprintf_s(tmp, 256, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", i);
+		json += tmp;
+		AppendEscaped(json, rings[i]->thread_name[0] ? rings[i]->thread_name : "Thread");
+		json += "\"}},\n";
+	}
+
+	uint64 first = frame_count > PROFILER_FRAMES ? frame_count - PROFILER_FRAMES : 0;
+	ProfileFrame frame;
+
+	for (uint64 f = first; f < frame_count; ++f)
+	{
+		if (!GetFrame(f, frame))
+			continue;
+
+		// --- Frames go on a track of their own ---
+		sprintf_s(tmp, 256, "{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n", f, PROFILER_MAX_THREADS, frame.start / 1000.0, (frame.end - frame.start) / 1000.0);
+		json += tmp;
+
+		for (uint64 i = frame.first_event; i < frame.end_event; ++i)
+		{
+			const ProfileEvent& event = GetEvent(i);
+
+			json += "{\"name\":\"";
+			AppendEscaped(json, event.name);
+			sprintf_s(tmp, 256, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n", event.thread, event.start / 1000.0, (event.end - event.start) / 1000.0);
+			json += tmp;
+		}
+	}
+
+	sprintf_s(tmp, 256, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Frames\"}}\n]}\n", PROFILER_MAX_THREADS);
+	json += tmp;
+
+	std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+
+	if (!file.is_open())
+	{
+		CONSOLE_LOG("|[error]: Profiler: could not open %s to export the trace", path);
+		return false;
+	}
+
+	file << json;
+	file.close();
+
+	CONSOLE_LOG("Profiler: exported %llu frames to %s", frame_count - first, path);
+
+	return true;
+}
+
+ProfileRing* Profiler::GetThreadRing()
+{
+	if (profile_thread.ring)
+		return profile_thread.ring;
+
+	// --- First scope on this thread, reuse the ring of a thread that exited or create a new one ---
+	std::lock_guard<std::mutex> lock(register_mutex);
+
+	uint count = ring_count.load(std::memory_order_relaxed);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		if (!rings[i]->in_use)
+		{
+			rings[i]->in_use = true;
+			rings[i]->thread_name[0] = '\0';
+			profile_thread.ring = rings[i];
+			return rings[i];
+		}
+	}
+
+	if (count < PROFILER_MAX_THREADS)
+	{
+		ProfileRing* ring = new ProfileRing;
+		ring->in_use = true;
+		rings[count] = ring;
+		ring_count.fetch_add(1, std::memory_order_release);
+		profile_thread.ring = ring;
+		return ring;
+	}
+
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- ProfileScope ---
+
+ProfileScope::ProfileScope(const char* name) : name(name)
+{
+	depth = profile_thread.depth++;
+	start = Profiler::Now();
+}
+
+ProfileScope::~ProfileScope()
+{
+	uint64 end = Profiler::Now();
+	profile_thread.depth--;
+
+	Profiler::Get().Record(name, start, end, depth);
+}
@@ -0,0 +1,141 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+#define PROFILER_THREAD_EVENTS 8192 // Per thread, must be a power of two
+#define PROFILER_MAX_THREADS 32 // Scopes from threads past this are dropped
+#define PROFILER_EVENTS (1 << 18) // Rolling window shared by all recorded frames, must be a power of two
+#define PROFILER_FRAMES 256 // Rolling window of frames
+#define PROFILER_THREAD_NAME_SIZE 32
+#define PROFILER_TRACE_FILE SETTINGS_FOLDER "profile_trace.json"
+
+// --- Define PROFILER_ENABLED 0 to compile every scope out ---
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name) // name must outlive the profiler, a literal or a module name
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_THREAD(name) Profiler::Get().SetThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+#endif
+
+struct ProfileEvent
+{
+	const char* name = nullptr;
+	uint64 start = 0; // Nanoseconds since the profiler was created
+	uint64 end = 0;
+	uint thread = 0; // Index of the thread buffer
+	uint depth = 0; // Nesting level on its thread
+};
+
+struct ProfileFrame
+{
+	uint64 first_event = 0; // Index into the event window
+	uint64 end_event = 0; // One past the last
+	uint64 start = 0;
+	uint64 end = 0;
+};
+
+// --- Single producer (the owning thread), single consumer (the main thread at EndFrame) ring ---
+class ProfileRing
+{
+public:
+
+	ProfileRing();
+
+	bool Push(const ProfileEvent& event);
+	bool Pop(ProfileEvent& event);
+
+	std::atomic<bool> in_use;
+	std::atomic<uint> dropped;
+	char thread_name[PROFILER_THREAD_NAME_SIZE];
+
+private:
+
+	ProfileEvent events[PROFILER_THREAD_EVENTS];
+	std::atomic<uint> head; // Next to read
+	std::atomic<uint> tail; // Next to write
+};
+
+class Profiler
+{
+public:
+
+	static Profiler& Get();
+	static uint64 Now();
+
+	// --- Scopes call this on exit, one event per scope ---
+	void Record(const char* name, uint64 start, uint64 end, uint depth);
+
+	// --- Main thread, once per frame at Application::FinishUpdate. Moves every thread's events into the window ---
+	void EndFrame();
+
+	void SetThreadName(const char* name);
+	void SetPaused(bool paused);
+	bool IsPaused() const;
+
+	// --- Window access, main thread only ---
+	uint64 GetFrameCount() const; // Frames recorded since start, only the last PROFILER_FRAMES are kept
+	bool GetFrame(uint64 index, ProfileFrame& frame) const; // False if the frame or its events left the window
+	const ProfileEvent& GetEvent(uint64 index) const;
+	uint GetThreadCount() const;
+	const char* GetThreadName(uint thread) const;
+	uint GetThreadIndex(); // Calling thread's index in ProfileEvent::thread
+	uint GetDroppedEvents() const;
+
+	// --- Chrome trace event format, opens in Perfetto and chrome://tracing ---
+	bool ExportChromeTrace(const char* path = PROFILER_TRACE_FILE) const;
+
+private:
+
+	Profiler();
+	~Profiler();
+
+	ProfileRing* GetThreadRing();
+
+private:
+
+	std::chrono::steady_clock::time_point origin;
+
+	ProfileRing* rings[PROFILER_MAX_THREADS];
+	std::atomic<uint> ring_count;
+	std::mutex register_mutex;
+
+	// --- Rolling window ---
+	ProfileEvent* events = nullptr;
+	uint64 event_count = 0;
+	ProfileFrame frames[PROFILER_FRAMES];
+	uint64 frame_count = 0;
+	uint64 frame_start = 0;
+	uint dropped_events = 0;
+
+	bool paused = false;
+};
+
+// --- Times its own lifetime ---
+class ProfileScope
+{
+public:
+
+	ProfileScope(const char* name);
+	~ProfileScope();
+
+private:
+
+	const char* name;
+	uint64 start;
+	uint depth;
+};
+
+#endif
@@ -1,7 +1,7 @@
 #include "Globals.h"
 #include "GameObject.h"
 #include "ComponentTransform.h"
-#include "QuadTree.h"
+#include "Quadtree.h"
 
 #include "mmgr/mmgr.h"
 
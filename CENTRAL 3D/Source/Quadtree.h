@@ -30,10 +30,10 @@ public:
 	void CollectBoxes(std::vector<const QuadtreeNode*>& nodes) const;
 	void CollectObjects(std::vector<GameObject*>& objects) const;
 	void CollectObjects(std::map<float, GameObject*>& objects, const float3& origin) const;
-	template<typename TYPE>
-	void CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive) const;
-	template<typename TYPE>
-	void CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive) const;
+	template<typename TYPE, typename Compare, typename Alloc>
+	void CollectIntersections(std::map<float, GameObject*, Compare, Alloc>& objects, const TYPE& primitive) const;
+	template<typename TYPE, typename Alloc>
+	void CollectIntersections(std::vector<GameObject*, Alloc>& objects, const TYPE& primitive) const;
 
 public:
 	AABB box;
@@ -56,32 +56,33 @@ public:
 	void CollectBoxes(std::vector<const QuadtreeNode*>& nodes) const;
 	void CollectObjects(std::vector<GameObject*>& objects) const;
 	void CollectObjects(std::map<float, GameObject*>& objects, const float3& origin) const;
-	template<typename TYPE>
-	void CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive) const;
-	template<typename TYPE>
-	void CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive) const;
+	template<typename TYPE, typename Compare, typename Alloc>
+	void CollectIntersections(std::map<float, GameObject*, Compare, Alloc>& objects, const TYPE& primitive) const;
+	template<typename TYPE, typename Alloc>
+	void CollectIntersections(std::vector<GameObject*, Alloc>& objects, const TYPE& primitive) const;
 
 public:
 	QuadtreeNode* root = nullptr;
 };
 
 // Intersection methods could use a different number of primitives, so we use a template
-template<typename TYPE>
-inline void Quadtree::CollectIntersections(std::map<float, GameObject*>& objects, const TYPE & primitive) const
+// Containers are templated too so callers can hand in frame allocated ones
+template<typename TYPE, typename Compare, typename Alloc>
+inline void Quadtree::CollectIntersections(std::map<float, GameObject*, Compare, Alloc>& objects, const TYPE & primitive) const
 {
 	if (root != nullptr)
 		root->CollectIntersections(objects, primitive);
 }
 
-template<typename TYPE>
-inline void Quadtree::CollectIntersections(std::vector<GameObject*>& objects, const TYPE & primitive) const
+template<typename TYPE, typename Alloc>
+inline void Quadtree::CollectIntersections(std::vector<GameObject*, Alloc>& objects, const TYPE & primitive) const
 {
 	if (root != nullptr)
 		root->CollectIntersections(objects, primitive);
 }
 
-template<typename TYPE>
-inline void QuadtreeNode::CollectIntersections(std::map<float, GameObject*>& objects, const TYPE & primitive) const
+template<typename TYPE, typename Compare, typename Alloc>
+inline void QuadtreeNode::CollectIntersections(std::map<float, GameObject*, Compare, Alloc>& objects, const TYPE & primitive) const
 {
 	if (primitive.Intersects(box))
 	{
@@ -97,8 +98,8 @@ inline void QuadtreeNode::CollectIntersections(std::map<float, GameObject*>& obj
 	}
 }
 
-template<typename TYPE>
-inline void QuadtreeNode::CollectIntersections(std::vector<GameObject*>& objects, const TYPE & primitive) const
+template<typename TYPE, typename Alloc>
+inline void QuadtreeNode::CollectIntersections(std::vector<GameObject*, Alloc>& objects, const TYPE & primitive) const
 {
 	if (primitive.Intersects(box))
 	{
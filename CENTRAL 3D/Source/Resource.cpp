@@ -3,7 +3,10 @@
 #include "ModuleResourceManager.h"
 #include "ModuleEventManager.h"
 #include "ModuleFileSystem.h"
+#include "ModuleGui.h"
+#include "ModuleRenderer3D.h"
 #include "GameObject.h"
+#include "Profiler.h"
 
 #include "mmgr/mmgr.h"
 
@@ -18,6 +21,9 @@ Resource::Resource(ResourceType type, uint UID, std::string source_file)
 
 Resource::~Resource()
 {
+	// --- Handles to this resource go stale from now on ---
+	App->resources->UnregisterResource(this);
+
 	Event e(Event::EventType::Resource_destroyed);
 	e.uid = UID;
 	App->event_manager->PushEvent(e);
@@ -68,6 +74,16 @@ const uint Resource::GetNumInstances() const
 	return instances;
 }
 
+uint Resource::GetHandleIndex() const
+{
+	return handle_index;
+}
+
+uint Resource::GetHandleGeneration() const
+{
+	return handle_generation;
+}
+
 void Resource::SetOriginalFile(const char* new_path)
 {
 	original_file = new_path;
@@ -87,6 +103,8 @@ bool Resource::IsInMemory() const
 
 bool Resource::LoadToMemory()
 {
+	PROFILE_FUNCTION();
+
 	if (instances > 0)
 	{
 		instances++;
@@ -94,6 +112,13 @@ bool Resource::LoadToMemory()
 	else
 	{
 		instances = LoadInMemory() ? 1 : 0;
+
+		if (instances > 0)
+		{
+			Event e(Event::EventType::Resource_loaded);
+			e.uid = UID;
+			App->event_manager->PushEvent(e);
+		}
 	}
 
 	return instances > 0;
@@ -142,6 +167,12 @@ void Resource::NotifyUsers(ResourceNotificationType type)
 	}
 }
 
+void Resource::OnDependencyChanged(uint UID)
+{
+	// --- Users pick the resource up again, most resources hold nothing else that could go stale ---
+	NotifyUsers(ResourceNotificationType::Overwrite);
+}
+
 void Resource::SetName(const char * name)
 {
 	this->name = name;
@@ -152,4 +183,12 @@ void Resource::SetPreviewTexID(uint ID)
 	previewTexID = ID;
 }
 
+void Resource::ReleasePreviewTexture()
+{
+	if (!App->gui->IsEditorIcon(previewTexID))
+		App->renderer3D->ReleaseTexture(previewTexID);
+
+	previewTexID = 0;
+}
+
 
@@ -4,12 +4,16 @@
 #include <string>
 #include <vector>
 #include "Globals.h"
+#include "Allocator.h"
 
 class GameObject;
 
 class Resource 
 {
+	friend class ResourceTable;
 public:
+	MEMORY_TAG(MemoryTag::Resources)
+
 	enum class ResourceType
 	{
 		FOLDER,
@@ -42,12 +46,15 @@ public:
 	const char* GetName() const;
 	const uint GetPreviewTexID() const;
 	const uint GetNumInstances() const;
+	uint GetHandleIndex() const;
+	uint GetHandleGeneration() const; // 0 if not registered on the resource table
 
 	void SetOriginalFile(const char* new_path);
 	void SetResourceFile(const char* new_path); // for temporal scene 
 	void SetUID(uint UID);
 	void SetName(const char* name);
 	void SetPreviewTexID(uint ID);
+	void ReleasePreviewTexture(); // Rendered previews only, the editor's icons are shared
 
 	bool IsInMemory() const;
 	bool LoadToMemory();
@@ -59,6 +66,7 @@ public:
 
 	virtual void OnOverwrite() = 0;
 	virtual void OnDelete() = 0;
+	virtual void OnDependencyChanged(uint UID); // Something this one was built from was reimported
 	virtual void CreateInspectorNode() {};
 
 	// to encapsulate model childs in panelproject
@@ -75,6 +83,8 @@ protected:
 	uint instances = 0;
 	uint previewTexID = 0;
 	uint UID = 0;
+	uint handle_index = 0;
+	uint handle_generation = 0;
 	ResourceType type = ResourceType::UNKNOWN;
 
 	std::vector<GameObject*> users; // Resource notifies all interested objects of overwrites/deletes
@@ -0,0 +1,56 @@
+#ifndef __RESOURCE_HANDLE_H__
+#define __RESOURCE_HANDLE_H__
+
+#include "Globals.h"
+
+class Resource;
+
+// --- Defined by the resource manager, returns nullptr if the slot's generation moved on ---
+Resource* ResolveResourceHandle(uint index, uint generation);
+
+// --- Typed reference to a resource registered on the resource table ---
+// --- Behaves like a pointer, but once the resource is deleted it resolves to nullptr instead of dangling ---
+template<typename TResource>
+class ResourceHandle
+{
+public:
+
+	ResourceHandle() {}
+	ResourceHandle(TResource* resource) { Set(resource); }
+
+	ResourceHandle& operator=(TResource* resource)
+	{
+		Set(resource);
+		return *this;
+	}
+
+	TResource* Get() const
+	{
+		return generation ? static_cast<TResource*>(ResolveResourceHandle(index, generation)) : nullptr;
+	}
+
+	TResource* operator->() const { return Get(); }
+	operator TResource*() const { return Get(); }
+
+	// --- Was pointing to a resource that no longer exists, the UID is kept so it can be looked up again ---
+	bool IsStale() const { return generation != 0 && ResolveResourceHandle(index, generation) == nullptr; }
+	uint GetUID() const { return UID; }
+	void Reset() { index = 0; generation = 0; UID = 0; }
+
+private:
+
+	void Set(TResource* resource)
+	{
+		index = resource ? resource->GetHandleIndex() : 0;
+		generation = resource ? resource->GetHandleGeneration() : 0;
+		UID = resource ? resource->GetUID() : 0;
+	}
+
+private:
+
+	uint index = 0;
+	uint generation = 0;
+	uint UID = 0;
+};
+
+#endif
@@ -30,7 +30,7 @@ ResourceMaterial::ResourceMaterial(uint UID, std::string source_file) : Resource
 
 ResourceMaterial::~ResourceMaterial()
 {
-	glDeleteTextures(1, (GLuint*)&previewTexID);
+	ReleasePreviewTexture();
 }
 
 bool ResourceMaterial::LoadInMemory()
@@ -362,6 +362,15 @@ void ResourceMaterial::OnDelete()
 	App->resources->ONResourceDestroyed(this);
 }
 
+void ResourceMaterial::OnDependencyChanged(uint UID)
+{
+	// --- The shader may have gained or lost uniforms, values of the ones that remain are kept ---
+	if (shader && shader->GetUID() == UID)
+		shader->GetAllUniforms(uniforms);
+
+	NotifyUsers(ResourceNotificationType::Overwrite);
+}
+
 void ResourceMaterial::Repath()
 {
 	resource_file = original_file + extension;
@@ -4,6 +4,7 @@
 #include "Resource.h"
 #include "Globals.h"
 #include "Color.h"
+#include "ResourceHandle.h"
 
 class ResourceTexture;
 class ResourceShader;
@@ -24,7 +25,7 @@ public:
 
 	std::string previewTexPath;
 public:
-	ResourceTexture* resource_diffuse = nullptr;
+	ResourceHandle<ResourceTexture> resource_diffuse;
 	ResourceShader* shader = nullptr;
 	std::vector<Uniform*> uniforms;
 	Color color = White;
@@ -34,6 +35,7 @@ public:
 private:
 	void OnOverwrite() override;
 	void OnDelete() override;
+	void OnDependencyChanged(uint UID) override;
 	void Repath() override;
 };
 
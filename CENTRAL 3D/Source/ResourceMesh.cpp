@@ -3,6 +3,7 @@
 #include "ModuleGui.h"
 #include "ModuleFileSystem.h"
 #include "ModuleResourceManager.h"
+#include "ModuleRenderer3D.h"
 
 #include "ImporterMesh.h"
 
@@ -21,7 +22,8 @@ ResourceMesh::ResourceMesh(uint UID, std::string source_file) : Resource(Resourc
 
 ResourceMesh::~ResourceMesh()
 {
-	glDeleteTextures(1, (GLuint*)&previewTexID);
+	ReleasePreviewTexture();
+	App->fs->UnmapFile(mapped);
 }
 
 void ResourceMesh::CreateAABB()
@@ -34,112 +36,86 @@ void ResourceMesh::CreateAABB()
 	}
 }
 
+void ResourceMesh::CreateBoundingSphere()
+{
+	// --- Around the box's center, not minimal but cheap and stable ---
+	sphere = Sphere(aabb.IsFinite() ? aabb.CenterPoint() : float3::zero, 0.0f);
+
+	for (uint i = 0; i < VerticesSize; ++i)
+	{
+		float distance = sphere.pos.Distance(float3(vertices[i].position));
+		sphere.r = distance > sphere.r ? distance : sphere.r;
+	}
+}
+
+void ResourceMesh::AttachMapping(MappedFile& mapping)
+{
+	App->fs->UnmapFile(mapped);
+	mapped = mapping;
+	mapping = MappedFile();
+}
+
+void ResourceMesh::DetachMapping()
+{
+	if (!IsMapped())
+		return;
+
+	Vertex* owned_vertices = new Vertex[VerticesSize];
+	uint* owned_indices = new uint[IndicesSize];
+	memcpy(owned_vertices, vertices, sizeof(Vertex) * VerticesSize);
+	memcpy(owned_indices, Indices, sizeof(uint) * IndicesSize);
+
+	App->fs->UnmapFile(mapped);
+
+	vertices = owned_vertices;
+	Indices = owned_indices;
+}
+
+bool ResourceMesh::IsMapped() const
+{
+	return mapped.data != nullptr;
+}
+
 bool ResourceMesh::LoadInMemory()
 {
 	bool ret = true;
 
+	// --- Primitives are filled in place and have no file, library meshes come with their bounds ---
 	if (App->fs->Exists(resource_file.c_str()))
+		App->resources->GetImporter<ImporterMesh>()->LoadData(this);
+	else
 	{
-		// --- Load mesh data ---
-		char* buffer = nullptr;
-		App->fs->Load(resource_file.c_str(), &buffer);
-		char* cursor = buffer;
-
-		// amount of indices / vertices / normals / texture_coords
-		uint ranges[3];
-		uint bytes = sizeof(ranges);
-		memcpy(ranges, cursor, bytes);
-		bytes += ranges[0];
-
-		IndicesSize = ranges[1];
-		VerticesSize = ranges[2];
-
-		vertices = new Vertex[VerticesSize];
-		float* Vertices = new float[VerticesSize * 3];
-		float* Normals = new float[VerticesSize * 3];
-		unsigned char* Colors = new unsigned char[VerticesSize * 4];
-		float* TexCoords = new float[VerticesSize * 2];
-
-
-		// --- Load indices ---
-		cursor += bytes;
-		bytes = sizeof(uint) * IndicesSize;
-		Indices = new uint[IndicesSize];
-		memcpy(Indices, cursor, bytes);
-
-		// --- Load Vertices ---
-		cursor += bytes;
-		bytes = sizeof(float) * 3 * VerticesSize;
-		memcpy(Vertices, cursor, bytes);
-
-		// --- Load Normals ---
-		cursor += bytes;
-		bytes = sizeof(float) * 3 * VerticesSize;
-		memcpy(Normals, cursor, bytes);
-
-		// --- Load Colors ---
-		cursor += bytes;
-		bytes = sizeof(unsigned char) * 4 * VerticesSize;
-		memcpy(Colors, cursor, bytes);
-
-		// --- Load Texture Coords ---
-		cursor += bytes;
-		bytes = sizeof(float) * 2 * VerticesSize;
-		memcpy(TexCoords, cursor, bytes);
-
-		// --- Fill Vertex array ---
-
-		for (uint i = 0; i < VerticesSize; ++i)
-		{
-			// --- Vertices ---
-			vertices[i].position[0] = Vertices[i * 3];
-			vertices[i].position[1] = Vertices[(i * 3) + 1];
-			vertices[i].position[2] = Vertices[(i * 3) + 2];
-
-			// --- Normals ---
-			vertices[i].normal[0] = Normals[i * 3];
-			vertices[i].normal[1] = Normals[(i * 3) + 1];
-			vertices[i].normal[2] = Normals[(i * 3) + 2];
-
-			// --- Colors ---
-			vertices[i].color[0] = Colors[i * 4];
-			vertices[i].color[1] = Colors[(i * 4) + 1];
-			vertices[i].color[2] = Colors[(i * 4) + 2];
-			vertices[i].color[3] = Colors[(i * 4) + 3];
-
-			// --- Texture Coordinates ---
-			vertices[i].texCoord[0] = TexCoords[i * 2];
-			vertices[i].texCoord[1] = TexCoords[(i * 2) + 1];
-		}
-
-		// --- Delete buffer data ---
-		if (buffer)
-		{
-			delete[] buffer;
-			buffer = nullptr;
-			cursor = nullptr;
-		}
-
-		delete[] Vertices;
-		delete[] Normals;
-		delete[] Colors;
-		delete[] TexCoords;
+		CreateAABB();
+		CreateBoundingSphere();
 	}
 
-	CreateAABB();
-	CreateVBO();
-	CreateEBO();
-	CreateVAO();
+	// --- Headless tools have no GL context, meshes stay on the CPU ---
+	if (App->renderer3D->HasContext())
+	{
+		CreateVBO();
+		CreateEBO();
+		CreateVAO();
+	}
 
 	return ret;
 }
 
 void ResourceMesh::FreeMemory()
 {
-	glDeleteBuffers(1, (GLuint*)&VBO);
+	// --- Buffers are shared with the render thread, let the renderer delete them once no frame uses them ---
+	App->renderer3D->ReleaseBuffer(VBO);
+	App->renderer3D->ReleaseBuffer(EBO);
 
-	glDeleteBuffers(1, (GLuint*)&EBO);
-	glDeleteVertexArrays(1, (GLuint*)&VAO);
+	if (VAO)
+		glDeleteVertexArrays(1, (GLuint*)&VAO);
+
+	// --- Mapped ones are owned by the mapping ---
+	if (IsMapped())
+	{
+		App->fs->UnmapFile(mapped);
+		vertices = nullptr;
+		Indices = nullptr;
+	}
 
 	if (vertices)
 	{
@@ -190,6 +166,13 @@ void ResourceMesh::CreateEBO()
 
 void ResourceMesh::CreateVAO()
 {
+	VAO = CreateVertexArray(VBO);
+}
+
+uint ResourceMesh::CreateVertexArray(uint VBO)
+{
+	uint VAO = 0;
+
     // --- Create a Vertex Array Object ---
 	glGenVertexArrays(1, &VAO);
 	// --- Bind it ---
@@ -219,6 +202,8 @@ void ResourceMesh::CreateVAO()
 	// --- Unbind VAO and VBO ---
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return VAO;
 }
 
 void ResourceMesh::OnOverwrite()
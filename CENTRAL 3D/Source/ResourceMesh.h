@@ -3,10 +3,14 @@
 
 #include "Resource.h"
 #include "Globals.h"
+#include "ModuleFileSystem.h"
 #include "MathGeoLib/include/Geometry/AABB.h"
+#include "MathGeoLib/include/Geometry/Sphere.h"
 
 struct Vertex
 {
+	MEMORY_TAG(MemoryTag::Resources)
+
 	float position[3];
 	float normal[3];
 	unsigned char color[4];
@@ -21,11 +25,20 @@ public:
 	~ResourceMesh();
 
 	void CreateAABB();
+	void CreateBoundingSphere();
+
+	// --- Vertices and indices may point into the mapped library file, read only ---
+	void AttachMapping(MappedFile& mapping);
+	void DetachMapping(); // Takes a copy of both and unmaps, before anything writes the file
+	bool IsMapped() const;
 
 	bool LoadInMemory() override;
 	void FreeMemory() override;
 	void CreateInspectorNode() override;
 
+	// --- VAOs are per context, the render thread builds its own from the shared VBO ---
+	static uint CreateVertexArray(uint VBO);
+
 	std::string previewTexPath;
 private:
 	void CreateVBO(); 
@@ -34,11 +47,13 @@ private:
 
 public:
 	AABB aabb;
+	Sphere sphere;
 
 	Vertex* vertices = nullptr;
 	uint VerticesSize = 0;
 	uint* Indices = nullptr;
 	uint IndicesSize = 0;
+	bool compressed = false; // Library file written with MeshCodec, smaller but decoded into memory of its own
 
 	// --- New shader approach ---
 
@@ -48,6 +63,8 @@ public:
 	uint VAO = 0;	// Vertex Array Object
 
 private:
+	MappedFile mapped;
+
 	void OnOverwrite() override;
 	void OnDelete() override;
 	void Repath() override;
@@ -59,6 +59,7 @@ void ResourceMeta::OnDelete()
 
 	FreeMemory();
 	App->fs->Remove(resource_file.c_str());
+	App->resources->GetAssetDatabase().Remove(resource_file.substr(0, resource_file.find_last_of(".")).c_str());
 
 	App->resources->RemoveResourceFromFolder(this);
 	App->resources->ONResourceDestroyed(this);
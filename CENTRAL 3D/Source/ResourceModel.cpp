@@ -7,6 +7,11 @@
 #include "Importer.h"
 #include "ImporterModel.h"
 #include "ImporterMaterial.h"
+#include "ImporterMesh.h"
+#include "ImporterMeta.h"
+#include "ResourceMesh.h"
+#include "ResourceMeta.h"
+#include "Imgui/imgui.h"
 #include "OpenGL.h"
 
 #include "mmgr/mmgr.h"
@@ -24,7 +29,7 @@ ResourceModel::~ResourceModel()
 {
 	resources.clear();
 
-	glDeleteTextures(1, (GLuint*)&previewTexID);
+	ReleasePreviewTexture();
 }
 
 bool ResourceModel::LoadInMemory()
@@ -49,6 +54,42 @@ void ResourceModel::FreeMemory()
 
 void ResourceModel::CreateInspectorNode()
 {
+	bool compress = GetCompressMeshes();
+
+	if (ImGui::Checkbox("Compress meshes", &compress))
+		SetCompressMeshes(compress);
+}
+
+bool ResourceModel::GetCompressMeshes() const
+{
+	ResourceMeta* meta = (ResourceMeta*)App->resources->FindResource(GetUID(), Resource::ResourceType::META);
+
+	// --- Missing in metas written before the setting existed, looked up without adding it ---
+	if (meta == nullptr || !meta->ResourceData.is_object())
+		return false;
+
+	json::const_iterator it = meta->ResourceData.find("CompressMeshes");
+
+	return it != meta->ResourceData.end() && it->is_boolean() && it->get<bool>();
+}
+
+void ResourceModel::SetCompressMeshes(bool compress)
+{
+	ResourceMeta* meta = (ResourceMeta*)App->resources->FindResource(GetUID(), Resource::ResourceType::META);
+
+	if (meta == nullptr)
+		return;
+
+	meta->ResourceData["CompressMeshes"] = compress;
+	App->resources->GetImporter<ImporterMeta>()->Save(meta);
+
+	ImporterMesh* IMesh = App->resources->GetImporter<ImporterMesh>();
+
+	for (uint i = 0; i < resources.size(); ++i)
+	{
+		if (resources[i]->GetType() == Resource::ResourceType::MESH)
+			IMesh->SetCompression((ResourceMesh*)resources[i], compress);
+	}
 }
 
 void ResourceModel::AddResource(Resource* resource)
@@ -20,6 +20,10 @@ public:
 	void RemoveResource(Resource* resource);
 	std::vector<Resource*>* GetResources();
 
+	// --- Kept in the model's meta, meshes are rewritten right away when it changes ---
+	bool GetCompressMeshes() const;
+	void SetCompressMeshes(bool compress);
+
 	bool openInProject = false;
 	std::string previewTexPath;
 private:
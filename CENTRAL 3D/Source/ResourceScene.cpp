@@ -72,7 +72,11 @@ bool ResourceScene::LoadInMemory()
 					go->is_prefab_instance = file[it.key()]["PrefabInstance"];
 
 				if (!file[it.key()]["Model"].is_null())
-					go->model = (ResourceModel*)App->resources->ImportAssets(Importer::ImportData(file[it.key()]["Model"].get<std::string>().c_str()));
+				{
+					std::string model_path = file[it.key()]["Model"].get<std::string>();
+					Importer::ImportData IData(model_path.c_str());
+					go->model = (ResourceModel*)App->resources->ImportAssets(IData);
+				}
 
 				// --- Iterate components ---
 				json components = file[it.key()]["Components"];
@@ -12,6 +12,7 @@
 #include "ModuleResourceManager.h"
 #include "ModuleRenderer3D.h"
 #include "JSONLoader.h"
+#include "Logger.h"
 
 #include "OpenGL.h"
 
@@ -64,7 +65,8 @@ bool ResourceShader::LoadInMemory()
 				glGetProgramInfoLog(ID, 512, NULL, infoLog);
 				CONSOLE_LOG("|[error]:SHADER::PROGRAM::LINKING_FAILED: %s", infoLog);
 
-				glDeleteProgram(ID);
+				App->renderer3D->ReleaseProgram(ID);
+				ID = 0;
 			}
 			else
 			{
@@ -91,7 +93,7 @@ bool ResourceShader::LoadInMemory()
 					CONSOLE_LOG("|[error]: Could not load binary shader, triggered recompilation %s", infoLog);
 
 					// --- Trigger recompilation ---
-					glDeleteProgram(ID);
+					App->renderer3D->ReleaseProgram(ID);
 					CreateShaderProgram();
 					ReloadAndCompileShader();
 				}
@@ -199,7 +201,7 @@ void ResourceShader::ReloadAndCompileShader()
 		accumulated_errors++;
 	}
 	else
-		CONSOLE_LOG("Vertex Shader compiled successfully");
+		LOG_DEBUG(LogCategory::Resources, "Vertex Shader compiled successfully");
 
 	// --- Compile new fragment shader ---
 
@@ -212,7 +214,7 @@ void ResourceShader::ReloadAndCompileShader()
 		accumulated_errors++;
 	}
 	else
-		CONSOLE_LOG("Fragment Shader compiled successfully");
+		LOG_DEBUG(LogCategory::Resources, "Fragment Shader compiled successfully");
 
 	if (accumulated_errors == 0)
 	{
@@ -257,7 +259,7 @@ void ResourceShader::ReloadAndCompileShader()
 			vertex = new_vertex;
 			fragment = new_fragment;
 
-			CONSOLE_LOG("Shader Program linked successfully");
+			LOG_DEBUG(LogCategory::Resources, "Shader Program linked successfully");
 		}
 	}
 	else
@@ -440,9 +442,10 @@ bool ResourceShader::CreateShaderProgram()
 
 void ResourceShader::DeleteShaderProgram()
 {
+	// --- Frames in flight may still draw with it ---
 	if (glIsProgram(ID))
 	{
-		glDeleteProgram(ID);
+		App->renderer3D->ReleaseProgram(ID);
 		ID = 0;
 	}
 }
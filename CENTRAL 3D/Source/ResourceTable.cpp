@@ -0,0 +1,198 @@
+#include "ResourceTable.h"
+
+#include "mmgr/mmgr.h"
+
+// --- Entry slot values with special meaning ---
+#define ENTRY_EMPTY 0xFFFFFFFF
+#define ENTRY_TOMBSTONE 0xFFFFFFFE
+
+ResourceTable::ResourceTable()
+{
+	Rehash(RESOURCE_TABLE_MIN_CAPACITY);
+}
+
+ResourceTable::~ResourceTable()
+{
+}
+
+void ResourceTable::Insert(Resource* resource)
+{
+	if (!resource)
+		return;
+
+	// --- Keep empty + tombstones above half the table so probes stay short ---
+	if ((count + tombstones + 1) * 2 > entries.size())
+		Rehash(count * 4 > entries.size() ? entries.size() * 2 : entries.size());
+
+	int existing = FindEntry(resource->GetUID());
+
+	if (existing >= 0)
+	{
+		Entry& entry = entries[existing];
+
+		if (slots[entry.slot].resource == resource)
+			return;
+
+		// --- Overwritten by a new resource with the same UID, old handles must not reach the new one ---
+		ReleaseSlot(entry.slot);
+		entry.slot = AllocateSlot(resource);
+		entry.type = resource->GetType();
+		return;
+	}
+
+	uint mask = entries.size() - 1;
+
+	for (uint i = Hash(resource->GetUID()) & mask;; i = (i + 1) & mask)
+	{
+		Entry& entry = entries[i];
+
+		if (entry.slot == ENTRY_EMPTY || entry.slot == ENTRY_TOMBSTONE)
+		{
+			if (entry.slot == ENTRY_TOMBSTONE)
+				tombstones--;
+
+			entry.UID = resource->GetUID();
+			entry.type = resource->GetType();
+			entry.slot = AllocateSlot(resource);
+			count++;
+			break;
+		}
+	}
+}
+
+void ResourceTable::Remove(Resource* resource)
+{
+	if (!resource)
+		return;
+
+	int index = FindEntry(resource->GetUID());
+
+	// --- Only if it is the registered one, an overwritten resource may be destroyed after its replacement got in ---
+	if (index < 0 || slots[entries[index].slot].resource != resource)
+		return;
+
+	ReleaseSlot(entries[index].slot);
+	entries[index].slot = ENTRY_TOMBSTONE;
+	count--;
+	tombstones++;
+}
+
+void ResourceTable::Clear()
+{
+	for (uint i = 0; i < slots.size(); ++i)
+	{
+		if (slots[i].resource)
+			ReleaseSlot(i);
+	}
+
+	entries.clear();
+	count = 0;
+	Rehash(RESOURCE_TABLE_MIN_CAPACITY);
+}
+
+Resource* ResourceTable::Find(uint UID) const
+{
+	int index = FindEntry(UID);
+	return index >= 0 ? slots[entries[index].slot].resource : nullptr;
+}
+
+Resource* ResourceTable::Find(uint UID, Resource::ResourceType type) const
+{
+	int index = FindEntry(UID);
+	return index >= 0 && entries[index].type == type ? slots[entries[index].slot].resource : nullptr;
+}
+
+uint ResourceTable::Size() const
+{
+	return count;
+}
+
+int ResourceTable::FindEntry(uint UID) const
+{
+	uint mask = entries.size() - 1;
+
+	for (uint i = Hash(UID) & mask;; i = (i + 1) & mask)
+	{
+		const Entry& entry = entries[i];
+
+		if (entry.slot == ENTRY_EMPTY)
+			return -1;
+
+		if (entry.slot != ENTRY_TOMBSTONE && entry.UID == UID)
+			return (int)i;
+	}
+}
+
+uint ResourceTable::Hash(uint UID) const
+{
+	// --- Fibonacci hashing, high bits folded down since the mask keeps the low ones ---
+	uint hash = UID * 2654435769u;
+	return hash ^ (hash >> 16);
+}
+
+void ResourceTable::Rehash(uint capacity)
+{
+	if (capacity < RESOURCE_TABLE_MIN_CAPACITY)
+		capacity = RESOURCE_TABLE_MIN_CAPACITY;
+
+	std::vector<Entry> old_entries;
+	old_entries.swap(entries);
+
+	Entry empty;
+	empty.slot = ENTRY_EMPTY;
+	entries.assign(capacity, empty);
+	tombstones = 0;
+
+	uint mask = capacity - 1;
+
+	for (uint i = 0; i < old_entries.size(); ++i)
+	{
+		if (old_entries[i].slot == ENTRY_EMPTY || old_entries[i].slot == ENTRY_TOMBSTONE)
+			continue;
+
+		uint j = Hash(old_entries[i].UID) & mask;
+
+		while (entries[j].slot != ENTRY_EMPTY)
+			j = (j + 1) & mask;
+
+		entries[j] = old_entries[i];
+	}
+}
+
+uint ResourceTable::AllocateSlot(Resource* resource)
+{
+	uint slot = 0;
+
+	if (!free_slots.empty())
+	{
+		slot = free_slots.back();
+		free_slots.pop_back();
+	}
+	else
+	{
+		slot = slots.size();
+		slots.push_back(Slot());
+	}
+
+	slots[slot].resource = resource;
+	resource->handle_index = slot;
+	resource->handle_generation = slots[slot].generation;
+
+	return slot;
+}
+
+void ResourceTable::ReleaseSlot(uint slot)
+{
+	Resource* resource = slots[slot].resource;
+
+	if (resource && resource->handle_index == slot)
+		resource->handle_generation = 0;
+
+	slots[slot].resource = nullptr;
+
+	// --- Skip 0 on wrap, it means null handle ---
+	if (++slots[slot].generation == 0)
+		slots[slot].generation = 1;
+
+	free_slots.push_back(slot);
+}
@@ -0,0 +1,65 @@
+#ifndef __RESOURCE_TABLE_H__
+#define __RESOURCE_TABLE_H__
+
+#include "Resource.h"
+#include <vector>
+
+#define RESOURCE_TABLE_MIN_CAPACITY 256 // Must be a power of two
+
+// --- Open addressing (linear probing) table keyed by UID, entries point to slots that keep a generation count ---
+// --- Handles store slot + generation, once a resource leaves the table its slot generation changes and old handles resolve to nullptr ---
+class ResourceTable
+{
+public:
+
+	ResourceTable();
+	~ResourceTable();
+
+	// --- Registering a UID that is already in replaces the old resource, its handles go stale ---
+	void Insert(Resource* resource);
+	void Remove(Resource* resource);
+	void Clear();
+
+	// --- Lookups ---
+	Resource* Find(uint UID) const;
+	Resource* Find(uint UID, Resource::ResourceType type) const;
+	uint Size() const;
+
+	// --- One index and a generation check ---
+	inline Resource* Resolve(uint index, uint generation) const
+	{
+		return index < slots.size() && slots[index].generation == generation ? slots[index].resource : nullptr;
+	}
+
+private:
+
+	struct Entry
+	{
+		uint UID = 0;
+		uint slot = 0;
+		Resource::ResourceType type = Resource::ResourceType::UNKNOWN;
+	};
+
+	struct Slot
+	{
+		Resource* resource = nullptr;
+		uint generation = 1; // 0 is reserved for null handles
+	};
+
+	int FindEntry(uint UID) const;
+	uint Hash(uint UID) const;
+	void Rehash(uint capacity);
+	uint AllocateSlot(Resource* resource);
+	void ReleaseSlot(uint slot);
+
+private:
+
+	std::vector<Entry> entries;
+	std::vector<Slot> slots;
+	std::vector<uint> free_slots;
+
+	uint count = 0;
+	uint tombstones = 0;
+};
+
+#endif
@@ -5,12 +5,17 @@
 #include "OpenGL.h"
 #include "ModuleResourceManager.h"
 #include "ModuleFileSystem.h"
+#include "ModuleRenderer3D.h"
+#include "ImporterMeta.h"
+#include "ResourceMeta.h"
+
+#include "Imgui/imgui.h"
 
 #include "mmgr/mmgr.h"
 
 ResourceTexture::ResourceTexture(uint UID, std::string source_file) : Resource(Resource::ResourceType::TEXTURE, UID, source_file)
 {
-	extension = ".dds";
+	extension = ".ktx2";
 	resource_file = TEXTURES_FOLDER + std::to_string(UID) + extension;
 	buffer_id = App->textures->GetDefaultTextureID();
 	previewTexID = App->gui->defaultfileTexID;
@@ -21,26 +26,129 @@ ResourceTexture::ResourceTexture(uint UID, std::string source_file) : Resource(R
 
 ResourceTexture::~ResourceTexture()
 {
-	glDeleteTextures(1, (GLuint*)&buffer_id);
+	FreeMemory();
 }
 
 bool ResourceTexture::LoadInMemory()
 {
+	// --- Library textures with mips start at their smallest levels, the streamer loads the rest as they are drawn ---
 	if (App->resources->IsFileImported(original_file.c_str()) && App->fs->Exists(resource_file.c_str()))
-		SetTextureID(App->textures->CreateTextureFromFile(resource_file.c_str(), Texture_width, Texture_height, -1));
+	{
+		uint texID = App->textures->streamer.Register(this, resource_file.c_str(), Texture_width, Texture_height);
+		SetTextureID(texID ? texID : App->textures->CreateTextureFromFile(resource_file.c_str(), Texture_width, Texture_height, -1));
+	}
 	else if (original_file != "DefaultTexture")
-		SetTextureID(App->textures->CreateTextureFromFile(original_file.c_str(), Texture_width, Texture_height, GetUID()));
+		SetTextureID(App->textures->CreateTextureFromFile(original_file.c_str(), Texture_width, Texture_height, GetUID(), GetCompression()));
+	else
+		buffer_id = App->textures->GetDefaultTextureID();
 
 	return true;
 }
 
 void ResourceTexture::FreeMemory()
 {
-	glDeleteTextures(1, (GLuint*)&buffer_id);
+	App->textures->streamer.Unregister(this);
+
+	// --- Shared with the render thread, the renderer deletes it once no frame uses it. The default texture is everyone's ---
+	if (buffer_id != App->textures->GetDefaultTextureID())
+		App->renderer3D->ReleaseTexture(buffer_id);
+
+	// --- Released names may be handed out again before the renderer deletes them, none is kept ---
+	buffer_id = 0;
+	previewTexID = App->gui->defaultfileTexID;
 }
 
 void ResourceTexture::CreateInspectorNode()
 {
+	TextureCompression compression = GetCompression();
+	int usage = (int)compression.usage;
+	int quality = (int)compression.quality;
+	int filter = (int)compression.filter;
+	bool changed = false;
+
+	changed |= ImGui::Combo("Usage", &usage, "Albedo\0Normal\0Mask\0");
+	changed |= ImGui::Combo("Quality", &quality, "Fast\0Normal\0High\0");
+	changed |= ImGui::Checkbox("Mipmaps", &compression.mips);
+
+	if (compression.mips)
+	{
+		changed |= ImGui::Combo("Mip filter", &filter, "Box\0Kaiser\0Lanczos\0");
+		changed |= ImGui::Checkbox("Alpha coverage", &compression.alpha_coverage);
+
+		// --- Applied on enter, each change recompresses the texture ---
+		if (compression.alpha_coverage && ImGui::InputFloat("Alpha cutoff", &compression.alpha_cutoff, 0.05f, 0.1f, "%.2f", ImGuiInputTextFlags_EnterReturnsTrue))
+		{
+			compression.alpha_cutoff = compression.alpha_cutoff < 0.0f ? 0.0f : (compression.alpha_cutoff > 1.0f ? 1.0f : compression.alpha_cutoff);
+			changed = true;
+		}
+	}
+
+	if (changed)
+	{
+		compression.usage = (TextureUsage)usage;
+		compression.quality = (CompressionQuality)quality;
+		compression.filter = (MipFilter)filter;
+		SetCompression(compression);
+	}
+}
+
+TextureCompression ResourceTexture::GetCompression() const
+{
+	TextureCompression compression;
+	ResourceMeta* meta = (ResourceMeta*)App->resources->FindResource(GetUID(), Resource::ResourceType::META);
+
+	// --- Missing in metas written before the settings existed, looked up without adding them ---
+	if (meta == nullptr || !meta->ResourceData.is_object())
+		return compression;
+
+	json::const_iterator usage = meta->ResourceData.find("Usage");
+	json::const_iterator quality = meta->ResourceData.find("Quality");
+	json::const_iterator mips = meta->ResourceData.find("Mipmaps");
+	json::const_iterator filter = meta->ResourceData.find("MipFilter");
+	json::const_iterator coverage = meta->ResourceData.find("AlphaCoverage");
+	json::const_iterator cutoff = meta->ResourceData.find("AlphaCutoff");
+
+	if (usage != meta->ResourceData.end() && usage->is_number_integer() && usage->get<int>() >= 0 && usage->get<int>() <= (int)TextureUsage::Mask)
+		compression.usage = (TextureUsage)usage->get<int>();
+
+	if (quality != meta->ResourceData.end() && quality->is_number_integer() && quality->get<int>() >= 0 && quality->get<int>() <= (int)CompressionQuality::High)
+		compression.quality = (CompressionQuality)quality->get<int>();
+
+	if (mips != meta->ResourceData.end() && mips->is_boolean())
+		compression.mips = mips->get<bool>();
+
+	if (filter != meta->ResourceData.end() && filter->is_number_integer() && filter->get<int>() >= 0 && filter->get<int>() <= (int)MipFilter::Lanczos)
+		compression.filter = (MipFilter)filter->get<int>();
+
+	if (coverage != meta->ResourceData.end() && coverage->is_boolean())
+		compression.alpha_coverage = coverage->get<bool>();
+
+	if (cutoff != meta->ResourceData.end() && cutoff->is_number())
+		compression.alpha_cutoff = cutoff->get<float>();
+
+	return compression;
+}
+
+void ResourceTexture::SetCompression(const TextureCompression& compression)
+{
+	ResourceMeta* meta = (ResourceMeta*)App->resources->FindResource(GetUID(), Resource::ResourceType::META);
+
+	if (meta == nullptr)
+		return;
+
+	meta->ResourceData["Usage"] = (int)compression.usage;
+	meta->ResourceData["Quality"] = (int)compression.quality;
+	meta->ResourceData["Mipmaps"] = compression.mips;
+	meta->ResourceData["MipFilter"] = (int)compression.filter;
+	meta->ResourceData["AlphaCoverage"] = compression.alpha_coverage;
+	meta->ResourceData["AlphaCutoff"] = compression.alpha_cutoff;
+	App->resources->GetImporter<ImporterMeta>()->Save(meta);
+
+	// --- Recompress from the original ---
+	FreeMemory();
+	App->fs->Remove(resource_file.c_str());
+
+	SetTextureID(App->textures->CreateTextureFromFile(original_file.c_str(), Texture_width, Texture_height, GetUID(), compression));
 }
 
 void ResourceTexture::SetTextureID(uint ID)
@@ -60,7 +168,7 @@ void ResourceTexture::OnOverwrite()
 	FreeMemory();
 	App->fs->Remove(resource_file.c_str());
 
-	SetTextureID(App->textures->CreateTextureFromFile(original_file.c_str(), Texture_width, Texture_height, GetUID()));
+	SetTextureID(App->textures->CreateTextureFromFile(original_file.c_str(), Texture_width, Texture_height, GetUID(), GetCompression()));
 }
 
 void ResourceTexture::OnDelete()
@@ -2,6 +2,7 @@
 #define __RESOURCE_TEXTURE_H__
 
 #include "Resource.h"
+#include "TextureCompressor.h"
 
 class ResourceTexture : public Resource
 {
@@ -16,6 +17,10 @@ public:
 	void SetTextureID(uint ID);
 	uint GetTexID();
 
+	// --- Kept in the meta, changing them recompresses the library texture ---
+	TextureCompression GetCompression() const;
+	void SetCompression(const TextureCompression& compression);
+
 public:
 	std::string Texture_path;
 	uint Texture_width = 0;
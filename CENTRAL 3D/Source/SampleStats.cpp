@@ -0,0 +1,41 @@
+#include "SampleStats.h"
+#include <algorithm>
+#include <math.h>
+
+#include "mmgr/mmgr.h"
+
+SampleStats ComputeSampleStats(const std::vector<double>& samples)
+{
+	SampleStats stats;
+	stats.count = samples.size();
+
+	if (samples.empty())
+		return stats;
+
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	unsigned int count = sorted.size();
+	stats.min = sorted[0];
+	stats.max = sorted[count - 1];
+	stats.median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5;
+
+	unsigned int rank = (unsigned int)ceil(0.95 * count);
+	stats.p95 = sorted[rank > 0 ? rank - 1 : 0];
+
+	double sum = 0.0;
+
+	for (unsigned int i = 0; i < count; ++i)
+		sum += sorted[i];
+
+	stats.mean = sum / count;
+
+	double squares = 0.0;
+
+	for (unsigned int i = 0; i < count; ++i)
+		squares += (sorted[i] - stats.mean) * (sorted[i] - stats.mean);
+
+	stats.variance = count > 1 ? squares / (count - 1) : 0.0;
+
+	return stats;
+}
@@ -0,0 +1,20 @@
+#ifndef __SAMPLE_STATS_H__
+#define __SAMPLE_STATS_H__
+
+#include <vector>
+
+// --- Summary of a set of timings, shared by the benchmark and the scenario runner so both report the same numbers ---
+struct SampleStats
+{
+	unsigned int count = 0;
+	double median = 0.0;
+	double p95 = 0.0; // Nearest rank, with few samples this is the slowest one
+	double mean = 0.0;
+	double variance = 0.0; // Sample variance, n - 1
+	double min = 0.0;
+	double max = 0.0;
+};
+
+SampleStats ComputeSampleStats(const std::vector<double>& samples);
+
+#endif
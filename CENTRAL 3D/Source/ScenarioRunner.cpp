@@ -0,0 +1,489 @@
+#include "ScenarioRunner.h"
+#include "Application.h"
+#include "ModuleInput.h"
+#include "ModuleCamera3D.h"
+#include "ModuleTimeManager.h"
+#include "ModuleSceneManager.h"
+#include "ModuleResourceManager.h"
+#include "ComponentCamera.h"
+#include "ResourceScene.h"
+#include "Profiler.h"
+#include "SampleStats.h"
+#include "FrameAllocator.h"
+
+#include "SDL/include/SDL_scancode.h"
+#include "SDL/include/SDL_keyboard.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "mmgr/mmgr.h"
+
+// ----------------------------------------------------------------------------------------------------------
+// --- Statistics ---
+
+// --- One sided Mann-Whitney U, probability of seeing current this much slower if nothing changed ---
+// --- Frame times are skewed and spiky, ranks do not care about either ---
+static double RankTestSlower(const std::vector<double>& base, const std::vector<double>& current)
+{
+	uint n1 = base.size();
+	uint n2 = current.size();
+
+	if (n1 == 0 || n2 == 0)
+		return 1.0;
+
+	std::vector<std::pair<double, uint>> all; // Value, 0 base 1 current
+	all.reserve(n1 + n2);
+
+	for (uint i = 0; i < n1; ++i)
+		all.push_back(std::pair<double, uint>(base[i], 0));
+
+	for (uint i = 0; i < n2; ++i)
+		all.push_back(std::pair<double, uint>(current[i], 1));
+
+	std::sort(all.begin(), all.end());
+
+	// --- Ties share their average rank ---
+	double rank_sum = 0.0;
+	double tie_term = 0.0;
+	uint i = 0;
+
+	while (i < all.size())
+	{
+		uint j = i;
+
+		while (j + 1 < all.size() && all[j + 1].first == all[i].first)
+			++j;
+
+		double rank = (i + j) * 0.5 + 1.0;
+		double ties = j - i + 1;
+		tie_term += ties * ties * ties - ties;
+
+		for (uint k = i; k <= j; ++k)
+		{
+			if (all[k].second == 1)
+				rank_sum += rank;
+		}
+
+		i = j + 1;
+	}
+
+	double n = n1 + n2;
+	double u = rank_sum - n2 * (n2 + 1) * 0.5;
+	double mean = n1 * (double)n2 * 0.5;
+	double sigma = sqrt(n1 * (double)n2 / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0))));
+
+	if (sigma <= 0.0)
+		return 1.0;
+
+	double z = (u - mean - 0.5) / sigma;
+
+	return 0.5 * erfc(z / sqrt(2.0));
+}
+
+static json StatsToJson(const std::vector<double>& samples)
+{
+	SampleStats stats = ComputeSampleStats(samples);
+
+	json node;
+	node["Median"] = stats.median;
+	node["P95"] = stats.p95;
+	node["Mean"] = stats.mean;
+	node["Variance"] = stats.variance;
+	node["Samples"] = samples;
+
+	return node;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// --- ScenarioRunner ---
+
+ScenarioRunner::ScenarioRunner()
+{
+}
+
+ScenarioRunner::~ScenarioRunner()
+{
+}
+
+bool ScenarioRunner::Load(const char* path)
+{
+	// --- A bare name refers to Settings/Scenarios/<name>.json ---
+	std::string file_path = path;
+
+	if (file_path.find('/') == std::string::npos && file_path.find('\\') == std::string::npos)
+		file_path = SCENARIOS_FOLDER + file_path;
+
+	if (file_path.find(".json") == std::string::npos)
+		file_path.append(".json");
+
+	json file = App->GetJLoader()->Load(file_path.c_str());
+
+	if (file.is_null() || file["Scene"].is_null() || file["Frames"].is_null())
+	{
+		CONSOLE_LOG("|[error]: Scenario: could not load %s, it needs at least a Scene and Frames", file_path.c_str());
+		return false;
+	}
+
+	name = file["Name"].is_null() ? file_path : file["Name"].get<std::string>();
+	scene = file["Scene"].get<std::string>();
+	frames = file["Frames"].get<uint>();
+
+	if (!file["WarmupFrames"].is_null())
+		warmup_frames = file["WarmupFrames"].get<uint>();
+
+	if (!file["FixedDt"].is_null())
+		fixed_dt = file["FixedDt"].get<float>();
+
+	if (!file["Play"].is_null())
+		play = file["Play"].get<bool>();
+
+	if (!file["MaxHeapCalls"].is_null())
+		max_heap_calls = file["MaxHeapCalls"].get<int>();
+
+	if (!file["Compare"].is_null())
+	{
+		json compare = file["Compare"];
+
+		if (!compare["Threshold"].is_null())
+			thresholds.percent = compare["Threshold"].get<float>();
+
+		if (!compare["Alpha"].is_null())
+			thresholds.alpha = compare["Alpha"].get<float>();
+
+		if (!compare["MinDelta"].is_null())
+			thresholds.min_delta = compare["MinDelta"].get<float>();
+	}
+
+	// --- Camera path ---
+	json camera_keys = file["Camera"];
+
+	for (json::iterator it = camera_keys.begin(); it != camera_keys.end(); ++it)
+	{
+		ScenarioCameraKey key;
+		key.frame = (*it)["Frame"].get<uint>();
+		key.position = float3((*it)["Position"][0].get<float>(), (*it)["Position"][1].get<float>(), (*it)["Position"][2].get<float>());
+		key.look_at = float3((*it)["LookAt"][0].get<float>(), (*it)["LookAt"][1].get<float>(), (*it)["LookAt"][2].get<float>());
+		camera.push_back(key);
+	}
+
+	// --- Input stream ---
+	json input_events = file["Input"];
+
+	for (json::iterator it = input_events.begin(); it != input_events.end(); ++it)
+	{
+		ScenarioInputEvent event;
+		event.frame = (*it)["Frame"].get<uint>();
+
+		if (!(*it)["Down"].is_null())
+			event.down = (*it)["Down"].get<bool>();
+
+		if (!(*it)["Key"].is_null())
+		{
+			std::string key_name = (*it)["Key"].get<std::string>();
+			event.key = SDL_GetScancodeFromName(key_name.c_str());
+
+			if (event.key == SDL_SCANCODE_UNKNOWN)
+				CONSOLE_LOG("![Warning]: Scenario: unknown key %s on frame %u, it will be ignored", key_name.c_str(), event.frame);
+		}
+
+		if (!(*it)["Button"].is_null())
+			event.button = (*it)["Button"].get<int>();
+
+		if (!(*it)["Mouse"].is_null())
+		{
+			event.move = true;
+			event.mouse_x = (*it)["Mouse"][0].get<int>();
+			event.mouse_y = (*it)["Mouse"][1].get<int>();
+		}
+
+		if (!(*it)["Wheel"].is_null())
+			event.wheel = (*it)["Wheel"].get<int>();
+
+		input.push_back(event);
+	}
+
+	std::stable_sort(camera.begin(), camera.end(), [](const ScenarioCameraKey& a, const ScenarioCameraKey& b) { return a.frame < b.frame; });
+	std::stable_sort(input.begin(), input.end(), [](const ScenarioInputEvent& a, const ScenarioInputEvent& b) { return a.frame < b.frame; });
+
+	CONSOLE_LOG("Scenario: loaded %s, %u frames after %u warm up frames", name.c_str(), frames, warmup_frames);
+
+	return true;
+}
+
+bool ScenarioRunner::Start()
+{
+	Importer::ImportData IData(scene.c_str());
+	ResourceScene* resource = (ResourceScene*)App->resources->ImportAssets(IData);
+
+	if (!resource || resource->GetType() != Resource::ResourceType::SCENE)
+	{
+		CONSOLE_LOG("|[error]: Scenario: %s is not a scene", scene.c_str());
+		return false;
+	}
+
+	App->scene_manager->SetActiveScene(resource);
+
+	// --- Same dt every frame, so the scene plays the same way however long frames take ---
+	App->time->SetFixedDt(fixed_dt);
+	App->input->SetPlayback(true);
+
+	if (play)
+		App->GetAppState() = AppState::TO_PLAY;
+
+	// --- Module scopes are what we measure ---
+	Profiler::Get().SetPaused(false);
+	main_thread = Profiler::Get().GetThreadIndex();
+
+	frame_ms.reserve(frames);
+	heap_calls.reserve(frames);
+
+	return true;
+}
+
+void ScenarioRunner::BeginFrame()
+{
+	ApplyCamera();
+	ApplyInput();
+}
+
+void ScenarioRunner::EndFrame()
+{
+	// --- Called once the profiler closed the frame ---
+	if (frame++ < warmup_frames || IsFinished())
+		return;
+
+	Profiler& profiler = Profiler::Get();
+	ProfileFrame profile_frame;
+
+	if (profiler.GetFrameCount() == 0 || !profiler.GetFrame(profiler.GetFrameCount() - 1, profile_frame))
+	{
+		CONSOLE_LOG("![Warning]: Scenario: frame %u has no profiler data", frame - 1);
+		return;
+	}
+
+	frame_ms.push_back((profile_frame.end - profile_frame.start) / 1000000.0);
+
+	// --- Warm frames should find everything they need in the frame arenas and reserved storage ---
+	uint64 calls = FrameMemory::GetHeapCalls();
+	heap_calls.push_back((double)calls);
+
+	if (max_heap_calls >= 0 && calls > (uint64)max_heap_calls)
+	{
+		if (heap_failures++ == 0)
+			CONSOLE_LOG("|[error]: Scenario: frame %u made %llu heap calls, the limit is %d", frame - 1, calls, max_heap_calls);
+	}
+
+	// --- Application::Update scopes each module inside PreUpdate, Update and PostUpdate ---
+	// --- Names are the modules' own, the first frame adds them and the rest only look them up ---
+	uint measured = frame_ms.size();
+
+	for (uint64 i = profile_frame.first_event; i < profile_frame.end_event; ++i)
+	{
+		const ProfileEvent& event = profiler.GetEvent(i);
+
+		if (event.thread != main_thread || event.depth != 1)
+			continue;
+
+		std::map<std::string, std::vector<double>, std::less<>>::iterator it = module_ms.find(event.name);
+
+		if (it == module_ms.end())
+		{
+			it = module_ms.insert(std::pair<std::string, std::vector<double>>(event.name, std::vector<double>())).first;
+			(*it).second.reserve(frames);
+		}
+
+		// --- Every module keeps one sample per measured frame, zero if it did not run ---
+		std::vector<double>& samples = (*it).second;
+
+		if (samples.size() < measured)
+			samples.resize(measured, 0.0);
+
+		samples.back() += (event.end - event.start) / 1000000.0;
+	}
+
+	for (std::map<std::string, std::vector<double>, std::less<>>::iterator it = module_ms.begin(); it != module_ms.end(); ++it)
+		(*it).second.resize(measured, 0.0);
+}
+
+bool ScenarioRunner::IsFinished() const
+{
+	return frame >= warmup_frames + frames;
+}
+
+const char* ScenarioRunner::GetName() const
+{
+	return name.c_str();
+}
+
+bool ScenarioRunner::Save(const char* path) const
+{
+	json file;
+	file["Engine"] = TITLE;
+	file["Version"] = VERSION;
+	file["Scenario"] = name;
+	file["Scene"] = scene;
+	file["Frames"] = frame_ms.size();
+	file["WarmupFrames"] = warmup_frames;
+	file["FixedDt"] = fixed_dt;
+	file["TimeUnit"] = "ms";
+
+	file["Compare"]["Threshold"] = thresholds.percent;
+	file["Compare"]["Alpha"] = thresholds.alpha;
+	file["Compare"]["MinDelta"] = thresholds.min_delta;
+
+	file["Frame"] = StatsToJson(frame_ms);
+	file["HeapCalls"] = StatsToJson(heap_calls);
+
+	if (max_heap_calls >= 0)
+		file["MaxHeapCalls"] = max_heap_calls;
+
+	for (std::map<std::string, std::vector<double>, std::less<>>::const_iterator it = module_ms.begin(); it != module_ms.end(); ++it)
+		file["Modules"][(*it).first] = StatsToJson((*it).second);
+
+	if (!App->GetJLoader()->Save(path, file))
+	{
+		CONSOLE_LOG("|[error]: Scenario: could not save results to %s", path);
+		return false;
+	}
+
+	CONSOLE_LOG("Scenario: %s results saved to %s", name.c_str(), path);
+
+	return true;
+}
+
+bool ScenarioRunner::Passed() const
+{
+	if (heap_failures > 0)
+	{
+		CONSOLE_LOG("|[error]: Scenario: %u of %u measured frames went over %d heap calls", heap_failures, (uint)heap_calls.size(), max_heap_calls);
+		return false;
+	}
+
+	return true;
+}
+
+int ScenarioRunner::Compare(const char* base_path, const char* current_path, float threshold)
+{
+	JSONLoader loader;
+	json base = loader.Load(base_path);
+	json current = loader.Load(current_path);
+
+	if (base.is_null() || current.is_null() || base["Frame"].is_null() || current["Frame"].is_null())
+	{
+		printf("Could not compare %s and %s, both must be scenario results\n", base_path, current_path);
+		return -1;
+	}
+
+	if (base["Scenario"] != current["Scenario"])
+		printf("Warning: comparing different scenarios, %s and %s\n", base["Scenario"].get<std::string>().c_str(), current["Scenario"].get<std::string>().c_str());
+
+	// --- Thresholds recorded with the current run ---
+	ScenarioThresholds limits;
+
+	if (!current["Compare"].is_null())
+	{
+		limits.percent = current["Compare"]["Threshold"].get<float>();
+		limits.alpha = current["Compare"]["Alpha"].get<float>();
+		limits.min_delta = current["Compare"]["MinDelta"].get<float>();
+	}
+
+	if (threshold >= 0.0f)
+		limits.percent = threshold;
+
+	// --- The frame first, then every module both runs have ---
+	std::vector<std::string> names;
+	std::vector<json> base_nodes;
+	std::vector<json> current_nodes;
+
+	names.push_back("Frame");
+	base_nodes.push_back(base["Frame"]);
+	current_nodes.push_back(current["Frame"]);
+
+	json base_modules = base["Modules"];
+
+	for (json::iterator it = base_modules.begin(); it != base_modules.end(); ++it)
+	{
+		if (current["Modules"].find(it.key()) == current["Modules"].end())
+			continue;
+
+		names.push_back(it.key());
+		base_nodes.push_back(it.value());
+		current_nodes.push_back(current["Modules"][it.key()]);
+	}
+
+	printf("Scenario %s, regression past %.1f%% and %.3f ms with p < %.3f\n", current["Scenario"].get<std::string>().c_str(), limits.percent, limits.min_delta, limits.alpha);
+	printf("%-24s %12s %12s %9s %10s\n", "", "base ms", "current ms", "change", "p");
+
+	int regressions = 0;
+
+	for (uint i = 0; i < names.size(); ++i)
+	{
+		std::vector<double> base_samples = base_nodes[i]["Samples"].get<std::vector<double>>();
+		std::vector<double> current_samples = current_nodes[i]["Samples"].get<std::vector<double>>();
+
+		double base_median = ComputeSampleStats(base_samples).median;
+		double current_median = ComputeSampleStats(current_samples).median;
+		double delta = current_median - base_median;
+		double percent = base_median > 0.0 ? delta / base_median * 100.0 : 0.0;
+		double p = RankTestSlower(base_samples, current_samples);
+
+		bool regression = percent > limits.percent && delta > limits.min_delta && p < limits.alpha;
+
+		if (regression)
+			regressions++;
+
+		printf("%-24s %12.4f %12.4f %+8.1f%% %10.4f%s\n", names[i].c_str(), base_median, current_median, percent, p, regression ? "  REGRESSION" : "");
+	}
+
+	printf("%d regression(s)\n", regressions);
+
+	return regressions;
+}
+
+void ScenarioRunner::ApplyCamera() const
+{
+	if (camera.empty() || !App->camera->camera)
+		return;
+
+	// --- Hold the first and last keys outside the path ---
+	uint next = 0;
+
+	while (next < camera.size() && camera[next].frame <= frame)
+		++next;
+
+	const ScenarioCameraKey& a = camera[next > 0 ? next - 1 : 0];
+	const ScenarioCameraKey& b = camera[next < camera.size() ? next : camera.size() - 1];
+
+	float t = b.frame > a.frame ? float(frame - a.frame) / float(b.frame - a.frame) : 0.0f;
+	t = math::Clamp(t, 0.0f, 1.0f);
+
+	float3 look_at = a.look_at.Lerp(b.look_at, t);
+
+	App->camera->camera->frustum.SetPos(a.position.Lerp(b.position, t));
+	App->camera->camera->Look(look_at);
+	App->camera->reference = look_at;
+}
+
+void ScenarioRunner::ApplyInput()
+{
+	// --- Wheel only lasts the frame it was recorded on ---
+	App->input->SetPlaybackWheel(0);
+
+	while (next_input < input.size() && input[next_input].frame <= frame)
+	{
+		const ScenarioInputEvent& event = input[next_input++];
+
+		if (event.key > 0)
+			App->input->SetPlaybackKey(event.key, event.down);
+
+		if (event.button > 0)
+			App->input->SetPlaybackMouseButton(event.button, event.down);
+
+		if (event.move)
+			App->input->SetPlaybackMouse(event.mouse_x, event.mouse_y);
+
+		if (event.wheel != 0)
+			App->input->SetPlaybackWheel(event.wheel);
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef __SCENARIO_RUNNER_H__
+#define __SCENARIO_RUNNER_H__
+
+#include "Globals.h"
+#include "Math.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define SCENARIOS_FOLDER SETTINGS_FOLDER "Scenarios/"
+#define SCENARIO_RESULTS_FILE "scenario_results.json"
+
+// --- Camera placement, frames in between are interpolated ---
+struct ScenarioCameraKey
+{
+	uint frame = 0;
+	float3 position = float3::zero;
+	float3 look_at = float3::zero;
+};
+
+// --- One recorded device change, applied at the start of its frame ---
+struct ScenarioInputEvent
+{
+	uint frame = 0;
+	int key = -1; // SDL scancode
+	int button = -1; // SDL mouse button
+	bool down = false;
+	bool move = false;
+	int mouse_x = 0;
+	int mouse_y = 0;
+	int wheel = 0;
+};
+
+// --- A regression needs to pass all three ---
+struct ScenarioThresholds
+{
+	float percent = 5.0f; // Median slowdown
+	float alpha = 0.01f; // Significance of the rank test
+	float min_delta = 0.05f; // ms, ignores noise on modules that barely cost anything
+};
+
+// --- Plays a scene back for a fixed amount of frames with recorded camera and input, headless ---
+// --- Frame and per module CPU times come from the profiler's scopes on the main thread ---
+class ScenarioRunner
+{
+public:
+
+	ScenarioRunner();
+	~ScenarioRunner();
+
+	// --- Scenario files live in Settings/Scenarios ---
+	bool Load(const char* path);
+
+	// --- Called by the application once every module has started ---
+	bool Start();
+	void BeginFrame();
+	void EndFrame();
+
+	bool IsFinished() const;
+	const char* GetName() const;
+	bool Save(const char* path) const;
+	bool Passed() const; // Whether every measured frame kept to the scenario's limits
+
+	// --- Thresholds are the ones the current run recorded, threshold overrides their percent when given ---
+	// --- Returns the amount of regressions found, -1 if the files could not be compared ---
+	static int Compare(const char* base_path, const char* current_path, float threshold = -1.0f);
+
+private:
+
+	void ApplyCamera() const;
+	void ApplyInput();
+
+private:
+
+	std::string name;
+	std::string scene;
+	bool play = false;
+	uint warmup_frames = 0;
+	uint frames = 0;
+	float fixed_dt = 0.0f;
+	int max_heap_calls = -1; // Per measured frame, -1 does not check
+	ScenarioThresholds thresholds;
+
+	std::vector<ScenarioCameraKey> camera;
+	std::vector<ScenarioInputEvent> input;
+	uint next_input = 0;
+
+	uint frame = 0;
+	uint main_thread = 0;
+
+	// --- Measured frames only, storage is reserved up front so recording a frame does not allocate ---
+	std::vector<double> frame_ms;
+	std::vector<double> heap_calls;
+	std::map<std::string, std::vector<double>, std::less<>> module_ms;
+	uint heap_failures = 0;
+};
+
+#endif
@@ -0,0 +1,831 @@
+#include "TextureCompressor.h"
+#include "TextureMips.h"
+#include "Application.h"
+#include "ModuleJobs.h"
+#include "Kernels.h"
+#include "Allocator.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "mmgr/mmgr.h"
+
+#define BC7_MODE6_WEIGHTS 16 // 4 bit indices
+
+static const int bc7_weights[BC7_MODE6_WEIGHTS] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// --- One 4x4 block, as bytes and as floats laid out per channel for the kernels ---
+struct BlockPixels
+{
+	unsigned char rgba[16][4];
+	float channels[4][16];
+};
+
+static inline int Clamp(int value, int min, int max)
+{
+	return value < min ? min : (value > max ? max : value);
+}
+
+static inline float ClampF(float value, float min, float max)
+{
+	return value < min ? min : (value > max ? max : value);
+}
+
+// --- Edge blocks repeat the last column and row ---
+static void LoadBlock(const unsigned char* pixels, uint width, uint height, uint bx, uint by, BlockPixels& block)
+{
+	for (uint y = 0; y < 4; ++y)
+	{
+		uint row = by * 4 + y < height ? by * 4 + y : height - 1;
+
+		for (uint x = 0; x < 4; ++x)
+		{
+			uint column = bx * 4 + x < width ? bx * 4 + x : width - 1;
+			const unsigned char* source = pixels + ((uint64)row * width + column) * 4;
+			uint pixel = y * 4 + x;
+
+			for (uint c = 0; c < 4; ++c)
+			{
+				block.rgba[pixel][c] = source[c];
+				block.channels[c][pixel] = (float)source[c];
+			}
+		}
+	}
+}
+
+// --- Nearest palette entry for every pixel over channels [first, first + count), returns the squared error ---
+static float FindIndices(const BlockPixels& block, const float (*palette)[4], uint palette_size, uint first, uint count, unsigned char* indices)
+{
+	return Kernels::BlockIndices(block.channels, palette, palette_size, first, count, indices);
+}
+
+// --- Principal axis of the block over channels [first, first + count), by power iteration ---
+static void FindAxis(const BlockPixels& block, uint first, uint count, float mean[4], float axis[4])
+{
+	float covariance[4][4] = { { 0.0f } };
+
+	for (uint c = first; c < first + count; ++c)
+	{
+		mean[c] = 0.0f;
+
+		for (uint i = 0; i < 16; ++i)
+			mean[c] += block.channels[c][i];
+
+		mean[c] /= 16.0f;
+	}
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		for (uint a = first; a < first + count; ++a)
+		{
+			for (uint b = first; b < first + count; ++b)
+				covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+		}
+	}
+
+	// --- Start from the widest channel, converges in a few steps for 16 points ---
+	uint widest = first;
+
+	for (uint c = first; c < first + count; ++c)
+	{
+		axis[c] = 0.0f;
+
+		if (covariance[c][c] > covariance[widest][widest])
+			widest = c;
+	}
+
+	axis[widest] = 1.0f;
+
+	for (uint step = 0; step < 8; ++step)
+	{
+		float next[4] = { 0.0f };
+		float length = 0.0f;
+
+		for (uint a = first; a < first + count; ++a)
+		{
+			for (uint b = first; b < first + count; ++b)
+				next[a] += covariance[a][b] * axis[b];
+
+			length += next[a] * next[a];
+		}
+
+		if (length < 1e-12f)
+			break;
+
+		length = 1.0f / sqrtf(length);
+
+		for (uint c = first; c < first + count; ++c)
+			axis[c] = next[c] * length;
+	}
+}
+
+// --- Endpoints along the principal axis, or the bounding box diagonal when fast ---
+static void FindEndpoints(const BlockPixels& block, uint first, uint count, CompressionQuality quality, float start[4], float end[4])
+{
+	if (quality == CompressionQuality::Fast)
+	{
+		for (uint c = first; c < first + count; ++c)
+		{
+			float min = 255.0f, max = 0.0f;
+
+			for (uint i = 0; i < 16; ++i)
+			{
+				min = block.channels[c][i] < min ? block.channels[c][i] : min;
+				max = block.channels[c][i] > max ? block.channels[c][i] : max;
+			}
+
+			// --- Inset so the extremes land between palette entries ---
+			float inset = (max - min) / 16.0f;
+			start[c] = min + inset;
+			end[c] = max - inset;
+		}
+
+		return;
+	}
+
+	float mean[4], axis[4];
+	FindAxis(block, first, count, mean, axis);
+
+	float min = FLT_MAX, max = -FLT_MAX;
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		float projection = 0.0f;
+
+		for (uint c = first; c < first + count; ++c)
+			projection += (block.channels[c][i] - mean[c]) * axis[c];
+
+		min = projection < min ? projection : min;
+		max = projection > max ? projection : max;
+	}
+
+	for (uint c = first; c < first + count; ++c)
+	{
+		start[c] = ClampF(mean[c] + axis[c] * min, 0.0f, 255.0f);
+		end[c] = ClampF(mean[c] + axis[c] * max, 0.0f, 255.0f);
+	}
+}
+
+// --- Least squares endpoints for the given indices, t is each index's weight of the end point. False when they are degenerate ---
+static bool SolveEndpoints(const BlockPixels& block, uint first, uint count, const unsigned char* indices, const float* weights, float start[4], float end[4])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = { 0.0f }, bx[4] = { 0.0f };
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		float t = weights[indices[i]];
+		float s = 1.0f - t;
+		aa += s * s;
+		ab += s * t;
+		bb += t * t;
+
+		for (uint c = first; c < first + count; ++c)
+		{
+			ax[c] += s * block.channels[c][i];
+			bx[c] += t * block.channels[c][i];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+
+	if (fabsf(determinant) < 1e-6f)
+		return false;
+
+	determinant = 1.0f / determinant;
+
+	for (uint c = first; c < first + count; ++c)
+	{
+		start[c] = ClampF((ax[c] * bb - bx[c] * ab) * determinant, 0.0f, 255.0f);
+		end[c] = ClampF((bx[c] * aa - ax[c] * ab) * determinant, 0.0f, 255.0f);
+	}
+
+	return true;
+}
+
+// --- BC1 color, 565 endpoints and 2 bit indices, always in the four color mode ---
+
+static inline uint To565(const int color[3])
+{
+	return (Clamp(color[0], 0, 31) << 11) | (Clamp(color[1], 0, 63) << 5) | Clamp(color[2], 0, 31);
+}
+
+static void Build565Palette(uint c0, uint c1, float palette[4][4])
+{
+	int colors[2][3];
+
+	for (uint i = 0; i < 2; ++i)
+	{
+		uint c = i == 0 ? c0 : c1;
+		colors[i][0] = ((c >> 11) & 31) * 255 / 31;
+		colors[i][1] = ((c >> 5) & 63) * 255 / 63;
+		colors[i][2] = (c & 31) * 255 / 31;
+	}
+
+	// --- Same rounding as ImageDecoder::DecompressBlocks ---
+	for (uint c = 0; c < 3; ++c)
+	{
+		palette[0][c] = (float)colors[0][c];
+		palette[1][c] = (float)colors[1][c];
+		palette[2][c] = (float)((2 * colors[0][c] + colors[1][c]) / 3);
+		palette[3][c] = (float)((colors[0][c] + 2 * colors[1][c]) / 3);
+	}
+
+	for (uint i = 0; i < 4; ++i)
+		palette[i][3] = 255.0f;
+}
+
+static void Quantize565(const float color[4], int quantized[3])
+{
+	quantized[0] = Clamp((int)(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+	quantized[1] = Clamp((int)(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+	quantized[2] = Clamp((int)(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+}
+
+static float Evaluate565(const BlockPixels& block, const int q0[3], const int q1[3], unsigned char* indices)
+{
+	float palette[4][4];
+	Build565Palette(To565(q0), To565(q1), palette);
+
+	return FindIndices(block, palette, 4, 0, 3, indices);
+}
+
+static float EncodeColorBlock(const BlockPixels& block, CompressionQuality quality, unsigned char* out, unsigned char decoded[16][4])
+{
+	static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float start[4], end[4];
+	FindEndpoints(block, 0, 3, quality, start, end);
+
+	int best0[3], best1[3];
+	unsigned char best_indices[16];
+	Quantize565(start, best0);
+	Quantize565(end, best1);
+	float best = Evaluate565(block, best0, best1, best_indices);
+
+	// --- Refit the endpoints to the chosen indices ---
+	uint iterations = quality == CompressionQuality::Fast ? 0 : (quality == CompressionQuality::Normal ? 1 : 3);
+
+	for (uint i = 0; i < iterations && best > 0.0f; ++i)
+	{
+		if (!SolveEndpoints(block, 0, 3, best_indices, weights, start, end))
+			break;
+
+		int q0[3], q1[3];
+		unsigned char indices[16];
+		Quantize565(start, q0);
+		Quantize565(end, q1);
+		float error = Evaluate565(block, q0, q1, indices);
+
+		if (error >= best)
+			break;
+
+		best = error;
+		memcpy(best0, q0, sizeof(q0));
+		memcpy(best1, q1, sizeof(q1));
+		memcpy(best_indices, indices, 16);
+	}
+
+	// --- Nudge each endpoint channel by one step while it helps ---
+	if (quality == CompressionQuality::High)
+	{
+		for (uint channel = 0; channel < 6 && best > 0.0f; ++channel)
+		{
+			for (int step = -1; step <= 1; step += 2)
+			{
+				int q0[3], q1[3];
+				unsigned char indices[16];
+				memcpy(q0, best0, sizeof(q0));
+				memcpy(q1, best1, sizeof(q1));
+
+				int* target = channel < 3 ? &q0[channel] : &q1[channel - 3];
+				*target = Clamp(*target + step, 0, (channel % 3) == 1 ? 63 : 31);
+
+				float error = Evaluate565(block, q0, q1, indices);
+
+				if (error < best)
+				{
+					best = error;
+					memcpy(best0, q0, sizeof(q0));
+					memcpy(best1, q1, sizeof(q1));
+					memcpy(best_indices, indices, 16);
+				}
+			}
+		}
+	}
+
+	uint c0 = To565(best0);
+	uint c1 = To565(best1);
+
+	// --- Four color mode needs c0 > c1, swapping them swaps the index pairs ---
+	if (c0 < c1)
+	{
+		uint swap = c0;
+		c0 = c1;
+		c1 = swap;
+
+		for (uint i = 0; i < 16; ++i)
+			best_indices[i] ^= 1;
+	}
+	else if (c0 == c1)
+		memset(best_indices, 0, 16);
+
+	float palette[4][4];
+	Build565Palette(c0, c1, palette);
+
+	out[0] = (unsigned char)c0;
+	out[1] = (unsigned char)(c0 >> 8);
+	out[2] = (unsigned char)c1;
+	out[3] = (unsigned char)(c1 >> 8);
+
+	for (uint row = 0; row < 4; ++row)
+	{
+		out[4 + row] = 0;
+
+		for (uint x = 0; x < 4; ++x)
+			out[4 + row] |= best_indices[row * 4 + x] << (2 * x);
+	}
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		for (uint c = 0; c < 3; ++c)
+			decoded[i][c] = (unsigned char)palette[best_indices[i]][c];
+	}
+
+	return best;
+}
+
+// --- BC4 channel, also BC3 alpha and both BC5 channels. 8 bit endpoints and 3 bit indices ---
+
+static void BuildChannelPalette(int a0, int a1, uint channel, float palette[8][4])
+{
+	int values[8];
+	values[0] = a0;
+	values[1] = a1;
+
+	for (int i = 2; i < 8; ++i)
+	{
+		if (a0 > a1)
+			values[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+		else if (i < 6)
+			values[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+		else
+			values[i] = i == 6 ? 0 : 255;
+	}
+
+	for (uint i = 0; i < 8; ++i)
+		palette[i][channel] = (float)values[i];
+}
+
+static float EvaluateChannel(const BlockPixels& block, uint channel, int a0, int a1, unsigned char* indices)
+{
+	float palette[8][4];
+	BuildChannelPalette(a0, a1, channel, palette);
+
+	return FindIndices(block, palette, 8, channel, 1, indices);
+}
+
+static float EncodeChannelBlock(const BlockPixels& block, uint channel, CompressionQuality quality, unsigned char* out, unsigned char decoded[16][4])
+{
+	int min = 255, max = 0, inner_min = 255, inner_max = 0;
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		int value = block.rgba[i][channel];
+		min = value < min ? value : min;
+		max = value > max ? value : max;
+
+		if (value > 0 && value < 255)
+		{
+			inner_min = value < inner_min ? value : inner_min;
+			inner_max = value > inner_max ? value : inner_max;
+		}
+	}
+
+	int best0 = max, best1 = min;
+	unsigned char best_indices[16];
+	float best = 0.0f;
+
+	if (min == max)
+	{
+		// --- Flat, the six value mode with everything on the first endpoint ---
+		memset(best_indices, 0, 16);
+	}
+	else
+	{
+		best = EvaluateChannel(block, channel, best0, best1, best_indices);
+
+		// --- Six values plus explicit 0 and 255, for blocks that touch the extremes ---
+		if (quality != CompressionQuality::Fast && (min == 0 || max == 255) && best > 0.0f)
+		{
+			int a0 = inner_min <= inner_max ? inner_min : 0;
+			int a1 = inner_min <= inner_max ? inner_max : 0;
+			unsigned char indices[16];
+			float error = EvaluateChannel(block, channel, a0, a1, indices);
+
+			if (error < best)
+			{
+				best = error;
+				best0 = a0;
+				best1 = a1;
+				memcpy(best_indices, indices, 16);
+			}
+		}
+
+		// --- Pull the endpoints in a little, the extremes are rarely the best fit ---
+		if (quality == CompressionQuality::High && best > 0.0f && best0 > best1)
+		{
+			int start0 = best0, start1 = best1;
+
+			for (int d0 = -3; d0 <= 0; ++d0)
+			{
+				for (int d1 = 0; d1 <= 3; ++d1)
+				{
+					int a0 = start0 + d0, a1 = start1 + d1;
+
+					if (a0 <= a1)
+						continue;
+
+					unsigned char indices[16];
+					float error = EvaluateChannel(block, channel, a0, a1, indices);
+
+					if (error < best)
+					{
+						best = error;
+						best0 = a0;
+						best1 = a1;
+						memcpy(best_indices, indices, 16);
+					}
+				}
+			}
+		}
+	}
+
+	float palette[8][4];
+	BuildChannelPalette(best0, best1, channel, palette);
+
+	out[0] = (unsigned char)best0;
+	out[1] = (unsigned char)best1;
+
+	uint64 bits = 0;
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		bits |= (uint64)best_indices[i] << (3 * i);
+		decoded[i][channel] = (unsigned char)palette[best_indices[i]][channel];
+	}
+
+	for (uint i = 0; i < 6; ++i)
+		out[2 + i] = (unsigned char)(bits >> (8 * i));
+
+	return best;
+}
+
+// --- BC7 mode 6, one subset of RGBA endpoints with 7 bits and a p-bit each, 4 bit indices ---
+
+static void QuantizeBC7(const float color[4], uint pbit, int quantized[4])
+{
+	for (uint c = 0; c < 4; ++c)
+		quantized[c] = Clamp((int)((color[c] - (float)pbit) / 2.0f + 0.5f), 0, 127);
+}
+
+static void BuildBC7Palette(const int q0[4], uint p0, const int q1[4], uint p1, float palette[BC7_MODE6_WEIGHTS][4])
+{
+	for (uint c = 0; c < 4; ++c)
+	{
+		int e0 = (q0[c] << 1) | (int)p0;
+		int e1 = (q1[c] << 1) | (int)p1;
+
+		for (uint i = 0; i < BC7_MODE6_WEIGHTS; ++i)
+			palette[i][c] = (float)(((64 - bc7_weights[i]) * e0 + bc7_weights[i] * e1 + 32) >> 6);
+	}
+}
+
+// --- Each p-bit by its own rounding error, or the best of the four pairs when quality is high ---
+static float EvaluateBC7(const BlockPixels& block, const float start[4], const float end[4], CompressionQuality quality, int q0[4], uint& p0, int q1[4], uint& p1, unsigned char* indices)
+{
+	uint pairs[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+	uint pair_count = 4;
+
+	if (quality != CompressionQuality::High)
+	{
+		float errors[2][2] = { { 0.0f } };
+
+		for (uint p = 0; p < 2; ++p)
+		{
+			int t0[4], t1[4];
+			QuantizeBC7(start, p, t0);
+			QuantizeBC7(end, p, t1);
+
+			for (uint c = 0; c < 4; ++c)
+			{
+				float d0 = (float)((t0[c] << 1) | p) - start[c];
+				float d1 = (float)((t1[c] << 1) | p) - end[c];
+				errors[0][p] += d0 * d0;
+				errors[1][p] += d1 * d1;
+			}
+		}
+
+		pairs[0][0] = errors[0][1] < errors[0][0] ? 1 : 0;
+		pairs[0][1] = errors[1][1] < errors[1][0] ? 1 : 0;
+		pair_count = 1;
+	}
+
+	float best = FLT_MAX;
+
+	for (uint pair = 0; pair < pair_count; ++pair)
+	{
+		uint a = pairs[pair][0], b = pairs[pair][1];
+		int t0[4], t1[4];
+		unsigned char candidate[16];
+		float palette[BC7_MODE6_WEIGHTS][4];
+		QuantizeBC7(start, a, t0);
+		QuantizeBC7(end, b, t1);
+		BuildBC7Palette(t0, a, t1, b, palette);
+
+		float error = FindIndices(block, palette, BC7_MODE6_WEIGHTS, 0, 4, candidate);
+
+		if (error < best)
+		{
+			best = error;
+			memcpy(q0, t0, sizeof(t0));
+			memcpy(q1, t1, sizeof(t1));
+			p0 = a;
+			p1 = b;
+			memcpy(indices, candidate, 16);
+		}
+	}
+
+	return best;
+}
+
+struct BitWriter
+{
+	unsigned char* out = nullptr;
+	uint position = 0;
+
+	void Write(uint value, uint bits)
+	{
+		for (uint i = 0; i < bits; ++i, ++position)
+		{
+			if (value & (1 << i))
+				out[position >> 3] |= (unsigned char)(1 << (position & 7));
+		}
+	}
+};
+
+static float EncodeBC7Block(const BlockPixels& block, CompressionQuality quality, unsigned char* out, unsigned char decoded[16][4])
+{
+	float weights[BC7_MODE6_WEIGHTS];
+
+	for (uint i = 0; i < BC7_MODE6_WEIGHTS; ++i)
+		weights[i] = bc7_weights[i] / 64.0f;
+
+	float start[4], end[4];
+	FindEndpoints(block, 0, 4, quality, start, end);
+
+	int best0[4], best1[4];
+	uint best_p0 = 0, best_p1 = 0;
+	unsigned char best_indices[16];
+	float best = EvaluateBC7(block, start, end, quality, best0, best_p0, best1, best_p1, best_indices);
+
+	uint iterations = quality == CompressionQuality::Fast ? 0 : (quality == CompressionQuality::Normal ? 1 : 3);
+
+	for (uint i = 0; i < iterations && best > 0.0f; ++i)
+	{
+		if (!SolveEndpoints(block, 0, 4, best_indices, weights, start, end))
+			break;
+
+		int q0[4], q1[4];
+		uint p0 = 0, p1 = 0;
+		unsigned char indices[16];
+		float error = EvaluateBC7(block, start, end, quality, q0, p0, q1, p1, indices);
+
+		if (error >= best)
+			break;
+
+		best = error;
+		memcpy(best0, q0, sizeof(q0));
+		memcpy(best1, q1, sizeof(q1));
+		best_p0 = p0;
+		best_p1 = p1;
+		memcpy(best_indices, indices, 16);
+	}
+
+	// --- The first index drops its top bit, swapping the endpoints inverts the indices ---
+	if (best_indices[0] & 8)
+	{
+		for (uint c = 0; c < 4; ++c)
+		{
+			int swap = best0[c];
+			best0[c] = best1[c];
+			best1[c] = swap;
+		}
+
+		uint swap = best_p0;
+		best_p0 = best_p1;
+		best_p1 = swap;
+
+		for (uint i = 0; i < 16; ++i)
+			best_indices[i] = (unsigned char)(15 - best_indices[i]);
+	}
+
+	float palette[BC7_MODE6_WEIGHTS][4];
+	BuildBC7Palette(best0, best_p0, best1, best_p1, palette);
+
+	memset(out, 0, 16);
+	BitWriter writer;
+	writer.out = out;
+	writer.Write(1 << 6, 7);
+
+	for (uint c = 0; c < 4; ++c)
+	{
+		writer.Write(best0[c], 7);
+		writer.Write(best1[c], 7);
+	}
+
+	writer.Write(best_p0, 1);
+	writer.Write(best_p1, 1);
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		writer.Write(best_indices[i], i == 0 ? 3 : 4);
+
+		for (uint c = 0; c < 4; ++c)
+			decoded[i][c] = (unsigned char)palette[best_indices[i]][c];
+	}
+
+	return best;
+}
+
+// --- Levels ---
+
+static uint64 EncodeBlock(const BlockPixels& block, PixelFormat format, CompressionQuality quality, unsigned char* out)
+{
+	unsigned char decoded[16][4];
+	memcpy(decoded, block.rgba, sizeof(decoded));
+
+	uint first = 0, count = 4;
+
+	switch (format)
+	{
+	case PixelFormat::BC1:
+		EncodeColorBlock(block, quality, out, decoded);
+		count = 3;
+		break;
+	case PixelFormat::BC3:
+		EncodeChannelBlock(block, 3, quality, out, decoded);
+		EncodeColorBlock(block, quality, out + 8, decoded);
+		break;
+	case PixelFormat::BC4:
+		EncodeChannelBlock(block, 0, quality, out, decoded);
+		count = 1;
+		break;
+	case PixelFormat::BC5:
+		EncodeChannelBlock(block, 0, quality, out, decoded);
+		EncodeChannelBlock(block, 1, quality, out + 8, decoded);
+		count = 2;
+		break;
+	case PixelFormat::BC7:
+		EncodeBC7Block(block, quality, out, decoded);
+		break;
+	default:
+		break;
+	}
+
+	// --- Error over what the decoder gives back, for the stats ---
+	uint64 error = 0;
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		for (uint c = first; c < first + count; ++c)
+		{
+			int difference = (int)decoded[i][c] - (int)block.rgba[i][c];
+			error += difference * difference;
+		}
+	}
+
+	return error;
+}
+
+static uint64 CompressLevel(const unsigned char* pixels, uint width, uint height, PixelFormat format, CompressionQuality quality, unsigned char* out)
+{
+	uint block_bytes = ImageDecoder::GetBlockBytes(format);
+	uint blocks_x = (width + 3) / 4;
+	uint blocks_y = (height + 3) / 4;
+	std::atomic<uint64> error(0);
+
+	App->jobs->ParallelFor(blocks_y, TEXTURE_COMPRESSOR_TILE_ROWS, [&](uint begin, uint end)
+	{
+		BlockPixels block;
+		uint64 tile_error = 0;
+
+		for (uint by = begin; by < end; ++by)
+		{
+			for (uint bx = 0; bx < blocks_x; ++bx)
+			{
+				LoadBlock(pixels, width, height, bx, by, block);
+				tile_error += EncodeBlock(block, format, quality, out + ((uint64)by * blocks_x + bx) * block_bytes);
+			}
+		}
+
+		error += tile_error;
+	});
+
+	return error;
+}
+
+PixelFormat TextureCompressor::ChooseFormat(const TextureCompression& compression, bool has_alpha, bool bc7_supported)
+{
+	switch (compression.usage)
+	{
+	case TextureUsage::Normal:
+		return PixelFormat::BC5;
+	case TextureUsage::Mask:
+		return PixelFormat::BC4;
+	default:
+		if (compression.quality == CompressionQuality::High && bc7_supported)
+			return PixelFormat::BC7;
+
+		return has_alpha ? PixelFormat::BC3 : PixelFormat::BC1;
+	}
+}
+
+bool TextureCompressor::HasAlpha(const DecodedImage& image)
+{
+	if (image.format != PixelFormat::RGBA8 || image.pixels == nullptr)
+		return false;
+
+	uint64 pixels = (uint64)image.width * image.height;
+
+	for (uint64 i = 0; i < pixels; ++i)
+	{
+		if (image.pixels[i * 4 + 3] != 255)
+			return true;
+	}
+
+	return false;
+}
+
+bool TextureCompressor::Compress(const DecodedImage& image, PixelFormat format, const TextureCompression& compression, DecodedImage& out, CompressionStats* stats)
+{
+	PROFILE_FUNCTION();
+
+	out = DecodedImage();
+
+	if (image.format != PixelFormat::RGBA8 || image.pixels == nullptr || ImageDecoder::GetBlockBytes(format) == 0 || format == PixelFormat::BC2)
+		return false;
+
+	PerfTimer timer;
+
+	// --- Levels below the top are filtered first, then every level is compressed on its own ---
+	std::vector<std::vector<unsigned char>> mips;
+
+	if (compression.mips)
+		TextureMips::Generate(image, compression, mips);
+
+	uint levels = 1 + (uint)mips.size();
+
+	out.format = format;
+	out.width = image.width;
+	out.height = image.height;
+	out.levels = levels;
+	out.size = ImageDecoder::GetImageSize(format, image.width, image.height, levels);
+	out.pixels = (unsigned char*)ENGINE_ALLOC(MemoryTag::Import, (size_t)out.size);
+	out.owned = true;
+
+	unsigned char* target = out.pixels;
+	uint width = image.width;
+	uint height = image.height;
+	uint64 top_error = 0;
+
+	for (uint level = 0; level < levels; ++level)
+	{
+		uint64 error = CompressLevel(level == 0 ? image.pixels : mips[level - 1].data(), width, height, format, compression.quality, target);
+
+		if (level == 0)
+			top_error = error;
+
+		target += ImageDecoder::GetLevelSize(format, width, height);
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	if (stats)
+	{
+		// --- Edge blocks repeat pixels, close enough for a quality figure ---
+		uint channels = format == PixelFormat::BC4 ? 1 : (format == PixelFormat::BC5 ? 2 : (format == PixelFormat::BC1 ? 3 : 4));
+		double samples = (double)((image.width + 3) / 4) * ((image.height + 3) / 4) * 16 * channels;
+		double mse = top_error / samples;
+
+		stats->psnr = mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+		stats->ms = timer.ReadMs();
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+#ifndef __TEXTURE_COMPRESSOR_H__
+#define __TEXTURE_COMPRESSOR_H__
+
+#include "ImageDecoder.h"
+
+#define TEXTURE_COMPRESSOR_TILE_ROWS 4 // Block rows per job
+
+enum class TextureUsage
+{
+	Albedo = 0, // BC1, BC3 with alpha, BC7 at high quality. sRGB, mips are filtered in linear light
+	Normal, // BC5, only x and y are kept, z is rebuilt when sampling
+	Mask // BC4, red only
+};
+
+enum class CompressionQuality
+{
+	Fast = 0,
+	Normal,
+	High
+};
+
+enum class MipFilter
+{
+	Box = 0,
+	Kaiser,
+	Lanczos // Sharpest, rings the most
+};
+
+struct TextureCompression
+{
+	TextureUsage usage = TextureUsage::Albedo;
+	CompressionQuality quality = CompressionQuality::Normal;
+	bool mips = true; // Full chain down to 1x1, see TextureMips
+	MipFilter filter = MipFilter::Kaiser;
+	bool alpha_coverage = false; // Keep as many pixels past alpha_cutoff on every level, for alpha tested foliage
+	float alpha_cutoff = 0.5f;
+};
+
+struct CompressionStats
+{
+	double psnr = 0.0; // Top level, over the channels the format keeps
+	double ms = 0.0;
+};
+
+// --- Block compression for the library. Rows stay bottom first, the blocks are stored in the order GL reads them ---
+namespace TextureCompressor
+{
+	PixelFormat ChooseFormat(const TextureCompression& compression, bool has_alpha, bool bc7_supported);
+	bool HasAlpha(const DecodedImage& image);
+
+	// --- Image is RGBA8, tiles of block rows are compressed on the job system. Out owns its pixels, free them through ModuleTextures::FreeImage ---
+	bool Compress(const DecodedImage& image, PixelFormat format, const TextureCompression& compression, DecodedImage& out, CompressionStats* stats = nullptr);
+}
+
+#endif
@@ -0,0 +1,326 @@
+#include "TextureMips.h"
+#include "Application.h"
+#include "ModuleJobs.h"
+
+#include <math.h>
+
+#include "mmgr/mmgr.h"
+
+#define TEXTURE_MIPS_PI 3.14159265358979f
+#define TEXTURE_MIPS_ROWS 16 // Rows per job
+
+// --- Source pixels and weights of every target pixel along one axis, count of them each ---
+struct MipTaps
+{
+	uint count = 0;
+	std::vector<uint> indices;
+	std::vector<float> weights;
+};
+
+static inline float Saturate(float value)
+{
+	return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+static float SRGBToLinear(float value)
+{
+	return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float value)
+{
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static float Sinc(float x)
+{
+	if (fabsf(x) < 1e-5f)
+		return 1.0f;
+
+	x *= TEXTURE_MIPS_PI;
+
+	return sinf(x) / x;
+}
+
+// --- Modified Bessel function of the first kind, order zero, by its series ---
+static float BesselI0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+
+	for (uint k = 1; k < 32; ++k)
+	{
+		float factor = x / (2.0f * k);
+		term *= factor * factor;
+		sum += term;
+
+		if (term < sum * 1e-7f)
+			break;
+	}
+
+	return sum;
+}
+
+// --- Distance in pixels of the smaller level ---
+static float EvaluateFilter(MipFilter filter, float distance)
+{
+	distance = fabsf(distance);
+
+	switch (filter)
+	{
+	case MipFilter::Box:
+		return distance <= 0.5f ? 1.0f : 0.0f;
+	case MipFilter::Lanczos:
+		return distance < TEXTURE_MIPS_RADIUS ? Sinc(distance) * Sinc(distance / TEXTURE_MIPS_RADIUS) : 0.0f;
+	default:
+	{
+		if (distance >= TEXTURE_MIPS_RADIUS)
+			return 0.0f;
+
+		float ratio = distance / TEXTURE_MIPS_RADIUS;
+
+		return Sinc(distance) * BesselI0(TEXTURE_MIPS_KAISER_ALPHA * sqrtf(1.0f - ratio * ratio)) / BesselI0(TEXTURE_MIPS_KAISER_ALPHA);
+	}
+	}
+}
+
+static void BuildTaps(uint source, uint target, MipFilter filter, MipTaps& taps)
+{
+	float scale = (float)source / target;
+	float support = (filter == MipFilter::Box ? 0.5f : TEXTURE_MIPS_RADIUS) * scale;
+
+	taps.count = (uint)ceilf(support * 2.0f) + 1;
+	taps.indices.resize((size_t)target * taps.count);
+	taps.weights.resize((size_t)target * taps.count);
+
+	for (uint x = 0; x < target; ++x)
+	{
+		float center = (x + 0.5f) * scale - 0.5f;
+		int first = (int)ceilf(center - support);
+		uint* indices = &taps.indices[(size_t)x * taps.count];
+		float* weights = &taps.weights[(size_t)x * taps.count];
+		float sum = 0.0f;
+
+		for (uint i = 0; i < taps.count; ++i)
+		{
+			int position = first + (int)i;
+
+			indices[i] = (uint)(((position % (int)source) + (int)source) % (int)source);
+			weights[i] = EvaluateFilter(filter, (position - center) / scale);
+			sum += weights[i];
+		}
+
+		if (sum != 0.0f)
+		{
+			for (uint i = 0; i < taps.count; ++i)
+				weights[i] /= sum;
+		}
+	}
+}
+
+// --- Separable, rows first. Temp ends up holding height x target_width pixels ---
+static void Resample(const std::vector<float>& source, uint width, uint height, std::vector<float>& temp, std::vector<float>& target, uint target_width, uint target_height, MipFilter filter)
+{
+	MipTaps columns, rows;
+	BuildTaps(width, target_width, filter, columns);
+	BuildTaps(height, target_height, filter, rows);
+
+	temp.assign((size_t)height * target_width * 4, 0.0f);
+	target.assign((size_t)target_width * target_height * 4, 0.0f);
+
+	App->jobs->ParallelFor(height, TEXTURE_MIPS_ROWS, [&](uint begin, uint end)
+	{
+		for (uint y = begin; y < end; ++y)
+		{
+			const float* row = &source[(size_t)y * width * 4];
+
+			for (uint x = 0; x < target_width; ++x)
+			{
+				float* out = &temp[((size_t)y * target_width + x) * 4];
+
+				for (uint i = 0; i < columns.count; ++i)
+				{
+					const float* pixel = row + columns.indices[(size_t)x * columns.count + i] * 4;
+					float weight = columns.weights[(size_t)x * columns.count + i];
+
+					for (uint c = 0; c < 4; ++c)
+						out[c] += pixel[c] * weight;
+				}
+			}
+		}
+	});
+
+	App->jobs->ParallelFor(target_height, TEXTURE_MIPS_ROWS, [&](uint begin, uint end)
+	{
+		for (uint y = begin; y < end; ++y)
+		{
+			float* out = &target[(size_t)y * target_width * 4];
+
+			for (uint i = 0; i < rows.count; ++i)
+			{
+				const float* row = &temp[(size_t)rows.indices[(size_t)y * rows.count + i] * target_width * 4];
+				float weight = rows.weights[(size_t)y * rows.count + i];
+
+				for (uint x = 0; x < target_width * 4; ++x)
+					out[x] += row[x] * weight;
+			}
+		}
+	});
+}
+
+// --- Back to bytes, undoing what Generate did to the top level ---
+static void Quantize(const std::vector<float>& source, uint64 pixels, TextureUsage usage, bool premultiplied, std::vector<unsigned char>& target)
+{
+	target.resize((size_t)pixels * 4);
+
+	App->jobs->ParallelFor((uint)((pixels + 1023) / 1024), 1, [&](uint begin, uint end)
+	{
+		uint64 last = (uint64)end * 1024 < pixels ? (uint64)end * 1024 : pixels;
+
+		for (uint64 i = (uint64)begin * 1024; i < last; ++i)
+		{
+			const float* pixel = &source[(size_t)i * 4];
+			float color[3] = { pixel[0], pixel[1], pixel[2] };
+			float alpha = Saturate(pixel[3]);
+
+			if (usage == TextureUsage::Normal)
+			{
+				// --- Filtering shortens normals, they are renormalized ---
+				float length = 0.0f;
+
+				for (uint c = 0; c < 3; ++c)
+				{
+					color[c] = color[c] * 2.0f - 1.0f;
+					length += color[c] * color[c];
+				}
+
+				length = length > 1e-8f ? 1.0f / sqrtf(length) : 0.0f;
+
+				for (uint c = 0; c < 3; ++c)
+					color[c] = color[c] * length * 0.5f + 0.5f;
+			}
+			else if (premultiplied)
+			{
+				for (uint c = 0; c < 3; ++c)
+					color[c] = alpha > 1.0f / 512.0f ? color[c] / alpha : 0.0f;
+			}
+
+			unsigned char* out = &target[(size_t)i * 4];
+
+			for (uint c = 0; c < 3; ++c)
+			{
+				float value = Saturate(color[c]);
+				out[c] = (unsigned char)((usage == TextureUsage::Albedo ? LinearToSRGB(value) : value) * 255.0f + 0.5f);
+			}
+
+			out[3] = (unsigned char)(alpha * 255.0f + 0.5f);
+		}
+	});
+}
+
+static float GetCoverage(const unsigned char* rgba, uint64 pixels, float cutoff, float scale)
+{
+	uint64 covered = 0;
+
+	for (uint64 i = 0; i < pixels; ++i)
+	{
+		if (rgba[i * 4 + 3] * scale > cutoff)
+			++covered;
+	}
+
+	return pixels ? (float)covered / pixels : 0.0f;
+}
+
+// --- Scales alpha until as many pixels pass the alpha test as in the top level, so cutouts do not fade with distance ---
+static void PreserveCoverage(std::vector<unsigned char>& rgba, float coverage, float cutoff)
+{
+	uint64 pixels = rgba.size() / 4;
+	float low = 0.0f;
+	float high = 4.0f;
+
+	for (uint i = 0; i < TEXTURE_MIPS_COVERAGE_STEPS; ++i)
+	{
+		float scale = (low + high) * 0.5f;
+
+		if (GetCoverage(rgba.data(), pixels, cutoff, scale) < coverage)
+			low = scale;
+		else
+			high = scale;
+	}
+
+	float scale = (low + high) * 0.5f;
+
+	for (uint64 i = 0; i < pixels; ++i)
+	{
+		float alpha = rgba[(size_t)i * 4 + 3] * scale + 0.5f;
+		rgba[(size_t)i * 4 + 3] = (unsigned char)(alpha > 255.0f ? 255.0f : alpha);
+	}
+}
+
+uint TextureMips::GetLevelCount(uint width, uint height)
+{
+	uint levels = 1;
+
+	for (uint largest = width > height ? width : height; largest > 1; largest /= 2)
+		++levels;
+
+	return levels;
+}
+
+bool TextureMips::Generate(const DecodedImage& image, const TextureCompression& compression, std::vector<std::vector<unsigned char>>& levels)
+{
+	levels.clear();
+
+	if (image.format != PixelFormat::RGBA8 || image.pixels == nullptr)
+		return false;
+
+	uint width = image.width;
+	uint height = image.height;
+	uint count = GetLevelCount(width, height);
+	bool srgb = compression.usage == TextureUsage::Albedo;
+	bool alpha = srgb && TextureCompressor::HasAlpha(image);
+	float cutoff = Saturate(compression.alpha_cutoff) * 255.0f;
+	float coverage = alpha && compression.alpha_coverage ? GetCoverage(image.pixels, (uint64)width * height, cutoff, 1.0f) : 0.0f;
+
+	// --- Top level to floats, linear and premultiplied for albedo ---
+	float table[256];
+
+	for (uint i = 0; i < 256; ++i)
+		table[i] = srgb ? SRGBToLinear(i / 255.0f) : i / 255.0f;
+
+	std::vector<float> current((size_t)width * height * 4), temp, next;
+
+	App->jobs->ParallelFor(height, TEXTURE_MIPS_ROWS, [&](uint begin, uint end)
+	{
+		for (uint64 i = (uint64)begin * width; i < (uint64)end * width; ++i)
+		{
+			const unsigned char* pixel = image.pixels + i * 4;
+			float* out = &current[(size_t)i * 4];
+
+			out[3] = pixel[3] / 255.0f;
+
+			for (uint c = 0; c < 3; ++c)
+				out[c] = alpha ? table[pixel[c]] * out[3] : table[pixel[c]];
+		}
+	});
+
+	levels.resize(count - 1);
+
+	for (uint level = 1; level < count; ++level)
+	{
+		uint target_width = width > 1 ? width / 2 : 1;
+		uint target_height = height > 1 ? height / 2 : 1;
+
+		Resample(current, width, height, temp, next, target_width, target_height, compression.filter);
+		Quantize(next, (uint64)target_width * target_height, compression.usage, alpha, levels[level - 1]);
+
+		if (alpha && compression.alpha_coverage)
+			PreserveCoverage(levels[level - 1], coverage, cutoff);
+
+		current.swap(next);
+		width = target_width;
+		height = target_height;
+	}
+
+	return true;
+}
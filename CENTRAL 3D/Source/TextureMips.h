@@ -0,0 +1,21 @@
+#ifndef __TEXTURE_MIPS_H__
+#define __TEXTURE_MIPS_H__
+
+#include "TextureCompressor.h"
+#include <vector>
+
+#define TEXTURE_MIPS_RADIUS 3.0f // Kaiser and Lanczos support, in pixels of the smaller level
+#define TEXTURE_MIPS_KAISER_ALPHA 4.0f // Kaiser window shape, higher trades ringing for blur
+#define TEXTURE_MIPS_COVERAGE_STEPS 16 // Binary search steps for the alpha scale of each level
+
+// --- Offline mip chain. Albedo is filtered in linear light with premultiplied alpha, each level is resampled from the unquantized one above.
+// Sampling wraps around the edges, as textures are set to repeat ---
+namespace TextureMips
+{
+	uint GetLevelCount(uint width, uint height); // Down to 1x1, top included
+
+	// --- Image is RGBA8. Levels gets every one below the top, RGBA8 and largest first ---
+	bool Generate(const DecodedImage& image, const TextureCompression& compression, std::vector<std::vector<unsigned char>>& levels);
+}
+
+#endif
@@ -0,0 +1,463 @@
+#include "TextureStreaming.h"
+#include "Application.h"
+#include "ModuleTextures.h"
+#include "ModuleFileSystem.h"
+#include "ModuleEventManager.h"
+#include "ModuleHardware.h"
+#include "ModuleRenderer3D.h"
+#include "ResourceTexture.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <string.h>
+
+#include "mmgr/mmgr.h"
+
+#define TEXTURE_STREAMING_MB (1024ull * 1024ull)
+
+static uint GetLargestSide(const ImageInfo& info, uint level)
+{
+	uint side = (info.width > info.height ? info.width : info.height) >> level;
+
+	return side ? side : 1;
+}
+
+static uint64 GetLevelsSize(const ImageInfo& info, uint first)
+{
+	uint64 size = 0;
+
+	for (uint i = first; i < info.levels; ++i)
+		size += ImageDecoder::GetLevelSize(info.format, info.width >> i ? info.width >> i : 1, info.height >> i ? info.height >> i : 1);
+
+	return size;
+}
+
+// --- First level both sides of which fit in the tail size, or the last one ---
+static uint GetTail(const ImageInfo& info)
+{
+	uint tail = 0;
+
+	while (tail + 1 < info.levels && ((info.width >> tail) > TEXTURE_STREAMING_TAIL_SIZE || (info.height >> tail) > TEXTURE_STREAMING_TAIL_SIZE))
+		++tail;
+
+	return tail;
+}
+
+static bool SameImage(const ImageInfo& a, const ImageInfo& b)
+{
+	return a.format == b.format && a.width == b.width && a.height == b.height && a.levels == b.levels;
+}
+
+TextureStreamer::TextureStreamer() : loads_counter(0)
+{
+}
+
+uint TextureStreamer::Register(ResourceTexture* resource, const char* path, uint& width, uint& height)
+{
+	if (resource == nullptr || path == nullptr)
+		return 0;
+
+	Unregister(resource);
+
+	// --- Headless tools keep no textures ---
+	if (!App->renderer3D->HasContext())
+		return 0;
+
+	MappedFile file;
+
+	if (!App->fs->MapFile(path, file))
+		return 0;
+
+	StreamedTexture texture;
+	std::vector<const unsigned char*> levels;
+
+	// --- Library files with a chain to drop levels from, the tail is uploaded right away ---
+	if (ImageDecoderKTX2::GetLevels((const unsigned char*)file.data, file.size, texture.info, levels) && texture.info.levels > 1)
+	{
+		texture.tail = GetTail(texture.info);
+		texture.texture = App->textures->CreateStreamedTexture(texture.info, texture.tail);
+
+		for (uint i = texture.info.levels; texture.texture && i-- > texture.tail;)
+			App->textures->UploadStreamedLevel(texture.texture, texture.info, texture.tail, i, levels[i]);
+	}
+
+	App->fs->UnmapFile(file);
+
+	if (texture.texture == 0)
+		return 0;
+
+	texture.resource = resource;
+	texture.path = path;
+	texture.resident = texture.requested = texture.target = texture.wanted = texture.tail;
+	texture.last_frame = frame;
+
+	width = texture.info.width;
+	height = texture.info.height;
+	resident_bytes += GetSize(texture, texture.resident);
+
+	textures[resource->GetUID()] = texture;
+
+	return texture.texture;
+}
+
+void TextureStreamer::Unregister(ResourceTexture* resource)
+{
+	if (resource == nullptr)
+		return;
+
+	std::map<uint, StreamedTexture>::iterator it = textures.find(resource->GetUID());
+
+	if (it == textures.end())
+		return;
+
+	StreamedTexture& texture = it->second;
+
+	// --- The job keeps its load alive until it finishes, only the upload is ours to drop. The texture itself belongs to the resource ---
+	if (texture.load)
+	{
+		App->renderer3D->ReleaseTexture(texture.load->texture);
+		transient_bytes -= GetSize(texture, texture.load->first);
+		--loads_in_flight;
+	}
+
+	resident_bytes -= GetSize(texture, texture.resident);
+	textures.erase(it);
+}
+
+void TextureStreamer::Request(uint UID, float screen_size)
+{
+	std::map<uint, StreamedTexture>::iterator it = textures.find(UID);
+
+	if (it == textures.end())
+		return;
+
+	StreamedTexture& texture = it->second;
+
+	// --- Largest level that still has a texel per pixel, each one halves the texture ---
+	uint level = 0;
+	float size = (float)GetLargestSide(texture.info, 0);
+
+	while (level < texture.tail && size * 0.5f >= screen_size)
+	{
+		size *= 0.5f;
+		++level;
+	}
+
+	// --- First draw this frame, last frame's requests are done with ---
+	if (texture.last_frame != frame)
+	{
+		texture.wanted = level;
+		texture.priority = screen_size;
+		texture.last_frame = frame;
+	}
+	else
+	{
+		texture.wanted = level < texture.wanted ? level : texture.wanted;
+		texture.priority = screen_size > texture.priority ? screen_size : texture.priority;
+	}
+}
+
+void TextureStreamer::Update()
+{
+	PROFILE_FUNCTION();
+
+	++frame;
+
+	// --- The driver's free memory lowers the budget, on drivers that report it ---
+	if (App->renderer3D->HasContext() && frame % TEXTURE_STREAMING_VRAM_INTERVAL == 1)
+	{
+		const hw_info& info = App->hardware->GetInfo();
+
+		if (info.vram_mb_budget > 0.0f)
+		{
+			float limit_mb = (float)(resident_bytes + transient_bytes) / TEXTURE_STREAMING_MB + info.vram_mb_available - TEXTURE_STREAMING_RESERVE_MB;
+			driver_limit = limit_mb > 0.0f ? (uint64)(limit_mb * TEXTURE_STREAMING_MB) : 0;
+		}
+		else
+			driver_limit = UINT64_MAX;
+	}
+
+	effective_budget = (uint64)budget_mb * TEXTURE_STREAMING_MB;
+	effective_budget = driver_limit < effective_budget ? driver_limit : effective_budget;
+
+	// --- Last frame's draws set what each texture asks for, textures out of sight keep their levels for a while ---
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		StreamedTexture& texture = it->second;
+
+		if (texture.last_frame + 1 == frame)
+		{
+			texture.requested = texture.wanted;
+			texture.on_screen = texture.priority;
+		}
+		else if (frame - texture.last_frame > TEXTURE_STREAMING_GRACE_FRAMES)
+		{
+			texture.requested = texture.tail;
+			texture.on_screen = 0.0f;
+		}
+
+		texture.target = texture.requested;
+	}
+
+	ApplyBudget();
+	StartLoads();
+
+	// --- Finished reads are uploaded inside what is left of the frame ---
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		if (it->second.load && it->second.load->done)
+		{
+			FrameScheduler::Get().Schedule("Texture Streaming", DeferredPriority::Normal, [this](const DeferredSlice& slice) { return UploadLoads(slice); }, true);
+			break;
+		}
+	}
+}
+
+void TextureStreamer::CleanUp()
+{
+	App->jobs->Wait(loads_counter);
+
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		if (it->second.load)
+			App->renderer3D->ReleaseTexture(it->second.load->texture);
+	}
+
+	textures.clear();
+	resident_bytes = 0;
+	transient_bytes = 0;
+	loads_in_flight = 0;
+}
+
+void TextureStreamer::ApplyBudget()
+{
+	typedef std::pair<float, StreamedTexture*> Candidate;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+	uint64 total = 0;
+
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		StreamedTexture& texture = it->second;
+		total += GetSize(texture, texture.target);
+
+		if (texture.target < texture.tail)
+			candidates.push(Candidate(texture.on_screen / GetLargestSide(texture.info, texture.target), &texture));
+	}
+
+	// --- Over budget, the level with the fewest pixels per texel goes first. Textures out of sight have none and drop to their tail ---
+	while (total > effective_budget && !candidates.empty())
+	{
+		StreamedTexture* texture = candidates.top().second;
+		candidates.pop();
+
+		total -= GetSize(*texture, texture->target) - GetSize(*texture, texture->target + 1);
+		++texture->target;
+
+		if (texture->target < texture->tail)
+			candidates.push(Candidate(texture->on_screen / GetLargestSide(texture->info, texture->target), texture));
+	}
+}
+
+void TextureStreamer::StartLoads()
+{
+	if (loads_in_flight >= TEXTURE_STREAMING_MAX_LOADS)
+		return;
+
+	std::vector<StreamedTexture*> pending;
+
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		if (it->second.load == nullptr && it->second.target != it->second.resident)
+			pending.push_back(&it->second);
+	}
+
+	// --- Evictions first, they free memory. Then the textures that cover the most of the screen ---
+	std::sort(pending.begin(), pending.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+	{
+		bool a_evicts = a->target > a->resident;
+		bool b_evicts = b->target > b->resident;
+
+		if (a_evicts != b_evicts)
+			return a_evicts;
+
+		return a->on_screen > b->on_screen;
+	});
+
+	// --- The new texture is allocated before the old one goes, it has to fit beside everything resident and every other load ---
+	for (uint i = 0; i < pending.size() && loads_in_flight < TEXTURE_STREAMING_MAX_LOADS; ++i)
+	{
+		StreamedTexture& texture = *pending[i];
+		uint first = texture.target;
+
+		// --- Raises go as far as there is room for both copies, the rest waits for evictions to free memory ---
+		while (first < texture.resident && resident_bytes + transient_bytes + GetSize(texture, first) > effective_budget)
+			++first;
+
+		if (first == texture.resident)
+			continue;
+
+		// --- Already over budget an eviction cannot fit either, those go one at a time so the overshoot is a single smaller copy ---
+		if (first > texture.resident && resident_bytes + transient_bytes + GetSize(texture, first) > effective_budget && loads_in_flight > 0)
+			continue;
+
+		StartLoad(texture, first);
+	}
+}
+
+void TextureStreamer::StartLoad(StreamedTexture& texture, uint first)
+{
+	std::shared_ptr<StreamingLoad> load = std::make_shared<StreamingLoad>();
+	load->first = first;
+
+	texture.load = load;
+	transient_bytes += GetSize(texture, first);
+	++loads_in_flight;
+
+	std::string path = texture.path;
+	ImageInfo expected = texture.info;
+
+	// --- Levels from first down are read into the load, packed largest first ---
+	App->jobs->Schedule([load, path, expected]()
+	{
+		MappedFile file;
+
+		if (App->fs->MapFile(path.c_str(), file))
+		{
+			ImageInfo info;
+			std::vector<const unsigned char*> levels;
+
+			// --- Rewritten since it was registered, the resource loads it again ---
+			if (ImageDecoderKTX2::GetLevels((const unsigned char*)file.data, file.size, info, levels) && SameImage(info, expected))
+			{
+				load->data.resize((size_t)GetLevelsSize(info, load->first));
+				unsigned char* out = load->data.data();
+
+				for (uint i = load->first; i < info.levels; ++i)
+				{
+					uint64 size = ImageDecoder::GetLevelSize(info.format, info.width >> i ? info.width >> i : 1, info.height >> i ? info.height >> i : 1);
+					memcpy(out, levels[i], (size_t)size);
+					out += size;
+				}
+
+				load->ok = true;
+			}
+
+			App->fs->UnmapFile(file);
+		}
+
+		load->done = true;
+	}, &loads_counter);
+}
+
+bool TextureStreamer::UploadLoads(const DeferredSlice& slice)
+{
+	PROFILE_FUNCTION();
+
+	for (std::map<uint, StreamedTexture>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		StreamedTexture& texture = it->second;
+		std::shared_ptr<StreamingLoad> load = texture.load;
+
+		if (load == nullptr || !load->done)
+			continue;
+
+		if (!load->ok)
+		{
+			CONSOLE_LOG("|[error]: Texture Streaming: could not read levels of %s", texture.path.c_str());
+			transient_bytes -= GetSize(texture, load->first);
+			texture.load.reset();
+			--loads_in_flight;
+			continue;
+		}
+
+		if (load->texture == 0)
+		{
+			load->texture = App->textures->CreateStreamedTexture(texture.info, load->first);
+			load->next = texture.info.levels;
+		}
+
+		// --- Smallest first, a level at a time while the frame allows ---
+		uint64 size = GetLevelsSize(texture.info, load->first);
+
+		while (load->texture && load->next > load->first)
+		{
+			if (slice.OutOfTime())
+				return false;
+
+			--load->next;
+			App->textures->UploadStreamedLevel(load->texture, texture.info, load->first, load->next, &load->data[(size_t)(size - GetLevelsSize(texture.info, load->next))]);
+		}
+
+		// --- Complete, the new texture takes the place of the old one, which goes once no frame in flight uses it ---
+		if (load->texture)
+		{
+			App->renderer3D->ReleaseTexture(texture.texture);
+			texture.texture = load->texture;
+			texture.resource->SetTextureID(texture.texture);
+
+			// --- Only more detail is news, dropped levels are not reported ---
+			if (load->first < texture.resident)
+			{
+				Event e(Event::EventType::Resource_loaded);
+				e.uid = it->first;
+				App->event_manager->PushEvent(e);
+			}
+
+			resident_bytes = resident_bytes - GetSize(texture, texture.resident) + size;
+			texture.resident = load->first;
+		}
+
+		transient_bytes -= size;
+		texture.load.reset();
+		--loads_in_flight;
+	}
+
+	return true;
+}
+
+uint TextureStreamer::GetBudgetMB() const
+{
+	return budget_mb;
+}
+
+void TextureStreamer::SetBudgetMB(uint mb)
+{
+	budget_mb = mb;
+}
+
+uint64 TextureStreamer::GetEffectiveBudget() const
+{
+	return effective_budget;
+}
+
+uint64 TextureStreamer::GetResidentBytes() const
+{
+	return resident_bytes;
+}
+
+uint64 TextureStreamer::GetRequestedBytes() const
+{
+	uint64 total = 0;
+
+	for (std::map<uint, StreamedTexture>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+		total += GetSize(it->second, it->second.requested);
+
+	return total;
+}
+
+const std::map<uint, StreamedTexture>& TextureStreamer::GetTextures() const
+{
+	return textures;
+}
+
+uint TextureStreamer::GetLoadsInFlight() const
+{
+	return loads_in_flight;
+}
+
+uint64 TextureStreamer::GetSize(const StreamedTexture& texture, uint first) const
+{
+	return GetLevelsSize(texture.info, first);
+}
@@ -0,0 +1,110 @@
+#ifndef __TEXTURE_STREAMING_H__
+#define __TEXTURE_STREAMING_H__
+
+#include "ImageDecoder.h"
+#include "ModuleJobs.h"
+#include "FrameScheduler.h"
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#define TEXTURE_STREAMING_DEFAULT_BUDGET_MB 512 // Most the streamed textures may take, the driver's free memory lowers it
+#define TEXTURE_STREAMING_RESERVE_MB 256 // Video memory left to everything else when the driver reports what is free
+#define TEXTURE_STREAMING_TAIL_SIZE 64 // Levels this wide or smaller are always resident
+#define TEXTURE_STREAMING_GRACE_FRAMES 120 // Frames a texture keeps its levels once it is no longer drawn
+#define TEXTURE_STREAMING_MAX_LOADS 4 // Residency changes in flight at once
+#define TEXTURE_STREAMING_VRAM_INTERVAL 30 // Frames between queries of the driver's free memory
+
+class ResourceTexture;
+
+// --- Levels read from the file on a job, uploaded a slice at a time on the main thread ---
+struct StreamingLoad
+{
+	uint first = 0; // Largest level the new texture holds
+	std::vector<unsigned char> data; // Levels first to the last, packed largest first
+	std::atomic<bool> done;
+	bool ok = false;
+
+	// --- Upload, main thread ---
+	uint texture = 0;
+	uint next = 0; // Next level to upload, they go in smallest first
+
+	StreamingLoad() : done(false) {}
+};
+
+struct StreamedTexture
+{
+	ResourceTexture* resource = nullptr;
+	std::string path;
+	ImageInfo info;
+	uint texture = 0;
+	uint tail = 0; // Smallest level index that is always resident
+
+	// --- Levels are indices into the file, 0 is the largest. The texture holds resident to the last ---
+	uint resident = 0;
+	uint requested = 0; // What the screen size asked for last
+	uint target = 0; // Requested, after the budget had its say
+	float on_screen = 0.0f; // Pixels the texture covered last, eviction goes from the smallest
+
+	// --- Gathered during the frame's draws ---
+	uint wanted = 0;
+	float priority = 0.0f;
+	uint64 last_frame = 0;
+
+	std::shared_ptr<StreamingLoad> load;
+};
+
+// --- Per texture mip residency under a video memory budget. Levels are picked from the size textures are drawn at,
+// read on the job system and uploaded through the FrameScheduler. A change builds a second texture before the old one goes,
+// so loads only start while both copies fit in the budget. Main thread only ---
+class TextureStreamer
+{
+public:
+
+	TextureStreamer();
+
+	// --- Uploads the tail and returns the texture, 0 when the file cannot be streamed and should be loaded whole ---
+	uint Register(ResourceTexture* resource, const char* path, uint& width, uint& height);
+	void Unregister(ResourceTexture* resource);
+
+	// --- Called for every draw, screen_size is the height in pixels the texture covers ---
+	void Request(uint UID, float screen_size);
+
+	void Update(); // Once per frame, before drawing
+	void CleanUp(); // Waits for the loads in flight
+
+	// --- Budget ---
+	uint GetBudgetMB() const;
+	void SetBudgetMB(uint mb);
+	uint64 GetEffectiveBudget() const; // Bytes, after the driver's free memory
+	uint64 GetResidentBytes() const;
+	uint64 GetRequestedBytes() const; // What every texture would take at its requested level
+
+	// --- Stats ---
+	const std::map<uint, StreamedTexture>& GetTextures() const;
+	uint GetLoadsInFlight() const;
+	uint64 GetSize(const StreamedTexture& texture, uint first) const; // Bytes of levels first to the last
+
+private:
+
+	void ApplyBudget();
+	void StartLoads();
+	void StartLoad(StreamedTexture& texture, uint first);
+	bool UploadLoads(const DeferredSlice& slice);
+
+private:
+
+	std::map<uint, StreamedTexture> textures; // By resource UID
+	JobCounter loads_counter;
+
+	uint budget_mb = TEXTURE_STREAMING_DEFAULT_BUDGET_MB;
+	uint64 effective_budget = 0;
+	uint64 driver_limit = UINT64_MAX; // Bytes the driver leaves us, unknown on drivers that do not say
+	uint64 resident_bytes = 0;
+	uint64 transient_bytes = 0; // New textures of the loads in flight, they live beside the old ones until the swap
+	uint64 frame = 0;
+	uint loads_in_flight = 0;
+};
+
+#endif
@@ -74,6 +74,9 @@
 //
 // ---------------------------------------------------------------------------------------------------------------------------------
 
+// --- Debug builds only, see mmgr.h ---
+#if defined(_DEBUG) && !defined(NO_MMGR)
+
 #define _CRT_SECURE_NO_WARNINGS
 #pragma warning( disable : 4577 ) // Warning that exceptions are disabled
 #pragma warning( disable : 4530 ) // Warning that exceptions are disabled
@@ -1750,6 +1753,8 @@ sMStats	m_getMemoryStatistics()
 	return stats;
 }
 
+#endif // _DEBUG && !NO_MMGR
+
 // ---------------------------------------------------------------------------------------------------------------------------------
 // mmgr.cpp - End of file
 // ---------------------------------------------------------------------------------------------------------------------------------
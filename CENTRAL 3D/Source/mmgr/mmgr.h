@@ -153,6 +153,8 @@ void	operator delete[](void *reportedAddress);
 // Macros -- "Kids, please don't try this at home. We're trained professionals here." :)
 // ---------------------------------------------------------------------------------------------------------------------------------
 
+// --- Debug builds only, release builds account memory through the engine heaps (Allocator.h) ---
+#if defined(_DEBUG) && !defined(NO_MMGR)
 #include "nommgr.h"
 #define	new		(m_setOwner  (__FILE__,__LINE__,__FUNCTION__),false) ? NULL : new
 #define	delete		(m_setOwner  (__FILE__,__LINE__,__FUNCTION__),false) ? m_setOwner("",0,"") : delete
@@ -160,6 +162,7 @@ void	operator delete[](void *reportedAddress);
 #define	calloc(sz)	m_allocator  (__FILE__,__LINE__,__FUNCTION__,m_alloc_calloc,sz)
 #define	realloc(ptr,sz)	m_reallocator(__FILE__,__LINE__,__FUNCTION__,m_alloc_realloc,sz,ptr)
 #define	free(ptr)	m_deallocator(__FILE__,__LINE__,__FUNCTION__,m_alloc_free,ptr)
+#endif
 
 // ---------------------------------------------------------------------------------------------------------------------------------
 // mmgr.h - End of file